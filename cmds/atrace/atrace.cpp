@@ -31,6 +31,7 @@
 #include <zlib.h>
 
 #include <fstream>
+#include <map>
 #include <memory>
 
 #include <binder/IBinder.h>
@@ -631,28 +632,50 @@ static bool setAppCmdlineProperty(char* cmdline)
     return true;
 }
 
-// Disable all /sys/ enable files.
-static bool disableKernelTraceEvents() {
+// Set all /sys/ enable files: "1" for the files of enabled categories if
+// enableCategories is true, "0" for all others. The same file may belong to
+// several categories, and each file is written exactly once, rather than once
+// to disable it and again to enable it.
+static bool setKernelTraceEvents(bool enableCategories) {
     bool ok = true;
+    std::map<std::string, bool> enables;
     for (size_t i = 0; i < arraysize(k_categories); i++) {
         const TracingCategory &c = k_categories[i];
+        const bool enable = enableCategories && g_categoryEnables[i];
         for (int j = 0; j < MAX_SYS_FILES; j++) {
             const char* path = c.sysfiles[j].path;
-            if (path != nullptr && fileIsWritable(path)) {
-                ok &= setKernelOptionEnable(path, false);
+            if (path == nullptr) {
+                continue;
             }
+            if (!fileIsWritable(path)) {
+                if (enable && c.sysfiles[j].required == REQ) {
+                    fprintf(stderr, "error writing file %s\n", path);
+                    ok = false;
+                }
+                continue;
+            }
+            enables[path] |= enable;
         }
     }
     for (const TracingVendorFileCategory& c : g_vendorFileCategories) {
+        const bool enable = enableCategories && c.enabled;
         for (const std::string& path : c.ftrace_enable_paths) {
             if (fileIsWritable(path.c_str())) {
-                ok &= setKernelOptionEnable(path.c_str(), false);
+                enables[path] |= enable;
             }
         }
     }
+    for (const auto& [path, enable] : enables) {
+        ok &= setKernelOptionEnable(path.c_str(), enable);
+    }
     return ok;
 }
 
+// Disable all /sys/ enable files.
+static bool disableKernelTraceEvents() {
+    return setKernelTraceEvents(false);
+}
+
 // Verify that the comma separated list of functions are being traced by the
 // kernel.
 static bool verifyKernelTraceFuncs(const char* funcs)
@@ -856,38 +879,9 @@ static bool setUpKernelTracing()
     ok &= setPrintTgidEnableIfPresent(true);
     ok &= setKernelTraceFuncs(g_kernelTraceFuncs);
 
-    // Disable all the sysfs enables.  This is done as a separate loop from
-    // the enables to allow the same enable to exist in multiple categories.
-    ok &= disableKernelTraceEvents();
-
-    // Enable all the sysfs enables that are in an enabled category.
-    for (size_t i = 0; i < arraysize(k_categories); i++) {
-        if (g_categoryEnables[i]) {
-            const TracingCategory &c = k_categories[i];
-            for (int j = 0; j < MAX_SYS_FILES; j++) {
-                const char* path = c.sysfiles[j].path;
-                bool required = c.sysfiles[j].required == REQ;
-                if (path != nullptr) {
-                    if (fileIsWritable(path)) {
-                        ok &= setKernelOptionEnable(path, true);
-                    } else if (required) {
-                        fprintf(stderr, "error writing file %s\n", path);
-                        ok = false;
-                    }
-                }
-            }
-        }
-    }
-
-    for (const TracingVendorFileCategory& c : g_vendorFileCategories) {
-        if (c.enabled) {
-            for (const std::string& path : c.ftrace_enable_paths) {
-                if (fileIsWritable(path.c_str())) {
-                    ok &= setKernelOptionEnable(path.c_str(), true);
-                }
-            }
-        }
-    }
+    // Enable all the sysfs enables that are in an enabled category, and
+    // disable all the others.
+    ok &= setKernelTraceEvents(true);
 
     return ok;
 }
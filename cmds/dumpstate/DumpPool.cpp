@@ -18,6 +18,7 @@
 
 #include "DumpPool.h"
 
+#include <algorithm>
 #include <array>
 #include <thread>
 
@@ -58,7 +59,7 @@ DumpPool::~DumpPool() {
     if (shutdown_ || threads_.empty()) {
         return;
     }
-    while (!tasks_.empty()) tasks_.pop();
+    tasks_.clear();
 
     shutdown_ = true;
     condition_variable_.notify_all();
@@ -78,6 +79,10 @@ void DumpPool::start(int thread_counts) {
     if (thread_counts > MAX_THREAD_COUNT) {
         thread_counts = MAX_THREAD_COUNT;
     }
+    int cpu_counts = static_cast<int>(std::thread::hardware_concurrency());
+    if (cpu_counts > 0 && thread_counts > cpu_counts) {
+        thread_counts = cpu_counts;
+    }
     MYLOGI("Start thread pool:%d\n", thread_counts);
     shutdown_ = false;
     for (int i = 0; i < thread_counts; i++) {
@@ -163,18 +168,47 @@ void DumpPool::setThreadName(const pthread_t thread, int id) {
     pthread_setname_np(thread, name.data());
 }
 
+std::vector<std::string> DumpPool::knownDependenciesLocked(const std::string& duration_title,
+        const std::vector<std::string>& dependencies) {
+    std::vector<std::string> known;
+    for (const auto& dependency : dependencies) {
+        if (enqueued_.count(dependency) == 0) {
+            MYLOGE("Task '%s' depends on unknown task '%s', ignoring\n", duration_title.c_str(),
+                   dependency.c_str());
+            continue;
+        }
+        known.push_back(dependency);
+    }
+    return known;
+}
+
+bool DumpPool::isReadyLocked(const PendingTask& pending) const {
+    return std::all_of(pending.dependencies.begin(), pending.dependencies.end(),
+                       [this](const std::string& dependency) {
+                           return finished_.count(dependency) != 0;
+                       });
+}
+
 void DumpPool::loop() {
     std::unique_lock lock(lock_);
     while (!shutdown_) {
-        if (tasks_.empty()) {
+        auto it = std::find_if(tasks_.begin(), tasks_.end(), [this](const PendingTask& pending) {
+            return isReadyLocked(pending);
+        });
+        if (it == tasks_.end()) {
             condition_variable_.wait(lock);
             continue;
         } else {
-            std::packaged_task<std::string()> task = std::move(tasks_.front());
-            tasks_.pop();
+            PendingTask pending = std::move(*it);
+            tasks_.erase(it);
             lock.unlock();
-            std::invoke(task);
+            std::invoke(pending.task);
             lock.lock();
+            if (!pending.duration_title.empty()) {
+                finished_.insert(pending.duration_title);
+                // Tasks waiting on this one may now be runnable on any thread.
+                condition_variable_.notify_all();
+            }
         }
     }
 }
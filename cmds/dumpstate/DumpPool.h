@@ -17,9 +17,11 @@
 #ifndef FRAMEWORK_NATIVE_CMD_DUMPPOOL_H_
 #define FRAMEWORK_NATIVE_CMD_DUMPPOOL_H_
 
+#include <deque>
 #include <future>
-#include <queue>
+#include <set>
 #include <string>
+#include <vector>
 
 #include <android-base/file.h>
 #include <android-base/macros.h>
@@ -69,6 +71,13 @@ inline void WaitForTask(std::future<std::string> future) {
  * enqueueTaskWithFd method in DumpPool to enqueue the task to the pool. The
  * std::placeholders::_1 is a placeholder for DumpPool to pass a fd argument.
  *
+ * Tasks that must not overlap with an earlier one can be enqueued with
+ * enqueueTaskAfter/enqueueTaskWithFdAfter, naming the duration titles of the
+ * tasks they depend on. Such a task is held back until all of its dependencies
+ * have finished, while independent tasks behind it keep running. The order of
+ * the results in the bugreport is still decided by the order of WaitForTask
+ * calls.
+ *
  * std::futures returned by `enqueueTask*()` must all have their `get` methods
  * called, or have been destroyed before the DumpPool itself is destroyed.
  */
@@ -94,7 +103,8 @@ class DumpPool {
     /*
      * Starts the threads in the pool.
      *
-     * |thread_counts| the number of threads to start.
+     * |thread_counts| the number of threads to start. It is capped by
+     * MAX_THREAD_COUNT and by the number of online CPUs.
      */
     void start(int thread_counts = MAX_THREAD_COUNT);
 
@@ -112,7 +122,7 @@ class DumpPool {
     std::future<std::string> enqueueTask(const std::string& duration_title, F&& f, Args&&... args) {
         std::function<void(void)> func = std::bind(std::forward<F>(f),
                 std::forward<Args>(args)...);
-        auto future = post(duration_title, func);
+        auto future = post(duration_title, {}, func);
         if (threads_.empty()) {
             start();
         }
@@ -132,7 +142,42 @@ class DumpPool {
             const std::string& duration_title, F&& f, Args&&... args) {
         std::function<void(int)> func = std::bind(std::forward<F>(f),
                 std::forward<Args>(args)...);
-        auto future = post(duration_title, func);
+        auto future = post(duration_title, {}, func);
+        if (threads_.empty()) {
+            start();
+        }
+        return future;
+    }
+
+    /*
+     * Same as enqueueTask, but the task does not start until every task named
+     * in |dependencies| has finished.
+     *
+     * |dependencies| Duration titles of previously enqueued tasks. Titles
+     * that were never enqueued are ignored.
+     */
+    template<class F, class... Args>
+    std::future<std::string> enqueueTaskAfter(const std::vector<std::string>& dependencies,
+            const std::string& duration_title, F&& f, Args&&... args) {
+        std::function<void(void)> func = std::bind(std::forward<F>(f),
+                std::forward<Args>(args)...);
+        auto future = post(duration_title, dependencies, func);
+        if (threads_.empty()) {
+            start();
+        }
+        return future;
+    }
+
+    /*
+     * Same as enqueueTaskWithFd, but the task does not start until every task
+     * named in |dependencies| has finished.
+     */
+    template<class F, class... Args> std::future<std::string> enqueueTaskWithFdAfter(
+            const std::vector<std::string>& dependencies, const std::string& duration_title,
+            F&& f, Args&&... args) {
+        std::function<void(int)> func = std::bind(std::forward<F>(f),
+                std::forward<Args>(args)...);
+        auto future = post(duration_title, dependencies, func);
         if (threads_.empty()) {
             start();
         }
@@ -151,8 +196,15 @@ class DumpPool {
 
     template<class T> void invokeTask(T dump_func, const std::string& duration_title, int out_fd);
 
+    struct PendingTask {
+        Task task;
+        std::string duration_title;
+        std::vector<std::string> dependencies;
+    };
+
     template<class T>
-    std::future<std::string> post(const std::string& duration_title, T dump_func) {
+    std::future<std::string> post(const std::string& duration_title,
+            const std::vector<std::string>& dependencies, T dump_func) {
         Task packaged_task([=]() {
             std::unique_ptr<TmpFile> tmp_file_ptr = createTempFile();
             if (!tmp_file_ptr) {
@@ -164,7 +216,11 @@ class DumpPool {
         });
         std::unique_lock lock(lock_);
         auto future = packaged_task.get_future();
-        tasks_.push(std::move(packaged_task));
+        tasks_.push_back({std::move(packaged_task), duration_title,
+                          knownDependenciesLocked(duration_title, dependencies)});
+        if (!duration_title.empty()) {
+            enqueued_.insert(duration_title);
+        }
         condition_variable_.notify_one();
         return future;
     }
@@ -179,6 +235,19 @@ class DumpPool {
     void setThreadName(const pthread_t thread, int id);
     void loop();
 
+    /*
+     * Drops dependencies on tasks that were never enqueued, so that a typo or
+     * a skipped section cannot hold a task back forever. Requires lock_.
+     */
+    std::vector<std::string> knownDependenciesLocked(const std::string& duration_title,
+            const std::vector<std::string>& dependencies);
+
+    /*
+     * Returns true if every dependency of |pending| has finished. Requires
+     * lock_.
+     */
+    bool isReadyLocked(const PendingTask& pending) const;
+
     /*
      * For test purpose only. Enables or disables logging duration of the task.
      *
@@ -194,11 +263,14 @@ class DumpPool {
     std::string tmp_root_;
     bool shutdown_;
     bool log_duration_; // For test purpose only, the default value is true.
-    std::mutex lock_;  // A lock for the tasks_.
+    std::mutex lock_;  // A lock for the tasks_, enqueued_ and finished_.
     std::condition_variable condition_variable_;
 
     std::vector<std::thread> threads_;
-    std::queue<Task> tasks_;
+    std::deque<PendingTask> tasks_;
+    /* Duration titles of every task enqueued so far, and of those that have finished. */
+    std::set<std::string> enqueued_;
+    std::set<std::string> finished_;
 
     DISALLOW_COPY_AND_ASSIGN(DumpPool);
 };
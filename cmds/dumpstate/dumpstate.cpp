@@ -252,6 +252,8 @@ static const std::string DUMP_NETSTATS_PROTO_TASK = "DUMP NETSTATS PROTO";
 static const std::string DUMP_HALS_TASK = "DUMP HALS";
 static const std::string DUMP_BOARD_TASK = "dumpstate_board()";
 static const std::string DUMP_CHECKINS_TASK = "DUMP CHECKINS";
+static const std::string DUMP_KERNEL_MODULES_TASK = "DUMP KERNEL MODULES";
+static const std::string DUMP_OPEN_FILES_TASK = "DUMP OPEN FILES";
 static const std::string SERIALIZE_PERFETTO_TRACE_TASK = "SERIALIZE PERFETTO TRACE";
 
 namespace android {
@@ -848,9 +850,16 @@ static const std::set<std::string> PROBLEMATIC_FILE_EXTENSIONS = {
       ".shb", ".sys", ".vb",  ".vbe", ".vbs", ".vxd", ".wsc", ".wsf", ".wsh"
 };
 
+// Extensions of files whose content is already compressed. Deflating them again costs CPU time on
+// the single zip writer thread and saves next to nothing, so they are stored as-is.
+static const std::set<std::string> COMPRESSED_FILE_EXTENSIONS = {
+      ".7z", ".br", ".bz2", ".gz", ".jpeg", ".jpg", ".lz4", ".png", ".webp", ".xz", ".zip", ".zst"
+};
+
 status_t Dumpstate::AddZipEntryFromFd(const std::string& entry_name, int fd,
                                       std::chrono::milliseconds timeout = 0ms) {
     std::string valid_name = entry_name;
+    size_t flags = ZipWriter::kCompress | ZipWriter::kDefaultCompression;
 
     // Rename extension if necessary.
     size_t idx = entry_name.rfind('.');
@@ -861,11 +870,13 @@ status_t Dumpstate::AddZipEntryFromFd(const std::string& entry_name, int fd,
             valid_name = entry_name + ".renamed";
             MYLOGI("Renaming entry %s to %s\n", entry_name.c_str(), valid_name.c_str());
         }
+        if (COMPRESSED_FILE_EXTENSIONS.count(extension) != 0) {
+            flags = 0;
+        }
     }
 
     // Logging statement  below is useful to time how long each entry takes, but it's too verbose.
     // MYLOGD("Adding zip entry %s\n", entry_name.c_str());
-    size_t flags = ZipWriter::kCompress | ZipWriter::kDefaultCompression;
     int32_t err = zip_writer_->StartEntryWithTime(valid_name.c_str(), flags,
                                                   get_mtime(fd, ds.now_));
     if (err != 0) {
@@ -1654,6 +1665,23 @@ static void DumpAppInfos(int out_fd = STDOUT_FILENO) {
             DUMPSYS_COMPONENTS_OPTIONS, 0, out_fd);
 }
 
+static void DumpKernelModules(int out_fd = STDOUT_FILENO) {
+    struct stat s;
+    if (stat("/proc/modules", &s) != 0) {
+        MYLOGD("Skipping 'lsmod' because /proc/modules does not exist\n");
+        return;
+    }
+    RunCommand("LSMOD", {"lsmod"}, CommandOptions::DEFAULT, false, out_fd);
+    RunCommand("MODULES INFO",
+               {"sh", "-c", "cat /proc/modules | cut -d' ' -f1 | "
+                "    while read MOD ; do echo modinfo:$MOD ; modinfo $MOD ; "
+                "done"}, CommandOptions::AS_ROOT, false, out_fd);
+}
+
+static void DumpOpenFiles(int out_fd = STDOUT_FILENO) {
+    RunCommand("LIST OF OPEN FILES", {"lsof"}, CommandOptions::AS_ROOT, false, out_fd);
+}
+
 // Dumps various things. Returns early with status USER_CONSENT_DENIED if user denies consent
 // via the consent they are shown. Ignores other errors that occur while running various
 // commands. The consent checking is currently done around long running tasks, which happen to
@@ -1663,20 +1691,26 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
 
     // Enqueue slow functions into the thread pool, if the parallel run is enabled.
     std::future<std::string> dump_hals, dump_incident_report, dump_board, dump_checkins,
-        dump_netstats_report;
+        dump_netstats_report, dump_kernel_modules, dump_open_files;
     if (ds.dump_pool_) {
         // Pool was shutdown in DumpstateDefaultAfterCritical method in order to
         // drop root user. Restarts it.
-        ds.dump_pool_->start(/* thread_counts = */3);
+        ds.dump_pool_->start(/* thread_counts = */4);
 
         dump_hals = ds.dump_pool_->enqueueTaskWithFd(DUMP_HALS_TASK, &DumpHals, _1);
         dump_incident_report = ds.dump_pool_->enqueueTask(
             DUMP_INCIDENT_REPORT_TASK, &DumpIncidentReport);
-        dump_netstats_report = ds.dump_pool_->enqueueTask(
-            DUMP_NETSTATS_PROTO_TASK, &DumpNetstatsProto);
         dump_board = ds.dump_pool_->enqueueTaskWithFd(
             DUMP_BOARD_TASK, &Dumpstate::DumpstateBoard, &ds, _1);
         dump_checkins = ds.dump_pool_->enqueueTaskWithFd(DUMP_CHECKINS_TASK, &DumpCheckins, _1);
+        // Both the checkins and the proto dump go through NetworkStatsService; running them
+        // back to back keeps them from contending on its lock.
+        dump_netstats_report = ds.dump_pool_->enqueueTaskAfter(
+            {DUMP_CHECKINS_TASK}, DUMP_NETSTATS_PROTO_TASK, &DumpNetstatsProto);
+        dump_kernel_modules = ds.dump_pool_->enqueueTaskWithFd(
+            DUMP_KERNEL_MODULES_TASK, &DumpKernelModules, _1);
+        dump_open_files = ds.dump_pool_->enqueueTaskWithFd(
+            DUMP_OPEN_FILES_TASK, &DumpOpenFiles, _1);
     }
 
     // Dump various things. Note that anything that takes "long" (i.e. several seconds) should
@@ -1718,15 +1752,10 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
 
     RunCommand("PRINTENV", {"printenv"});
     RunCommand("NETSTAT", {"netstat", "-nW"});
-    struct stat s;
-    if (stat("/proc/modules", &s) != 0) {
-        MYLOGD("Skipping 'lsmod' because /proc/modules does not exist\n");
+    if (ds.dump_pool_) {
+        WAIT_TASK_WITH_CONSENT_CHECK(std::move(dump_kernel_modules));
     } else {
-        RunCommand("LSMOD", {"lsmod"});
-        RunCommand("MODULES INFO",
-                   {"sh", "-c", "cat /proc/modules | cut -d' ' -f1 | "
-                    "    while read MOD ; do echo modinfo:$MOD ; modinfo $MOD ; "
-                    "done"}, CommandOptions::AS_ROOT);
+        RUN_SLOW_FUNCTION_AND_LOG(DUMP_KERNEL_MODULES_TASK, DumpKernelModules);
     }
 
     if (android::base::GetBoolProperty("ro.logd.kernel", false)) {
@@ -1737,7 +1766,11 @@ Dumpstate::RunStatus Dumpstate::dumpstate() {
 
     DumpVintf();
 
-    RunCommand("LIST OF OPEN FILES", {"lsof"}, CommandOptions::AS_ROOT);
+    if (ds.dump_pool_) {
+        WAIT_TASK_WITH_CONSENT_CHECK(std::move(dump_open_files));
+    } else {
+        RUN_SLOW_FUNCTION_AND_LOG(DUMP_OPEN_FILES_TASK, DumpOpenFiles);
+    }
 
     for_each_tid(show_wchan, "BLOCKED PROCESS WAIT-CHANNELS");
     for_each_pid(show_showtime, "PROCESS TIMES (pid cmd user system iowait+percentage)");
@@ -38,6 +38,7 @@
 #include <unistd.h>
 #include <ziparchive/zip_archive.h>
 
+#include <atomic>
 #include <filesystem>
 #include <thread>
 
@@ -1782,6 +1783,38 @@ TEST_F(DumpPoolTest, EnqueueTask_withDurationLog) {
     EXPECT_THAT(getTempFileCounts(kTestDataPath), Eq(0));
 }
 
+TEST_F(DumpPoolTest, EnqueueTaskAfter_waitsForDependencies) {
+    std::atomic<bool> first_done = false;
+    std::atomic<bool> ran_after_first = false;
+    auto dump_func_1 = [&]() {
+        sleep(1);
+        first_done = true;
+    };
+    auto dump_func_2 = [&](int out_fd) {
+        ran_after_first = first_done.load();
+        dprintf(out_fd, "B");
+    };
+    auto dump_func_3 = [](int out_fd) {
+        dprintf(out_fd, "C");
+    };
+    setLogDuration(/* log_duration = */false);
+    dump_pool_->start(/* thread_counts = */2);
+    auto t1 = dump_pool_->enqueueTask("1", dump_func_1);
+    auto t2 = dump_pool_->enqueueTaskWithFdAfter({"1", "unknown"}, "2", dump_func_2,
+                                                 std::placeholders::_1);
+    auto t3 = dump_pool_->enqueueTaskWithFd("3", dump_func_3, std::placeholders::_1);
+
+    WaitForTask(std::move(t3), "", out_fd_.get());
+    WaitForTask(std::move(t2), "", out_fd_.get());
+    WaitForTask(std::move(t1), "", out_fd_.get());
+
+    std::string result;
+    ReadFileToString(out_path_, &result);
+    EXPECT_TRUE(ran_after_first);
+    EXPECT_THAT(result, StrEq("C\nB\n"));
+    EXPECT_THAT(getTempFileCounts(kTestDataPath), Eq(0));
+}
+
 class TaskQueueTest : public DumpstateBaseTest {
 public:
     void SetUp() {
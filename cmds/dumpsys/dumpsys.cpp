@@ -15,8 +15,11 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <iomanip>
+#include <mutex>
 #include <thread>
 
 #include <android-base/file.h>
@@ -36,6 +39,7 @@
 #include <iostream>
 #include <fcntl.h>
 #include <getopt.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -66,13 +70,15 @@ static void usage() {
         "         To dump all services.\n"
         "or:\n"
         "       dumpsys [-t TIMEOUT] [--priority LEVEL] [--clients] [--dump] [--pid] [--thread] "
-        "[--help | "
+        "[--binder-stats] [--parallel N] [--help | "
         "-l | --skip SERVICES "
         "| SERVICE [ARGS]]\n"
         "         --help: shows this help\n"
         "         -l: only list services, do not dump them\n"
         "         -t TIMEOUT_SEC: TIMEOUT to use in seconds instead of default 10 seconds\n"
         "         -T TIMEOUT_MS: TIMEOUT to use in milliseconds instead of default 10 seconds\n"
+        "         --binder-stats: dump the binder transaction statistics of the server process\n"
+        "               instead of usual dump\n"
         "         --clients: dump client PIDs instead of usual dump\n"
         "         --dump: ask the service to dump itself (this is the default)\n"
         "         --pid: dump PID instead of usual dump\n"
@@ -83,6 +89,8 @@ static void usage() {
         "         --skip SERVICES: dumps all services but SERVICES (comma-separated list)\n"
         "         --stability: dump binder stability information instead of usual dump\n"
         "         --thread: dump thread usage instead of usual dump\n"
+        "         --parallel N: when dumping several services, dump up to N of them at once.\n"
+        "               Output order and per-service timeouts are unchanged\n"
         "         SERVICE [ARGS]: dumps only service SERVICE, optionally passing ARGS to it\n");
 }
 
@@ -135,13 +143,15 @@ int Dumpsys::main(int argc, char* const argv[]) {
     bool asProto = false;
     int dumpTypeFlags = 0;
     int timeoutArgMs = 10000;
+    int parallelDumps = 1;
     int priorityFlags = IServiceManager::DUMP_FLAG_PRIORITY_ALL;
     static struct option longOptions[] = {
         {"help", no_argument, 0, 0},           {"clients", no_argument, 0, 0},
         {"dump", no_argument, 0, 0},           {"pid", no_argument, 0, 0},
         {"priority", required_argument, 0, 0}, {"proto", no_argument, 0, 0},
         {"skip", no_argument, 0, 0},           {"stability", no_argument, 0, 0},
-        {"thread", no_argument, 0, 0},         {0, 0, 0, 0}};
+        {"thread", no_argument, 0, 0},         {"parallel", required_argument, 0, 0},
+        {"binder-stats", no_argument, 0, 0},   {0, 0, 0, 0}};
 
     // Must reset optind, otherwise subsequent calls will fail (wouldn't happen on main.cpp, but
     // happens on test cases).
@@ -182,6 +192,15 @@ int Dumpsys::main(int argc, char* const argv[]) {
                 dumpTypeFlags |= TYPE_THREAD;
             } else if (!strcmp(longOptions[optionIndex].name, "clients")) {
                 dumpTypeFlags |= TYPE_CLIENTS;
+            } else if (!strcmp(longOptions[optionIndex].name, "binder-stats")) {
+                dumpTypeFlags |= TYPE_BINDER_STATS;
+            } else if (!strcmp(longOptions[optionIndex].name, "parallel")) {
+                char* endptr;
+                parallelDumps = strtol(optarg, &endptr, 10);
+                if (*endptr != '\0' || parallelDumps <= 0) {
+                    fprintf(stderr, "Error: invalid parallel dump count: '%s'\n", optarg);
+                    return -1;
+                }
             }
             break;
 
@@ -271,6 +290,17 @@ int Dumpsys::main(int argc, char* const argv[]) {
         return 0;
     }
 
+    if (parallelDumps > 1 && N > 1) {
+        Vector<String16> toDump;
+        for (const auto& serviceName : services) {
+            if (!IsSkipped(skippedServices, serviceName)) toDump.add(serviceName);
+        }
+        dumpServicesInParallel(STDOUT_FILENO, toDump, dumpTypeFlags, args, priorityFlags,
+                               std::chrono::milliseconds(timeoutArgMs), asProto, parallelDumps,
+                               /*addSeparator=*/true);
+        return 0;
+    }
+
     for (size_t i = 0; i < N; i++) {
         const String16& serviceName = services[i];
         if (IsSkipped(skippedServices, serviceName)) continue;
@@ -406,6 +436,48 @@ static status_t dumpClientsToFd(const sp<IBinder>& service, const unique_fd& fd)
     return OK;
 }
 
+static void appendBinderStatsDirection(std::string* out, const char* name,
+                                       const BinderTransactionStats::Direction& d) {
+    StringAppendF(out,
+                  "  %s: calls=%" PRIu64 " oneway=%" PRIu64 " errors=%" PRIu64
+                  " data=%" PRIu64 "B reply=%" PRIu64 "B\n",
+                  name, d.calls, d.onewayCalls, d.errors, d.dataBytes, d.replyBytes);
+    // Buckets are labelled with their lower bound, and only printed when non-empty.
+    out->append("    latency(us):");
+    for (size_t i = 0; i < d.latencyHistogram.size(); i++) {
+        if (d.latencyHistogram[i] == 0) continue;
+        StringAppendF(out, " %s%" PRIu64 "=%" PRIu64,
+                      i == d.latencyHistogram.size() - 1 ? ">=" : "", uint64_t{1} << i,
+                      d.latencyHistogram[i]);
+    }
+    out->append("\n    codes:");
+    for (size_t i = 0; i < d.callsPerCode.size(); i++) {
+        if (d.callsPerCode[i] == 0) continue;
+        if (i == BinderTransactionStats::kTrackedCodes) {
+            StringAppendF(out, " other=%" PRIu64, d.callsPerCode[i]);
+        } else {
+            StringAppendF(out, " %zu=%" PRIu64, i + IBinder::FIRST_CALL_TRANSACTION,
+                          d.callsPerCode[i]);
+        }
+    }
+    out->append("\n");
+}
+
+static status_t dumpBinderStatsToFd(const sp<IBinder>& service, const unique_fd& fd) {
+    BinderTransactionStats stats;
+    status_t status = getBinderTransactionStats(service, &stats);
+    if (status != OK) {
+        return status;
+    }
+    std::string out = "Binder transaction stats:\n";
+    appendBinderStatsDirection(&out, "outgoing", stats.outgoing);
+    appendBinderStatsDirection(&out, "incoming", stats.incoming);
+    StringAppendF(&out, "  oneway in flight: %" PRIu32 " (max %" PRIu32 ")\n",
+                  stats.onewayInFlight, stats.maxOnewayInFlight);
+    WriteStringToFd(out, fd.get());
+    return OK;
+}
+
 static void reportDumpError(const String16& serviceName, status_t error, const char* context) {
     if (error == OK) return;
 
@@ -415,6 +487,12 @@ static void reportDumpError(const String16& serviceName, status_t error, const c
 
 status_t Dumpsys::startDumpThread(int dumpTypeFlags, const String16& serviceName,
                                   const Vector<String16>& args) {
+    return startDumpThread(dumpTypeFlags, serviceName, args, &activeThread_, &redirectFd_);
+}
+
+status_t Dumpsys::startDumpThread(int dumpTypeFlags, const String16& serviceName,
+                                  const Vector<String16>& args, std::thread* thread,
+                                  unique_fd* redirectFd) {
     sp<IBinder> service = sm_->checkService(serviceName);
     if (service == nullptr) {
         std::cerr << "Can't find service: " << serviceName << std::endl;
@@ -428,12 +506,12 @@ status_t Dumpsys::startDumpThread(int dumpTypeFlags, const String16& serviceName
         return -errno;
     }
 
-    redirectFd_ = unique_fd(sfd[0]);
+    *redirectFd = unique_fd(sfd[0]);
     unique_fd remote_end(sfd[1]);
     sfd[0] = sfd[1] = -1;
 
     // dump blocks until completion, so spawn a thread..
-    activeThread_ = std::thread([=, remote_end{std::move(remote_end)}]() mutable {
+    *thread = std::thread([=, remote_end{std::move(remote_end)}]() mutable {
         if (dumpTypeFlags & TYPE_PID) {
             status_t err = dumpPidToFd(service, remote_end, dumpTypeFlags == TYPE_PID);
             reportDumpError(serviceName, err, "dumping PID");
@@ -450,6 +528,10 @@ status_t Dumpsys::startDumpThread(int dumpTypeFlags, const String16& serviceName
             status_t err = dumpClientsToFd(service, remote_end);
             reportDumpError(serviceName, err, "dumping clients info");
         }
+        if (dumpTypeFlags & TYPE_BINDER_STATS) {
+            status_t err = dumpBinderStatsToFd(service, remote_end);
+            reportDumpError(serviceName, err, "dumping binder stats");
+        }
 
         // other types always act as a header, this is usually longer
         if (dumpTypeFlags & TYPE_DUMP) {
@@ -486,19 +568,43 @@ void Dumpsys::writeDumpHeader(int fd, const String16& serviceName, int priorityF
     WriteStringToFd(msg, fd);
 }
 
+static std::string timeoutMessage(const String16& serviceName, std::chrono::milliseconds timeout) {
+    return StringPrintf("\n*** SERVICE '%s' DUMP TIMEOUT (%llums) EXPIRED ***\n\n",
+                        String8(serviceName).c_str(), timeout.count());
+}
+
 status_t Dumpsys::writeDump(int fd, const String16& serviceName, std::chrono::milliseconds timeout,
                             bool asProto, std::chrono::duration<double>& elapsedDuration,
                             size_t& bytesWritten) const {
-    status_t status = OK;
-    size_t totalBytes = 0;
     auto start = std::chrono::steady_clock::now();
-    auto end = start + timeout;
 
     int serviceDumpFd = redirectFd_.get();
     if (serviceDumpFd == -1) {
         return INVALID_OPERATION;
     }
 
+    status_t status = readDump(serviceDumpFd, serviceName, timeout,
+                               [fd](const char* buf, size_t len) {
+                                   return WriteFully(fd, buf, len);
+                               },
+                               bytesWritten);
+
+    if ((status == TIMED_OUT) && (!asProto)) {
+        WriteStringToFd(timeoutMessage(serviceName, timeout), fd);
+    }
+
+    elapsedDuration = std::chrono::steady_clock::now() - start;
+    return status;
+}
+
+status_t Dumpsys::readDump(int serviceDumpFd, const String16& serviceName,
+                           std::chrono::milliseconds timeout,
+                           const std::function<bool(const char*, size_t)>& output,
+                           size_t& bytesRead) const {
+    status_t status = OK;
+    size_t totalBytes = 0;
+    auto end = std::chrono::steady_clock::now() + timeout;
+
     struct pollfd pfd = {.fd = serviceDumpFd, .events = POLLIN};
 
     while (true) {
@@ -521,7 +627,7 @@ status_t Dumpsys::writeDump(int fd, const String16& serviceName, std::chrono::mi
         }
 
         char buf[4096];
-        rc = TEMP_FAILURE_RETRY(read(redirectFd_.get(), buf, sizeof(buf)));
+        rc = TEMP_FAILURE_RETRY(read(serviceDumpFd, buf, sizeof(buf)));
         if (rc < 0) {
             std::cerr << "Failed to read while dumping service " << serviceName << ": "
                  << strerror(errno) << std::endl;
@@ -532,7 +638,7 @@ status_t Dumpsys::writeDump(int fd, const String16& serviceName, std::chrono::mi
             break;
         }
 
-        if (!WriteFully(fd, buf, rc)) {
+        if (!output(buf, rc)) {
             std::cerr << "Failed to write while dumping service " << serviceName << ": "
                  << strerror(errno) << std::endl;
             status = -errno;
@@ -541,14 +647,7 @@ status_t Dumpsys::writeDump(int fd, const String16& serviceName, std::chrono::mi
         totalBytes += rc;
     }
 
-    if ((status == TIMED_OUT) && (!asProto)) {
-        std::string msg = StringPrintf("\n*** SERVICE '%s' DUMP TIMEOUT (%llums) EXPIRED ***\n\n",
-                                       String8(serviceName).c_str(), timeout.count());
-        WriteStringToFd(msg, fd);
-    }
-
-    elapsedDuration = std::chrono::steady_clock::now() - start;
-    bytesWritten = totalBytes;
+    bytesRead = totalBytes;
     return status;
 }
 
@@ -565,3 +664,113 @@ void Dumpsys::writeDumpFooter(int fd, const String16& serviceName,
                      elapsedDuration.count(), String8(serviceName).c_str(), oss.str().c_str());
     WriteStringToFd(msg, fd);
 }
+
+namespace {
+// Output of one service dumped by dumpServicesInParallel(), handed from the worker dumping it to
+// the thread writing the sections out in order.
+struct ParallelDump {
+    std::mutex lock;
+    std::condition_variable changed;
+    // Dump output not yet written out.
+    std::string pending;
+    // Set once the dump thread is running; a service that never starts gets no section.
+    bool started = false;
+    bool done = false;
+    status_t status = OK;
+    std::chrono::duration<double> elapsedDuration{};
+};
+} // namespace
+
+void Dumpsys::dumpServicesInParallel(int fd, const Vector<String16>& services, int dumpTypeFlags,
+                                     const Vector<String16>& args, int priorityFlags,
+                                     std::chrono::milliseconds timeout, bool asProto,
+                                     size_t parallelism, bool addSeparator) {
+    std::vector<ParallelDump> dumps(services.size());
+    std::atomic<size_t> next = 0;
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < services.size(); i = next++) {
+            ParallelDump& dump = dumps[i];
+            std::thread dumpThread;
+            unique_fd dumpFd;
+            auto start = std::chrono::steady_clock::now();
+            status_t status =
+                    startDumpThread(dumpTypeFlags, services[i], args, &dumpThread, &dumpFd);
+            if (status == OK) {
+                {
+                    std::lock_guard<std::mutex> guard(dump.lock);
+                    dump.started = true;
+                }
+                dump.changed.notify_all();
+                auto append = [&dump](const char* buf, size_t len) {
+                    {
+                        std::lock_guard<std::mutex> guard(dump.lock);
+                        dump.pending.append(buf, len);
+                    }
+                    dump.changed.notify_all();
+                    return true;
+                };
+                size_t bytesRead = 0;
+                status = readDump(dumpFd.get(), services[i], timeout, append, bytesRead);
+                if ((status == TIMED_OUT) && (!asProto)) {
+                    std::string msg = timeoutMessage(services[i], timeout);
+                    append(msg.c_str(), msg.size());
+                }
+                if (status == OK) {
+                    dumpThread.join();
+                } else {
+                    dumpThread.detach();
+                }
+            }
+            {
+                std::lock_guard<std::mutex> guard(dump.lock);
+                dump.status = status;
+                dump.elapsedDuration = std::chrono::steady_clock::now() - start;
+                dump.done = true;
+            }
+            dump.changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(parallelism, dumps.size()); i++) {
+        workers.emplace_back(worker);
+    }
+
+    for (size_t i = 0; i < dumps.size(); i++) {
+        ParallelDump& dump = dumps[i];
+        std::unique_lock<std::mutex> guard(dump.lock);
+        dump.changed.wait(guard, [&dump] { return dump.started || dump.done; });
+        if (!dump.started) {
+            continue;
+        }
+        if (addSeparator) {
+            writeDumpHeader(fd, services[i], priorityFlags);
+        }
+        while (true) {
+            dump.changed.wait(guard, [&dump] { return !dump.pending.empty() || dump.done; });
+            std::string chunk = std::move(dump.pending);
+            dump.pending.clear();
+            bool done = dump.done;
+            guard.unlock();
+            if (!chunk.empty() && !WriteFully(fd, chunk.data(), chunk.size())) {
+                std::cerr << "Failed to write while dumping service " << services[i] << ": "
+                          << strerror(errno) << std::endl;
+            }
+            guard.lock();
+            if (done && dump.pending.empty()) {
+                break;
+            }
+        }
+        if (dump.status == TIMED_OUT) {
+            WriteStringToFd(timeoutMessage(services[i], timeout), fd);
+        }
+        if (addSeparator) {
+            writeDumpFooter(fd, services[i], dump.elapsedDuration);
+        }
+    }
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
@@ -17,6 +17,7 @@
 #ifndef FRAMEWORK_NATIVE_CMD_DUMPSYS_H_
 #define FRAMEWORK_NATIVE_CMD_DUMPSYS_H_
 
+#include <functional>
 #include <thread>
 
 #include <android-base/unique_fd.h>
@@ -52,11 +53,12 @@ class Dumpsys {
     static void setServiceArgs(Vector<String16>& args, bool asProto, int priorityFlags);
 
     enum Type {
-        TYPE_DUMP = 0x1,       // dump using `dump` function
-        TYPE_PID = 0x2,        // dump pid of server only
-        TYPE_STABILITY = 0x4,  // dump stability information of server
-        TYPE_THREAD = 0x8,     // dump thread usage of server only
-        TYPE_CLIENTS = 0x10,   // dump pid of clients
+        TYPE_DUMP = 0x1,          // dump using `dump` function
+        TYPE_PID = 0x2,           // dump pid of server only
+        TYPE_STABILITY = 0x4,     // dump stability information of server
+        TYPE_THREAD = 0x8,        // dump thread usage of server only
+        TYPE_CLIENTS = 0x10,      // dump pid of clients
+        TYPE_BINDER_STATS = 0x20, // dump binder transaction stats of server
     };
 
     /**
@@ -125,7 +127,38 @@ class Dumpsys {
         return redirectFd_.get();
     }
 
+    /**
+     * Dumps several services with up to {@code parallelism} dumps running at once. Output is
+     * written to {@code fd} in the order of {@code services}; a section is streamed while it is
+     * being produced once every section before it is complete, and buffered otherwise. Each
+     * service gets the full {@code timeout}, counted from the start of its own dump.
+     * @param fd file descriptor to write data
+     * @param services services to dump, in output order
+     * @param dumpTypeFlags operations to perform
+     * @param args list of arguments to pass to service dump method.
+     * @param priorityFlags dump priority specified, used for section headers
+     * @param timeout timeout to terminate each dump if not completed
+     * @param asProto used to supresses additional output to the fd such as timeout
+     * error messages
+     * @param parallelism maximum number of services dumped concurrently
+     * @param addSeparator if {@code true}, writes a header and footer around each section
+     */
+    void dumpServicesInParallel(int fd, const Vector<String16>& services, int dumpTypeFlags,
+                                const Vector<String16>& args, int priorityFlags,
+                                std::chrono::milliseconds timeout, bool asProto,
+                                size_t parallelism, bool addSeparator);
+
   private:
+    status_t startDumpThread(int dumpTypeFlags, const String16& serviceName,
+                             const Vector<String16>& args, std::thread* thread,
+                             android::base::unique_fd* redirectFd);
+
+    // Reads a service dump from serviceDumpFd until EOF or timeout, handing each chunk to output.
+    status_t readDump(int serviceDumpFd, const String16& serviceName,
+                      std::chrono::milliseconds timeout,
+                      const std::function<bool(const char*, size_t)>& output,
+                      size_t& bytesRead) const;
+
     android::IServiceManager* sm_;
     std::thread activeThread_;
     mutable android::base::unique_fd redirectFd_;
@@ -117,6 +117,7 @@ pub struct AbsoluteAxisInfo {
 }
 
 #[repr(C)]
+#[derive(Clone, Copy)]
 pub struct InputEvent {
     pub time: TimeVal,
     pub type_: u16,
@@ -278,22 +279,23 @@ impl Device {
         .map(|_| info)
     }
 
-    pub fn read_event(&self) -> nix::Result<InputEvent> {
-        let mut event = InputEvent::default();
-
+    /// Reads as many events as are available, up to the length of `events`, with a single read
+    /// call. Blocks until at least one event is available. Returns the number of events read.
+    pub fn read_events(&self, events: &mut [InputEvent]) -> nix::Result<usize> {
         // SAFETY:
         // We know that fd is a valid file descriptor as it comes from a File that we have open.
         //
-        // We know that the pointer to event is valid because we just allocated it, and that the
-        // data structures match up because InputEvent is repr(C) and all its members are repr(C)
-        // or primitives that support all representations without niches.
+        // We know that the pointer to events is valid for mem::size_of_val(events) bytes because
+        // it comes from a mutable slice, and that the data structures match up because
+        // InputEvent is repr(C) and all its members are repr(C) or primitives that support all
+        // representations without niches. evdev only returns whole events.
         nix::errno::Errno::result(unsafe {
             libc::read(
                 self.fd.as_raw_fd(),
-                &mut event as *mut _ as *mut std::ffi::c_void,
-                mem::size_of::<InputEvent>(),
+                events.as_mut_ptr() as *mut std::ffi::c_void,
+                mem::size_of_val(events),
             )
         })
-        .map(|_| event)
+        .map(|len| len as usize / mem::size_of::<InputEvent>())
     }
 }
@@ -162,6 +162,10 @@ fn print_device_description(
     Ok(())
 }
 
+/// The most events read from the device at once. evdev's own buffer is sized for at least 8
+/// packets; this drains a few of them per read.
+const EVENT_BATCH_SIZE: usize = 64;
+
 fn print_events(
     device: &evdev::Device,
     output: &mut impl Write,
@@ -180,20 +184,26 @@ fn print_events(
         )?;
         Ok(())
     }
-    let event = device.read_event()?;
-    let start_time = match timestamp_base {
-        // Due to a bug in the C implementation of evemu-play [0] that has since become part of the
-        // API, the timestamp of the first event in a recording shouldn't be exactly 0.0 seconds,
-        // so offset it by 1µs.
-        //
-        // [0]: https://gitlab.freedesktop.org/libevdev/evemu/-/commit/eba96a4d2be7260b5843e65c4b99c8b06a1f4c9d
-        TimestampBase::FirstEvent => event.time - TimeVal::new(0, 1),
-        TimestampBase::Boot => TimeVal::new(0, 0),
-    };
-    print_event(output, &event.offset_time_by(start_time))?;
+    // Events are read in batches, as many as the kernel has queued, so that a busy device costs
+    // one read and one write per batch rather than per event.
+    let mut events = [evdev::InputEvent::default(); EVENT_BATCH_SIZE];
+    let mut start_time = None;
     loop {
-        let event = device.read_event()?;
-        print_event(output, &event.offset_time_by(start_time))?;
+        let count = device.read_events(&mut events)?;
+        for event in &events[..count] {
+            let start_time = *start_time.get_or_insert_with(|| match timestamp_base {
+                // Due to a bug in the C implementation of evemu-play [0] that has since become part
+                // of the API, the timestamp of the first event in a recording shouldn't be exactly
+                // 0.0 seconds, so offset it by 1µs.
+                //
+                // [0]: https://gitlab.freedesktop.org/libevdev/evemu/-/commit/eba96a4d2be7260b5843e65c4b99c8b06a1f4c9d
+                TimestampBase::FirstEvent => event.time - TimeVal::new(0, 1),
+                TimestampBase::Boot => TimeVal::new(0, 0),
+            });
+            print_event(output, &event.offset_time_by(start_time))?;
+        }
+        // Flush after every batch, so that the recording is complete whenever it is interrupted.
+        output.flush()?;
     }
 }
 
@@ -203,11 +213,12 @@ fn main() -> Result<(), Box<dyn Error>> {
     let device_path = args.device.unwrap_or_else(|| pick_input_device().unwrap());
 
     let device = evdev::Device::open(device_path.as_path())?;
-    let mut output = match args.output_file {
+    let mut output = io::BufWriter::new(match args.output_file {
         Some(path) => Box::new(fs::File::create(path)?) as Box<dyn Write>,
         None => Box::new(io::stdout().lock()),
-    };
+    });
     print_device_description(&device, &mut output)?;
+    output.flush()?;
     print_events(&device, &mut output, args.timestamp_base)?;
     Ok(())
 }
@@ -50,12 +50,15 @@ public:
     void loadItems();
 
     void ensureItems();
+    // Removes and returns the item that should be purged next, or nullptr once none remain.
+    std::shared_ptr<CacheItem> popItem();
 
     int getCacheRatio();
 
     int64_t cacheUsed;
     int64_t cacheQuota;
 
+    // Loaded items, kept as a heap ordered by compareItems(); use popItem() to consume them.
     std::vector<std::shared_ptr<CacheItem>> items;
 
 private:
@@ -68,6 +71,8 @@ private:
 
     bool loadQuotaStats();
     void loadItemsFrom(const std::string& path);
+    static bool compareItems(const std::shared_ptr<CacheItem>& left,
+                             const std::shared_ptr<CacheItem>& right);
 
     DISALLOW_COPY_AND_ASSIGN(CacheTracker);
 };
@@ -19,6 +19,7 @@
 #include <errno.h>
 #include <fts.h>
 #include <inttypes.h>
+#include <linux/fs.h>
 #include <linux/fsverity.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,6 +37,8 @@
 #include <sys/xattr.h>
 #include <unistd.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -98,6 +101,9 @@ static constexpr const char* kTestUuid = "TEST";
 
 static constexpr const mode_t kRollbackFolderMode = 0700;
 
+// Upper bound on the threads createAppDataBatched uses to prepare packages concurrently.
+static constexpr const size_t kMaxCreateAppDataThreads = 4;
+
 static constexpr const char* kCpPath = "/system/bin/cp";
 static constexpr const char* kXattrDefault = "user.default";
 
@@ -323,8 +329,8 @@ struct LocalLockHolder {
     using Map = std::unordered_map<Key, WeakPointer>;
     using MapLock = std::recursive_mutex;
 
-    LocalLockHolder(Key key, Map& map, MapLock& mapLock)
-          : mKey(std::move(key)), mMap(map), mMapLock(mapLock) {
+    LocalLockHolder(Key key, Map& map, MapLock& mapLock, LockWaitStats& stats)
+          : mKey(std::move(key)), mMap(map), mMapLock(mapLock), mStats(stats) {
         std::lock_guard lock(mMapLock);
         auto& weakPtr = mMap[mKey];
 
@@ -340,6 +346,7 @@ struct LocalLockHolder {
           : mKey(std::move(other.mKey)),
             mMap(other.mMap),
             mMapLock(other.mMapLock),
+            mStats(other.mStats),
             mRefLock(std::move(other.mRefLock)) {
         other.mRefLock.reset();
     }
@@ -362,15 +369,35 @@ struct LocalLockHolder {
         }
     }
 
-    void lock() { mRefLock->lock(); }
+    void lock() {
+        timedLock([this] { return mRefLock->try_lock(); }, [this] { mRefLock->lock(); });
+    }
     void unlock() { mRefLock->unlock(); }
-    void lock_shared() { mRefLock->lock_shared(); }
+    void lock_shared() {
+        timedLock([this] { return mRefLock->try_lock_shared(); },
+                  [this] { mRefLock->lock_shared(); });
+    }
     void unlock_shared() { mRefLock->unlock_shared(); }
 
 private:
+    // Only contended acquisitions read the clock, so the uncontended path stays a try-lock.
+    template <class TryLock, class Lock>
+    void timedLock(TryLock tryLock, Lock lock) {
+        if (tryLock()) {
+            mStats.recordWait(0);
+            return;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        lock();
+        mStats.recordWait(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - start)
+                                  .count());
+    }
+
     Key mKey;
     Map& mMap;
     MapLock& mMapLock;
+    LockWaitStats& mStats;
     StrongPointer mRefLock;
 };
 
@@ -381,16 +408,16 @@ using UserReadLockGuard = std::shared_lock<UserLock>;
 using PackageLock = LocalLockHolder<std::string, std::recursive_mutex>;
 using PackageLockGuard = std::lock_guard<PackageLock>;
 
-#define LOCK_USER()                                     \
-    UserLock localUserLock(userId, mUserIdLock, mLock); \
+#define LOCK_USER()                                                     \
+    UserLock localUserLock(userId, mUserIdLock, mLock, mUserLockStats); \
     UserWriteLockGuard userLock(localUserLock)
 
-#define LOCK_USER_READ()                                \
-    UserLock localUserLock(userId, mUserIdLock, mLock); \
+#define LOCK_USER_READ()                                                    \
+    UserLock localUserLock(userId, mUserIdLock, mLock, mUserReadLockStats); \
     UserReadLockGuard userLock(localUserLock)
 
-#define LOCK_PACKAGE()                                                  \
-    PackageLock localPackageLock(packageName, mPackageNameLock, mLock); \
+#define LOCK_PACKAGE()                                                                     \
+    PackageLock localPackageLock(packageName, mPackageNameLock, mLock, mPackageLockStats); \
     PackageLockGuard packageLock(localPackageLock)
 
 #define LOCK_PACKAGE_USER() \
@@ -467,10 +494,39 @@ status_t InstalldNativeService::dump(int fd, const Vector<String16>& /* args */)
     }
 
     dprintf(fd, "is_dexopt_blocked:%d\n", android::installd::is_dexopt_blocked());
+    android::installd::dump_dexopt_jobs(fd);
+
+    dprintf(fd, "Lock waits:\n");
+    mUserLockStats.dump(fd, "user");
+    mUserReadLockStats.dump(fd, "user (shared)");
+    mPackageLockStats.dump(fd, "package");
 
     return NO_ERROR;
 }
 
+void LockWaitStats::recordWait(int64_t waitNs) {
+    acquisitions++;
+    if (waitNs == 0) {
+        return;
+    }
+    contentions++;
+    totalWaitNs += waitNs;
+    int64_t max = maxWaitNs.load();
+    while (waitNs > max && !maxWaitNs.compare_exchange_weak(max, waitNs)) {
+    }
+}
+
+void LockWaitStats::dump(int fd, const char* name) const {
+    const uint64_t contended = contentions.load();
+    const int64_t totalWaitUs = totalWaitNs.load() / 1000;
+    dprintf(fd,
+            "    %s: acquisitions=%" PRIu64 " contended=%" PRIu64 " totalWait=%" PRId64
+            "us avgWait=%" PRId64 "us maxWait=%" PRId64 "us\n",
+            name, acquisitions.load(), contended, totalWaitUs,
+            contended ? totalWaitUs / static_cast<int64_t>(contended) : 0,
+            maxWaitNs.load() / 1000);
+}
+
 constexpr const char kXattrRestoreconInProgress[] = "user.restorecon_in_progress";
 
 static std::string lgetfilecon(const std::string& path) {
@@ -959,6 +1015,14 @@ binder::Status InstalldNativeService::createAppData(
         int32_t flags, int32_t appId, int32_t previousAppId, const std::string& seInfo,
         int32_t targetSdkVersion, int64_t* ceDataInode, int64_t* deDataInode) {
     ENFORCE_UID(AID_SYSTEM);
+    return createAppDataForSystem(uuid, packageName, userId, flags, appId, previousAppId, seInfo,
+                                  targetSdkVersion, ceDataInode, deDataInode);
+}
+
+binder::Status InstalldNativeService::createAppDataForSystem(
+        const std::optional<std::string>& uuid, const std::string& packageName, int32_t userId,
+        int32_t flags, int32_t appId, int32_t previousAppId, const std::string& seInfo,
+        int32_t targetSdkVersion, int64_t* ceDataInode, int64_t* deDataInode) {
     ENFORCE_VALID_USER(userId);
     CHECK_ARGUMENT_UUID(uuid);
     CHECK_ARGUMENT_PACKAGE_NAME(packageName);
@@ -996,13 +1060,53 @@ binder::Status InstalldNativeService::createAppDataBatched(
 
     // Locking is performed depeer in the callstack.
 
-    std::vector<android::os::CreateAppDataResult> results;
-    for (const auto &arg : args) {
-        android::os::CreateAppDataResult result;
-        createAppData(arg, &result);
-        results.push_back(result);
+    // Every package is independent and only takes its own package lock plus a shared user lock,
+    // so spread the packages across a few workers. Entries for the same package (one per user)
+    // stay on one worker, in order, so they never contend with each other.
+    std::vector<std::vector<size_t>> packages;
+    {
+        std::unordered_map<std::string, size_t> packageIndex;
+        for (size_t i = 0; i < args.size(); i++) {
+            auto [it, inserted] = packageIndex.try_emplace(args[i].packageName, packages.size());
+            if (inserted) packages.emplace_back();
+            packages[it->second].push_back(i);
+        }
+    }
+
+    // Workers are not binder threads, so the caller's UID was checked once above and the
+    // per-entry work skips that check.
+    std::vector<android::os::CreateAppDataResult> results(args.size());
+    std::atomic<size_t> nextPackage = 0;
+    auto createPackages = [&]() {
+        for (size_t i; (i = nextPackage.fetch_add(1)) < packages.size();) {
+            for (size_t index : packages[i]) {
+                const auto& arg = args[index];
+                auto& result = results[index];
+                result.ceDataInode = -1;
+                result.deDataInode = -1;
+                auto status = createAppDataForSystem(arg.uuid, arg.packageName, arg.userId,
+                                                     arg.flags, arg.appId, arg.previousAppId,
+                                                     arg.seInfo, arg.targetSdkVersion,
+                                                     &result.ceDataInode, &result.deDataInode);
+                result.exceptionCode = status.exceptionCode();
+                result.exceptionMessage = status.exceptionMessage();
+            }
+        }
+    };
+
+    const size_t numWorkers =
+            std::min({packages.size(), kMaxCreateAppDataThreads,
+                      static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()))});
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numWorkers; i++) {
+        workers.emplace_back(createPackages);
+    }
+    createPackages();
+    for (auto& worker : workers) {
+        worker.join();
     }
-    *_aidl_return = results;
+
+    *_aidl_return = std::move(results);
     return ok();
 }
 
@@ -1563,7 +1667,126 @@ binder::Status InstalldNativeService::fixupAppData(const std::optional<std::stri
     return ok();
 }
 
+static bool copy_xattrs(const std::string& from, const std::string& to) {
+    ssize_t listSize = llistxattr(from.c_str(), nullptr, 0);
+    if (listSize <= 0) {
+        return listSize == 0;
+    }
+    std::vector<char> names(listSize);
+    if ((listSize = llistxattr(from.c_str(), names.data(), names.size())) < 0) {
+        return false;
+    }
+    std::vector<char> value;
+    for (const char* name = names.data(); name < names.data() + listSize;
+         name += strlen(name) + 1) {
+        ssize_t valueSize = lgetxattr(from.c_str(), name, nullptr, 0);
+        if (valueSize < 0) {
+            return false;
+        }
+        value.resize(valueSize);
+        if ((valueSize = lgetxattr(from.c_str(), name, value.data(), value.size())) < 0 ||
+            lsetxattr(to.c_str(), name, value.data(), valueSize, 0) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Applies the ownership, xattrs, mode and timestamps of |st| (the stat of |from|) to |to|,
+// matching `cp --preserve=mode,ownership,timestamps,xattr`.
+static bool copy_attributes(const std::string& from, const std::string& to,
+                            const struct stat& st) {
+    if (lchown(to.c_str(), st.st_uid, st.st_gid) != 0 || !copy_xattrs(from, to)) {
+        return false;
+    }
+    if (!S_ISLNK(st.st_mode) && chmod(to.c_str(), st.st_mode & 07777) != 0) {
+        return false;
+    }
+    const struct timespec times[] = {st.st_atim, st.st_mtim};
+    return utimensat(AT_FDCWD, to.c_str(), times, AT_SYMLINK_NOFOLLOW) == 0;
+}
+
+static bool clone_file(const std::string& from, const std::string& to) {
+    unique_fd fromFd(open(from.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+    if (fromFd < 0) {
+        return false;
+    }
+    if (unlink(to.c_str()) != 0 && errno != ENOENT) {
+        return false;
+    }
+    unique_fd toFd(open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600));
+    if (toFd < 0) {
+        return false;
+    }
+    return ioctl(toFd.get(), FICLONE, fromFd.get()) == 0;
+}
+
+/**
+ * Copies the directory |from| into the directory |to| like copy_directory_recursive, but shares
+ * file extents with the source through FICLONE instead of duplicating the data. Returns false as
+ * soon as anything cannot be cloned (including filesystems without reflink support), in which
+ * case the caller falls back to a regular copy over whatever was created so far.
+ */
+static bool clone_directory_recursive(const char* from, const char* to) {
+    const std::string fromRoot = from;
+    const std::string toRoot = StringPrintf("%s/%s", to, android::base::Basename(from).c_str());
+    char* argv[] = {(char*)from, nullptr};
+
+    FTS* fts = fts_open(argv, FTS_PHYSICAL | FTS_NOCHDIR | FTS_XDEV, nullptr);
+    if (fts == nullptr) {
+        return false;
+    }
+    auto ftsCloser = android::base::make_scope_guard([fts] { fts_close(fts); });
+
+    FTSENT* p;
+    while ((p = fts_read(fts)) != nullptr) {
+        const std::string toPath = toRoot + (p->fts_path + fromRoot.size());
+        switch (p->fts_info) {
+            case FTS_D:
+                if (mkdir(toPath.c_str(), 0700) != 0 && errno != EEXIST) {
+                    return false;
+                }
+                break;
+            case FTS_DP:
+                // Directory attributes go last so that filling the directory does not touch them.
+                if (!copy_attributes(p->fts_path, toPath, *p->fts_statp)) {
+                    return false;
+                }
+                break;
+            case FTS_F:
+                if (!clone_file(p->fts_path, toPath) ||
+                    !copy_attributes(p->fts_path, toPath, *p->fts_statp)) {
+                    return false;
+                }
+                break;
+            case FTS_SL:
+            case FTS_SLNONE: {
+                std::string target;
+                if (!android::base::Readlink(p->fts_path, &target) ||
+                    (unlink(toPath.c_str()) != 0 && errno != ENOENT) ||
+                    symlink(target.c_str(), toPath.c_str()) != 0 ||
+                    !copy_attributes(p->fts_path, toPath, *p->fts_statp)) {
+                    return false;
+                }
+                break;
+            }
+            default:
+                // Special files and walk errors are left to cp.
+                return false;
+        }
+    }
+    return true;
+}
+
 static int32_t copy_directory_recursive(const char* from, const char* to) {
+    {
+        ScopedTrace tracer("clone-directory");
+        if (clone_directory_recursive(from, to)) {
+            LOG(DEBUG) << "Cloned " << from << " to " << to;
+            return 0;
+        }
+    }
+
     char* argv[] =
             {(char*)kCpPath,
              (char*)"-F", /* delete any existing destination file first (--remove-destination) */
@@ -2131,7 +2354,7 @@ binder::Status InstalldNativeService::freeCache(const std::optional<std::string>
         std::unordered_map<uid_t, std::shared_ptr<CacheTracker>> trackers;
         for (auto userId : users) {
 #ifdef GRANULAR_LOCKS
-            userLocks.emplace_back(userId, mUserIdLock, mLock);
+            userLocks.emplace_back(userId, mUserIdLock, mLock, mUserLockStats);
             lockGuards.emplace_back(userLocks.back());
 #endif // GRANULAR_LOCKS
             FTS *fts;
@@ -2245,13 +2468,11 @@ binder::Status InstalldNativeService::freeCache(const std::optional<std::string>
             }
 
             // If no items remain, go find another tracker
-            if (active->items.empty()) {
+            auto item = active->popItem();
+            if (!item) {
                 active = nullptr;
                 continue;
             } else {
-                auto item = active->items.back();
-                active->items.pop_back();
-
                 LOG(DEBUG) << "Purging " << item->toString() << " from " << active->toString();
                 if (!noop) {
                     item->purge();
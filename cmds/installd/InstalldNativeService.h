@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <shared_mutex>
 #include <unordered_map>
 #include <vector>
@@ -38,6 +39,18 @@ namespace installd {
 
 using IFsveritySetupAuthToken = android::os::IInstalld::IFsveritySetupAuthToken;
 
+// Acquisition and wait-time counters for one kind of installd lock, reported by dump().
+struct LockWaitStats {
+    std::atomic<uint64_t> acquisitions = 0;
+    // Acquisitions that could not take the lock immediately.
+    std::atomic<uint64_t> contentions = 0;
+    std::atomic<int64_t> totalWaitNs = 0;
+    std::atomic<int64_t> maxWaitNs = 0;
+
+    void recordWait(int64_t waitNs);
+    void dump(int fd, const char* name) const;
+};
+
 class InstalldNativeService : public BinderService<InstalldNativeService>, public os::BnInstalld {
 public:
     class FsveritySetupAuthToken : public os::IInstalld::BnFsveritySetupAuthToken {
@@ -219,6 +232,9 @@ private:
     std::recursive_mutex mLock;
     std::unordered_map<userid_t, std::weak_ptr<std::shared_mutex>> mUserIdLock;
     std::unordered_map<std::string, std::weak_ptr<std::recursive_mutex>> mPackageNameLock;
+    LockWaitStats mUserLockStats;
+    LockWaitStats mUserReadLockStats;
+    LockWaitStats mPackageLockStats;
 
     std::recursive_mutex mMountsLock;
     std::recursive_mutex mQuotasLock;
@@ -231,6 +247,13 @@ private:
 
     std::string findDataMediaPath(const std::optional<std::string>& uuid, userid_t userid);
 
+    // Same as createAppData, for callers that have already verified that the binder caller is
+    // the system server.
+    binder::Status createAppDataForSystem(const std::optional<std::string>& uuid,
+                                          const std::string& packageName, int32_t userId,
+                                          int32_t flags, int32_t appId, int32_t previousAppId,
+                                          const std::string& seInfo, int32_t targetSdkVersion,
+                                          int64_t* ceDataInode, int64_t* deDataInode);
     binder::Status createAppDataLocked(const std::optional<std::string>& uuid,
                                        const std::string& packageName, int32_t userId,
                                        int32_t flags, int32_t appId, int32_t previousAppId,
@@ -16,7 +16,9 @@
 #define LOG_TAG "installd"
 
 #include <fcntl.h>
+#include <inttypes.h>
 #include <signal.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/capability.h>
@@ -28,7 +30,10 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <condition_variable>
 #include <iomanip>
 #include <mutex>
 #include <unordered_set>
@@ -71,6 +76,7 @@ using android::base::EndsWith;
 using android::base::GetBoolProperty;
 using android::base::GetProperty;
 using android::base::ReadFdToString;
+using android::base::ReadFileToString;
 using android::base::ReadFully;
 using android::base::StringPrintf;
 using android::base::WriteFully;
@@ -87,8 +93,108 @@ constexpr int kShortTimeoutMs = 60000; // 1 minute.
 // aborted before that watchdog would take down the system server.
 constexpr int kLongTimeoutMs = 570000; // 9.5 minutes.
 
+// Upper bound on dex2oat processes running at the same time, regardless of how many cores the
+// device has. Each dex2oat is itself multi-threaded, so more than this only adds contention.
+constexpr size_t kMaxConcurrentDex2oat = 4;
+
+// Memory a single dex2oat is expected to need. The concurrency budget is never allowed to exceed
+// what MemAvailable can back at this rate.
+constexpr uint64_t kDex2oatMemoryBudgetBytes = 512 * 1024 * 1024;
+
+// Returns MemAvailable in bytes, or 0 if it cannot be read.
+uint64_t read_mem_available_bytes() {
+    std::string meminfo;
+    if (!ReadFileToString("/proc/meminfo", &meminfo)) {
+        return 0;
+    }
+    size_t pos = meminfo.find("MemAvailable:");
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    return strtoull(meminfo.c_str() + pos + strlen("MemAvailable:"), nullptr, 10) * 1024;
+}
+
+// Number of dex2oat processes that may run at once given the current CPU and memory state.
+// dalvik.vm.dex2oat-max-jobs overrides the computed value when set.
+size_t compute_dex2oat_job_limit() {
+    size_t limit = ::android::base::GetUintProperty<size_t>("dalvik.vm.dex2oat-max-jobs", 0);
+    if (limit > 0) {
+        return limit;
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    limit = std::clamp<size_t>(cpus > 0 ? cpus / 2 : 1, 1, kMaxConcurrentDex2oat);
+    uint64_t mem_available = read_mem_available_bytes();
+    if (mem_available > 0) {
+        limit = std::clamp<size_t>(mem_available / kDex2oatMemoryBudgetBytes, 1, limit);
+    }
+    return limit;
+}
+
+int64_t timeval_to_ns(const struct timeval& tv) {
+    return static_cast<int64_t>(tv.tv_sec) * 1000000000LL + tv.tv_usec * 1000LL;
+}
+
 class DexOptStatus {
  public:
+    // Waits until a dex2oat slot is available. Install-time jobs always go ahead of background
+    // jobs, and background jobs are held to half of the budget so that an install arriving in
+    // the middle of a background run does not queue behind all of it. Returns false without
+    // taking a slot if dexopt gets blocked while waiting.
+    bool acquire_job_slot(bool background) {
+        size_t limit = compute_dex2oat_job_limit();
+        size_t background_limit = std::max<size_t>(1, limit / 2);
+        auto start = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(dexopt_lock_);
+        JobStats& stats = background ? background_stats_ : install_stats_;
+        job_limit_ = limit;
+        if (!background) {
+            waiting_install_jobs_++;
+        }
+        while (!dexopt_blocked_ && !can_start_job(background, limit, background_limit)) {
+            job_slot_cv_.wait(lock);
+        }
+        if (!background) {
+            waiting_install_jobs_--;
+        }
+        stats.queue_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        if (dexopt_blocked_) {
+            job_slot_cv_.notify_all();
+            return false;
+        }
+        running_jobs_++;
+        if (background) {
+            running_background_jobs_++;
+        }
+        return true;
+    }
+
+    // Returns a slot taken by acquire_job_slot() and records what the job cost.
+    void release_job_slot(bool background, int64_t wall_ns, int64_t cpu_ns) {
+        {
+            std::lock_guard<std::mutex> lock(dexopt_lock_);
+            JobStats& stats = background ? background_stats_ : install_stats_;
+            stats.jobs++;
+            stats.wall_ns += wall_ns;
+            stats.cpu_ns += cpu_ns;
+            stats.max_wall_ns = std::max(stats.max_wall_ns, wall_ns);
+            running_jobs_--;
+            if (background) {
+                running_background_jobs_--;
+            }
+        }
+        job_slot_cv_.notify_all();
+    }
+
+    void dump(int fd) {
+        std::lock_guard<std::mutex> lock(dexopt_lock_);
+        dprintf(fd, "Dexopt jobs: running=%zu (background=%zu) waiting_install=%zu limit=%zu\n",
+                running_jobs_, running_background_jobs_, waiting_install_jobs_, job_limit_);
+        install_stats_.dump(fd, "install");
+        background_stats_.dump(fd, "background");
+    }
+
     // Check if dexopt is cancelled and fork if it is not cancelled.
     // cancelled is set to true if cancelled. Otherwise it will be set to false.
     // If it is not cancelled, it will return the return value of fork() call.
@@ -131,6 +237,8 @@ class DexOptStatus {
         if (!block) {
             return;
         }
+        // Release anything queued for a slot; it will see the block and give up.
+        job_slot_cv_.notify_all();
         // Blocked, also kill currently running tasks
         for (auto pid : dexopt_pids_) {
             LOG(INFO) << "control_dexopt_blocking kill pid:" << pid;
@@ -141,7 +249,42 @@ class DexOptStatus {
     }
 
  private:
+    bool can_start_job(bool background, size_t limit, size_t background_limit)
+            REQUIRES(dexopt_lock_) {
+        if (running_jobs_ >= limit) {
+            return false;
+        }
+        return !background ||
+                (waiting_install_jobs_ == 0 && running_background_jobs_ < background_limit);
+    }
+
+    struct JobStats {
+        uint64_t jobs = 0;
+        int64_t queue_ns = 0;
+        int64_t wall_ns = 0;
+        int64_t cpu_ns = 0;
+        int64_t max_wall_ns = 0;
+
+        void dump(int fd, const char* name) const {
+            dprintf(fd,
+                    "    %s: jobs=%" PRIu64 " queue_ms=%" PRId64 " wall_ms=%" PRId64
+                    " cpu_ms=%" PRId64 " max_wall_ms=%" PRId64 "\n",
+                    name, jobs, queue_ns / 1000000, wall_ns / 1000000, cpu_ns / 1000000,
+                    max_wall_ns / 1000000);
+        }
+    };
+
     std::mutex dexopt_lock_;
+    std::condition_variable job_slot_cv_;
+    // dex2oat processes that currently hold a slot, and how many of those are background jobs.
+    size_t running_jobs_ GUARDED_BY(dexopt_lock_) = 0;
+    size_t running_background_jobs_ GUARDED_BY(dexopt_lock_) = 0;
+    // Install-time jobs waiting for a slot. Background jobs do not start while this is non-zero.
+    size_t waiting_install_jobs_ GUARDED_BY(dexopt_lock_) = 0;
+    // Budget computed by the most recent acquire_job_slot(), for dumpsys.
+    size_t job_limit_ GUARDED_BY(dexopt_lock_) = 0;
+    JobStats install_stats_ GUARDED_BY(dexopt_lock_);
+    JobStats background_stats_ GUARDED_BY(dexopt_lock_);
     // when true, dexopt is blocked and will not run.
     bool dexopt_blocked_ GUARDED_BY(dexopt_lock_) = false;
     // PIDs of child process while runinng dexopt.
@@ -153,6 +296,34 @@ class DexOptStatus {
 
 android::base::NoDestructor<DexOptStatus> dexopt_status_;
 
+// Holds a slot taken with DexOptStatus::acquire_job_slot() and hands it back, together with the
+// job's wall and CPU time, when it goes out of scope.
+class DexoptJobSlot {
+ public:
+    explicit DexoptJobSlot(bool background)
+        : background_(background), start_(std::chrono::steady_clock::now()) {}
+
+    ~DexoptJobSlot() {
+        if (!held_) {
+            return;
+        }
+        int64_t wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count();
+        dexopt_status_->release_job_slot(background_, wall_ns, cpu_ns_);
+    }
+
+    void SetCpuTime(int64_t cpu_ns) { cpu_ns_ = cpu_ns; }
+
+    // Forgets the slot without returning it.
+    void Release() { held_ = false; }
+
+ private:
+    const bool background_;
+    const std::chrono::steady_clock::time_point start_;
+    int64_t cpu_ns_ = 0;
+    bool held_ = true;
+};
+
 } // namespace
 
 namespace android {
@@ -1614,6 +1785,10 @@ bool is_dexopt_blocked() {
     return dexopt_status_->is_dexopt_blocked();
 }
 
+void dump_dexopt_jobs(int fd) {
+    dexopt_status_->dump(fd);
+}
+
 enum SecondaryDexOptProcessResult {
     kSecondaryDexOptProcessOk = 0,
     kSecondaryDexOptProcessCancelled = 1,
@@ -1968,6 +2143,13 @@ int dexopt(const char* dex_path, uid_t uid, const char* pkgname, const char* ins
                       enable_hidden_api_checks, generate_compact_dex, compile_without_image,
                       background_job_compile, compilation_reason);
 
+    if (!dexopt_status_->acquire_job_slot(background_job_compile)) {
+        *completed = false;
+        reference_profile.DisableCleanup();
+        return 0;
+    }
+    DexoptJobSlot job_slot(background_job_compile);
+
     bool cancelled = false;
     pid_t pid = dexopt_status_->check_cancellation_and_fork(&cancelled);
     if (cancelled) {
@@ -1976,6 +2158,9 @@ int dexopt(const char* dex_path, uid_t uid, const char* pkgname, const char* ins
         return 0;
     }
     if (pid == 0) {
+        // The slot belongs to the parent; this process never returns from here.
+        job_slot.Release();
+
         // Need to set schedpolicy before dropping privileges
         // for cgroup migration. See details at b/175178520.
         SetDex2OatScheduling(boot_complete);
@@ -1991,7 +2176,9 @@ int dexopt(const char* dex_path, uid_t uid, const char* pkgname, const char* ins
 
         runner.Exec(DexoptReturnCodes::kDex2oatExec);
     } else {
-        int res = wait_child_with_timeout(pid, kLongTimeoutMs);
+        struct rusage usage = {};
+        int res = wait_child_with_timeout(pid, kLongTimeoutMs, &usage);
+        job_slot.SetCpuTime(timeval_to_ns(usage.ru_utime) + timeval_to_ns(usage.ru_stime));
         bool cancelled = dexopt_status_->check_if_killed_and_remove_dexopt_pid(pid);
         if (res == 0) {
             LOG(VERBOSE) << "DexInv: --- END '" << dex_path << "' (success) ---";
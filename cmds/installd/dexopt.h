@@ -132,6 +132,9 @@ bool is_dexopt_blocked();
 
 void control_dexopt_blocking(bool block);
 
+// Prints dex2oat concurrency state and per-priority job accounting.
+void dump_dexopt_jobs(int fd);
+
 bool calculate_oat_file_path_default(char path[PKG_PATH_MAX], const char *oat_dir,
         const char *apk_path, const char *instruction_set);
 
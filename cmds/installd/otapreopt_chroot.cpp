@@ -23,13 +23,19 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <set>
 #include <sstream>
 
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/macros.h>
+#include <android-base/properties.h>
 #include <android-base/scopeguard.h>
 #include <android-base/stringprintf.h>
 #include <android-base/strings.h>
@@ -134,6 +140,115 @@ static void TryExtraMount(const char* name, const char* slot, const char* target
     (void)TryMountWithFstypes(block_device.c_str(), target);
 }
 
+// Records the dexopt commands which already ran for the build being installed, so that an
+// interrupted OTA preopt picks up where it left off. The first line identifies the build, and
+// every following line is a command which succeeded.
+class DexoptCheckpoint {
+  public:
+    DexoptCheckpoint(std::string path, std::string build_id)
+        : path_(std::move(path)), build_id_(std::move(build_id)) {
+        std::string contents;
+        if (!android::base::ReadFileToString(path_, &contents)) {
+            return;
+        }
+        std::vector<std::string> lines = android::base::Split(contents, "\n");
+        if (lines.empty() || lines[0] != build_id_) {
+            LOG(INFO) << "Ignoring checkpoint " << path_ << " of a different build";
+            return;
+        }
+        // The last line is either empty or left over from an interrupted write, and is ignored.
+        if (lines.size() > 2) {
+            done_.insert(lines.begin() + 1, lines.end() - 1);
+        }
+    }
+
+    bool IsDone(const std::string& command) const { return done_.count(command) != 0; }
+
+    size_t DoneCount() const { return done_.size(); }
+
+    void MarkDone(const std::string& command) {
+        if (!fd_.ok() && !failed_) {
+            Open();
+        }
+        if (!fd_.ok()) {
+            return;
+        }
+        std::string line = command + "\n";
+        if (!android::base::WriteStringToFd(line, fd_) || fdatasync(fd_.get()) != 0) {
+            PLOG(WARNING) << "Failed to write checkpoint " << path_;
+        }
+    }
+
+  private:
+    void Open() {
+        // The checkpoint lives next to the artifacts, which otapreopt creates, so it is only
+        // opened once a command succeeded.
+        bool append = !done_.empty();
+        fd_.reset(open(path_.c_str(),
+                       O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0600));
+        if (!fd_.ok()) {
+            PLOG(WARNING) << "Failed to open checkpoint " << path_ << ", progress won't be saved";
+            failed_ = true;
+            return;
+        }
+        if (!append && !android::base::WriteStringToFd(build_id_ + "\n", fd_)) {
+            PLOG(WARNING) << "Failed to write checkpoint " << path_ << ", progress won't be saved";
+            fd_.reset();
+            failed_ = true;
+        }
+    }
+
+    const std::string path_;
+    const std::string build_id_;
+    std::set<std::string> done_;
+    android::base::unique_fd fd_;
+    bool failed_ = false;
+};
+
+// Identifies the build in the chroot, so that checkpoints of other OTAs are not reused.
+static std::string GetBuildId() {
+    std::string build_prop;
+    if (!android::base::ReadFileToString("/system/build.prop", &build_prop)) {
+        PLOG(WARNING) << "Failed to read /system/build.prop";
+    }
+    return StringPrintf("build.prop:%zx", std::hash<std::string>()(build_prop));
+}
+
+// Returns how many otapreopt instances may run at once. dex2oat is multi-threaded itself, so
+// only a fraction of the cores get their own instance.
+static size_t GetMaxDexoptJobs() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t default_jobs = std::clamp<long>(cpus / 4, 1, 4);
+    return std::max<size_t>(
+            android::base::GetUintProperty<size_t>("ro.otapreopt.max_jobs", default_jobs), 1);
+}
+
+// Whether the device is busy enough that no more than one otapreopt should run.
+static bool IsCpuBusy() {
+    std::string loadavg;
+    if (!android::base::ReadFileToString("/proc/loadavg", &loadavg)) {
+        return false;
+    }
+    double load = 0;
+    std::istringstream(loadavg) >> load;
+    return load >= sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+// Returns the APK a dexopt command compiles, which follows the "dexopt" token.
+static std::string GetDexoptApkPath(const std::vector<std::string>& tokens) {
+    auto it = std::find(tokens.begin(), tokens.end(), "dexopt");
+    if (it == tokens.end() || it + 1 == tokens.end()) {
+        return "";
+    }
+    return *(it + 1);
+}
+
+struct DexoptCommand {
+    size_t index;
+    std::string line;
+    std::string apk_path;
+};
+
 // Entry for otapreopt_chroot. Expected parameters are:
 //
 //   [cmd] [status-fd] [target-slot-suffix]
@@ -143,9 +258,11 @@ static void TryExtraMount(const char* name, const char* slot, const char* target
 //
 //   "dexopt" [dexopt-params]
 //
-// are then read from stdin until EOF and passed on to /system/bin/otapreopt one
-// by one. After each call a line with the current command count is written to
-// stdout and flushed.
+// are then read from stdin until EOF and passed on to /system/bin/otapreopt. Up
+// to GetMaxDexoptJobs() commands run at once, but never two for the same APK.
+// After each command finishes, a line with the count of finished commands is
+// written to stdout and flushed. Commands which succeeded are recorded in a
+// checkpoint, and skipped if the same OTA is preopted again.
 static int otapreopt_chroot(const int argc, char **arg) {
     // Validate arguments
     if (argc == 2 && std::string_view(arg[1]) == "--version") {
@@ -352,9 +469,9 @@ static int otapreopt_chroot(const int argc, char **arg) {
 
     // Now go on and read dexopt lines from stdin and pass them on to otapreopt.
 
-    int count = 1;
+    std::deque<DexoptCommand> pending;
     for (std::array<char, 10000> linebuf;
-         std::cin.clear(), std::cin.getline(&linebuf[0], linebuf.size()); ++count) {
+         std::cin.clear(), std::cin.getline(&linebuf[0], linebuf.size());) {
         // Subtract one from gcount() since getline() counts the newline.
         std::string line(&linebuf[0], std::cin.gcount() - 1);
 
@@ -364,22 +481,93 @@ static int otapreopt_chroot(const int argc, char **arg) {
         }
 
         std::vector<std::string> tokenized_line = android::base::Tokenize(line, " ");
-        std::vector<std::string> cmd{"/system/bin/otapreopt", slot_suffix};
-        std::move(tokenized_line.begin(), tokenized_line.end(), std::back_inserter(cmd));
+        pending.push_back({pending.size() + 1, android::base::Join(tokenized_line, " "),
+                           GetDexoptApkPath(tokenized_line)});
+    }
+
+    DexoptCheckpoint checkpoint(StringPrintf("/data/ota/%s/otapreopt_checkpoint", slot_suffix),
+                                GetBuildId());
+    size_t finished = 0;
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (checkpoint.IsDone(it->line)) {
+            it = pending.erase(it);
+            // Print the count to stdout and flush to indicate progress.
+            std::cout << ++finished << std::endl;
+        } else {
+            ++it;
+        }
+    }
+    if (finished > 0) {
+        LOG(INFO) << "Resuming after " << finished << " commands done in a previous run";
+    }
 
-        LOG(INFO) << "Command " << count << ": " << android::base::Join(cmd, " ");
+    const size_t max_jobs = GetMaxDexoptJobs();
+    LOG(INFO) << "Running " << pending.size() << " dexopt commands with up to " << max_jobs
+              << " jobs";
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::map<pid_t, DexoptCommand> running;
+    while (!pending.empty() || !running.empty()) {
+        while (!pending.empty() && running.size() < max_jobs &&
+               (running.empty() || !IsCpuBusy())) {
+            // Start the first command which doesn't compile an APK that is being compiled.
+            auto next = std::find_if(pending.begin(), pending.end(),
+                                     [&](const DexoptCommand& command) {
+                return command.apk_path.empty() ||
+                        std::none_of(running.begin(), running.end(), [&](const auto& job) {
+                            return job.second.apk_path == command.apk_path;
+                        });
+            });
+            if (next == pending.end()) {
+                break;
+            }
+
+            std::vector<std::string> cmd{"/system/bin/otapreopt", slot_suffix};
+            std::vector<std::string> tokenized_line = android::base::Tokenize(next->line, " ");
+            std::move(tokenized_line.begin(), tokenized_line.end(), std::back_inserter(cmd));
+
+            LOG(INFO) << "Command " << next->index << ": " << android::base::Join(cmd, " ");
+
+            // Fork and execute otapreopt in its own process.
+            std::string error_msg;
+            pid_t pid = ExecAsync(cmd, &error_msg);
+            if (pid == -1) {
+                LOG(ERROR) << "Running otapreopt failed: " << error_msg;
+                pending.erase(next);
+                std::cout << ++finished << std::endl;
+                continue;
+            }
+            running.emplace(pid, std::move(*next));
+            pending.erase(next);
+        }
+
+        int status;
+        pid_t pid = TEMP_FAILURE_RETRY(waitpid(-1, &status, 0));
+        if (pid == -1) {
+            PLOG(ERROR) << "Failed to wait for otapreopt";
+            exit(222);
+        }
+        auto job = running.find(pid);
+        if (job == running.end()) {
+            continue;
+        }
 
-        // Fork and execute otapreopt in its own process.
         std::string error_msg;
-        bool exec_result = Exec(cmd, &error_msg);
-        if (!exec_result) {
+        if (CheckExecStatus(status, "otapreopt " + job->second.line, &error_msg)) {
+            checkpoint.MarkDone(job->second.line);
+        } else {
             LOG(ERROR) << "Running otapreopt failed: " << error_msg;
         }
+        running.erase(job);
 
         // Print the count to stdout and flush to indicate progress.
-        std::cout << count << std::endl;
+        std::cout << ++finished << std::endl;
     }
 
+    LOG(INFO) << "Dexopt commands took "
+              << std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::steady_clock::now() - start_time).count()
+              << "s";
     LOG(INFO) << "No more dexopt commands";
     return 0;
 }
@@ -1184,6 +1184,28 @@ TEST_F(SdkSandboxDataTest, CreateAppData_CreatesSdkPackageData) {
     CheckFileAccess(fooDePath, kSystemUid, kSystemUid, S_IFDIR | 0751);
 }
 
+TEST_F(SdkSandboxDataTest, CreateAppDataBatched_CreatesEveryPackageInOrder) {
+    const std::vector<std::string> packageNames = {"com.foo", "com.bar", "com.baz", "com.qux",
+                                                   "com.quux"};
+    std::vector<android::os::CreateAppDataArgs> args;
+    for (const auto& packageName : packageNames) {
+        args.push_back(createAppDataArgs(packageName));
+    }
+    // An invalid entry fails on its own without affecting the rest of the batch.
+    args.push_back(createAppDataArgs("../com.invalid"));
+
+    std::vector<android::os::CreateAppDataResult> results;
+    ASSERT_BINDER_SUCCESS(service->createAppDataBatched(args, &results));
+    ASSERT_EQ(args.size(), results.size());
+
+    for (size_t i = 0; i < packageNames.size(); i++) {
+        EXPECT_EQ(binder::Status::EX_NONE, results[i].exceptionCode) << packageNames[i];
+        CheckFileAccess("misc_ce/0/sdksandbox/" + packageNames[i], kSystemUid, kSystemUid,
+                        S_IFDIR | 0751);
+    }
+    EXPECT_NE(binder::Status::EX_NONE, results.back().exceptionCode);
+}
+
 TEST_F(SdkSandboxDataTest, CreateAppData_CreatesSdkPackageData_WithoutSdkFlag) {
     android::os::CreateAppDataResult result;
     android::os::CreateAppDataArgs args = createAppDataArgs("com.foo");
@@ -17,6 +17,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <android-base/logging.h>
@@ -678,6 +679,40 @@ TEST_F(UtilsTest, TestForEachSubdir) {
     EXPECT_THAT(result, UnorderedElementsAre("com.foo", "com.bar"));
 }
 
+TEST_F(UtilsTest, TestCalculateTreeSize) {
+    const std::string root = "/data/local/tmp/tree-size";
+    auto deleter = [&]() {
+        delete_dir_contents_and_dir(root, true /* ignore_if_missing */);
+    };
+    auto scope_guard = android::base::make_scope_guard(deleter);
+
+    system(("mkdir -p " + root + "/a/nested " + root + "/b " + root + "/c/d/e").c_str());
+    system(("dd if=/dev/zero of=" + root + "/top bs=4096 count=3 2>/dev/null").c_str());
+    system(("dd if=/dev/zero of=" + root + "/a/nested/file bs=4096 count=5 2>/dev/null").c_str());
+    system(("dd if=/dev/zero of=" + root + "/c/d/e/file bs=4096 count=7 2>/dev/null").c_str());
+    system(("ln -s top " + root + "/link").c_str());
+
+    int64_t expected = 0;
+    for (const char* entry : {"", "/top", "/link", "/a", "/a/nested", "/a/nested/file", "/b", "/c",
+                              "/c/d", "/c/d/e", "/c/d/e/file"}) {
+        struct stat st;
+        ASSERT_EQ(0, lstat((root + entry).c_str(), &st)) << entry;
+        expected += st.st_blocks * 512;
+    }
+
+    int64_t size = 0;
+    ASSERT_EQ(0, calculate_tree_size(root, &size));
+    EXPECT_EQ(expected, size);
+
+    // Sizes accumulate into the output, as the callers rely on.
+    ASSERT_EQ(0, calculate_tree_size(root + "/top", &size));
+    EXPECT_GT(size, expected);
+
+    size = 0;
+    EXPECT_EQ(-1, calculate_tree_size(root + "/missing", &size));
+    EXPECT_EQ(0, size);
+}
+
 TEST_F(UtilsTest, TestSdkSandboxDataPaths) {
     // Ce data paths
     EXPECT_EQ("/data/misc_ce/0/sdksandbox",
@@ -16,6 +16,7 @@
 
 #include "utils.h"
 
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <fts.h>
@@ -23,6 +24,7 @@
 #include <stdlib.h>
 #include <sys/capability.h>
 #include <sys/pidfd.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <sys/statvfs.h>
 #include <sys/wait.h>
@@ -42,6 +44,9 @@
 #include <private/android_filesystem_config.h>
 #include <private/android_projectid_config.h>
 
+#include <atomic>
+#include <thread>
+
 #include "dexopt_return_codes.h"
 #include "globals.h"  // extern variables.
 #include "QuotaUtils.h"
@@ -464,7 +469,23 @@ int set_quota_project_id(const std::string& path, long project_id, bool set_inhe
     return 0;
 }
 
-int calculate_tree_size(const std::string& path, int64_t* size,
+// Maximum number of threads that measure the subdirectories of one tree concurrently.
+static constexpr size_t kMaxTreeSizeThreads = 4;
+
+static bool is_app_owned(const struct stat& st) {
+    int32_t user_uid = multiuser_get_app_id(st.st_uid);
+    int32_t user_gid = multiuser_get_app_id(st.st_gid);
+    return (user_uid >= AID_APP_START && user_uid <= AID_APP_END)
+            || (user_gid >= AID_CACHE_GID_START && user_gid <= AID_CACHE_GID_END)
+            || (user_gid >= AID_SHARED_GID_START && user_gid <= AID_SHARED_GID_END);
+}
+
+static bool matches_gid(const struct stat& st, int32_t include_gid, int32_t exclude_gid) {
+    int32_t gid = st.st_gid;
+    return (include_gid == -1 || gid == include_gid) && (exclude_gid == -1 || gid != exclude_gid);
+}
+
+static int calculate_subtree_size(const std::string& path, int64_t* size,
         int32_t include_gid, int32_t exclude_gid, bool exclude_apps) {
     FTS *fts;
     FTSENT *p;
@@ -483,21 +504,12 @@ int calculate_tree_size(const std::string& path, int64_t* size,
         case FTS_F:
         case FTS_SL:
         case FTS_SLNONE:
-            int32_t uid = p->fts_statp->st_uid;
-            int32_t gid = p->fts_statp->st_gid;
-            int32_t user_uid = multiuser_get_app_id(uid);
-            int32_t user_gid = multiuser_get_app_id(gid);
-            if (exclude_apps && ((user_uid >= AID_APP_START && user_uid <= AID_APP_END)
-                    || (user_gid >= AID_CACHE_GID_START && user_gid <= AID_CACHE_GID_END)
-                    || (user_gid >= AID_SHARED_GID_START && user_gid <= AID_SHARED_GID_END))) {
+            if (exclude_apps && is_app_owned(*p->fts_statp)) {
                 // Don't traverse inside or measure
                 fts_set(fts, p, FTS_SKIP);
                 break;
             }
-            if (include_gid != -1 && gid != include_gid) {
-                break;
-            }
-            if (exclude_gid != -1 && gid == exclude_gid) {
+            if (!matches_gid(*p->fts_statp, include_gid, exclude_gid)) {
                 break;
             }
             matchedSize += (p->fts_statp->st_blocks * 512);
@@ -505,6 +517,82 @@ int calculate_tree_size(const std::string& path, int64_t* size,
         }
     }
     fts_close(fts);
+    *size += matchedSize;
+    return 0;
+}
+
+int calculate_tree_size(const std::string& path, int64_t* size,
+        int32_t include_gid, int32_t exclude_gid, bool exclude_apps) {
+    // Measure the top level here and hand each subdirectory to a pool of walkers, so that
+    // trees with several large subdirectories (code paths, dalvik-cache, media) are not
+    // walked one inode at a time on a single thread. The result matches a single fts walk
+    // of |path|: subdirectories on other devices are neither measured nor traversed.
+    struct stat st;
+    std::unique_ptr<DIR, decltype(&closedir)> dir(nullptr, closedir);
+    if (lstat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        dir.reset(opendir(path.c_str()));
+    }
+    if (!dir) {
+        return calculate_subtree_size(path, size, include_gid, exclude_gid, exclude_apps);
+    }
+    if (exclude_apps && is_app_owned(st)) {
+        return 0;
+    }
+
+    int64_t matchedSize = 0;
+    if (matches_gid(st, include_gid, exclude_gid)) {
+        matchedSize += st.st_blocks * 512;
+    }
+
+    std::vector<std::string> subdirs;
+    struct dirent* ent;
+    while ((ent = readdir(dir.get()))) {
+        if (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, "..")) {
+            continue;
+        }
+        struct stat child;
+        if (fstatat(dirfd(dir.get()), ent->d_name, &child, AT_SYMLINK_NOFOLLOW) != 0) {
+            continue;
+        }
+        if (S_ISDIR(child.st_mode)) {
+            if (child.st_dev == st.st_dev) {
+                subdirs.push_back(path + "/" + ent->d_name);
+            }
+            continue;
+        }
+        if (exclude_apps && is_app_owned(child)) {
+            continue;
+        }
+        if (matches_gid(child, include_gid, exclude_gid)) {
+            matchedSize += child.st_blocks * 512;
+        }
+    }
+    dir.reset();
+
+    // Walkers claim subdirectories from a shared index, so a thread that finishes a small
+    // subtree moves on to the next one instead of idling behind a large one.
+    std::atomic<size_t> nextSubdir = 0;
+    std::atomic<int64_t> subdirsSize = 0;
+    auto walk = [&]() {
+        int64_t walkedSize = 0;
+        for (size_t i; (i = nextSubdir.fetch_add(1)) < subdirs.size();) {
+            calculate_subtree_size(subdirs[i], &walkedSize, include_gid, exclude_gid,
+                    exclude_apps);
+        }
+        subdirsSize += walkedSize;
+    };
+
+    std::vector<std::thread> walkers;
+    const size_t numWalkers = std::min(subdirs.size(), kMaxTreeSizeThreads);
+    for (size_t i = 1; i < numWalkers; i++) {
+        walkers.emplace_back(walk);
+    }
+    walk();
+    for (auto& walker : walkers) {
+        walker.join();
+    }
+    matchedSize += subdirsSize;
+
 #if MEASURE_DEBUG
     if ((include_gid == -1) && (exclude_gid == -1)) {
         LOG(DEBUG) << "Measured " << path << " size " << matchedSize;
@@ -1167,9 +1255,9 @@ int ensure_config_user_dirs(userid_t userid) {
     return fs_prepare_dir(path.c_str(), 0750, uid, gid);
 }
 
-static int wait_child(pid_t pid) {
+static int wait_child(pid_t pid, struct rusage* usage) {
     int status;
-    pid_t got_pid = TEMP_FAILURE_RETRY(waitpid(pid, &status, /*options=*/0));
+    pid_t got_pid = TEMP_FAILURE_RETRY(wait4(pid, &status, /*options=*/0, usage));
 
     if (got_pid != pid) {
         PLOG(ERROR) << "waitpid failed: wanted " << pid << ", got " << got_pid;
@@ -1179,12 +1267,12 @@ static int wait_child(pid_t pid) {
     return status;
 }
 
-int wait_child_with_timeout(pid_t pid, int timeout_ms) {
+int wait_child_with_timeout(pid_t pid, int timeout_ms, struct rusage* usage) {
     int pidfd = pidfd_open(pid, /*flags=*/0);
     if (pidfd < 0) {
         PLOG(ERROR) << "pidfd_open failed for pid " << pid
                     << ", waiting for child process without timeout";
-        return wait_child(pid);
+        return wait_child(pid, usage);
     }
 
     struct pollfd pfd;
@@ -1197,15 +1285,15 @@ int wait_child_with_timeout(pid_t pid, int timeout_ms) {
     if (poll_ret < 0) {
         PLOG(ERROR) << "poll failed for pid " << pid;
         kill(pid, SIGKILL);
-        return wait_child(pid);
+        return wait_child(pid, usage);
     }
     if (poll_ret == 0) {
         LOG(WARNING) << "Child process " << pid << " timed out after " << timeout_ms
                      << "ms. Killing it";
         kill(pid, SIGKILL);
-        return wait_child(pid);
+        return wait_child(pid, usage);
     }
-    return wait_child(pid);
+    return wait_child(pid, usage);
 }
 
 /**
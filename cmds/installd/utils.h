@@ -24,6 +24,7 @@
 
 #include <dirent.h>
 #include <inttypes.h>
+#include <sys/resource.h>
 #include <unistd.h>
 #include <utime.h>
 
@@ -165,8 +166,9 @@ int validate_apk_path_subdirs(const char *path);
 
 int ensure_config_user_dirs(userid_t userid);
 
-// Waits for a child process, or kills it if it times out. Returns the exit code.
-int wait_child_with_timeout(pid_t pid, int timeout_ms);
+// Waits for a child process, or kills it if it times out. Returns the exit code. If usage is
+// non-null it receives the resource usage of the reaped child.
+int wait_child_with_timeout(pid_t pid, int timeout_ms, struct rusage* usage = nullptr);
 
 int prepare_app_cache_dir(const std::string& parent, const char* name, mode_t target_mode,
         uid_t uid, gid_t gid);
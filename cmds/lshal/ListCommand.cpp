@@ -19,6 +19,7 @@
 #include <getopt.h>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -26,6 +27,7 @@
 #include <map>
 #include <regex>
 #include <sstream>
+#include <thread>
 
 #include <android-base/file.h>
 #include <android-base/hex.h>
@@ -459,6 +461,43 @@ static vintf::Arch fromBaseArchitecture(::android::hidl::base::V1_0::DebugInfo::
     }
 }
 
+// Upper bound on HALs asked for debug() output at the same time.
+static constexpr size_t kMaxConcurrentDebugDumps = 4;
+
+std::map<std::string, std::string> ListCommand::fetchDebugInfos(const Table& table) const {
+    std::vector<std::string> interfaceNames;
+    for (const auto& entry : table) {
+        interfaceNames.push_back(entry.interfaceName);
+    }
+
+    // Each debug() call goes through its own PipeRelay into its own buffer, so several HALs can
+    // be dumped at once. Results are assembled in table order afterwards.
+    std::vector<std::string> debugInfos(interfaceNames.size());
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+        for (size_t i = next++; i < interfaceNames.size(); i = next++) {
+            std::stringstream ss;
+            auto pair = splitFirst(interfaceNames[i], '/');
+            mLshal.emitDebugInfo(pair.first, pair.second, {}, ParentDebugInfoLevel::FQNAME_ONLY,
+                                 ss, NullableOStream<std::ostream>(nullptr));
+            debugInfos[i] = ss.str();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(kMaxConcurrentDebugDumps, interfaceNames.size()); ++i) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    std::map<std::string, std::string> ret;
+    for (size_t i = 0; i < interfaceNames.size(); ++i) {
+        ret.emplace(interfaceNames[i], std::move(debugInfos[i]));
+    }
+    return ret;
+}
+
 void ListCommand::dumpTable(const NullableOStream<std::ostream>& out) const {
     if (mNeat) {
         std::vector<const Table*> tables;
@@ -476,14 +515,12 @@ void ListCommand::dumpTable(const NullableOStream<std::ostream>& out) const {
         // debug info for a service we create on the fly, so we only operate
         // on the "mServicesTable".
         std::function<std::string(const std::string&)> emitDebugInfo = nullptr;
+        std::map<std::string, std::string> debugInfos;
         if (mEmitDebugInfo && &table == &mServicesTable) {
-            emitDebugInfo = [this](const auto& iName) {
-                std::stringstream ss;
-                auto pair = splitFirst(iName, '/');
-                mLshal.emitDebugInfo(pair.first, pair.second, {},
-                                     ParentDebugInfoLevel::FQNAME_ONLY, ss,
-                                     NullableOStream<std::ostream>(nullptr));
-                return ss.str();
+            debugInfos = fetchDebugInfos(table);
+            emitDebugInfo = [&debugInfos](const auto& iName) {
+                auto it = debugInfos.find(iName);
+                return it == debugInfos.end() ? std::string() : it->second;
             };
         }
         table.createTextTable(mNeat, emitDebugInfo).dump(out.buf());
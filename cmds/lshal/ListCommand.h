@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #include <fstream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -110,6 +111,8 @@ protected:
     const BinderPidInfo* getPidInfoCached(pid_t serverPid);
 
     void dumpTable(const NullableOStream<std::ostream>& out) const;
+    // Collects debug() output for every entry of table, keyed by interface name.
+    std::map<std::string, std::string> fetchDebugInfos(const Table& table) const;
     void dumpVintf(const NullableOStream<std::ostream>& out) const;
     void addLine(TextTable *table, const std::string &interfaceName, const std::string &transport,
                  const std::string &arch, const std::string &threadUsage, const std::string &server,
@@ -23,6 +23,7 @@
 #include <selinux/avc.h>
 
 #include <sstream>
+#include <unordered_map>
 
 namespace android {
 
@@ -46,11 +47,21 @@ static std::string getPidcon(pid_t pid) {
     return result;
 }
 
+// Target contexts of service names, as looked up through the current selabel handle. Almost
+// every call into servicemanager checks access to a name, and most names are asked for many
+// times, so this saves a service_contexts lookup on each of them.
+static std::unordered_map<std::string, std::string>& getServiceContextCache() {
+    static auto& gServiceContexts = *new std::unordered_map<std::string, std::string>();
+    return gServiceContexts;
+}
+
 static struct selabel_handle* getSehandle() {
     static struct selabel_handle* gSehandle = nullptr;
     if (gSehandle != nullptr && selinux_status_updated()) {
         selabel_close(gSehandle);
         gSehandle = nullptr;
+        // Policy or service_contexts may have changed.
+        getServiceContextCache().clear();
     }
 
     if (gSehandle == nullptr) {
@@ -63,6 +74,25 @@ static struct selabel_handle* getSehandle() {
     return gSehandle;
 }
 
+static bool lookupServiceContext(const std::string& name, std::string* outContext) {
+    struct selabel_handle* handle = getSehandle();
+
+    auto& cache = getServiceContextCache();
+    if (auto it = cache.find(name); it != cache.end()) {
+        *outContext = it->second;
+        return true;
+    }
+
+    char* tctx = nullptr;
+    if (selabel_lookup(handle, &tctx, name.c_str(), SELABEL_CTX_ANDROID_SERVICE) != 0) {
+        return false;
+    }
+    *outContext = tctx;
+    freecon(tctx);
+    cache.emplace(name, *outContext);
+    return true;
+}
+
 struct AuditCallbackData {
     const Access::CallingContext* context;
     const std::string* tname;
@@ -161,15 +191,13 @@ bool Access::actionAllowed(const CallingContext& sctx, const char* tctx, const c
 
 bool Access::actionAllowedFromLookup(const CallingContext& sctx, const std::string& name, const char *perm) {
 #ifdef __ANDROID__
-    char *tctx = nullptr;
-    if (selabel_lookup(getSehandle(), &tctx, name.c_str(), SELABEL_CTX_ANDROID_SERVICE) != 0) {
+    std::string tctx;
+    if (!lookupServiceContext(name, &tctx)) {
         LOG(ERROR) << "SELinux: No match for " << name << " in service_contexts.\n";
         return false;
     }
 
-    bool allowed = actionAllowed(sctx, tctx, perm, name);
-    freecon(tctx);
-    return allowed;
+    return actionAllowed(sctx, tctx.c_str(), perm, name);
 #else
     (void)sctx;
     (void)name;
@@ -16,8 +16,10 @@
 
 #include "ServiceManager.h"
 
+#include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/properties.h>
+#include <android-base/stringprintf.h>
 #include <android-base/strings.h>
 #include <binder/BpBinder.h>
 #include <binder/IPCThreadState.h>
@@ -39,6 +41,9 @@
 
 using ::android::binder::Status;
 using ::android::internal::Stability;
+using std::chrono::duration_cast;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
 
 namespace android {
 
@@ -380,6 +385,13 @@ sp<IBinder> ServiceManager::tryGetService(const std::string& name, bool startIfN
     }
 
     if (!out && startIfNotFound) {
+        // Only services which registered before are tracked, so that looking up arbitrary names
+        // doesn't grow mNameToStats.
+        if (auto it = mNameToStats.find(name); it != mNameToStats.end()) {
+            ServiceStats& stats = it->second;
+            stats.startRequests++;
+            if (!stats.startRequestedTime) stats.startRequestedTime = steady_clock::now();
+        }
         tryStartService(ctx, name);
     }
 
@@ -486,7 +498,9 @@ Status ServiceManager::addService(const std::string& name, const sp<IBinder>& bi
             .hasClients = prevClients, // see b/279898063, matters if existing callbacks
             .guaranteeClient = false,
             .ctx = ctx,
+            .lastClientTime = steady_clock::now(),
     };
+    noteServiceRegistered(name);
 
     if (auto it = mNameToRegistrationCallback.find(name); it != mNameToRegistrationCallback.end()) {
         // If someone is currently waiting on the service, notify the service that
@@ -860,6 +874,7 @@ bool ServiceManager::handleServiceClientCallback(size_t knownClients,
     if (count == -1) return true;
 
     bool hasKernelReportedClients = static_cast<size_t>(count) > knownClients;
+    steady_clock::time_point now = steady_clock::now();
 
     if (service.guaranteeClient) {
         if (!service.hasClients && !hasKernelReportedClients) {
@@ -867,8 +882,13 @@ bool ServiceManager::handleServiceClientCallback(size_t knownClients,
                                             "service is guaranteed to be in use");
         }
 
-        // guarantee is temporary
+        // guarantee is temporary, but it restarts the keep-alive
         service.guaranteeClient = false;
+        service.lastClientTime = now;
+    }
+
+    if (hasKernelReportedClients) {
+        service.lastClientTime = now;
     }
 
     // Regardless of this situation, we want to give this notification as soon as possible.
@@ -877,9 +897,11 @@ bool ServiceManager::handleServiceClientCallback(size_t knownClients,
         sendClientCallbackNotifications(serviceName, true, "we now have a record of a client");
     }
 
-    // But limit rate of shutting down service.
+    // But limit rate of shutting down service: it is only told that its clients are gone once
+    // they have been gone for its whole keep-alive.
     if (isCalledOnInterval) {
-        if (!hasKernelReportedClients && service.hasClients) {
+        if (!hasKernelReportedClients && service.hasClients &&
+            now - service.lastClientTime >= getClientKeepAlive(serviceName)) {
             sendClientCallbackNotifications(serviceName, false,
                                             "we now have no record of a client");
         }
@@ -915,6 +937,9 @@ void ServiceManager::sendClientCallbackNotifications(const std::string& serviceN
     }
 
     service.hasClients = hasClients;
+
+    ServiceStats& stats = mNameToStats[serviceName];
+    (hasClients ? stats.clientsGained : stats.clientsLost)++;
 }
 
 Status ServiceManager::tryUnregisterService(const std::string& name, const sp<IBinder>& binder) {
@@ -979,6 +1004,10 @@ Status ServiceManager::tryUnregisterService(const std::string& name, const sp<IB
     ALOGI("%s Unregistering %s", ctx.toDebugString().c_str(), name.c_str());
     mNameToService.erase(name);
 
+    ServiceStats& stats = mNameToStats[name];
+    stats.unregistrations++;
+    stats.unregisteredTime = steady_clock::now();
+
     return Status::ok();
 }
 
@@ -1003,6 +1032,83 @@ void ServiceManager::clear() {
     mNameToService.clear();
     mNameToRegistrationCallback.clear();
     mNameToClientCallback.clear();
+    mNameToStats.clear();
+}
+
+void ServiceManager::setClientKeepAlive(const std::string& name, milliseconds keepAlive) {
+    if (name.empty()) {
+        mDefaultClientKeepAlive = keepAlive;
+    } else {
+        mNameToClientKeepAlive[name] = keepAlive;
+    }
+}
+
+milliseconds ServiceManager::getClientKeepAlive(const std::string& name) const {
+    if (auto it = mNameToClientKeepAlive.find(name); it != mNameToClientKeepAlive.end()) {
+        return it->second;
+    }
+    return mDefaultClientKeepAlive;
+}
+
+void ServiceManager::noteServiceRegistered(const std::string& name) {
+    steady_clock::time_point now = steady_clock::now();
+    ServiceStats& stats = mNameToStats[name];
+    stats.registrations++;
+
+    if (stats.startRequestedTime) {
+        stats.lastStartLatency = duration_cast<milliseconds>(now - *stats.startRequestedTime);
+        stats.maxStartLatency = std::max(stats.maxStartLatency, stats.lastStartLatency);
+        stats.startRequestedTime.reset();
+        ALOGI("Service '%s' registered %lld ms after it was requested", name.c_str(),
+              static_cast<long long>(stats.lastStartLatency.count()));
+    }
+
+    if (stats.unregisteredTime) {
+        milliseconds downtime = duration_cast<milliseconds>(now - *stats.unregisteredTime);
+        if (!stats.shortestDowntime || downtime < *stats.shortestDowntime) {
+            stats.shortestDowntime = downtime;
+        }
+        // The service had been idle for its keep-alive before it stopped, so if it was down for
+        // less than that, twice the keep-alive would have kept it running.
+        if (downtime < getClientKeepAlive(name)) {
+            stats.restartsWithinKeepAlive++;
+        }
+        stats.unregisteredTime.reset();
+    }
+}
+
+status_t ServiceManager::dump(int fd, const Vector<String16>& /*args*/) {
+    if (!mAccess->canList(mAccess->getCallingContext())) {
+        return PERMISSION_DENIED;
+    }
+
+    std::string out = base::StringPrintf("Lazy services (default keep-alive %lld ms):\n",
+                                         static_cast<long long>(mDefaultClientKeepAlive.count()));
+    for (const auto& [name, stats] : mNameToStats) {
+        // Services which never had client callbacks and never stopped aren't lazy.
+        if (mNameToClientCallback.count(name) == 0 && stats.unregistrations == 0) continue;
+
+        base::StringAppendF(&out, "  %s: %s, keep-alive %lld ms\n", name.c_str(),
+                            mNameToService.count(name) ? "running" : "stopped",
+                            static_cast<long long>(getClientKeepAlive(name).count()));
+        base::StringAppendF(&out,
+                            "    registrations: %zu, unregistrations: %zu, start requests: %zu\n",
+                            stats.registrations, stats.unregistrations, stats.startRequests);
+        base::StringAppendF(&out, "    onClients(true): %zu, onClients(false): %zu\n",
+                            stats.clientsGained, stats.clientsLost);
+        base::StringAppendF(&out, "    start latency: last %lld ms, max %lld ms\n",
+                            static_cast<long long>(stats.lastStartLatency.count()),
+                            static_cast<long long>(stats.maxStartLatency.count()));
+        if (stats.shortestDowntime) {
+            base::StringAppendF(&out,
+                                "    shortest downtime: %lld ms, restarts within keep-alive: "
+                                "%zu\n",
+                                static_cast<long long>(stats.shortestDowntime->count()),
+                                stats.restartsWithinKeepAlive);
+        }
+    }
+
+    return base::WriteStringToFd(out, fd) ? OK : UNKNOWN_ERROR;
 }
 
 }  // namespace android
@@ -20,6 +20,9 @@
 #include <android/os/IClientCallback.h>
 #include <android/os/IServiceCallback.h>
 
+#include <chrono>
+#include <optional>
+
 #include "Access.h"
 
 namespace android {
@@ -58,14 +61,27 @@ public:
     binder::Status tryUnregisterService(const std::string& name, const sp<IBinder>& binder) override;
     binder::Status getServiceDebugInfo(std::vector<ServiceDebugInfo>* outReturn) override;
     void binderDied(const wp<IBinder>& who) override;
+    // Prints the start/stop history of lazy services.
+    status_t dump(int fd, const Vector<String16>& args) override;
     void handleClientCallbacks();
 
+    /**
+     * Sets how long a lazy service is still told it has clients after its last client went away.
+     * Services which are restarted soon after they shut down should keep a longer value, and
+     * services which are rarely used a shorter one. An empty name sets the value used by services
+     * which don't have their own.
+     */
+    void setClientKeepAlive(const std::string& name, std::chrono::milliseconds keepAlive);
+
     /**
      *  This API is added for debug purposes. It clears members which hold service and callback
      * information.
      */
     void clear();
 
+    // matches the interval at which servicemanager checked for clients before keep-alives existed
+    static constexpr std::chrono::milliseconds kDefaultClientKeepAlive{5000};
+
 protected:
     virtual void tryStartService(const Access::CallingContext& ctx, const std::string& name);
 
@@ -77,6 +93,8 @@ private:
         bool hasClients = false; // notifications sent on true -> false.
         bool guaranteeClient = false; // forces the client check to true
         Access::CallingContext ctx;   // process that originally registers this
+        // last time this service was known to be in use, for the keep-alive
+        std::chrono::steady_clock::time_point lastClientTime;
 
         // the number of clients of the service, including servicemanager itself
         ssize_t getNodeStrongRefCount();
@@ -84,9 +102,26 @@ private:
         ~Service();
     };
 
+    // Start/stop history of a service. Unlike Service, this is kept when the service unregisters.
+    struct ServiceStats {
+        size_t startRequests = 0;   // times getService tried to start the service
+        size_t registrations = 0;
+        size_t unregistrations = 0;
+        size_t clientsGained = 0;   // onClients(true) notifications
+        size_t clientsLost = 0;     // onClients(false) notifications
+        // restarts which a keep-alive twice as long would have avoided
+        size_t restartsWithinKeepAlive = 0;
+        std::optional<std::chrono::steady_clock::time_point> startRequestedTime;
+        std::optional<std::chrono::steady_clock::time_point> unregisteredTime;
+        std::chrono::milliseconds lastStartLatency{0};
+        std::chrono::milliseconds maxStartLatency{0};
+        std::optional<std::chrono::milliseconds> shortestDowntime;
+    };
+
     using ServiceCallbackMap = std::map<std::string, std::vector<sp<IServiceCallback>>>;
     using ClientCallbackMap = std::map<std::string, std::vector<sp<IClientCallback>>>;
     using ServiceMap = std::map<std::string, Service>;
+    using ServiceStatsMap = std::map<std::string, ServiceStats>;
 
     // removes a callback from mNameToRegistrationCallback, removing it if the vector is empty
     // this updates iterator to the next location
@@ -104,10 +139,17 @@ private:
     void removeClientCallback(const wp<IBinder>& who, ClientCallbackMap::iterator* it);
 
     sp<IBinder> tryGetService(const std::string& name, bool startIfNotFound);
+    std::chrono::milliseconds getClientKeepAlive(const std::string& name) const;
+    // records that a service was registered, for its ServiceStats
+    void noteServiceRegistered(const std::string& name);
 
     ServiceMap mNameToService;
     ServiceCallbackMap mNameToRegistrationCallback;
     ClientCallbackMap mNameToClientCallback;
+    ServiceStatsMap mNameToStats;
+
+    std::chrono::milliseconds mDefaultClientKeepAlive = kDefaultClientKeepAlive;
+    std::map<std::string, std::chrono::milliseconds> mNameToClientKeepAlive;
 
     std::unique_ptr<Access> mAccess;
 };
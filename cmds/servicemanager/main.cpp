@@ -15,7 +15,9 @@
  */
 
 #include <android-base/logging.h>
+#include <android-base/parseint.h>
 #include <android-base/properties.h>
+#include <android-base/strings.h>
 #include <binder/IPCThreadState.h>
 #include <binder/ProcessState.h>
 #include <binder/Status.h>
@@ -33,7 +35,10 @@ using ::android::LooperCallback;
 using ::android::ProcessState;
 using ::android::ServiceManager;
 using ::android::sp;
+using ::android::base::GetProperty;
+using ::android::base::ParseInt;
 using ::android::base::SetProperty;
+using ::android::base::Split;
 using ::android::os::IServiceManager;
 
 class BinderCallback : public LooperCallback {
@@ -80,13 +85,15 @@ public:
         int fdTimer = timerfd_create(CLOCK_MONOTONIC, 0 /*flags*/);
         LOG_ALWAYS_FATAL_IF(fdTimer < 0, "Failed to timerfd_create: fd: %d err: %d", fdTimer, errno);
 
+        // Clients going away are only noticed on this timer, so it bounds how precisely the
+        // keep-alive of lazy services is honored.
         itimerspec timespec {
             .it_interval = {
-                .tv_sec = 5,
+                .tv_sec = 1,
                 .tv_nsec = 0,
             },
             .it_value = {
-                .tv_sec = 5,
+                .tv_sec = 1,
                 .tv_nsec = 0,
             },
         };
@@ -123,6 +130,25 @@ private:
     sp<BinderCallback> mBinderCallback;
 };
 
+// Reads the keep-alives of lazy services, e.g. "5000,android.hardware.foo.IFoo/default=30000",
+// where the entry without a name is the default.
+static void setupClientKeepAlives(const sp<ServiceManager>& manager) {
+    std::string config = GetProperty("ro.servicemanager.lazy_keep_alive_ms", "");
+    if (config.empty()) return;
+
+    for (const std::string& entry : Split(config, ",")) {
+        size_t separator = entry.rfind('=');
+        std::string name = separator == std::string::npos ? "" : entry.substr(0, separator);
+        int64_t keepAliveMs;
+        if (!ParseInt(entry.substr(separator == std::string::npos ? 0 : separator + 1),
+                      &keepAliveMs, int64_t{0})) {
+            LOG(ERROR) << "Ignoring malformed lazy service keep-alive: " << entry;
+            continue;
+        }
+        manager->setClientKeepAlive(name, std::chrono::milliseconds(keepAliveMs));
+    }
+}
+
 int main(int argc, char** argv) {
     android::base::InitLogging(argv, android::base::KernelLogger);
 
@@ -144,6 +170,7 @@ int main(int argc, char** argv) {
     if (!manager->addService("manager", manager, false /*allowIsolated*/, IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk()) {
         LOG(ERROR) << "Could not self register servicemanager";
     }
+    setupClientKeepAlives(manager);
 
     IPCThreadState::self()->setTheContextObject(manager);
     if (!ps->becomeContextManager()) {
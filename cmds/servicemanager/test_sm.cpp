@@ -14,8 +14,10 @@
  * limitations under the License.
  */
 
+#include <android-base/file.h>
 #include <android-base/properties.h>
 #include <android-base/strings.h>
+#include <android/os/BnClientCallback.h>
 #include <android/os/BnServiceCallback.h>
 #include <binder/Binder.h>
 #include <binder/IServiceManager.h>
@@ -23,6 +25,7 @@
 #include <cutils/android_filesystem_config.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <unistd.h>
 
 #include "Access.h"
 #include "ServiceManager.h"
@@ -34,12 +37,16 @@ using android::ServiceManager;
 using android::sp;
 using android::base::EndsWith;
 using android::base::GetProperty;
+using android::base::ReadFdToString;
 using android::base::StartsWith;
 using android::binder::Status;
+using android::os::BnClientCallback;
 using android::os::BnServiceCallback;
 using android::os::IServiceManager;
 using testing::_;
 using testing::ElementsAre;
+using testing::HasSubstr;
+using testing::Not;
 using testing::NiceMock;
 using testing::Return;
 
@@ -536,3 +543,75 @@ TEST(ServiceNotifications, GetMultipleNotification) {
     EXPECT_THAT(cb->registrations, ElementsAre("asdfasdf", "asdfasdf"));
     EXPECT_THAT(cb->registrations, ElementsAre("asdfasdf", "asdfasdf"));
 }
+
+class ClientCallback : public BnClientCallback {
+public:
+    Status onClients(const sp<IBinder>&, bool) override { return Status::ok(); }
+    android::status_t linkToDeath(const sp<DeathRecipient>&, void*, uint32_t) override {
+        // let SM linkToDeath
+        return android::OK;
+    }
+};
+
+// Registers the service as if from this process, which client callbacks require.
+static sp<ServiceManager> getLazyServiceManager() {
+    std::unique_ptr<MockAccess> access = std::make_unique<NiceMock<MockAccess>>();
+
+    ON_CALL(*access, getCallingContext())
+            .WillByDefault(Return(Access::CallingContext{.debugPid = getpid()}));
+    ON_CALL(*access, canAdd(_, _)).WillByDefault(Return(true));
+    ON_CALL(*access, canFind(_, _)).WillByDefault(Return(true));
+    ON_CALL(*access, canList(_)).WillByDefault(Return(true));
+
+    return sp<NiceMock<MockServiceManager>>::make(std::move(access));
+}
+
+static std::string dumpToString(const sp<ServiceManager>& sm) {
+    int fds[2];
+    if (pipe(fds) != 0) return "";
+    EXPECT_EQ(android::OK, sm->dump(fds[1], {}));
+    close(fds[1]);
+    std::string out;
+    EXPECT_TRUE(ReadFdToString(fds[0], &out));
+    close(fds[0]);
+    return out;
+}
+
+TEST(LazyServiceStats, CountsRegistrations) {
+    auto sm = getLazyServiceManager();
+
+    sp<IBinder> service = getBinder();
+    EXPECT_TRUE(sm->addService("foo", getBinder(), false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->addService("foo", service, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->addService("bar", getBinder(), false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->registerClientCallback("foo", service, sp<ClientCallback>::make()).isOk());
+
+    std::string dump = dumpToString(sm);
+    EXPECT_THAT(dump, HasSubstr("foo: running, keep-alive 5000 ms"));
+    EXPECT_THAT(dump, HasSubstr("registrations: 2, unregistrations: 0, start requests: 0"));
+    // bar has no client callback, so it isn't a lazy service
+    EXPECT_THAT(dump, Not(HasSubstr("bar")));
+}
+
+TEST(LazyServiceStats, KeepAliveOverrides) {
+    auto sm = getLazyServiceManager();
+    sm->setClientKeepAlive("", std::chrono::milliseconds(1000));
+    sm->setClientKeepAlive("foo", std::chrono::milliseconds(30000));
+
+    sp<IBinder> foo = getBinder();
+    sp<IBinder> bar = getBinder();
+    EXPECT_TRUE(sm->addService("foo", foo, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->addService("bar", bar, false /*allowIsolated*/,
+        IServiceManager::DUMP_FLAG_PRIORITY_DEFAULT).isOk());
+    EXPECT_TRUE(sm->registerClientCallback("foo", foo, sp<ClientCallback>::make()).isOk());
+    EXPECT_TRUE(sm->registerClientCallback("bar", bar, sp<ClientCallback>::make()).isOk());
+
+    std::string dump = dumpToString(sm);
+    EXPECT_THAT(dump, HasSubstr("default keep-alive 1000 ms"));
+    EXPECT_THAT(dump, HasSubstr("foo: running, keep-alive 30000 ms"));
+    EXPECT_THAT(dump, HasSubstr("bar: running, keep-alive 1000 ms"));
+}
@@ -73,6 +73,12 @@ class BaseFuture<Self, T, std::future> {
     return std::get<Impl>(self()).get();
   }
 
+  void wait() const {
+    if (!std::holds_alternative<T>(self())) {
+      std::get<Impl>(self()).wait();
+    }
+  }
+
   template <class Rep, class Period>
   std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout_duration) const {
     if (std::holds_alternative<T>(self())) {
@@ -100,6 +106,12 @@ class BaseFuture<Self, T, std::shared_future> {
     return std::get<Impl>(self()).get();
   }
 
+  void wait() const {
+    if (!std::holds_alternative<T>(self())) {
+      std::get<Impl>(self()).wait();
+    }
+  }
+
   template <class Rep, class Period>
   std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout_duration) const {
     if (std::holds_alternative<T>(self())) {
@@ -21,11 +21,113 @@
 #include <ftl/small_vector.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace android::ftl {
+namespace details {
+
+template <typename K, typename = void>
+struct is_hashable : std::false_type {};
+
+template <typename K>
+struct is_hashable<K, std::void_t<decltype(std::hash<K>{}(std::declval<const K&>()))>>
+    : std::true_type {};
+
+// Open-addressed hash index from keys to positions in the contiguous storage of a SmallMap. Slots
+// hold positions offset by one, so that zero marks an empty slot. The load factor is kept at or
+// below one half, so linear probing stays short.
+template <typename K>
+class SmallMapIndex {
+ public:
+  bool active() const { return !slots_.empty(); }
+  void clear() { slots_.clear(); }
+
+  template <typename Map>
+  void rebuild(const Map& map) {
+    std::size_t capacity = 32;
+    while (capacity < 2 * map.size()) capacity *= 2;
+    slots_.assign(capacity, 0);
+    for (std::size_t pos = 0; pos < map.size(); ++pos) {
+      slots_[free_slot(map[pos].first)] = static_cast<std::uint32_t>(pos + 1);
+    }
+  }
+
+  // Indexes the last mapping, which was just emplaced.
+  template <typename Map>
+  void on_emplace_back(const Map& map) {
+    if (2 * map.size() > slots_.size()) {
+      rebuild(map);
+    } else {
+      const std::size_t pos = map.size() - 1;
+      slots_[free_slot(map[pos].first)] = static_cast<std::uint32_t>(pos + 1);
+    }
+  }
+
+  // Returns the position of the key, or the size of the map if not found.
+  template <typename Map>
+  std::size_t find(const Map& map, const K& key) const {
+    for (std::size_t slot = home(key);; slot = next(slot)) {
+      const std::uint32_t entry = slots_[slot];
+      if (entry == 0) return map.size();
+      if (map[entry - 1].first == key) return entry - 1;
+    }
+  }
+
+  // Unindexes the mapping at pos before it is erased by moving the last mapping into its place.
+  template <typename Map>
+  void on_unstable_erase(const Map& map, std::size_t pos) {
+    remove(map, slot_of(map, pos));
+
+    const std::size_t last = map.size() - 1;
+    if (pos != last) {
+      slots_[slot_of(map, last)] = static_cast<std::uint32_t>(pos + 1);
+    }
+  }
+
+ private:
+  std::size_t home(const K& key) const { return std::hash<K>{}(key) & (slots_.size() - 1); }
+  std::size_t next(std::size_t slot) const { return (slot + 1) & (slots_.size() - 1); }
+
+  std::size_t free_slot(const K& key) const {
+    std::size_t slot = home(key);
+    while (slots_[slot] != 0) slot = next(slot);
+    return slot;
+  }
+
+  template <typename Map>
+  std::size_t slot_of(const Map& map, std::size_t pos) const {
+    std::size_t slot = home(map[pos].first);
+    while (slots_[slot] != pos + 1) slot = next(slot);
+    return slot;
+  }
+
+  // Empties the slot, and shifts back the entries of its probe sequence so that lookups do not
+  // stop early at the hole.
+  template <typename Map>
+  void remove(const Map& map, std::size_t hole) {
+    for (std::size_t slot = next(hole); slots_[slot] != 0; slot = next(slot)) {
+      const std::size_t ideal = home(map[slots_[slot] - 1].first);
+      // Move the entry into the hole unless its ideal slot lies cyclically in (hole, slot].
+      const bool reachable = hole <= slot ? (hole < ideal && ideal <= slot)
+                                          : (hole < ideal || ideal <= slot);
+      if (!reachable) {
+        slots_[hole] = slots_[slot];
+        hole = slot;
+      }
+    }
+    slots_[hole] = 0;
+  }
+
+  std::vector<std::uint32_t> slots_;
+};
+
+struct NoSmallMapIndex {};
+
+}  // namespace details
 
 // Associative container with unique, unordered keys. Unlike std::unordered_map, key-value pairs are
 // stored in contiguous storage for cache efficiency. The map is allocated statically until its size
@@ -36,6 +138,10 @@ namespace android::ftl {
 //
 // SmallMap<K, V, 0> unconditionally allocates on the heap.
 //
+// Lookup is a linear search while the map is small. If K is hashable with std::hash and KeyEqual is
+// the default, then a hash index is built once the map grows past kIndexThreshold mappings, so that
+// lookups in large maps take constant time. Iteration order is unaffected by the index.
+//
 // Example usage:
 //
 //   ftl::SmallMap<int, std::string, 3> map;
@@ -65,6 +171,11 @@ template <typename K, typename V, std::size_t N, typename KeyEqual = std::equal_
 class SmallMap final {
   using Map = SmallVector<std::pair<const K, V>, N>;
 
+  static constexpr bool kIndexed =
+      details::is_hashable<K>::value && std::is_same_v<KeyEqual, std::equal_to<K>>;
+  using Index =
+      std::conditional_t<kIndexed, details::SmallMapIndex<K>, details::NoSmallMapIndex>;
+
   template <typename, typename, std::size_t, typename>
   friend class SmallMap;
 
@@ -101,14 +212,20 @@ class SmallMap final {
   SmallMap(InitializerList<U, std::index_sequence<Sizes...>, Types...>&& list)
       : map_(std::move(list)) {
     deduplicate();
+    reindex();
   }
 
   // Copies or moves key-value pairs from a convertible map.
   template <typename Q, typename W, std::size_t M, typename E>
-  SmallMap(SmallMap<Q, W, M, E> other) : map_(std::move(other.map_)) {}
+  SmallMap(SmallMap<Q, W, M, E> other) : map_(std::move(other.map_)) {
+    reindex();
+  }
 
   static constexpr size_type static_capacity() { return N; }
 
+  // The size past which lookups go through a hash index, if K is hashable.
+  static constexpr size_type kIndexThreshold = 16;
+
   size_type max_size() const { return map_.max_size(); }
   size_type size() const { return map_.size(); }
   bool empty() const { return map_.empty(); }
@@ -146,26 +263,29 @@ class SmallMap final {
   //   assert(d == 'D');
   //
   auto get(const key_type& key) const -> Optional<std::reference_wrapper<const mapped_type>> {
-    for (const auto& [k, v] : *this) {
-      if (KeyEqual{}(k, key)) {
-        return std::cref(v);
-      }
+    if (const auto it = find(key); it != end()) {
+      return std::cref(it->second);
     }
     return {};
   }
 
   auto get(const key_type& key) -> Optional<std::reference_wrapper<mapped_type>> {
-    for (auto& [k, v] : *this) {
-      if (KeyEqual{}(k, key)) {
-        return std::ref(v);
-      }
+    if (const auto it = find(key); it != end()) {
+      return std::ref(it->second);
     }
     return {};
   }
 
   // Returns an iterator to an existing mapping for the given key, or the end() iterator otherwise.
   const_iterator find(const key_type& key) const { return const_cast<SmallMap&>(*this).find(key); }
-  iterator find(const key_type& key) { return find(key, begin()); }
+  iterator find(const key_type& key) {
+    if constexpr (kIndexed) {
+      if (index_.active()) {
+        return begin() + static_cast<difference_type>(index_.find(map_, key));
+      }
+    }
+    return find(key, begin());
+  }
 
   // Inserts a mapping unless it exists. Returns an iterator to the inserted or existing mapping,
   // and whether the mapping was inserted.
@@ -183,6 +303,14 @@ class SmallMap final {
         map_.emplace_back(std::piecewise_construct, std::forward_as_tuple(key),
                           std::forward_as_tuple(std::forward<Args>(args)...));
 
+    if constexpr (kIndexed) {
+      if (index_.active()) {
+        index_.on_emplace_back(map_);
+      } else if (size() > kIndexThreshold) {
+        index_.rebuild(map_);
+      }
+    }
+
     if constexpr (static_capacity() > 0) {
       return {&ref_or_it, true};
     } else {
@@ -232,13 +360,21 @@ class SmallMap final {
   //
   // The last() and end() iterators, as well as those to the erased mapping, are invalidated.
   //
-  bool erase(const key_type& key) { return erase(key, begin()); }
+  bool erase(const key_type& key) {
+    const auto it = find(key);
+    if (it == end()) return false;
+    erase(it);
+    return true;
+  }
 
   // Removes all mappings.
   //
   // All iterators are invalidated.
   //
-  void clear() { map_.clear(); }
+  void clear() {
+    map_.clear();
+    if constexpr (kIndexed) index_.clear();
+  }
 
  private:
   iterator find(const key_type& key, iterator first) {
@@ -249,10 +385,29 @@ class SmallMap final {
   bool erase(const key_type& key, iterator first) {
     const auto it = find(key, first);
     if (it == end()) return false;
-    map_.unstable_erase(it);
+    erase(it);
     return true;
   }
 
+  void erase(iterator it) {
+    if constexpr (kIndexed) {
+      if (index_.active()) {
+        index_.on_unstable_erase(map_, static_cast<std::size_t>(it - begin()));
+      }
+    }
+    map_.unstable_erase(it);
+  }
+
+  void reindex() {
+    if constexpr (kIndexed) {
+      if (size() > kIndexThreshold) {
+        index_.rebuild(map_);
+      } else {
+        index_.clear();
+      }
+    }
+  }
+
   void deduplicate() {
     for (auto it = begin(); it != end();) {
       if (const auto key = it->first; ++it != end()) {
@@ -262,6 +417,7 @@ class SmallMap final {
   }
 
   Map map_;
+  [[no_unique_address]] Index index_;
 };
 
 // Deduction guide for in-place constructor.
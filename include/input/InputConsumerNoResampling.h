@@ -18,6 +18,7 @@
 
 #include <utils/Looper.h>
 #include "InputTransport.h"
+#include "Resampler.h"
 
 namespace android {
 
@@ -47,14 +48,13 @@ public:
 /**
  * Consumes input events from an input channel.
  *
- * This is a re-implementation of InputConsumer that does not have resampling at the current moment.
+ * This is a re-implementation of InputConsumer that does not resample by default. Resampling can be
+ * enabled by providing a ResamplerFactory, which lets the caller choose the resampling strategy.
  * A lot of the higher-level logic has been folded into this class, to make it easier to use.
  * In the legacy class, InputConsumer, the consumption logic was partially handled in the jni layer,
  * as well as various actions like adding the fd to the Choreographer.
  *
  * TODO(b/297226446): use this instead of "InputConsumer":
- * - Add resampling to this class
- * - Allow various resampling strategies to be specified
  * - Delete the old "InputConsumer" and use this class instead, renaming it to "InputConsumer".
  * - Add tracing
  * - Update all tests to use the new InputConsumer
@@ -64,8 +64,20 @@ public:
  */
 class InputConsumerNoResampling final {
 public:
+    /**
+     * Creates the resampler for a single input device. Invoked on the looper thread the first time
+     * a motion event from that device is delivered.
+     */
+    using ResamplerFactory = std::function<std::unique_ptr<Resampler>()>;
+
+    /**
+     * @param resamplerFactory if set, batched motion events are resampled to the time returned by
+     * Resampler::getResampleTime for the requested frame, and only samples up to that time are
+     * consumed for the frame.
+     */
     explicit InputConsumerNoResampling(const std::shared_ptr<InputChannel>& channel,
-                                       sp<Looper> looper, InputConsumerCallbacks& callbacks);
+                                       sp<Looper> looper, InputConsumerCallbacks& callbacks,
+                                       ResamplerFactory resamplerFactory = nullptr);
     ~InputConsumerNoResampling();
 
     /**
@@ -79,7 +91,9 @@ public:
      * @param frameTime the time up to which consume the events. When there's double (or triple)
      * buffering, you may want to not consume all events currently available, because you could be
      * still working on an older frame, but there could already have been events that arrived that
-     * are more recent.
+     * are more recent. When resampling is enabled, this should be the frame time reported by
+     * Choreographer; batches are then cut at the resample time rather than at the arrival time of
+     * the latest sample.
      * @return whether any events were actually consumed
      */
     bool consumeBatchedInputEvents(std::optional<nsecs_t> frameTime);
@@ -165,7 +179,7 @@ private:
      * Send InputMessage to the corresponding InputConsumerCallbacks function.
      * @param msg
      */
-    void handleMessage(const InputMessage& msg) const;
+    void handleMessage(const InputMessage& msg);
 
     // Batching
     /**
@@ -206,6 +220,18 @@ private:
      * the batched MotionEvent that it received.
      */
     std::map<uint32_t, std::vector<uint32_t>> mBatchedSequenceNumbers;
+
+    // Resampling
+    const ResamplerFactory mResamplerFactory;
+    /**
+     * The resampler of each device, created on demand by mResamplerFactory. Resamplers keep the
+     * latest samples of the gesture, so they can't be shared between devices.
+     */
+    std::map<DeviceId, std::unique_ptr<Resampler>> mResamplers;
+    /**
+     * Returns the resampler for the provided device, or nullptr if resampling is disabled.
+     */
+    Resampler* getResampler(DeviceId deviceId);
 };
 
 } // namespace android
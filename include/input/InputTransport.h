@@ -147,7 +147,8 @@ struct InputMessage {
              * The "pointers" field must be the last field of the struct InputMessage.
              * When we send the struct InputMessage across the socket, we are not
              * writing the entire "pointers" array, but only the pointerCount portion
-             * of it as an optimization. Adding a field after "pointers" would break this.
+             * of it, with each pointer packed down to the axes it uses, as an
+             * optimization. Adding a field after "pointers" would break this.
              */
             struct Pointer {
                 PointerProperties properties;
@@ -221,6 +222,7 @@ struct InputMessage {
 
     bool isValid(size_t actualSize) const;
     size_t size() const;
+    // Only the first size() bytes of |msg| are written.
     void getSanitizedCopy(InputMessage* msg) const;
 };
 
@@ -277,6 +279,21 @@ public:
      */
     status_t receiveMessage(InputMessage* msg);
 
+    /* Receive up to |count| messages sent by the other endpoint with a single syscall.
+     *
+     * Messages are stored in |msgs| in the order they were sent and |outCount| is set to the
+     * number of messages received. Fewer than |count| messages being returned means the channel
+     * was drained at the time of the call.
+     *
+     * Return OK if at least one message was received.
+     * Return WOULD_BLOCK if there is no message present.
+     * Return DEAD_OBJECT if the channel's peer has been closed.
+     * Return BAD_VALUE if an invalid message was received; |outCount| is set to the number of
+     * valid messages that preceded it.
+     * Other errors probably indicate that the channel is broken.
+     */
+    status_t receiveMessages(InputMessage* msgs, size_t count, size_t* outCount);
+
     /* Tells whether there is a message in the channel available to be received.
      *
      * This is only a performance hint and may return false negative results. Clients should not
@@ -328,6 +345,10 @@ private:
                                                 android::base::unique_fd fd, sp<IBinder> token);
 
     InputChannel(const std::string name, android::base::unique_fd fd, sp<IBinder> token);
+
+    /* Decode and validate a message of |nRead| bytes that was just read from the socket, and
+     * trace it. */
+    status_t checkReceivedMessage(InputMessage& msg, size_t nRead) const;
 };
 
 /*
@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include <android-base/result.h>
 #include <input/Input.h>
+#include <utils/BitSet.h>
 #include "rust/cxx.h"
 
 namespace android {
@@ -55,6 +58,19 @@ public:
 
 private:
     rust::Box<android::input::verifier::InputVerifier> mVerifier;
+    // The rust verifier logs every event when this is set, so the fast path must not be taken.
+    const bool mLogEvents;
+
+    // The touching pointers that the rust verifier has accepted for each device, used to accept
+    // consistent ACTION_MOVE events without calling into rust. Only updated after the rust
+    // verifier has accepted an event. A device is absent if its state is not known, in which
+    // case every event goes to rust.
+    std::unordered_map<int32_t /*deviceId*/, BitSet32> mTouchingPointerIdsByDevice;
+
+    bool isConsistentMove(int32_t deviceId, int32_t action, uint32_t pointerCount,
+                          const PointerProperties* pointerProperties) const;
+    void updateTouchingPointers(int32_t deviceId, int32_t action, uint32_t pointerCount,
+                                const PointerProperties* pointerProperties);
 };
 
 } // namespace android
@@ -114,6 +114,16 @@ public:
 
     std::unique_ptr<MotionEvent> predict(nsecs_t timestamp);
 
+    /**
+     * Same as predict(nsecs_t), but writes the prediction into a caller-owned event instead of
+     * allocating a new one. Reusing the same event on every frame keeps its sample storage
+     * allocated, so steady-state prediction does not allocate.
+     *
+     * @return true if a prediction was written to |outPrediction|. If false, the contents of
+     * |outPrediction| are unspecified.
+     */
+    bool predict(nsecs_t timestamp, MotionEvent& outPrediction);
+
     bool isPredictionAvailable(int32_t deviceId, int32_t source);
 
 private:
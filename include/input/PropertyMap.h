@@ -81,8 +81,10 @@ public:
     static android::base::Result<std::unique_ptr<PropertyMap>> load(const char* filename);
 
 private:
-    /* Returns true if the property map contains the specified key. */
-    bool hasProperty(const std::string& key) const;
+    /* Returns the unparsed value of the specified key without copying it, or nullptr if the key
+     * wasn't found.
+     */
+    const std::string* findValue(const std::string& key) const;
 
     class Parser {
         PropertyMap* mMap;
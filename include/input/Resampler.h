@@ -0,0 +1,163 @@
+/**
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <input/Input.h>
+#include <input/InputTransport.h>
+#include <input/MotionPredictor.h>
+#include <input/RingBuffer.h>
+#include <utils/Timers.h>
+
+namespace android {
+
+/**
+ * Resamples the batched motion events produced by InputConsumerNoResampling so that the last
+ * sample of each event lines up with the frame that is going to draw it, rather than with the
+ * arrival time of the most recent hardware report.
+ *
+ * The consumer owns one Resampler per input device. All of the methods are invoked on the looper
+ * thread of the consumer.
+ */
+class Resampler {
+public:
+    virtual ~Resampler() = default;
+
+    /**
+     * Returns the time that the events consumed for a frame starting at frameTime should be
+     * resampled to. Samples that are newer than both frameTime and the returned time are left in
+     * the batch for the next frame.
+     */
+    virtual nsecs_t getResampleTime(nsecs_t frameTime) const = 0;
+
+    /**
+     * Tries to append a sample at resampleTime to motionEvent. If resampling is not possible, the
+     * event is left untouched.
+     * @param resampleTime the value returned by getResampleTime for the current frame.
+     * @param motionEvent a batched event that is about to be delivered to the application.
+     * @param futureSample the oldest sample of the same device that was not consumed for this
+     * frame, or nullptr if the batch was consumed in its entirety.
+     */
+    virtual void resampleMotionEvent(nsecs_t resampleTime, MotionEvent& motionEvent,
+                                     const InputMessage* futureSample) = 0;
+
+    /**
+     * Notifies the resampler about a motion event that was delivered without batching, such as a
+     * DOWN or an UP. Implementations should use it to start or end the current gesture.
+     */
+    virtual void onUnbatchedMotionEvent(const MotionEvent& motionEvent) = 0;
+};
+
+/**
+ * Interpolates between the two samples surrounding the resample time, or extrapolates from the two
+ * most recent samples when no future sample is available. This is the same scheme that the legacy
+ * InputConsumer uses, including its latency and prediction limits.
+ */
+class LinearResampler : public Resampler {
+public:
+    nsecs_t getResampleTime(nsecs_t frameTime) const override;
+
+    void resampleMotionEvent(nsecs_t resampleTime, MotionEvent& motionEvent,
+                             const InputMessage* futureSample) override;
+
+    void onUnbatchedMotionEvent(const MotionEvent& motionEvent) override;
+
+protected:
+    struct Pointer {
+        PointerProperties properties;
+        PointerCoords coords;
+    };
+
+    struct Sample {
+        nsecs_t eventTime;
+        std::vector<Pointer> pointers;
+
+        const PointerCoords* getCoordsById(int32_t id) const;
+    };
+
+    /**
+     * Stores the real (non-resampled) samples of motionEvent as the latest samples of the gesture.
+     * Returns false if motionEvent is not a candidate for resampling, in which case the history is
+     * cleared.
+     */
+    bool recordSamples(const MotionEvent& motionEvent);
+
+    /**
+     * Appends a sample at resampleTime to motionEvent, linearly interpolated towards futureSample
+     * or extrapolated from the last two recorded samples.
+     */
+    void resampleLinear(nsecs_t resampleTime, MotionEvent& motionEvent,
+                        const InputMessage* futureSample) const;
+
+    /**
+     * Appends a sample at resampleTime whose coordinates are produced by resampleCoords, which is
+     * invoked once per pointer of the latest recorded sample. Does nothing if resampleTime is not
+     * newer than the latest recorded sample.
+     */
+    void addResampledSample(
+            nsecs_t resampleTime, MotionEvent& motionEvent,
+            const std::function<bool(int32_t id, const PointerCoords& current,
+                                     PointerCoords& outCoords)>& resampleCoords) const;
+
+    // The latest real samples of the current gesture, oldest first.
+    RingBuffer<Sample> mLatestSamples{3};
+};
+
+/**
+ * Fits a Catmull-Rom spline through the sample preceding the resample time, the sample after it,
+ * and their neighbours. Unlike linear interpolation, this keeps the curvature of fast strokes
+ * instead of cutting their corners. Extrapolation falls back to the linear scheme, since higher
+ * order extrapolation overshoots on noisy input.
+ */
+class CatmullRomResampler final : public LinearResampler {
+public:
+    void resampleMotionEvent(nsecs_t resampleTime, MotionEvent& motionEvent,
+                             const InputMessage* futureSample) override;
+};
+
+/**
+ * Extrapolates the gesture to the expected present time of the frame using MotionPredictor,
+ * instead of resampling slightly in the past of the frame time. Events that the predictor does not
+ * support (for example, non-stylus events) are resampled linearly.
+ */
+class PredictingResampler final : public LinearResampler {
+public:
+    /**
+     * @param presentTimeOffset the expected delay between the frame time and the time at which the
+     * frame is presented, as reported by Choreographer.
+     * @param predictor the predictor to use. It must not be shared with other resamplers.
+     */
+    PredictingResampler(nsecs_t presentTimeOffset, std::unique_ptr<MotionPredictor> predictor);
+
+    nsecs_t getResampleTime(nsecs_t frameTime) const override;
+
+    void resampleMotionEvent(nsecs_t resampleTime, MotionEvent& motionEvent,
+                             const InputMessage* futureSample) override;
+
+    void onUnbatchedMotionEvent(const MotionEvent& motionEvent) override;
+
+private:
+    const nsecs_t mPresentTimeOffset;
+    const std::unique_ptr<MotionPredictor> mPredictor;
+    // Reused across frames so that steady-state prediction does not allocate.
+    MotionEvent mPrediction;
+};
+
+} // namespace android
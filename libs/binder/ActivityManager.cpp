@@ -16,21 +16,111 @@
 
 #include <mutex>
 #include <unistd.h>
+#include <unordered_map>
 
 #include <android/permission_manager.h>
 #include <binder/ActivityManager.h>
 #include <binder/Binder.h>
 #include <binder/IServiceManager.h>
+#include <binder/IUidObserver.h>
 #include <binder/ProcessState.h>
 
 #include <utils/SystemClock.h>
 
 namespace android {
 
+// Process states of uids, kept up to date by uid observer notifications.
+class ActivityManager::UidStateCache : public BnUidObserver, public IBinder::DeathRecipient {
+public:
+    explicit UidStateCache(const String16& callingPackage) : mCallingPackage(callingPackage) {}
+
+    status_t registerObserver(const sp<IActivityManager>& service) {
+        std::lock_guard<std::mutex> registerLock(mRegisterLock);
+        if (registered()) return NO_ERROR;
+        status_t status =
+                service->registerUidObserver(sp<IUidObserver>::fromExisting(this),
+                                             UID_OBSERVER_PROCSTATE | UID_OBSERVER_GONE,
+                                             PROCESS_STATE_UNKNOWN, mCallingPackage);
+        if (status != NO_ERROR) return status;
+        IInterface::asBinder(service)->linkToDeath(sp<DeathRecipient>::fromExisting(this));
+
+        std::lock_guard<std::mutex> _l(mLock);
+        mRegistered = true;
+        return NO_ERROR;
+    }
+
+    bool registered() {
+        std::lock_guard<std::mutex> _l(mLock);
+        return mRegistered;
+    }
+
+    // Returns false if uid is not cached. In that case, outGeneration is set for insert().
+    bool lookup(uid_t uid, int32_t* outState, uint64_t* outGeneration) {
+        std::lock_guard<std::mutex> _l(mLock);
+        auto it = mStates.find(uid);
+        if (mRegistered && it != mStates.end()) {
+            *outState = it->second;
+            return true;
+        }
+        *outGeneration = mGeneration;
+        return false;
+    }
+
+    // Caches a state read from the activity manager, unless a notification arrived since the
+    // lookup that returned generation, in which case the state may already be stale.
+    void insert(uid_t uid, int32_t state, uint64_t generation) {
+        std::lock_guard<std::mutex> _l(mLock);
+        if (mRegistered && generation == mGeneration && state != PROCESS_STATE_UNKNOWN) {
+            mStates[uid] = state;
+        }
+    }
+
+    void onUidGone(uid_t uid, bool /*disabled*/) override {
+        update(uid, PROCESS_STATE_NONEXISTENT);
+    }
+    void onUidActive(uid_t /*uid*/) override {}
+    void onUidIdle(uid_t /*uid*/, bool /*disabled*/) override {}
+    void onUidStateChanged(uid_t uid, int32_t procState, int64_t /*procStateSeq*/,
+                           int32_t /*capability*/) override {
+        update(uid, procState);
+    }
+    void onUidProcAdjChanged(uid_t /*uid*/, int32_t /*adj*/) override {}
+
+    // The registration died with the activity manager, so nothing cached can be trusted anymore.
+    void binderDied(const wp<IBinder>& /*who*/) override {
+        std::lock_guard<std::mutex> _l(mLock);
+        mRegistered = false;
+        mStates.clear();
+        mGeneration++;
+    }
+
+private:
+    void update(uid_t uid, int32_t state) {
+        std::lock_guard<std::mutex> _l(mLock);
+        mGeneration++;
+        if (mRegistered) mStates[uid] = state;
+    }
+
+    const String16 mCallingPackage;
+    std::mutex mRegisterLock;
+    std::mutex mLock; // for below
+    bool mRegistered = false;
+    uint64_t mGeneration = 0;
+    std::unordered_map<uid_t, int32_t> mStates;
+};
+
 ActivityManager::ActivityManager()
 {
 }
 
+ActivityManager::~ActivityManager()
+{
+    if (mUidStateCache != nullptr && mService != nullptr && mUidStateCache->registered()) {
+        mService->unregisterUidObserver(mUidStateCache);
+        IInterface::asBinder(mService)->unlinkToDeath(mUidStateCache);
+    }
+}
+
 sp<IActivityManager> ActivityManager::getService()
 {
     std::lock_guard<Mutex> scoped_lock(mLock);
@@ -140,11 +230,70 @@ bool ActivityManager::isUidActive(const uid_t uid, const String16& callingPackag
 
 int32_t ActivityManager::getUidProcessState(const uid_t uid, const String16& callingPackage)
 {
+    int32_t state;
+    getUidProcessStates(1, &uid, &state, callingPackage);
+    return state;
+}
+
+void ActivityManager::getUidProcessStates(size_t length, const uid_t* uids, int32_t* states,
+                                          const String16& callingPackage)
+{
+    sp<UidStateCache> cache = getUidStateCache();
+    sp<IActivityManager> service;
+    for (size_t i = 0; i < length; i++) {
+        uint64_t generation = 0;
+        if (cache != nullptr && cache->lookup(uids[i], &states[i], &generation)) continue;
+
+        if (service == nullptr) service = getService();
+        if (service == nullptr) {
+            states[i] = PROCESS_STATE_UNKNOWN;
+            continue;
+        }
+        states[i] = service->getUidProcessState(uids[i], callingPackage);
+        if (cache != nullptr) cache->insert(uids[i], states[i], generation);
+    }
+}
+
+status_t ActivityManager::enableUidProcessStateCache(const String16& callingPackage)
+{
+    {
+        std::lock_guard<Mutex> scoped_lock(mLock);
+        if (mUidStateCache != nullptr) return NO_ERROR;
+    }
+
     sp<IActivityManager> service = getService();
-    if (service != nullptr) {
-        return service->getUidProcessState(uid, callingPackage);
+    if (service == nullptr) {
+        // ActivityManagerService appears dead. Return usual error code for dead service.
+        return DEAD_OBJECT;
+    }
+    sp<UidStateCache> cache = sp<UidStateCache>::make(callingPackage);
+    if (status_t status = cache->registerObserver(service); status != NO_ERROR) return status;
+
+    {
+        std::lock_guard<Mutex> scoped_lock(mLock);
+        if (mUidStateCache == nullptr) {
+            mUidStateCache = cache;
+            return NO_ERROR;
+        }
     }
-    return PROCESS_STATE_UNKNOWN;
+    // Lost a race with another thread enabling the cache.
+    service->unregisterUidObserver(cache);
+    IInterface::asBinder(service)->unlinkToDeath(cache);
+    return NO_ERROR;
+}
+
+sp<ActivityManager::UidStateCache> ActivityManager::getUidStateCache()
+{
+    sp<UidStateCache> cache;
+    {
+        std::lock_guard<Mutex> scoped_lock(mLock);
+        cache = mUidStateCache;
+    }
+    if (cache == nullptr || cache->registered()) return cache;
+
+    sp<IActivityManager> service = getService();
+    if (service == nullptr || cache->registerObserver(service) != NO_ERROR) return nullptr;
+    return cache;
 }
 
 status_t ActivityManager::checkPermission(const String16& permission,
@@ -19,6 +19,7 @@
 #include <atomic>
 #include <set>
 
+#include <binder/BinderTransactionStats.h>
 #include <binder/BpBinder.h>
 #include <binder/IInterface.h>
 #include <binder/IPCThreadState.h>
@@ -40,6 +41,7 @@
 #include "BuildFlags.h"
 #include "OS.h"
 #include "RpcState.h"
+#include "TransactionRecorder.h"
 
 namespace android {
 
@@ -274,7 +276,7 @@ public:
     std::set<sp<RpcServerLink>> mRpcServerLinks;
     BpBinder::ObjectManager mObjects;
 
-    unique_fd mRecordingFd;
+    std::shared_ptr<TransactionRecorder> mRecorder;
 };
 
 // ---------------------------------------------------------------------------
@@ -311,10 +313,19 @@ status_t BBinder::startRecordingTransactions(const Parcel& data) {
         ALOGI("Could not start Binder recording. Another is already in progress.");
         return INVALID_OPERATION;
     } else {
-        status_t readStatus = data.readUniqueFileDescriptor(&(e->mRecordingFd));
+        unique_fd fd;
+        status_t readStatus = data.readUniqueFileDescriptor(&fd);
         if (readStatus != OK) {
             return readStatus;
         }
+        // Older clients only send the fd, and record every transaction.
+        uint32_t samplingInterval = 1;
+        if (data.dataAvail() > 0) {
+            if (readStatus = data.readUint32(&samplingInterval); readStatus != OK) {
+                return readStatus;
+            }
+        }
+        e->mRecorder = std::make_shared<TransactionRecorder>(std::move(fd), samplingInterval);
         mRecordingOn = true;
         ALOGI("Started Binder recording.");
         return NO_ERROR;
@@ -336,16 +347,21 @@ status_t BBinder::stopRecordingTransactions() {
         return PERMISSION_DENIED;
     }
     Extras* e = getOrCreateExtras();
-    RpcMutexUniqueLock lock(e->mLock);
-    if (mRecordingOn) {
-        e->mRecordingFd.reset();
+    std::shared_ptr<TransactionRecorder> recorder;
+    {
+        RpcMutexUniqueLock lock(e->mLock);
+        if (!mRecordingOn) {
+            ALOGI("Could not stop Binder recording. One is not in progress.");
+            return INVALID_OPERATION;
+        }
+        recorder = std::move(e->mRecorder);
         mRecordingOn = false;
-        ALOGI("Stopped Binder recording.");
-        return NO_ERROR;
-    } else {
-        ALOGI("Could not stop Binder recording. One is not in progress.");
-        return INVALID_OPERATION;
     }
+    // Flush outside of the lock, so that transactions racing with this one are not blocked on
+    // the file.
+    recorder->stop();
+    ALOGI("Stopped Binder recording.");
+    return NO_ERROR;
 }
 
 const String16& BBinder::getInterfaceDescriptor() const
@@ -388,6 +404,17 @@ status_t BBinder::transact(
             err = setRpcClientDebug(data);
             break;
         }
+        case TRANSACTION_STATS_TRANSACTION: {
+            LOG_ALWAYS_FATAL_IF(reply == nullptr, "reply == nullptr");
+            if (!kEnableKernelIpc) {
+                err = INVALID_OPERATION;
+                break;
+            }
+            BinderTransactionStats stats;
+            IPCThreadState::getTransactionStats(&stats);
+            err = stats.writeToParcel(reply);
+            break;
+        }
         default:
             err = onTransact(code, data, reply, flags);
             break;
@@ -404,21 +431,16 @@ status_t BBinder::transact(
 
     if (kEnableKernelIpc && mRecordingOn && code != START_RECORDING_TRANSACTION) [[unlikely]] {
         Extras* e = mExtras.load(std::memory_order_acquire);
-        RpcMutexUniqueLock lock(e->mLock);
-        if (mRecordingOn) {
+        std::shared_ptr<TransactionRecorder> recorder;
+        {
+            RpcMutexLockGuard lock(e->mLock);
+            recorder = e->mRecorder;
+        }
+        // Serialization happens on this thread, but the write to the recording fd does not.
+        if (recorder) {
             Parcel emptyReply;
-            timespec ts;
-            timespec_get(&ts, TIME_UTC);
-            auto transaction = android::binder::debug::RecordedTransaction::
-                    fromDetails(getInterfaceDescriptor(), code, flags, ts, data,
-                                reply ? *reply : emptyReply, err);
-            if (transaction) {
-                if (status_t err = transaction->dumpToFile(e->mRecordingFd); err != NO_ERROR) {
-                    ALOGI("Failed to dump RecordedTransaction to file with error %d", err);
-                }
-            } else {
-                ALOGI("Failed to create RecordedTransaction object.");
-            }
+            recorder->record(getInterfaceDescriptor(), code, flags, data,
+                             reply ? *reply : emptyReply, err);
         }
     }
 
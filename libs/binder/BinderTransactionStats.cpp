@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <binder/BinderTransactionStats.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <binder/IBinder.h>
+#include <binder/Parcel.h>
+
+namespace android {
+
+size_t BinderTransactionStats::latencyBucket(int64_t latencyNs) {
+    uint64_t us = latencyNs > 0 ? static_cast<uint64_t>(latencyNs) / 1000 : 0;
+    if (us == 0) return 0;
+    return std::min<size_t>(63 - __builtin_clzll(us), kLatencyBuckets - 1);
+}
+
+size_t BinderTransactionStats::codeSlot(uint32_t code) {
+    if (code >= IBinder::FIRST_CALL_TRANSACTION &&
+        code - IBinder::FIRST_CALL_TRANSACTION < kTrackedCodes) {
+        return code - IBinder::FIRST_CALL_TRANSACTION;
+    }
+    return kTrackedCodes;
+}
+
+// Arrays are sent with their size, so that both ends may disagree on kLatencyBuckets and
+// kTrackedCodes.
+template <size_t N>
+static status_t writeArray(Parcel* parcel, const std::array<uint64_t, N>& values) {
+    return parcel->writeUint64Vector(std::vector<uint64_t>(values.begin(), values.end()));
+}
+
+template <size_t N>
+static status_t readArray(const Parcel& parcel, std::array<uint64_t, N>* values) {
+    std::vector<uint64_t> read;
+    if (status_t status = parcel.readUint64Vector(&read); status != OK) return status;
+    values->fill(0);
+    std::copy_n(read.begin(), std::min(read.size(), N), values->begin());
+    return OK;
+}
+
+static status_t writeDirection(Parcel* parcel, const BinderTransactionStats::Direction& d) {
+    for (uint64_t value : {d.calls, d.onewayCalls, d.errors, d.dataBytes, d.replyBytes}) {
+        if (status_t status = parcel->writeUint64(value); status != OK) return status;
+    }
+    if (status_t status = writeArray(parcel, d.latencyHistogram); status != OK) return status;
+    return writeArray(parcel, d.callsPerCode);
+}
+
+static status_t readDirection(const Parcel& parcel, BinderTransactionStats::Direction* d) {
+    for (uint64_t* value : {&d->calls, &d->onewayCalls, &d->errors, &d->dataBytes,
+                            &d->replyBytes}) {
+        if (status_t status = parcel.readUint64(value); status != OK) return status;
+    }
+    if (status_t status = readArray(parcel, &d->latencyHistogram); status != OK) return status;
+    return readArray(parcel, &d->callsPerCode);
+}
+
+status_t BinderTransactionStats::writeToParcel(Parcel* parcel) const {
+    if (status_t status = writeDirection(parcel, outgoing); status != OK) return status;
+    if (status_t status = writeDirection(parcel, incoming); status != OK) return status;
+    if (status_t status = parcel->writeUint32(onewayInFlight); status != OK) return status;
+    return parcel->writeUint32(maxOnewayInFlight);
+}
+
+status_t BinderTransactionStats::readFromParcel(const Parcel& parcel) {
+    if (status_t status = readDirection(parcel, &outgoing); status != OK) return status;
+    if (status_t status = readDirection(parcel, &incoming); status != OK) return status;
+    if (status_t status = parcel.readUint32(&onewayInFlight); status != OK) return status;
+    return parcel.readUint32(&maxOnewayInFlight);
+}
+
+} // namespace android
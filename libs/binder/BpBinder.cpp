@@ -338,6 +338,13 @@ status_t BpBinder::startRecordingBinder(const unique_fd& fd) {
     return transact(START_RECORDING_TRANSACTION, send, &reply);
 }
 
+status_t BpBinder::startRecordingBinder(const unique_fd& fd, uint32_t samplingInterval) {
+    Parcel send, reply;
+    send.writeUniqueFileDescriptor(fd);
+    send.writeUint32(samplingInterval);
+    return transact(START_RECORDING_TRANSACTION, send, &reply);
+}
+
 status_t BpBinder::stopRecordingBinder() {
     Parcel data, reply;
     data.markForBinder(sp<BpBinder>::fromExisting(this));
@@ -364,25 +371,8 @@ status_t BpBinder::transact(
 {
     // Once a binder has died, it will never come back to life.
     if (mAlive) {
-        bool privateVendor = flags & FLAG_PRIVATE_VENDOR;
-        // don't send userspace flags to the kernel
-        flags = flags & ~static_cast<uint32_t>(FLAG_PRIVATE_VENDOR);
-
-        // user transactions require a given stability level
-        if (code >= FIRST_CALL_TRANSACTION && code <= LAST_CALL_TRANSACTION) {
-            using android::internal::Stability;
-
-            int16_t stability = Stability::getRepr(this);
-            Stability::Level required = privateVendor ? Stability::VENDOR
-                : Stability::getLocalLevel();
-
-            if (!Stability::check(stability, required)) [[unlikely]] {
-                ALOGE("Cannot do a user transaction on a %s binder (%s) in a %s context.",
-                      Stability::levelString(stability).c_str(),
-                      String8(getInterfaceDescriptor()).c_str(),
-                      Stability::levelString(required).c_str());
-                return BAD_TYPE;
-            }
+        if (status_t status = checkTransactionStability(code, &flags); status != OK) {
+            return status;
         }
 
         status_t status;
@@ -411,6 +401,51 @@ status_t BpBinder::transact(
     return DEAD_OBJECT;
 }
 
+status_t BpBinder::transactAsync(uint32_t code, const Parcel& data, Parcel* reply, uint32_t flags,
+                                 std::function<void(status_t)>&& callback) {
+    if (!isRpcBinder()) {
+        ALOGE("Asynchronous transactions are only supported on RPC binders.");
+        return INVALID_OPERATION;
+    }
+    if (!mAlive) return DEAD_OBJECT;
+    if (status_t status = checkTransactionStability(code, &flags); status != OK) return status;
+
+    return rpcSession()->transactAsync(sp<IBinder>::fromExisting(this), code, data, reply, flags,
+                                       [self = sp<BpBinder>::fromExisting(this),
+                                        callback = std::move(callback)](status_t status) {
+                                           if (status == DEAD_OBJECT) self->mAlive = 0;
+                                           callback(status);
+                                       });
+}
+
+status_t BpBinder::checkTransactionStability(uint32_t code, uint32_t* flags) {
+    bool privateVendor = *flags & FLAG_PRIVATE_VENDOR;
+    // don't send userspace flags to the kernel
+    *flags = *flags & ~static_cast<uint32_t>(FLAG_PRIVATE_VENDOR);
+
+    // user transactions require a given stability level
+    if (code >= FIRST_CALL_TRANSACTION && code <= LAST_CALL_TRANSACTION) {
+        using android::internal::Stability;
+
+        Stability::Level required = privateVendor ? Stability::VENDOR
+            : Stability::getLocalLevel();
+        if (mCheckedStability.load(std::memory_order_relaxed) == required) [[likely]] {
+            return OK;
+        }
+
+        int16_t stability = Stability::getRepr(this);
+        if (!Stability::check(stability, required)) [[unlikely]] {
+            ALOGE("Cannot do a user transaction on a %s binder (%s) in a %s context.",
+                  Stability::levelString(stability).c_str(),
+                  String8(getInterfaceDescriptor()).c_str(),
+                  Stability::levelString(required).c_str());
+            return BAD_TYPE;
+        }
+        mCheckedStability.store(required, std::memory_order_relaxed);
+    }
+    return OK;
+}
+
 // NOLINTNEXTLINE(google-default-arguments)
 status_t BpBinder::linkToDeath(
     const sp<DeathRecipient>& recipient, void* cookie, uint32_t flags)
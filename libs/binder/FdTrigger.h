@@ -57,6 +57,15 @@ public:
     [[nodiscard]] status_t triggerablePoll(const android::RpcTransportFd& transportFd,
                                            int16_t event);
 
+#ifndef BINDER_RPC_SINGLE_THREADED
+    /**
+     * The read end of the pipe, which receives POLLHUP once this is triggered.
+     * This is for polling the trigger together with more FDs than
+     * triggerablePoll allows.
+     */
+    [[nodiscard]] binder::borrowed_fd pollFd() const { return mRead; }
+#endif
+
 private:
 #ifdef BINDER_RPC_SINGLE_THREADED
     bool mTriggered = false;
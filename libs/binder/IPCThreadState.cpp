@@ -19,6 +19,7 @@
 #include <binder/IPCThreadState.h>
 
 #include <binder/Binder.h>
+#include <binder/BinderTransactionStats.h>
 #include <binder/BpBinder.h>
 #include <binder/TextOutput.h>
 
@@ -26,7 +27,9 @@
 #include <utils/CallStack.h>
 #include <utils/Log.h>
 #include <utils/SystemClock.h>
+#include <utils/Timers.h>
 
+#include <algorithm>
 #include <atomic>
 #include <errno.h>
 #include <inttypes.h>
@@ -291,6 +294,65 @@ static pthread_key_t gTLS = 0;
 static std::atomic<bool> gShutdown = false;
 static std::atomic<bool> gDisableBackgroundScheduling = false;
 
+// Process-wide counters behind IPCThreadState::getTransactionStats. All updates are relaxed,
+// since readers only ever get an approximate snapshot anyway.
+struct TransactionStatsCounters {
+    struct Direction {
+        std::atomic<uint64_t> calls = 0;
+        std::atomic<uint64_t> onewayCalls = 0;
+        std::atomic<uint64_t> errors = 0;
+        std::atomic<uint64_t> dataBytes = 0;
+        std::atomic<uint64_t> replyBytes = 0;
+        std::array<std::atomic<uint64_t>, BinderTransactionStats::kLatencyBuckets>
+                latencyHistogram{};
+        std::array<std::atomic<uint64_t>, BinderTransactionStats::kTrackedCodes + 1>
+                callsPerCode{};
+
+        void record(uint32_t code, uint32_t flags, size_t dataSize, size_t replySize,
+                    nsecs_t latency, status_t err) {
+            constexpr auto relaxed = std::memory_order_relaxed;
+            calls.fetch_add(1, relaxed);
+            callsPerCode[BinderTransactionStats::codeSlot(code)].fetch_add(1, relaxed);
+            dataBytes.fetch_add(dataSize, relaxed);
+            if (err != NO_ERROR) errors.fetch_add(1, relaxed);
+            if (flags & TF_ONE_WAY) {
+                onewayCalls.fetch_add(1, relaxed);
+                return;
+            }
+            replyBytes.fetch_add(replySize, relaxed);
+            latencyHistogram[BinderTransactionStats::latencyBucket(latency)].fetch_add(1, relaxed);
+        }
+
+        void snapshot(BinderTransactionStats::Direction* out) const {
+            constexpr auto relaxed = std::memory_order_relaxed;
+            out->calls = calls.load(relaxed);
+            out->onewayCalls = onewayCalls.load(relaxed);
+            out->errors = errors.load(relaxed);
+            out->dataBytes = dataBytes.load(relaxed);
+            out->replyBytes = replyBytes.load(relaxed);
+            for (size_t i = 0; i < latencyHistogram.size(); i++) {
+                out->latencyHistogram[i] = latencyHistogram[i].load(relaxed);
+            }
+            for (size_t i = 0; i < callsPerCode.size(); i++) {
+                out->callsPerCode[i] = callsPerCode[i].load(relaxed);
+            }
+        }
+    };
+
+    Direction outgoing;
+    Direction incoming;
+    std::atomic<uint32_t> onewayInFlight = 0;
+    std::atomic<uint32_t> maxOnewayInFlight = 0;
+};
+static TransactionStatsCounters gTransactionStats;
+
+void IPCThreadState::getTransactionStats(BinderTransactionStats* stats) {
+    gTransactionStats.outgoing.snapshot(&stats->outgoing);
+    gTransactionStats.incoming.snapshot(&stats->incoming);
+    stats->onewayInFlight = gTransactionStats.onewayInFlight.load(std::memory_order_relaxed);
+    stats->maxOnewayInFlight = gTransactionStats.maxOnewayInFlight.load(std::memory_order_relaxed);
+}
+
 IPCThreadState* IPCThreadState::self()
 {
     if (gHaveTLS.load(std::memory_order_acquire)) {
@@ -642,8 +704,12 @@ status_t IPCThreadState::getAndExecuteCommand()
             ALOGI("%s", message.c_str());
         }
 
+        const int64_t startTimeNs = uptimeNanos();
+
         pthread_mutex_lock(&mProcess->mThreadCountLock);
         mProcess->mExecutingThreadsCount++;
+        mProcess->mPeakExecutingThreads =
+                std::max(mProcess->mPeakExecutingThreads, mProcess->mExecutingThreadsCount);
         if (mProcess->mExecutingThreadsCount >= mProcess->mMaxThreads &&
                 mProcess->mStarvationStartTimeMs == 0) {
             mProcess->mStarvationStartTimeMs = uptimeMillis();
@@ -652,8 +718,12 @@ status_t IPCThreadState::getAndExecuteCommand()
 
         result = executeCommand(cmd);
 
+        const int64_t busyTimeNs = uptimeNanos() - startTimeNs;
+
         pthread_mutex_lock(&mProcess->mThreadCountLock);
         mProcess->mExecutingThreadsCount--;
+        mProcess->mCommandCount++;
+        mProcess->mBusyTimeNs += busyTimeNs;
         if (mProcess->mExecutingThreadsCount < mProcess->mMaxThreads &&
                 mProcess->mStarvationStartTimeMs != 0) {
             int64_t starvationTimeMs = uptimeMillis() - mProcess->mStarvationStartTimeMs;
@@ -662,6 +732,7 @@ status_t IPCThreadState::getAndExecuteCommand()
                       mProcess->mMaxThreads, starvationTimeMs);
             }
             mProcess->mStarvationStartTimeMs = 0;
+            mProcess->onThreadPoolStarvedLocked(starvationTimeMs);
         }
 
         // Cond broadcast can be expensive, so don't send it every time a binder
@@ -825,10 +896,21 @@ status_t IPCThreadState::transact(int32_t handle,
 
     LOG_ONEWAY(">>>> SEND from pid %d uid %d %s", getpid(), getuid(),
         (flags & TF_ONE_WAY) == 0 ? "READ REPLY" : "ONE WAY");
+    if (mOnewayBatchDepth > 0) {
+        if (flags & TF_ONE_WAY) {
+            return queueOnewayTransaction(handle, code, data, flags);
+        }
+        // The driver reports the results of the queued transactions first. They must not be
+        // taken for the reply to this one.
+        flushOnewayBatch();
+    }
+    const nsecs_t startTime = (flags & TF_ONE_WAY) == 0 ? systemTime(SYSTEM_TIME_MONOTONIC) : 0;
     err = writeTransactionData(BC_TRANSACTION, flags, handle, code, data, nullptr);
 
     if (err != NO_ERROR) {
         if (reply) reply->setError(err);
+        gTransactionStats.outgoing.record(code, flags, data.dataSize(), 0,
+                                          systemTime(SYSTEM_TIME_MONOTONIC) - startTime, err);
         return (mLastError = err);
     }
 
@@ -879,6 +961,11 @@ status_t IPCThreadState::transact(int32_t handle,
         err = waitForResponse(nullptr, nullptr);
     }
 
+    gTransactionStats.outgoing.record(code, flags, data.dataSize(), reply ? reply->dataSize() : 0,
+                                      (flags & TF_ONE_WAY) == 0
+                                              ? systemTime(SYSTEM_TIME_MONOTONIC) - startTime
+                                              : 0,
+                                      err);
     return err;
 }
 
@@ -962,7 +1049,9 @@ IPCThreadState::IPCThreadState()
         mIsFlushing(false),
         mStrictModePolicy(0),
         mLastTransactionBinderFlags(0),
-        mCallRestriction(mProcess->mCallRestriction) {
+        mCallRestriction(mProcess->mCallRestriction),
+        mOnewayBatchDepth(0),
+        mOnewayBatchError(NO_ERROR) {
     pthread_setspecific(gTLS, this);
     clearCaller();
     mHasExplicitIdentity = false;
@@ -1248,6 +1337,55 @@ status_t IPCThreadState::writeTransactionData(int32_t cmd, uint32_t binderFlags,
     return NO_ERROR;
 }
 
+status_t IPCThreadState::queueOnewayTransaction(int32_t handle, uint32_t code, const Parcel& data,
+                                                uint32_t flags) {
+    if (status_t err = data.errorCheck(); err != NO_ERROR) {
+        return (mLastError = err);
+    }
+
+    // The driver reads the data when the batch is flushed, by which time the caller may have
+    // released it.
+    auto copy = std::make_unique<Parcel>();
+    if (status_t err = copy->appendFrom(&data, 0, data.dataSize()); err != NO_ERROR) {
+        return (mLastError = err);
+    }
+    if (status_t err = writeTransactionData(BC_TRANSACTION, flags, handle, code, *copy, nullptr);
+        err != NO_ERROR) {
+        return err;
+    }
+    mOnewayBatch.push_back(std::move(copy));
+    gTransactionStats.outgoing.record(code, flags, data.dataSize(), 0, 0, NO_ERROR);
+    return NO_ERROR;
+}
+
+void IPCThreadState::flushOnewayBatch() {
+    // The driver returns exactly one result per transaction. The first wait writes all of them
+    // out and reads back as many results as are ready, so the following waits rarely need to
+    // enter the driver again.
+    for (size_t i = 0; i < mOnewayBatch.size(); i++) {
+        status_t err = waitForResponse(nullptr, nullptr);
+        if (err != NO_ERROR && mOnewayBatchError == NO_ERROR) {
+            mOnewayBatchError = err;
+        }
+    }
+    mOnewayBatch.clear();
+}
+
+void IPCThreadState::beginOnewayBatch() {
+    mOnewayBatchDepth++;
+}
+
+status_t IPCThreadState::endOnewayBatch() {
+    LOG_ALWAYS_FATAL_IF(mOnewayBatchDepth == 0, "endOnewayBatch() without beginOnewayBatch()");
+    if (--mOnewayBatchDepth > 0) {
+        return NO_ERROR;
+    }
+    flushOnewayBatch();
+    const status_t err = mOnewayBatchError;
+    mOnewayBatchError = NO_ERROR;
+    return err;
+}
+
 sp<BBinder> the_context_object;
 
 void IPCThreadState::setTheContextObject(const sp<BBinder>& obj)
@@ -1398,6 +1536,23 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 std::string message = logStream.str();
                 ALOGI("%s", message.c_str());
             }
+            const bool oneway = (tr.flags & TF_ONE_WAY) != 0;
+            nsecs_t startTime = 0;
+            if (oneway) {
+                uint32_t inFlight =
+                        gTransactionStats.onewayInFlight.fetch_add(1, std::memory_order_relaxed) +
+                        1;
+                uint32_t maxInFlight =
+                        gTransactionStats.maxOnewayInFlight.load(std::memory_order_relaxed);
+                while (inFlight > maxInFlight &&
+                       !gTransactionStats.maxOnewayInFlight
+                                .compare_exchange_weak(maxInFlight, inFlight,
+                                                       std::memory_order_relaxed)) {
+                }
+            } else {
+                startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+            }
+
             if (tr.target.ptr) {
                 // We only have a weak reference on the target object, so we must first try to
                 // safely acquire a strong reference before doing anything else with it.
@@ -1414,6 +1569,15 @@ status_t IPCThreadState::executeCommand(int32_t cmd)
                 error = the_context_object->transact(tr.code, buffer, &reply, tr.flags);
             }
 
+            if (oneway) {
+                gTransactionStats.onewayInFlight.fetch_sub(1, std::memory_order_relaxed);
+            }
+            gTransactionStats.incoming.record(tr.code, tr.flags, tr.data_size, reply.dataSize(),
+                                              oneway ? 0
+                                                     : systemTime(SYSTEM_TIME_MONOTONIC) -
+                                                              startTime,
+                                              error);
+
             //ALOGI("<<<< TRANSACT from pid %d restore pid %d sid %s uid %d\n",
             //     mCallingPid, origPid, (origSid ? origSid : "<N/A>"), origUid);
 
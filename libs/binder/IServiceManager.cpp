@@ -20,11 +20,14 @@
 
 #include <inttypes.h>
 #include <unistd.h>
+#include <atomic>
 #include <condition_variable>
+#include <map>
 
 #include <android-base/properties.h>
 #include <android/os/BnServiceCallback.h>
 #include <android/os/IServiceManager.h>
+#include <binder/BpBinder.h>
 #include <binder/IPCThreadState.h>
 #include <binder/Parcel.h>
 #include <utils/Log.h>
@@ -72,6 +75,125 @@ const String16& IServiceManager::getInterfaceDescriptor() const {
 IServiceManager::IServiceManager() {}
 IServiceManager::~IServiceManager() {}
 
+static std::atomic<uint64_t> gServiceCacheHits = 0;
+static std::atomic<uint64_t> gServiceCacheMisses = 0;
+
+// Process-local name -> binder cache in front of checkService and waitForService.
+//
+// Only weak references are kept. A strong reference would count as a client of the service, so
+// lazy services could never shut down while anything in this process had once looked them up.
+// A weak reference to a kernel binder can only be promoted while something else in this process
+// still holds it strongly, so a hit never changes the refcount servicemanager sees; once the last
+// strong reference goes away the entry simply misses again.
+//
+// Entries are kept coherent with a registerForNotifications callback per cached name (which fires
+// when the name is re-registered with a new binder) and a death notification per cached binder.
+// Both are delivered on the threadpool, so nothing is cached until it has been started.
+class ServiceManagerCache : public android::os::BnServiceCallback,
+                            public IBinder::DeathRecipient {
+public:
+    explicit ServiceManagerCache(const sp<AidlServiceManager>& sm) : mServiceManager(sm) {}
+
+    // Returns the cached binder, or nullptr. On a miss, *generation must be passed back to
+    // insert() so that a result fetched concurrently with an invalidation is not cached.
+    sp<IBinder> lookup(const std::string& name, uint64_t* generation) {
+        std::lock_guard<std::mutex> lock(mLock);
+        *generation = mGeneration;
+        if (auto it = mEntries.find(name); it != mEntries.end()) {
+            if (sp<IBinder> binder = it->second.binder.promote();
+                binder != nullptr && binder->isBinderAlive()) {
+                gServiceCacheHits++;
+                return binder;
+            }
+        }
+        gServiceCacheMisses++;
+        return nullptr;
+    }
+
+    void insert(const std::string& name, const sp<IBinder>& binder, uint64_t generation) {
+        if (binder == nullptr) return;
+        // RPC binders can't be promoted from weak references and have no notifications.
+        BpBinder* remote = binder->remoteBinder();
+        if (remote != nullptr && remote->isRpcBinder()) return;
+        if (!ProcessState::self()->isThreadPoolStarted()) return;
+
+        bool needsRegistration = false;
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            if (generation != mGeneration) return;
+            Entry& entry = mEntries[name];
+            if (entry.uncacheable) return;
+            if (entry.binder.unsafe_get() == binder.get()) return;
+            entry.binder = binder;
+            needsRegistration = !entry.registered;
+            entry.registered = true;
+        }
+
+        if (remote != nullptr) {
+            if (status_t status = binder->linkToDeath(sp<ServiceManagerCache>::fromExisting(this));
+                status != OK) {
+                ALOGW("Failed to linkToDeath for cached service %s: %s", name.c_str(),
+                      statusToString(status).c_str());
+                invalidate(name, true /*uncacheable*/);
+                return;
+            }
+        }
+
+        if (needsRegistration) {
+            if (Status status = mServiceManager->registerForNotifications(
+                        name, sp<ServiceManagerCache>::fromExisting(this));
+                !status.isOk()) {
+                ALOGW("Not caching %s, failed to registerForNotifications: %s", name.c_str(),
+                      status.toString8().c_str());
+                invalidate(name, true /*uncacheable*/);
+            }
+        }
+    }
+
+    // IServiceCallback. Also called immediately on registration with the current binder.
+    Status onRegistration(const std::string& name, const sp<IBinder>& binder) override {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (auto it = mEntries.find(name); it != mEntries.end() && it->second.binder.unsafe_get() != binder.get()) {
+            it->second.binder.clear();
+            mGeneration++;
+        }
+        return Status::ok();
+    }
+
+    // IBinder::DeathRecipient
+    void binderDied(const wp<IBinder>& who) override {
+        std::lock_guard<std::mutex> lock(mLock);
+        for (auto& [name, entry] : mEntries) {
+            if (entry.binder == who) entry.binder.clear();
+        }
+        mGeneration++;
+    }
+
+private:
+    struct Entry {
+        wp<IBinder> binder;
+        bool registered = false;
+        bool uncacheable = false;
+    };
+
+    void invalidate(const std::string& name, bool uncacheable) {
+        std::lock_guard<std::mutex> lock(mLock);
+        Entry& entry = mEntries[name];
+        entry.binder.clear();
+        entry.uncacheable = uncacheable;
+        mGeneration++;
+    }
+
+    sp<AidlServiceManager> mServiceManager;
+    std::mutex mLock;
+    std::map<std::string, Entry> mEntries;
+    uint64_t mGeneration = 0;
+};
+
+IServiceManager::ServiceCacheStats getServiceCacheStats() {
+    return {.hits = gServiceCacheHits.load(), .misses = gServiceCacheMisses.load()};
+}
+
 // From the old libbinder IServiceManager interface to IServiceManager.
 class ServiceManagerShim : public IServiceManager
 {
@@ -119,6 +241,7 @@ public:
 
 protected:
     sp<AidlServiceManager> mTheRealServiceManager;
+    sp<ServiceManagerCache> mCache;
     // AidlRegistrationCallback -> services that its been registered for
     // notifications.
     using LocalRegistrationAndWaiter =
@@ -291,7 +414,7 @@ void* openDeclaredPassthroughHal(const String16& interface, const String16& inst
 // ----------------------------------------------------------------------
 
 ServiceManagerShim::ServiceManagerShim(const sp<AidlServiceManager>& impl)
- : mTheRealServiceManager(impl)
+ : mTheRealServiceManager(impl), mCache(sp<ServiceManagerCache>::make(impl))
 {}
 
 // This implementation could be simplified and made more efficient by delegating
@@ -344,10 +467,15 @@ sp<IBinder> ServiceManagerShim::getService(const String16& name) const
 
 sp<IBinder> ServiceManagerShim::checkService(const String16& name) const
 {
+    const std::string nameStr = String8(name).c_str();
+    uint64_t generation;
+    if (sp<IBinder> cached = mCache->lookup(nameStr, &generation)) return cached;
+
     sp<IBinder> ret;
-    if (!mTheRealServiceManager->checkService(String8(name).c_str(), &ret).isOk()) {
+    if (!mTheRealServiceManager->checkService(nameStr, &ret).isOk()) {
         return nullptr;
     }
+    mCache->insert(nameStr, ret, generation);
     return ret;
 }
 
@@ -404,6 +532,9 @@ sp<IBinder> ServiceManagerShim::waitForService(const String16& name16)
 
     const std::string name = String8(name16).c_str();
 
+    uint64_t generation;
+    if (sp<IBinder> cached = mCache->lookup(name, &generation)) return cached;
+
     sp<IBinder> out;
     if (Status status = realGetService(name, &out); !status.isOk()) {
         ALOGW("Failed to getService in waitForService for %s: %s", name.c_str(),
@@ -417,7 +548,10 @@ sp<IBinder> ServiceManagerShim::waitForService(const String16& name16)
         }
         return nullptr;
     }
-    if (out != nullptr) return out;
+    if (out != nullptr) {
+        mCache->insert(name, out, generation);
+        return out;
+    }
 
     sp<Waiter> waiter = sp<Waiter>::make();
     if (Status status = mTheRealServiceManager->registerForNotifications(name, waiter);
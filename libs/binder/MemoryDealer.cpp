@@ -24,6 +24,12 @@
 #include <utils/SortedVector.h>
 #include <utils/String8.h>
 
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -119,23 +125,46 @@ private:
 
 // ----------------------------------------------------------------------------
 
-class SimpleBestFitAllocator
+class HeapAllocator
 {
+public:
     enum {
         PAGE_ALIGNED = 0x00000001
     };
-public:
-    explicit SimpleBestFitAllocator(size_t size);
-    ~SimpleBestFitAllocator();
 
-    size_t      allocate(size_t size, uint32_t flags = 0);
-    status_t    deallocate(size_t offset);
-    size_t      size() const;
-    void        dump(const char* what) const;
-    void        dump(String8& res, const char* what) const;
+    virtual ~HeapAllocator() = default;
+
+    // Returns the offset of the allocation in the heap, or NO_MEMORY.
+    virtual size_t      allocate(size_t size, uint32_t flags = 0) = 0;
+    virtual status_t    deallocate(size_t offset) = 0;
+    virtual size_t      size() const = 0;
+    virtual void        dump(const char* what) const = 0;
+    virtual void        dump(String8& res, const char* what) const = 0;
 
     static size_t getAllocationAlignment() { return kMemoryAlign; }
 
+protected:
+    // Appends the external fragmentation of the free space to result.
+    static void dumpFragmentation(String8& result, size_t freeBytes, size_t freeBlocks,
+                                  size_t largestFreeBlock);
+
+    static const int    kMemoryAlign;
+};
+
+// ----------------------------------------------------------------------------
+
+class SimpleBestFitAllocator : public HeapAllocator
+{
+public:
+    explicit SimpleBestFitAllocator(size_t size);
+    ~SimpleBestFitAllocator() override;
+
+    size_t      allocate(size_t size, uint32_t flags = 0) override;
+    status_t    deallocate(size_t offset) override;
+    size_t      size() const override;
+    void        dump(const char* what) const override;
+    void        dump(String8& res, const char* what) const override;
+
 private:
 
     struct chunk_t {
@@ -154,7 +183,6 @@ private:
     void     dump_l(const char* what) const;
     void     dump_l(String8& res, const char* what) const;
 
-    static const int    kMemoryAlign;
     mutable std::mutex mLock;
     LinkedList<chunk_t> mList;
     size_t              mHeapSize;
@@ -162,6 +190,40 @@ private:
 
 // ----------------------------------------------------------------------------
 
+/*
+ * Binary buddy allocator. The heap is split into power-of-two blocks of kMemoryAlign units, and
+ * each size class keeps its own free list, so allocating and freeing never scan the heap. Block
+ * bookkeeping lives outside of the heap, which may be mapped read-only.
+ */
+class BuddyAllocator : public HeapAllocator
+{
+public:
+    explicit BuddyAllocator(size_t size);
+
+    size_t      allocate(size_t size, uint32_t flags = 0) override;
+    status_t    deallocate(size_t offset) override;
+    size_t      size() const override;
+    void        dump(const char* what) const override;
+    void        dump(String8& res, const char* what) const override;
+
+private:
+    struct Allocated {
+        uint32_t order;
+        size_t requested;
+    };
+
+    mutable std::mutex mLock;
+    size_t              mHeapSize;
+    // mFree[order] holds the start, in kMemoryAlign units, of each free block of 2^order units.
+    // Sets keep the lowest addresses in use first, which limits fragmentation.
+    std::vector<std::set<size_t>> mFree;
+    std::unordered_map<size_t, Allocated> mAllocated;
+    size_t              mAllocatedBytes = 0;
+    size_t              mRequestedBytes = 0;
+};
+
+// ----------------------------------------------------------------------------
+
 Allocation::Allocation(
         const sp<MemoryDealer>& dealer,
         const sp<IMemoryHeap>& heap, ssize_t offset, size_t size)
@@ -227,8 +289,16 @@ Allocation::~Allocation()
 // ----------------------------------------------------------------------------
 
 MemoryDealer::MemoryDealer(size_t size, const char* name, uint32_t flags)
-      : mHeap(sp<MemoryHeapBase>::make(size, flags, name)),
-        mAllocator(new SimpleBestFitAllocator(size)) {}
+      : MemoryDealer(size, name, flags, Allocator::BEST_FIT) {}
+
+MemoryDealer::MemoryDealer(size_t size, const char* name, uint32_t flags, Allocator allocator)
+      : mHeap(sp<MemoryHeapBase>::make(size, flags, name)) {
+    if (allocator == Allocator::BUDDY) {
+        mAllocator = new BuddyAllocator(size);
+    } else {
+        mAllocator = new SimpleBestFitAllocator(size);
+    }
+}
 
 MemoryDealer::~MemoryDealer()
 {
@@ -259,20 +329,33 @@ const sp<IMemoryHeap>& MemoryDealer::heap() const {
     return mHeap;
 }
 
-SimpleBestFitAllocator* MemoryDealer::allocator() const {
+HeapAllocator* MemoryDealer::allocator() const {
     return mAllocator;
 }
 
 // static
 size_t MemoryDealer::getAllocationAlignment()
 {
-    return SimpleBestFitAllocator::getAllocationAlignment();
+    return HeapAllocator::getAllocationAlignment();
 }
 
 // ----------------------------------------------------------------------------
 
 // align all the memory blocks on a cache-line boundary
-const int SimpleBestFitAllocator::kMemoryAlign = 32;
+const int HeapAllocator::kMemoryAlign = 32;
+
+void HeapAllocator::dumpFragmentation(String8& result, size_t freeBytes, size_t freeBlocks,
+                                      size_t largestFreeBlock)
+{
+    // 0% when all of the free space is contiguous, close to 100% when it is in small pieces.
+    unsigned int fragmentation =
+            freeBytes ? (unsigned int)(100 - (100 * largestFreeBlock) / freeBytes) : 0;
+    result.appendFormat("  free: %zu bytes in %zu blocks, largest %zu bytes, "
+                        "fragmentation %u%%\n",
+                        freeBytes, freeBlocks, largestFreeBlock, fragmentation);
+}
+
+// ----------------------------------------------------------------------------
 
 SimpleBestFitAllocator::SimpleBestFitAllocator(size_t size)
 {
@@ -442,6 +525,8 @@ void SimpleBestFitAllocator::dump_l(String8& result,
         const char* what) const
 {
     size_t size = 0;
+    size_t freeBlocks = 0;
+    size_t largestFreeBlock = 0;
     int32_t i = 0;
     chunk_t const* cur = mList.head();
     
@@ -466,8 +551,12 @@ void SimpleBestFitAllocator::dump_l(String8& result,
         
         result.append(buffer);
 
-        if (!cur->free)
+        if (!cur->free) {
             size += cur->size*kMemoryAlign;
+        } else {
+            freeBlocks++;
+            largestFreeBlock = std::max(largestFreeBlock, size_t(cur->size*kMemoryAlign));
+        }
 
         i++;
         cur = cur->next;
@@ -475,6 +564,124 @@ void SimpleBestFitAllocator::dump_l(String8& result,
     snprintf(buffer, SIZE,
             "  size allocated: %u (%u KB)\n", int(size), int(size/1024));
     result.append(buffer);
+    dumpFragmentation(result, mHeapSize - size, freeBlocks, largestFreeBlock);
+}
+
+// ----------------------------------------------------------------------------
+
+BuddyAllocator::BuddyAllocator(size_t size)
+{
+    size_t pagesize = getpagesize();
+    mHeapSize = ((size + pagesize-1) & ~(pagesize-1));
+
+    const size_t units = mHeapSize / kMemoryAlign;
+    uint32_t maxOrder = 0;
+    while ((size_t(2) << maxOrder) <= units) maxOrder++;
+    mFree.resize(maxOrder + 1);
+
+    // Cover heaps that are not a power of two with the largest aligned blocks that fit.
+    for (size_t start = 0; start < units;) {
+        uint32_t order = maxOrder;
+        while ((start & ((size_t(1) << order) - 1)) || start + (size_t(1) << order) > units) {
+            order--;
+        }
+        mFree[order].insert(start);
+        start += size_t(1) << order;
+    }
+}
+
+size_t BuddyAllocator::size() const
+{
+    return mHeapSize;
+}
+
+size_t BuddyAllocator::allocate(size_t size, uint32_t flags)
+{
+    if (size == 0) {
+        return 0;
+    }
+    const size_t units = (size + kMemoryAlign-1) / kMemoryAlign;
+    uint32_t order = 0;
+    while ((size_t(1) << order) < units) order++;
+    if (flags & PAGE_ALIGNED) {
+        // Blocks are aligned to their size, so page-sized blocks are page aligned.
+        const size_t pageUnits = getpagesize() / kMemoryAlign;
+        while ((size_t(1) << order) < pageUnits) order++;
+    }
+
+    std::unique_lock<std::mutex> _l(mLock);
+    uint32_t from = order;
+    while (from < mFree.size() && mFree[from].empty()) from++;
+    if (from >= mFree.size()) {
+        return NO_MEMORY;
+    }
+
+    const size_t start = *mFree[from].begin();
+    mFree[from].erase(mFree[from].begin());
+    // Give back the upper halves until the block has the requested order.
+    while (from > order) {
+        from--;
+        mFree[from].insert(start + (size_t(1) << from));
+    }
+    mAllocated.emplace(start, Allocated{order, size});
+    mAllocatedBytes += (size_t(1) << order) * kMemoryAlign;
+    mRequestedBytes += size;
+    return start * kMemoryAlign;
+}
+
+status_t BuddyAllocator::deallocate(size_t offset)
+{
+    std::unique_lock<std::mutex> _l(mLock);
+    size_t start = offset / kMemoryAlign;
+    auto it = mAllocated.find(start);
+    if (offset % kMemoryAlign || it == mAllocated.end()) {
+        return NAME_NOT_FOUND;
+    }
+    uint32_t order = it->second.order;
+    mAllocatedBytes -= (size_t(1) << order) * kMemoryAlign;
+    mRequestedBytes -= it->second.requested;
+    mAllocated.erase(it);
+
+    // merge with the buddy block for as long as it is free
+    while (order + 1 < mFree.size()) {
+        const size_t buddy = start ^ (size_t(1) << order);
+        auto found = mFree[order].find(buddy);
+        if (found == mFree[order].end()) break;
+        mFree[order].erase(found);
+        start = std::min(start, buddy);
+        order++;
+    }
+    mFree[order].insert(start);
+    return NO_ERROR;
+}
+
+void BuddyAllocator::dump(const char* what) const
+{
+    String8 result;
+    dump(result, what);
+    ALOGD("%s", result.c_str());
+}
+
+void BuddyAllocator::dump(String8& result, const char* what) const
+{
+    std::unique_lock<std::mutex> _l(mLock);
+    result.appendFormat("  %s (%p, size=%zu, buddy)\n", what, this, mHeapSize);
+
+    size_t freeBlocks = 0;
+    size_t largestFreeBlock = 0;
+    for (size_t order = 0; order < mFree.size(); order++) {
+        if (mFree[order].empty()) continue;
+        const size_t blockSize = (size_t(1) << order) * kMemoryAlign;
+        result.appendFormat("  order %2zu (%8zu bytes): %zu free\n", order, blockSize,
+                            mFree[order].size());
+        freeBlocks += mFree[order].size();
+        largestFreeBlock = blockSize;
+    }
+    result.appendFormat("  size allocated: %zu (%zu KB) in %zu allocations, "
+                        "%zu bytes lost to rounding\n",
+                        mAllocatedBytes, mAllocatedBytes / 1024, mAllocated.size(),
+                        mAllocatedBytes - mRequestedBytes);
+    dumpFragmentation(result, mHeapSize - mAllocatedBytes, freeBlocks, largestFreeBlock);
 }
 
 
@@ -31,6 +31,8 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <algorithm>
+#include <array>
+#include <utility>
 
 #include <binder/Binder.h>
 #include <binder/BpBinder.h>
@@ -117,6 +119,114 @@ constexpr size_t kMaxFds = 1024;
 // Maximum size of a blob to transfer in-place.
 [[maybe_unused]] static const size_t BLOB_INPLACE_LIMIT = 16 * 1024;
 
+#ifdef BINDER_WITH_KERNEL_IPC
+// Per-thread cache of recently freed Parcel data buffers. Most transactions are a few hundred
+// bytes and construct new Parcels for every call, so a client making back-to-back calls would
+// otherwise malloc and free the same sizes over and over.
+//
+// Buffers are kept in power-of-two size classes starting at the minimum Parcel capacity, with a
+// couple of slots each, which bounds the memory retained per thread.
+// Set once the calling thread's cache is destroyed. Parcels can still be freed after that, for
+// instance by IPCThreadState's thread-exit handler, and they must bypass the cache.
+static thread_local bool tParcelBufferCacheDestroyed = false;
+
+class ParcelBufferCache {
+public:
+    ~ParcelBufferCache() {
+        tParcelBufferCacheDestroyed = true;
+        for (auto& sizeClass : mClasses) {
+            for (Buffer& buffer : sizeClass) {
+                free(buffer.data);
+            }
+        }
+    }
+
+    // Returns a buffer of at least |desired| bytes and stores its capacity in |outCapacity|, or
+    // nullptr if there is none.
+    uint8_t* take(size_t desired, size_t* outCapacity) {
+        for (size_t i = sizeClassOf(desired); i < kNumClasses; i++) {
+            for (Buffer& buffer : mClasses[i]) {
+                if (buffer.data != nullptr && buffer.capacity >= desired) {
+                    *outCapacity = buffer.capacity;
+                    return std::exchange(buffer.data, nullptr);
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    // Takes ownership of |data|, keeping it for reuse or freeing it.
+    void give(uint8_t* data, size_t capacity) {
+        if (capacity < kMinCapacity || capacity >= (kMinCapacity << kNumClasses)) {
+            free(data);
+            return;
+        }
+        for (Buffer& buffer : mClasses[sizeClassOf(capacity)]) {
+            if (buffer.data == nullptr) {
+                buffer = {data, capacity};
+                return;
+            }
+        }
+        free(data);
+    }
+
+private:
+    // Matches the smallest allocation made by Parcel::growData.
+    static constexpr size_t kMinCapacity = 128;
+    // Size classes of [128, 256), [256, 512), [512, 1024) and [1024, 2048) bytes. With
+    // kSlotsPerClass, at most 7.5KiB is retained per thread.
+    static constexpr size_t kNumClasses = 4;
+    static constexpr size_t kSlotsPerClass = 2;
+
+    struct Buffer {
+        uint8_t* data = nullptr;
+        size_t capacity = 0;
+    };
+
+    static size_t sizeClassOf(size_t size) {
+        size_t sizeClass = 0;
+        while (sizeClass < kNumClasses && size >= (kMinCapacity << (sizeClass + 1))) {
+            sizeClass++;
+        }
+        return sizeClass;
+    }
+
+    std::array<std::array<Buffer, kSlotsPerClass>, kNumClasses> mClasses;
+};
+
+static ParcelBufferCache* parcelBufferCache() {
+    if (tParcelBufferCacheDestroyed) {
+        return nullptr;
+    }
+    thread_local ParcelBufferCache cache;
+    return &cache;
+}
+#endif // BINDER_WITH_KERNEL_IPC
+
+// Allocates the first data buffer of a Parcel, which may be larger than |desired|.
+static uint8_t* allocParcelData(size_t desired, size_t* outCapacity) {
+#ifdef BINDER_WITH_KERNEL_IPC
+    if (ParcelBufferCache* cache = parcelBufferCache(); cache != nullptr) {
+        if (uint8_t* data = cache->take(desired, outCapacity); data != nullptr) {
+            return data;
+        }
+    }
+#endif // BINDER_WITH_KERNEL_IPC
+    *outCapacity = desired;
+    return static_cast<uint8_t*>(malloc(desired));
+}
+
+static void freeParcelData(uint8_t* data, size_t capacity) {
+#ifdef BINDER_WITH_KERNEL_IPC
+    if (ParcelBufferCache* cache = parcelBufferCache(); cache != nullptr) {
+        cache->give(data, capacity);
+        return;
+    }
+#endif // BINDER_WITH_KERNEL_IPC
+    (void)capacity;
+    free(data);
+}
+
 #if defined(__BIONIC__)
 static void FdTag(int fd, const void* old_addr, const void* new_addr) {
     if (android_fdsan_exchange_owner_tag) {
@@ -953,6 +1063,19 @@ constexpr int32_t kHeader = B_PACK_CHARS('U', 'N', 'K', 'N');
 
 #endif // BINDER_WITH_KERNEL_IPC
 
+// Written in place of the String16 length of an RPC interface token when the token is the hash of
+// the descriptor. String16 lengths are never negative, other than -1 for null strings.
+constexpr int32_t kInterfaceTokenHash = -2;
+
+// FNV-1a, which is stable across builds and architectures.
+static uint64_t hashInterfaceToken(const char16_t* str, size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ static_cast<uint16_t>(str[i])) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
 // Write RPC headers.  (previously just the interface token)
 status_t Parcel::writeInterfaceToken(const String16& interface)
 {
@@ -974,7 +1097,17 @@ status_t Parcel::writeInterfaceToken(const char16_t* str, size_t len) {
 #endif // BINDER_WITH_KERNEL_IPC
     }
 
-    // currently the interface identification token is just its name as a string
+    // Sessions which agreed on a recent enough protocol can skip the descriptor string, which is
+    // otherwise the largest part of most small transactions.
+    if (auto* rpcFields = maybeRpcFields()) {
+        if (rpcFields->mSession->getProtocolVersion().value_or(0) >=
+            RPC_WIRE_PROTOCOL_VERSION_PARCEL_FEATURE_INTERFACE_TOKEN_HASH) {
+            if (status_t status = writeInt32(kInterfaceTokenHash); status != OK) return status;
+            return writeUint64(hashInterfaceToken(str, len));
+        }
+    }
+
+    // otherwise, the interface identification token is just its name as a string
     return writeString16(str, len);
 }
 
@@ -1064,7 +1197,19 @@ bool Parcel::enforceInterface(const char16_t* interface,
 #endif // BINDER_WITH_KERNEL_IPC
     }
 
-    // Interface descriptor.
+    // Interface descriptor. RPC peers may send its hash instead, see writeInterfaceToken.
+    if (isForRpc()) {
+        const size_t start = dataPosition();
+        uint64_t hash;
+        if (readInt32() == kInterfaceTokenHash && readUint64(&hash) == OK) {
+            if (hash == hashInterfaceToken(interface, len) || mServiceFuzzing) return true;
+            ALOGW("**** enforceInterface() expected '%s' but read a different interface hash",
+                  String8(interface, len).c_str());
+            return false;
+        }
+        setDataPosition(start);
+    }
+
     size_t parcel_interface_len;
     const char16_t* parcel_interface = readString16Inplace(&parcel_interface_len);
     if (len == parcel_interface_len &&
@@ -1249,6 +1394,7 @@ status_t Parcel::writeUtf8AsUtf16(const std::string& str) {
         return BAD_VALUE;
     }
 
+    reserveLengthPrefixedWrite((utf16Len + 1) * sizeof(char16_t));
     status_t err = writeInt32(utf16Len);
     if (err) {
         return err;
@@ -1272,10 +1418,16 @@ status_t Parcel::writeUtf8AsUtf16(const std::unique_ptr<std::string>& str) { ret
 status_t Parcel::writeString16(const std::optional<String16>& str) { return writeData(str); }
 status_t Parcel::writeString16(const std::unique_ptr<String16>& str) { return writeData(str); }
 
-status_t Parcel::writeByteVector(const std::vector<int8_t>& val) { return writeData(val); }
+status_t Parcel::writeByteVector(const std::vector<int8_t>& val) {
+    reserveLengthPrefixedWrite(val.size());
+    return writeData(val);
+}
 status_t Parcel::writeByteVector(const std::optional<std::vector<int8_t>>& val) { return writeData(val); }
 status_t Parcel::writeByteVector(const std::unique_ptr<std::vector<int8_t>>& val) { return writeData(val); }
-status_t Parcel::writeByteVector(const std::vector<uint8_t>& val) { return writeData(val); }
+status_t Parcel::writeByteVector(const std::vector<uint8_t>& val) {
+    reserveLengthPrefixedWrite(val.size());
+    return writeData(val);
+}
 status_t Parcel::writeByteVector(const std::optional<std::vector<uint8_t>>& val) { return writeData(val); }
 status_t Parcel::writeByteVector(const std::unique_ptr<std::vector<uint8_t>>& val){ return writeData(val); }
 status_t Parcel::writeInt32Vector(const std::vector<int32_t>& val) { return writeData(val); }
@@ -1410,6 +1562,7 @@ status_t Parcel::writeInt32Array(size_t len, const int32_t *val) {
     if (!val) {
         return writeInt32(-1);
     }
+    reserveLengthPrefixedWrite(len * sizeof(*val));
     status_t ret = writeInt32(static_cast<uint32_t>(len));
     if (ret == NO_ERROR) {
         ret = write(val, len * sizeof(*val));
@@ -1426,6 +1579,7 @@ status_t Parcel::writeByteArray(size_t len, const uint8_t *val) {
     if (!val) {
         return writeInt32(-1);
     }
+    reserveLengthPrefixedWrite(len * sizeof(*val));
     status_t ret = writeInt32(static_cast<uint32_t>(len));
     if (ret == NO_ERROR) {
         ret = write(val, len * sizeof(*val));
@@ -1504,6 +1658,7 @@ status_t Parcel::writeString8(const char* str, size_t len)
     if (str == nullptr) return writeInt32(-1);
 
     // NOTE: Keep this logic in sync with android_os_Parcel.cpp
+    reserveLengthPrefixedWrite(len + sizeof(char));
     status_t err = writeInt32(len);
     if (err == NO_ERROR) {
         uint8_t* data = (uint8_t*)writeInplace(len+sizeof(char));
@@ -1527,6 +1682,9 @@ status_t Parcel::writeString16(const char16_t* str, size_t len)
     if (str == nullptr) return writeInt32(-1);
 
     // NOTE: Keep this logic in sync with android_os_Parcel.cpp
+    if (len < INT32_MAX / sizeof(char16_t)) {
+        reserveLengthPrefixedWrite((len + 1) * sizeof(char16_t));
+    }
     status_t err = writeInt32(len);
     if (err == NO_ERROR) {
         len *= sizeof(char16_t);
@@ -1683,8 +1841,17 @@ status_t Parcel::writeBlob(size_t len, bool mutableCopy, WritableBlob* outBlob)
         return BAD_VALUE;
     }
 
+    // Over RPC, large blobs can only be shared through ashmem if the session transfers file
+    // descriptors. Otherwise the data is sent in place.
+    bool canShareFd = mAllowFds;
+    if (auto* rpcFields = maybeRpcFields(); rpcFields != nullptr &&
+        rpcFields->mSession->getFileDescriptorTransportMode() ==
+                RpcSession::FileDescriptorTransportMode::NONE) {
+        canShareFd = false;
+    }
+
     status_t status;
-    if (!mAllowFds || len <= BLOB_INPLACE_LIMIT) {
+    if (!canShareFd || len <= BLOB_INPLACE_LIMIT) {
         ALOGV("writeBlob: write in place");
         status = writeInt32(BLOB_INPLACE);
         if (status) return status;
@@ -2938,8 +3105,10 @@ void Parcel::freeDataNoInit()
             gParcelGlobalAllocCount--;
             if (mDeallocZero) {
                 zeroMemory(mData, mDataSize);
+                free(mData);
+            } else {
+                freeParcelData(mData, mDataCapacity);
             }
-            free(mData);
         }
         auto* kernelFields = maybeKernelFields();
         if (kernelFields && kernelFields->mObjects) free(kernelFields->mObjects);
@@ -2970,6 +3139,17 @@ status_t Parcel::growData(size_t len)
             : continueWrite(std::max(newSize, (size_t) 128));
 }
 
+void Parcel::reserveLengthPrefixedWrite(size_t len)
+{
+    // Oversized writes are rejected by writeInplace.
+    if (len > INT32_MAX) return;
+
+    const size_t total = sizeof(int32_t) + pad_size(len);
+    if (mDataPos + total > mDataCapacity) {
+        growData(total);
+    }
+}
+
 static uint8_t* reallocZeroFree(uint8_t* data, size_t oldCapacity, size_t newCapacity, bool zero) {
     if (!zero) {
         return (uint8_t*)realloc(data, newCapacity);
@@ -3248,7 +3428,8 @@ status_t Parcel::continueWrite(size_t desired)
 
     } else {
         // This is the first data.  Easy!
-        uint8_t* data = (uint8_t*)malloc(desired);
+        size_t capacity;
+        uint8_t* data = allocParcelData(desired, &capacity);
         if (!data) {
             mError = NO_MEMORY;
             return NO_MEMORY;
@@ -3262,15 +3443,15 @@ status_t Parcel::continueWrite(size_t desired)
                   kernelFields ? kernelFields->mObjectsCapacity : 0, desired);
         }
 
-        LOG_ALLOC("Parcel %p: allocating with %zu capacity", this, desired);
-        gParcelGlobalAllocSize += desired;
+        LOG_ALLOC("Parcel %p: allocating with %zu capacity", this, capacity);
+        gParcelGlobalAllocSize += capacity;
         gParcelGlobalAllocCount++;
 
         mData = data;
         mDataSize = mDataPos = 0;
         ALOGV("continueWrite Setting data size of %p to %zu", this, mDataSize);
         ALOGV("continueWrite Setting data pos of %p to %zu", this, mDataPos);
-        mDataCapacity = desired;
+        mDataCapacity = capacity;
     }
 
     return NO_ERROR;
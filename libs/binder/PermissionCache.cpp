@@ -31,47 +31,79 @@ ANDROID_SINGLETON_STATIC_INSTANCE(PermissionCache)
 
 // ----------------------------------------------------------------------------
 
+class PermissionCache::ControllerDeathRecipient : public IBinder::DeathRecipient {
+public:
+    void binderDied(const wp<IBinder>& /*who*/) override {
+        PermissionCache::getInstance().onControllerDied();
+    }
+};
+
 PermissionCache::PermissionCache() {
 }
 
 status_t PermissionCache::check(bool* granted,
         const String16& permission, uid_t uid) const {
     Mutex::Autolock _l(mLock);
-    Entry e;
-    e.name = permission;
-    e.uid  = uid;
-    ssize_t index = mCache.indexOf(e);
-    if (index >= 0) {
-        *granted = mCache.itemAt(index).granted;
+    auto it = mCache.find(Key{permission, uid});
+    if (it != mCache.end()) {
+        mStats.hits++;
+        *granted = it->second;
         return NO_ERROR;
     }
+    mStats.misses++;
     return NAME_NOT_FOUND;
 }
 
 void PermissionCache::cache(const String16& permission,
         uid_t uid, bool granted) {
     Mutex::Autolock _l(mLock);
-    Entry e;
-    ssize_t index = mPermissionNamesPool.indexOf(permission);
-    if (index > 0) {
-        e.name = mPermissionNamesPool.itemAt(index);
-    } else {
-        mPermissionNamesPool.add(permission);
-        e.name = permission;
-    }
     // note, we don't need to store the pid, which is not actually used in
     // permission checks
-    e.uid  = uid;
-    e.granted = granted;
-    index = mCache.indexOf(e);
-    if (index < 0) {
-        mCache.add(e);
-    }
+    mCache.try_emplace(Key{permission, uid}, granted);
 }
 
 void PermissionCache::purge() {
     Mutex::Autolock _l(mLock);
     mCache.clear();
+    mStats.purges++;
+}
+
+void PermissionCache::watchController() {
+    {
+        Mutex::Autolock _l(mLock);
+        if (mWatchingController) return;
+        mWatchingController = true;
+    }
+
+    sp<IBinder> controller = defaultServiceManager()->checkService(String16("permission"));
+    if (controller == nullptr) {
+        Mutex::Autolock _l(mLock);
+        mWatchingController = false;
+        return;
+    }
+    // The permission controller can't die without this process, in which case there is nothing
+    // to link to, and mWatchingController stays set.
+    sp<IBinder::DeathRecipient> recipient = sp<ControllerDeathRecipient>::make();
+    if (controller->localBinder() == nullptr && controller->linkToDeath(recipient) != NO_ERROR) {
+        Mutex::Autolock _l(mLock);
+        mWatchingController = false;
+        return;
+    }
+
+    Mutex::Autolock _l(mLock);
+    mController = controller;
+    mControllerDeathRecipient = recipient;
+}
+
+void PermissionCache::onControllerDied() {
+    ALOGI("permission controller died, purging cached permissions");
+    {
+        Mutex::Autolock _l(mLock);
+        mWatchingController = false;
+        mController.clear();
+        mControllerDeathRecipient.clear();
+    }
+    purge();
 }
 
 bool PermissionCache::checkCallingPermission(const String16& permission) {
@@ -104,6 +136,7 @@ bool PermissionCache::checkPermission(
         ALOGD("checking %s for uid=%d => %s (%d us)", String8(permission).c_str(), uid,
               granted ? "granted" : "denied", (int)ns2us(t));
         pc.cache(permission, uid, granted);
+        pc.watchController();
     }
     return granted;
 }
@@ -113,5 +146,13 @@ void PermissionCache::purgeCache() {
     pc.purge();
 }
 
+PermissionCache::Stats PermissionCache::getStats() {
+    PermissionCache& pc(PermissionCache::getInstance());
+    Mutex::Autolock _l(pc.mLock);
+    Stats stats = pc.mStats;
+    stats.size = pc.mCache.size();
+    return stats;
+}
+
 // ---------------------------------------------------------------------------
 } // namespace android
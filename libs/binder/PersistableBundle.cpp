@@ -90,12 +90,46 @@ namespace os {
         }                                     \
     }
 
+PersistableBundle::PersistableBundle(const PersistableBundle& bundle) : Parcelable(bundle) {
+    *this = bundle;
+}
+
+PersistableBundle& PersistableBundle::operator=(const PersistableBundle& bundle) {
+    if (this == &bundle) return *this;
+
+    std::scoped_lock lock(mLock, bundle.mLock);
+    mParcelledData = bundle.mParcelledData;
+    mParcelledMagic = bundle.mParcelledMagic;
+    mBoolMap = bundle.mBoolMap;
+    mIntMap = bundle.mIntMap;
+    mLongMap = bundle.mLongMap;
+    mDoubleMap = bundle.mDoubleMap;
+    mStringMap = bundle.mStringMap;
+    mBoolVectorMap = bundle.mBoolVectorMap;
+    mIntVectorMap = bundle.mIntVectorMap;
+    mLongVectorMap = bundle.mLongVectorMap;
+    mDoubleVectorMap = bundle.mDoubleVectorMap;
+    mStringVectorMap = bundle.mStringVectorMap;
+    mPersistableBundleMap = bundle.mPersistableBundleMap;
+    return *this;
+}
+
 status_t PersistableBundle::writeToParcel(Parcel* parcel) const {
     /*
      * Keep implementation in sync with writeToParcelInner() in
      * frameworks/base/core/java/android/os/BaseBundle.java.
      */
 
+    {
+        std::lock_guard lock(mLock);
+        if (!mParcelledData.empty()) {
+            // Not accessed since it was read, so forward the original bytes.
+            RETURN_IF_FAILED(parcel->writeInt32(static_cast<int32_t>(mParcelledData.size())));
+            RETURN_IF_FAILED(parcel->writeInt32(mParcelledMagic));
+            return parcel->write(mParcelledData.data(), mParcelledData.size());
+        }
+    }
+
     // Special case for empty bundles.
     if (empty()) {
         RETURN_IF_FAILED(parcel->writeInt32(0));
@@ -136,11 +170,45 @@ status_t PersistableBundle::readFromParcel(const Parcel* parcel) {
     return readFromParcelInner(parcel, static_cast<size_t>(length));
 }
 
+void PersistableBundle::unparcel() const {
+    std::lock_guard lock(mLock);
+    unparcelLocked();
+}
+
+void PersistableBundle::unparcelLocked() const {
+    if (mParcelledData.empty()) return;
+
+    std::vector<uint8_t> data = std::move(mParcelledData);
+    mParcelledData.clear();
+    // The maps only get modified after unparceling, so they are empty here.
+    auto* self = const_cast<PersistableBundle*>(this);
+    if (status_t status = self->readEntries(data.data(), data.size()); status != NO_ERROR) {
+        // Match BaseBundle, which drops the contents of a bundle that fails to unparcel.
+        ALOGE("Failed to unparcel PersistableBundle: %d", status);
+        mBoolMap.clear();
+        mIntMap.clear();
+        mLongMap.clear();
+        mDoubleMap.clear();
+        mStringMap.clear();
+        mBoolVectorMap.clear();
+        mIntVectorMap.clear();
+        mLongVectorMap.clear();
+        mDoubleVectorMap.clear();
+        mStringVectorMap.clear();
+        mPersistableBundleMap.clear();
+    }
+}
+
 bool PersistableBundle::empty() const {
     return size() == 0u;
 }
 
 size_t PersistableBundle::size() const {
+    unparcel();
+    return countEntries();
+}
+
+size_t PersistableBundle::countEntries() const {
     return (mBoolMap.size() +
             mIntMap.size() +
             mLongMap.size() +
@@ -155,6 +223,7 @@ size_t PersistableBundle::size() const {
 }
 
 size_t PersistableBundle::erase(const String16& key) {
+    unparcel();
     RETURN_IF_ENTRY_ERASED(mBoolMap, key);
     RETURN_IF_ENTRY_ERASED(mIntMap, key);
     RETURN_IF_ENTRY_ERASED(mLongMap, key);
@@ -224,90 +293,112 @@ void PersistableBundle::putPersistableBundle(const String16& key, const Persista
 }
 
 bool PersistableBundle::getBoolean(const String16& key, bool* out) const {
+    unparcel();
     return getValue(key, out, mBoolMap);
 }
 
 bool PersistableBundle::getInt(const String16& key, int32_t* out) const {
+    unparcel();
     return getValue(key, out, mIntMap);
 }
 
 bool PersistableBundle::getLong(const String16& key, int64_t* out) const {
+    unparcel();
     return getValue(key, out, mLongMap);
 }
 
 bool PersistableBundle::getDouble(const String16& key, double* out) const {
+    unparcel();
     return getValue(key, out, mDoubleMap);
 }
 
 bool PersistableBundle::getString(const String16& key, String16* out) const {
+    unparcel();
     return getValue(key, out, mStringMap);
 }
 
 bool PersistableBundle::getBooleanVector(const String16& key, vector<bool>* out) const {
+    unparcel();
     return getValue(key, out, mBoolVectorMap);
 }
 
 bool PersistableBundle::getIntVector(const String16& key, vector<int32_t>* out) const {
+    unparcel();
     return getValue(key, out, mIntVectorMap);
 }
 
 bool PersistableBundle::getLongVector(const String16& key, vector<int64_t>* out) const {
+    unparcel();
     return getValue(key, out, mLongVectorMap);
 }
 
 bool PersistableBundle::getDoubleVector(const String16& key, vector<double>* out) const {
+    unparcel();
     return getValue(key, out, mDoubleVectorMap);
 }
 
 bool PersistableBundle::getStringVector(const String16& key, vector<String16>* out) const {
+    unparcel();
     return getValue(key, out, mStringVectorMap);
 }
 
 bool PersistableBundle::getPersistableBundle(const String16& key, PersistableBundle* out) const {
+    unparcel();
     return getValue(key, out, mPersistableBundleMap);
 }
 
 set<String16> PersistableBundle::getBooleanKeys() const {
+    unparcel();
     return getKeys(mBoolMap);
 }
 
 set<String16> PersistableBundle::getIntKeys() const {
+    unparcel();
     return getKeys(mIntMap);
 }
 
 set<String16> PersistableBundle::getLongKeys() const {
+    unparcel();
     return getKeys(mLongMap);
 }
 
 set<String16> PersistableBundle::getDoubleKeys() const {
+    unparcel();
     return getKeys(mDoubleMap);
 }
 
 set<String16> PersistableBundle::getStringKeys() const {
+    unparcel();
     return getKeys(mStringMap);
 }
 
 set<String16> PersistableBundle::getBooleanVectorKeys() const {
+    unparcel();
     return getKeys(mBoolVectorMap);
 }
 
 set<String16> PersistableBundle::getIntVectorKeys() const {
+    unparcel();
     return getKeys(mIntVectorMap);
 }
 
 set<String16> PersistableBundle::getLongVectorKeys() const {
+    unparcel();
     return getKeys(mLongVectorMap);
 }
 
 set<String16> PersistableBundle::getDoubleVectorKeys() const {
+    unparcel();
     return getKeys(mDoubleVectorMap);
 }
 
 set<String16> PersistableBundle::getStringVectorKeys() const {
+    unparcel();
     return getKeys(mStringVectorMap);
 }
 
 set<String16> PersistableBundle::getPersistableBundleKeys() const {
+    unparcel();
     return getKeys(mPersistableBundleMap);
 }
 
@@ -402,6 +493,31 @@ status_t PersistableBundle::readFromParcelInner(const Parcel* parcel, size_t len
         return BAD_VALUE;
     }
 
+    // The length covers all entries, which are kept as they are until first accessed.
+    const uint8_t* data = static_cast<const uint8_t*>(parcel->readInplace(length));
+    if (data == nullptr) {
+        ALOGE("Bad length for PersistableBundle: %zu", length);
+        return BAD_VALUE;
+    }
+
+    std::lock_guard lock(mLock);
+    unparcelLocked();
+    if (countEntries() > 0) {
+        // Merging into existing entries can't be forwarded as is.
+        return readEntries(data, length);
+    }
+    mParcelledData.assign(data, data + length);
+    mParcelledMagic = magic;
+    return NO_ERROR;
+}
+
+status_t PersistableBundle::readEntries(const uint8_t* data, size_t length) {
+    Parcel parcel;
+    RETURN_IF_FAILED(parcel.setData(data, length));
+    return readEntriesFromParcel(&parcel);
+}
+
+status_t PersistableBundle::readEntriesFromParcel(const Parcel* parcel) {
     /*
      * To keep this implementation in sync with unparcel() in
      * frameworks/base/core/java/android/os/BaseBundle.java, the number of
@@ -36,6 +36,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -44,11 +45,14 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <algorithm>
 #include <mutex>
 
 #define BINDER_VM_SIZE ((1 * 1024 * 1024) - sysconf(_SC_PAGE_SIZE) * 2)
 #define DEFAULT_MAX_BINDER_THREADS 15
 #define DEFAULT_ENABLE_ONEWAY_SPAM_DETECTION 1
+// How long every kernel-started thread must stay busy before the adaptive pool grows.
+#define THREAD_POOL_GROW_STARVATION_MS 100
 
 #ifdef __ANDROID_VNDK__
 const char* kDefaultDriver = "/dev/vndbinder";
@@ -431,6 +435,56 @@ status_t ProcessState::setThreadPoolMaxThreadCount(size_t maxThreads) {
     return result;
 }
 
+status_t ProcessState::setThreadPoolAdaptiveMaxThreadCount(size_t maxThreads) {
+    pthread_mutex_lock(&mThreadCountLock);
+    auto detachGuard = make_scope_guard([&]() { pthread_mutex_unlock(&mThreadCountLock); });
+
+    if (maxThreads < mMaxThreads) {
+        ALOGE("Adaptive max threads %zu is below the current max of %zu", maxThreads, mMaxThreads);
+        return BAD_VALUE;
+    }
+    mAdaptiveMaxThreads = maxThreads;
+    return NO_ERROR;
+}
+
+void ProcessState::onThreadPoolStarvedLocked(int64_t starvationTimeMs) {
+    mStarvationCount++;
+    mStarvationTimeMs += starvationTimeMs;
+
+    // A short burst is absorbed by the existing threads; only grow once all of them have been
+    // busy for long enough that callers are likely queueing behind them.
+    if (starvationTimeMs <= THREAD_POOL_GROW_STARVATION_MS || mMaxThreads >= mAdaptiveMaxThreads) {
+        return;
+    }
+    size_t maxThreads = mMaxThreads + 1;
+    if (ioctl(mDriverFD, BINDER_SET_MAX_THREADS, &maxThreads) == -1) {
+        ALOGE("Binder ioctl to grow max threads to %zu failed: %s", maxThreads, strerror(errno));
+        // don't keep retrying on every starvation period
+        mAdaptiveMaxThreads = mMaxThreads;
+        return;
+    }
+    ALOGI("binder thread pool starved for %" PRId64 " ms, growing to %zu threads",
+          starvationTimeMs, maxThreads);
+    mMaxThreads = maxThreads;
+}
+
+ProcessState::ThreadPoolStats ProcessState::getThreadPoolStats() const {
+    pthread_mutex_lock(&mThreadCountLock);
+    auto detachGuard = make_scope_guard([&]() { pthread_mutex_unlock(&mThreadCountLock); });
+
+    return {
+            .maxThreads = mMaxThreads,
+            .adaptiveMaxThreads = std::max(mMaxThreads, mAdaptiveMaxThreads),
+            .currentThreads = mCurrentThreads,
+            .executingThreads = mExecutingThreadsCount,
+            .peakExecutingThreads = mPeakExecutingThreads,
+            .commandCount = mCommandCount,
+            .busyTimeNs = mBusyTimeNs,
+            .starvationCount = mStarvationCount,
+            .starvationTimeMs = mStarvationTimeMs,
+    };
+}
+
 size_t ProcessState::getThreadPoolMaxTotalThreadCount() const {
     pthread_mutex_lock(&mThreadCountLock);
     auto detachGuard = make_scope_guard([&]() { pthread_mutex_unlock(&mThreadCountLock); });
@@ -562,6 +616,12 @@ ProcessState::ProcessState(const char* driver)
         mCurrentThreads(0),
         mKernelStartedThreads(0),
         mStarvationStartTimeMs(0),
+        mAdaptiveMaxThreads(0),
+        mPeakExecutingThreads(0),
+        mCommandCount(0),
+        mBusyTimeNs(0),
+        mStarvationCount(0),
+        mStarvationTimeMs(0),
         mForked(false),
         mThreadPoolStarted(false),
         mThreadPoolSeq(1),
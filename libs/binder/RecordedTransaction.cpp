@@ -21,6 +21,7 @@
 #include <binder/unique_fd.h>
 
 #include <inttypes.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <algorithm>
@@ -310,80 +311,134 @@ std::optional<RecordedTransaction> RecordedTransaction::fromFile(const unique_fd
     return std::optional<RecordedTransaction>(std::move(t));
 }
 
-android::status_t RecordedTransaction::writeChunk(borrowed_fd fd, uint32_t chunkType,
-                                                  size_t byteCount, const uint8_t* data) const {
+android::status_t RecordedTransaction::appendChunk(std::vector<uint8_t>* buffer,
+                                                   uint32_t chunkType, size_t byteCount,
+                                                   const uint8_t* data) {
     if (byteCount > kMaxChunkDataSize) {
         ALOGE("Chunk data exceeds maximum size");
         return BAD_VALUE;
     }
     ChunkDescriptor descriptor = {.chunkType = chunkType,
                                   .dataSize = static_cast<uint32_t>(byteCount)};
-    // Prepare Chunk content as byte *
-    const std::byte* descriptorBytes = reinterpret_cast<const std::byte*>(&descriptor);
-    const std::byte* dataBytes = reinterpret_cast<const std::byte*>(data);
-
-    // Add Chunk to intermediate buffer, except checksum
-    std::vector<std::byte> buffer;
-    buffer.insert(buffer.end(), descriptorBytes, descriptorBytes + sizeof(ChunkDescriptor));
-    buffer.insert(buffer.end(), dataBytes, dataBytes + byteCount);
-    std::byte zero{0};
-    buffer.insert(buffer.end(), PADDING8(byteCount), zero);
-
-    // Calculate checksum from buffer
-    transaction_checksum_t* checksumData = reinterpret_cast<transaction_checksum_t*>(buffer.data());
-    transaction_checksum_t checksumValue = 0;
-    for (size_t idx = 0; idx < (buffer.size() / sizeof(transaction_checksum_t)); idx++) {
-        checksumValue ^= checksumData[idx];
-    }
+    const uint8_t* descriptorBytes = reinterpret_cast<const uint8_t*>(&descriptor);
 
-    // Write checksum to buffer
-    std::byte* checksumBytes = reinterpret_cast<std::byte*>(&checksumValue);
-    buffer.insert(buffer.end(), checksumBytes, checksumBytes + sizeof(transaction_checksum_t));
+    // Add Chunk to buffer, except checksum
+    size_t chunkStart = buffer->size();
+    buffer->insert(buffer->end(), descriptorBytes, descriptorBytes + sizeof(ChunkDescriptor));
+    if (byteCount > 0) {
+        buffer->insert(buffer->end(), data, data + byteCount);
+    }
+    buffer->insert(buffer->end(), PADDING8(byteCount), 0);
 
-    // Write buffer to file
-    if (!WriteFully(fd, buffer.data(), buffer.size())) {
-        ALOGE("Failed to write chunk fd %d", fd.get());
-        return UNKNOWN_ERROR;
+    // Calculate checksum from buffer. The buffer may hold previous records, so the chunk is not
+    // necessarily 8-byte aligned in memory.
+    transaction_checksum_t checksumValue = 0;
+    for (size_t idx = chunkStart; idx < buffer->size(); idx += sizeof(transaction_checksum_t)) {
+        transaction_checksum_t word;
+        memcpy(&word, buffer->data() + idx, sizeof(word));
+        checksumValue ^= word;
     }
+
+    const uint8_t* checksumBytes = reinterpret_cast<const uint8_t*>(&checksumValue);
+    buffer->insert(buffer->end(), checksumBytes, checksumBytes + sizeof(transaction_checksum_t));
     return NO_ERROR;
 }
 
-android::status_t RecordedTransaction::dumpToFile(const unique_fd& fd) const {
+android::status_t RecordedTransaction::serialize(
+        std::vector<uint8_t>* buffer, const TransactionHeader& header,
+        const std::string& interfaceName, const uint8_t* sentData, size_t sentDataSize,
+        const uint8_t* replyData, size_t replyDataSize, const uint64_t* sentObjects,
+        size_t sentObjectCount) {
+    buffer->reserve(buffer->size() + 6 * (sizeof(ChunkDescriptor) + 7 + sizeof(transaction_checksum_t)) +
+                    sizeof(TransactionHeader) + interfaceName.size() + sentDataSize +
+                    replyDataSize + sentObjectCount * sizeof(uint64_t));
+
     if (NO_ERROR !=
-        writeChunk(fd, HEADER_CHUNK, sizeof(TransactionHeader),
-                   reinterpret_cast<const uint8_t*>(&(mData.mHeader)))) {
-        ALOGE("Failed to write transactionHeader to fd %d", fd.get());
+        appendChunk(buffer, HEADER_CHUNK, sizeof(TransactionHeader),
+                    reinterpret_cast<const uint8_t*>(&header))) {
+        ALOGE("Failed to serialize transactionHeader");
         return UNKNOWN_ERROR;
     }
     if (NO_ERROR !=
-        writeChunk(fd, INTERFACE_NAME_CHUNK, mData.mInterfaceName.size() * sizeof(uint8_t),
-                   reinterpret_cast<const uint8_t*>(mData.mInterfaceName.c_str()))) {
-        ALOGI("Failed to write Interface Name Chunk to fd %d", fd.get());
+        appendChunk(buffer, INTERFACE_NAME_CHUNK, interfaceName.size() * sizeof(uint8_t),
+                    reinterpret_cast<const uint8_t*>(interfaceName.c_str()))) {
+        ALOGI("Failed to serialize Interface Name Chunk");
         return UNKNOWN_ERROR;
     }
 
-    if (NO_ERROR !=
-        writeChunk(fd, DATA_PARCEL_CHUNK, mSentDataOnly.dataBufferSize(), mSentDataOnly.data())) {
-        ALOGE("Failed to write sent Parcel to fd %d", fd.get());
+    if (NO_ERROR != appendChunk(buffer, DATA_PARCEL_CHUNK, sentDataSize, sentData)) {
+        ALOGE("Failed to serialize sent Parcel");
         return UNKNOWN_ERROR;
     }
 
-    if (NO_ERROR !=
-        writeChunk(fd, REPLY_PARCEL_CHUNK, mReplyDataOnly.dataBufferSize(),
-                   mReplyDataOnly.data())) {
-        ALOGE("Failed to write reply Parcel to fd %d", fd.get());
+    if (NO_ERROR != appendChunk(buffer, REPLY_PARCEL_CHUNK, replyDataSize, replyData)) {
+        ALOGE("Failed to serialize reply Parcel");
         return UNKNOWN_ERROR;
     }
 
     if (NO_ERROR !=
-        writeChunk(fd, DATA_PARCEL_OBJECT_CHUNK, mData.mSentObjectData.size() * sizeof(uint64_t),
-                   reinterpret_cast<const uint8_t*>(mData.mSentObjectData.data()))) {
-        ALOGE("Failed to write sent parcel object metadata to fd %d", fd.get());
+        appendChunk(buffer, DATA_PARCEL_OBJECT_CHUNK, sentObjectCount * sizeof(uint64_t),
+                    reinterpret_cast<const uint8_t*>(sentObjects))) {
+        ALOGE("Failed to serialize sent parcel object metadata");
         return UNKNOWN_ERROR;
     }
 
-    if (NO_ERROR != writeChunk(fd, END_CHUNK, 0, nullptr)) {
-        ALOGE("Failed to write end chunk to fd %d", fd.get());
+    if (NO_ERROR != appendChunk(buffer, END_CHUNK, 0, nullptr)) {
+        ALOGE("Failed to serialize end chunk");
+        return UNKNOWN_ERROR;
+    }
+    return NO_ERROR;
+}
+
+android::status_t RecordedTransaction::serializeDetails(
+        std::vector<uint8_t>* buffer, const String16& interfaceName, uint32_t code, uint32_t flags,
+        timespec timestamp, const Parcel& dataParcel, const Parcel& replyParcel, status_t err) {
+    TransactionHeader header = {code,
+                                flags,
+                                static_cast<int32_t>(err),
+                                dataParcel.isForRpc() ? static_cast<uint32_t>(1)
+                                                      : static_cast<uint32_t>(0),
+                                static_cast<int64_t>(timestamp.tv_sec),
+                                static_cast<int32_t>(timestamp.tv_nsec),
+                                0};
+
+    std::string name(String8(interfaceName).c_str());
+    if (interfaceName.size() != name.size()) {
+        ALOGE("Interface Name is not valid. Contains characters that aren't single byte utf-8.");
+        return BAD_VALUE;
+    }
+
+    std::vector<uint64_t> objects;
+    if (const auto* kernelFields = dataParcel.maybeKernelFields()) {
+        objects.assign(kernelFields->mObjects, kernelFields->mObjects + kernelFields->mObjectsSize);
+    }
+
+    size_t originalSize = buffer->size();
+    status_t status = serialize(buffer, header, name, dataParcel.data(),
+                                dataParcel.dataBufferSize(), replyParcel.data(),
+                                replyParcel.dataBufferSize(), objects.data(), objects.size());
+    if (status != NO_ERROR) {
+        buffer->resize(originalSize);
+    }
+    return status;
+}
+
+android::status_t RecordedTransaction::dumpToFile(const unique_fd& fd) const {
+    std::vector<uint8_t> buffer;
+    if (status_t status =
+                serialize(&buffer, mData.mHeader, mData.mInterfaceName, mSentDataOnly.data(),
+                          mSentDataOnly.dataBufferSize(), mReplyDataOnly.data(),
+                          mReplyDataOnly.dataBufferSize(), mData.mSentObjectData.data(),
+                          mData.mSentObjectData.size());
+        status != NO_ERROR) {
+        ALOGE("Failed to serialize RecordedTransaction for fd %d", fd.get());
+        return status;
+    }
+
+    // Write the whole transaction at once, so that concurrent readers never observe a partial
+    // record and the cost is a single syscall.
+    if (!WriteFully(fd, buffer.data(), buffer.size())) {
+        ALOGE("Failed to write RecordedTransaction to fd %d", fd.get());
         return UNKNOWN_ERROR;
     }
     return NO_ERROR;
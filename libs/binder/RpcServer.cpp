@@ -16,12 +16,15 @@
 
 #define LOG_TAG "RpcServer"
 
+#include <fcntl.h>
 #include <inttypes.h>
 #include <netinet/tcp.h>
 #include <poll.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <unistd.h>
 
+#include <deque>
 #include <thread>
 #include <vector>
 
@@ -33,6 +36,7 @@
 
 #include "BuildFlags.h"
 #include "FdTrigger.h"
+#include "FdUtils.h"
 #include "OS.h"
 #include "RpcSocketAddress.h"
 #include "RpcState.h"
@@ -48,6 +52,161 @@ using namespace android::binder::impl;
 using android::binder::borrowed_fd;
 using android::binder::unique_fd;
 
+// Serves the incoming connections of all sessions of a server from a fixed pool
+// of threads.
+//
+// Connections which are waiting for a command are polled by a dispatcher
+// thread, together with the shutdown trigger of their session. Once one is
+// readable, it is queued for a worker thread, which owns it until the commands
+// received on it have been executed, and then hands it back to the dispatcher.
+class RpcServer::EventLoop {
+public:
+    struct Connection {
+        sp<RpcSession> session;
+        sp<RpcSession::RpcConnection> connection;
+        borrowed_fd fd;
+    };
+
+    // Returns nullptr for error case
+    static std::unique_ptr<EventLoop> make(size_t numWorkers);
+
+    void add(Connection&& connection);
+
+    // All connections must have been closed.
+    void shutdown();
+
+private:
+    void wake();
+    void dispatch();
+    void work();
+
+    unique_fd mWakeRead;
+    unique_fd mWakeWrite;
+
+    RpcMutex mLock; // for below
+    RpcConditionVariable mReadyCv;
+    bool mShutdown = false;
+    // Only removed from by the dispatcher thread.
+    std::vector<Connection> mIdle;
+    std::deque<Connection> mReady;
+    std::vector<RpcMaybeThread> mThreads;
+};
+
+std::unique_ptr<RpcServer::EventLoop> RpcServer::EventLoop::make(size_t numWorkers) {
+#ifdef BINDER_RPC_SINGLE_THREADED
+    (void)numWorkers;
+    return nullptr;
+#else
+    auto ret = std::make_unique<EventLoop>();
+    if (!binder::Pipe(&ret->mWakeRead, &ret->mWakeWrite, O_CLOEXEC | O_NONBLOCK)) {
+        ALOGE("Could not create pipe %s", strerror(errno));
+        return nullptr;
+    }
+
+    EventLoop* loop = ret.get();
+    ret->mThreads.emplace_back([loop] { loop->dispatch(); });
+    for (size_t i = 0; i < numWorkers; i++) {
+        ret->mThreads.emplace_back(
+                [loop] { RpcSession::runAttachedToJava([loop] { loop->work(); }); });
+    }
+    return ret;
+#endif
+}
+
+void RpcServer::EventLoop::add(Connection&& connection) {
+    {
+        RpcMutexLockGuard _l(mLock);
+        mIdle.push_back(std::move(connection));
+    }
+    wake();
+}
+
+void RpcServer::EventLoop::shutdown() {
+    {
+        RpcMutexLockGuard _l(mLock);
+        LOG_ALWAYS_FATAL_IF(!mIdle.empty() || !mReady.empty(),
+                            "Event loop still has %zu idle and %zu ready connections",
+                            mIdle.size(), mReady.size());
+        mShutdown = true;
+    }
+    mReadyCv.notify_all();
+    wake();
+
+    for (auto& thread : mThreads) {
+        thread.join();
+    }
+    mThreads.clear();
+}
+
+void RpcServer::EventLoop::wake() {
+    uint8_t byte = 0;
+    // If the pipe is full, the dispatcher is going to wake up anyway.
+    (void)TEMP_FAILURE_RETRY(write(mWakeWrite.get(), &byte, sizeof(byte)));
+}
+
+void RpcServer::EventLoop::dispatch() {
+#ifndef BINDER_RPC_SINGLE_THREADED
+    // mWakeRead, followed by the FD and the session shutdown trigger of each
+    // idle connection.
+    std::vector<pollfd> pfds;
+    while (true) {
+        size_t numIdle;
+        {
+            RpcMutexLockGuard _l(mLock);
+            if (mShutdown) return;
+
+            numIdle = mIdle.size();
+            pfds.clear();
+            pfds.push_back({.fd = mWakeRead.get(), .events = POLLIN, .revents = 0});
+            for (const auto& idle : mIdle) {
+                pfds.push_back({.fd = idle.fd.get(), .events = POLLIN, .revents = 0});
+                pfds.push_back({.fd = idle.session->mShutdownTrigger->pollFd().get(),
+                                .events = 0,
+                                .revents = 0});
+            }
+        }
+
+        int ret = TEMP_FAILURE_RETRY(poll(pfds.data(), pfds.size(), -1));
+        LOG_ALWAYS_FATAL_IF(ret < 0, "RpcServer event loop failed to poll: %s", strerror(errno));
+
+        if (pfds[0].revents != 0) {
+            uint8_t buf[64];
+            while (TEMP_FAILURE_RETRY(read(mWakeRead.get(), buf, sizeof(buf))) > 0) {
+            }
+        }
+
+        bool anyReady = false;
+        {
+            RpcMutexLockGuard _l(mLock);
+            // Connections may have been added while polling, but they are only
+            // appended, so the first numIdle entries are the ones polled.
+            for (size_t i = numIdle; i-- > 0;) {
+                if (pfds[1 + 2 * i].revents == 0 && pfds[2 + 2 * i].revents == 0) continue;
+                mReady.push_back(std::move(mIdle[i]));
+                if (i + 1 != mIdle.size()) mIdle[i] = std::move(mIdle.back());
+                mIdle.pop_back();
+                anyReady = true;
+            }
+        }
+        if (anyReady) mReadyCv.notify_all();
+    }
+#endif
+}
+
+void RpcServer::EventLoop::work() {
+    while (true) {
+        RpcMutexUniqueLock _l(mLock);
+        mReadyCv.wait(_l, [this] { return mShutdown || !mReady.empty(); });
+        if (mShutdown) return;
+        Connection ready = std::move(mReady.front());
+        mReady.pop_front();
+        _l.unlock();
+
+        if (!ready.session->serveIncomingCommands(ready.connection)) continue;
+        add(std::move(ready));
+    }
+}
+
 RpcServer::RpcServer(std::unique_ptr<RpcTransportCtx> ctx) : mCtx(std::move(ctx)) {}
 RpcServer::~RpcServer() {
     RpcMutexUniqueLock _l(mLock);
@@ -124,6 +283,17 @@ size_t RpcServer::getMaxThreads() {
     return mMaxThreads;
 }
 
+void RpcServer::setEventLoopThreads(size_t threads) {
+    LOG_ALWAYS_FATAL_IF(!kEnableRpcThreads && threads > 0,
+                        "RpcServer event loop is not supported on single-threaded libbinder");
+    LOG_ALWAYS_FATAL_IF(mJoinThreadRunning, "Cannot set event loop threads while running");
+    mEventLoopThreads = threads;
+}
+
+size_t RpcServer::getEventLoopThreads() {
+    return mEventLoopThreads;
+}
+
 bool RpcServer::setProtocolVersion(uint32_t version) {
     if (!RpcState::validateProtocolVersion(version)) {
         return false;
@@ -247,6 +417,10 @@ void RpcServer::join() {
         mJoinThreadRunning = true;
         mShutdownTrigger = FdTrigger::make();
         LOG_ALWAYS_FATAL_IF(mShutdownTrigger == nullptr, "Cannot create join signaler");
+        if (mEventLoopThreads > 0) {
+            mEventLoop = EventLoop::make(mEventLoopThreads);
+            LOG_ALWAYS_FATAL_IF(mEventLoop == nullptr, "Cannot create event loop");
+        }
     }
 
     status_t status;
@@ -276,12 +450,22 @@ void RpcServer::join() {
             continue;
         }
 
+        std::function<void(sp<RpcSession>&&, RpcSession::PreJoinSetupResult&&)> joinFn =
+                RpcSession::join;
+        if (mEventLoop != nullptr) {
+            joinFn = [fd = borrowed_fd(clientSocket.fd.get())](
+                             sp<RpcSession>&& session,
+                             RpcSession::PreJoinSetupResult&& setupResult) {
+                joinEventLoop(fd, std::move(session), std::move(setupResult));
+            };
+        }
+
         {
             RpcMutexLockGuard _l(mLock);
             RpcMaybeThread thread =
                     RpcMaybeThread(&RpcServer::establishConnection,
                                    sp<RpcServer>::fromExisting(this), std::move(clientSocket), addr,
-                                   addrLen, RpcSession::join);
+                                   addrLen, std::move(joinFn));
 
             auto& threadRef = mConnectingThreads[thread.get_id()];
             threadRef = std::move(thread);
@@ -333,6 +517,12 @@ bool RpcServer::shutdown() {
         }
     }
 
+    // All connections of the event loop were closed with their sessions.
+    if (mEventLoop != nullptr) {
+        mEventLoop->shutdown();
+        mEventLoop.reset();
+    }
+
     // At this point, we know join() is about to exit, but the thread that calls
     // join() may not have exited yet.
     // If RpcServer owns the join thread (aka start() is called), make sure the thread exits;
@@ -558,6 +748,28 @@ void RpcServer::establishConnection(
     joinFn(std::move(session), std::move(setupResult));
 }
 
+void RpcServer::joinEventLoop(borrowed_fd clientFd, sp<RpcSession>&& session,
+                              RpcSession::PreJoinSetupResult&& setupResult) {
+    sp<RpcServer> server = session->server();
+    if (setupResult.status != OK || server == nullptr) {
+        // cleans up the same way as for a dedicated thread
+        RpcSession::join(std::move(session), std::move(setupResult));
+        return;
+    }
+
+    session->releaseIncomingConnectionThread(setupResult.connection);
+
+    // The session is not dropped until this connection is closed, so shutdown()
+    // can't have torn down the event loop yet.
+    RpcMutexLockGuard _l(server->mLock);
+    LOG_ALWAYS_FATAL_IF(server->mEventLoop == nullptr, "Event loop is not running");
+    server->mEventLoop->add(EventLoop::Connection{
+            .session = std::move(session),
+            .connection = std::move(setupResult.connection),
+            .fd = clientFd,
+    });
+}
+
 status_t RpcServer::setupSocketServer(const RpcSocketAddress& addr) {
     LOG_RPC_DETAIL("Setting up socket server %s", addr.toString().c_str());
     LOG_ALWAYS_FATAL_IF(hasServer(), "Each RpcServer can only have one server.");
@@ -19,11 +19,13 @@
 #include <binder/RpcSession.h>
 
 #include <dlfcn.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <netinet/tcp.h>
 #include <poll.h>
 #include <unistd.h>
 
+#include <limits>
 #include <string_view>
 
 #include <binder/BpBinder.h>
@@ -36,6 +38,7 @@
 
 #include "BuildFlags.h"
 #include "FdTrigger.h"
+#include "FdUtils.h"
 #include "OS.h"
 #include "RpcSocketAddress.h"
 #include "RpcState.h"
@@ -54,6 +57,149 @@ using namespace android::binder::impl;
 using android::binder::borrowed_fd;
 using android::binder::unique_fd;
 
+// exclusiveTid of a connection which was handed off by ExclusiveConnection. No
+// thread has this ID, so such a connection is neither available, nor reused for
+// nested calls.
+constexpr uint64_t kHandedOffTid = std::numeric_limits<uint64_t>::max();
+
+// Reads the replies of the transactions sent by transactAsync.
+//
+// A single thread polls the connections waiting for a reply, together with the
+// shutdown trigger of the session. Once one is readable, the thread takes the
+// connection over, reads the reply (executing any nested commands which come
+// before it), releases the connection, and calls the callback.
+//
+// The thread only runs while replies are outstanding, and it holds a strong
+// reference to the session in the meantime, so the session (and this object)
+// can't be destroyed under it.
+class RpcSession::ReplyPoller {
+public:
+    struct Pending {
+        sp<RpcConnection> connection;
+        Parcel* reply;
+        TransactCallback callback;
+    };
+
+    // Returns nullptr for error case
+    static std::unique_ptr<ReplyPoller> make();
+
+    // The connection must have been handed off, after a transaction was sent
+    // on it.
+    void add(const sp<RpcSession>& session, Pending&& pending);
+
+private:
+    void wake();
+    void run(const sp<RpcSession>& session);
+
+    unique_fd mWakeRead;
+    unique_fd mWakeWrite;
+
+    RpcMutex mLock; // for below
+    bool mRunning = false;
+    // Only removed from by the polling thread.
+    std::vector<Pending> mPending;
+};
+
+std::unique_ptr<RpcSession::ReplyPoller> RpcSession::ReplyPoller::make() {
+    auto ret = std::make_unique<ReplyPoller>();
+    if (!binder::Pipe(&ret->mWakeRead, &ret->mWakeWrite, O_CLOEXEC | O_NONBLOCK)) {
+        ALOGE("Could not create pipe %s", strerror(errno));
+        return nullptr;
+    }
+    return ret;
+}
+
+void RpcSession::ReplyPoller::add(const sp<RpcSession>& session, Pending&& pending) {
+    RpcMutexLockGuard _l(mLock);
+    mPending.push_back(std::move(pending));
+    if (mRunning) {
+        wake();
+        return;
+    }
+    mRunning = true;
+    RpcMaybeThread([this, session] { run(session); }).detach();
+}
+
+void RpcSession::ReplyPoller::wake() {
+    uint8_t byte = 0;
+    // If the pipe is full, the polling thread is going to wake up anyway.
+    (void)TEMP_FAILURE_RETRY(write(mWakeWrite.get(), &byte, sizeof(byte)));
+}
+
+void RpcSession::ReplyPoller::run(const sp<RpcSession>& session) {
+#ifndef BINDER_RPC_SINGLE_THREADED
+    // mWakeRead, the session shutdown trigger, and then the FD of each pending
+    // connection.
+    //
+    // Nothing was read from a pending connection since its transaction was
+    // sent, so the transport can't have buffered any of its data, and polling
+    // the FD is enough.
+    std::vector<pollfd> pfds;
+    std::vector<Pending> ready;
+    while (true) {
+        size_t numPending;
+        {
+            RpcMutexLockGuard _l(mLock);
+            if (mPending.empty()) {
+                mRunning = false;
+                return;
+            }
+
+            numPending = mPending.size();
+            pfds.clear();
+            pfds.push_back({.fd = mWakeRead.get(), .events = POLLIN, .revents = 0});
+            pfds.push_back({.fd = session->mShutdownTrigger->pollFd().get(),
+                            .events = 0,
+                            .revents = 0});
+            for (const auto& pending : mPending) {
+                pfds.push_back({.fd = pending.connection->rpcTransport->pollFd().get(),
+                                .events = POLLIN,
+                                .revents = 0});
+            }
+        }
+
+        int ret = TEMP_FAILURE_RETRY(poll(pfds.data(), pfds.size(), -1));
+        LOG_ALWAYS_FATAL_IF(ret < 0, "RpcSession reply poller failed to poll: %s",
+                            strerror(errno));
+
+        if (pfds[0].revents != 0) {
+            uint8_t buf[64];
+            while (TEMP_FAILURE_RETRY(read(mWakeRead.get(), buf, sizeof(buf))) > 0) {
+            }
+        }
+
+        // Once the session is shut down, every read fails, which completes
+        // all of the pending calls.
+        bool shutdown = pfds[1].revents != 0;
+        {
+            RpcMutexLockGuard _l(mLock);
+            // Calls may have been added while polling, but they are only
+            // appended, so the first numPending entries are the ones polled.
+            for (size_t i = numPending; i-- > 0;) {
+                if (!shutdown && pfds[2 + i].revents == 0) continue;
+                ready.push_back(std::move(mPending[i]));
+                if (i + 1 != mPending.size()) mPending[i] = std::move(mPending.back());
+                mPending.pop_back();
+            }
+        }
+
+        for (auto& pending : ready) {
+            {
+                RpcMutexLockGuard _l(session->mMutex);
+                pending.connection->exclusiveTid = binder::os::GetThreadId();
+            }
+            status_t status =
+                    session->state()->waitForReply(pending.connection, session, pending.reply);
+            session->clearConnectionTid(pending.connection);
+            pending.callback(status);
+        }
+        ready.clear();
+    }
+#else
+    (void)session;
+#endif
+}
+
 RpcSession::RpcSession(std::unique_ptr<RpcTransportCtx> ctx) : mCtx(std::move(ctx)) {
     LOG_RPC_DETAIL("RpcSession created %p", this);
 
@@ -277,6 +423,52 @@ status_t RpcSession::transact(const sp<IBinder>& binder, uint32_t code, const Pa
                              sp<RpcSession>::fromExisting(this), reply, flags);
 }
 
+status_t RpcSession::transactAsync(const sp<IBinder>& binder, uint32_t code, const Parcel& data,
+                                   Parcel* reply, uint32_t flags, TransactCallback&& callback) {
+    if constexpr (!kEnableRpcThreads) {
+        ALOGE("RpcSession::transactAsync is not supported on single-threaded libbinder");
+        return INVALID_OPERATION;
+    }
+    if (flags & IBinder::FLAG_ONEWAY) {
+        ALOGE("RpcSession::transactAsync does not support oneway transactions");
+        return BAD_VALUE;
+    }
+    LOG_ALWAYS_FATAL_IF(reply == nullptr, "Reply parcel must be used for synchronous transaction.");
+
+    {
+        RpcMutexLockGuard _l(mMutex);
+        if (mReplyPoller == nullptr) {
+            mReplyPoller = ReplyPoller::make();
+            if (mReplyPoller == nullptr) return UNKNOWN_ERROR;
+        }
+    }
+
+    ExclusiveConnection connection;
+    status_t status = ExclusiveConnection::find(sp<RpcSession>::fromExisting(this),
+                                                ConnectionUse::CLIENT, &connection);
+    if (status != OK) return status;
+
+    // The reply has to be read on this connection by this thread, since it may
+    // be in the middle of a transaction on it.
+    if (connection.reentrant()) {
+        callback(state()->transact(connection.get(), binder, code, data,
+                                   sp<RpcSession>::fromExisting(this), reply, flags));
+        return OK;
+    }
+
+    status = state()->sendTransaction(connection.get(), binder, code, data,
+                                      sp<RpcSession>::fromExisting(this), flags);
+    if (status != OK) return status;
+
+    mReplyPoller->add(sp<RpcSession>::fromExisting(this),
+                      ReplyPoller::Pending{
+                              .connection = connection.handOff(),
+                              .reply = reply,
+                              .callback = std::move(callback),
+                      });
+    return OK;
+}
+
 status_t RpcSession::sendDecStrong(const BpBinder* binder) {
     // target is 0 because this is used to free BpBinder objects
     return sendDecStrongToTarget(binder->getPrivateAccessor().rpcAddress(), 0 /*target*/);
@@ -467,6 +659,58 @@ void RpcSession::join(sp<RpcSession>&& session, PreJoinSetupResult&& setupResult
     }
 }
 
+void RpcSession::releaseIncomingConnectionThread(const sp<RpcConnection>& connection) {
+    RpcMutexLockGuard _l(mMutex);
+    auto it = mConnections.mThreads.find(rpc_this_thread::get_id());
+    LOG_ALWAYS_FATAL_IF(it == mConnections.mThreads.end());
+    it->second.detach();
+    mConnections.mThreads.erase(it);
+
+    connection->exclusiveTid = std::nullopt;
+}
+
+bool RpcSession::serveIncomingCommands(const sp<RpcConnection>& connection) {
+    sp<RpcSession> session = sp<RpcSession>::fromExisting(this);
+    {
+        RpcMutexLockGuard _l(mMutex);
+        LOG_ALWAYS_FATAL_IF(connection->exclusiveTid != std::nullopt,
+                            "Incoming connection is already being served");
+        connection->exclusiveTid = binder::os::GetThreadId();
+    }
+
+    // Also execute the commands which the transport has already buffered, e.g.
+    // TLS records, since these won't make the socket readable again.
+    status_t status;
+    do {
+        status = state()->getAndExecuteCommand(connection, session, RpcState::CommandType::ANY);
+    } while (status == OK && (status = connection->rpcTransport->pollRead()) == OK);
+
+    if (status == WOULD_BLOCK) {
+        clearConnectionTid(connection);
+        return true;
+    }
+    LOG_RPC_DETAIL("Binder connection closing w/ status %s", statusToString(status).c_str());
+
+    sp<RpcSession::EventListener> listener;
+    {
+        RpcMutexLockGuard _l(mMutex);
+        listener = mEventListener.promote();
+    }
+
+    LOG_ALWAYS_FATAL_IF(!removeIncomingConnection(connection),
+                        "bad state: connection object guaranteed to be in list");
+
+    if (listener != nullptr) {
+        listener->onSessionIncomingThreadEnded();
+    }
+    return false;
+}
+
+void RpcSession::runAttachedToJava(const std::function<void()>& fn) {
+    [[maybe_unused]] JavaThreadAttacher javaThreadAttacher;
+    fn();
+}
+
 sp<RpcServer> RpcSession::server() {
     RpcServer* unsafeServer = mForServer.unsafe_get();
     sp<RpcServer> server = mForServer.promote();
@@ -990,6 +1234,13 @@ RpcSession::ExclusiveConnection::~ExclusiveConnection() {
     }
 }
 
+sp<RpcSession::RpcConnection> RpcSession::ExclusiveConnection::handOff() {
+    LOG_ALWAYS_FATAL_IF(mReentrant, "Can't hand off a connection used by an outer call");
+    RpcMutexLockGuard _l(mSession->mMutex);
+    mConnection->exclusiveTid = kHandedOffTid;
+    return std::move(mConnection);
+}
+
 bool RpcSession::hasActiveConnection(const std::vector<sp<RpcConnection>>& connections) {
     for (const auto& connection : connections) {
         if (connection->exclusiveTid != std::nullopt && !connection->rpcTransport->isWaiting()) {
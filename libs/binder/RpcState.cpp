@@ -525,21 +525,60 @@ status_t RpcState::getSessionId(const sp<RpcSession::RpcConnection>& connection,
 status_t RpcState::transact(const sp<RpcSession::RpcConnection>& connection,
                             const sp<IBinder>& binder, uint32_t code, const Parcel& data,
                             const sp<RpcSession>& session, Parcel* reply, uint32_t flags) {
+    uint64_t address;
+    if (status_t status = prepareTransaction(session, binder, code, data, &address); status != OK) {
+        return status;
+    }
+
+    return transactAddress(connection, address, code, data, session, reply, flags);
+}
+
+status_t RpcState::sendTransaction(const sp<RpcSession::RpcConnection>& connection,
+                                   const sp<IBinder>& binder, uint32_t code, const Parcel& data,
+                                   const sp<RpcSession>& session, uint32_t flags) {
+    uint64_t address;
+    if (status_t status = prepareTransaction(session, binder, code, data, &address); status != OK) {
+        return status;
+    }
+
+    return sendTransactionAddress(connection, address, code, data, session, flags);
+}
+
+status_t RpcState::prepareTransaction(const sp<RpcSession>& session, const sp<IBinder>& binder,
+                                      uint32_t code, const Parcel& data, uint64_t* outAddress) {
     std::string errorMsg;
     if (status_t status = validateParcel(session, data, &errorMsg); status != OK) {
         ALOGE("Refusing to send RPC on binder %p code %" PRIu32 ": Parcel %p failed validation: %s",
               binder.get(), code, &data, errorMsg.c_str());
         return status;
     }
-    uint64_t address;
-    if (status_t status = onBinderLeaving(session, binder, &address); status != OK) return status;
-
-    return transactAddress(connection, address, code, data, session, reply, flags);
+    return onBinderLeaving(session, binder, outAddress);
 }
 
 status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connection,
                                    uint64_t address, uint32_t code, const Parcel& data,
                                    const sp<RpcSession>& session, Parcel* reply, uint32_t flags) {
+    if (status_t status = sendTransactionAddress(connection, address, code, data, session, flags);
+        status != OK) {
+        return status;
+    }
+
+    if (flags & IBinder::FLAG_ONEWAY) {
+        LOG_RPC_DETAIL("Oneway command, so no longer waiting on RpcTransport %p",
+                       connection->rpcTransport.get());
+
+        // Do not wait on result.
+        return OK;
+    }
+
+    LOG_ALWAYS_FATAL_IF(reply == nullptr, "Reply parcel must be used for synchronous transaction.");
+
+    return waitForReply(connection, session, reply);
+}
+
+status_t RpcState::sendTransactionAddress(const sp<RpcSession::RpcConnection>& connection,
+                                          uint64_t address, uint32_t code, const Parcel& data,
+                                          const sp<RpcSession>& session, uint32_t flags) {
     LOG_ALWAYS_FATAL_IF(!data.isForRpc());
     LOG_ALWAYS_FATAL_IF(data.objectsCount() != 0);
 
@@ -626,17 +665,7 @@ status_t RpcState::transactAddress(const sp<RpcSession::RpcConnection>& connecti
         return status;
     }
 
-    if (flags & IBinder::FLAG_ONEWAY) {
-        LOG_RPC_DETAIL("Oneway command, so no longer waiting on RpcTransport %p",
-                       connection->rpcTransport.get());
-
-        // Do not wait on result.
-        return OK;
-    }
-
-    LOG_ALWAYS_FATAL_IF(reply == nullptr, "Reply parcel must be used for synchronous transaction.");
-
-    return waitForReply(connection, session, reply);
+    return OK;
 }
 
 static void cleanup_reply_data(const uint8_t* data, size_t dataSize, const binder_size_t* objects,
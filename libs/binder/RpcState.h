@@ -90,6 +90,19 @@ public:
                                            const sp<RpcSession>& session, Parcel* reply,
                                            uint32_t flags);
 
+    /**
+     * Like transact, but returns once the transaction is sent, without waiting
+     * for its reply. The connection must be kept exclusive until the reply is
+     * read with waitForReply (any nested commands which arrive before it are
+     * executed there).
+     */
+    [[nodiscard]] status_t sendTransaction(const sp<RpcSession::RpcConnection>& connection,
+                                           const sp<IBinder>& address, uint32_t code,
+                                           const Parcel& data, const sp<RpcSession>& session,
+                                           uint32_t flags);
+    [[nodiscard]] status_t waitForReply(const sp<RpcSession::RpcConnection>& connection,
+                                        const sp<RpcSession>& session, Parcel* reply);
+
     /**
      * The ownership model here carries an implicit strong refcount whenever a
      * binder is sent across processes. Since we have a local strong count in
@@ -200,8 +213,13 @@ private:
                                   std::vector<std::variant<binder::unique_fd, binder::borrowed_fd>>*
                                           ancillaryFds = nullptr);
 
-    [[nodiscard]] status_t waitForReply(const sp<RpcSession::RpcConnection>& connection,
-                                        const sp<RpcSession>& session, Parcel* reply);
+    [[nodiscard]] status_t prepareTransaction(const sp<RpcSession>& session,
+                                              const sp<IBinder>& binder, uint32_t code,
+                                              const Parcel& data, uint64_t* outAddress);
+    [[nodiscard]] status_t sendTransactionAddress(const sp<RpcSession::RpcConnection>& connection,
+                                                  uint64_t address, uint32_t code,
+                                                  const Parcel& data, const sp<RpcSession>& session,
+                                                  uint32_t flags);
     [[nodiscard]] status_t processCommand(
             const sp<RpcSession::RpcConnection>& connection, const sp<RpcSession>& session,
             const RpcWireHeader& command, CommandType type,
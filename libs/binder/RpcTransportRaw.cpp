@@ -84,6 +84,7 @@ public:
     }
 
     bool isWaiting() override { return mSocket.isInPollingState(); }
+    borrowed_fd pollFd() override { return borrowed_fd(mSocket.fd.get()); }
 
 private:
     android::RpcTransportFd mSocket;
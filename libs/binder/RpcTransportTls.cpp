@@ -18,11 +18,13 @@
 #include <log/log.h>
 
 #include <poll.h>
+#include <string.h>
 #include <sys/socket.h>
 
 #include <openssl/bn.h>
 #include <openssl/ssl.h>
 
+#include <binder/RpcThreads.h>
 #include <binder/RpcTlsUtils.h>
 #include <binder/RpcTransportTls.h>
 
@@ -48,6 +50,13 @@ using android::binder::unique_fd;
 
 namespace {
 
+// The largest amount of data that a single TLS record can carry. Every SSL_write() produces at
+// least one record, so writes are gathered into records of this size.
+constexpr size_t kMaxRecordSize = SSL3_RT_MAX_PLAIN_LENGTH;
+
+// Sessions are only resumed by contexts that use the same session ID context.
+constexpr uint8_t kSessionIdContext[] = "binder_rpc";
+
 // Implement BIO for socket that ignores SIGPIPE.
 int socketNew(BIO* bio) {
     BIO_set_data(bio, reinterpret_cast<void*>(-1));
@@ -299,10 +308,13 @@ public:
             std::vector<std::variant<unique_fd, borrowed_fd>>* ancillaryFds) override;
 
     bool isWaiting() override { return mSocket.isInPollingState(); };
+    borrowed_fd pollFd() override { return borrowed_fd(mSocket.fd.get()); }
 
 private:
     android::RpcTransportFd mSocket;
     Ssl mSsl;
+    // Holds the data of a record which is not full yet, allocated on first use.
+    std::unique_ptr<uint8_t[]> mWriteBuffer;
 };
 
 // Error code is errno.
@@ -338,16 +350,8 @@ status_t RpcTransportTls::interruptableWriteFully(
     // once. The trigger is also checked via triggerablePoll() after every SSL_write().
     if (fdTrigger->isTriggered()) return DEAD_OBJECT;
 
-    size_t size = 0;
-    for (int i = 0; i < niovs; i++) {
-        const iovec& iov = iovs[i];
-        if (iov.iov_len == 0) {
-            continue;
-        }
-        size += iov.iov_len;
-
-        auto buffer = reinterpret_cast<const uint8_t*>(iov.iov_base);
-        const uint8_t* end = buffer + iov.iov_len;
+    auto writeAll = [&](const uint8_t* buffer, size_t len) -> status_t {
+        const uint8_t* end = buffer + len;
         while (buffer < end) {
             size_t todo = std::min<size_t>(end - buffer, std::numeric_limits<int>::max());
             auto [writeSize, errorQueue] = mSsl.call(SSL_write, buffer, todo);
@@ -365,6 +369,42 @@ status_t RpcTransportTls::interruptableWriteFully(
             if (pollStatus != OK) return pollStatus;
             // Do not advance buffer. Try SSL_write() again.
         }
+        return OK;
+    };
+
+    if (mWriteBuffer == nullptr) mWriteBuffer.reset(new uint8_t[kMaxRecordSize]);
+    uint8_t* pending = mWriteBuffer.get();
+    size_t pendingSize = 0;
+
+    size_t size = 0;
+    for (int i = 0; i < niovs; i++) {
+        const iovec& iov = iovs[i];
+        size += iov.iov_len;
+
+        auto buffer = reinterpret_cast<const uint8_t*>(iov.iov_base);
+        size_t remaining = iov.iov_len;
+        while (remaining > 0) {
+            // Full records are written in place, without copying them.
+            if (pendingSize == 0 && remaining >= kMaxRecordSize) {
+                size_t todo = remaining - remaining % kMaxRecordSize;
+                if (status_t status = writeAll(buffer, todo); status != OK) return status;
+                buffer += todo;
+                remaining -= todo;
+                continue;
+            }
+            size_t todo = std::min(remaining, kMaxRecordSize - pendingSize);
+            memcpy(pending + pendingSize, buffer, todo);
+            pendingSize += todo;
+            buffer += todo;
+            remaining -= todo;
+            if (pendingSize == kMaxRecordSize) {
+                if (status_t status = writeAll(pending, pendingSize); status != OK) return status;
+                pendingSize = 0;
+            }
+        }
+    }
+    if (pendingSize > 0) {
+        if (status_t status = writeAll(pending, pendingSize); status != OK) return status;
     }
     LOG_TLS_DETAIL("TLS: Sent %zu bytes!", size);
     return OK;
@@ -459,9 +499,15 @@ public:
 
 protected:
     static ssl_verify_result_t sslCustomVerify(SSL* ssl, uint8_t* outAlert);
+    static int sslNewSession(SSL* ssl, SSL_SESSION* session);
     virtual void preHandshake(Ssl* ssl) const = 0;
     bssl::UniquePtr<SSL_CTX> mCtx;
     std::shared_ptr<RpcCertificateVerifier> mCertVerifier;
+
+    // For clients, the session from the latest ticket issued by the server, which is offered
+    // when connecting again.
+    mutable RpcMutex mSessionLock;
+    bssl::UniquePtr<SSL_SESSION> mSession;
 };
 
 std::vector<uint8_t> RpcTransportCtxTls::getCertificate(RpcCertificateFormat format) const {
@@ -490,6 +536,23 @@ ssl_verify_result_t RpcTransportCtxTls::sslCustomVerify(SSL* ssl, uint8_t* outAl
     return ssl_verify_invalid;
 }
 
+// Keeps the latest session of a client, so that the next connection can resume it. The first
+// connection of an RpcSession receives tickets while reading the response to its connection
+// header, before any other connection is made.
+int RpcTransportCtxTls::sslNewSession(SSL* ssl, SSL_SESSION* session) {
+    if (SSL_is_server(ssl)) return 0;
+
+    auto ctx = SSL_get_SSL_CTX(ssl); // Does not set error queue
+    LOG_ALWAYS_FATAL_IF(ctx == nullptr);
+    // void* -> RpcTransportCtxTls*
+    auto rpcTransportCtxTls = reinterpret_cast<RpcTransportCtxTls*>(SSL_CTX_get_app_data(ctx));
+    LOG_ALWAYS_FATAL_IF(rpcTransportCtxTls == nullptr);
+
+    RpcMutexLockGuard _l(rpcTransportCtxTls->mSessionLock);
+    rpcTransportCtxTls->mSession.reset(session);
+    return 1; // takes ownership of session
+}
+
 // Common implementation for creating server and client contexts. The child class, |Impl|, is
 // provided as a template argument so that this function can initialize an |Impl| object.
 template <typename Impl, typename>
@@ -512,6 +575,16 @@ std::unique_ptr<RpcTransportCtxTls> RpcTransportCtxTls::create(
     // Require at least TLS 1.3
     TEST_AND_RETURN(nullptr, SSL_CTX_set_min_proto_version(ctx.get(), TLS1_3_VERSION));
 
+    // Let additional connections of a session, and reconnects, resume the session of an earlier
+    // connection with a PSK from a session ticket, instead of exchanging and verifying
+    // certificates again. Servers issue stateless tickets, encrypted with keys which are private
+    // to this context, so only a peer which passed verification by this server can resume.
+    TEST_AND_RETURN(nullptr,
+                    SSL_CTX_set_session_id_context(ctx.get(), kSessionIdContext,
+                                                   sizeof(kSessionIdContext)));
+    SSL_CTX_set_session_cache_mode(ctx.get(), SSL_SESS_CACHE_BOTH | SSL_SESS_CACHE_NO_INTERNAL);
+    SSL_CTX_sess_set_new_cb(ctx.get(), sslNewSession);
+
     if constexpr (SHOULD_LOG_TLS_DETAIL) { // NOLINT
         SSL_CTX_set_info_callback(ctx.get(), sslDebugLog);
     }
@@ -546,6 +619,18 @@ class RpcTransportCtxTlsClient : public RpcTransportCtxTls {
 protected:
     void preHandshake(Ssl* ssl) const override {
         ssl->call(SSL_set_connect_state).errorQueue.clear();
+
+        RpcMutexLockGuard _l(mSessionLock);
+        if (mSession != nullptr && SSL_SESSION_is_resumable(mSession.get())) {
+            // SSL_set_session() takes its own reference, and falls back to a full handshake if
+            // the server doesn't accept the session.
+            auto [ret, errorQueue] = ssl->call(SSL_set_session, mSession.get());
+            if (ret != 1) {
+                ALOGW("Not resuming TLS session: %s", errorQueue.toString().c_str());
+            } else {
+                errorQueue.clear();
+            }
+        }
     }
 };
 
@@ -141,7 +141,9 @@ status_t Stability::setRepr(IBinder* binder, int32_t setting, uint32_t flags) {
     if (local != nullptr) {
         local->mStability = setting;
     } else {
-        binder->remoteBinder()->mStability = setting;
+        BpBinder* remote = binder->remoteBinder();
+        remote->mStability = setting;
+        remote->mCheckedStability.store(0, std::memory_order_relaxed);
     }
 
     return OK;
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TransactionRecorder"
+#include <log/log.h>
+
+#include "TransactionRecorder.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+#include <binder/RecordedTransaction.h>
+
+#include "BuildFlags.h"
+#include "file.h"
+
+namespace android {
+
+using android::binder::unique_fd;
+using android::binder::WriteFully;
+using android::binder::debug::RecordedTransaction;
+
+// Written buffers kept around for reuse, so that steady-state recording does not allocate.
+constexpr size_t kMaxFreeBuffers = 16;
+
+TransactionRecorder::TransactionRecorder(unique_fd fd, uint32_t samplingInterval)
+      : mFd(std::move(fd)), mSamplingInterval(std::max<uint32_t>(samplingInterval, 1)) {
+    if constexpr (kEnableRpcThreads) {
+        mWriter = RpcMaybeThread(&TransactionRecorder::writerLoop, this);
+    }
+}
+
+TransactionRecorder::~TransactionRecorder() {
+    stop();
+}
+
+void TransactionRecorder::record(const String16& interfaceName, uint32_t code, uint32_t flags,
+                                 const Parcel& data, const Parcel& reply, status_t err) {
+    if (mSamplingInterval > 1 &&
+        mTransactionCount.fetch_add(1, std::memory_order_relaxed) % mSamplingInterval != 0) {
+        return;
+    }
+
+    timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    std::vector<uint8_t> buffer = takeBuffer();
+    if (status_t status = RecordedTransaction::serializeDetails(&buffer, interfaceName, code,
+                                                                flags, ts, data, reply, err);
+        status != OK) {
+        ALOGI("Failed to serialize RecordedTransaction with error %d", status);
+        return;
+    }
+
+    if constexpr (!kEnableRpcThreads) {
+        if (!mStopping && !WriteFully(mFd, buffer.data(), buffer.size())) {
+            ALOGI("Failed to write RecordedTransaction to fd %d", mFd.get());
+        }
+        return;
+    }
+
+    RpcMutexLockGuard _l(mLock);
+    if (mStopping || mWriteFailed) return;
+    if (mPendingBytes + buffer.size() > kMaxPendingBytes) {
+        mDropped++;
+        return;
+    }
+    mPendingBytes += buffer.size();
+    mPending.push_back(std::move(buffer));
+    mCv.notify_one();
+}
+
+void TransactionRecorder::stop() {
+    {
+        RpcMutexLockGuard _l(mLock);
+        if (mStopping) return;
+        mStopping = true;
+    }
+    mCv.notify_all();
+    if constexpr (kEnableRpcThreads) {
+        mWriter.join();
+    }
+    if (mDropped > 0) {
+        ALOGW("Dropped %zu transactions because the recording fd could not keep up", mDropped);
+    }
+}
+
+std::vector<uint8_t> TransactionRecorder::takeBuffer() {
+    RpcMutexLockGuard _l(mLock);
+    if (mFreeBuffers.empty()) return {};
+    std::vector<uint8_t> buffer = std::move(mFreeBuffers.back());
+    mFreeBuffers.pop_back();
+    return buffer;
+}
+
+void TransactionRecorder::writerLoop() {
+    std::deque<std::vector<uint8_t>> batch;
+    size_t batchBytes = 0;
+    bool writeFailed = false;
+    while (true) {
+        {
+            RpcMutexUniqueLock _l(mLock);
+            mPendingBytes -= batchBytes;
+            mWriteFailed |= writeFailed;
+            for (auto& buffer : batch) {
+                if (mFreeBuffers.size() >= kMaxFreeBuffers) break;
+                buffer.clear();
+                mFreeBuffers.push_back(std::move(buffer));
+            }
+            batch.clear();
+
+            mCv.wait(_l, [&] { return !mPending.empty() || mStopping; });
+            // Everything queued before stop() is written out before returning.
+            if (mPending.empty()) return;
+            batch.swap(mPending);
+        }
+
+        batchBytes = 0;
+        for (const auto& record : batch) {
+            batchBytes += record.size();
+            if (writeFailed) continue;
+            if (!WriteFully(mFd, record.data(), record.size())) {
+                ALOGE("Failed to write RecordedTransaction to fd %d: %s", mFd.get(),
+                      strerror(errno));
+                writeFailed = true;
+            }
+        }
+    }
+}
+
+} // namespace android
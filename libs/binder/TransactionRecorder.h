@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <binder/Parcel.h>
+#include <binder/RpcThreads.h>
+#include <binder/unique_fd.h>
+#include <utils/String16.h>
+
+namespace android {
+
+/**
+ * Streams RecordedTransactions to a file descriptor without blocking the threads that serve
+ * the recorded binder.
+ *
+ * Each recorded transaction is serialized into a single buffer on the calling thread and queued.
+ * A writer thread drains the queue, so the transaction path never waits on the file. If the
+ * writer falls behind by more than kMaxPendingBytes, new records are dropped (and counted)
+ * rather than stalling the service.
+ *
+ * In single-threaded builds, records are written synchronously.
+ */
+class TransactionRecorder {
+public:
+    // Upper bound on the amount of serialized data waiting for the writer thread.
+    static constexpr size_t kMaxPendingBytes = 16 * 1024 * 1024;
+
+    /**
+     * Starts recording to fd. Only one out of every samplingInterval transactions passed to
+     * record() is written; 0 and 1 both record every transaction.
+     */
+    TransactionRecorder(binder::unique_fd fd, uint32_t samplingInterval);
+    ~TransactionRecorder();
+
+    /** Threadsafe. Ignored once stop() was called. */
+    void record(const String16& interfaceName, uint32_t code, uint32_t flags, const Parcel& data,
+                const Parcel& reply, status_t err);
+
+    /**
+     * Writes all of the records that were queued so far, then stops the writer thread. Must not
+     * be called concurrently with itself.
+     */
+    void stop();
+
+private:
+    void writerLoop();
+    // Returns a buffer for a new record, reusing one that was already written when possible.
+    std::vector<uint8_t> takeBuffer();
+
+    const binder::unique_fd mFd;
+    const uint32_t mSamplingInterval;
+    std::atomic<uint64_t> mTransactionCount = 0;
+
+    RpcMutex mLock; // for below
+    RpcConditionVariable mCv;
+    std::deque<std::vector<uint8_t>> mPending;
+    std::vector<std::vector<uint8_t>> mFreeBuffers;
+    size_t mPendingBytes = 0;
+    size_t mDropped = 0;
+    bool mStopping = false;
+    bool mWriteFailed = false;
+
+    RpcMaybeThread mWriter;
+};
+
+} // namespace android
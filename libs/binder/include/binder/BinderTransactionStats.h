@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <binder/Common.h>
+#include <utils/Errors.h>
+
+namespace android {
+
+class Parcel;
+
+/**
+ * Snapshot of the kernel binder transactions of a process, as counted by IPCThreadState since
+ * the process started. The counters are kept up to date with relaxed atomics on every
+ * transaction, so taking a snapshot never touches binder debugfs.
+ */
+struct BinderTransactionStats {
+    // Latency bucket i counts calls which took [2^i, 2^(i+1)) microseconds. Faster calls land in
+    // the first bucket, and slower calls in the last one.
+    static constexpr size_t kLatencyBuckets = 24;
+    // Codes [FIRST_CALL_TRANSACTION, FIRST_CALL_TRANSACTION + kTrackedCodes) are counted
+    // individually. All other codes share the last slot of callsPerCode.
+    static constexpr size_t kTrackedCodes = 64;
+
+    struct Direction {
+        uint64_t calls = 0;
+        uint64_t onewayCalls = 0;
+        uint64_t errors = 0;
+        uint64_t dataBytes = 0;
+        uint64_t replyBytes = 0;
+        // Two-way calls only. For outgoing calls, this is the round trip. For incoming calls, it
+        // is the time spent in BBinder::transact.
+        std::array<uint64_t, kLatencyBuckets> latencyHistogram{};
+        std::array<uint64_t, kTrackedCodes + 1> callsPerCode{};
+    };
+
+    Direction outgoing; // transactions sent by this process
+    Direction incoming; // transactions served by this process
+    // Oneway transactions being served right now, and the most that were ever served at once.
+    uint32_t onewayInFlight = 0;
+    uint32_t maxOnewayInFlight = 0;
+
+    /** Returns the index of the latencyHistogram bucket for a latency in nanoseconds. */
+    LIBBINDER_EXPORTED static size_t latencyBucket(int64_t latencyNs);
+    /** Returns the index of the callsPerCode slot for code. */
+    LIBBINDER_EXPORTED static size_t codeSlot(uint32_t code);
+
+    LIBBINDER_EXPORTED status_t writeToParcel(Parcel* parcel) const;
+    LIBBINDER_EXPORTED status_t readFromParcel(const Parcel& parcel);
+};
+
+} // namespace android
@@ -21,6 +21,8 @@
 #include <binder/RpcThreads.h>
 #include <binder/unique_fd.h>
 
+#include <atomic>
+#include <functional>
 #include <map>
 #include <optional>
 #include <unordered_map>
@@ -57,6 +59,20 @@ public:
     LIBBINDER_EXPORTED virtual status_t transact(uint32_t code, const Parcel& data, Parcel* reply,
                                                  uint32_t flags = 0) final;
 
+    /**
+     * Like transact, but doesn't block the calling thread until the reply
+     * arrives. Instead, callback is called with the status once the reply has
+     * been read into 'reply', which must be kept alive until then. See
+     * RpcSession::transactAsync.
+     *
+     * Only supported for RPC binders. For others, this returns
+     * INVALID_OPERATION and transact should be used instead. If this returns
+     * an error, nothing was sent and callback is not called.
+     */
+    LIBBINDER_EXPORTED status_t transactAsync(uint32_t code, const Parcel& data, Parcel* reply,
+                                              uint32_t flags,
+                                              std::function<void(status_t)>&& callback);
+
     // NOLINTNEXTLINE(google-default-arguments)
     LIBBINDER_EXPORTED virtual status_t linkToDeath(const sp<DeathRecipient>& recipient,
                                                     void* cookie = nullptr, uint32_t flags = 0);
@@ -95,6 +111,10 @@ public:
     // Start recording transactions to the unique_fd.
     // See RecordedTransaction.h for more details.
     LIBBINDER_EXPORTED status_t startRecordingBinder(const binder::unique_fd& fd);
+    // Same as above, but only records one out of every samplingInterval transactions. This
+    // keeps the overhead of recording low on busy services.
+    LIBBINDER_EXPORTED status_t startRecordingBinder(const binder::unique_fd& fd,
+                                                     uint32_t samplingInterval);
     // Stop the current recording.
     LIBBINDER_EXPORTED status_t stopRecordingBinder();
 
@@ -172,6 +192,10 @@ private:
     uint64_t rpcAddress() const;
     const sp<RpcSession>& rpcSession() const;
 
+    // Checks that user transactions are allowed on this binder in this context,
+    // and clears the userspace flags in 'flags'.
+    status_t checkTransactionStability(uint32_t code, uint32_t* flags);
+
     explicit BpBinder(Handle&& handle);
     BpBinder(BinderHandle&& handle, int32_t trackedUid);
     explicit BpBinder(RpcHandle&& handle);
@@ -184,6 +208,9 @@ private:
     friend ::android::internal::Stability;
 
     int32_t mStability;
+    // The last required level which mStability was found to satisfy, so that repeated user
+    // transactions skip Stability::check. Cleared by Stability::setRepr.
+    std::atomic<int32_t> mCheckedStability = 0;
     Handle mHandle;
 
     struct Obituary {
@@ -22,6 +22,9 @@
 #include <utils/Errors.h>
 #include <utils/Vector.h>
 
+#include <memory>
+#include <vector>
+
 #if defined(_WIN32)
 typedef  int  uid_t;
 #endif
@@ -29,6 +32,8 @@ typedef  int  uid_t;
 // ---------------------------------------------------------------------------
 namespace android {
 
+struct BinderTransactionStats;
+
 /**
  * Kernel binder thread state. All operations here refer to kernel binder. This
  * object is allocated per-thread.
@@ -166,6 +171,19 @@ public:
     LIBBINDER_EXPORTED status_t transact(int32_t handle, uint32_t code, const Parcel& data,
                                          Parcel* reply, uint32_t flags);
 
+    // Oneway transactions sent from this thread between beginOnewayBatch() and the matching
+    // endOnewayBatch() are queued instead of being sent one by one. They are written to the
+    // driver together, usually in a single BINDER_WRITE_READ, when the outermost batch ends.
+    // Their data is copied, so the caller may release it as soon as transact() returns.
+    //
+    // A two-way transaction sent during a batch sends the queued transactions first, so the
+    // order of transactions is preserved.
+    //
+    // transact() returns NO_ERROR for a queued transaction. endOnewayBatch() returns the first
+    // error reported by the driver for any transaction of the batch.
+    LIBBINDER_EXPORTED void beginOnewayBatch();
+    LIBBINDER_EXPORTED status_t endOnewayBatch();
+
     LIBBINDER_EXPORTED void incStrongHandle(int32_t handle, BpBinder* proxy);
     LIBBINDER_EXPORTED void decStrongHandle(int32_t handle);
     LIBBINDER_EXPORTED void incWeakHandle(int32_t handle, BpBinder* proxy);
@@ -185,6 +203,10 @@ public:
     LIBBINDER_EXPORTED static void disableBackgroundScheduling(bool disable);
     LIBBINDER_EXPORTED bool backgroundSchedulingDisabled();
 
+    // Fills stats with the kernel binder transactions sent and served by this
+    // process so far. This is cheap enough to be polled continuously.
+    LIBBINDER_EXPORTED static void getTransactionStats(BinderTransactionStats* stats);
+
     // Call blocks until the number of executing binder threads is less than
     // the maximum number of binder threads threads allowed for this process.
     LIBBINDER_EXPORTED void blockUntilThreadAvailable();
@@ -215,6 +237,9 @@ private:
     status_t talkWithDriver(bool doReceive = true);
     status_t writeTransactionData(int32_t cmd, uint32_t binderFlags, int32_t handle, uint32_t code,
                                   const Parcel& data, status_t* statusBuffer);
+    status_t queueOnewayTransaction(int32_t handle, uint32_t code, const Parcel& data,
+                                    uint32_t flags);
+    void flushOnewayBatch();
     status_t getAndExecuteCommand();
     status_t executeCommand(int32_t command);
     void processPendingDerefs();
@@ -251,6 +276,11 @@ private:
             int32_t             mStrictModePolicy;
             int32_t             mLastTransactionBinderFlags;
             CallRestriction     mCallRestriction;
+            // See beginOnewayBatch(). The parcels must stay alive until the driver has read
+            // the transactions which point into them.
+            uint32_t mOnewayBatchDepth;
+            std::vector<std::unique_ptr<Parcel>> mOnewayBatch;
+            status_t mOnewayBatchError;
 };
 
 } // namespace android
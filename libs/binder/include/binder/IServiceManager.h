@@ -147,6 +147,15 @@ public:
         int pid;
     };
     virtual std::vector<ServiceDebugInfo> getServiceDebugInfo() = 0;
+
+    /**
+     * Lookups answered from (hits) or forwarded past (misses) the process-local
+     * service cache used by checkService, getService and waitForService.
+     */
+    struct ServiceCacheStats {
+        uint64_t hits;
+        uint64_t misses;
+    };
 };
 
 LIBBINDER_EXPORTED sp<IServiceManager> defaultServiceManager();
@@ -159,6 +168,13 @@ LIBBINDER_EXPORTED sp<IServiceManager> defaultServiceManager();
  */
 LIBBINDER_EXPORTED void setDefaultServiceManager(const sp<IServiceManager>& sm);
 
+/**
+ * Statistics for the process-local service cache in front of the default
+ * service manager. Only binders that are still strongly held somewhere in
+ * this process can be returned from the cache.
+ */
+LIBBINDER_EXPORTED IServiceManager::ServiceCacheStats getServiceCacheStats();
+
 template<typename INTERFACE>
 sp<INTERFACE> waitForService(const String16& name) {
     const sp<IServiceManager> sm = defaultServiceManager();
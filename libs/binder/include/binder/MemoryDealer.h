@@ -26,15 +26,29 @@
 namespace android {
 // ----------------------------------------------------------------------------
 
-class SimpleBestFitAllocator;
+class HeapAllocator;
 
 // ----------------------------------------------------------------------------
 
 class MemoryDealer : public RefBase {
 public:
+    // How allocations are placed in the heap.
+    enum class Allocator {
+        // Best-fit search through a list of chunks. Allocations are only rounded up to
+        // getAllocationAlignment(), but allocating and freeing are linear in the number of
+        // chunks.
+        BEST_FIT,
+        // Buddy allocator with a free list per power-of-two size class. Allocating and freeing
+        // are logarithmic in the heap size, at the cost of rounding allocations up to a power of
+        // two. Prefer this for heaps shared by many concurrent clients.
+        BUDDY,
+    };
+
     LIBBINDER_EXPORTED explicit MemoryDealer(
             size_t size, const char* name = nullptr,
             uint32_t flags = 0 /* or bits such as MemoryHeapBase::READ_ONLY */);
+    LIBBINDER_EXPORTED MemoryDealer(size_t size, const char* name, uint32_t flags,
+                                    Allocator allocator);
 
     LIBBINDER_EXPORTED virtual sp<IMemory> allocate(size_t size);
     LIBBINDER_EXPORTED virtual void dump(const char* what) const;
@@ -51,10 +65,10 @@ private:
     friend class Allocation;
     virtual void                deallocate(size_t offset);
     LIBBINDER_EXPORTED const sp<IMemoryHeap>& heap() const;
-    SimpleBestFitAllocator*     allocator() const;
+    HeapAllocator*              allocator() const;
 
     sp<IMemoryHeap>             mHeap;
-    SimpleBestFitAllocator*     mAllocator;
+    HeapAllocator*              mAllocator;
 };
 
 // ----------------------------------------------------------------------------
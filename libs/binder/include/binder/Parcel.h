@@ -673,6 +673,9 @@ private:
     void                releaseObjects();
     void                acquireObjects();
     status_t            growData(size_t len);
+    // Makes room for a 32-bit length followed by |len| bytes of payload, so that writing both
+    // grows the buffer at most once. Errors are left for the writes themselves to report.
+    void                reserveLengthPrefixedWrite(size_t len);
     // Clear the Parcel and set the capacity to `desired`.
     // Doesn't reset the RPC session association.
     status_t            restartWrite(size_t desired);
@@ -21,42 +21,69 @@
 #include <stdint.h>
 #include <unistd.h>
 
-#include <utils/String16.h>
-#include <utils/Singleton.h>
-#include <utils/SortedVector.h>
+#include <string_view>
+#include <unordered_map>
+
 #include <binder/Common.h>
+#include <binder/IBinder.h>
+#include <utils/Mutex.h>
+#include <utils/Singleton.h>
+#include <utils/String16.h>
 
 namespace android {
 // ---------------------------------------------------------------------------
 
 /*
- * PermissionCache caches permission checks for a given uid.
+ * PermissionCache caches permission checks, both granted and denied, for a
+ * given uid.
  *
- * Currently the cache is not updated when there is a permission change,
- * for instance when an application is uninstalled.
+ * The cache is purged when the permission controller dies, and whenever
+ * purgeCache() is called. It is not otherwise updated when there is a
+ * permission change, for instance when an application is uninstalled.
  *
  * IMPORTANT: for the reason stated above, only system permissions are safe
- * to cache. This restriction may be lifted at a later time.
+ * to cache, unless the caller purges the cache on permission changes. This
+ * restriction may be lifted at a later time.
  *
  */
 
 class PermissionCache : Singleton<PermissionCache> {
-    struct Entry {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        // Number of times the cache was purged, including permission controller deaths.
+        uint64_t purges = 0;
+        size_t size = 0;
+    };
+
+private:
+    struct Key {
         String16    name;
         uid_t       uid;
-        bool        granted;
-        inline bool operator < (const Entry& e) const {
-            return (uid == e.uid) ? (name < e.name) : (uid < e.uid);
+        inline bool operator == (const Key& k) const {
+            return uid == k.uid && name == k.name;
         }
     };
-    mutable Mutex mLock;
-    // we pool all the permission names we see, as many permissions checks
-    // will have identical names
-    SortedVector< String16 > mPermissionNamesPool;
-    // this is our cache per say. it stores pooled names.
-    SortedVector< Entry > mCache;
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return std::hash<std::u16string_view>()(
+                           std::u16string_view(k.name.c_str(), k.name.size())) ^
+                    (static_cast<size_t>(k.uid) * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+    class ControllerDeathRecipient;
 
-    // free the whole cache, but keep the permission name pool
+    mutable Mutex mLock;
+    // this is our cache per say, keyed by (permission, uid).
+    std::unordered_map<Key, bool, KeyHash> mCache;
+    mutable Stats mStats;
+    // Set while a death notification is registered on the permission controller, or attempted.
+    bool mWatchingController = false;
+    sp<IBinder> mController;
+    sp<IBinder::DeathRecipient> mControllerDeathRecipient;
+
+    // free the whole cache
     void purge();
 
     status_t check(bool* granted,
@@ -64,6 +91,11 @@ class PermissionCache : Singleton<PermissionCache> {
 
     void cache(const String16& permission, uid_t uid, bool granted);
 
+    // Registers for permission controller deaths, which purge the cache. Binder calls, so must
+    // not be called with mLock held.
+    void watchController();
+    void onControllerDied();
+
 public:
     LIBBINDER_EXPORTED PermissionCache();
 
@@ -76,6 +108,8 @@ public:
                                                    uid_t uid);
 
     LIBBINDER_EXPORTED static void purgeCache();
+
+    LIBBINDER_EXPORTED static Stats getStats();
 };
 
 // ---------------------------------------------------------------------------
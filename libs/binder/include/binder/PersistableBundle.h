@@ -17,6 +17,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <set>
 #include <vector>
 
@@ -32,12 +33,17 @@ namespace os {
 /*
  * C++ implementation of PersistableBundle, a mapping from String values to
  * various types that can be saved to persistent and later restored.
+ *
+ * Like BaseBundle in Java, a PersistableBundle read from a Parcel keeps its
+ * serialized contents and only unparcels them when first accessed. A bundle
+ * that is written back unmodified forwards those bytes as they are.
  */
 class LIBBINDER_EXPORTED PersistableBundle : public Parcelable {
 public:
     PersistableBundle() = default;
     virtual ~PersistableBundle() = default;
-    PersistableBundle(const PersistableBundle& bundle) = default;
+    PersistableBundle(const PersistableBundle& bundle);
+    PersistableBundle& operator=(const PersistableBundle& bundle);
 
     status_t writeToParcel(Parcel* parcel) const override;
     status_t readFromParcel(const Parcel* parcel) override;
@@ -94,6 +100,8 @@ public:
     std::set<String16> getPersistableBundleKeys() const;
 
     friend bool operator==(const PersistableBundle& lhs, const PersistableBundle& rhs) {
+        lhs.unparcel();
+        rhs.unparcel();
         return (lhs.mBoolMap == rhs.mBoolMap && lhs.mIntMap == rhs.mIntMap &&
                 lhs.mLongMap == rhs.mLongMap && lhs.mDoubleMap == rhs.mDoubleMap &&
                 lhs.mStringMap == rhs.mStringMap && lhs.mBoolVectorMap == rhs.mBoolVectorMap &&
@@ -111,18 +119,33 @@ public:
 private:
     status_t writeToParcelInner(Parcel* parcel) const;
     status_t readFromParcelInner(const Parcel* parcel, size_t length);
-
-    std::map<String16, bool> mBoolMap;
-    std::map<String16, int32_t> mIntMap;
-    std::map<String16, int64_t> mLongMap;
-    std::map<String16, double> mDoubleMap;
-    std::map<String16, String16> mStringMap;
-    std::map<String16, std::vector<bool>> mBoolVectorMap;
-    std::map<String16, std::vector<int32_t>> mIntVectorMap;
-    std::map<String16, std::vector<int64_t>> mLongVectorMap;
-    std::map<String16, std::vector<double>> mDoubleVectorMap;
-    std::map<String16, std::vector<String16>> mStringVectorMap;
-    std::map<String16, PersistableBundle> mPersistableBundleMap;
+    status_t readEntriesFromParcel(const Parcel* parcel);
+    status_t readEntries(const uint8_t* data, size_t length);
+
+    // Returns the number of entries in the maps, without unparceling.
+    size_t countEntries() const;
+
+    // Unparcels mParcelledData into the maps below, if it is still pending.
+    void unparcel() const;
+    void unparcelLocked() const;
+
+    mutable std::mutex mLock;
+    // Serialized entries read by readFromParcel() that haven't been unparceled yet, and the
+    // magic number they were written with. Empty once unparceled.
+    mutable std::vector<uint8_t> mParcelledData;
+    mutable int32_t mParcelledMagic = 0;
+
+    mutable std::map<String16, bool> mBoolMap;
+    mutable std::map<String16, int32_t> mIntMap;
+    mutable std::map<String16, int64_t> mLongMap;
+    mutable std::map<String16, double> mDoubleMap;
+    mutable std::map<String16, String16> mStringMap;
+    mutable std::map<String16, std::vector<bool>> mBoolVectorMap;
+    mutable std::map<String16, std::vector<int32_t>> mIntVectorMap;
+    mutable std::map<String16, std::vector<int64_t>> mLongVectorMap;
+    mutable std::map<String16, std::vector<double>> mDoubleVectorMap;
+    mutable std::map<String16, std::vector<String16>> mStringVectorMap;
+    mutable std::map<String16, PersistableBundle> mPersistableBundleMap;
 };
 
 }  // namespace os
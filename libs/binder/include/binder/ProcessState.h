@@ -63,6 +63,33 @@ public:
     // threads started by 'startThreadPool' or 'joinRpcThreadpool'.
     LIBBINDER_EXPORTED status_t setThreadPoolMaxThreadCount(size_t maxThreads);
 
+    // Lets the kernel-started part of the threadpool grow past the count set
+    // by setThreadPoolMaxThreadCount, one thread at a time and up to
+    // 'maxThreads', whenever every pool thread has stayed busy for a sustained
+    // period. Like the base count, the grown count is never decreased: the
+    // driver has no way to retire a looper that is blocked waiting for work.
+    //
+    // Same restrictions as setThreadPoolMaxThreadCount; 'maxThreads' must not
+    // be smaller than the current count.
+    LIBBINDER_EXPORTED status_t setThreadPoolAdaptiveMaxThreadCount(size_t maxThreads);
+
+    struct ThreadPoolStats {
+        // Current and adaptive limit on kernel-started threads.
+        size_t maxThreads;
+        size_t adaptiveMaxThreads;
+        // Threads currently in the pool, and how many of them are executing a command.
+        size_t currentThreads;
+        size_t executingThreads;
+        size_t peakExecutingThreads;
+        // Commands executed by pool threads, and the total time spent executing them.
+        uint64_t commandCount;
+        int64_t busyTimeNs;
+        // Number of times all kernel-started threads were busy, and for how long in total.
+        uint64_t starvationCount;
+        int64_t starvationTimeMs;
+    };
+    LIBBINDER_EXPORTED ThreadPoolStats getThreadPoolStats() const;
+
     // Libraries should not call this, as processes should configure
     // threadpools themselves. Should be called in the main function
     // directly before any code executes or joins the threadpool.
@@ -158,6 +185,9 @@ private:
 
     handle_entry* lookupHandleLocked(int32_t handle);
 
+    // Called with mThreadCountLock held when a starvation period ends.
+    void onThreadPoolStarvedLocked(int64_t starvationTimeMs);
+
     String8 mDriverName;
     int mDriverFD;
     void* mVMStart;
@@ -178,6 +208,14 @@ private:
     size_t mKernelStartedThreads;
     // Time when thread pool was emptied
     int64_t mStarvationStartTimeMs;
+    // Ceiling mMaxThreads may be grown to under starvation, see setThreadPoolAdaptiveMaxThreadCount.
+    size_t mAdaptiveMaxThreads;
+    // Counters reported by getThreadPoolStats.
+    size_t mPeakExecutingThreads;
+    uint64_t mCommandCount;
+    int64_t mBusyTimeNs;
+    uint64_t mStarvationCount;
+    int64_t mStarvationTimeMs;
 
     mutable std::mutex mLock; // protects everything below.
 
@@ -43,6 +43,14 @@ public:
 
     [[nodiscard]] LIBBINDER_EXPORTED status_t dumpToFile(const binder::unique_fd& fd) const;
 
+    // Appends the transaction described by the arguments to buffer, in the same format as
+    // dumpToFile. Unlike fromDetails followed by dumpToFile, the Parcels are copied only once,
+    // directly into buffer, so that the record can be written later with a single write.
+    [[nodiscard]] LIBBINDER_EXPORTED static status_t serializeDetails(
+            std::vector<uint8_t>* buffer, const String16& interfaceName, uint32_t code,
+            uint32_t flags, timespec timestamp, const Parcel& data, const Parcel& reply,
+            status_t err);
+
     LIBBINDER_EXPORTED const std::string& getInterfaceName() const;
     LIBBINDER_EXPORTED uint32_t getCode() const;
     LIBBINDER_EXPORTED uint32_t getFlags() const;
@@ -56,8 +64,16 @@ public:
 private:
     RecordedTransaction() = default;
 
-    android::status_t writeChunk(const binder::borrowed_fd, uint32_t chunkType, size_t byteCount,
-                                 const uint8_t* data) const;
+    struct TransactionHeader;
+
+    static android::status_t appendChunk(std::vector<uint8_t>* buffer, uint32_t chunkType,
+                                         size_t byteCount, const uint8_t* data);
+    static android::status_t serialize(std::vector<uint8_t>* buffer,
+                                       const TransactionHeader& header,
+                                       const std::string& interfaceName, const uint8_t* sentData,
+                                       size_t sentDataSize, const uint8_t* replyData,
+                                       size_t replyDataSize, const uint64_t* sentObjects,
+                                       size_t sentObjectCount);
 
 #pragma clang diagnostic push
 #pragma clang diagnostic error "-Wpadded"
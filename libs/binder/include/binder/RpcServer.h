@@ -137,6 +137,26 @@ public:
     LIBBINDER_EXPORTED void setMaxThreads(size_t threads);
     LIBBINDER_EXPORTED size_t getMaxThreads();
 
+    /**
+     * Serve incoming connections from a fixed pool of worker threads, instead
+     * of dedicating a thread to each connection. Idle connections are polled
+     * by a single dispatcher thread, and a worker is only assigned to a
+     * connection while it executes the commands received on it, including
+     * any nested transactions that they make. This allows a server to keep
+     * many mostly idle sessions without one thread per connection.
+     *
+     * A command which waits on another connection (e.g. a synchronous call
+     * into a client which calls back into this server on another connection)
+     * holds its worker in the meantime, so the pool must be large enough for
+     * the number of such calls which may be in flight at once.
+     *
+     * This must be called before join() or start(). If this is not specified,
+     * or 0, each connection gets its own thread. Not supported on
+     * single-threaded builds.
+     */
+    LIBBINDER_EXPORTED void setEventLoopThreads(size_t threads);
+    LIBBINDER_EXPORTED size_t getEventLoopThreads();
+
     /**
      * By default, the latest protocol version which is supported by a client is
      * used. However, this can be used in order to prevent newer protocol
@@ -262,13 +282,18 @@ private:
             sp<RpcServer>&& server, RpcTransportFd clientFd,
             std::array<uint8_t, kRpcAddressSize> addr, size_t addrLen,
             std::function<void(sp<RpcSession>&&, RpcSession::PreJoinSetupResult&&)>&& joinFn);
+    static void joinEventLoop(binder::borrowed_fd clientFd, sp<RpcSession>&& session,
+                              RpcSession::PreJoinSetupResult&& setupResult);
     static status_t acceptSocketConnection(const RpcServer& server, RpcTransportFd* out);
     static status_t recvmsgSocketConnection(const RpcServer& server, RpcTransportFd* out);
 
     [[nodiscard]] status_t setupSocketServer(const RpcSocketAddress& address);
 
+    class EventLoop;
+
     const std::unique_ptr<RpcTransportCtx> mCtx;
     size_t mMaxThreads = 1;
+    size_t mEventLoopThreads = 0;
     std::optional<uint32_t> mProtocolVersion;
     // A mode is supported if the N'th bit is on, where N is the mode enum's value.
     std::bitset<8> mSupportedFileDescriptorTransportModes = std::bitset<8>().set(
@@ -287,6 +312,7 @@ private:
     std::function<void(binder::borrowed_fd)> mServerSocketModifier;
     std::map<std::vector<uint8_t>, sp<RpcSession>> mSessions;
     std::unique_ptr<FdTrigger> mShutdownTrigger;
+    std::unique_ptr<EventLoop> mEventLoop;
     RpcConditionVariable mShutdownCv;
     std::function<status_t(const RpcServer& server, RpcTransportFd* out)> mAcceptFn;
 };
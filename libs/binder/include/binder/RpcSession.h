@@ -23,6 +23,7 @@
 #include <utils/Errors.h>
 #include <utils/RefBase.h>
 
+#include <functional>
 #include <map>
 #include <optional>
 #include <vector>
@@ -47,6 +48,11 @@ constexpr uint32_t RPC_WIRE_PROTOCOL_VERSION = 1;
 // * RpcWireTransaction and RpcWireReplyV1 include the parcel data size.
 constexpr uint32_t RPC_WIRE_PROTOCOL_VERSION_RPC_HEADER_FEATURE_EXPLICIT_PARCEL_SIZE = 1;
 
+// Starting with this version:
+//
+// * Interface tokens may be sent as a 64-bit hash of the descriptor instead of the full string.
+constexpr uint32_t RPC_WIRE_PROTOCOL_VERSION_PARCEL_FEATURE_INTERFACE_TOKEN_HASH = 2;
+
 /**
  * This represents a session (group of connections) between a client
  * and a server. Multiple connections are needed for multiple parallel "binder"
@@ -91,6 +97,11 @@ public:
      * maximum number of connections to 10, and the server requests 1, then only 1 will be
      * created. This API is used to limit the amount of resources a server can request you
      * create.
+     *
+     * Each connection carries one transaction (and its nested transactions) at a time, so the
+     * number of connections also bounds how many calls can be outstanding at once. Further calls
+     * wait until a connection is released. To allow more concurrent calls, raise both this and
+     * RpcServer::setMaxThreads on the server.
      */
     LIBBINDER_EXPORTED void setMaxOutgoingConnections(size_t connections);
     LIBBINDER_EXPORTED size_t getMaxOutgoingThreads();
@@ -197,6 +208,37 @@ public:
                                                        const Parcel& data, Parcel* reply,
                                                        uint32_t flags);
 
+    /**
+     * Called with the status of a transaction started by transactAsync. When
+     * this is OK, the reply has been read into the 'reply' parcel.
+     */
+    using TransactCallback = std::function<void(status_t status)>;
+
+    /**
+     * Sends a synchronous transaction, but returns as soon as it is sent,
+     * instead of blocking the calling thread until the reply arrives. The
+     * reply is read into 'reply', which must be kept alive until 'callback'
+     * is called. This happens on a thread of the session which polls all of
+     * the connections waiting for a reply, so many calls may be in flight
+     * without a thread waiting on each of them. 'callback' should return
+     * quickly, since it delays the other replies.
+     *
+     * Each call still occupies an outgoing connection until its reply
+     * arrives (see setMaxOutgoingConnections), and this blocks while none is
+     * available. Nested transactions which the other side makes before it
+     * replies are executed on the polling thread. If the calling thread is
+     * already using a connection (e.g. in a nested transaction), the call is
+     * made on it synchronously, and 'callback' is called before this returns.
+     *
+     * If this returns an error, nothing was sent and 'callback' is not
+     * called. Oneway transactions are not supported (use transact), and
+     * neither are single-threaded builds.
+     */
+    [[nodiscard]] LIBBINDER_EXPORTED status_t transactAsync(const sp<IBinder>& binder,
+                                                            uint32_t code, const Parcel& data,
+                                                            Parcel* reply, uint32_t flags,
+                                                            TransactCallback&& callback);
+
     /**
      * Generally, you should not call this, unless you are testing error
      * conditions, as this is called automatically by BpBinders when they are
@@ -285,6 +327,20 @@ private:
     // join on thread passed to preJoinThreadOwnership
     static void join(sp<RpcSession>&& session, PreJoinSetupResult&& result);
 
+    // Instead of join, RpcServer's event loop may take over a connection after
+    // a successful preJoinSetup. This gives up the thread passed to
+    // preJoinThreadOwnership, which must be the calling thread, and leaves the
+    // connection unassigned until serveIncomingCommands is called on it.
+    void releaseIncomingConnectionThread(const sp<RpcConnection>& connection);
+    // Executes the commands which are available on an incoming connection on
+    // the calling thread, which owns the connection in the meantime, so that
+    // nested transactions work as they do under join. Returns false if the
+    // connection was closed, in which case it has been removed from the
+    // session.
+    [[nodiscard]] bool serveIncomingCommands(const sp<RpcConnection>& connection);
+    // Runs fn attached to the JVM, as join does, if the Android Runtime exists.
+    static void runAttachedToJava(const std::function<void()>& fn);
+
     [[nodiscard]] status_t setupClient(
             const std::function<status_t(const std::vector<uint8_t>& sessionId, bool incoming)>&
                     connectAndInit);
@@ -328,6 +384,12 @@ private:
 
         ~ExclusiveConnection();
         const sp<RpcConnection>& get() { return mConnection; }
+        bool reentrant() const { return mReentrant; }
+
+        // Gives up the exclusive use of the connection by this thread, but
+        // keeps it from being used by any other thread until the connection is
+        // handed to one (see ReplyPoller), or released with clearConnectionTid.
+        sp<RpcConnection> handOff();
 
     private:
         static void findConnection(uint64_t tid, sp<RpcConnection>* exclusive,
@@ -374,6 +436,8 @@ private:
 
     std::unique_ptr<RpcState> mRpcBinderState;
 
+    class ReplyPoller;
+
     RpcMutex mMutex; // for all below
 
     bool mStartedSetup = false;
@@ -386,6 +450,9 @@ private:
 
     std::unique_ptr<RpcTransport> mBootstrapTransport;
 
+    // created by the first transactAsync call
+    std::unique_ptr<ReplyPoller> mReplyPoller;
+
     struct ThreadState {
         size_t mWaitingThreads = 0;
         // hint index into clients, ++ when sending an async transaction
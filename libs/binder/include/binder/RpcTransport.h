@@ -104,6 +104,13 @@ public:
      */
     [[nodiscard]] virtual bool isWaiting() = 0;
 
+    /**
+     * The FD underlying this transport, so that it can be polled together with
+     * other FDs. Data which the transport has already buffered doesn't make
+     * the FD readable, so pollRead should be checked before waiting on it.
+     */
+    [[nodiscard]] virtual binder::borrowed_fd pollFd() = 0;
+
 private:
     // limit the classes which can implement RpcTransport. Being able to change this
     // interface is important to allow development of RPC binder. In the past, we
@@ -76,6 +76,7 @@ public:
     };
 
     ActivityManager();
+    ~ActivityManager();
 
     int openContentUri(const String16& stringUri);
     status_t registerUidObserver(const sp<IUidObserver>& observer,
@@ -93,15 +94,31 @@ public:
                                    int32_t uid);
     bool isUidActive(const uid_t uid, const String16& callingPackage);
     int getUidProcessState(const uid_t uid, const String16& callingPackage);
+    // Like getUidProcessState, for each of uids. Once the cache is enabled, only the uids which
+    // are not cached are queried from the activity manager.
+    void getUidProcessStates(size_t length, /*in*/ const uid_t* uids, /*out*/ int32_t* states,
+                             const String16& callingPackage);
+    // Caches the results of getUidProcessState(s) in this process. The cache registers a uid
+    // observer on behalf of callingPackage, so that it is updated as soon as a uid changes state
+    // instead of calling into the activity manager for each query. This costs a oneway call to
+    // this process for each uid state change in the system, so it is only worth it for services
+    // which query process states frequently.
+    status_t enableUidProcessStateCache(const String16& callingPackage);
     status_t checkPermission(const String16& permission, const pid_t pid, const uid_t uid, int32_t* outResult);
 
     status_t linkToDeath(const sp<IBinder::DeathRecipient>& recipient);
     status_t unlinkToDeath(const sp<IBinder::DeathRecipient>& recipient);
 
 private:
+    class UidStateCache;
+
     Mutex mLock;
     sp<IActivityManager> mService;
+    sp<UidStateCache> mUidStateCache;
     sp<IActivityManager> getService();
+    // Returns the uid state cache if it is enabled, registering its observer again after the
+    // activity manager restarted.
+    sp<UidStateCache> getUidStateCache();
 };
 
 
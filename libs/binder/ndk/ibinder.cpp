@@ -18,6 +18,7 @@
 #include <android/binder_ibinder_platform.h>
 #include <android/binder_stability.h>
 #include <android/binder_status.h>
+#include <binder/BpBinder.h>
 #include <binder/IPCThreadState.h>
 #include <binder/IResultReceiver.h>
 #if __has_include(<private/android_filesystem_config.h>)
@@ -31,6 +32,7 @@
 
 using DeathRecipient = ::android::IBinder::DeathRecipient;
 
+using ::android::BpBinder;
 using ::android::IBinder;
 using ::android::IResultReceiver;
 using ::android::Parcel;
@@ -781,6 +783,62 @@ binder_status_t AIBinder_transact(AIBinder* binder, transaction_code_t code, APa
     return ret;
 }
 
+binder_status_t AIBinder_transactAsync(AIBinder* binder, transaction_code_t code, AParcel** in,
+                                       binder_flags_t flags,
+                                       AIBinder_onTransactComplete onComplete, void* cookie) {
+    if (!isUserCommand(code)) {
+        ALOGE("%s: Only user-defined transactions can be made from the NDK, but requested: %d",
+              __func__, code);
+        return STATUS_UNKNOWN_TRANSACTION;
+    }
+
+    constexpr binder_flags_t kAllFlags = FLAG_PRIVATE_VENDOR | FLAG_CLEAR_BUF;
+    if ((flags & ~kAllFlags) != 0) {
+        ALOGE("%s: Unrecognized or oneway flags sent: %d", __func__, flags);
+        return STATUS_BAD_VALUE;
+    }
+
+    if (binder == nullptr || in == nullptr || *in == nullptr || onComplete == nullptr) {
+        ALOGE("%s: requires non-null parameters binder (%p), in (%p), and onComplete.", __func__,
+              binder, in);
+        return STATUS_UNEXPECTED_NULL;
+    }
+
+    if ((*in)->getBinder() != binder) {
+        ALOGE("%s: parcel is associated with binder object %p but called with %p", __func__, binder,
+              (*in)->getBinder());
+        return STATUS_BAD_VALUE;
+    }
+
+    BpBinder* proxy = binder->getBinder()->remoteBinder();
+    if (proxy == nullptr || !proxy->isRpcBinder()) {
+        return STATUS_INVALID_OPERATION;
+    }
+
+    // From here on, this owns the input, and onComplete is always called.
+    std::unique_ptr<AParcel> forIn(*in);
+    *in = nullptr;
+
+    // The reply refers to the binder, so keep it alive until the reply is delivered.
+    sp<AIBinder> keepBinder = binder;
+    AParcel* out = new AParcel(binder);
+    status_t status = proxy->transactAsync(code, *forIn->get(), out->get(), flags,
+                                           [keepBinder, out, onComplete, cookie](status_t status) {
+                                               binder_status_t ret = PruneStatusT(status);
+                                               if (ret != STATUS_OK) {
+                                                   delete out;
+                                                   onComplete(cookie, ret, nullptr);
+                                                   return;
+                                               }
+                                               onComplete(cookie, ret, out);
+                                           });
+    if (status != ::android::OK) {
+        delete out;
+        onComplete(cookie, PruneStatusT(status), nullptr);
+    }
+    return STATUS_OK;
+}
+
 AIBinder_DeathRecipient* AIBinder_DeathRecipient_new(
         AIBinder_DeathRecipient_onBinderDied onBinderDied) {
     if (onBinderDied == nullptr) {
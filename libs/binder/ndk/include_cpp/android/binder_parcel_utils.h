@@ -167,6 +167,32 @@ static inline bool AParcel_nullableStdArrayExternalAllocator(void* arrayData, in
     return true;
 }
 
+/**
+ * A caller-owned buffer which a primitive array is read into. See AParcel_readArrayIntoBuffer.
+ */
+template <typename T>
+struct AParcel_ArrayBuffer {
+    T* data;
+    size_t capacity;
+    size_t length;
+};
+
+/**
+ * This checks the length against the capacity of an AParcel_ArrayBuffer and retrieves its data. No
+ * allocation required.
+ */
+template <typename T>
+static inline bool AParcel_arrayBufferAllocator(void* arrayData, int32_t length, T** outBuffer) {
+    if (length < 0) return false;
+
+    AParcel_ArrayBuffer<T>* buffer = static_cast<AParcel_ArrayBuffer<T>*>(arrayData);
+    if (static_cast<size_t>(length) > buffer->capacity) return false;
+
+    buffer->length = static_cast<size_t>(length);
+    *outBuffer = buffer->data;
+    return true;
+}
+
 /**
  * This retrieves and allocates a vector to size 'length' and returns the underlying buffer.
  */
@@ -195,7 +221,9 @@ static inline bool AParcel_nullableStdVectorAllocator(void* vectorData, int32_t
         return true;
     }
 
-    *vec = std::optional<std::vector<T>>(std::vector<T>{});
+    // Like AParcel_stdVectorAllocator, keep an existing vector and its elements so that their
+    // storage is reused.
+    if (!*vec) vec->emplace();
 
     if (static_cast<size_t>(length) > (*vec)->max_size()) return false;
     (*vec)->resize(static_cast<size_t>(length));
@@ -246,7 +274,9 @@ static inline bool AParcel_nullableStdVectorExternalAllocator(void* vectorData,
         return true;
     }
 
-    *vec = std::optional<std::vector<T>>(std::vector<T>{});
+    // Like AParcel_stdVectorAllocator, keep an existing vector and its elements so that their
+    // storage is reused.
+    if (!*vec) vec->emplace();
 
     if (static_cast<size_t>(length) > (*vec)->max_size()) return false;
     (*vec)->resize(static_cast<size_t>(length));
@@ -386,6 +416,8 @@ static inline binder_status_t AParcel_readRequiredParcelFileDescriptor(const APa
 /**
  * Allocates a std::string to length and returns the underlying buffer. For use with
  * AParcel_readString. See use below in AParcel_readString(const AParcel*, std::string*).
+ *
+ * The existing capacity of the string is reused.
  */
 static inline bool AParcel_stdStringAllocator(void* stringData, int32_t length, char** buffer) {
     if (length <= 0) return false;
@@ -400,6 +432,9 @@ static inline bool AParcel_stdStringAllocator(void* stringData, int32_t length,
  * Allocates a string in a std::optional<std::string> to size 'length' (or to std::nullopt when
  * length is -1) and returns the underlying buffer. For use with AParcel_readString. See use below
  * in AParcel_readString(const AParcel*, std::optional<std::string>*).
+ *
+ * A string which is already present is resized in place, so reading into the same object again
+ * (for instance, every element of a reused vector) does not allocate unless the string grows.
  */
 static inline bool AParcel_nullableStdStringAllocator(void* stringData, int32_t length,
                                                       char** buffer) {
@@ -412,7 +447,7 @@ static inline bool AParcel_nullableStdStringAllocator(void* stringData, int32_t
         return true;
     }
 
-    *str = std::optional<std::string>(std::string{});
+    if (!*str) str->emplace();
     (*str)->resize(static_cast<size_t>(length) - 1);
     *buffer = &(**str)[0];
     return true;
@@ -1546,6 +1581,45 @@ static inline binder_status_t AParcel_readFixedArray(const AParcel* parcel, std:
     }
 }
 
+/**
+ * Reads an array of up to 'capacity' elements of T directly into 'data', which is owned by the
+ * caller, and sets 'outLength' to the number of elements read. Unlike AParcel_readVector, nothing
+ * is allocated, so a buffer can be reused across many reads. T must be one of the primitive types
+ * which are sent contiguously.
+ *
+ * Fails with STATUS_NO_MEMORY if the array is longer than 'capacity', and with
+ * STATUS_UNEXPECTED_NULL if the array is null.
+ */
+template <typename T>
+static inline binder_status_t AParcel_readArrayIntoBuffer(const AParcel* parcel, T* data,
+                                                          size_t capacity, size_t* outLength) {
+    AParcel_ArrayBuffer<T> buffer{data, capacity, 0};
+    void* arrayData = static_cast<void*>(&buffer);
+    binder_status_t status;
+    if constexpr (std::is_same_v<T, int8_t>) {
+        status = AParcel_readByteArray(parcel, arrayData, &AParcel_arrayBufferAllocator<T>);
+    } else if constexpr (std::is_same_v<T, char16_t>) {
+        status = AParcel_readCharArray(parcel, arrayData, &AParcel_arrayBufferAllocator<T>);
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+        status = AParcel_readInt32Array(parcel, arrayData, &AParcel_arrayBufferAllocator<T>);
+    } else if constexpr (std::is_same_v<T, uint32_t>) {
+        status = AParcel_readUint32Array(parcel, arrayData, &AParcel_arrayBufferAllocator<T>);
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+        status = AParcel_readInt64Array(parcel, arrayData, &AParcel_arrayBufferAllocator<T>);
+    } else if constexpr (std::is_same_v<T, uint64_t>) {
+        status = AParcel_readUint64Array(parcel, arrayData, &AParcel_arrayBufferAllocator<T>);
+    } else if constexpr (std::is_same_v<T, float>) {
+        status = AParcel_readFloatArray(parcel, arrayData, &AParcel_arrayBufferAllocator<T>);
+    } else if constexpr (std::is_same_v<T, double>) {
+        status = AParcel_readDoubleArray(parcel, arrayData, &AParcel_arrayBufferAllocator<T>);
+    } else {
+        static_assert(dependent_false_v<T>,
+                      "AParcel_readArrayIntoBuffer: only contiguous primitive types are supported");
+    }
+    if (status == STATUS_OK) *outLength = buffer.length;
+    return status;
+}
+
 /**
  * Reads a fixed-size array of T.
  */
@@ -80,4 +80,40 @@ void AIBinder_setMinSchedulerPolicy(AIBinder* binder, int policy, int priority)
  */
 void AIBinder_setInheritRt(AIBinder* binder, bool inheritRt) __INTRODUCED_IN(33);
 
+/**
+ * Called once a transaction started by AIBinder_transactAsync completes.
+ *
+ * \param cookie the cookie passed to AIBinder_transactAsync.
+ * \param status the result of the transaction, as AIBinder_transact would return it.
+ * \param out the reply, which the callee owns and must delete with AParcel_delete. This is null
+ * unless status is STATUS_OK.
+ */
+typedef void (*AIBinder_onTransactComplete)(void* cookie, binder_status_t status, AParcel* out);
+
+/**
+ * Like AIBinder_transact, but returns once the transaction is sent, instead of blocking the calling
+ * thread until the reply arrives. The reply is then passed to onComplete, generally on another
+ * thread. This allows many transactions to be in flight without a thread waiting for each of them.
+ *
+ * This is only supported for binders which are hosted over RPC binder sessions. For other binders,
+ * this returns STATUS_INVALID_OPERATION and AIBinder_transact should be used instead. Oneway
+ * transactions are not supported.
+ *
+ * \param binder the binder object to transact on.
+ * \param code the implementation-specific code representing which transaction should be taken.
+ * \param in the implementation-specific input data to this transaction. Only if this returns
+ * STATUS_OK, ownership of this parcel is taken and it is set to null.
+ * \param flags possible flags to alter the way in which the transaction is conducted.
+ * \param onComplete called exactly once with the reply if this returns STATUS_OK. It may be called
+ * before this returns (e.g. if the transaction could not be sent).
+ * \param cookie passed to onComplete.
+ *
+ * \return STATUS_OK if onComplete is going to be called, or an error if the arguments are invalid
+ * or the binder doesn't support this, in which case nothing was sent.
+ */
+binder_status_t AIBinder_transactAsync(AIBinder* binder, transaction_code_t code, AParcel** in,
+                                       binder_flags_t flags,
+                                       AIBinder_onTransactComplete onComplete, void* cookie)
+        __INTRODUCED_IN(36);
+
 __END_DECLS
@@ -1117,6 +1117,65 @@ TEST(NdkBinder_ScopedAResource, Release) {
     EXPECT_EQ(deleteCount, 0);
 }
 
+TEST(NdkBinder_Parcel, CharAndBoolArraysRoundTrip) {
+    ndk::ScopedAParcel parcel(AParcel_create());
+    std::vector<char16_t> chars = {u'a', u'\u00e9', u'\uffff', 0};
+    std::vector<bool> bools = {true, false, false, true, true};
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_writeVector(parcel.get(), chars));
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_writeVector(parcel.get(), bools));
+    // Elements are still sent as int32_t each, as they were before the bulk paths.
+    EXPECT_EQ(static_cast<int32_t>(2 * sizeof(int32_t) + (chars.size() + bools.size()) * 4),
+              AParcel_getDataSize(parcel.get()));
+
+    ASSERT_EQ(STATUS_OK, AParcel_setDataPosition(parcel.get(), 0));
+    std::vector<char16_t> readChars;
+    std::vector<bool> readBools;
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_readVector(parcel.get(), &readChars));
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_readVector(parcel.get(), &readBools));
+    EXPECT_EQ(chars, readChars);
+    EXPECT_EQ(bools, readBools);
+}
+
+TEST(NdkBinder_Parcel, ReadArrayIntoBuffer) {
+    ndk::ScopedAParcel parcel(AParcel_create());
+    std::vector<int64_t> values = {1, -2, 3};
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_writeVector(parcel.get(), values));
+    ASSERT_EQ(STATUS_OK,
+              ndk::AParcel_writeVector(parcel.get(), std::optional<std::vector<int64_t>>()));
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_writeVector(parcel.get(), values));
+
+    ASSERT_EQ(STATUS_OK, AParcel_setDataPosition(parcel.get(), 0));
+    int64_t buffer[4] = {};
+    size_t length = 0;
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_readArrayIntoBuffer(parcel.get(), buffer, 4, &length));
+    ASSERT_EQ(values.size(), length);
+    EXPECT_EQ(values, std::vector<int64_t>(buffer, buffer + length));
+
+    EXPECT_EQ(STATUS_UNEXPECTED_NULL,
+              ndk::AParcel_readArrayIntoBuffer(parcel.get(), buffer, 4, &length));
+    EXPECT_EQ(STATUS_NO_MEMORY, ndk::AParcel_readArrayIntoBuffer(parcel.get(), buffer, 2, &length));
+    EXPECT_EQ(values.size(), length);
+}
+
+TEST(NdkBinder_Parcel, ReadStringVectorReusesElements) {
+    ndk::ScopedAParcel parcel(AParcel_create());
+    std::optional<std::vector<std::optional<std::string>>> strings =
+            std::vector<std::optional<std::string>>{"a fairly long string, longer than SSO",
+                                                    std::nullopt, "short"};
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_writeVector(parcel.get(), strings));
+
+    std::optional<std::vector<std::optional<std::string>>> read;
+    ASSERT_EQ(STATUS_OK, AParcel_setDataPosition(parcel.get(), 0));
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_readVector(parcel.get(), &read));
+    EXPECT_EQ(strings, read);
+
+    const char* firstData = read->at(0)->data();
+    ASSERT_EQ(STATUS_OK, AParcel_setDataPosition(parcel.get(), 0));
+    ASSERT_EQ(STATUS_OK, ndk::AParcel_readVector(parcel.get(), &read));
+    EXPECT_EQ(strings, read);
+    EXPECT_EQ(firstData, read->at(0)->data());
+}
+
 int main(int argc, char* argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
 
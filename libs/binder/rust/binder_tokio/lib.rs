@@ -29,6 +29,10 @@
 //! [`Tokio`]: crate::Tokio
 
 use binder::binder_impl::BinderAsyncRuntime;
+#[cfg(not(android_vndk))]
+use binder::binder_impl::{IBinderInternal, Parcel, TransactionCode, TransactionFlags};
+#[cfg(not(android_vndk))]
+use binder::SpIBinder;
 use binder::{BinderAsyncPool, BoxFuture, FromIBinder, StatusCode, Strong};
 use std::future::Future;
 
@@ -107,6 +111,49 @@ pub async fn wait_for_interface<T: FromIBinder + ?Sized + 'static>(
     }
 }
 
+/// Sends a transaction to `remote` and waits for its reply.
+///
+/// If `remote` is hosted over an RPC binder session, no thread is occupied
+/// while the reply is outstanding: the reply is delivered to this future by
+/// the session. Other binders are transacted on the `spawn_blocking` pool, as
+/// with [`Tokio`].
+#[cfg(not(android_vndk))]
+pub async fn transact(
+    remote: SpIBinder,
+    code: TransactionCode,
+    data: Parcel,
+    flags: TransactionFlags,
+) -> Result<Parcel, StatusCode> {
+    let (sender, receiver) = tokio::sync::oneshot::channel();
+    let on_complete = move |reply| {
+        // This only fails if the future was dropped, so nobody wants the reply.
+        let _ = sender.send(reply);
+    };
+    let data = match remote.submit_transact_async(code, data, flags, on_complete) {
+        // The sender is only dropped without sending if the process is torn down.
+        Ok(()) => return receiver.await.unwrap_or(Err(StatusCode::DEAD_OBJECT)),
+        Err((StatusCode::INVALID_OPERATION, data)) => data,
+        Err((e, _)) => return Err(e),
+    };
+
+    if binder::is_handling_transaction() {
+        // See comment in the BinderAsyncPool impl.
+        return remote.submit_transact(code, data, flags);
+    }
+
+    let res = tokio::task::spawn_blocking(move || remote.submit_transact(code, data, flags)).await;
+
+    // The `is_panic` branch is not actually reachable in Android as we compile
+    // with `panic = abort`.
+    match res {
+        Ok(Ok(reply)) => Ok(reply),
+        Ok(Err(err)) => Err(err),
+        Err(e) if e.is_panic() => std::panic::resume_unwind(e.into_panic()),
+        Err(e) if e.is_cancelled() => Err(StatusCode::FAILED_TRANSACTION),
+        Err(_) => Err(StatusCode::UNKNOWN_ERROR),
+    }
+}
+
 /// Use the Tokio `spawn_blocking` pool with AIDL.
 pub enum Tokio {}
 
@@ -126,6 +126,86 @@ impl SpIBinder {
     pub fn downgrade(&mut self) -> WpIBinder {
         WpIBinder::new(self)
     }
+
+    /// Sends a transaction without blocking the calling thread until its reply
+    /// arrives. Instead, `on_complete` is called with the reply, generally on
+    /// another thread.
+    ///
+    /// This is only supported for binders hosted over RPC binder sessions. On
+    /// error, nothing was sent and `on_complete` is dropped without being
+    /// called. `data` is then handed back, so that a binder which returned
+    /// `StatusCode::INVALID_OPERATION` can be sent the same transaction with
+    /// `submit_transact` instead.
+    #[cfg(not(android_vndk))]
+    pub fn submit_transact_async<F>(
+        &self,
+        code: TransactionCode,
+        data: Parcel,
+        flags: TransactionFlags,
+        on_complete: F,
+    ) -> std::result::Result<(), (StatusCode, Parcel)>
+    where
+        F: FnOnce(Result<Parcel>) + Send + 'static,
+    {
+        let cookie = Box::into_raw(Box::new(on_complete));
+        let mut input = data.into_raw();
+        // Safety: `SpIBinder` guarantees that `self` always contains a valid
+        // pointer to an `AIBinder`, and it is safe to cast it to mutable for the
+        // same reasons as in `submit_transact`. `input` is a valid, owned
+        // `AParcel` pointer, and `cookie` a valid pointer to `F`, which
+        // `on_transact_complete::<F>` expects.
+        //
+        // On success, this call takes ownership of `input` and of `cookie`
+        // (which is passed back to `on_transact_complete` exactly once). On
+        // error, it takes neither.
+        let status = unsafe {
+            sys::AIBinder_transactAsync(
+                self.as_native() as *mut sys::AIBinder,
+                code,
+                &mut input,
+                flags,
+                Some(on_transact_complete::<F>),
+                cookie.cast(),
+            )
+        };
+        if let Err(e) = status_result(status) {
+            // Safety: On error, `AIBinder_transactAsync` neither calls nor keeps
+            // `cookie`, which still points to the leaked `F`.
+            drop(unsafe { Box::from_raw(cookie) });
+            // Safety: On error, `input` is still the valid, owned `AParcel`
+            // pointer taken from `data`.
+            let data = unsafe { Parcel::from_raw(input) }
+                .expect("AIBinder_transactAsync failed but took its input");
+            return Err((e, data));
+        }
+        Ok(())
+    }
+}
+
+/// Completes a transaction sent by `SpIBinder::submit_transact_async`.
+///
+/// # Safety
+///
+/// `cookie` must be the pointer to `F` leaked by `submit_transact_async`, and
+/// this must be called at most once for it. `reply` must be null or a valid,
+/// owned `AParcel` pointer.
+#[cfg(not(android_vndk))]
+unsafe extern "C" fn on_transact_complete<F>(
+    cookie: *mut c_void,
+    status: sys::binder_status_t,
+    reply: *mut sys::AParcel,
+) where
+    F: FnOnce(Result<Parcel>) + Send + 'static,
+{
+    // Safety: Guaranteed by our caller, `cookie` comes from `Box::into_raw` on
+    // a `Box<F>`, and we are the only ones to reclaim it.
+    let on_complete = unsafe { Box::from_raw(cookie.cast::<F>()) };
+    let reply = status_result(status).and_then(|()| {
+        // Safety: Guaranteed by our caller, `reply` is null or a valid, owned
+        // `AParcel` pointer, so we can take ownership of it.
+        unsafe { Parcel::from_raw(reply) }.ok_or(StatusCode::UNEXPECTED_NULL)
+    });
+    on_complete(reply);
 }
 
 pub mod unstable_api {
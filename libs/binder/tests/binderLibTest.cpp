@@ -533,12 +533,70 @@ TEST_F(BinderLibTest, NopTransaction) {
                 StatusEq(NO_ERROR));
 }
 
+TEST_F(BinderLibTest, CheckServiceCachedWhileHeld) {
+    sp<IServiceManager> sm = defaultServiceManager();
+    // m_server keeps the service strongly referenced, so the first lookup
+    // populates the cache and the second is answered from it.
+    sp<IBinder> first = sm->checkService(binderLibTestServiceName);
+    ASSERT_EQ(m_server, first);
+
+    IServiceManager::ServiceCacheStats before = getServiceCacheStats();
+    sp<IBinder> second = sm->checkService(binderLibTestServiceName);
+    IServiceManager::ServiceCacheStats after = getServiceCacheStats();
+    EXPECT_EQ(m_server, second);
+    EXPECT_EQ(before.hits + 1, after.hits);
+    EXPECT_EQ(before.misses, after.misses);
+}
+
 TEST_F(BinderLibTest, NopTransactionOneway) {
     Parcel data, reply;
     EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply, TF_ONE_WAY),
                 StatusEq(NO_ERROR));
 }
 
+TEST_F(BinderLibTest, OnewayBatch) {
+    int pipefd[2];
+    ASSERT_EQ(0, pipe2(pipefd, O_NONBLOCK));
+
+    IPCThreadState::self()->beginOnewayBatch();
+    for (uint8_t value = 1; value <= 3; value++) {
+        // The parcel is released before the batch is sent.
+        Parcel data, reply;
+        EXPECT_THAT(data.writeFileDescriptor(pipefd[1]), StatusEq(NO_ERROR));
+        EXPECT_THAT(data.writeInt32(sizeof(value)), StatusEq(NO_ERROR));
+        EXPECT_THAT(data.write(&value, sizeof(value)), StatusEq(NO_ERROR));
+        EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_WRITE_FILE_TRANSACTION, data, &reply,
+                                       TF_ONE_WAY),
+                    StatusEq(NO_ERROR));
+    }
+    EXPECT_THAT(IPCThreadState::self()->endOnewayBatch(), StatusEq(NO_ERROR));
+    close(pipefd[1]);
+
+    // Oneway transactions to the same binder are delivered in order.
+    uint8_t buf[3] = {};
+    size_t bytesRead = 0;
+    while (bytesRead < sizeof(buf)) {
+        waitForReadData(pipefd[0], 5000);
+        ssize_t ret = read(pipefd[0], buf + bytesRead, sizeof(buf) - bytesRead);
+        ASSERT_GT(ret, 0);
+        bytesRead += ret;
+    }
+    EXPECT_EQ(1, buf[0]);
+    EXPECT_EQ(2, buf[1]);
+    EXPECT_EQ(3, buf[2]);
+    close(pipefd[0]);
+}
+
+TEST_F(BinderLibTest, OnewayBatchFlushedByTwoWayTransaction) {
+    IPCThreadState::self()->beginOnewayBatch();
+    Parcel data, reply;
+    EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply, TF_ONE_WAY),
+                StatusEq(NO_ERROR));
+    EXPECT_THAT(m_server->transact(BINDER_LIB_TEST_NOP_TRANSACTION, data, &reply),
+                StatusEq(NO_ERROR));
+    EXPECT_THAT(IPCThreadState::self()->endOnewayBatch(), StatusEq(NO_ERROR));
+}
+
 TEST_F(BinderLibTest, NopTransactionClear) {
     Parcel data, reply;
     // make sure it accepts the transaction flag
@@ -1565,6 +1623,18 @@ TEST_F(BinderLibTest, ThreadPoolStarted) {
     EXPECT_TRUE(reply.readBool());
 }
 
+TEST_F(BinderLibTest, ThreadPoolAdaptiveMaxThreadCount) {
+    sp<ProcessState> ps = ProcessState::self();
+    ProcessState::ThreadPoolStats stats = ps->getThreadPoolStats();
+    ASSERT_GT(stats.maxThreads, 0u);
+    EXPECT_EQ(BAD_VALUE, ps->setThreadPoolAdaptiveMaxThreadCount(stats.maxThreads - 1));
+
+    EXPECT_EQ(NO_ERROR, ps->setThreadPoolAdaptiveMaxThreadCount(stats.maxThreads + 4));
+    stats = ps->getThreadPoolStats();
+    EXPECT_EQ(stats.maxThreads + 4, stats.adaptiveMaxThreads);
+    EXPECT_LE(stats.executingThreads, stats.peakExecutingThreads);
+}
+
 size_t epochMillis() {
     using std::chrono::duration_cast;
     using std::chrono::milliseconds;
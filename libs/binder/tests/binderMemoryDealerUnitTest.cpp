@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <binder/MemoryDealer.h>
+
+#include <unistd.h>
+
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+using namespace android;
+
+class MemoryDealerTest : public testing::TestWithParam<MemoryDealer::Allocator> {
+protected:
+    sp<MemoryDealer> makeDealer(size_t size) {
+        return sp<MemoryDealer>::make(size, "MemoryDealerTest", 0, GetParam());
+    }
+};
+
+TEST_P(MemoryDealerTest, AllocationsDoNotOverlap) {
+    auto dealer = makeDealer(64 * 1024);
+    std::vector<sp<IMemory>> memories;
+    std::set<std::pair<size_t, size_t>> ranges;
+    for (size_t size : {1, 32, 33, 100, 4096, 5000, 31, 64}) {
+        sp<IMemory> memory = dealer->allocate(size);
+        ASSERT_NE(nullptr, memory);
+        EXPECT_EQ(size, memory->size());
+        EXPECT_EQ(0u, memory->offset() % MemoryDealer::getAllocationAlignment());
+        size_t start = memory->offset();
+        size_t end = start + memory->size();
+        for (const auto& [otherStart, otherEnd] : ranges) {
+            EXPECT_TRUE(end <= otherStart || start >= otherEnd);
+        }
+        ranges.emplace(start, end);
+        memories.push_back(memory);
+    }
+}
+
+TEST_P(MemoryDealerTest, FreedMemoryIsReused) {
+    constexpr size_t kHeapSize = 16 * 1024;
+    auto dealer = makeDealer(kHeapSize);
+
+    // Fill the heap, then release everything: the whole heap must be available again.
+    std::vector<sp<IMemory>> memories;
+    while (sp<IMemory> memory = dealer->allocate(1024)) {
+        memories.push_back(memory);
+    }
+    EXPECT_EQ(kHeapSize / 1024, memories.size());
+    memories.clear();
+
+    EXPECT_NE(nullptr, dealer->allocate(kHeapSize));
+}
+
+TEST_P(MemoryDealerTest, NonPowerOfTwoHeap) {
+    const size_t pageSize = getpagesize();
+    auto dealer = makeDealer(3 * pageSize);
+
+    sp<IMemory> big = dealer->allocate(2 * pageSize);
+    ASSERT_NE(nullptr, big);
+    sp<IMemory> small = dealer->allocate(pageSize);
+    ASSERT_NE(nullptr, small);
+    EXPECT_EQ(nullptr, dealer->allocate(32));
+}
+
+TEST_P(MemoryDealerTest, TooLarge) {
+    const size_t pageSize = getpagesize();
+    auto dealer = makeDealer(pageSize);
+    EXPECT_EQ(nullptr, dealer->allocate(pageSize + 1));
+}
+
+INSTANTIATE_TEST_SUITE_P(Allocators, MemoryDealerTest,
+                         testing::Values(MemoryDealer::Allocator::BEST_FIT,
+                                         MemoryDealer::Allocator::BUDDY));
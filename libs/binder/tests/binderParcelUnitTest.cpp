@@ -401,6 +401,24 @@ TEST_READ_WRITE_INVERSE(int8_t, Byte, {-1, 0, 1});
 TEST_READ_WRITE_INVERSE(String8, String8, {String8(), String8("a"), String8("asdf")});
 TEST_READ_WRITE_INVERSE(String16, String16, {String16(), String16("a"), String16("asdf")});
 
+TEST(Parcel, ReuseDataBufferAcrossParcels) {
+    const size_t allocSizeBefore = Parcel::getGlobalAllocSize();
+    for (int32_t i = 0; i < 10; i++) {
+        Parcel p;
+        EXPECT_EQ(0u, p.dataSize());
+        for (int32_t j = 0; j <= i * 16; j++) {
+            ASSERT_EQ(OK, p.writeInt32(i + j));
+        }
+        p.setDataPosition(0);
+        for (int32_t j = 0; j <= i * 16; j++) {
+            ASSERT_EQ(i + j, p.readInt32());
+        }
+        EXPECT_EQ(p.enforceNoDataAvail().exceptionCode(), Status::Exception::EX_NONE);
+    }
+    // Buffers kept for reuse are not accounted to any Parcel.
+    EXPECT_EQ(allocSizeBefore, Parcel::getGlobalAllocSize());
+}
+
 TEST(Parcel, GetOpenAshmemSize) {
     constexpr size_t kSize = 1024;
     constexpr size_t kCount = 3;
@@ -17,6 +17,7 @@
 #include <binder/Parcel.h>
 #include <binder/PersistableBundle.h>
 #include <gtest/gtest.h>
+#include <cstring>
 #include <numeric>
 
 using android::OK;
@@ -132,3 +133,51 @@ TEST(PersistableBundle, OverwriteKey) {
     EXPECT_TRUE(pb.getDouble(kKey, &out));
     EXPECT_EQ(out, 0.5);
 }
+
+TEST(PersistableBundle, ForwardUnmodifiedBundle) {
+    PersistableBundle expected = createSimplePersistableBundle();
+    expected.putPersistableBundle(String16{"nested"}, createSimplePersistableBundle());
+    expected.putStringVector(String16{"strings"}, {String16{"foo"}, String16{"bar"}});
+
+    Parcel p1{};
+    ASSERT_EQ(expected.writeToParcel(&p1), OK);
+    p1.setDataPosition(0);
+    PersistableBundle forwarded{};
+    ASSERT_EQ(forwarded.readFromParcel(&p1), OK);
+
+    // Writing a bundle that was never accessed reproduces the original bytes.
+    Parcel p2{};
+    ASSERT_EQ(forwarded.writeToParcel(&p2), OK);
+    ASSERT_EQ(p1.dataSize(), p2.dataSize());
+    EXPECT_EQ(0, memcmp(p1.data(), p2.data(), p1.dataSize()));
+
+    p2.setDataPosition(0);
+    PersistableBundle out{};
+    ASSERT_EQ(out.readFromParcel(&p2), OK);
+    EXPECT_EQ(expected, out);
+}
+
+TEST(PersistableBundle, ModifyUnparceledBundle) {
+    PersistableBundle in = createSimplePersistableBundle();
+    Parcel p{};
+    ASSERT_EQ(in.writeToParcel(&p), OK);
+    p.setDataPosition(0);
+
+    PersistableBundle pb{};
+    ASSERT_EQ(pb.readFromParcel(&p), OK);
+    PersistableBundle copy = pb;
+    pb.putLong(String16{"long"}, 42);
+
+    int32_t intValue;
+    EXPECT_TRUE(pb.getInt(kKey, &intValue));
+    EXPECT_EQ(intValue, 64);
+    EXPECT_EQ(pb.size(), 2u);
+    EXPECT_EQ(copy, in);
+
+    Parcel modified{};
+    ASSERT_EQ(pb.writeToParcel(&modified), OK);
+    modified.setDataPosition(0);
+    PersistableBundle out{};
+    ASSERT_EQ(out.readFromParcel(&modified), OK);
+    EXPECT_EQ(out, pb);
+}
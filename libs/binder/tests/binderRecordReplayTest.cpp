@@ -34,6 +34,7 @@
 #include <gtest/gtest.h>
 
 #include <sys/prctl.h>
+#include <sys/stat.h>
 
 #include "../file.h"
 #include "parcelables/SingleDataParcelable.h"
@@ -391,6 +392,28 @@ TEST_F(BinderRecordReplayTest, ReplayFd) {
                  &IBinderRecordReplayTest::getFileDescriptor, unique_fd(dup(changed)));
 }
 
+TEST_F(BinderRecordReplayTest, RecordSampled) {
+    unique_fd fd(open("/data/local/tmp/binderRecordReplayTestSampled.rec",
+                      O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666));
+    ASSERT_TRUE(fd.ok());
+
+    // Only the first and third transactions are recorded.
+    ASSERT_EQ(OK, mBpBinder->startRecordingBinder(fd, 2));
+    for (int value : {1, 2, 3, 4}) {
+        EXPECT_TRUE(mInterface->setInt(value).isOk());
+    }
+    ASSERT_EQ(OK, mBpBinder->stopRecordingBinder());
+
+    // stopRecordingBinder waits for queued records, so the file holds exactly two of them.
+    ASSERT_EQ(0, lseek(fd.get(), 0, SEEK_SET));
+    for (int i = 0; i < 2; i++) {
+        ASSERT_NE(RecordedTransaction::fromFile(fd), std::nullopt);
+    }
+    struct stat st;
+    ASSERT_EQ(0, fstat(fd.get(), &st));
+    EXPECT_EQ(lseek(fd.get(), 0, SEEK_CUR), st.st_size);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
 
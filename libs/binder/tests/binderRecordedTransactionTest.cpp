@@ -18,6 +18,8 @@
 #include <gtest/gtest.h>
 #include <utils/Errors.h>
 
+#include <unistd.h>
+
 using android::Parcel;
 using android::status_t;
 using android::binder::unique_fd;
@@ -60,6 +62,48 @@ TEST(BinderRecordedTransaction, RoundTripEncoding) {
     EXPECT_EQ(retrievedTransaction->getReplyParcel().readInt32(), 99);
 }
 
+TEST(BinderRecordedTransaction, SerializeDetailsMatchesDumpToFile) {
+    android::String16 interfaceName("SampleInterface");
+    Parcel d;
+    d.writeInt32(12);
+    d.writeInt64(2);
+    Parcel r;
+    r.writeInt32(99);
+    timespec ts = {1232456, 567890};
+
+    auto transaction = RecordedTransaction::fromDetails(interfaceName, 1, 42, ts, d, r, 0);
+    ASSERT_TRUE(transaction.has_value());
+    auto file = std::tmpfile();
+    auto fd = unique_fd(fcntl(fileno(file), F_DUPFD, 1));
+    ASSERT_EQ(android::NO_ERROR, transaction->dumpToFile(fd));
+    std::vector<uint8_t> dumped(lseek(fd.get(), 0, SEEK_CUR));
+    ASSERT_EQ(0, lseek(fd.get(), 0, SEEK_SET));
+    ASSERT_EQ(static_cast<ssize_t>(dumped.size()), read(fd.get(), dumped.data(), dumped.size()));
+
+    // Records are appended, so a buffer can hold several of them.
+    std::vector<uint8_t> serialized;
+    ASSERT_EQ(android::NO_ERROR,
+              RecordedTransaction::serializeDetails(&serialized, interfaceName, 1, 42, ts, d, r,
+                                                    0));
+    EXPECT_EQ(dumped, serialized);
+    ASSERT_EQ(android::NO_ERROR,
+              RecordedTransaction::serializeDetails(&serialized, interfaceName, 1, 42, ts, d, r,
+                                                    0));
+    EXPECT_EQ(2 * dumped.size(), serialized.size());
+
+    auto file2 = std::tmpfile();
+    auto fd2 = unique_fd(fcntl(fileno(file2), F_DUPFD, 1));
+    ASSERT_EQ(static_cast<ssize_t>(serialized.size()),
+              write(fd2.get(), serialized.data(), serialized.size()));
+    ASSERT_EQ(0, lseek(fd2.get(), 0, SEEK_SET));
+    for (int i = 0; i < 2; i++) {
+        auto retrievedTransaction = RecordedTransaction::fromFile(fd2);
+        ASSERT_TRUE(retrievedTransaction.has_value());
+        EXPECT_EQ(retrievedTransaction->getCode(), 1);
+        EXPECT_EQ(retrievedTransaction->getReplyParcel().readInt32(), 99);
+    }
+}
+
 TEST(BinderRecordedTransaction, Checksum) {
     android::String16 interfaceName("SampleInterface");
     Parcel d;
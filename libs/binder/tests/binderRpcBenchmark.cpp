@@ -20,6 +20,7 @@
 #include <binder/Binder.h>
 #include <binder/IPCThreadState.h>
 #include <binder/IServiceManager.h>
+#include <binder/ParcelFileDescriptor.h>
 #include <binder/ProcessState.h>
 #include <binder/RpcCertificateFormat.h>
 #include <binder/RpcCertificateVerifier.h>
@@ -31,8 +32,13 @@
 #include <binder/RpcTransportTls.h>
 #include <openssl/ssl.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <thread>
 
+#include <fcntl.h>
+#include <sched.h>
 #include <signal.h>
 #include <sys/prctl.h>
 #include <sys/types.h>
@@ -60,6 +66,8 @@ using android::status_t;
 using android::statusToString;
 using android::String16;
 using android::binder::Status;
+using android::binder::unique_fd;
+using android::os::ParcelFileDescriptor;
 
 class MyBinderRpcBenchmark : public BnBinderRpcBenchmark {
     Status repeatString(const std::string& str, std::string* out) override {
@@ -108,10 +116,36 @@ class MyBinderRpcBenchmark : public BnBinderRpcBenchmark {
         return Status::ok();
     }
 
+    Status sendBytesOneway(const std::vector<uint8_t>& /*bytes*/) override {
+        {
+            std::lock_guard<std::mutex> l(mOnewayMutex);
+            mOnewaysReceived++;
+        }
+        mOnewayCv.notify_all();
+        return Status::ok();
+    }
+    Status waitOnewaysReceived(int64_t count) override {
+        std::unique_lock<std::mutex> l(mOnewayMutex);
+        mOnewayCv.wait(l, [&] { return mOnewaysReceived >= count; });
+        return Status::ok();
+    }
+
+    Status repeatFd(const ParcelFileDescriptor& fd, ParcelFileDescriptor* out) override {
+        *out = ParcelFileDescriptor(unique_fd(dup(fd.get())));
+        return Status::ok();
+    }
+    Status pingBack(const sp<IBinder>& callback) override {
+        return Status::fromStatusT(callback->pingBinder());
+    }
+
     friend class CountedBinder;
     std::mutex mCountMutex;
     std::condition_variable mCountCv;
     size_t mBinderCount;
+
+    std::mutex mOnewayMutex;
+    std::condition_variable mOnewayCv;
+    int64_t mOnewaysReceived = 0;
 };
 
 enum Transport {
@@ -128,6 +162,14 @@ static const std::initializer_list<int64_t> kTransportList = {
         Transport::RPC_TLS,
 };
 
+// Transports which can pass file descriptors. TLS sessions can't.
+static const std::initializer_list<int64_t> kFdTransportList = {
+#ifdef __BIONIC__
+        Transport::KERNEL,
+#endif
+        Transport::RPC,
+};
+
 std::unique_ptr<RpcTransportCtxFactory> makeFactoryTls() {
     auto pkey = android::makeKeyPairForSelfSignedCert();
     CHECK_NE(pkey.get(), nullptr);
@@ -148,8 +190,41 @@ static sp<IBinder> gRpcTlsBinder;
 #ifdef __BIONIC__
 static const String16 kKernelBinderInstance = String16(u"binderRpcBenchmark-control");
 static sp<IBinder> gKernelBinder;
+// Same service, but with a minimum scheduler policy that calls must be run at.
+static const String16 kKernelMinPolicyBinderInstance =
+        String16(u"binderRpcBenchmark-minSchedulerPolicy");
+static sp<IBinder> gKernelMinPolicyBinder;
 #endif
 
+// Total calls to sendBytesOneway made to the server of each transport.
+static std::array<int64_t, 3> gOnewaysSent;
+
+// Records the duration of each call, to report latency percentiles alongside the mean time
+// that benchmark reports.
+class LatencyRecorder {
+public:
+    void record(std::chrono::steady_clock::duration latency) {
+        mLatencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+    }
+
+    void report(benchmark::State& state) {
+        if (mLatencies.empty()) return;
+        std::sort(mLatencies.begin(), mLatencies.end());
+        auto percentileUs = [&](double percentile) {
+            size_t index = std::min(mLatencies.size() - 1,
+                                    static_cast<size_t>(percentile * mLatencies.size()));
+            // Averaged rather than summed when several threads run the benchmark.
+            return benchmark::Counter(mLatencies[index] / 1000.0, benchmark::Counter::kAvgThreads);
+        };
+        state.counters["p50_us"] = percentileUs(0.50);
+        state.counters["p99_us"] = percentileUs(0.99);
+        state.counters["p999_us"] = percentileUs(0.999);
+    }
+
+private:
+    std::vector<int64_t> mLatencies;
+};
+
 static sp<IBinder> getBinderForOptions(benchmark::State& state) {
     Transport transport = static_cast<Transport>(state.range(0));
     switch (transport) {
@@ -301,6 +376,144 @@ void BM_repeatBinder(benchmark::State& state) {
 }
 BENCHMARK(BM_repeatBinder)->ArgsProduct({kTransportList});
 
+void BM_latencyForTransportAndBytes(benchmark::State& state) {
+    sp<IBinder> binder = getBinderForOptions(state);
+    sp<IBinderRpcBenchmark> iface = interface_cast<IBinderRpcBenchmark>(binder);
+    CHECK(iface != nullptr);
+
+    std::vector<uint8_t> bytes = std::vector<uint8_t>(state.range(1));
+    LatencyRecorder recorder;
+
+    while (state.KeepRunning()) {
+        std::vector<uint8_t> out;
+        auto start = std::chrono::steady_clock::now();
+        Status ret = iface->repeatBytes(bytes, &out);
+        recorder.record(std::chrono::steady_clock::now() - start);
+        CHECK(ret.isOk()) << ret;
+    }
+
+    recorder.report(state);
+    SetLabel(state);
+}
+BENCHMARK(BM_latencyForTransportAndBytes)
+        ->ArgsProduct({kTransportList, {64, 1024, 4096, 16384, 65536}});
+
+void BM_onewayForTransportAndBytes(benchmark::State& state) {
+    sp<IBinder> binder = getBinderForOptions(state);
+    sp<IBinderRpcBenchmark> iface = interface_cast<IBinderRpcBenchmark>(binder);
+    CHECK(iface != nullptr);
+
+    // Wait for the server to catch up after this many calls, so that they don't fill up the
+    // kernel's async buffer space.
+    constexpr int64_t kCallsPerWait = 16;
+
+    std::vector<uint8_t> bytes = std::vector<uint8_t>(state.range(1));
+    int64_t& sent = gOnewaysSent[state.range(0)];
+    LatencyRecorder recorder;
+
+    while (state.KeepRunning()) {
+        auto start = std::chrono::steady_clock::now();
+        Status ret = iface->sendBytesOneway(bytes);
+        recorder.record(std::chrono::steady_clock::now() - start);
+        CHECK(ret.isOk()) << ret;
+
+        if (++sent % kCallsPerWait == 0) {
+            state.PauseTiming();
+            ret = iface->waitOnewaysReceived(sent);
+            CHECK(ret.isOk()) << ret;
+            state.ResumeTiming();
+        }
+    }
+    Status ret = iface->waitOnewaysReceived(sent);
+    CHECK(ret.isOk()) << ret;
+
+    recorder.report(state);
+    SetLabel(state);
+}
+BENCHMARK(BM_onewayForTransportAndBytes)->ArgsProduct({kTransportList, {64, 1024, 4096, 16384}});
+
+void BM_repeatFd(benchmark::State& state) {
+    sp<IBinder> binder = getBinderForOptions(state);
+    sp<IBinderRpcBenchmark> iface = interface_cast<IBinderRpcBenchmark>(binder);
+    CHECK(iface != nullptr);
+
+    ParcelFileDescriptor fd(unique_fd(open("/dev/null", O_RDWR | O_CLOEXEC)));
+    CHECK_GE(fd.get(), 0);
+    LatencyRecorder recorder;
+
+    while (state.KeepRunning()) {
+        ParcelFileDescriptor out;
+        auto start = std::chrono::steady_clock::now();
+        Status ret = iface->repeatFd(fd, &out);
+        recorder.record(std::chrono::steady_clock::now() - start);
+        CHECK(ret.isOk()) << ret;
+    }
+
+    recorder.report(state);
+    SetLabel(state);
+}
+BENCHMARK(BM_repeatFd)->ArgsProduct({kFdTransportList});
+
+void BM_nestedCall(benchmark::State& state) {
+    sp<IBinder> binder = getBinderForOptions(state);
+    sp<IBinderRpcBenchmark> iface = interface_cast<IBinderRpcBenchmark>(binder);
+    CHECK(iface != nullptr);
+
+    sp<IBinder> callback = sp<BBinder>::make();
+    LatencyRecorder recorder;
+
+    while (state.KeepRunning()) {
+        auto start = std::chrono::steady_clock::now();
+        Status ret = iface->pingBack(callback);
+        recorder.record(std::chrono::steady_clock::now() - start);
+        CHECK(ret.isOk()) << ret;
+    }
+
+    recorder.report(state);
+    SetLabel(state);
+}
+BENCHMARK(BM_nestedCall)->ArgsProduct({kTransportList});
+
+// Many client threads calling into one service, limited by its threads (kernel) or by the
+// connections of the session (RPC).
+void BM_pingTransactionContended(benchmark::State& state) {
+    sp<IBinder> binder = getBinderForOptions(state);
+    LatencyRecorder recorder;
+
+    while (state.KeepRunning()) {
+        auto start = std::chrono::steady_clock::now();
+        status_t status = binder->pingBinder();
+        recorder.record(std::chrono::steady_clock::now() - start);
+        CHECK_EQ(OK, status);
+    }
+
+    recorder.report(state);
+    SetLabel(state);
+}
+BENCHMARK(BM_pingTransactionContended)
+        ->ArgsProduct({kTransportList})
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+
+#ifdef __BIONIC__
+// Calls to a service with a minimum scheduler policy, which the driver applies to the thread
+// handling each call.
+void BM_pingMinSchedulerPolicy(benchmark::State& state) {
+    LatencyRecorder recorder;
+
+    while (state.KeepRunning()) {
+        auto start = std::chrono::steady_clock::now();
+        status_t status = gKernelMinPolicyBinder->pingBinder();
+        recorder.record(std::chrono::steady_clock::now() - start);
+        CHECK_EQ(OK, status);
+    }
+
+    recorder.report(state);
+    state.SetLabel("kernel");
+}
+BENCHMARK(BM_pingMinSchedulerPolicy);
+#endif
+
 void forkRpcServer(const char* addr, const sp<RpcServer>& server) {
     if (0 == fork()) {
         prctl(PR_SET_PDEATHSIG, SIGHUP); // racey, okay
@@ -331,6 +544,11 @@ int main(int argc, char** argv) {
         CHECK_EQ(OK,
                  defaultServiceManager()->addService(kKernelBinderInstance,
                                                      sp<MyBinderRpcBenchmark>::make()));
+        sp<MyBinderRpcBenchmark> minPolicyService = sp<MyBinderRpcBenchmark>::make();
+        minPolicyService->setMinSchedulerPolicy(SCHED_FIFO, 1);
+        CHECK_EQ(OK,
+                 defaultServiceManager()->addService(kKernelMinPolicyBinderInstance,
+                                                     minPolicyService));
         IPCThreadState::self()->joinThreadPool();
         exit(1);
     }
@@ -340,13 +558,21 @@ int main(int argc, char** argv) {
 
     gKernelBinder = defaultServiceManager()->waitForService(kKernelBinderInstance);
     CHECK_NE(nullptr, gKernelBinder.get());
+    gKernelMinPolicyBinder =
+            defaultServiceManager()->waitForService(kKernelMinPolicyBinderInstance);
+    CHECK_NE(nullptr, gKernelMinPolicyBinder.get());
 #endif
 
     std::string tmp = getenv("TMPDIR") ?: "/tmp";
 
     std::string addr = tmp + "/binderRpcBenchmark";
     (void)unlink(addr.c_str());
-    forkRpcServer(addr.c_str(), RpcServer::make(RpcTransportCtxFactoryRaw::make()));
+    sp<RpcServer> server = RpcServer::make(RpcTransportCtxFactoryRaw::make());
+    server->setSupportedFileDescriptorTransportModes(
+            {RpcSession::FileDescriptorTransportMode::NONE,
+             RpcSession::FileDescriptorTransportMode::UNIX});
+    forkRpcServer(addr.c_str(), server);
+    gSession->setFileDescriptorTransportMode(RpcSession::FileDescriptorTransportMode::UNIX);
     setupClient(gSession, addr.c_str());
     gRpcBinder = gSession->getRootObject();
 
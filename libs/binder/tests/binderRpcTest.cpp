@@ -1467,6 +1467,104 @@ TEST_P(BinderRpcServerOnly, Shutdown) {
             << "After server->shutdown() returns true, join() did not stop after 2s";
 }
 
+TEST(BinderRpc, EventLoopServesManySessions) {
+    if constexpr (!kEnableRpcThreads) {
+        GTEST_SKIP() << "Test skipped because threads were disabled at build time";
+    }
+
+    constexpr size_t kNumSessions = 16;
+    constexpr size_t kNumConnections = 2;
+
+    auto addr = allocateSocketAddress();
+    auto server = RpcServer::make();
+    server->setMaxThreads(kNumConnections);
+    server->setEventLoopThreads(2);
+    ASSERT_EQ(2u, server->getEventLoopThreads());
+    server->setRootObject(sp<BBinder>::make());
+    ASSERT_EQ(OK, server->setupUnixDomainServer(addr.c_str()));
+    server->start();
+
+    // More connections than worker threads, which all stay open while idle.
+    std::vector<sp<RpcSession>> sessions;
+    for (size_t i = 0; i < kNumSessions; i++) {
+        auto session = RpcSession::make();
+        ASSERT_EQ(OK, session->setupUnixDomainClient(addr.c_str()));
+        sessions.push_back(session);
+    }
+
+    std::vector<std::thread> threads;
+    for (const auto& session : sessions) {
+        threads.emplace_back([session] {
+            auto root = session->getRootObject();
+            ASSERT_NE(nullptr, root);
+            for (size_t i = 0; i < 10; i++) {
+                EXPECT_EQ(OK, root->pingBinder());
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(kNumSessions, server->listSessions().size());
+
+    for (const auto& session : sessions) {
+        EXPECT_TRUE(session->shutdownAndWait(true));
+    }
+    ASSERT_TRUE(server->shutdown());
+}
+
+TEST(BinderRpc, TransactAsyncCompletesEveryCall) {
+    if constexpr (!kEnableRpcThreads) {
+        GTEST_SKIP() << "Test skipped because threads were disabled at build time";
+    }
+
+    constexpr size_t kNumCalls = 4;
+
+    auto addr = allocateSocketAddress();
+    auto server = RpcServer::make();
+    server->setMaxThreads(kNumCalls);
+    server->setRootObject(sp<BBinder>::make());
+    ASSERT_EQ(OK, server->setupUnixDomainServer(addr.c_str()));
+    server->start();
+
+    auto session = RpcSession::make();
+    ASSERT_EQ(OK, session->setupUnixDomainClient(addr.c_str()));
+    auto root = session->getRootObject();
+    ASSERT_NE(nullptr, root);
+    BpBinder* proxy = root->remoteBinder();
+    ASSERT_NE(nullptr, proxy);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t completed = 0;
+    std::vector<Parcel> replies(kNumCalls);
+    for (size_t i = 0; i < kNumCalls; i++) {
+        Parcel data;
+        data.markForBinder(root);
+        ASSERT_EQ(OK,
+                  proxy->transactAsync(IBinder::PING_TRANSACTION, data, &replies[i], 0,
+                                       [&](status_t status) {
+                                           EXPECT_EQ(OK, status);
+                                           std::lock_guard<std::mutex> lock(mutex);
+                                           completed++;
+                                           cv.notify_all();
+                                       }));
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ASSERT_TRUE(cv.wait_for(lock, 10s, [&] { return completed == kNumCalls; }));
+    }
+
+    // Async calls must not prevent the session from being used synchronously afterwards.
+    EXPECT_EQ(OK, root->pingBinder());
+    EXPECT_EQ(BAD_VALUE,
+              proxy->transactAsync(IBinder::PING_TRANSACTION, Parcel(), nullptr,
+                                   IBinder::FLAG_ONEWAY, [](status_t) {}));
+
+    EXPECT_TRUE(session->shutdownAndWait(true));
+    ASSERT_TRUE(server->shutdown());
+}
+
 INSTANTIATE_TEST_SUITE_P(BinderRpc, BinderRpcServerOnly,
                          ::testing::Combine(::testing::ValuesIn(RpcSecurityValues()),
                                             ::testing::ValuesIn(testVersions())),
@@ -1817,6 +1915,56 @@ TEST_P(RpcTransportTest, MultipleClients) {
     for (auto& client : clients) client.run();
 }
 
+TEST_P(RpcTransportTest, Reconnect) {
+    auto server = std::make_unique<Server>();
+    ASSERT_TRUE(server->setUp(GetParam()));
+
+    Client client(server->getConnectToServerFn());
+    ASSERT_TRUE(client.setUp(GetParam()));
+
+    ASSERT_EQ(OK, trust(&client, server));
+    ASSERT_EQ(OK, trust(server, &client));
+
+    server->start();
+    client.run();
+    // For TLS, this resumes the session of the first connection.
+    client.run();
+    client.run();
+}
+
+TEST_P(RpcTransportTest, LargeMessage) {
+    // Spans several TLS records, in iovecs which don't line up with them.
+    std::string message(3 * 16384 + 5, '\0');
+    for (size_t i = 0; i < message.size(); i++) message[i] = static_cast<char>('a' + i % 26);
+
+    auto serverPostConnect = [&](RpcTransport* serverTransport, FdTrigger* fdTrigger) {
+        iovec messageIovs[] = {
+                {message.data(), 4},
+                {message.data() + 4, 16384},
+                {message.data() + 16388, message.size() - 16388},
+        };
+        auto status = serverTransport->interruptableWriteFully(fdTrigger, messageIovs,
+                                                               countof(messageIovs), std::nullopt,
+                                                               nullptr);
+        if (status != OK) return AssertionFailure() << statusToString(status);
+        return AssertionSuccess();
+    };
+
+    auto server = std::make_unique<Server>();
+    ASSERT_TRUE(server->setUp(GetParam()));
+    server->setPostConnect(serverPostConnect);
+
+    Client client(server->getConnectToServerFn());
+    ASSERT_TRUE(client.setUp(GetParam()));
+
+    ASSERT_EQ(OK, trust(&client, server));
+    ASSERT_EQ(OK, trust(server, &client));
+
+    server->start();
+    ASSERT_TRUE(client.setUpTransport());
+    ASSERT_TRUE(client.readMessage(message));
+}
+
 TEST_P(RpcTransportTest, UntrustedServer) {
     auto [socketType, rpcSecurity, certificateFormat, serverVersion] = GetParam();
     (void)serverVersion;
@@ -257,6 +257,32 @@ TEST(RpcWire, CurrentVersion) {
     checkRepr(kCurrentRepr, RPC_WIRE_PROTOCOL_VERSION);
 }
 
+TEST(RpcWire, InterfaceTokenHash) {
+    // Until the feature is frozen, it is only available with the experimental protocol.
+    auto session = RpcSession::make();
+    if (!session->setProtocolVersion(RPC_WIRE_PROTOCOL_VERSION_EXPERIMENTAL)) {
+        GTEST_SKIP() << "Experimental protocol unavailable in this configuration";
+    }
+    ASSERT_EQ(OK, session->addNullDebuggingClient());
+
+    Parcel p;
+    p.markForRpc(session);
+    ASSERT_EQ(OK, p.writeInterfaceToken(String16(u"tok")));
+    EXPECT_EQ("feffffffbd9f654419b7f956", HexString(p.data(), p.dataSize()));
+
+    p.setDataPosition(0);
+    EXPECT_TRUE(p.enforceInterface(String16(u"tok")));
+    p.setDataPosition(0);
+    EXPECT_FALSE(p.enforceInterface(String16(u"tak")));
+
+    // The full string is still accepted from peers which send it.
+    Parcel full;
+    full.markForRpc(session);
+    ASSERT_EQ(OK, full.writeString16(String16(u"tok")));
+    full.setDataPosition(0);
+    EXPECT_TRUE(full.enforceInterface(String16(u"tok")));
+}
+
 static_assert(RPC_WIRE_PROTOCOL_VERSION == 1,
               "If the binder wire protocol is updated, this test should test additional versions. "
               "The binder wire protocol should only be updated on upstream AOSP.");
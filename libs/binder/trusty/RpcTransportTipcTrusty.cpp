@@ -219,6 +219,7 @@ public:
     }
 
     bool isWaiting() override { return mSocket.isInPollingState(); }
+    borrowed_fd pollFd() override { return borrowed_fd(mSocket.fd.get()); }
 
 private:
     status_t ensureMessage(bool wait) {
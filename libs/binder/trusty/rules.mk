@@ -30,6 +30,7 @@ MODULE_SRCS := \
 	$(LOCAL_DIR)/TrustyStatus.cpp \
 	$(LOCAL_DIR)/socket.cpp \
 	$(LIBBINDER_DIR)/Binder.cpp \
+	$(LIBBINDER_DIR)/BinderTransactionStats.cpp \
 	$(LIBBINDER_DIR)/BpBinder.cpp \
 	$(LIBBINDER_DIR)/FdTrigger.cpp \
 	$(LIBBINDER_DIR)/IInterface.cpp \
@@ -18,6 +18,7 @@
 #include <android-base/parseint.h>
 #include <android-base/strings.h>
 #include <binder/Binder.h>
+#include <binder/Parcel.h>
 #include <sys/types.h>
 #include <fstream>
 #include <regex>
@@ -226,4 +227,14 @@ status_t getBinderTransactions(pid_t pid, std::string& transactionsOutput) {
     return NAME_NOT_FOUND;
 }
 
+status_t getBinderTransactionStats(const sp<IBinder>& binder, BinderTransactionStats* stats) {
+    Parcel data;
+    Parcel reply;
+    status_t status = binder->transact(IBinder::TRANSACTION_STATS_TRANSACTION, data, &reply);
+    if (status != OK) {
+        return status;
+    }
+    return stats->readFromParcel(reply);
+}
+
 } // namespace  android
@@ -15,6 +15,8 @@
  */
 #pragma once
 
+#include <binder/BinderTransactionStats.h>
+#include <binder/IBinder.h>
 #include <utils/Errors.h>
 
 #include <map>
@@ -52,4 +54,12 @@ status_t getBinderClientPids(BinderDebugContext context, pid_t pid, pid_t servic
  */
 status_t getBinderTransactions(pid_t pid, std::string& transactionOutput);
 
+/**
+ * Get the transaction statistics that libbinder keeps for the process hosting binder. Unlike the
+ * functions above, this does not parse binder debugfs: it is a single transaction to binder, so
+ * it is cheap enough for continuous telemetry.
+ * Return: OK on success, or the error of the transaction.
+ */
+status_t getBinderTransactionStats(const sp<IBinder>& binder, BinderTransactionStats* stats);
+
 } // namespace  android
@@ -60,6 +60,18 @@ TEST(BinderDebugTests, BinderThreads) {
     EXPECT_GE(pidInfo.threadCount, 1);
 }
 
+TEST(BinderDebugTests, BinderTransactionStats) {
+    BinderTransactionStats stats;
+    const auto& status = getBinderTransactionStats(sp<BBinder>::make(), &stats);
+    ASSERT_EQ(status, OK);
+    // main() registered a service and was called by the child process
+    EXPECT_GE(stats.outgoing.calls, 1u);
+    EXPECT_GE(stats.incoming.calls, 1u);
+    EXPECT_GE(stats.incoming.callsPerCode[BinderTransactionStats::codeSlot(
+                      IBinder::FIRST_CALL_TRANSACTION)],
+              1u);
+}
+
 extern "C" {
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
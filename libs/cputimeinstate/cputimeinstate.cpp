@@ -296,6 +296,23 @@ std::optional<std::vector<std::vector<uint64_t>>> getTotalCpuFreqTimes() {
 
     return out;
 }
+// Adds the per-CPU times of a uid_time_in_state bucket to out, which has the format returned by
+// getUidCpuFreqTimes().
+static void addTisBucket(uint32_t bucket, const std::vector<tis_val_t> &vals,
+                         std::vector<std::vector<uint64_t>> &out) {
+    auto offset = bucket * FREQS_PER_ENTRY;
+    auto nextOffset = (bucket + 1) * FREQS_PER_ENTRY;
+    for (uint32_t i = 0; i < gNPolicies; ++i) {
+        if (offset >= gPolicyFreqs[i].size()) continue;
+        auto begin = out[i].begin() + offset;
+        auto end = nextOffset < gPolicyFreqs[i].size() ? begin + FREQS_PER_ENTRY : out[i].end();
+        for (const auto &cpu : gPolicyCpus[i]) {
+            std::transform(begin, end, std::begin(vals[gCpuIndexMap[cpu]].ar), begin,
+                           std::plus<uint64_t>());
+        }
+    }
+}
+
 // Retrieve the times in ns that uid spent running at each CPU frequency.
 // Return contains no value on error, otherwise it contains a vector of vectors using the format:
 // [[t0_0, t0_1, ...],
@@ -319,28 +336,13 @@ std::optional<std::vector<std::vector<uint64_t>>> getUidCpuFreqTimes(uint32_t ui
             if (errno != ENOENT || getFirstMapKey(gTisMapFd, &tmpKey)) return {};
             continue;
         }
-
-        auto offset = i * FREQS_PER_ENTRY;
-        auto nextOffset = (i + 1) * FREQS_PER_ENTRY;
-        for (uint32_t j = 0; j < gNPolicies; ++j) {
-            if (offset >= gPolicyFreqs[j].size()) continue;
-            auto begin = out[j].begin() + offset;
-            auto end = nextOffset < gPolicyFreqs[j].size() ? begin + FREQS_PER_ENTRY : out[j].end();
-
-            for (const auto &cpu : gPolicyCpus[j]) {
-                std::transform(begin, end, std::begin(vals[gCpuIndexMap[cpu]].ar), begin,
-                               std::plus<uint64_t>());
-            }
-        }
+        addTisBucket(i, vals, out);
     }
 
     return out;
 }
 
-static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
-                                           uint64_t *newLastUpdate) {
-    uint64_t uidLastUpdate;
-    if (findMapEntry(gUidLastUpdateMapFd, &uid, &uidLastUpdate)) return {};
+static bool updatedSince(uint64_t uidLastUpdate, uint64_t lastUpdate, uint64_t *newLastUpdate) {
     // Updates that occurred during the previous read may have been missed. To mitigate
     // this, don't ignore entries updated up to 1s before *lastUpdate
     constexpr uint64_t NSEC_PER_SEC = 1000000000;
@@ -349,6 +351,13 @@ static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
     return true;
 }
 
+static std::optional<bool> uidUpdatedSince(uint32_t uid, uint64_t lastUpdate,
+                                           uint64_t *newLastUpdate) {
+    uint64_t uidLastUpdate;
+    if (findMapEntry(gUidLastUpdateMapFd, &uid, &uidLastUpdate)) return {};
+    return updatedSince(uidLastUpdate, lastUpdate, newLastUpdate);
+}
+
 // Retrieve the times in ns that each uid spent running at each CPU freq.
 // Return contains no value on error, otherwise it contains a map from uids to vectors of vectors
 // using the format:
@@ -365,9 +374,15 @@ getUidsCpuFreqTimes() {
 // Return format is the same as getUidsCpuFreqTimes()
 std::optional<std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>>>
 getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate) {
+    std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>> map;
+    if (lastUpdate) {
+        std::vector<uint32_t> updatedUids;
+        if (!getUidsUpdatedCpuFreqTimes(lastUpdate, &map, &updatedUids)) return {};
+        return map;
+    }
+
     if (!gInitialized && !initGlobals()) return {};
     time_key_t key, prevKey;
-    std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>> map;
     if (getFirstMapKey(gTisMapFd, &key)) {
         if (errno == ENOENT) return map;
         return std::nullopt;
@@ -376,36 +391,75 @@ getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate) {
     std::vector<std::vector<uint64_t>> mapFormat;
     for (const auto &freqList : gPolicyFreqs) mapFormat.emplace_back(freqList.size(), 0);
 
-    uint64_t newLastUpdate = lastUpdate ? *lastUpdate : 0;
     std::vector<tis_val_t> vals(gNCpus);
     do {
-        if (lastUpdate) {
-            auto uidUpdated = uidUpdatedSince(key.uid, *lastUpdate, &newLastUpdate);
-            if (!uidUpdated.has_value()) return {};
-            if (!*uidUpdated) continue;
-        }
         if (findMapEntry(gTisMapFd, &key, vals.data())) return {};
-        if (map.find(key.uid) == map.end()) map.emplace(key.uid, mapFormat);
-
-        auto offset = key.bucket * FREQS_PER_ENTRY;
-        auto nextOffset = (key.bucket + 1) * FREQS_PER_ENTRY;
-        for (uint32_t i = 0; i < gNPolicies; ++i) {
-            if (offset >= gPolicyFreqs[i].size()) continue;
-            auto begin = map[key.uid][i].begin() + offset;
-            auto end = nextOffset < gPolicyFreqs[i].size() ? begin + FREQS_PER_ENTRY :
-                map[key.uid][i].end();
-            for (const auto &cpu : gPolicyCpus[i]) {
-                std::transform(begin, end, std::begin(vals[gCpuIndexMap[cpu]].ar), begin,
-                               std::plus<uint64_t>());
-            }
-        }
-        prevKey = key;
+        auto it = map.find(key.uid);
+        if (it == map.end()) it = map.emplace(key.uid, mapFormat).first;
+        addTisBucket(key.bucket, vals, it->second);
     } while (prevKey = key, !getNextMapKey(gTisMapFd, &prevKey, &key));
     if (errno != ENOENT) return {};
-    if (lastUpdate && newLastUpdate > *lastUpdate) *lastUpdate = newLastUpdate;
     return map;
 }
 
+// Refresh times, a map in the format returned by getUidsCpuFreqTimes(), with the times of the UIDs
+// that have run since *lastUpdate, and store those UIDs in updatedUids.
+// Rather than walking every (uid, bucket) entry of the time in state map, this walks the much
+// smaller per-UID last update map and only reads the buckets of UIDs that have run. Entries of
+// times that belong to other UIDs are left as they are, and existing entries are overwritten in
+// place, so a caller that keeps times and updatedUids between polls does not allocate once every
+// UID has been seen. Callers are responsible for erasing the entries of removed UIDs.
+// Returns false on error, in which case times may have been partially refreshed.
+bool getUidsUpdatedCpuFreqTimes(
+        uint64_t *lastUpdate, std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>> *times,
+        std::vector<uint32_t> *updatedUids) {
+    if (!gInitialized && !initGlobals()) return false;
+    updatedUids->clear();
+
+    uint32_t maxFreqCount = 0;
+    for (const auto &freqList : gPolicyFreqs) {
+        if (freqList.size() > maxFreqCount) maxFreqCount = freqList.size();
+    }
+
+    uint32_t uid, prevUid;
+    if (getFirstMapKey(gUidLastUpdateMapFd, &uid)) return errno == ENOENT;
+
+    uint64_t newLastUpdate = *lastUpdate;
+    std::vector<tis_val_t> vals(gNCpus);
+    do {
+        uint64_t uidLastUpdate;
+        if (findMapEntry(gUidLastUpdateMapFd, &uid, &uidLastUpdate)) {
+            // The UID was removed by clearUidTimes() since it was returned as a key.
+            if (errno == ENOENT) continue;
+            return false;
+        }
+        if (!updatedSince(uidLastUpdate, *lastUpdate, &newLastUpdate)) continue;
+
+        auto &uidTimes = (*times)[uid];
+        uidTimes.resize(gNPolicies);
+        for (uint32_t i = 0; i < gNPolicies; ++i) uidTimes[i].assign(gPolicyFreqs[i].size(), 0);
+
+        bool found = false;
+        for (uint32_t bucket = 0; bucket <= (maxFreqCount - 1) / FREQS_PER_ENTRY; ++bucket) {
+            const time_key_t key = {.uid = uid, .bucket = bucket};
+            if (findMapEntry(gTisMapFd, &key, vals.data())) {
+                if (errno != ENOENT) return false;
+                continue;
+            }
+            addTisBucket(bucket, vals, uidTimes);
+            found = true;
+        }
+        if (!found) {
+            times->erase(uid);
+            continue;
+        }
+        updatedUids->push_back(uid);
+    } while (prevUid = uid, !getNextMapKey(gUidLastUpdateMapFd, &prevUid, &uid));
+    if (errno != ENOENT) return false;
+    if (newLastUpdate > *lastUpdate) *lastUpdate = newLastUpdate;
+    return true;
+}
+
 static bool verifyConcurrentTimes(const concurrent_time_t &ct) {
     uint64_t activeSum = std::accumulate(ct.active.begin(), ct.active.end(), (uint64_t)0);
     uint64_t policySum = 0;
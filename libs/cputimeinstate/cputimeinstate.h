@@ -30,6 +30,9 @@ std::optional<std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>>>
     getUidsCpuFreqTimes();
 std::optional<std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>>>
     getUidsUpdatedCpuFreqTimes(uint64_t *lastUpdate);
+bool getUidsUpdatedCpuFreqTimes(
+        uint64_t *lastUpdate, std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>> *times,
+        std::vector<uint32_t> *updatedUids);
 std::optional<std::vector<std::vector<uint32_t>>> getCpuFreqs();
 
 struct concurrent_time_t {
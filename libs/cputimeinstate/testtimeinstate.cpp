@@ -209,6 +209,43 @@ TEST_F(TimeInStateTest, AllUidUpdatedTimeInState) {
     }
 }
 
+TEST_F(TimeInStateTest, AllUidUpdatedTimeInStateReusesBuffers) {
+    uint64_t lastUpdate = 0;
+    std::unordered_map<uint32_t, std::vector<std::vector<uint64_t>>> times;
+    std::vector<uint32_t> updatedUids;
+    ASSERT_TRUE(getUidsUpdatedCpuFreqTimes(&lastUpdate, &times, &updatedUids));
+    ASSERT_FALSE(updatedUids.empty());
+    ASSERT_EQ(updatedUids.size(), times.size());
+    ASSERT_NE(lastUpdate, (uint64_t)0);
+    uint64_t oldLastUpdate = lastUpdate;
+    auto oldTimes = times;
+
+    // Sleep briefly to trigger a context switch, ensuring we see at least one update.
+    struct timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = 1000000;
+    nanosleep (&ts, NULL);
+
+    ASSERT_TRUE(getUidsUpdatedCpuFreqTimes(&lastUpdate, &times, &updatedUids));
+    ASSERT_FALSE(updatedUids.empty());
+    ASSERT_LT(updatedUids.size(), times.size());
+    ASSERT_NE(lastUpdate, oldLastUpdate);
+
+    for (const auto &uid : updatedUids) {
+        ASSERT_NE(oldTimes.find(uid), oldTimes.end());
+        ASSERT_NO_FATAL_FAILURE(TestCheckUpdate(oldTimes[uid], times[uid]));
+    }
+
+    auto freqs = getCpuFreqs();
+    ASSERT_TRUE(freqs.has_value());
+    for (const auto &[uid, uidTimes] : times) {
+        ASSERT_EQ(uidTimes.size(), freqs->size());
+        for (size_t i = 0; i < uidTimes.size(); ++i) {
+            ASSERT_EQ(uidTimes[i].size(), (*freqs)[i].size());
+        }
+    }
+}
+
 TEST_F(TimeInStateTest, TotalAndAllUidTimeInStateConsistent) {
     auto allUid = getUidsCpuFreqTimes();
     auto total = getTotalCpuFreqTimes();
@@ -140,4 +140,72 @@ TEST(Future, WaitFor) {
   }
 }
 
+TEST(Future, Wait) {
+  {
+    auto future = ftl::yield(42);
+    future.wait();
+    EXPECT_EQ(future.get(), 42);
+  }
+  {
+    std::packaged_task<int32_t()> get_int([] { return 24; });
+    auto future = ftl::Future(get_int.get_future()).share();
+    std::thread get_thread(std::move(get_int));
+
+    future.wait();
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(future.get(), 24);
+
+    get_thread.join();
+  }
+}
+
+TEST(Future, ThenInlineIfReady) {
+  using namespace std::chrono_literals;
+
+  // Keep in sync with example usage in header file.
+  {
+    auto future = ftl::yield(21).then(ftl::inline_if_ready, [](int x) { return x * 2; });
+    EXPECT_EQ(future.wait_for(0s), std::future_status::ready);
+    EXPECT_EQ(future.get(), 42);
+  }
+
+  // Continuations of ready futures run on the calling thread, including nested futures.
+  {
+    bool called = false;
+    auto future = ftl::yield<std::string>("abc")
+                      .then(ftl::inline_if_ready,
+                            [&called](std::string str) {
+                              called = true;
+                              return ftl::yield(str.size());
+                            })
+                      .then(ftl::inline_if_ready, [](std::size_t size) { return size + 1; });
+
+    EXPECT_TRUE(called);
+    EXPECT_EQ(future.wait_for(0s), std::future_status::ready);
+    EXPECT_EQ(future.get(), 4u);
+  }
+  {
+    auto future = ftl::yield(1).share().then(ftl::inline_if_ready, [](int x) {
+      return ftl::yield(x + 1).share();
+    });
+    EXPECT_EQ(future.get(), 2);
+  }
+
+  // Continuations of pending futures are deferred.
+  {
+    std::promise<int> promise;
+    bool called = false;
+    auto future = ftl::Future(promise.get_future()).then(ftl::inline_if_ready, [&called](int x) {
+      called = true;
+      return x * 2;
+    });
+
+    EXPECT_FALSE(called);
+    promise.set_value(21);
+    EXPECT_FALSE(called);
+    EXPECT_EQ(future.get(), 42);
+    EXPECT_TRUE(called);
+  }
+}
+
 }  // namespace android::test
@@ -19,6 +19,8 @@
 #include <gtest/gtest.h>
 
 #include <cctype>
+#include <random>
+#include <unordered_map>
 #include <string>
 #include <string_view>
 
@@ -442,4 +444,65 @@ TEST(SmallMap, KeyEqual) {
   EXPECT_EQ(map, SmallMap(ftl::init::map<int, char, KeyEqual>(1, '1')(2, '2')));
 }
 
+TEST(SmallMap, Indexed) {
+  SmallMap<int, int, 4> map;
+  constexpr int kSize = 200;
+
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_TRUE(map.try_emplace(i * 7, i).second);
+    EXPECT_FALSE(map.try_emplace(i * 7, -1).second);
+  }
+  ASSERT_EQ(map.size(), static_cast<std::size_t>(kSize));
+
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(map.get(i * 7), i);
+    EXPECT_FALSE(map.contains(i * 7 + 1));
+  }
+
+  // Iteration order is the insertion order.
+  int expected = 0;
+  for (const auto& [k, v] : map) {
+    EXPECT_EQ(v, expected++);
+  }
+
+  EXPECT_NE(map.try_replace(0, 42), map.end());
+  EXPECT_EQ(map.get(0), 42);
+
+  // Copies carry a valid index.
+  const auto copy = map;
+  EXPECT_EQ(copy.get(7 * (kSize - 1)), kSize - 1);
+  EXPECT_EQ(copy, map);
+
+  map.clear();
+  EXPECT_FALSE(map.contains(7));
+  EXPECT_TRUE(map.try_emplace(7, 1).second);
+  EXPECT_EQ(map.get(7), 1);
+}
+
+TEST(SmallMap, IndexedErase) {
+  SmallMap<int, int, 4> map;
+  std::unordered_map<int, int> reference;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> keys(0, 127);
+
+  for (int i = 0; i < 5000; ++i) {
+    const int key = keys(rng);
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(map.erase(key), reference.erase(key) == 1u);
+    } else {
+      EXPECT_EQ(map.try_emplace(key, i).second, reference.try_emplace(key, i).second);
+    }
+
+    ASSERT_EQ(map.size(), reference.size());
+    for (int k = 0; k <= 127; ++k) {
+      const auto it = reference.find(k);
+      if (it == reference.end()) {
+        ASSERT_FALSE(map.contains(k)) << "key " << k;
+      } else {
+        ASSERT_EQ(map.get(k), it->second) << "key " << k;
+      }
+    }
+  }
+}
+
 }  // namespace android::test
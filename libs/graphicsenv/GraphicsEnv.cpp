@@ -340,6 +340,78 @@ std::string GraphicsEnv::getDriverPath() const {
     return mDriverPath;
 }
 
+// Load the first library named prefix + <value of one of the properties> + ".so" from ns, and
+// keep it loaded.
+static bool preloadDriverLibrary(android_namespace_t* ns, const std::string& prefix,
+                                 const std::vector<const char*>& suffixProperties) {
+    const android_dlextinfo dlextinfo = {
+            .flags = ANDROID_DLEXT_USE_NAMESPACE,
+            .library_namespace = ns,
+    };
+    for (auto key : suffixProperties) {
+        auto suffix = base::GetProperty(key, "");
+        if (suffix.empty()) {
+            continue;
+        }
+        std::string name = prefix + suffix + ".so";
+        // The handle is deliberately never closed, so the library is already loaded when the
+        // GLES or Vulkan loader opens it from the same namespace.
+        if (android_dlopen_ext(name.c_str(), RTLD_LOCAL | RTLD_NOW, &dlextinfo)) {
+            ALOGV("Preloaded %s", name.c_str());
+            return true;
+        }
+    }
+    return false;
+}
+
+void GraphicsEnv::preloadDriversAsync(bool preloadGl, bool preloadVulkan) {
+    std::thread preloadThread([this, preloadGl, preloadVulkan]() {
+        ATRACE_NAME("preloadDrivers");
+
+        // Keep in sync with the driver names and properties used by the GLES and Vulkan loaders
+        const std::vector<const char*> glSuffixProperties = {"persist.graphics.egl",
+                                                             "ro.hardware.egl",
+                                                             "ro.board.platform"};
+        const std::vector<const char*> vkSuffixProperties = {"ro.hardware.vulkan",
+                                                             "ro.board.platform"};
+
+        bool useAngle = preloadGl && shouldUseAngle() && !shouldUseSystemAngle();
+        if (useAngle) {
+            if (android_namespace_t* ns = getAngleNamespace()) {
+                ATRACE_NAME("preloadAngle");
+                const android_dlextinfo dlextinfo = {
+                        .flags = ANDROID_DLEXT_USE_NAMESPACE,
+                        .library_namespace = ns,
+                };
+                for (auto name : {"libEGL_angle.so", "libGLESv1_CM_angle.so",
+                                  "libGLESv2_angle.so"}) {
+                    if (!android_dlopen_ext(name, RTLD_LOCAL | RTLD_NOW, &dlextinfo)) {
+                        ALOGV("Failed to preload %s: %s", name, dlerror());
+                    }
+                }
+            }
+        }
+
+        android_namespace_t* ns = getDriverNamespace();
+        if (!ns) {
+            return;
+        }
+        if (preloadGl && !useAngle) {
+            ATRACE_NAME("preloadUpdatableGl");
+            if (!preloadDriverLibrary(ns, "libGLES_", glSuffixProperties)) {
+                for (auto prefix : {"libEGL_", "libGLESv1_CM_", "libGLESv2_"}) {
+                    preloadDriverLibrary(ns, prefix, glSuffixProperties);
+                }
+            }
+        }
+        if (preloadVulkan) {
+            ATRACE_NAME("preloadUpdatableVulkan");
+            preloadDriverLibrary(ns, "vulkan.", vkSuffixProperties);
+        }
+    });
+    preloadThread.detach();
+}
+
 /**
  * APIs for GpuStats
  */
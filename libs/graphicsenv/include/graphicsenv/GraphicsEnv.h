@@ -64,6 +64,13 @@ public:
     // Get the updatable driver namespace.
     android_namespace_t* getDriverNamespace();
     std::string getDriverPath() const;
+    // Load the GLES and/or Vulkan driver libraries this process is going to use on a background
+    // thread, so that loading and relocating them overlaps other startup work instead of
+    // blocking the first GL or Vulkan call. This only does anything for drivers loaded from an
+    // app provided namespace, i.e. an updatable driver or ANGLE from an apk; the system driver is
+    // already preloaded by the zygote. Must be called after the driver has been chosen, i.e.
+    // after setDriverPathAndSphalLibraries and setAngleInfo.
+    void preloadDriversAsync(bool preloadGl, bool preloadVulkan);
 
     /*
      * Apis for GpuStats
@@ -46,6 +46,7 @@
 
 #include <android-base/thread_annotations.h>
 #include <chrono>
+#include <thread>
 
 #include <com_android_graphics_libgui_flags.h>
 
@@ -264,9 +265,11 @@ void BLASTBufferQueue::update(const sp<SurfaceControl>& surface, uint32_t width,
     LOG_ALWAYS_FATAL_IF(surface == nullptr, "BLASTBufferQueue: mSurfaceControl must not be NULL");
 
     std::lock_guard _lock{mMutex};
+    bool preallocateBuffers = false;
     if (mFormat != format) {
         mFormat = format;
         mBufferItemConsumer->setDefaultBufferFormat(convertBufferFormat(format));
+        preallocateBuffers = true;
     }
 
     const bool surfaceControlChanged = !SurfaceControl::isSameSurface(mSurfaceControl, surface);
@@ -293,6 +296,7 @@ void BLASTBufferQueue::update(const sp<SurfaceControl>& surface, uint32_t width,
     if (mRequestedSize != newSize) {
         mRequestedSize.set(newSize);
         mBufferItemConsumer->setDefaultBufferSize(mRequestedSize.width, mRequestedSize.height);
+        preallocateBuffers = true;
         if (mLastBufferInfo.scalingMode != NATIVE_WINDOW_SCALING_MODE_FREEZE) {
             // If the buffer supports scaling, update the frame immediately since the client may
             // want to scale the existing buffer to the new size.
@@ -308,6 +312,16 @@ void BLASTBufferQueue::update(const sp<SurfaceControl>& surface, uint32_t width,
         t.setApplyToken(mApplyToken).apply(false, true);
     }
 
+    // Once the producer has drawn at least one buffer we know which usage it allocates with, so
+    // the buffers for the new size or format can be allocated off the producer's thread. The next
+    // dequeueBuffer calls then find them ready instead of allocating synchronously, which is what
+    // makes the first frames after a rotation or resize hitch.
+    if (preallocateBuffers && mLastBufferInfo.hasBuffer) {
+        std::thread([producer = mProducer, usage = mLastBufferInfo.usage]() {
+            producer->allocateBuffers(0, 0, 0, usage);
+        }).detach();
+    }
+
     /* QTI_BEGIN */
     if (mQtiBBQExtn) {
         mQtiBBQExtn->qtiSetConsumerUsageBitsForRC(mName, mSurfaceControl);
@@ -639,7 +653,7 @@ status_t BLASTBufferQueue::acquireNextBufferLocked(
     Rect crop = computeCrop(bufferItem);
     mLastBufferInfo.update(true /* hasBuffer */, bufferItem.mGraphicBuffer->getWidth(),
                            bufferItem.mGraphicBuffer->getHeight(), bufferItem.mTransform,
-                           bufferItem.mScalingMode, crop);
+                           bufferItem.mScalingMode, crop, bufferItem.mGraphicBuffer->getUsage());
 
     auto releaseBufferCallback =
             std::bind(releaseBufferCallbackThunk, wp<BLASTBufferQueue>(this) /* callbackContext */,
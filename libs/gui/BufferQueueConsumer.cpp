@@ -297,7 +297,7 @@ status_t BufferQueueConsumer::acquireBuffer(BufferItem* outBuffer,
         // We might have freed a slot while dropping old buffers, or the producer
         // may be blocked waiting for the number of buffers in the queue to
         // decrease.
-        mCore->mDequeueCondition.notify_all();
+        mCore->notifyDequeueConditionLocked();
 
         ATRACE_INT(mCore->mConsumerName.c_str(), static_cast<int32_t>(mCore->mQueue.size()));
 #ifndef NO_BINDER
@@ -350,7 +350,7 @@ status_t BufferQueueConsumer::detachBuffer(int slot) {
         mCore->mActiveBuffers.erase(slot);
         mCore->mFreeSlots.insert(slot);
         mCore->clearBufferSlotLocked(slot);
-        mCore->mDequeueCondition.notify_all();
+        mCore->notifyDequeueConditionLocked();
         VALIDATE_CONSISTENCY();
     }
 
@@ -478,6 +478,7 @@ status_t BufferQueueConsumer::releaseBuffer(int slot, uint64_t frameNumber,
     }
 
     sp<IProducerListener> listener;
+    bool wakeDequeuers = false;
     { // Autolock scope
         std::lock_guard<std::mutex> lock(mCore->mMutex);
 
@@ -520,10 +521,16 @@ status_t BufferQueueConsumer::releaseBuffer(int slot, uint64_t frameNumber,
         }
         BQ_LOGV("releaseBuffer: releasing slot %d", slot);
 
-        mCore->mDequeueCondition.notify_all();
+        // Wake a producer blocked in dequeueBuffer only after dropping the
+        // lock, so that it doesn't immediately block again on mMutex.
+        wakeDequeuers = mCore->mDequeueWaiters > 0;
         VALIDATE_CONSISTENCY();
     } // Autolock scope
 
+    if (wakeDequeuers) {
+        mCore->mDequeueCondition.notify_all();
+    }
+
     // Call back without lock held
     if (listener != nullptr) {
         listener->onBufferReleased();
@@ -574,7 +581,7 @@ status_t BufferQueueConsumer::disconnect() {
     mCore->mQueue.clear();
     mCore->freeAllBuffersLocked();
     mCore->mSharedBufferSlot = BufferQueueCore::INVALID_BUFFER_SLOT;
-    mCore->mDequeueCondition.notify_all();
+    mCore->notifyDequeueConditionLocked();
     return NO_ERROR;
 }
 
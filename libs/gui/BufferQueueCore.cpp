@@ -104,6 +104,7 @@ BufferQueueCore::BufferQueueCore()
         mUnusedSlots(),
         mActiveBuffers(),
         mDequeueCondition(),
+        mDequeueWaiters(0),
         mDequeueBufferCannotBlock(false),
         mQueueBufferCanDrop(false),
         mLegacyBufferDrop(true),
@@ -371,6 +372,12 @@ void BufferQueueCore::waitWhileAllocatingLocked(std::unique_lock<std::mutex>& lo
     }
 }
 
+void BufferQueueCore::notifyDequeueConditionLocked() const {
+    if (mDequeueWaiters > 0) {
+        mDequeueCondition.notify_all();
+    }
+}
+
 #if DEBUG_ONLY_CODE
 void BufferQueueCore::validateConsistencyLocked() const {
     static const useconds_t PAUSE_TIME = 0;
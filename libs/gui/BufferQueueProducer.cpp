@@ -112,8 +112,26 @@ BufferQueueProducer::~BufferQueueProducer() {}
 
 status_t BufferQueueProducer::requestBuffer(int slot, sp<GraphicBuffer>* buf) {
     ATRACE_CALL();
-    BQ_LOGV("requestBuffer: slot %d", slot);
     std::lock_guard<std::mutex> lock(mCore->mMutex);
+    return requestBufferLocked(slot, buf);
+}
+
+status_t BufferQueueProducer::requestBuffers(const std::vector<int32_t>& slots,
+                                             std::vector<RequestBufferOutput>* outputs) {
+    ATRACE_CALL();
+    outputs->clear();
+    outputs->reserve(slots.size());
+
+    std::lock_guard<std::mutex> lock(mCore->mMutex);
+    for (int32_t slot : slots) {
+        RequestBufferOutput& output = outputs->emplace_back();
+        output.result = requestBufferLocked(static_cast<int>(slot), &output.buffer);
+    }
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::requestBufferLocked(int slot, sp<GraphicBuffer>* buf) {
+    BQ_LOGV("requestBuffer: slot %d", slot);
 
     if (mCore->mIsAbandoned) {
         BQ_LOGE("requestBuffer: BufferQueue has been abandoned");
@@ -220,7 +238,7 @@ status_t BufferQueueProducer::setMaxDequeuedBufferCount(int maxDequeuedBuffers,
         if (delta < 0) {
             listener = mCore->mConsumerListener;
         }
-        mCore->mDequeueCondition.notify_all();
+        mCore->notifyDequeueConditionLocked();
     } // Autolock scope
 
     // Call back without lock held
@@ -272,7 +290,7 @@ status_t BufferQueueProducer::setAsyncMode(bool async) {
         }
         mCore->mAsyncMode = async;
         VALIDATE_CONSISTENCY();
-        mCore->mDequeueCondition.notify_all();
+        mCore->notifyDequeueConditionLocked();
         if (delta < 0) {
             listener = mCore->mConsumerListener;
         }
@@ -294,6 +312,23 @@ int BufferQueueProducer::getFreeBufferLocked() const {
     return slot;
 }
 
+int BufferQueueProducer::getStaleFreeBufferLocked(uint32_t width, uint32_t height,
+                                                  PixelFormat format, uint64_t usage,
+                                                  const std::bitset<BufferQueueDefs::NUM_BUFFER_SLOTS>&
+                                                          skip) const {
+    for (int slot : mCore->mFreeBuffers) {
+        if (slot == mCore->mSharedBufferSlot || skip.test(slot)) {
+            continue;
+        }
+        const sp<GraphicBuffer>& buffer = mSlots[slot].mGraphicBuffer;
+        if (buffer != nullptr &&
+            buffer->needsReallocation(width, height, format, BQ_LAYER_COUNT, usage)) {
+            return slot;
+        }
+    }
+    return BufferQueueCore::INVALID_BUFFER_SLOT;
+}
+
 int BufferQueueProducer::getFreeSlotLocked() const {
     if (mCore->mFreeSlots.empty()) {
         return BufferQueueCore::INVALID_BUFFER_SLOT;
@@ -394,14 +429,17 @@ status_t BufferQueueProducer::waitForFreeSlotThenRelock(FreeSlotCaller caller,
                     (acquiredCount <= mCore->mMaxAcquiredBufferCount)) {
                 return WOULD_BLOCK;
             }
+            mCore->mDequeueWaiters++;
             if (mDequeueTimeout >= 0) {
                 std::cv_status result = mCore->mDequeueCondition.wait_for(lock,
                         std::chrono::nanoseconds(mDequeueTimeout));
+                mCore->mDequeueWaiters--;
                 if (result == std::cv_status::timeout) {
                     return TIMED_OUT;
                 }
             } else {
                 mCore->mDequeueCondition.wait(lock);
+                mCore->mDequeueWaiters--;
             }
         }
     } // while (tryAgain)
@@ -708,69 +746,109 @@ status_t BufferQueueProducer::dequeueBuffer(int* outSlot, sp<android::Fence>* ou
 
 status_t BufferQueueProducer::detachBuffer(int slot) {
     ATRACE_CALL();
-    ATRACE_BUFFER_INDEX(slot);
-    BQ_LOGV("detachBuffer: slot %d", slot);
 
     sp<IConsumerListener> listener;
-    bool callOnFrameDetached = false;
-    uint64_t bufferId = 0; // Only used if callOnFrameDetached is true
+    std::optional<uint64_t> bufferId;
     {
         std::lock_guard<std::mutex> lock(mCore->mMutex);
-
-        if (mCore->mIsAbandoned) {
-            BQ_LOGE("detachBuffer: BufferQueue has been abandoned");
-            return NO_INIT;
+        if (status_t result = detachBufferLocked(slot, &bufferId); result != NO_ERROR) {
+            return result;
         }
+        listener = mCore->mConsumerListener;
+    }
 
-        if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
-            BQ_LOGE("detachBuffer: BufferQueue has no connected producer");
-            return NO_INIT;
-        }
+    if (listener != nullptr && bufferId) {
+        listener->onFrameDetached(*bufferId);
+    }
 
-        if (mCore->mSharedBufferMode || mCore->mSharedBufferSlot == slot) {
-            BQ_LOGE("detachBuffer: cannot detach a buffer in shared buffer mode");
-            return BAD_VALUE;
-        }
+    if (listener != nullptr) {
+        listener->onBuffersReleased();
+    }
 
-        if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
-            BQ_LOGE("detachBuffer: slot index %d out of range [0, %d)",
-                    slot, BufferQueueDefs::NUM_BUFFER_SLOTS);
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mBufferState.isDequeued()) {
-            // TODO(http://b/140581935): This message is BQ_LOGW because it
-            // often logs when no actionable errors are present. Return to
-            // using BQ_LOGE after ensuring this only logs during errors.
-            BQ_LOGW("detachBuffer: slot %d is not owned by the producer "
-                    "(state = %s)", slot, mSlots[slot].mBufferState.string());
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mRequestBufferCalled) {
-            BQ_LOGE("detachBuffer: buffer in slot %d has not been requested",
-                    slot);
-            return BAD_VALUE;
-        }
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::detachBuffers(const std::vector<int32_t>& slots,
+                                            std::vector<status_t>* results) {
+    ATRACE_CALL();
+    results->clear();
+    results->reserve(slots.size());
 
+    sp<IConsumerListener> listener;
+    std::vector<uint64_t> detachedIds;
+    bool anyDetached = false;
+    {
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        for (int32_t slot : slots) {
+            std::optional<uint64_t> bufferId;
+            status_t result = detachBufferLocked(slot, &bufferId);
+            results->emplace_back(result);
+            if (result == NO_ERROR) {
+                anyDetached = true;
+                if (bufferId) detachedIds.push_back(*bufferId);
+            }
+        }
         listener = mCore->mConsumerListener;
-        auto gb = mSlots[slot].mGraphicBuffer;
-        if (gb != nullptr) {
-            callOnFrameDetached = true;
-            bufferId = gb->getId();
+    }
+
+    if (listener != nullptr) {
+        for (uint64_t bufferId : detachedIds) {
+            listener->onFrameDetached(bufferId);
         }
-        mSlots[slot].mBufferState.detachProducer();
-        mCore->mActiveBuffers.erase(slot);
-        mCore->mFreeSlots.insert(slot);
-        mCore->clearBufferSlotLocked(slot);
-        mCore->mDequeueCondition.notify_all();
-        VALIDATE_CONSISTENCY();
+        if (anyDetached) {
+            listener->onBuffersReleased();
+        }
+    }
+
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::detachBufferLocked(int slot, std::optional<uint64_t>* outBufferId) {
+    ATRACE_BUFFER_INDEX(slot);
+    BQ_LOGV("detachBuffer: slot %d", slot);
+
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("detachBuffer: BufferQueue has been abandoned");
+        return NO_INIT;
     }
 
-    if (listener != nullptr && callOnFrameDetached) {
-        listener->onFrameDetached(bufferId);
+    if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("detachBuffer: BufferQueue has no connected producer");
+        return NO_INIT;
     }
 
-    if (listener != nullptr) {
-        listener->onBuffersReleased();
+    if (mCore->mSharedBufferMode || mCore->mSharedBufferSlot == slot) {
+        BQ_LOGE("detachBuffer: cannot detach a buffer in shared buffer mode");
+        return BAD_VALUE;
+    }
+
+    if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
+        BQ_LOGE("detachBuffer: slot index %d out of range [0, %d)",
+                slot, BufferQueueDefs::NUM_BUFFER_SLOTS);
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mBufferState.isDequeued()) {
+        // TODO(http://b/140581935): This message is BQ_LOGW because it
+        // often logs when no actionable errors are present. Return to
+        // using BQ_LOGE after ensuring this only logs during errors.
+        BQ_LOGW("detachBuffer: slot %d is not owned by the producer "
+                "(state = %s)", slot, mSlots[slot].mBufferState.string());
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mRequestBufferCalled) {
+        BQ_LOGE("detachBuffer: buffer in slot %d has not been requested",
+                slot);
+        return BAD_VALUE;
     }
 
+    auto gb = mSlots[slot].mGraphicBuffer;
+    if (gb != nullptr) {
+        *outBufferId = gb->getId();
+    }
+    mSlots[slot].mBufferState.detachProducer();
+    mCore->mActiveBuffers.erase(slot);
+    mCore->mFreeSlots.insert(slot);
+    mCore->clearBufferSlotLocked(slot);
+    mCore->notifyDequeueConditionLocked();
+    VALIDATE_CONSISTENCY();
     return NO_ERROR;
 }
 
@@ -1108,7 +1186,7 @@ status_t BufferQueueProducer::queueBuffer(int slot,
         }
 
         mCore->mBufferHasBeenQueued = true;
-        mCore->mDequeueCondition.notify_all();
+        mCore->notifyDequeueConditionLocked();
         mCore->mLastQueuedSlot = slot;
 
         output->width = mCore->mDefaultWidth;
@@ -1184,72 +1262,108 @@ status_t BufferQueueProducer::queueBuffer(int slot,
 
 status_t BufferQueueProducer::cancelBuffer(int slot, const sp<Fence>& fence) {
     ATRACE_CALL();
-    BQ_LOGV("cancelBuffer: slot %d", slot);
 
     sp<IConsumerListener> listener;
-    bool callOnFrameCancelled = false;
-    uint64_t bufferId = 0; // Only used if callOnFrameCancelled == true
+    std::optional<uint64_t> bufferId;
     {
         std::lock_guard<std::mutex> lock(mCore->mMutex);
-
-        if (mCore->mIsAbandoned) {
-            BQ_LOGE("cancelBuffer: BufferQueue has been abandoned");
-            return NO_INIT;
+        if (status_t result = cancelBufferLocked(slot, fence, &bufferId); result != NO_ERROR) {
+            return result;
         }
+        listener = mCore->mConsumerListener;
+    }
 
-        if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
-            BQ_LOGE("cancelBuffer: BufferQueue has no connected producer");
-            return NO_INIT;
-        }
+    if (listener != nullptr && bufferId) {
+        listener->onFrameCancelled(*bufferId);
+    }
 
-        if (mCore->mSharedBufferMode) {
-            BQ_LOGE("cancelBuffer: cannot cancel a buffer in shared buffer mode");
-            return BAD_VALUE;
+    return NO_ERROR;
+}
+
+status_t BufferQueueProducer::cancelBuffers(const std::vector<CancelBufferInput>& inputs,
+                                            std::vector<status_t>* results) {
+    ATRACE_CALL();
+    results->clear();
+    results->reserve(inputs.size());
+
+    sp<IConsumerListener> listener;
+    std::vector<uint64_t> cancelledIds;
+    {
+        std::lock_guard<std::mutex> lock(mCore->mMutex);
+        for (const CancelBufferInput& input : inputs) {
+            std::optional<uint64_t> bufferId;
+            status_t result = cancelBufferLocked(input.slot, input.fence, &bufferId);
+            results->emplace_back(result);
+            if (result == NO_ERROR && bufferId) {
+                cancelledIds.push_back(*bufferId);
+            }
         }
+        listener = mCore->mConsumerListener;
+    }
 
-        if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
-            BQ_LOGE("cancelBuffer: slot index %d out of range [0, %d)", slot,
-                    BufferQueueDefs::NUM_BUFFER_SLOTS);
-            return BAD_VALUE;
-        } else if (!mSlots[slot].mBufferState.isDequeued()) {
-            BQ_LOGE("cancelBuffer: slot %d is not owned by the producer "
-                    "(state = %s)",
-                    slot, mSlots[slot].mBufferState.string());
-            return BAD_VALUE;
-        } else if (fence == nullptr) {
-            BQ_LOGE("cancelBuffer: fence is NULL");
-            return BAD_VALUE;
+    if (listener != nullptr) {
+        for (uint64_t bufferId : cancelledIds) {
+            listener->onFrameCancelled(bufferId);
         }
+    }
 
-        mSlots[slot].mBufferState.cancel();
+    return NO_ERROR;
+}
 
-        // After leaving shared buffer mode, the shared buffer will still be around.
-        // Mark it as no longer shared if this operation causes it to be free.
-        if (!mCore->mSharedBufferMode && mSlots[slot].mBufferState.isFree()) {
-            mSlots[slot].mBufferState.mShared = false;
-        }
+status_t BufferQueueProducer::cancelBufferLocked(int slot, const sp<Fence>& fence,
+                                                 std::optional<uint64_t>* outBufferId) {
+    BQ_LOGV("cancelBuffer: slot %d", slot);
 
-        // Don't put the shared buffer on the free list.
-        if (!mSlots[slot].mBufferState.isShared()) {
-            mCore->mActiveBuffers.erase(slot);
-            mCore->mFreeBuffers.push_back(slot);
-        }
+    if (mCore->mIsAbandoned) {
+        BQ_LOGE("cancelBuffer: BufferQueue has been abandoned");
+        return NO_INIT;
+    }
 
-        auto gb = mSlots[slot].mGraphicBuffer;
-        if (gb != nullptr) {
-            callOnFrameCancelled = true;
-            bufferId = gb->getId();
-        }
-        mSlots[slot].mFence = fence;
-        mCore->mDequeueCondition.notify_all();
-        listener = mCore->mConsumerListener;
-        VALIDATE_CONSISTENCY();
+    if (mCore->mConnectedApi == BufferQueueCore::NO_CONNECTED_API) {
+        BQ_LOGE("cancelBuffer: BufferQueue has no connected producer");
+        return NO_INIT;
+    }
+
+    if (mCore->mSharedBufferMode) {
+        BQ_LOGE("cancelBuffer: cannot cancel a buffer in shared buffer mode");
+        return BAD_VALUE;
+    }
+
+    if (slot < 0 || slot >= BufferQueueDefs::NUM_BUFFER_SLOTS) {
+        BQ_LOGE("cancelBuffer: slot index %d out of range [0, %d)", slot,
+                BufferQueueDefs::NUM_BUFFER_SLOTS);
+        return BAD_VALUE;
+    } else if (!mSlots[slot].mBufferState.isDequeued()) {
+        BQ_LOGE("cancelBuffer: slot %d is not owned by the producer "
+                "(state = %s)",
+                slot, mSlots[slot].mBufferState.string());
+        return BAD_VALUE;
+    } else if (fence == nullptr) {
+        BQ_LOGE("cancelBuffer: fence is NULL");
+        return BAD_VALUE;
     }
 
-    if (listener != nullptr && callOnFrameCancelled) {
-        listener->onFrameCancelled(bufferId);
+    mSlots[slot].mBufferState.cancel();
+
+    // After leaving shared buffer mode, the shared buffer will still be around.
+    // Mark it as no longer shared if this operation causes it to be free.
+    if (!mCore->mSharedBufferMode && mSlots[slot].mBufferState.isFree()) {
+        mSlots[slot].mBufferState.mShared = false;
+    }
+
+    // Don't put the shared buffer on the free list.
+    if (!mSlots[slot].mBufferState.isShared()) {
+        mCore->mActiveBuffers.erase(slot);
+        mCore->mFreeBuffers.push_back(slot);
     }
 
+    auto gb = mSlots[slot].mGraphicBuffer;
+    if (gb != nullptr) {
+        *outBufferId = gb->getId();
+    }
+    mSlots[slot].mFence = fence;
+    mCore->notifyDequeueConditionLocked();
+    VALIDATE_CONSISTENCY();
     return NO_ERROR;
 }
 
@@ -1480,7 +1594,7 @@ status_t BufferQueueProducer::disconnect(int api, DisconnectMode mode) {
                     mCore->mConnectedApi = BufferQueueCore::NO_CONNECTED_API;
                     mCore->mConnectedPid = -1;
                     mCore->mSidebandStream.clear();
-                    mCore->mDequeueCondition.notify_all();
+                    mCore->notifyDequeueConditionLocked();
                     mCore->mAutoPrerotation = false;
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_EXTENDEDALLOCATE)
                     mCore->mAdditionalOptions.clear();
@@ -1530,6 +1644,10 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
     ATRACE_CALL();
 
     const bool useDefaultSize = !width && !height;
+    // Slots whose stale buffer has already been replaced by this call, so that a buffer which
+    // still doesn't satisfy needsReallocation (e.g. an implementation-defined format) is not
+    // reallocated forever.
+    std::bitset<BufferQueueDefs::NUM_BUFFER_SLOTS> replacedSlots;
     while (true) {
         size_t newBufferCount = 0;
         uint32_t allocWidth = 0;
@@ -1551,13 +1669,6 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
                 return;
             }
 
-            // Only allocate one buffer at a time to reduce risks of overlapping an allocation from
-            // both allocateBuffers and dequeueBuffer.
-            newBufferCount = mCore->mFreeSlots.empty() ? 0 : 1;
-            if (newBufferCount == 0) {
-                return;
-            }
-
             allocWidth = width > 0 ? width : mCore->mDefaultWidth;
             allocHeight = height > 0 ? height : mCore->mDefaultHeight;
             if (useDefaultSize && mCore->mAutoPrerotation &&
@@ -1567,6 +1678,20 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
 
             allocFormat = format != 0 ? format : mCore->mDefaultBufferFormat;
             allocUsage = usage | mCore->mConsumerUsageBits;
+
+            // Only allocate one buffer at a time to reduce risks of overlapping an allocation from
+            // both allocateBuffers and dequeueBuffer. Once every slot has a buffer, keep going by
+            // replacing free buffers that a dequeue with these attributes would have to reallocate
+            // anyway, e.g. after the default size changed for a resize or rotation.
+            newBufferCount = !mCore->mFreeSlots.empty() ||
+                            getStaleFreeBufferLocked(allocWidth, allocHeight, allocFormat,
+                                                     allocUsage, replacedSlots) !=
+                                    BufferQueueCore::INVALID_BUFFER_SLOT
+                    ? 1
+                    : 0;
+            if (newBufferCount == 0) {
+                return;
+            }
             allocName.assign(mCore->mConsumerName.c_str(), mCore->mConsumerName.size());
 
 #if COM_ANDROID_GRAPHICS_LIBGUI_FLAGS(BQ_EXTENDEDALLOCATE)
@@ -1646,9 +1771,17 @@ void BufferQueueProducer::allocateBuffers(uint32_t width, uint32_t height,
 
             for (size_t i = 0; i < newBufferCount; ++i) {
                 if (mCore->mFreeSlots.empty()) {
-                    BQ_LOGV("allocateBuffers: a slot was occupied while "
-                            "allocating. Dropping allocated buffer.");
-                    continue;
+                    int staleSlot = getStaleFreeBufferLocked(allocWidth, allocHeight, allocFormat,
+                                                             allocUsage, replacedSlots);
+                    if (staleSlot == BufferQueueCore::INVALID_BUFFER_SLOT) {
+                        BQ_LOGV("allocateBuffers: a slot was occupied while "
+                                "allocating. Dropping allocated buffer.");
+                        continue;
+                    }
+                    BQ_LOGV("allocateBuffers: replacing stale buffer in slot %d", staleSlot);
+                    mCore->mFreeBuffers.remove(staleSlot);
+                    mCore->mFreeSlots.insert(staleSlot);
+                    replacedSlots.set(staleSlot);
                 }
                 auto slot = mCore->mFreeSlots.begin();
                 mCore->clearBufferSlotLocked(*slot); // Clean up the slot first
@@ -21,6 +21,8 @@
 #include <gui/TraceUtils.h>
 #include <jni.h>
 
+#include <limits>
+
 #undef LOG_TAG
 #define LOG_TAG "AChoreographer"
 
@@ -171,6 +173,23 @@ void Choreographer::postFrameCallbackDelayed(AChoreographer_frameCallback cb,
     }
 }
 
+void Choreographer::postVsyncCallbackBeforeDeadline(AChoreographer_vsyncCallback vsyncCallback,
+                                                    void* data, nsecs_t leadTime) {
+    nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    FrameCallback callback{nullptr, nullptr, vsyncCallback, data, now, CALLBACK_ANIMATION,
+                           std::max(leadTime, nsecs_t{0})};
+    {
+        std::lock_guard<std::mutex> _l{mLock};
+        mFrameCallbacks.push(callback);
+    }
+    if (std::this_thread::get_id() != mThreadId && mLooper != nullptr) {
+        Message m{MSG_SCHEDULE_VSYNC};
+        mLooper->sendMessage(this, m);
+    } else {
+        scheduleVsync();
+    }
+}
+
 void Choreographer::registerRefreshRateCallback(AChoreographer_refreshRateCallback cb, void* data) {
     std::lock_guard<std::mutex> _l{mLock};
     for (const auto& callback : mRefreshRateCallbacks) {
@@ -287,13 +306,18 @@ void Choreographer::handleRefreshRateUpdates() {
 
 void Choreographer::dispatchCallbacks(const std::vector<FrameCallback>& callbacks,
                                       VsyncEventData vsyncEventData, nsecs_t timestamp) {
+    bool startTimeRegistered = false;
     for (const auto& cb : callbacks) {
         if (cb.vsyncCallback != nullptr) {
             ATRACE_FORMAT("AChoreographer_vsyncCallback %" PRId64,
                           vsyncEventData.preferredVsyncId());
             const ChoreographerFrameCallbackDataImpl frameCallbackData =
                     createFrameCallbackData(timestamp);
-            registerStartTime();
+            // The start times only depend on the vsync, so they are registered once per batch.
+            if (!startTimeRegistered) {
+                registerStartTime();
+                startTimeRegistered = true;
+            }
             mInCallback = true;
             cb.vsyncCallback(reinterpret_cast<const AChoreographerFrameCallbackData*>(
                                      &frameCallbackData),
@@ -311,13 +335,22 @@ void Choreographer::dispatchCallbacks(const std::vector<FrameCallback>& callback
 
 void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t,
                                   VsyncEventData vsyncEventData) {
+    // Callbacks that are still waiting for the previous frame's deadline must not run with the
+    // data of this vsync.
+    dispatchDeferredCallbacks(/*flushAll=*/true);
+
     std::vector<FrameCallback> animationCallbacks{};
     std::vector<FrameCallback> inputCallbacks{};
     {
         std::lock_guard<std::mutex> _l{mLock};
         nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
         while (!mFrameCallbacks.empty() && mFrameCallbacks.top().dueTime < now) {
-            if (mFrameCallbacks.top().callbackType == CALLBACK_INPUT) {
+            const nsecs_t deadlineLeadTime = mFrameCallbacks.top().deadlineLeadTime;
+            const nsecs_t dispatchTime =
+                    vsyncEventData.preferredDeadlineTimestamp() - deadlineLeadTime;
+            if (deadlineLeadTime >= 0 && mLooper != nullptr && dispatchTime > now) {
+                mDeferredCallbacks.emplace_back(dispatchTime, mFrameCallbacks.top());
+            } else if (mFrameCallbacks.top().callbackType == CALLBACK_INPUT) {
                 inputCallbacks.push_back(mFrameCallbacks.top());
             } else {
                 animationCallbacks.push_back(mFrameCallbacks.top());
@@ -335,6 +368,40 @@ void Choreographer::dispatchVsync(nsecs_t timestamp, PhysicalDisplayId, uint32_t
         ATRACE_FORMAT("CALLBACK_ANIMATION");
         dispatchCallbacks(animationCallbacks, vsyncEventData, timestamp);
     }
+
+    if (!mDeferredCallbacks.empty()) {
+        mDeferredCallbacksTimestamp = timestamp;
+        dispatchDeferredCallbacks(/*flushAll=*/false);
+    }
+}
+
+void Choreographer::dispatchDeferredCallbacks(bool flushAll) {
+    if (mDeferredCallbacks.empty()) {
+        return;
+    }
+    const nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    std::vector<FrameCallback> dueCallbacks;
+    nsecs_t nextDispatchTime = std::numeric_limits<nsecs_t>::max();
+    auto it = mDeferredCallbacks.begin();
+    while (it != mDeferredCallbacks.end()) {
+        const auto& [dispatchTime, callback] = *it;
+        if (flushAll || dispatchTime <= now) {
+            dueCallbacks.push_back(callback);
+            it = mDeferredCallbacks.erase(it);
+        } else {
+            nextDispatchTime = std::min(nextDispatchTime, dispatchTime);
+            it++;
+        }
+    }
+    if (!mDeferredCallbacks.empty()) {
+        mLooper->removeMessages(this, MSG_DISPATCH_DEFERRED_CALLBACKS);
+        mLooper->sendMessageAtTime(nextDispatchTime, this,
+                                   Message{MSG_DISPATCH_DEFERRED_CALLBACKS});
+    }
+    if (!dueCallbacks.empty()) {
+        ATRACE_FORMAT("CALLBACK_ANIMATION deferred");
+        dispatchCallbacks(dueCallbacks, mLastVsyncEventData, mDeferredCallbacksTimestamp);
+    }
 }
 
 void Choreographer::dispatchHotplug(nsecs_t, PhysicalDisplayId displayId, bool connected) {
@@ -380,6 +447,9 @@ void Choreographer::handleMessage(const Message& message) {
         case MSG_HANDLE_REFRESH_RATE_UPDATES:
             handleRefreshRateUpdates();
             break;
+        case MSG_DISPATCH_DEFERRED_CALLBACKS:
+            dispatchDeferredCallbacks(/*flushAll=*/false);
+            break;
     }
 }
 
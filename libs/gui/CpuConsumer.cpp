@@ -21,6 +21,7 @@
 #include <gui/CpuConsumer.h>
 
 #include <gui/BufferItem.h>
+#include <ui/GraphicBufferMapper.h>
 #include <utils/Log.h>
 
 #define CC_LOGV(x, ...) ALOGV("[%s] " x, mName.c_str(), ##__VA_ARGS__)
@@ -35,7 +36,8 @@ CpuConsumer::CpuConsumer(const sp<IGraphicBufferConsumer>& bq,
         size_t maxLockedBuffers, bool controlledByApp) :
     ConsumerBase(bq, controlledByApp),
     mMaxLockedBuffers(maxLockedBuffers),
-    mCurrentLockedBuffers(0)
+    mCurrentLockedBuffers(0),
+    mPersistentMappingEnabled(false)
 {
     // Create tracking entries for locked buffers
     mAcquiredBuffers.insertAt(0, maxLockedBuffers);
@@ -88,7 +90,17 @@ static bool isPossiblyYUV(PixelFormat format) {
     }
 }
 
-status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBuffer) const {
+static void setBufferItemInfo(const BufferItem& item, CpuConsumer::LockedBuffer* outBuffer) {
+    outBuffer->crop = item.mCrop;
+    outBuffer->transform = item.mTransform;
+    outBuffer->scalingMode = item.mScalingMode;
+    outBuffer->timestamp = item.mTimestamp;
+    outBuffer->dataSpace = item.mDataSpace;
+    outBuffer->frameNumber = item.mFrameNumber;
+}
+
+status_t CpuConsumer::lockBufferItem(const BufferItem& item, const Rect& bounds,
+                                     LockedBuffer* outBuffer) const {
     android_ycbcr ycbcr = android_ycbcr();
 
     PixelFormat format = item.mGraphicBuffer->getPixelFormat();
@@ -96,7 +108,7 @@ status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBu
     if (isPossiblyYUV(format)) {
         int fenceFd = item.mFence.get() ? item.mFence->dup() : -1;
         status_t err = item.mGraphicBuffer->lockAsyncYCbCr(GraphicBuffer::USAGE_SW_READ_OFTEN,
-                                                           item.mCrop, &ycbcr, fenceFd);
+                                                           bounds, &ycbcr, fenceFd);
         if (err == OK) {
             flexFormat = HAL_PIXEL_FORMAT_YCbCr_420_888;
             if (format != HAL_PIXEL_FORMAT_YCbCr_420_888) {
@@ -120,7 +132,7 @@ status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBu
         void* bufferPointer = nullptr;
         int fenceFd = item.mFence.get() ? item.mFence->dup() : -1;
         status_t err = item.mGraphicBuffer->lockAsync(GraphicBuffer::USAGE_SW_READ_OFTEN,
-                                                      item.mCrop, &bufferPointer, fenceFd);
+                                                      bounds, &bufferPointer, fenceFd);
         if (err != OK) {
             CC_LOGE("Unable to lock buffer for CPU reading: %s (%d)", strerror(-err), err);
             return err;
@@ -139,16 +151,87 @@ status_t CpuConsumer::lockBufferItem(const BufferItem& item, LockedBuffer* outBu
     outBuffer->format = format;
     outBuffer->flexFormat = flexFormat;
 
-    outBuffer->crop = item.mCrop;
-    outBuffer->transform = item.mTransform;
-    outBuffer->scalingMode = item.mScalingMode;
-    outBuffer->timestamp = item.mTimestamp;
-    outBuffer->dataSpace = item.mDataSpace;
-    outBuffer->frameNumber = item.mFrameNumber;
+    setBufferItemInfo(item, outBuffer);
+
+    return OK;
+}
+
+status_t CpuConsumer::lockPersistentLocked(const BufferItem& item, LockedBuffer* outBuffer) {
+    PersistentMapping& mapping = mPersistentMappings[item.mSlot];
+    if (mapping.mGraphicBuffer != item.mGraphicBuffer) {
+        releasePersistentMappingLocked(item.mSlot);
+        // Map the whole buffer, since later frames may use a different crop.
+        status_t err = lockBufferItem(item, item.mGraphicBuffer->getBounds(),
+                                      &mapping.mLockedBuffer);
+        if (err != OK) {
+            return err;
+        }
+        mapping.mGraphicBuffer = item.mGraphicBuffer;
+    } else {
+        if (item.mFence.get()) {
+            status_t err = item.mFence->waitForever("CpuConsumer::lockNextBuffer");
+            if (err != OK) {
+                CC_LOGE("Failed to wait for acquire fence: %s (%d)", strerror(-err), err);
+                return err;
+            }
+        }
+        status_t err =
+                GraphicBufferMapper::get().rereadLockedBuffer(item.mGraphicBuffer->handle);
+        if (err != OK) {
+            CC_LOGE("Unable to reread locked buffer: %s (%d)", strerror(-err), err);
+            return err;
+        }
+    }
 
+    *outBuffer = mapping.mLockedBuffer;
+    setBufferItemInfo(item, outBuffer);
     return OK;
 }
 
+void CpuConsumer::releasePersistentMappingLocked(int slot) {
+    PersistentMapping& mapping = mPersistentMappings[slot];
+    if (mapping.mGraphicBuffer == nullptr) {
+        return;
+    }
+
+    // If the user still holds the buffer, unlockBuffer takes care of unlocking it.
+    bool inUse = false;
+    for (size_t i = 0; i < mMaxLockedBuffers; i++) {
+        AcquiredBuffer& ab = mAcquiredBuffers.editItemAt(i);
+        if (ab.mPersistent && ab.mSlot == slot && ab.mGraphicBuffer == mapping.mGraphicBuffer) {
+            ab.mPersistent = false;
+            inUse = true;
+        }
+    }
+    if (!inUse) {
+        mapping.mGraphicBuffer->unlock();
+    }
+
+    mapping.mGraphicBuffer.clear();
+    mapping.mLockedBuffer = LockedBuffer();
+}
+
+status_t CpuConsumer::setPersistentMappingEnabled(bool enabled) {
+    Mutex::Autolock _l(mMutex);
+
+    if (enabled &&
+        GraphicBufferMapper::get().getMapperVersion() < GraphicBufferMapper::GRALLOC_4) {
+        return INVALID_OPERATION;
+    }
+    if (!enabled) {
+        for (int slot = 0; slot < BufferQueueDefs::NUM_BUFFER_SLOTS; slot++) {
+            releasePersistentMappingLocked(slot);
+        }
+    }
+    mPersistentMappingEnabled = enabled;
+    return OK;
+}
+
+void CpuConsumer::freeBufferLocked(int slotIndex) {
+    releasePersistentMappingLocked(slotIndex);
+    ConsumerBase::freeBufferLocked(slotIndex);
+}
+
 status_t CpuConsumer::lockNextBuffer(LockedBuffer *nativeBuffer) {
     status_t err;
 
@@ -177,7 +260,11 @@ status_t CpuConsumer::lockNextBuffer(LockedBuffer *nativeBuffer) {
         b.mGraphicBuffer = mSlots[b.mSlot].mGraphicBuffer;
     }
 
-    err = lockBufferItem(b, nativeBuffer);
+    if (mPersistentMappingEnabled) {
+        err = lockPersistentLocked(b, nativeBuffer);
+    } else {
+        err = lockBufferItem(b, b.mCrop, nativeBuffer);
+    }
     if (err != OK) {
         return err;
     }
@@ -190,6 +277,7 @@ status_t CpuConsumer::lockNextBuffer(LockedBuffer *nativeBuffer) {
     ab.mSlot = b.mSlot;
     ab.mGraphicBuffer = b.mGraphicBuffer;
     ab.mLockedBufferId = getLockedBufferId(*nativeBuffer);
+    ab.mPersistent = mPersistentMappingEnabled;
 
     mCurrentLockedBuffers++;
 
@@ -210,11 +298,13 @@ status_t CpuConsumer::unlockBuffer(const LockedBuffer &nativeBuffer) {
     AcquiredBuffer& ab = mAcquiredBuffers.editItemAt(lockedIdx);
 
     int fenceFd = -1;
-    status_t err = ab.mGraphicBuffer->unlockAsync(&fenceFd);
-    if (err != OK) {
-        CC_LOGE("%s: Unable to unlock graphic buffer %zd", __FUNCTION__,
-                lockedIdx);
-        return err;
+    if (!ab.mPersistent) {
+        status_t err = ab.mGraphicBuffer->unlockAsync(&fenceFd);
+        if (err != OK) {
+            CC_LOGE("%s: Unable to unlock graphic buffer %zd", __FUNCTION__,
+                    lockedIdx);
+            return err;
+        }
     }
 
     sp<Fence> fence(fenceFd >= 0 ? new Fence(fenceFd) : Fence::NO_FENCE);
@@ -228,6 +228,21 @@ void FrameEventHistory::dump(std::string& outString) const {
     }
 }
 
+// ============================================================================
+// FrameLatencyStats
+// ============================================================================
+
+void FrameLatencyStats::Histogram::add(nsecs_t latency) {
+    // Producer and consumer clocks agree, but the events of a frame may still
+    // be reported slightly out of order.
+    latency = std::max<nsecs_t>(latency, 0);
+    const size_t bucket =
+            std::min(static_cast<size_t>(latency / BUCKET_WIDTH), BUCKET_COUNT - 1);
+    buckets[bucket]++;
+    total += latency;
+    max = std::max(max, latency);
+}
+
 // ============================================================================
 // ProducerFrameEventHistory
 // ============================================================================
@@ -299,8 +314,15 @@ void ProducerFrameEventHistory::applyDelta(
         frame.dequeueReadyTime = d.mDequeueReadyTime;
 
         if (frame.frameNumber != d.mFrameNumber) {
+            // The old frame is about to be overwritten, so this is the last
+            // chance to account for it.
+            if (frame.valid && !recordLatency(frame)) {
+                mLatencyStats.unresolvedFrameCount++;
+            }
+
             // We got a new frame. Initialize some of the fields.
             frame.frameNumber = d.mFrameNumber;
+            frame.latencyRecorded = false;
             frame.acquireFence = FenceTime::NO_FENCE;
             frame.gpuCompositionDoneFence = FenceTime::NO_FENCE;
             frame.displayPresentFence = FenceTime::NO_FENCE;
@@ -316,6 +338,8 @@ void ProducerFrameEventHistory::applyDelta(
         applyFenceDelta(&mReleaseTimeline,
                 &frame.releaseFence, d.mReleaseFence);
     }
+
+    recordLatencies();
 }
 
 void ProducerFrameEventHistory::updateSignalTimes() {
@@ -323,6 +347,41 @@ void ProducerFrameEventHistory::updateSignalTimes() {
     mGpuCompositionDoneTimeline.updateSignalTimes();
     mPresentTimeline.updateSignalTimes();
     mReleaseTimeline.updateSignalTimes();
+
+    recordLatencies();
+}
+
+bool ProducerFrameEventHistory::recordLatency(FrameEvents& frame) {
+    if (frame.latencyRecorded) {
+        return true;
+    }
+    if (!frame.valid || !frame.hasPostedInfo() || !frame.hasLatchInfo() ||
+        !frame.hasDisplayPresentInfo()) {
+        return false;
+    }
+
+    // Only use the cached signal time; the timelines are responsible for
+    // polling the fences.
+    const nsecs_t presentTime = frame.displayPresentFence->getCachedSignalTime();
+    if (presentTime == Fence::SIGNAL_TIME_PENDING) {
+        return false;
+    }
+
+    frame.latencyRecorded = true;
+    mLatencyStats.frameCount++;
+    mLatencyStats.queueToLatch.add(frame.latchTime - frame.postedTime);
+    // Displays without present fences only contribute latch latencies.
+    if (Fence::isValidTimestamp(presentTime)) {
+        mLatencyStats.latchToPresent.add(presentTime - frame.latchTime);
+        mLatencyStats.queueToPresent.add(presentTime - frame.postedTime);
+    }
+    return true;
+}
+
+void ProducerFrameEventHistory::recordLatencies() {
+    for (auto& frame : mFrames) {
+        recordLatency(frame);
+    }
 }
 
 void ProducerFrameEventHistory::applyFenceDelta(FenceTimeline* timeline,
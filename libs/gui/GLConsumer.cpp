@@ -332,9 +332,17 @@ status_t GLConsumer::acquireBufferLocked(BufferItem *item,
     // If item->mGraphicBuffer is not null, this buffer has not been acquired
     // before, so any prior EglImage created is using a stale buffer. This
     // replaces any old EglImage with a new one (using the new buffer).
+    // The BufferQueue also resends a buffer it already sent, e.g. after the
+    // buffer was attached again to the same slot, in which case the EglImage
+    // of the slot is still valid and is kept rather than created again
+    // in-frame.
     if (item->mGraphicBuffer != nullptr) {
         int slot = item->mSlot;
-        mEglSlots[slot].mEglImage = new EglImage(item->mGraphicBuffer);
+        const sp<EglImage>& image = mEglSlots[slot].mEglImage;
+        if (image == nullptr || image->graphicBuffer() == nullptr ||
+            image->graphicBuffer()->getId() != item->mGraphicBuffer->getId()) {
+            mEglSlots[slot].mEglImage = new EglImage(item->mGraphicBuffer);
+        }
     }
 
     return NO_ERROR;
@@ -17,6 +17,8 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+#include <mutex>
+
 #include <utils/Errors.h>
 #include <utils/NativeHandle.h>
 #include <utils/RefBase.h>
@@ -94,6 +96,14 @@ public:
     ~BpGraphicBufferProducer() override;
 
     virtual status_t requestBuffer(int bufferIdx, sp<GraphicBuffer>* buf) {
+        {
+            // Served without a transaction when the buffer came with the dequeueBuffer reply.
+            std::lock_guard lock(mInlineBufferMutex);
+            if (mInlineBuffer != nullptr && mInlineBufferSlot == bufferIdx) {
+                *buf = std::move(mInlineBuffer);
+                return NO_ERROR;
+            }
+        }
         Parcel data, reply;
         data.writeInterfaceToken(IGraphicBufferProducer::getInterfaceDescriptor());
         data.writeInt32(bufferIdx);
@@ -175,7 +185,14 @@ public:
         data.writeInt32(static_cast<int32_t>(format));
         data.writeUint64(usage);
         data.writeBool(getFrameTimestamps);
+        // Asks for a reallocated buffer to be sent with the reply, saving the requestBuffer
+        // transaction that would follow. Older producers ignore this.
+        data.writeBool(true);
 
+        {
+            std::lock_guard lock(mInlineBufferMutex);
+            mInlineBuffer.clear();
+        }
         status_t result = remote()->transact(DEQUEUE_BUFFER, data, &reply);
         if (result != NO_ERROR) {
             return result;
@@ -208,6 +225,15 @@ public:
             }
         }
         result = reply.readInt32();
+        // Older producers reply without the buffer, and readBool then returns false.
+        if (reply.readBool()) {
+            sp<GraphicBuffer> buffer = sp<GraphicBuffer>::make();
+            if (reply.read(*buffer) == NO_ERROR) {
+                std::lock_guard lock(mInlineBufferMutex);
+                mInlineBufferSlot = *buf;
+                mInlineBuffer = std::move(buffer);
+            }
+        }
         return result;
     }
 
@@ -235,6 +261,10 @@ public:
     }
 
     virtual status_t detachBuffer(int slot) {
+        {
+            std::lock_guard lock(mInlineBufferMutex);
+            if (mInlineBufferSlot == slot) mInlineBuffer.clear();
+        }
         Parcel data, reply;
         data.writeInterfaceToken(IGraphicBufferProducer::getInterfaceDescriptor());
         data.writeInt32(slot);
@@ -798,6 +828,12 @@ public:
         return result;
     }
 #endif
+
+private:
+    // The buffer sent with the last dequeueBuffer reply, until requestBuffer takes it.
+    std::mutex mInlineBufferMutex;
+    int mInlineBufferSlot = BufferQueueDefs::NUM_BUFFER_SLOTS;
+    sp<GraphicBuffer> mInlineBuffer;
 };
 
 // Out-of-line virtual method definition to trigger vtable emission in this
@@ -1127,6 +1163,7 @@ status_t BnGraphicBufferProducer::onTransact(
             uint64_t usage = data.readUint64();
             uint64_t bufferAge = 0;
             bool getTimestamps = data.readBool();
+            bool sendBuffer = data.readBool();
 
             int buf = 0;
             sp<Fence> fence = Fence::NO_FENCE;
@@ -1145,6 +1182,15 @@ status_t BnGraphicBufferProducer::onTransact(
                 reply->write(frameTimestamps);
             }
             reply->writeInt32(result);
+            // Older clients do not ask for the buffer, and readBool then returns false.
+            sp<GraphicBuffer> buffer;
+            if (sendBuffer && result >= 0 && (result & BUFFER_NEEDS_REALLOCATION) &&
+                requestBuffer(buf, &buffer) == NO_ERROR && buffer != nullptr) {
+                reply->writeBool(true);
+                reply->write(*buffer);
+            } else {
+                reply->writeBool(false);
+            }
             return NO_ERROR;
         }
         case DEQUEUE_BUFFERS: {
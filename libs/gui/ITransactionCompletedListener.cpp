@@ -38,7 +38,8 @@ enum class Tag : uint32_t {
     ON_RELEASE_BUFFER,
     ON_TRANSACTION_QUEUE_STALLED,
     ON_TRUSTED_PRESENTATION_CHANGED,
-    LAST = ON_TRUSTED_PRESENTATION_CHANGED,
+    ON_RELEASE_BUFFERS,
+    LAST = ON_RELEASE_BUFFERS,
 };
 
 } // Anonymous namespace
@@ -319,6 +320,11 @@ public:
                                                            currentMaxAcquiredBufferCount);
     }
 
+    void onReleaseBuffers(std::vector<ReleaseBufferStats> releases) override {
+        callRemoteAsync<decltype(&ITransactionCompletedListener::
+                                         onReleaseBuffers)>(Tag::ON_RELEASE_BUFFERS, releases);
+    }
+
     void onTransactionQueueStalled(const String8& reason) override {
         callRemoteAsync<
                 decltype(&ITransactionCompletedListener::
@@ -356,6 +362,8 @@ status_t BnTransactionCompletedListener::onTransact(uint32_t code, const Parcel&
         case Tag::ON_TRUSTED_PRESENTATION_CHANGED:
             return callLocalAsync(data, reply,
                                   &ITransactionCompletedListener::onTrustedPresentationChanged);
+        case Tag::ON_RELEASE_BUFFERS:
+            return callLocalAsync(data, reply, &ITransactionCompletedListener::onReleaseBuffers);
     }
 }
 
@@ -407,4 +415,30 @@ status_t ReleaseCallbackId::readFromParcel(const Parcel* input) {
 
 const ReleaseCallbackId ReleaseCallbackId::INVALID_ID = ReleaseCallbackId(0, 0);
 
+status_t ReleaseBufferStats::writeToParcel(Parcel* output) const {
+    SAFE_PARCEL(output->writeParcelable, callbackId);
+    if (releaseFence) {
+        SAFE_PARCEL(output->writeBool, true);
+        SAFE_PARCEL(output->write, *releaseFence);
+    } else {
+        SAFE_PARCEL(output->writeBool, false);
+    }
+    SAFE_PARCEL(output->writeUint32, currentMaxAcquiredBufferCount);
+    return NO_ERROR;
+}
+
+status_t ReleaseBufferStats::readFromParcel(const Parcel* input) {
+    SAFE_PARCEL(input->readParcelable, &callbackId);
+    bool hasFence = false;
+    SAFE_PARCEL(input->readBool, &hasFence);
+    if (hasFence) {
+        releaseFence = sp<Fence>::make();
+        SAFE_PARCEL(input->read, *releaseFence);
+    } else {
+        releaseFence = Fence::NO_FENCE;
+    }
+    SAFE_PARCEL(input->readUint32, &currentMaxAcquiredBufferCount);
+    return NO_ERROR;
+}
+
 }; // namespace android
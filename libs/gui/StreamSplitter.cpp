@@ -15,6 +15,9 @@
  */
 
 #include <inttypes.h>
+#include <pthread.h>
+
+#include <optional>
 
 #define LOG_TAG "StreamSplitter"
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
@@ -58,9 +61,14 @@ status_t StreamSplitter::createSplitter(
 
 StreamSplitter::StreamSplitter(const sp<IGraphicBufferConsumer>& inputQueue)
       : mIsAbandoned(false), mMutex(), mReleaseCondition(),
-        mOutstandingBuffers(0), mInput(inputQueue), mOutputs(), mBuffers() {}
+        mOutstandingBuffers(0), mInput(inputQueue), mOutputs(),
+        mMaxBuffersPerOutput(0), mOutputQueues(), mBuffers() {}
 
 StreamSplitter::~StreamSplitter() {
+    for (size_t i = 0; i < mOutputQueues.size(); ++i) {
+        mOutputQueues[i]->stop();
+    }
+
     mInput->consumerDisconnect();
     Vector<sp<IGraphicBufferProducer> >::iterator output = mOutputs.begin();
     for (; output != mOutputs.end(); ++output) {
@@ -81,21 +89,47 @@ status_t StreamSplitter::addOutput(
 
     Mutex::Autolock lock(mMutex);
 
+    sp<OutputQueue> queue;
+    if (mMaxBuffersPerOutput > 0) {
+        queue = new OutputQueue(this, outputQueue, mMaxBuffersPerOutput);
+    }
+
     IGraphicBufferProducer::QueueBufferOutput queueBufferOutput;
-    sp<OutputListener> listener(new OutputListener(this, outputQueue));
+    sp<OutputListener> listener(new OutputListener(this, outputQueue, queue));
     IInterface::asBinder(outputQueue)->linkToDeath(listener);
     status_t status = outputQueue->connect(listener, NATIVE_WINDOW_API_CPU,
             /* producerControlledByApp */ false, &queueBufferOutput);
     if (status != NO_ERROR) {
         ALOGE("addOutput: failed to connect (%d)", status);
+        if (queue != nullptr) {
+            queue->stop();
+        }
         return status;
     }
 
     mOutputs.push_back(outputQueue);
+    if (queue != nullptr) {
+        mOutputQueues.push_back(queue);
+    }
 
     return NO_ERROR;
 }
 
+status_t StreamSplitter::setIndependentOutputs(size_t maxBuffersPerOutput) {
+    if (maxBuffersPerOutput == 0) {
+        ALOGE("setIndependentOutputs: maxBuffersPerOutput must not be 0");
+        return BAD_VALUE;
+    }
+
+    Mutex::Autolock lock(mMutex);
+    if (!mOutputs.empty()) {
+        ALOGE("setIndependentOutputs: outputs have already been added");
+        return INVALID_OPERATION;
+    }
+    mMaxBuffersPerOutput = maxBuffersPerOutput;
+    return NO_ERROR;
+}
+
 void StreamSplitter::setName(const String8 &name) {
     Mutex::Autolock lock(mMutex);
     mInput->setConsumerName(name);
@@ -111,8 +145,9 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
     // input queue, slowing down its producer.
 
     // If there are too many outstanding buffers, we block until a buffer is
-    // released back to the input in onBufferReleased
-    while (mOutstandingBuffers >= MAX_OUTSTANDING_BUFFERS) {
+    // released back to the input in onBufferReleased. Independent outputs
+    // apply their own limit instead.
+    while (mMaxBuffersPerOutput == 0 && mOutstandingBuffers >= MAX_OUTSTANDING_BUFFERS) {
         mReleaseCondition.wait(mMutex);
 
         // If the splitter is abandoned while we are waiting, the release
@@ -148,6 +183,18 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
             static_cast<int32_t>(bufferItem.mScalingMode),
             bufferItem.mTransform, bufferItem.mFence);
 
+    if (mMaxBuffersPerOutput > 0) {
+        const uint64_t bufferId = bufferItem.mGraphicBuffer->getId();
+        for (size_t i = 0; i < mOutputQueues.size(); ++i) {
+            if (!mOutputQueues[i]->tryEnqueue(bufferId, bufferItem.mGraphicBuffer, queueInput)) {
+                ALOGV("output %p is full, skipping buffer %#" PRIx64,
+                      mOutputQueues[i]->getOutput().get(), bufferId);
+                onBufferDoneLocked(bufferId, Fence::NO_FENCE);
+            }
+        }
+        return;
+    }
+
     // Attach and queue the buffer to each of the outputs
     Vector<sp<IGraphicBufferProducer> >::iterator output = mOutputs.begin();
     for (; output != mOutputs.end(); ++output) {
@@ -189,11 +236,19 @@ void StreamSplitter::onFrameAvailable(const BufferItem& /* item */) {
 void StreamSplitter::onBufferReleasedByOutput(
         const sp<IGraphicBufferProducer>& from) {
     ATRACE_CALL();
-    Mutex::Autolock lock(mMutex);
+    // Independent outputs detach without mMutex so that one slow output doesn't
+    // hold up the others. mMaxBuffersPerOutput can't change once outputs exist.
+    std::optional<Mutex::Autolock> lock;
+    if (mMaxBuffersPerOutput == 0) {
+        lock.emplace(mMutex);
+    }
 
     sp<GraphicBuffer> buffer;
     sp<Fence> fence;
     status_t status = from->detachNextBuffer(&buffer, &fence);
+    if (!lock) {
+        lock.emplace(mMutex);
+    }
     if (status == NO_INIT) {
         // If we just discovered that this output has been abandoned, note that,
         // but we can't do anything else, since buffer is invalid
@@ -207,15 +262,19 @@ void StreamSplitter::onBufferReleasedByOutput(
     ALOGV("detached buffer %#" PRIx64 " from output %p",
           buffer->getId(), from.get());
 
-    const sp<BufferTracker>& tracker = mBuffers.editValueFor(buffer->getId());
+    onBufferDoneLocked(buffer->getId(), fence);
+}
+
+void StreamSplitter::onBufferDoneLocked(uint64_t bufferId, const sp<Fence>& releaseFence) {
+    const sp<BufferTracker>& tracker = mBuffers.editValueFor(bufferId);
 
     // Merge the release fence of the incoming buffer so that the fence we send
     // back to the input includes all of the outputs' fences
-    tracker->mergeFence(fence);
+    tracker->mergeFence(releaseFence);
 
     // Check to see if this is the last outstanding reference to this buffer
     size_t releaseCount = tracker->incrementReleaseCountLocked();
-    ALOGV("buffer %#" PRIx64 " reference count %zu (of %zu)", buffer->getId(),
+    ALOGV("buffer %#" PRIx64 " reference count %zu (of %zu)", bufferId,
             releaseCount, mOutputs.size());
     if (releaseCount < mOutputs.size()) {
         return;
@@ -224,13 +283,13 @@ void StreamSplitter::onBufferReleasedByOutput(
     // If we've been abandoned, we can't return the buffer to the input, so just
     // stop tracking it and move on
     if (mIsAbandoned) {
-        mBuffers.removeItem(buffer->getId());
+        mBuffers.removeItem(bufferId);
         return;
     }
 
     // Attach and release the buffer back to the input
     int consumerSlot;
-    status = mInput->attachBuffer(&consumerSlot, tracker->getBuffer());
+    status_t status = mInput->attachBuffer(&consumerSlot, tracker->getBuffer());
     LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
             "attaching buffer to input failed (%d)", status);
 
@@ -239,11 +298,11 @@ void StreamSplitter::onBufferReleasedByOutput(
     LOG_ALWAYS_FATAL_IF(status != NO_ERROR,
             "releasing buffer to input failed (%d)", status);
 
-    ALOGV("released buffer %#" PRIx64 " to input", buffer->getId());
+    ALOGV("released buffer %#" PRIx64 " to input", bufferId);
 
     // We no longer need to track the buffer once it has been returned to the
     // input
-    mBuffers.removeItem(buffer->getId());
+    mBuffers.removeItem(bufferId);
 
     // Notify any waiting onFrameAvailable calls
     --mOutstandingBuffers;
@@ -259,14 +318,103 @@ void StreamSplitter::onAbandonedLocked() {
     mReleaseCondition.broadcast();
 }
 
+void StreamSplitter::queueToOutput(OutputQueue* output, uint64_t bufferId,
+                                   const sp<GraphicBuffer>& buffer,
+                                   const IGraphicBufferProducer::QueueBufferInput& input) {
+    ATRACE_CALL();
+    const sp<IGraphicBufferProducer>& producer = output->getOutput();
+
+    int slot;
+    status_t status = producer->attachBuffer(&slot, buffer);
+    if (status == NO_ERROR) {
+        IGraphicBufferProducer::QueueBufferOutput queueOutput;
+        status = producer->queueBuffer(slot, input, &queueOutput);
+    }
+    if (status == NO_ERROR) {
+        ALOGV("queued buffer %#" PRIx64 " to output %p", bufferId, producer.get());
+        return;
+    }
+    LOG_ALWAYS_FATAL_IF(status != NO_INIT, "queueing buffer to output failed (%d)", status);
+
+    // If we just discovered that this output has been abandoned, note that and
+    // count the buffer as released by it so that we still release this buffer
+    // eventually
+    output->onBufferDone();
+    Mutex::Autolock lock(mMutex);
+    onAbandonedLocked();
+    onBufferDoneLocked(bufferId, Fence::NO_FENCE);
+}
+
+StreamSplitter::OutputQueue::OutputQueue(StreamSplitter* splitter,
+                                         const sp<IGraphicBufferProducer>& output,
+                                         size_t maxBuffers)
+      : mSplitter(splitter), mOutput(output), mMaxBuffers(maxBuffers),
+        mOutstanding(0), mStopped(false) {
+    mThread = std::thread([this] { threadMain(); });
+}
+
+bool StreamSplitter::OutputQueue::tryEnqueue(
+        uint64_t bufferId, const sp<GraphicBuffer>& buffer,
+        const IGraphicBufferProducer::QueueBufferInput& input) {
+    Mutex::Autolock lock(mMutex);
+    if (mStopped || mOutstanding >= mMaxBuffers) {
+        return false;
+    }
+    ++mOutstanding;
+    mPending.push_back({bufferId, buffer, input});
+    mCondition.signal();
+    return true;
+}
+
+void StreamSplitter::OutputQueue::onBufferDone() {
+    Mutex::Autolock lock(mMutex);
+    if (mOutstanding > 0) {
+        --mOutstanding;
+    }
+}
+
+void StreamSplitter::OutputQueue::stop() {
+    {
+        Mutex::Autolock lock(mMutex);
+        mStopped = true;
+        mCondition.signal();
+    }
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+}
+
+void StreamSplitter::OutputQueue::threadMain() {
+    pthread_setname_np(pthread_self(), "StreamSplitter");
+    while (true) {
+        PendingBuffer next;
+        {
+            Mutex::Autolock lock(mMutex);
+            while (mPending.empty() && !mStopped) {
+                mCondition.wait(mMutex);
+            }
+            if (mStopped) {
+                return;
+            }
+            next = std::move(mPending.front());
+            mPending.pop_front();
+        }
+        mSplitter->queueToOutput(this, next.mBufferId, next.mBuffer, next.mInput);
+    }
+}
+
 StreamSplitter::OutputListener::OutputListener(
         const sp<StreamSplitter>& splitter,
-        const sp<IGraphicBufferProducer>& output)
-      : mSplitter(splitter), mOutput(output) {}
+        const sp<IGraphicBufferProducer>& output,
+        const sp<OutputQueue>& queue)
+      : mSplitter(splitter), mOutput(output), mQueue(queue) {}
 
 StreamSplitter::OutputListener::~OutputListener() {}
 
 void StreamSplitter::OutputListener::onBufferReleased() {
+    if (mQueue != nullptr) {
+        mQueue->onBufferDone();
+    }
     mSplitter->onBufferReleasedByOutput(mOutput);
 }
 
@@ -342,7 +342,7 @@ status_t Surface::getFrameTimestamps(uint64_t frameNumber,
         nsecs_t* outLatchTime, nsecs_t* outFirstRefreshStartTime,
         nsecs_t* outLastRefreshStartTime, nsecs_t* outGpuCompositionDoneTime,
         nsecs_t* outDisplayPresentTime, nsecs_t* outDequeueReadyTime,
-        nsecs_t* outReleaseTime) {
+        nsecs_t* outReleaseTime, bool updateFromConsumer) {
     ATRACE_CALL();
 
     Mutex::Autolock lock(mMutex);
@@ -365,7 +365,7 @@ status_t Surface::getFrameTimestamps(uint64_t frameNumber,
     }
 
     // Update our cache of events if the requested events are not available.
-    if (checkConsumerForUpdates(events, mLastFrameNumber,
+    if (updateFromConsumer && checkConsumerForUpdates(events, mLastFrameNumber,
             outLatchTime, outFirstRefreshStartTime, outLastRefreshStartTime,
             outGpuCompositionDoneTime, outDisplayPresentTime,
             outDequeueReadyTime, outReleaseTime)) {
@@ -421,6 +421,27 @@ status_t Surface::getFrameTimestamps(uint64_t frameNumber,
     return NO_ERROR;
 }
 
+status_t Surface::getFrameLatencyStats(FrameLatencyStats* outStats, bool reset) {
+    ATRACE_CALL();
+
+    if (outStats == nullptr) {
+        return BAD_VALUE;
+    }
+
+    Mutex::Autolock lock(mMutex);
+
+    if (!mEnableFrameTimestamps) {
+        return INVALID_OPERATION;
+    }
+
+    mFrameEventHistory->updateSignalTimes();
+    *outStats = mFrameEventHistory->getLatencyStats();
+    if (reset) {
+        mFrameEventHistory->resetLatencyStats();
+    }
+    return NO_ERROR;
+}
+
 // Deprecated(b/242763577): to be removed, this method should not be used
 // The reason this method still exists here is to support compiled vndk
 // Surface support should not be tied to the display
@@ -1488,6 +1509,9 @@ int Surface::perform(int operation, va_list args)
     case NATIVE_WINDOW_GET_FRAME_TIMESTAMPS:
         res = dispatchGetFrameTimestamps(args);
         break;
+    case NATIVE_WINDOW_GET_CACHED_FRAME_TIMESTAMPS:
+        res = dispatchGetCachedFrameTimestamps(args);
+        break;
     case NATIVE_WINDOW_GET_WIDE_COLOR_SUPPORT:
         res = dispatchGetWideColorSupport(args);
         break;
@@ -1734,6 +1758,24 @@ int Surface::dispatchGetFrameTimestamps(va_list args) {
             outDequeueReadyTime, outReleaseTime);
 }
 
+int Surface::dispatchGetCachedFrameTimestamps(va_list args) {
+    uint64_t frameId = va_arg(args, uint64_t);
+    nsecs_t* outRequestedPresentTime = va_arg(args, int64_t*);
+    nsecs_t* outAcquireTime = va_arg(args, int64_t*);
+    nsecs_t* outLatchTime = va_arg(args, int64_t*);
+    nsecs_t* outFirstRefreshStartTime = va_arg(args, int64_t*);
+    nsecs_t* outLastRefreshStartTime = va_arg(args, int64_t*);
+    nsecs_t* outGpuCompositionDoneTime = va_arg(args, int64_t*);
+    nsecs_t* outDisplayPresentTime = va_arg(args, int64_t*);
+    nsecs_t* outDequeueReadyTime = va_arg(args, int64_t*);
+    nsecs_t* outReleaseTime = va_arg(args, int64_t*);
+    return getFrameTimestamps(frameId,
+            outRequestedPresentTime, outAcquireTime, outLatchTime,
+            outFirstRefreshStartTime, outLastRefreshStartTime,
+            outGpuCompositionDoneTime, outDisplayPresentTime,
+            outDequeueReadyTime, outReleaseTime, false /* updateFromConsumer */);
+}
+
 int Surface::dispatchGetWideColorSupport(va_list args) {
     bool* outSupport = va_arg(args, bool*);
     return getWideColorSupport(outSupport);
@@ -546,6 +546,32 @@ void TransactionCompletedListener::onReleaseBuffer(ReleaseCallbackId callbackId,
     callback(callbackId, releaseFence, optionalMaxAcquiredBufferCount);
 }
 
+void TransactionCompletedListener::onReleaseBuffers(std::vector<ReleaseBufferStats> releases) {
+    std::vector<ReleaseBufferCallback> callbacks;
+    callbacks.reserve(releases.size());
+    {
+        std::scoped_lock<std::mutex> lock(mMutex);
+        for (const auto& release : releases) {
+            callbacks.push_back(popReleaseBufferCallbackLocked(release.callbackId));
+        }
+    }
+    for (size_t i = 0; i < releases.size(); i++) {
+        const auto& release = releases[i];
+        if (!callbacks[i]) {
+            ALOGE("Could not call release buffer callback, buffer not found %s",
+                  release.callbackId.to_string().c_str());
+            continue;
+        }
+        std::optional<uint32_t> optionalMaxAcquiredBufferCount =
+                release.currentMaxAcquiredBufferCount == UINT_MAX
+                ? std::nullopt
+                : std::make_optional<uint32_t>(release.currentMaxAcquiredBufferCount);
+        callbacks[i](release.callbackId,
+                     release.releaseFence ? release.releaseFence : Fence::NO_FENCE,
+                     optionalMaxAcquiredBufferCount);
+    }
+}
+
 ReleaseBufferCallback TransactionCompletedListener::popReleaseBufferCallbackLocked(
         const ReleaseCallbackId& callbackId) {
     ReleaseBufferCallback callback;
@@ -975,14 +1001,14 @@ SurfaceComposerClient::Transaction& SurfaceComposerClient::Transaction::merge(Tr
     }
     mMergedTransactionIds.insert(mMergedTransactionIds.begin(), other.mId);
 
-    for (auto const& [handle, composerState] : other.mComposerStates) {
-        if (mComposerStates.count(handle) == 0) {
-            mComposerStates[handle] = composerState;
-        } else {
+    // other is cleared below, so its states can be moved rather than copied.
+    for (auto& [handle, composerState] : other.mComposerStates) {
+        auto [it, inserted] = mComposerStates.try_emplace(handle, std::move(composerState));
+        if (!inserted) {
             if (composerState.state.what & layer_state_t::eBufferChanged) {
-                releaseBufferIfOverwriting(mComposerStates[handle].state);
+                releaseBufferIfOverwriting(it->second.state);
             }
-            mComposerStates[handle].state.merge(composerState.state);
+            it->second.state.merge(composerState.state);
         }
     }
 
@@ -995,17 +1021,18 @@ SurfaceComposerClient::Transaction& SurfaceComposerClient::Transaction::merge(Tr
         }
     }
 
-    for (const auto& [listener, callbackInfo] : other.mListenerCallbacks) {
+    const sp<ITransactionCompletedListener> currentProcessListener =
+            TransactionCompletedListener::getIInstance();
+    for (auto& [listener, callbackInfo] : other.mListenerCallbacks) {
         auto& [callbackIds, surfaceControls] = callbackInfo;
-        mListenerCallbacks[listener].callbackIds.insert(std::make_move_iterator(
-                                                                callbackIds.begin()),
-                                                        std::make_move_iterator(callbackIds.end()));
+        auto& mergedCallbackInfo = mListenerCallbacks[listener];
+        mergedCallbackInfo.callbackIds.insert(std::make_move_iterator(callbackIds.begin()),
+                                              std::make_move_iterator(callbackIds.end()));
 
-        mListenerCallbacks[listener].surfaceControls.insert(surfaceControls.begin(),
-                                                            surfaceControls.end());
+        mergedCallbackInfo.surfaceControls.insert(surfaceControls.begin(), surfaceControls.end());
 
-        auto& currentProcessCallbackInfo =
-                mListenerCallbacks[TransactionCompletedListener::getIInstance()];
+        // References into an unordered_map stay valid when it rehashes.
+        auto& currentProcessCallbackInfo = mListenerCallbacks[currentProcessListener];
         currentProcessCallbackInfo.surfaceControls
                 .insert(std::make_move_iterator(surfaceControls.begin()),
                         std::make_move_iterator(surfaceControls.end()));
@@ -1017,9 +1044,8 @@ SurfaceComposerClient::Transaction& SurfaceComposerClient::Transaction::merge(Tr
         }
     }
 
-    for (const auto& cacheId : other.mUncacheBuffers) {
-        mUncacheBuffers.push_back(cacheId);
-    }
+    mUncacheBuffers.insert(mUncacheBuffers.end(), other.mUncacheBuffers.begin(),
+                           other.mUncacheBuffers.end());
 
     mInputWindowCommands.merge(other.mInputWindowCommands);
 
@@ -1183,8 +1209,9 @@ status_t SurfaceComposerClient::Transaction::apply(bool synchronous, bool oneWay
 
     bool hasListenerCallbacks = !mListenerCallbacks.empty();
     std::vector<ListenerCallbacks> listenerCallbacks;
+    listenerCallbacks.reserve(mListenerCallbacks.size());
     // For every listener with registered callbacks
-    for (const auto& [listener, callbackInfo] : mListenerCallbacks) {
+    for (auto& [listener, callbackInfo] : mListenerCallbacks) {
         auto& [callbackIds, surfaceControls] = callbackInfo;
         if (callbackIds.empty()) {
             continue;
@@ -1214,6 +1241,7 @@ status_t SurfaceComposerClient::Transaction::apply(bool synchronous, bool oneWay
     Vector<DisplayState> displayStates;
     uint32_t flags = 0;
 
+    composerStates.setCapacity(mComposerStates.size());
     for (auto const& kv : mComposerStates) {
         composerStates.add(kv.second);
     }
@@ -1277,6 +1305,99 @@ status_t SurfaceComposerClient::Transaction::apply(bool synchronous, bool oneWay
     return NO_ERROR;
 }
 
+namespace {
+
+// Tracks the transactions that were applied with flow control and not yet committed by
+// SurfaceFlinger, for each apply token. The committed callbacks act as credits: a new transaction
+// is only sent when fewer than MAX_IN_FLIGHT transactions are outstanding, and is coalesced into a
+// pending transaction otherwise.
+class TransactionFlowController {
+public:
+    static TransactionFlowController& getInstance() {
+        // Leaked on purpose: committed callbacks may arrive on binder threads during exit.
+        static TransactionFlowController* sInstance = new TransactionFlowController();
+        return *sInstance;
+    }
+
+    status_t apply(const sp<IBinder>& applyToken, SurfaceComposerClient::Transaction& t) {
+        {
+            std::scoped_lock lock(mMutex);
+            TokenState& state = mStates[applyToken];
+            if (state.inFlight >= MAX_IN_FLIGHT) {
+                if (!state.pending) {
+                    state.pending = std::make_unique<SurfaceComposerClient::Transaction>();
+                }
+                state.pending->merge(std::move(t));
+                return NO_ERROR;
+            }
+            state.inFlight++;
+        }
+        return applyInFlight(applyToken, t);
+    }
+
+private:
+    static constexpr size_t MAX_IN_FLIGHT = 2;
+
+    struct TokenState {
+        size_t inFlight = 0;
+        std::unique_ptr<SurfaceComposerClient::Transaction> pending;
+    };
+
+    // The caller must have already counted t as in flight.
+    status_t applyInFlight(const sp<IBinder>& applyToken, SurfaceComposerClient::Transaction& t) {
+        t.setApplyToken(applyToken);
+        t.addTransactionCommittedCallback(
+                [applyToken](void* /*context*/, nsecs_t /*latchTime*/,
+                             const sp<Fence>& /*presentFence*/,
+                             const std::vector<SurfaceControlStats>& /*stats*/) {
+                    getInstance().onCommitted(applyToken);
+                },
+                /*callbackContext=*/nullptr);
+        const status_t status = t.apply(/*synchronous=*/false, /*oneWay=*/true);
+        if (status != NO_ERROR) {
+            // The transaction was not sent, so its committed callback will never arrive.
+            onCommitted(applyToken);
+        }
+        return status;
+    }
+
+    void onCommitted(const sp<IBinder>& applyToken) {
+        std::unique_ptr<SurfaceComposerClient::Transaction> pending;
+        {
+            std::scoped_lock lock(mMutex);
+            auto it = mStates.find(applyToken);
+            if (it == mStates.end()) {
+                return;
+            }
+            TokenState& state = it->second;
+            state.inFlight--;
+            if (state.pending) {
+                pending = std::move(state.pending);
+                state.inFlight++;
+            } else if (state.inFlight == 0) {
+                mStates.erase(it);
+            }
+        }
+        if (pending) {
+            applyInFlight(applyToken, *pending);
+        }
+    }
+
+    std::mutex mMutex;
+    std::unordered_map<sp<IBinder>, TokenState, SurfaceComposerClient::IBinderHash> mStates
+            GUARDED_BY(mMutex);
+};
+
+} // namespace
+
+status_t SurfaceComposerClient::Transaction::applyWithFlowControl() {
+    if (mStatus != NO_ERROR) {
+        return mStatus;
+    }
+    const sp<IBinder> applyToken = mApplyToken ? mApplyToken : getDefaultApplyToken();
+    return TransactionFlowController::getInstance().apply(applyToken, *this);
+}
+
 sp<IBinder> SurfaceComposerClient::Transaction::sApplyToken = new BBinder();
 
 std::mutex SurfaceComposerClient::Transaction::sApplyTokenMutex;
@@ -1368,17 +1489,14 @@ void SurfaceComposerClient::Transaction::setEarlyWakeupEnd() {
 layer_state_t* SurfaceComposerClient::Transaction::getLayerState(const sp<SurfaceControl>& sc) {
     auto handle = sc->getLayerStateHandle();
 
-    if (mComposerStates.count(handle) == 0) {
-        // we don't have it, add an initialized layer_state to our list
-        ComposerState s;
-
-        s.state.surface = handle;
-        s.state.layerId = sc->getLayerId();
-
-        mComposerStates[handle] = s;
+    auto [it, inserted] = mComposerStates.try_emplace(handle);
+    if (inserted) {
+        // we didn't have it, initialize the new layer_state in our list
+        it->second.state.surface = handle;
+        it->second.state.layerId = sc->getLayerId();
     }
 
-    return &(mComposerStates[handle].state);
+    return &(it->second.state);
 }
 
 void SurfaceComposerClient::Transaction::registerSurfaceControlForCallback(
@@ -2351,6 +2469,13 @@ void SurfaceComposerClient::Transaction::setDisplaySize(const sp<IBinder>& token
     s.what |= DisplayState::eDisplaySizeChanged;
 }
 
+void SurfaceComposerClient::Transaction::setDisplayRequestedRefreshRate(const sp<IBinder>& token,
+                                                                        float requestedRefreshRate) {
+    DisplayState& s(getDisplayState(token));
+    s.requestedRefreshRate = requestedRefreshRate;
+    s.what |= DisplayState::eRequestedRefreshRateChanged;
+}
+
 // copied from FrameTimelineInfo::merge()
 void SurfaceComposerClient::Transaction::mergeFrameTimelineInfo(FrameTimelineInfo& t,
                                                                 const FrameTimelineInfo& other) {
@@ -14,9 +14,14 @@
  * limitations under the License.
  */
 
+#define LOG_TAG "WindowInfosListenerReporter"
+
+#include <inttypes.h>
+
 #include <android/gui/ISurfaceComposer.h>
 #include <gui/AidlStatusUtil.h>
 #include <gui/WindowInfosListenerReporter.h>
+#include <log/log.h>
 #include "gui/WindowInfosUpdate.h"
 
 namespace android {
@@ -45,6 +50,7 @@ status_t WindowInfosListenerReporter::addWindowInfosListener(
             if (status == OK) {
                 mWindowInfosPublisher = std::move(listenerInfo.windowInfosPublisher);
                 mListenerId = listenerInfo.listenerId;
+                requestDeltasLocked();
             }
         }
 
@@ -78,6 +84,7 @@ status_t WindowInfosListenerReporter::removeWindowInfosListener(
             // stale values
             mLastWindowInfos.clear();
             mLastDisplayInfos.clear();
+            mLastVersion = 0;
         }
 
         if (status == OK) {
@@ -92,19 +99,44 @@ binder::Status WindowInfosListenerReporter::onWindowInfosChanged(
         const gui::WindowInfosUpdate& update) {
     std::unordered_set<sp<WindowInfosListener>, gui::SpHash<WindowInfosListener>>
             windowInfosListeners;
+    // Local listeners always get the complete window list.
+    std::optional<gui::WindowInfosUpdate> fullUpdate;
 
     {
         std::scoped_lock lock(mListenersMutex);
+        if (update.isDelta()) {
+            if (!mResyncPending && update.baseVersion == mLastVersion) {
+                fullUpdate = update;
+                if (fullUpdate->applyDelta(mLastWindowInfos) != OK) {
+                    fullUpdate.reset();
+                }
+            }
+            if (!fullUpdate) {
+                // Drop the update and wait for the complete one requested here (or earlier).
+                if (!mResyncPending) {
+                    ALOGW("Received window infos delta against version %" PRIu64
+                          " but have %" PRIu64 ", resyncing",
+                          update.baseVersion, mLastVersion);
+                    requestDeltasLocked();
+                }
+                mWindowInfosPublisher->ackWindowInfosReceived(update.vsyncId, mListenerId);
+                return binder::Status::ok();
+            }
+        }
+        mResyncPending = false;
+
         for (auto listener : mWindowInfosListeners) {
             windowInfosListeners.insert(listener);
         }
 
-        mLastWindowInfos = update.windowInfos;
-        mLastDisplayInfos = update.displayInfos;
+        const gui::WindowInfosUpdate& current = fullUpdate ? *fullUpdate : update;
+        mLastWindowInfos = current.windowInfos;
+        mLastDisplayInfos = current.displayInfos;
+        mLastVersion = current.version;
     }
 
     for (auto listener : windowInfosListeners) {
-        listener->onWindowInfosChanged(update);
+        listener->onWindowInfosChanged(fullUpdate ? *fullUpdate : update);
     }
 
     mWindowInfosPublisher->ackWindowInfosReceived(update.vsyncId, mListenerId);
@@ -119,7 +151,17 @@ void WindowInfosListenerReporter::reconnect(const sp<gui::ISurfaceComposer>& com
         composerService->addWindowInfosListener(this, &listenerInfo);
         mWindowInfosPublisher = std::move(listenerInfo.windowInfosPublisher);
         mListenerId = listenerInfo.listenerId;
+        mLastVersion = 0;
+        requestDeltasLocked();
+    }
+}
+
+void WindowInfosListenerReporter::requestDeltasLocked() {
+    if (mWindowInfosPublisher == nullptr) {
+        return;
     }
+    mResyncPending = true;
+    mWindowInfosPublisher->requestWindowInfosDeltas(mListenerId);
 }
 
 } // namespace android
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <unordered_map>
+
 #include <gui/WindowInfosUpdate.h>
 #include <private/gui/ParcelUtils.h>
 
@@ -44,6 +46,13 @@ status_t WindowInfosUpdate::readFromParcel(const android::Parcel* parcel) {
     SAFE_PARCEL(parcel->readInt64, &vsyncId);
     SAFE_PARCEL(parcel->readInt64, &timestamp);
 
+    SAFE_PARCEL(parcel->readUint64, &version);
+    SAFE_PARCEL(parcel->readUint64, &baseVersion);
+    windowIndices.clear();
+    if (isDelta()) {
+        SAFE_PARCEL(parcel->readInt32Vector, &windowIndices);
+    }
+
     return OK;
 }
 
@@ -66,6 +75,74 @@ status_t WindowInfosUpdate::writeToParcel(android::Parcel* parcel) const {
     SAFE_PARCEL(parcel->writeInt64, vsyncId);
     SAFE_PARCEL(parcel->writeInt64, timestamp);
 
+    SAFE_PARCEL(parcel->writeUint64, version);
+    SAFE_PARCEL(parcel->writeUint64, baseVersion);
+    if (isDelta()) {
+        SAFE_PARCEL(parcel->writeInt32Vector, windowIndices);
+    }
+
+    return OK;
+}
+
+WindowInfosUpdate WindowInfosUpdate::makeDelta(const WindowInfosUpdate& base,
+                                               const WindowInfosUpdate& update) {
+    std::unordered_map<int32_t, int32_t> baseIndexById;
+    baseIndexById.reserve(base.windowInfos.size());
+    for (size_t i = 0; i < base.windowInfos.size(); i++) {
+        baseIndexById.try_emplace(base.windowInfos[i].id, static_cast<int32_t>(i));
+    }
+
+    WindowInfosUpdate delta{{}, update.displayInfos, update.vsyncId, update.timestamp};
+    delta.version = update.version;
+    delta.baseVersion = base.version;
+    delta.windowIndices.reserve(update.windowInfos.size());
+    for (const WindowInfo& windowInfo : update.windowInfos) {
+        auto it = baseIndexById.find(windowInfo.id);
+        if (it != baseIndexById.end() && base.windowInfos[it->second] == windowInfo) {
+            delta.windowIndices.push_back(it->second);
+        } else {
+            delta.windowIndices.push_back(kChangedWindow);
+            delta.windowInfos.push_back(windowInfo);
+        }
+    }
+    return delta;
+}
+
+status_t WindowInfosUpdate::applyDelta(const std::vector<WindowInfo>& baseWindowInfos) {
+    if (!isDelta()) {
+        return OK;
+    }
+
+    size_t changedCount = 0;
+    for (int32_t index : windowIndices) {
+        if (index == kChangedWindow) {
+            changedCount++;
+        } else if (index < 0 || static_cast<size_t>(index) >= baseWindowInfos.size()) {
+            ALOGE("%s: Delta references window %d of a base with %zu windows", __func__, index,
+                  baseWindowInfos.size());
+            return BAD_VALUE;
+        }
+    }
+    if (changedCount != windowInfos.size()) {
+        ALOGE("%s: Delta has %zu changed windows but references %zu", __func__,
+              windowInfos.size(), changedCount);
+        return BAD_VALUE;
+    }
+
+    std::vector<WindowInfo> fullWindowInfos;
+    fullWindowInfos.reserve(windowIndices.size());
+    auto changedIt = windowInfos.begin();
+    for (int32_t index : windowIndices) {
+        if (index == kChangedWindow) {
+            fullWindowInfos.push_back(std::move(*changedIt++));
+        } else {
+            fullWindowInfos.push_back(baseWindowInfos[static_cast<size_t>(index)]);
+        }
+    }
+
+    windowInfos = std::move(fullWindowInfos);
+    baseVersion = 0;
+    windowIndices.clear();
     return OK;
 }
 
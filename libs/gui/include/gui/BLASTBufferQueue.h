@@ -248,14 +248,17 @@ private:
         // and the buffer will scale to fit the new size.
         uint32_t scalingMode = NATIVE_WINDOW_SCALING_MODE_SCALE_TO_WINDOW;
         Rect crop;
+        // Usage the buffer was allocated with, used to preallocate buffers for a new size.
+        uint64_t usage = 0;
 
         void update(bool hasBuffer, uint32_t width, uint32_t height, uint32_t transform,
-                    uint32_t scalingMode, const Rect& crop) {
+                    uint32_t scalingMode, const Rect& crop, uint64_t usage) {
             this->hasBuffer = hasBuffer;
             this->width = width;
             this->height = height;
             this->transform = transform;
             this->scalingMode = scalingMode;
+            this->usage = usage;
             if (!crop.isEmpty()) {
                 this->crop = crop;
             } else {
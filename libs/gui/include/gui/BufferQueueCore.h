@@ -133,6 +133,11 @@ private:
     // waitWhileAllocatingLocked blocks until mIsAllocating is false.
     void waitWhileAllocatingLocked(std::unique_lock<std::mutex>& lock) const;
 
+    // notifyDequeueConditionLocked wakes any thread blocked on
+    // mDequeueCondition. Broadcasting is a futex syscall even with no waiters,
+    // so it is skipped unless mDequeueWaiters is non-zero.
+    void notifyDequeueConditionLocked() const;
+
 #if DEBUG_ONLY_CODE
     // validateConsistencyLocked ensures that the free lists are in sync with
     // the information stored in mSlots
@@ -226,6 +231,10 @@ private:
     // synchronous mode.
     mutable std::condition_variable mDequeueCondition;
 
+    // mDequeueWaiters is the number of threads currently waiting on
+    // mDequeueCondition.
+    mutable int mDequeueWaiters;
+
     // mDequeueBufferCannotBlock indicates whether dequeueBuffer is allowed to
     // block. This flag is set during connect when both the producer and
     // consumer are controlled by the application.
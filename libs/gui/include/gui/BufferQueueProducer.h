@@ -23,6 +23,8 @@
 #ifndef ANDROID_GUI_BUFFERQUEUEPRODUCER_H
 #define ANDROID_GUI_BUFFERQUEUEPRODUCER_H
 
+#include <bitset>
+
 #include <gui/AdditionalOptions.h>
 #include <gui/BufferQueueDefs.h>
 
@@ -68,6 +70,10 @@ public:
     // flags indicating that previously-returned buffers are no longer valid.
     virtual status_t requestBuffer(int slot, sp<GraphicBuffer>* buf);
 
+    // See IGraphicBufferProducer::requestBuffers. Takes mCore->mMutex once for the whole batch.
+    status_t requestBuffers(const std::vector<int32_t>& slots,
+                            std::vector<RequestBufferOutput>* outputs) override;
+
     // see IGraphicsBufferProducer::setMaxDequeuedBufferCount
     virtual status_t setMaxDequeuedBufferCount(int maxDequeuedBuffers);
 
@@ -117,6 +123,11 @@ public:
     // See IGraphicBufferProducer::detachBuffer
     virtual status_t detachBuffer(int slot);
 
+    // See IGraphicBufferProducer::detachBuffers. Takes mCore->mMutex once for the whole batch
+    // and calls IConsumerListener::onBuffersReleased at most once.
+    status_t detachBuffers(const std::vector<int32_t>& slots,
+                           std::vector<status_t>* results) override;
+
     // See IGraphicBufferProducer::detachNextBuffer
     virtual status_t detachNextBuffer(sp<GraphicBuffer>* outBuffer,
             sp<Fence>* outFence);
@@ -149,6 +160,10 @@ public:
     // will usually be the one obtained from dequeueBuffer.
     virtual status_t cancelBuffer(int slot, const sp<Fence>& fence);
 
+    // See IGraphicBufferProducer::cancelBuffers. Takes mCore->mMutex once for the whole batch.
+    status_t cancelBuffers(const std::vector<CancelBufferInput>& inputs,
+                           std::vector<status_t>* results) override;
+
     // Query native window attributes.  The "what" values are enumerated in
     // window.h (e.g. NATIVE_WINDOW_FORMAT).
     virtual int query(int what, int* outValue);
@@ -251,9 +266,26 @@ private:
     // BufferQueueCore::INVALID_BUFFER_SLOT otherwise
     int getFreeSlotLocked() const;
 
+    // Returns a slot on the free buffer list, other than the shared buffer slot
+    // or one set in skip, whose buffer would need to be reallocated to satisfy
+    // the given attributes. Returns BufferQueueCore::INVALID_BUFFER_SLOT if there
+    // is none.
+    int getStaleFreeBufferLocked(uint32_t width, uint32_t height, PixelFormat format,
+                                 uint64_t usage,
+                                 const std::bitset<BufferQueueDefs::NUM_BUFFER_SLOTS>& skip) const;
+
     void addAndGetFrameTimestamps(const NewFrameEventsEntry* newTimestamps,
             FrameEventHistoryDelta* outDelta);
 
+    // Bodies of requestBuffer, detachBuffer and cancelBuffer, shared with their batched
+    // versions. Must be called with mCore->mMutex held. Consumer listener callbacks are left to
+    // the caller, which makes them after releasing the lock; outBufferId is set to the id of the
+    // buffer in the slot, if there is one.
+    status_t requestBufferLocked(int slot, sp<GraphicBuffer>* buf);
+    status_t detachBufferLocked(int slot, std::optional<uint64_t>* outBufferId);
+    status_t cancelBufferLocked(int slot, const sp<Fence>& fence,
+                                std::optional<uint64_t>* outBufferId);
+
     // waitForFreeSlotThenRelock finds the oldest slot in the FREE state. It may
     // block if there are no available slots and we are not in non-blocking
     // mode (producer and consumer controlled by the application). If it blocks,
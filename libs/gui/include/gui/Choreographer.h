@@ -40,6 +40,9 @@ struct FrameCallback {
     void* data;
     nsecs_t dueTime;
     CallbackType callbackType;
+    // If non-negative, the callback is delayed until this long before the deadline of the
+    // preferred frame timeline, instead of running as soon as the vsync is received.
+    nsecs_t deadlineLeadTime = -1;
 
     inline bool operator<(const FrameCallback& rhs) const {
         // Note that this is intentionally flipped because we want callbacks due sooner to be at
@@ -85,6 +88,13 @@ public:
                                   AChoreographer_frameCallback64 cb64,
                                   AChoreographer_vsyncCallback vsyncCallback, void* data,
                                   nsecs_t delay, CallbackType callbackType);
+    // Posts a vsync callback that runs leadTime before the deadline of the next frame, rather
+    // than when the vsync arrives. Apps whose frames are short can use this to sample input later
+    // and shorten the latency from input to display. The callback runs as soon as the vsync
+    // arrives if the deadline is already closer than leadTime, or if the choreographer has no
+    // looper.
+    void postVsyncCallbackBeforeDeadline(AChoreographer_vsyncCallback vsyncCallback, void* data,
+                                         nsecs_t leadTime);
     void registerRefreshRateCallback(AChoreographer_refreshRateCallback cb, void* data)
             EXCLUDES(gChoreographers.lock);
     void unregisterRefreshRateCallback(AChoreographer_refreshRateCallback cb, void* data);
@@ -99,6 +109,7 @@ public:
         MSG_SCHEDULE_CALLBACKS = 0,
         MSG_SCHEDULE_VSYNC = 1,
         MSG_HANDLE_REFRESH_RATE_UPDATES = 2,
+        MSG_DISPATCH_DEFERRED_CALLBACKS = 3,
     };
     virtual void handleMessage(const Message& message) override;
 
@@ -118,6 +129,9 @@ private:
                        VsyncEventData vsyncEventData) override;
     void dispatchCallbacks(const std::vector<FrameCallback>&, VsyncEventData vsyncEventData,
                            nsecs_t timestamp);
+    // Dispatches the deferred callbacks that are due by now, or all of them if flushAll is set,
+    // and schedules a message for the remaining ones.
+    void dispatchDeferredCallbacks(bool flushAll);
     void dispatchHotplug(nsecs_t timestamp, PhysicalDisplayId displayId, bool connected) override;
     void dispatchHotplugConnectionError(nsecs_t timestamp, int32_t connectionError) override;
     void dispatchModeChanged(nsecs_t timestamp, PhysicalDisplayId displayId, int32_t modeId,
@@ -142,6 +156,11 @@ private:
     VsyncEventData mLastVsyncEventData;
     bool mInCallback = false;
 
+    // Callbacks of the last vsync that wait for their deadline lead time, and the time at which
+    // each should run. Only accessed on the looper thread.
+    std::vector<std::pair<nsecs_t, FrameCallback>> mDeferredCallbacks;
+    nsecs_t mDeferredCallbacksTimestamp = 0;
+
     const sp<Looper> mLooper;
     const std::thread::id mThreadId;
 
@@ -111,6 +111,19 @@ class CpuConsumer : public ConsumerBase
     // lockNextBuffer.
     status_t unlockBuffer(const LockedBuffer &nativeBuffer);
 
+    // Enables or disables persistent mappings, which are off by default. When
+    // enabled, a buffer slot is locked for CPU reading the first time it is
+    // acquired and stays locked until the slot is freed or persistent mappings
+    // are disabled again. Later lockNextBuffer calls on that slot wait for the
+    // acquire fence and have gralloc invalidate the CPU's view of the buffer
+    // instead of locking it again, and unlockBuffer doesn't unlock it.
+    //
+    // Returns INVALID_OPERATION if the mapper HAL can't reread a locked buffer.
+    status_t setPersistentMappingEnabled(bool enabled);
+
+  protected:
+    void freeBufferLocked(int slotIndex) override;
+
   private:
     // Maximum number of buffers that can be locked at a time
     const size_t mMaxLockedBuffers;
@@ -125,27 +138,45 @@ class CpuConsumer : public ConsumerBase
         int mSlot;
         sp<GraphicBuffer> mGraphicBuffer;
         uintptr_t mLockedBufferId;
+        // Whether the buffer is locked through mPersistentMappings and must
+        // be left locked by unlockBuffer.
+        bool mPersistent;
 
         AcquiredBuffer() :
                 mSlot(BufferQueue::INVALID_BUFFER_SLOT),
-                mLockedBufferId(kUnusedId) {
+                mLockedBufferId(kUnusedId),
+                mPersistent(false) {
         }
 
         void reset() {
             mSlot = BufferQueue::INVALID_BUFFER_SLOT;
             mGraphicBuffer.clear();
             mLockedBufferId = kUnusedId;
+            mPersistent = false;
         }
     };
 
+    // A slot's buffer and the mapping it stays locked with while persistent
+    // mappings are enabled.
+    struct PersistentMapping {
+        sp<GraphicBuffer> mGraphicBuffer;
+        LockedBuffer mLockedBuffer;
+    };
+
     size_t findAcquiredBufferLocked(uintptr_t id) const;
 
-    status_t lockBufferItem(const BufferItem& item, LockedBuffer* outBuffer) const;
+    status_t lockBufferItem(const BufferItem& item, const Rect& bounds,
+                            LockedBuffer* outBuffer) const;
+    status_t lockPersistentLocked(const BufferItem& item, LockedBuffer* outBuffer);
+    void releasePersistentMappingLocked(int slot);
 
     Vector<AcquiredBuffer> mAcquiredBuffers;
 
     // Count of currently locked buffers
     size_t mCurrentLockedBuffers;
+
+    bool mPersistentMappingEnabled;
+    PersistentMapping mPersistentMappings[BufferQueueDefs::NUM_BUFFER_SLOTS];
 };
 
 } // namespace android
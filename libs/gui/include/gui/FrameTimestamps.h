@@ -79,6 +79,9 @@ struct FrameEvents {
     nsecs_t lastRefreshStartTime{TIMESTAMP_PENDING};
     nsecs_t dequeueReadyTime{TIMESTAMP_PENDING};
 
+    // Set once the producer has folded this frame into its FrameLatencyStats.
+    bool latencyRecorded{false};
+
     std::shared_ptr<FenceTime> acquireFence{FenceTime::NO_FENCE};
     std::shared_ptr<FenceTime> gpuCompositionDoneFence{FenceTime::NO_FENCE};
     std::shared_ptr<FenceTime> displayPresentFence{FenceTime::NO_FENCE};
@@ -108,6 +111,33 @@ protected:
 };
 
 
+// Latency histograms accumulated by the producer from the frame events it
+// already receives with each queueBuffer. Reading them requires no IPC.
+struct FrameLatencyStats {
+    static constexpr size_t BUCKET_COUNT = 32;
+    // Each bucket covers 1ms. The last bucket also collects all longer
+    // latencies.
+    static constexpr nsecs_t BUCKET_WIDTH = 1'000'000;
+
+    struct Histogram {
+        std::array<uint32_t, BUCKET_COUNT> buckets{};
+        nsecs_t total{0};
+        nsecs_t max{0};
+
+        void add(nsecs_t latency);
+    };
+
+    // Frames whose latch and present results were both known.
+    uint64_t frameCount{0};
+    // Frames that left the history before their latch or present result was
+    // known, e.g. because they were dropped.
+    uint64_t unresolvedFrameCount{0};
+
+    Histogram queueToLatch;
+    Histogram latchToPresent;
+    Histogram queueToPresent;
+};
+
 // The producer's interface to FrameEventHistory
 class ProducerFrameEventHistory : public FrameEventHistory {
 public:
@@ -131,7 +161,15 @@ public:
 
     void updateSignalTimes();
 
+    const FrameLatencyStats& getLatencyStats() const { return mLatencyStats; }
+    void resetLatencyStats() { mLatencyStats = {}; }
+
 protected:
+    // Records the frame in mLatencyStats if its results are all known.
+    // Returns whether the frame is (now) recorded.
+    bool recordLatency(FrameEvents& frame);
+    void recordLatencies();
+
     void applyFenceDelta(FenceTimeline* timeline,
             std::shared_ptr<FenceTime>* dst,
             const FenceTime::Snapshot& src) const;
@@ -151,6 +189,8 @@ protected:
     FenceTimeline mGpuCompositionDoneTimeline;
     FenceTimeline mPresentTimeline;
     FenceTimeline mReleaseTimeline;
+
+    FrameLatencyStats mLatencyStats;
 };
 
 
@@ -27,6 +27,7 @@
 #include <ui/Fence.h>
 #include <utils/Timers.h>
 
+#include <climits>
 #include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
@@ -89,6 +90,27 @@ struct ReleaseBufferCallbackIdHash {
     }
 };
 
+/**
+ * A single buffer release, as delivered by ITransactionCompletedListener::onReleaseBuffers.
+ * currentMaxAcquiredBufferCount is UINT_MAX when SurfaceFlinger has no value to report.
+ */
+class ReleaseBufferStats : public Parcelable {
+public:
+    ReleaseBufferStats() = default;
+    ReleaseBufferStats(ReleaseCallbackId callbackId, sp<Fence> releaseFence,
+                       uint32_t currentMaxAcquiredBufferCount)
+          : callbackId(callbackId),
+            releaseFence(std::move(releaseFence)),
+            currentMaxAcquiredBufferCount(currentMaxAcquiredBufferCount) {}
+
+    status_t writeToParcel(Parcel* output) const override;
+    status_t readFromParcel(const Parcel* input) override;
+
+    ReleaseCallbackId callbackId;
+    sp<Fence> releaseFence;
+    uint32_t currentMaxAcquiredBufferCount = UINT_MAX;
+};
+
 class FrameEventHistoryStats : public Parcelable {
 public:
     status_t writeToParcel(Parcel* output) const override;
@@ -206,6 +228,10 @@ public:
     virtual void onReleaseBuffer(ReleaseCallbackId callbackId, sp<Fence> releaseFence,
                                  uint32_t currentMaxAcquiredBufferCount) = 0;
 
+    // Same as onReleaseBuffer, for all buffers released to this listener in one frame. The
+    // releases are in the order SurfaceFlinger released the buffers.
+    virtual void onReleaseBuffers(std::vector<ReleaseBufferStats> releases) = 0;
+
     virtual void onTransactionQueueStalled(const String8& name) = 0;
 
     virtual void onTrustedPresentationChanged(int id, bool inTrustedPresentationState) = 0;
@@ -427,6 +427,7 @@ struct DisplayState {
         eDisplayProjectionChanged = 0x04,
         eDisplaySizeChanged = 0x08,
         eFlagsChanged = 0x10,
+        eRequestedRefreshRateChanged = 0x20,
 
         eAllChanged = ~0u
     };
@@ -475,6 +476,10 @@ struct DisplayState {
     uint32_t width = 0;
     uint32_t height = 0;
 
+    // Exclusive to virtual displays: the rate at which the display is composed, see
+    // ISurfaceComposer::createVirtualDisplay. 0 composes on every frame.
+    float requestedRefreshRate = 0.0f;
+
     status_t write(Parcel& output) const;
     status_t read(const Parcel& input);
 };
@@ -18,6 +18,7 @@
 #define ANDROID_GUI_STREAMSPLITTER_H
 
 #include <gui/IConsumerListener.h>
+#include <gui/IGraphicBufferProducer.h>
 #include <gui/IProducerListener.h>
 
 #include <utils/Condition.h>
@@ -25,6 +26,10 @@
 #include <utils/Mutex.h>
 #include <utils/StrongPointer.h>
 
+#include <atomic>
+#include <deque>
+#include <thread>
+
 namespace android {
 
 class GraphicBuffer;
@@ -66,6 +71,19 @@ public:
     // setName sets the consumer name of the input queue
     void setName(const String8& name);
 
+    // setIndependentOutputs makes the splitter service each output on its own
+    // thread instead of queueing every buffer to all outputs in turn. Each
+    // output may then hold at most maxBuffersPerOutput buffers that it has
+    // not released yet. While an output is at that limit, new input buffers
+    // skip it, so a slow output drops frames instead of stalling the input
+    // and every other output. The input is no longer limited to
+    // MAX_OUTSTANDING_BUFFERS; it must have enough buffers for all outputs.
+    //
+    // This must be called before any outputs are added. BAD_VALUE is
+    // returned if maxBuffersPerOutput is 0, and INVALID_OPERATION if outputs
+    // have already been added.
+    status_t setIndependentOutputs(size_t maxBuffersPerOutput);
+
 private:
     // From IConsumerListener
     //
@@ -104,6 +122,59 @@ private:
     // acquire. This must be called with mMutex locked.
     void onAbandonedLocked();
 
+    // Records that one output is done with the buffer, and releases it back
+    // to the input once every output is. This must be called with mMutex
+    // locked.
+    void onBufferDoneLocked(uint64_t bufferId, const sp<Fence>& releaseFence);
+
+    class OutputQueue;
+
+    // Attaches and queues one buffer to an independent output. Called on the
+    // output's thread without mMutex held.
+    void queueToOutput(OutputQueue* output, uint64_t bufferId, const sp<GraphicBuffer>& buffer,
+                       const IGraphicBufferProducer::QueueBufferInput& input);
+
+    // The pending buffers and thread of one output in independent mode (see
+    // setIndependentOutputs). mMutex is never held while this queue's lock
+    // is taken by its thread, and the thread itself holds no lock while
+    // talking to the output.
+    class OutputQueue : public RefBase {
+    public:
+        OutputQueue(StreamSplitter* splitter, const sp<IGraphicBufferProducer>& output,
+                    size_t maxBuffers);
+
+        const sp<IGraphicBufferProducer>& getOutput() const { return mOutput; }
+
+        // Returns false without queueing if the output is at its limit.
+        bool tryEnqueue(uint64_t bufferId, const sp<GraphicBuffer>& buffer,
+                        const IGraphicBufferProducer::QueueBufferInput& input);
+        // Called once for each buffer the output is done with.
+        void onBufferDone();
+        void stop();
+
+    private:
+        struct PendingBuffer {
+            uint64_t mBufferId;
+            sp<GraphicBuffer> mBuffer;
+            IGraphicBufferProducer::QueueBufferInput mInput;
+        };
+
+        void threadMain();
+
+        // The splitter joins this thread before it is destroyed.
+        StreamSplitter* const mSplitter;
+        const sp<IGraphicBufferProducer> mOutput;
+        const size_t mMaxBuffers;
+
+        Mutex mMutex;
+        Condition mCondition;
+        std::deque<PendingBuffer> mPending;
+        // Buffers pending here or queued to the output and not yet released
+        size_t mOutstanding;
+        bool mStopped;
+        std::thread mThread;
+    };
+
     // This is a thin wrapper class that lets us determine which BufferQueue
     // the IProducerListener::onBufferReleased callback is associated with. We
     // create one of these per output BufferQueue, and then pass the producer
@@ -112,7 +183,8 @@ private:
                            public IBinder::DeathRecipient {
     public:
         OutputListener(const sp<StreamSplitter>& splitter,
-                const sp<IGraphicBufferProducer>& output);
+                const sp<IGraphicBufferProducer>& output,
+                const sp<OutputQueue>& queue = nullptr);
         virtual ~OutputListener();
 
         // From IProducerListener
@@ -124,6 +196,7 @@ private:
     private:
         sp<StreamSplitter> mSplitter;
         sp<IGraphicBufferProducer> mOutput;
+        sp<OutputQueue> mQueue;
     };
 
     class BufferTracker : public LightRefBase<BufferTracker> {
@@ -173,6 +246,12 @@ private:
     sp<IGraphicBufferConsumer> mInput;
     Vector<sp<IGraphicBufferProducer> > mOutputs;
 
+    // Set by setIndependentOutputs; 0 means outputs are serviced in turn from
+    // onFrameAvailable.
+    size_t mMaxBuffersPerOutput;
+    // One per entry in mOutputs when mMaxBuffersPerOutput is nonzero
+    Vector<sp<OutputQueue> > mOutputQueues;
+
     // Map of GraphicBuffer IDs (GraphicBuffer::getId()) to buffer tracking
     // objects (which are mostly for counting how many outputs have released the
     // buffer, but also contain merged release fences).
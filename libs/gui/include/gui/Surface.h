@@ -215,13 +215,23 @@ public:
             nsecs_t* compositeDeadline, nsecs_t* compositeInterval,
             nsecs_t* compositeToPresentLatency);
 
-    // See IGraphicBufferProducer::getFrameTimestamps
+    // See IGraphicBufferProducer::getFrameTimestamps. If updateFromConsumer is
+    // false, only the timestamps already received by the producer are
+    // returned, and missing ones are reported as pending.
     status_t getFrameTimestamps(uint64_t frameNumber,
             nsecs_t* outRequestedPresentTime, nsecs_t* outAcquireTime,
             nsecs_t* outLatchTime, nsecs_t* outFirstRefreshStartTime,
             nsecs_t* outLastRefreshStartTime, nsecs_t* outGlCompositionDoneTime,
             nsecs_t* outDisplayPresentTime, nsecs_t* outDequeueReadyTime,
-            nsecs_t* outReleaseTime);
+            nsecs_t* outReleaseTime, bool updateFromConsumer = true);
+
+    /* Copies the latency histograms accumulated from the frame timestamps of
+     * all frames queued so far. Frame timestamps must be enabled. This never
+     * calls into the consumer; frames become visible here as their events
+     * arrive with later queueBuffer calls. If reset is true, the histograms
+     * are cleared after the copy.
+     */
+    status_t getFrameLatencyStats(FrameLatencyStats* outStats, bool reset);
 
     status_t getWideColorSupport(bool* supported) __attribute__((__deprecated__));
     status_t getHdrSupport(bool* supported) __attribute__((__deprecated__));
@@ -313,6 +323,7 @@ private:
     int dispatchEnableFrameTimestamps(va_list args);
     int dispatchGetCompositorTiming(va_list args);
     int dispatchGetFrameTimestamps(va_list args);
+    int dispatchGetCachedFrameTimestamps(va_list args);
     int dispatchGetWideColorSupport(va_list args);
     int dispatchGetHdrSupport(va_list args);
     int dispatchGetConsumerUsage64(va_list args);
@@ -511,6 +511,13 @@ public:
         std::vector<uint64_t> getMergedTransactionIds();
 
         status_t apply(bool synchronous = false, bool oneWay = false);
+        // Applies the transaction as a one-way call, unless SurfaceFlinger has not yet committed
+        // the last few transactions that were applied this way with the same apply token. In that
+        // case the transaction is merged into a pending transaction for the token, which is
+        // applied as soon as one of the earlier transactions is committed. This keeps a client
+        // that produces transactions faster than SurfaceFlinger can commit them from filling up
+        // its transaction queues, while preserving the order of the changes.
+        status_t applyWithFlowControl();
         // Merge another transaction in to this one, clearing other
         // as if it had been applied.
         Transaction& merge(Transaction&& other);
@@ -768,6 +775,11 @@ public:
         void setDisplayProjection(const sp<IBinder>& token, ui::Rotation orientation,
                                   const Rect& layerStackRect, const Rect& displayRect);
         void setDisplaySize(const sp<IBinder>& token, uint32_t width, uint32_t height);
+        /* Only valid for virtual displays. Composes the display at requestedRefreshRate rather
+         * than on every frame, see ISurfaceComposer::createVirtualDisplay. 0 composes on every
+         * frame.
+         */
+        void setDisplayRequestedRefreshRate(const sp<IBinder>& token, float requestedRefreshRate);
         void setAnimationTransaction();
         void setEarlyWakeupStart();
         void setEarlyWakeupEnd();
@@ -965,6 +977,7 @@ public:
     void onTransactionCompleted(ListenerStats stats) override;
     void onReleaseBuffer(ReleaseCallbackId, sp<Fence> releaseFence,
                          uint32_t currentMaxAcquiredBufferCount) override;
+    void onReleaseBuffers(std::vector<ReleaseBufferStats> releases) override;
 
     void removeReleaseBufferCallback(const ReleaseCallbackId& callbackId);
 
@@ -40,6 +40,8 @@ public:
     void reconnect(const sp<gui::ISurfaceComposer>&);
 
 private:
+    void requestDeltasLocked() REQUIRES(mListenersMutex);
+
     std::mutex mListenersMutex;
     std::unordered_set<sp<gui::WindowInfosListener>, gui::SpHash<gui::WindowInfosListener>>
             mWindowInfosListeners GUARDED_BY(mListenersMutex);
@@ -47,6 +49,11 @@ private:
     std::vector<gui::WindowInfo> mLastWindowInfos GUARDED_BY(mListenersMutex);
     std::vector<gui::DisplayInfo> mLastDisplayInfos GUARDED_BY(mListenersMutex);
 
+    // Version of mLastWindowInfos, which deltas are applied to. mResyncPending is set while
+    // waiting for the complete update requested through requestWindowInfosDeltas.
+    uint64_t mLastVersion GUARDED_BY(mListenersMutex) = 0;
+    bool mResyncPending GUARDED_BY(mListenersMutex) = false;
+
     sp<gui::IWindowInfosPublisher> mWindowInfosPublisher;
     int64_t mListenerId;
 };
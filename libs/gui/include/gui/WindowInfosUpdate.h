@@ -37,6 +37,30 @@ struct WindowInfosUpdate : public Parcelable {
     int64_t vsyncId;
     int64_t timestamp;
 
+    // Identifies the window list of this update so that a later delta can be encoded against it.
+    // Zero for unversioned updates, which can't serve as a delta base.
+    uint64_t version = 0;
+
+    // Delta encoding. When baseVersion is nonzero, windowInfos only holds the windows that
+    // changed since the update with that version, and windowIndices has one entry per window
+    // of the full list, in order: either kChangedWindow, meaning the next entry of windowInfos,
+    // or the index of the unchanged window in the base update's list.
+    static constexpr int32_t kChangedWindow = -1;
+    uint64_t baseVersion = 0;
+    std::vector<int32_t> windowIndices;
+
+    bool isDelta() const { return baseVersion != 0; }
+
+    // Returns a copy of update whose windowInfos only holds the windows that differ from base.
+    // Windows are matched by id.
+    static WindowInfosUpdate makeDelta(const WindowInfosUpdate& base,
+                                       const WindowInfosUpdate& update);
+
+    // Rebuilds the full window list of a delta from the window list of its base update. Returns
+    // BAD_VALUE, leaving this update untouched, if the delta references a window baseWindowInfos
+    // doesn't have.
+    status_t applyDelta(const std::vector<WindowInfo>& baseWindowInfos);
+
     status_t writeToParcel(android::Parcel*) const override;
     status_t readFromParcel(const android::Parcel*) override;
 };
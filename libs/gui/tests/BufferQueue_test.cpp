@@ -380,6 +380,56 @@ TEST_F(BufferQueueTest, DetachAndReattachOnProducerSide) {
     ASSERT_EQ(OK, item.mGraphicBuffer->unlock());
 }
 
+TEST_F(BufferQueueTest, BatchedRequestDetachAndCancel) {
+    createBufferQueue();
+    sp<MockConsumer> mc(new MockConsumer);
+    ASSERT_EQ(OK, mConsumer->consumerConnect(mc, false));
+    IGraphicBufferProducer::QueueBufferOutput output;
+    ASSERT_EQ(OK,
+              mProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, false, &output));
+    ASSERT_EQ(OK, mProducer->setMaxDequeuedBufferCount(3));
+
+    std::vector<int32_t> slots;
+    for (int i = 0; i < 3; i++) {
+        int slot;
+        sp<Fence> fence;
+        ASSERT_EQ(IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION,
+                  mProducer->dequeueBuffer(&slot, &fence, 0, 0, 0, GRALLOC_USAGE_SW_WRITE_OFTEN,
+                                           nullptr, nullptr));
+        slots.push_back(slot);
+    }
+
+    // One bad slot must not affect the others in the batch.
+    std::vector<int32_t> requestSlots = slots;
+    requestSlots.push_back(-1);
+    std::vector<IGraphicBufferProducer::RequestBufferOutput> requestOutputs;
+    ASSERT_EQ(OK, mProducer->requestBuffers(requestSlots, &requestOutputs));
+    ASSERT_EQ(requestSlots.size(), requestOutputs.size());
+    for (size_t i = 0; i < slots.size(); i++) {
+        EXPECT_EQ(OK, requestOutputs[i].result);
+        EXPECT_NE(nullptr, requestOutputs[i].buffer);
+    }
+    EXPECT_EQ(BAD_VALUE, requestOutputs.back().result);
+
+    std::vector<status_t> detachResults;
+    ASSERT_EQ(OK, mProducer->detachBuffers({slots[0]}, &detachResults));
+    ASSERT_EQ(1u, detachResults.size());
+    EXPECT_EQ(OK, detachResults[0]);
+
+    std::vector<IGraphicBufferProducer::CancelBufferInput> cancelInputs;
+    for (int32_t slot : slots) {
+        IGraphicBufferProducer::CancelBufferInput& input = cancelInputs.emplace_back();
+        input.slot = slot;
+        input.fence = Fence::NO_FENCE;
+    }
+    std::vector<status_t> cancelResults;
+    ASSERT_EQ(OK, mProducer->cancelBuffers(cancelInputs, &cancelResults));
+    ASSERT_EQ(3u, cancelResults.size());
+    EXPECT_EQ(BAD_VALUE, cancelResults[0]); // already detached
+    EXPECT_EQ(OK, cancelResults[1]);
+    EXPECT_EQ(OK, cancelResults[2]);
+}
+
 TEST_F(BufferQueueTest, DetachAndReattachOnConsumerSide) {
     createBufferQueue();
     sp<MockConsumer> mc(new MockConsumer);
@@ -520,6 +570,37 @@ TEST_F(BufferQueueTest, TestDisallowingAllocation) {
                                        GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr));
 }
 
+TEST_F(BufferQueueTest, AllocateBuffersReplacesStaleFreeBuffers) {
+    createBufferQueue();
+    sp<MockConsumer> mc(new MockConsumer);
+    ASSERT_EQ(OK, mConsumer->consumerConnect(mc, true));
+    IGraphicBufferProducer::QueueBufferOutput output;
+    ASSERT_EQ(OK,
+              mProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, true, &output));
+
+    static const uint32_t WIDTH = 320;
+    static const uint32_t HEIGHT = 240;
+
+    ASSERT_EQ(OK, mConsumer->setDefaultBufferSize(WIDTH, HEIGHT));
+    mProducer->allocateBuffers(0, 0, 0, GRALLOC_USAGE_SW_WRITE_OFTEN);
+
+    // Every slot now has a buffer of the old size; preallocating for the new
+    // default size must replace them rather than do nothing.
+    ASSERT_EQ(OK, mConsumer->setDefaultBufferSize(WIDTH * 2, HEIGHT * 2));
+    mProducer->allocateBuffers(0, 0, 0, GRALLOC_USAGE_SW_WRITE_OFTEN);
+
+    int slot;
+    sp<Fence> fence;
+    sp<GraphicBuffer> buffer;
+    ASSERT_EQ(OK, mProducer->allowAllocation(false));
+    status_t result = mProducer->dequeueBuffer(&slot, &fence, 0, 0, 0,
+                                               GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr, nullptr);
+    ASSERT_GE(result, OK);
+    ASSERT_EQ(OK, mProducer->requestBuffer(slot, &buffer));
+    EXPECT_EQ(WIDTH * 2, buffer->getWidth());
+    EXPECT_EQ(HEIGHT * 2, buffer->getHeight());
+}
+
 TEST_F(BufferQueueTest, TestGenerationNumbers) {
     createBufferQueue();
     sp<MockConsumer> mc(new MockConsumer);
@@ -85,4 +85,31 @@ TEST_F(ChoreographerTest, InputCallbackBeforeAnimation) {
                                            animationCb.frameTime.count());
 }
 
+TEST_F(ChoreographerTest, DeadlineCallbackRunsAfterVsyncCallbackOfSameFrame) {
+    sp<Looper> looper = Looper::prepare(0);
+    Choreographer* choreographer = Choreographer::getForThread();
+    VsyncCallback animationCb;
+    VsyncCallback deadlineCb;
+
+    choreographer->postVsyncCallbackBeforeDeadline(vsyncCallback, &deadlineCb, /*leadTime=*/0);
+    choreographer->postFrameCallbackDelayed(nullptr, nullptr, vsyncCallback, &animationCb, 0,
+                                            CALLBACK_ANIMATION);
+
+    nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    nsecs_t currTime;
+    int pollResult;
+    do {
+        pollResult = looper->pollOnce(16);
+        currTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    } while (!(deadlineCb.callbackReceived() && animationCb.callbackReceived()) &&
+             (pollResult != Looper::POLL_ERROR) && (currTime - startTime < ms2ns(3000)));
+
+    ASSERT_TRUE(animationCb.callbackReceived()) << "did not receive animation callback";
+    ASSERT_TRUE(deadlineCb.callbackReceived()) << "did not receive deadline callback";
+
+    // Both callbacks belong to the same frame, but the deadline callback waits for the deadline.
+    ASSERT_EQ(animationCb.frameTime, deadlineCb.frameTime);
+    ASSERT_LT(animationCb.receivedCallbackTime, deadlineCb.receivedCallbackTime);
+}
+
 } // namespace android
\ No newline at end of file
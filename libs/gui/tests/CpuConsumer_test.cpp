@@ -565,6 +565,47 @@ TEST_P(CpuConsumerTest, FromCpuSingle) {
     mCC->unlockBuffer(b);
 }
 
+TEST_P(CpuConsumerTest, FromCpuPersistentMapping) {
+    status_t err;
+    CpuConsumerTestParams params = GetParam();
+
+    // Set up
+
+    err = mCC->setPersistentMappingEnabled(true);
+    if (err == INVALID_OPERATION) {
+        GTEST_SKIP() << "Mapper HAL can't reread locked buffers";
+    }
+    ASSERT_NO_ERROR(err, "setPersistentMappingEnabled error: ");
+
+    ASSERT_NO_FATAL_FAILURE(configureANW(mANW, params, 1));
+
+    // Produce and consume enough frames that slots get reused while mapped
+
+    const int numFrames = 8;
+    for (int i = 0; i < numFrames; i++) {
+        const int64_t time = 1000L + i;
+        uint32_t stride;
+        ASSERT_NO_FATAL_FAILURE(produceOneFrame(mANW, params, time, &stride));
+
+        CpuConsumer::LockedBuffer b;
+        err = mCC->lockNextBuffer(&b);
+        ASSERT_NO_ERROR(err, "getNextBuffer error: ");
+
+        ASSERT_TRUE(b.data != nullptr);
+        EXPECT_EQ(params.width, b.width);
+        EXPECT_EQ(params.height, b.height);
+        EXPECT_EQ(stride, b.stride);
+        EXPECT_EQ(time, b.timestamp);
+
+        checkAnyBuffer(b, GetParam().format);
+        err = mCC->unlockBuffer(b);
+        ASSERT_NO_ERROR(err, "unlockBuffer error: ");
+    }
+
+    err = mCC->setPersistentMappingEnabled(false);
+    ASSERT_NO_ERROR(err, "setPersistentMappingEnabled error: ");
+}
+
 // This test is disabled because the HAL_PIXEL_FORMAT_RAW16 format is not
 // supported on all devices.
 TEST_P(CpuConsumerTest, FromCpuManyInQueue) {
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <binder/Binder.h>
+#include <binder/Parcel.h>
+#include <gui/LayerState.h>
+
+namespace android {
+namespace {
+
+// The number of layers that an animation typically updates in a single transaction.
+constexpr size_t NUM_LAYERS = 16;
+
+layer_state_t makePositionUpdate() {
+    layer_state_t state;
+    state.surface = sp<BBinder>::make();
+    state.what = layer_state_t::ePositionChanged;
+    state.x = 100.f;
+    state.y = 200.f;
+    return state;
+}
+
+layer_state_t makeGeometryUpdate() {
+    layer_state_t state = makePositionUpdate();
+    state.what |= layer_state_t::eMatrixChanged | layer_state_t::eCropChanged |
+            layer_state_t::eAlphaChanged | layer_state_t::eCornerRadiusChanged;
+    state.crop = Rect(0, 0, 1080, 2400);
+    state.color.a = 0.5f;
+    state.cornerRadius = 16.f;
+    return state;
+}
+
+void writeStates(const std::vector<layer_state_t>& states, Parcel& parcel) {
+    for (const auto& state : states) {
+        state.write(parcel);
+    }
+}
+
+void benchmarkWrite(benchmark::State& benchState, const layer_state_t& layerState) {
+    const std::vector<layer_state_t> states(NUM_LAYERS, layerState);
+    Parcel parcel;
+    for (auto _ : benchState) {
+        parcel.setDataSize(0);
+        writeStates(states, parcel);
+        benchmark::DoNotOptimize(parcel.data());
+    }
+    benchState.counters["bytes"] = parcel.dataSize();
+}
+
+void benchmarkRead(benchmark::State& benchState, const layer_state_t& layerState) {
+    const std::vector<layer_state_t> states(NUM_LAYERS, layerState);
+    Parcel parcel;
+    writeStates(states, parcel);
+    std::vector<layer_state_t> results(NUM_LAYERS);
+    for (auto _ : benchState) {
+        parcel.setDataPosition(0);
+        for (auto& result : results) {
+            result.read(parcel);
+        }
+        benchmark::DoNotOptimize(results.data());
+    }
+    benchState.counters["bytes"] = parcel.dataSize();
+}
+
+void BM_WritePositionUpdate(benchmark::State& state) {
+    benchmarkWrite(state, makePositionUpdate());
+}
+BENCHMARK(BM_WritePositionUpdate);
+
+void BM_ReadPositionUpdate(benchmark::State& state) {
+    benchmarkRead(state, makePositionUpdate());
+}
+BENCHMARK(BM_ReadPositionUpdate);
+
+void BM_WriteGeometryUpdate(benchmark::State& state) {
+    benchmarkWrite(state, makeGeometryUpdate());
+}
+BENCHMARK(BM_WriteGeometryUpdate);
+
+void BM_ReadGeometryUpdate(benchmark::State& state) {
+    benchmarkRead(state, makeGeometryUpdate());
+}
+BENCHMARK(BM_ReadGeometryUpdate);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <binder/Binder.h>
+#include <binder/Parcel.h>
+
+#include <gui/LayerState.h>
+
+namespace android {
+
+namespace test {
+
+TEST(LayerState, ParcellingOnlyWritesChangedFields) {
+    layer_state_t positionOnly;
+    positionOnly.what = layer_state_t::ePositionChanged;
+    positionOnly.x = 12.f;
+    positionOnly.y = 34.f;
+
+    layer_state_t withGeometry = positionOnly;
+    withGeometry.what |= layer_state_t::eCropChanged | layer_state_t::eMatrixChanged;
+
+    Parcel positionOnlyParcel;
+    ASSERT_EQ(OK, positionOnly.write(positionOnlyParcel));
+    Parcel withGeometryParcel;
+    ASSERT_EQ(OK, withGeometry.write(withGeometryParcel));
+    EXPECT_LT(positionOnlyParcel.dataSize(), withGeometryParcel.dataSize());
+
+    // Fields that were not selected keep their values from before the read.
+    layer_state_t result;
+    result.z = 7;
+    positionOnlyParcel.setDataPosition(0);
+    ASSERT_EQ(OK, result.read(positionOnlyParcel));
+    EXPECT_EQ(positionOnlyParcel.dataSize(), positionOnlyParcel.dataPosition());
+    EXPECT_EQ(layer_state_t::ePositionChanged, result.what);
+    EXPECT_EQ(12.f, result.x);
+    EXPECT_EQ(34.f, result.y);
+    EXPECT_EQ(7, result.z);
+}
+
+TEST(LayerState, Parcelling) {
+    layer_state_t state;
+    state.surface = sp<BBinder>::make();
+    state.layerId = 42;
+    state.what = layer_state_t::eLayerChanged | layer_state_t::eAlphaChanged |
+            layer_state_t::eColorChanged | layer_state_t::eFlagsChanged |
+            layer_state_t::eCropChanged | layer_state_t::eBlurRegionsChanged |
+            layer_state_t::eDesiredHdrHeadroomChanged | layer_state_t::eCachingHintChanged;
+    state.z = -3;
+    state.color = half4(0.25f, 0.5f, 0.75f, 0.125f);
+    state.flags = layer_state_t::eLayerHidden;
+    state.mask = layer_state_t::eLayerHidden | layer_state_t::eLayerOpaque;
+    state.crop = Rect(1, 2, 3, 4);
+    BlurRegion region{};
+    region.blurRadius = 5;
+    region.alpha = 0.5f;
+    region.right = 10;
+    region.bottom = 20;
+    state.blurRegions.push_back(region);
+    state.desiredHdrSdrRatio = 2.f;
+    state.cachingHint = gui::CachingHint::Disabled;
+
+    Parcel p;
+    ASSERT_EQ(OK, state.write(p));
+    p.setDataPosition(0);
+
+    layer_state_t result;
+    ASSERT_EQ(OK, result.read(p));
+    EXPECT_EQ(p.dataSize(), p.dataPosition());
+    EXPECT_EQ(state.surface, result.surface);
+    EXPECT_EQ(state.layerId, result.layerId);
+    EXPECT_EQ(state.what, result.what);
+    EXPECT_EQ(state.z, result.z);
+    EXPECT_EQ(state.color, result.color);
+    EXPECT_EQ(state.flags, result.flags);
+    EXPECT_EQ(state.mask, result.mask);
+    EXPECT_EQ(state.crop, result.crop);
+    ASSERT_EQ(1u, result.blurRegions.size());
+    EXPECT_EQ(region.blurRadius, result.blurRegions[0].blurRadius);
+    EXPECT_EQ(region.alpha, result.blurRegions[0].alpha);
+    EXPECT_EQ(region.right, result.blurRegions[0].right);
+    EXPECT_EQ(region.bottom, result.blurRegions[0].bottom);
+    EXPECT_EQ(state.desiredHdrSdrRatio, result.desiredHdrSdrRatio);
+    EXPECT_EQ(state.cachingHint, result.cachingHint);
+    EXPECT_EQ(nullptr, result.bufferData);
+    EXPECT_TRUE(result.listeners.empty());
+}
+
+} // namespace test
+} // namespace android
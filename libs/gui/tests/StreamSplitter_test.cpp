@@ -28,6 +28,10 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
 namespace android {
 
 class StreamSplitterTest : public ::testing::Test {};
@@ -38,6 +42,26 @@ struct FakeListener : public BnConsumerListener {
     virtual void onSidebandStreamChanged() {}
 };
 
+struct FrameCountingListener : public BnConsumerListener {
+    void onFrameAvailable(const BufferItem& /* item */) override {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mFrames;
+        mCondition.notify_all();
+    }
+    void onBuffersReleased() override {}
+    void onSidebandStreamChanged() override {}
+
+    bool waitForFrames(int count) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCondition.wait_for(lock, std::chrono::seconds(1),
+                                   [&] { return mFrames >= count; });
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    int mFrames = 0;
+};
+
 static const uint32_t TEST_DATA = 0x12345678u;
 
 TEST_F(StreamSplitterTest, OneInputOneOutput) {
@@ -222,4 +246,69 @@ TEST_F(StreamSplitterTest, OutputAbandonment) {
                                            nullptr, nullptr));
 }
 
+TEST_F(StreamSplitterTest, IndependentOutputSkipsStalledOutput) {
+    const int NUM_FRAMES = 6;
+
+    sp<IGraphicBufferProducer> inputProducer;
+    sp<IGraphicBufferConsumer> inputConsumer;
+    BufferQueue::createBufferQueue(&inputProducer, &inputConsumer);
+
+    // The stalled output never acquires anything
+    sp<IGraphicBufferProducer> stalledProducer;
+    sp<IGraphicBufferConsumer> stalledConsumer;
+    BufferQueue::createBufferQueue(&stalledProducer, &stalledConsumer);
+    ASSERT_EQ(OK, stalledConsumer->consumerConnect(new FakeListener, false));
+
+    sp<IGraphicBufferProducer> liveProducer;
+    sp<IGraphicBufferConsumer> liveConsumer;
+    BufferQueue::createBufferQueue(&liveProducer, &liveConsumer);
+    sp<FrameCountingListener> liveListener = new FrameCountingListener;
+    ASSERT_EQ(OK, liveConsumer->consumerConnect(liveListener, false));
+
+    sp<StreamSplitter> splitter;
+    ASSERT_EQ(OK, StreamSplitter::createSplitter(inputConsumer, &splitter));
+    ASSERT_EQ(BAD_VALUE, splitter->setIndependentOutputs(0));
+    ASSERT_EQ(OK, splitter->setIndependentOutputs(1));
+    ASSERT_EQ(OK, splitter->addOutput(stalledProducer));
+    ASSERT_EQ(OK, splitter->addOutput(liveProducer));
+    ASSERT_EQ(INVALID_OPERATION, splitter->setIndependentOutputs(1));
+
+    IGraphicBufferProducer::QueueBufferOutput qbOutput;
+    ASSERT_EQ(OK,
+              inputProducer->connect(new StubProducerListener, NATIVE_WINDOW_API_CPU, false,
+                                     &qbOutput));
+
+    IGraphicBufferProducer::QueueBufferInput qbInput(0, false,
+            HAL_DATASPACE_UNKNOWN, Rect(0, 0, 1, 1),
+            NATIVE_WINDOW_SCALING_MODE_FREEZE, 0, Fence::NO_FENCE);
+
+    for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+        int slot;
+        sp<Fence> fence;
+        sp<GraphicBuffer> buffer;
+        status_t status = inputProducer->dequeueBuffer(&slot, &fence, 0, 0, 0,
+                                                       GRALLOC_USAGE_SW_WRITE_OFTEN, nullptr,
+                                                       nullptr);
+        ASSERT_GE(status, OK);
+        if (status & IGraphicBufferProducer::BUFFER_NEEDS_REALLOCATION) {
+            ASSERT_EQ(OK, inputProducer->requestBuffer(slot, &buffer));
+        }
+        ASSERT_EQ(OK, inputProducer->queueBuffer(slot, qbInput, &qbOutput));
+
+        // The live output keeps receiving frames even though the stalled one
+        // is holding the first buffer
+        ASSERT_TRUE(liveListener->waitForFrames(frame + 1));
+        BufferItem item;
+        ASSERT_EQ(OK, liveConsumer->acquireBuffer(&item, 0));
+        ASSERT_EQ(OK, liveConsumer->releaseBuffer(item.mSlot, item.mFrameNumber,
+                    EGL_NO_DISPLAY, EGL_NO_SYNC_KHR, Fence::NO_FENCE));
+    }
+
+    // Only the first buffer was queued to the stalled output
+    BufferItem item;
+    ASSERT_EQ(OK, stalledConsumer->acquireBuffer(&item, 0));
+    ASSERT_EQ(IGraphicBufferConsumer::NO_BUFFER_AVAILABLE,
+              stalledConsumer->acquireBuffer(&item, 0));
+}
+
 } // namespace android
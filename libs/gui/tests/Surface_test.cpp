@@ -1722,6 +1722,42 @@ TEST_F(GetFrameTimestampsTest, TimestampsAssociatedWithCorrectFrame) {
     EXPECT_EQ(NATIVE_WINDOW_TIMESTAMP_PENDING, outReleaseTime);
 }
 
+// This test verifies that latency stats are built from the frame events
+// piggybacked on queueBuffer, without asking the consumer for them.
+TEST_F(GetFrameTimestampsTest, LatencyStatsNoSync) {
+    FrameLatencyStats stats;
+    EXPECT_EQ(INVALID_OPERATION, mSurface->getFrameLatencyStats(&stats, false));
+
+    enableFrameTimestamps();
+
+    dequeueAndQueue(0);
+    mFrames[0].signalQueueFences();
+    addFrameEvents(true, NO_FRAME_INDEX, 0);
+    mFrames[0].signalRefreshFences();
+
+    // Nothing is known about frame 1 until the next queue delivers its events.
+    EXPECT_EQ(NO_ERROR, mSurface->getFrameLatencyStats(&stats, false));
+    EXPECT_EQ(0u, stats.frameCount);
+
+    dequeueAndQueue(1);
+
+    const int oldCount = mFakeConsumer->mGetFrameTimestampsCount;
+    EXPECT_EQ(NO_ERROR, mSurface->getFrameLatencyStats(&stats, true));
+    EXPECT_EQ(oldCount, mFakeConsumer->mGetFrameTimestampsCount);
+
+    const nsecs_t presentTime = mFrames[0].mRefreshes[0].kPresentTime;
+    EXPECT_EQ(1u, stats.frameCount);
+    EXPECT_EQ(0u, stats.unresolvedFrameCount);
+    EXPECT_EQ(mFrames[0].kLatchTime - mFrames[0].kPostedTime, stats.queueToLatch.max);
+    EXPECT_EQ(presentTime - mFrames[0].kPostedTime, stats.queueToPresent.total);
+    EXPECT_EQ(1u, stats.queueToPresent.buckets[0]);
+    // The test's present time precedes its latch time, which is clamped.
+    EXPECT_EQ(0, stats.latchToPresent.max);
+
+    EXPECT_EQ(NO_ERROR, mSurface->getFrameLatencyStats(&stats, false));
+    EXPECT_EQ(0u, stats.frameCount);
+}
+
 // This test verifies the acquire fence recorded by the consumer is not sent
 // back to the producer and the producer saves its own fence.
 TEST_F(GetFrameTimestampsTest, QueueTimestampsNoSync) {
@@ -1889,6 +1925,57 @@ TEST_F(GetFrameTimestampsTest, FencesInProducerNoSync) {
     EXPECT_EQ(mFrames[0].kReleaseTime, outReleaseTime);
 }
 
+// This test verifies that cached timestamp queries never sync with the
+// consumer, and report what hasn't been received yet as pending.
+TEST_F(GetFrameTimestampsTest, CachedTimestampsNoSync) {
+    enableFrameTimestamps();
+
+    // Dequeue and queue frame 1.
+    const uint64_t fId1 = getNextFrameId();
+    dequeueAndQueue(0);
+    mFrames[0].signalQueueFences();
+
+    // Dequeue and queue frame 2.
+    const uint64_t fId2 = getNextFrameId();
+    dequeueAndQueue(1);
+    mFrames[1].signalQueueFences();
+
+    addFrameEvents(true, NO_FRAME_INDEX, 0);
+    addFrameEvents(true, 0, 1);
+
+    // The events triggered by addFrameEvents haven't reached the producer, so
+    // a cached query only sees producer side timestamps.
+    resetTimestamps();
+    int oldCount = mFakeConsumer->mGetFrameTimestampsCount;
+    int result = native_window_get_cached_frame_timestamps(mWindow.get(), fId1,
+            &outRequestedPresentTime, &outAcquireTime, &outLatchTime,
+            &outFirstRefreshStartTime, &outLastRefreshStartTime,
+            &outGpuCompositionDoneTime, &outDisplayPresentTime,
+            &outDequeueReadyTime, &outReleaseTime);
+    EXPECT_EQ(oldCount, mFakeConsumer->mGetFrameTimestampsCount);
+    EXPECT_EQ(NO_ERROR, result);
+    EXPECT_EQ(mFrames[0].kRequestedPresentTime, outRequestedPresentTime);
+    EXPECT_EQ(mFrames[0].kProducerAcquireTime, outAcquireTime);
+    EXPECT_EQ(NATIVE_WINDOW_TIMESTAMP_PENDING, outLatchTime);
+
+    // A full query for frame 2 syncs once, which brings in frame 1's events too.
+    resetTimestamps();
+    result = getAllFrameTimestamps(fId2);
+    EXPECT_EQ(oldCount + 1, mFakeConsumer->mGetFrameTimestampsCount);
+    EXPECT_EQ(NO_ERROR, result);
+
+    resetTimestamps();
+    result = native_window_get_cached_frame_timestamps(mWindow.get(), fId1,
+            &outRequestedPresentTime, &outAcquireTime, &outLatchTime,
+            &outFirstRefreshStartTime, &outLastRefreshStartTime,
+            &outGpuCompositionDoneTime, &outDisplayPresentTime,
+            &outDequeueReadyTime, &outReleaseTime);
+    EXPECT_EQ(oldCount + 1, mFakeConsumer->mGetFrameTimestampsCount);
+    EXPECT_EQ(NO_ERROR, result);
+    EXPECT_EQ(mFrames[0].kLatchTime, outLatchTime);
+    EXPECT_EQ(mFrames[0].kDequeueReadyTime, outDequeueReadyTime);
+}
+
 // This test verifies that if the frame wasn't GPU composited but has a refresh
 // event a sync call isn't made to get the GPU composite done time since it will
 // never exist.
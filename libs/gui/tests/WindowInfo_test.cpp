@@ -20,6 +20,7 @@
 #include <binder/Parcel.h>
 
 #include <gui/WindowInfo.h>
+#include <gui/WindowInfosUpdate.h>
 
 using std::chrono_literals::operator""s;
 
@@ -28,6 +29,7 @@ namespace android {
 using gui::InputApplicationInfo;
 using gui::TouchOcclusionMode;
 using gui::WindowInfo;
+using gui::WindowInfosUpdate;
 using ui::Size;
 
 namespace test {
@@ -116,5 +118,87 @@ TEST(InputApplicationInfo, Parcelling) {
     ASSERT_EQ(i, i2);
 }
 
+static WindowInfo makeWindowInfo(int32_t id, Rect frame) {
+    WindowInfo info;
+    info.id = id;
+    info.name = "Window " + std::to_string(id);
+    info.frame = frame;
+    info.touchableRegion = Region(frame);
+    return info;
+}
+
+TEST(WindowInfosUpdate, DeltaOnlyHoldsChangedWindows) {
+    WindowInfosUpdate base{{makeWindowInfo(1, Rect(0, 0, 10, 10)),
+                            makeWindowInfo(2, Rect(0, 0, 20, 20)),
+                            makeWindowInfo(3, Rect(0, 0, 30, 30))},
+                           {},
+                           /* vsyncId= */ 1,
+                           0};
+    base.version = 1;
+
+    // Window 2 moves, 1 and 3 swap, and window 4 is added.
+    WindowInfosUpdate update{{makeWindowInfo(3, Rect(0, 0, 30, 30)),
+                              makeWindowInfo(2, Rect(5, 5, 25, 25)),
+                              makeWindowInfo(1, Rect(0, 0, 10, 10)),
+                              makeWindowInfo(4, Rect(0, 0, 40, 40))},
+                             {},
+                             /* vsyncId= */ 2,
+                             0};
+    update.version = 2;
+
+    WindowInfosUpdate delta = WindowInfosUpdate::makeDelta(base, update);
+    ASSERT_TRUE(delta.isDelta());
+    EXPECT_EQ(1u, delta.baseVersion);
+    EXPECT_EQ(2u, delta.version);
+    ASSERT_EQ(2u, delta.windowInfos.size());
+    EXPECT_EQ(2, delta.windowInfos[0].id);
+    EXPECT_EQ(4, delta.windowInfos[1].id);
+    EXPECT_EQ((std::vector<int32_t>{2, WindowInfosUpdate::kChangedWindow, 0,
+                                    WindowInfosUpdate::kChangedWindow}),
+              delta.windowIndices);
+
+    Parcel p;
+    ASSERT_EQ(OK, delta.writeToParcel(&p));
+    p.setDataPosition(0);
+    WindowInfosUpdate received;
+    ASSERT_EQ(OK, received.readFromParcel(&p));
+    ASSERT_TRUE(received.isDelta());
+
+    ASSERT_EQ(OK, received.applyDelta(base.windowInfos));
+    EXPECT_FALSE(received.isDelta());
+    EXPECT_EQ(update.windowInfos, received.windowInfos);
+    EXPECT_EQ(2, received.vsyncId);
+    EXPECT_EQ(2u, received.version);
+}
+
+TEST(WindowInfosUpdate, ApplyDeltaRejectsMissingBaseWindows) {
+    WindowInfosUpdate delta;
+    delta.baseVersion = 1;
+    delta.windowIndices = {0, 1};
+
+    const std::vector<WindowInfo> base{makeWindowInfo(1, Rect(0, 0, 10, 10))};
+    EXPECT_EQ(BAD_VALUE, delta.applyDelta(base));
+    EXPECT_TRUE(delta.isDelta());
+
+    delta.windowIndices = {0, WindowInfosUpdate::kChangedWindow};
+    EXPECT_EQ(BAD_VALUE, delta.applyDelta(base));
+}
+
+TEST(WindowInfosUpdate, ParcellingFullUpdate) {
+    WindowInfosUpdate update{{makeWindowInfo(1, Rect(0, 0, 10, 10))}, {}, /* vsyncId= */ 7, 9};
+    update.version = 3;
+
+    Parcel p;
+    ASSERT_EQ(OK, update.writeToParcel(&p));
+    p.setDataPosition(0);
+    WindowInfosUpdate received;
+    ASSERT_EQ(OK, received.readFromParcel(&p));
+    EXPECT_FALSE(received.isDelta());
+    EXPECT_EQ(update.windowInfos, received.windowInfos);
+    EXPECT_EQ(3u, received.version);
+    EXPECT_EQ(7, received.vsyncId);
+    EXPECT_EQ(9, received.timestamp);
+}
+
 } // namespace test
 } // namespace android
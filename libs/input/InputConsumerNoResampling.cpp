@@ -177,8 +177,13 @@ using android::base::StringPrintf;
 
 InputConsumerNoResampling::InputConsumerNoResampling(const std::shared_ptr<InputChannel>& channel,
                                                      sp<Looper> looper,
-                                                     InputConsumerCallbacks& callbacks)
-      : mChannel(channel), mLooper(looper), mCallbacks(callbacks), mFdEvents(0) {
+                                                     InputConsumerCallbacks& callbacks,
+                                                     ResamplerFactory resamplerFactory)
+      : mChannel(channel),
+        mLooper(looper),
+        mCallbacks(callbacks),
+        mFdEvents(0),
+        mResamplerFactory(std::move(resamplerFactory)) {
     LOG_ALWAYS_FATAL_IF(mLooper == nullptr);
     mCallback = sp<LooperEventCallback>::make(
             std::bind(&InputConsumerNoResampling::handleReceiveCallback, this,
@@ -311,7 +316,6 @@ void InputConsumerNoResampling::setFdEvents(int events) {
 }
 
 void InputConsumerNoResampling::handleMessages(std::vector<InputMessage>&& messages) {
-    // TODO(b/297226446) : add resampling
     for (const InputMessage& msg : messages) {
         if (msg.header.type == InputMessage::Type::MOTION) {
             const int32_t action = msg.body.motion.action;
@@ -360,22 +364,33 @@ void InputConsumerNoResampling::handleMessages(std::vector<InputMessage>&& messa
 }
 
 std::vector<InputMessage> InputConsumerNoResampling::readAllMessages() {
+    // Read in batches so that a burst of queued events costs one syscall per batch rather than one
+    // per message. A short batch means the socket was drained, so no trailing read is needed.
+    static constexpr size_t kBatchSize = 8;
     std::vector<InputMessage> messages;
     while (true) {
-        InputMessage msg;
-        status_t result = mChannel->receiveMessage(&msg);
+        const size_t start = messages.size();
+        messages.resize(start + kBatchSize);
+        size_t received = 0;
+        status_t result = mChannel->receiveMessages(&messages[start], kBatchSize, &received);
+        messages.resize(start + received);
         switch (result) {
             case OK: {
-                const auto [_, inserted] =
-                        mConsumeTimes.emplace(msg.header.seq, systemTime(SYSTEM_TIME_MONOTONIC));
-                LOG_ALWAYS_FATAL_IF(!inserted, "Already have a consume time for seq=%" PRIu32,
-                                    msg.header.seq);
-
-                // Trace the event processing timeline - event was just read from the socket
-                // TODO(b/329777420): distinguish between multiple instances of InputConsumer
-                // in the same process.
-                ATRACE_ASYNC_BEGIN("InputConsumer processing", /*cookie=*/msg.header.seq);
-                messages.push_back(msg);
+                const nsecs_t consumeTime = systemTime(SYSTEM_TIME_MONOTONIC);
+                for (size_t i = start; i < messages.size(); i++) {
+                    const InputMessage& msg = messages[i];
+                    const auto [_, inserted] = mConsumeTimes.emplace(msg.header.seq, consumeTime);
+                    LOG_ALWAYS_FATAL_IF(!inserted, "Already have a consume time for seq=%" PRIu32,
+                                        msg.header.seq);
+
+                    // Trace the event processing timeline - event was just read from the socket
+                    // TODO(b/329777420): distinguish between multiple instances of InputConsumer
+                    // in the same process.
+                    ATRACE_ASYNC_BEGIN("InputConsumer processing", /*cookie=*/msg.header.seq);
+                }
+                if (received < kBatchSize) {
+                    return messages;
+                }
                 break;
             }
             case WOULD_BLOCK: {
@@ -397,7 +412,7 @@ std::vector<InputMessage> InputConsumerNoResampling::readAllMessages() {
     }
 }
 
-void InputConsumerNoResampling::handleMessage(const InputMessage& msg) const {
+void InputConsumerNoResampling::handleMessage(const InputMessage& msg) {
     switch (msg.header.type) {
         case InputMessage::Type::KEY: {
             std::unique_ptr<KeyEvent> keyEvent = createKeyEvent(msg);
@@ -407,6 +422,10 @@ void InputConsumerNoResampling::handleMessage(const InputMessage& msg) const {
 
         case InputMessage::Type::MOTION: {
             std::unique_ptr<MotionEvent> motionEvent = createMotionEvent(msg);
+            if (Resampler* resampler = getResampler(msg.body.motion.deviceId);
+                resampler != nullptr) {
+                resampler->onUnbatchedMotionEvent(*motionEvent);
+            }
             mCallbacks.onMotionEvent(std::move(motionEvent), msg.header.seq);
             break;
         }
@@ -453,12 +472,19 @@ bool InputConsumerNoResampling::consumeBatchedInputEvents(
     const nsecs_t frameTime = requestedFrameTime.value_or(std::numeric_limits<nsecs_t>::max());
     bool producedEvents = false;
     for (auto& [deviceId, messages] : mBatches) {
+        // Resampling only makes sense when the events are consumed for a specific frame. The batch
+        // is cut at the resample time, so that the first sample left in the batch can be used to
+        // interpolate rather than extrapolate.
+        Resampler* resampler = requestedFrameTime ? getResampler(deviceId) : nullptr;
+        const nsecs_t resampleTime =
+                resampler != nullptr ? resampler->getResampleTime(frameTime) : frameTime;
+        const nsecs_t batchEndTime = std::min(frameTime, resampleTime);
         std::unique_ptr<MotionEvent> motion;
         std::optional<uint32_t> firstSeqForBatch;
         std::vector<uint32_t> sequences;
         while (!messages.empty()) {
             const InputMessage& msg = messages.front();
-            if (msg.body.motion.eventTime > frameTime) {
+            if (msg.body.motion.eventTime > batchEndTime) {
                 break;
             }
             if (motion == nullptr) {
@@ -476,6 +502,10 @@ bool InputConsumerNoResampling::consumeBatchedInputEvents(
         }
         if (motion != nullptr) {
             LOG_ALWAYS_FATAL_IF(!firstSeqForBatch.has_value());
+            if (resampler != nullptr) {
+                resampler->resampleMotionEvent(resampleTime, *motion,
+                                               messages.empty() ? nullptr : &messages.front());
+            }
             mCallbacks.onMotionEvent(std::move(motion), *firstSeqForBatch);
             producedEvents = true;
         } else {
@@ -490,6 +520,17 @@ bool InputConsumerNoResampling::consumeBatchedInputEvents(
     return producedEvents;
 }
 
+Resampler* InputConsumerNoResampling::getResampler(DeviceId deviceId) {
+    if (mResamplerFactory == nullptr) {
+        return nullptr;
+    }
+    auto [it, inserted] = mResamplers.try_emplace(deviceId);
+    if (inserted) {
+        it->second = mResamplerFactory();
+    }
+    return it->second.get();
+}
+
 void InputConsumerNoResampling::ensureCalledOnLooperThread(const char* func) const {
     sp<Looper> callingThreadLooper = Looper::getForThread();
     if (callingThreadLooper != mLooper) {
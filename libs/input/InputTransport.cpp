@@ -15,6 +15,10 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
 #include <android-base/logging.h>
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
@@ -94,6 +98,10 @@ android::base::unique_fd dupChannelFd(int fd) {
 // behind processing touches.
 constexpr size_t SOCKET_BUFFER_SIZE = 32 * 1024;
 
+// Upper bound on the number of messages read by a single InputChannel::receiveMessages call.
+// Keeps the on-stack iovec and mmsghdr arrays small.
+constexpr size_t MAX_RECEIVE_BATCH_SIZE = 8;
+
 /**
  * Crash if the events that are getting sent to the InputPublisher are inconsistent.
  * Enable this via "adb shell setprop log.tag.InputTransportVerifyEvents DEBUG"
@@ -103,6 +111,114 @@ bool verifyEvents() {
             __android_log_is_loggable(ANDROID_LOG_DEBUG, LOG_TAG "VerifyEvents", ANDROID_LOG_INFO);
 }
 
+/**
+ * Motion pointers are not sent as the fixed-size InputMessage::Body::Motion::Pointer structs.
+ * Each PointerCoords reserves room for MAX_AXES values but typically only uses a handful, so on
+ * the wire each pointer is packed as:
+ *
+ *     PointerProperties properties
+ *     uint64_t          bits
+ *     uint32_t          isResampled
+ *     float             values[BitSet64::count(bits)]
+ *
+ * The records directly follow the fixed part of the motion body, in pointer order. This roughly
+ * triples the number of typical touch events that fit in the socket buffer.
+ */
+constexpr size_t MOTION_POINTERS_OFFSET =
+        sizeof(InputMessage::Header) + offsetof(InputMessage::Body::Motion, pointers);
+constexpr size_t PACKED_POINTER_HEADER_SIZE =
+        sizeof(PointerProperties) + sizeof(uint64_t) + sizeof(uint32_t);
+
+/**
+ * Pack the pointers of a sanitized MOTION message in place. Returns the number of bytes to send.
+ */
+size_t packMotionPointers(InputMessage& msg) {
+    uint8_t* const base = reinterpret_cast<uint8_t*>(&msg);
+    size_t offset = MOTION_POINTERS_OFFSET;
+    for (uint32_t i = 0; i < msg.body.motion.pointerCount; i++) {
+        // Packed records never extend past the unpacked pointer they are built from, so the
+        // pointer is copied out before its record is written over the front of it.
+        const InputMessage::Body::Motion::Pointer pointer = msg.body.motion.pointers[i];
+        const uint32_t isResampled = pointer.coords.isResampled;
+        const size_t valuesSize = BitSet64::count(pointer.coords.bits) * sizeof(float);
+        memcpy(base + offset, &pointer.properties, sizeof(PointerProperties));
+        offset += sizeof(PointerProperties);
+        memcpy(base + offset, &pointer.coords.bits, sizeof(uint64_t));
+        offset += sizeof(uint64_t);
+        memcpy(base + offset, &isResampled, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        memcpy(base + offset, pointer.coords.values.data(), valuesSize);
+        offset += valuesSize;
+    }
+    return offset;
+}
+
+/**
+ * Expand the packed pointers of a MOTION message of |nRead| bytes back into the fixed-size
+ * layout. Returns false if the packed records are malformed.
+ */
+bool unpackMotionPointers(InputMessage& msg, size_t nRead) {
+    if (nRead < MOTION_POINTERS_OFFSET) {
+        ALOGE("Received MOTION message of size %zu, too small to hold the motion body", nRead);
+        return false;
+    }
+    const uint32_t pointerCount = msg.body.motion.pointerCount;
+    if (pointerCount == 0 || pointerCount > MAX_POINTERS) {
+        ALOGE("Received invalid MOTION: pointerCount = %" PRIu32, pointerCount);
+        return false;
+    }
+
+    // Locate and validate every record before modifying the message.
+    const uint8_t* const base = reinterpret_cast<const uint8_t*>(&msg);
+    std::array<size_t, MAX_POINTERS> recordOffsets;
+    size_t offset = MOTION_POINTERS_OFFSET;
+    for (uint32_t i = 0; i < pointerCount; i++) {
+        if (nRead - offset < PACKED_POINTER_HEADER_SIZE) {
+            ALOGE("Received truncated MOTION pointer %" PRIu32, i);
+            return false;
+        }
+        uint64_t bits;
+        memcpy(&bits, base + offset + sizeof(PointerProperties), sizeof(uint64_t));
+        const uint32_t axisCount = BitSet64::count(bits);
+        if (axisCount > PointerCoords::MAX_AXES ||
+            nRead - offset - PACKED_POINTER_HEADER_SIZE < axisCount * sizeof(float)) {
+            ALOGE("Received invalid MOTION pointer %" PRIu32 " with %" PRIu32 " axes", i,
+                  axisCount);
+            return false;
+        }
+        recordOffsets[i] = offset;
+        offset += PACKED_POINTER_HEADER_SIZE + axisCount * sizeof(float);
+    }
+    if (offset != nRead) {
+        ALOGE("Received MOTION message of size %zu, expected %zu", nRead, offset);
+        return false;
+    }
+
+    // Expand from the last pointer to the first. Every record starts at or before the slot of
+    // its own pointer, so expanding in this order never overwrites a record still to be read.
+    for (uint32_t i = pointerCount; i-- > 0;) {
+        std::array<uint8_t, PACKED_POINTER_HEADER_SIZE + sizeof(float) * PointerCoords::MAX_AXES>
+                record;
+        const size_t recordSize = (i + 1 < pointerCount ? recordOffsets[i + 1] : nRead) -
+                recordOffsets[i];
+        memcpy(record.data(), base + recordOffsets[i], recordSize);
+
+        InputMessage::Body::Motion::Pointer& pointer = msg.body.motion.pointers[i];
+        memset(&pointer, 0, sizeof(pointer));
+        const uint8_t* field = record.data();
+        memcpy(&pointer.properties, field, sizeof(PointerProperties));
+        field += sizeof(PointerProperties);
+        memcpy(&pointer.coords.bits, field, sizeof(uint64_t));
+        field += sizeof(uint64_t);
+        uint32_t isResampled;
+        memcpy(&isResampled, field, sizeof(uint32_t));
+        pointer.coords.isResampled = isResampled != 0;
+        field += sizeof(uint32_t);
+        memcpy(pointer.coords.values.data(), field, recordSize - PACKED_POINTER_HEADER_SIZE);
+    }
+    return true;
+}
+
 } // namespace
 
 using android::base::Result;
@@ -174,11 +290,13 @@ size_t InputMessage::size() const {
 }
 
 /**
- * There could be non-zero bytes in-between InputMessage fields. Force-initialize the entire
- * memory to zero, then only copy the valid bytes on a per-field basis.
+ * There could be non-zero bytes in-between InputMessage fields. Force-initialize the memory that
+ * will be sent to zero, then only copy the valid bytes on a per-field basis. Bytes past size()
+ * are never written to the socket, so they are left untouched; for a motion event with few
+ * pointers that skips clearing most of the message.
  */
 void InputMessage::getSanitizedCopy(InputMessage* msg) const {
-    memset(msg, 0, sizeof(*msg));
+    memset(msg, 0, size());
 
     // Write the header
     msg->header.type = header.type;
@@ -390,9 +508,11 @@ status_t InputChannel::sendMessage(const InputMessage* msg) {
                    StringPrintf("sendMessage(inputChannel=%s, seq=0x%" PRIx32 ", type=%s)",
                                 name.c_str(), msg->header.seq,
                                 ftl::enum_string(msg->header.type).c_str()));
-    const size_t msgLength = msg->size();
     InputMessage cleanMsg;
     msg->getSanitizedCopy(&cleanMsg);
+    const size_t msgLength = msg->header.type == InputMessage::Type::MOTION
+            ? packMotionPointers(cleanMsg)
+            : msg->size();
     ssize_t nWrite;
     do {
         nWrite = ::send(getFd(), &cleanMsg, msgLength, MSG_DONTWAIT | MSG_NOSIGNAL);
@@ -449,19 +569,86 @@ status_t InputChannel::receiveMessage(InputMessage* msg) {
         return DEAD_OBJECT;
     }
 
-    if (!msg->isValid(nRead)) {
-        ALOGE("channel '%s' ~ received invalid message of size %zd", name.c_str(), nRead);
+    return checkReceivedMessage(*msg, nRead);
+}
+
+status_t InputChannel::receiveMessages(InputMessage* msgs, size_t count, size_t* outCount) {
+    *outCount = 0;
+    count = std::min(count, MAX_RECEIVE_BATCH_SIZE);
+    if (count == 0) {
+        return OK;
+    }
+
+    std::array<iovec, MAX_RECEIVE_BATCH_SIZE> iovs;
+    std::array<mmsghdr, MAX_RECEIVE_BATCH_SIZE> headers{};
+    for (size_t i = 0; i < count; i++) {
+        iovs[i].iov_base = &msgs[i];
+        iovs[i].iov_len = sizeof(InputMessage);
+        headers[i].msg_hdr.msg_iov = &iovs[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int nMessages;
+    do {
+        nMessages = ::recvmmsg(getFd(), headers.data(), count, MSG_DONTWAIT, /*timeout=*/nullptr);
+    } while (nMessages == -1 && errno == EINTR);
+
+    if (nMessages < 0) {
+        int error = errno;
+        ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ receive messages failed, errno=%d",
+                 name.c_str(), errno);
+        if (error == EAGAIN || error == EWOULDBLOCK) {
+            return WOULD_BLOCK;
+        }
+        if (error == EPIPE || error == ENOTCONN || error == ECONNREFUSED) {
+            return DEAD_OBJECT;
+        }
+        return -error;
+    }
+
+    for (int i = 0; i < nMessages; i++) {
+        const size_t nRead = headers[i].msg_len;
+        if (nRead == 0) { // check for EOF
+            if (i > 0) {
+                // Deliver what was read before the peer closed; the next call reports the EOF.
+                break;
+            }
+            ALOGD_IF(DEBUG_CHANNEL_MESSAGES,
+                     "channel '%s' ~ receive messages failed because peer was closed",
+                     name.c_str());
+            return DEAD_OBJECT;
+        }
+        const status_t status = checkReceivedMessage(msgs[i], nRead);
+        if (status != OK) {
+            return status;
+        }
+        (*outCount)++;
+    }
+    return OK;
+}
+
+status_t InputChannel::checkReceivedMessage(InputMessage& msg, size_t nRead) const {
+    if (nRead >= sizeof(InputMessage::Header) && msg.header.type == InputMessage::Type::MOTION) {
+        if (!unpackMotionPointers(msg, nRead)) {
+            ALOGE("channel '%s' ~ received malformed motion message of size %zu", name.c_str(),
+                  nRead);
+            return BAD_VALUE;
+        }
+        nRead = msg.size();
+    }
+    if (!msg.isValid(nRead)) {
+        ALOGE("channel '%s' ~ received invalid message of size %zu", name.c_str(), nRead);
         return BAD_VALUE;
     }
 
     ALOGD_IF(DEBUG_CHANNEL_MESSAGES, "channel '%s' ~ received message of type %s", name.c_str(),
-             ftl::enum_string(msg->header.type).c_str());
+             ftl::enum_string(msg.header.type).c_str());
     if (ATRACE_ENABLED()) {
         // Add an additional trace point to include data about the received message.
         std::string message =
                 StringPrintf("receiveMessage(inputChannel=%s, seq=0x%" PRIx32 ", type=%s)",
-                             name.c_str(), msg->header.seq,
-                             ftl::enum_string(msg->header.type).c_str());
+                             name.c_str(), msg.header.seq,
+                             ftl::enum_string(msg.header.type).c_str());
         ATRACE_NAME(message.c_str());
     }
     return OK;
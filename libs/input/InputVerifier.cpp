@@ -31,13 +31,25 @@ namespace android {
 // --- InputVerifier ---
 
 InputVerifier::InputVerifier(const std::string& name)
-      : mVerifier(android::input::verifier::create(rust::String::lossy(name))){};
+      : mVerifier(android::input::verifier::create(rust::String::lossy(name))),
+        mLogEvents(android::base::ShouldLog(android::base::LogSeverity::DEBUG,
+                                            "InputVerifierLogEvents")){};
 
 Result<void> InputVerifier::processMovement(DeviceId deviceId, int32_t source, int32_t action,
                                             uint32_t pointerCount,
                                             const PointerProperties* pointerProperties,
                                             const PointerCoords* pointerCoords, int32_t flags) {
+    if (!isFromSource(source, AINPUT_SOURCE_CLASS_POINTER)) {
+        // The rust verifier skips non-pointer sources like MOUSE_RELATIVE.
+        return {};
+    }
+    if (!mLogEvents && isConsistentMove(deviceId, action, pointerCount, pointerProperties)) {
+        // ACTION_MOVE doesn't change the verifier state, so there is nothing else to do.
+        return {};
+    }
+
     std::vector<RustPointerProperties> rpp;
+    rpp.reserve(pointerCount);
     for (size_t i = 0; i < pointerCount; i++) {
         rpp.emplace_back(RustPointerProperties{.id = pointerProperties[i].id});
     }
@@ -46,14 +58,78 @@ Result<void> InputVerifier::processMovement(DeviceId deviceId, int32_t source, i
             android::input::verifier::process_movement(*mVerifier, deviceId, source, action,
                                                        properties, static_cast<uint32_t>(flags));
     if (errorMessage.empty()) {
+        updateTouchingPointers(deviceId, action, pointerCount, pointerProperties);
         return {};
     } else {
+        mTouchingPointerIdsByDevice.erase(deviceId);
         return Error() << errorMessage;
     }
 }
 
 void InputVerifier::resetDevice(DeviceId deviceId) {
+    mTouchingPointerIdsByDevice.erase(deviceId);
     android::input::verifier::reset_device(*mVerifier, deviceId);
 }
 
+bool InputVerifier::isConsistentMove(DeviceId deviceId, int32_t action, uint32_t pointerCount,
+                                     const PointerProperties* pointerProperties) const {
+    if (action != AMOTION_EVENT_ACTION_MOVE || pointerCount == 0) {
+        return false;
+    }
+    auto it = mTouchingPointerIdsByDevice.find(deviceId);
+    if (it == mTouchingPointerIdsByDevice.end() || it->second.count() != pointerCount) {
+        return false;
+    }
+    // Same check as the rust verifier: the counts match and every pointer is touching.
+    for (size_t i = 0; i < pointerCount; i++) {
+        const int32_t id = pointerProperties[i].id;
+        if (id < 0 || id > MAX_POINTER_ID || !it->second.hasBit(id)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void InputVerifier::updateTouchingPointers(DeviceId deviceId, int32_t action,
+                                           uint32_t pointerCount,
+                                           const PointerProperties* pointerProperties) {
+    const int32_t actionIndex = MotionEvent::getActionIndex(action);
+    switch (MotionEvent::getActionMasked(action)) {
+        case AMOTION_EVENT_ACTION_DOWN: {
+            const int32_t id = pointerProperties[0].id;
+            if (id < 0 || id > MAX_POINTER_ID) {
+                mTouchingPointerIdsByDevice.erase(deviceId);
+                return;
+            }
+            mTouchingPointerIdsByDevice[deviceId] = BitSet32::valueForBit(id);
+            return;
+        }
+        case AMOTION_EVENT_ACTION_POINTER_DOWN:
+        case AMOTION_EVENT_ACTION_POINTER_UP: {
+            auto it = mTouchingPointerIdsByDevice.find(deviceId);
+            if (it == mTouchingPointerIdsByDevice.end()) {
+                return;
+            }
+            const int32_t id = pointerProperties[actionIndex].id;
+            if (id < 0 || id > MAX_POINTER_ID) {
+                mTouchingPointerIdsByDevice.erase(it);
+            } else if (MotionEvent::getActionMasked(action) == AMOTION_EVENT_ACTION_POINTER_DOWN) {
+                it->second.markBit(id);
+            } else {
+                it->second.clearBit(id);
+            }
+            return;
+        }
+        case AMOTION_EVENT_ACTION_UP:
+        case AMOTION_EVENT_ACTION_CANCEL: {
+            mTouchingPointerIdsByDevice.erase(deviceId);
+            return;
+        }
+        default: {
+            // Other actions don't change the touching pointers.
+            return;
+        }
+    }
+}
+
 } // namespace android
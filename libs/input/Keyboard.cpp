@@ -18,9 +18,13 @@
 
 #include <limits.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 
+#include <android-base/thread_annotations.h>
 #include <input/InputDevice.h>
 #include <input/InputEventLabels.h>
 #include <input/KeyCharacterMap.h>
@@ -31,6 +35,105 @@
 
 namespace android {
 
+namespace {
+
+/**
+ * Identifies one version of a file on disk. A cached key map is only reused while its file has
+ * the same stamp, so an edited file is picked up by the next device that loads it.
+ */
+struct FileStamp {
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    struct timespec modified;
+
+    bool operator==(const FileStamp& other) const {
+        return device == other.device && inode == other.inode && size == other.size &&
+                modified.tv_sec == other.modified.tv_sec &&
+                modified.tv_nsec == other.modified.tv_nsec;
+    }
+};
+
+std::optional<FileStamp> stampFile(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return std::nullopt;
+    }
+    return FileStamp{st.st_dev, st.st_ino, st.st_size, st.st_mtim};
+}
+
+/**
+ * Parsed key maps by file path. Most devices share a handful of files (every keyboard without a
+ * layout of its own ends up on Generic), so this saves re-tokenizing and re-parsing them each
+ * time a device is attached.
+ */
+template <typename Map>
+class KeyMapFileCache {
+public:
+    std::shared_ptr<Map> find(const std::string& path, const FileStamp& stamp) {
+        std::scoped_lock lock(mLock);
+        auto it = mEntries.find(path);
+        if (it == mEntries.end() || !(it->second.stamp == stamp)) {
+            return nullptr;
+        }
+        return it->second.map;
+    }
+
+    void insert(const std::string& path, const FileStamp& stamp, std::shared_ptr<Map> map) {
+        std::scoped_lock lock(mLock);
+        mEntries.insert_or_assign(path, Entry{stamp, std::move(map)});
+    }
+
+private:
+    struct Entry {
+        FileStamp stamp;
+        std::shared_ptr<Map> map;
+    };
+    std::mutex mLock;
+    std::unordered_map<std::string, Entry> mEntries GUARDED_BY(mLock);
+};
+
+base::Result<std::shared_ptr<KeyLayoutMap>> loadKeyLayoutMap(const std::string& path) {
+    // Intentionally leaked to avoid destruction order issues at exit.
+    static auto& cache = *new KeyMapFileCache<KeyLayoutMap>();
+
+    // KeyLayoutMap is immutable once loaded, so every device can share the cached instance.
+    const std::optional<FileStamp> stamp = stampFile(path);
+    if (stamp) {
+        if (std::shared_ptr<KeyLayoutMap> map = cache.find(path, *stamp); map != nullptr) {
+            return map;
+        }
+    }
+    base::Result<std::shared_ptr<KeyLayoutMap>> ret = KeyLayoutMap::load(path);
+    if (ret.ok() && stamp) {
+        cache.insert(path, *stamp, *ret);
+    }
+    return ret;
+}
+
+base::Result<std::shared_ptr<KeyCharacterMap>> loadKeyCharacterMap(const std::string& path) {
+    // Intentionally leaked to avoid destruction order issues at exit.
+    static auto& cache = *new KeyMapFileCache<const KeyCharacterMap>();
+
+    // A device's KeyCharacterMap is modified after loading by layout overlays and key
+    // remapping, so each device gets its own copy of the cached map.
+    const std::optional<FileStamp> stamp = stampFile(path);
+    if (stamp) {
+        if (std::shared_ptr<const KeyCharacterMap> map = cache.find(path, *stamp);
+            map != nullptr) {
+            return std::make_shared<KeyCharacterMap>(*map);
+        }
+    }
+    base::Result<std::shared_ptr<KeyCharacterMap>> ret =
+            KeyCharacterMap::load(path, KeyCharacterMap::Format::BASE);
+    if (ret.ok() && stamp) {
+        cache.insert(path, *stamp, std::make_shared<const KeyCharacterMap>(**ret));
+    }
+    return ret;
+}
+
+} // namespace
+
 static std::string getPath(const InputDeviceIdentifier& deviceIdentifier, const std::string& name,
                            InputDeviceConfigurationFileType type) {
     return name.empty()
@@ -118,7 +221,7 @@ status_t KeyMap::loadKeyLayout(const InputDeviceIdentifier& deviceIdentifier,
         return NAME_NOT_FOUND;
     }
 
-    base::Result<std::shared_ptr<KeyLayoutMap>> ret = KeyLayoutMap::load(path);
+    base::Result<std::shared_ptr<KeyLayoutMap>> ret = loadKeyLayoutMap(path);
     if (ret.ok()) {
         keyLayoutMap = *ret;
         keyLayoutFile = path;
@@ -132,7 +235,7 @@ status_t KeyMap::loadKeyLayout(const InputDeviceIdentifier& deviceIdentifier,
                                                                   InputDeviceConfigurationFileType::
                                                                           KEY_LAYOUT,
                                                                   "_fallback"));
-    ret = KeyLayoutMap::load(fallbackPath);
+    ret = loadKeyLayoutMap(fallbackPath);
     if (!ret.ok()) {
         return ret.error().code();
     }
@@ -149,8 +252,7 @@ status_t KeyMap::loadKeyCharacterMap(const InputDeviceIdentifier& deviceIdentifi
         return NAME_NOT_FOUND;
     }
 
-    base::Result<std::shared_ptr<KeyCharacterMap>> ret =
-            KeyCharacterMap::load(path, KeyCharacterMap::Format::BASE);
+    base::Result<std::shared_ptr<KeyCharacterMap>> ret = loadKeyCharacterMap(path);
     if (!ret.ok()) {
         return ret.error().code();
     }
@@ -228,6 +228,17 @@ std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
     if (mBuffers == nullptr || !mBuffers->isReady()) {
         return nullptr;
     }
+    std::unique_ptr<MotionEvent> prediction = std::make_unique<MotionEvent>();
+    if (!predict(timestamp, *prediction)) {
+        return nullptr;
+    }
+    return prediction;
+}
+
+bool MotionPredictor::predict(nsecs_t timestamp, MotionEvent& outPrediction) {
+    if (mBuffers == nullptr || !mBuffers->isReady()) {
+        return false;
+    }
 
     LOG_ALWAYS_FATAL_IF(!mModel);
     mBuffers->copyTo(*mModel);
@@ -257,7 +268,6 @@ std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
     LOG_ALWAYS_FATAL_IF(!mLastEvent);
     const MotionEvent& event = *mLastEvent;
     bool hasPredictions = false;
-    std::unique_ptr<MotionEvent> prediction = std::make_unique<MotionEvent>();
     int64_t predictionTime = mBuffers->lastTimestamp();
     const int64_t futureTime = timestamp + mPredictionTimestampOffsetNanos;
 
@@ -313,17 +323,18 @@ std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
         predictionTime += mModel->config().predictionInterval;
         if (i == 0) {
             hasPredictions = true;
-            prediction->initialize(InputEvent::nextId(), event.getDeviceId(), event.getSource(),
-                                   event.getDisplayId(), INVALID_HMAC, AMOTION_EVENT_ACTION_MOVE,
-                                   event.getActionButton(), event.getFlags(), event.getEdgeFlags(),
-                                   event.getMetaState(), event.getButtonState(),
-                                   event.getClassification(), event.getTransform(),
-                                   event.getXPrecision(), event.getYPrecision(),
-                                   event.getRawXCursorPosition(), event.getRawYCursorPosition(),
-                                   event.getRawTransform(), event.getDownTime(), predictionTime,
-                                   event.getPointerCount(), event.getPointerProperties(), &coords);
+            outPrediction.initialize(InputEvent::nextId(), event.getDeviceId(), event.getSource(),
+                                     event.getDisplayId(), INVALID_HMAC, AMOTION_EVENT_ACTION_MOVE,
+                                     event.getActionButton(), event.getFlags(),
+                                     event.getEdgeFlags(), event.getMetaState(),
+                                     event.getButtonState(), event.getClassification(),
+                                     event.getTransform(), event.getXPrecision(),
+                                     event.getYPrecision(), event.getRawXCursorPosition(),
+                                     event.getRawYCursorPosition(), event.getRawTransform(),
+                                     event.getDownTime(), predictionTime, event.getPointerCount(),
+                                     event.getPointerProperties(), &coords);
         } else {
-            prediction->addSample(predictionTime, &coords);
+            outPrediction.addSample(predictionTime, &coords);
         }
 
         axisFrom = axisTo;
@@ -331,14 +342,14 @@ std::unique_ptr<MotionEvent> MotionPredictor::predict(nsecs_t timestamp) {
     }
 
     if (!hasPredictions) {
-        return nullptr;
+        return false;
     }
 
     // Pass predictions to the MetricsManager.
     LOG_ALWAYS_FATAL_IF(!mMetricsManager);
-    mMetricsManager->onPredict(*prediction);
+    mMetricsManager->onPredict(outPrediction);
 
-    return prediction;
+    return true;
 }
 
 bool MotionPredictor::isPredictionAvailable(int32_t /*deviceId*/, int32_t source) {
@@ -56,13 +56,14 @@ std::unordered_set<std::string> PropertyMap::getKeysWithPrefix(const std::string
     return keys;
 }
 
-bool PropertyMap::hasProperty(const std::string& key) const {
-    return mProperties.find(key) != mProperties.end();
+const std::string* PropertyMap::findValue(const std::string& key) const {
+    auto it = mProperties.find(key);
+    return it != mProperties.end() ? &it->second : nullptr;
 }
 
 std::optional<std::string> PropertyMap::getString(const std::string& key) const {
-    auto it = mProperties.find(key);
-    return it != mProperties.end() ? std::make_optional(it->second) : std::nullopt;
+    const std::string* value = findValue(key);
+    return value != nullptr ? std::make_optional(*value) : std::nullopt;
 }
 
 std::optional<bool> PropertyMap::getBool(const std::string& key) const {
@@ -71,8 +72,8 @@ std::optional<bool> PropertyMap::getBool(const std::string& key) const {
 }
 
 std::optional<int32_t> PropertyMap::getInt(const std::string& key) const {
-    std::optional<std::string> stringValue = getString(key);
-    if (!stringValue.has_value() || stringValue->length() == 0) {
+    const std::string* stringValue = findValue(key);
+    if (stringValue == nullptr || stringValue->empty()) {
         return std::nullopt;
     }
 
@@ -87,8 +88,8 @@ std::optional<int32_t> PropertyMap::getInt(const std::string& key) const {
 }
 
 std::optional<float> PropertyMap::getFloat(const std::string& key) const {
-    std::optional<std::string> stringValue = getString(key);
-    if (!stringValue.has_value() || stringValue->length() == 0) {
+    const std::string* stringValue = findValue(key);
+    if (stringValue == nullptr || stringValue->empty()) {
         return std::nullopt;
     }
 
@@ -103,8 +104,8 @@ std::optional<float> PropertyMap::getFloat(const std::string& key) const {
 }
 
 std::optional<double> PropertyMap::getDouble(const std::string& key) const {
-    std::optional<std::string> stringValue = getString(key);
-    if (!stringValue.has_value() || stringValue->length() == 0) {
+    const std::string* stringValue = findValue(key);
+    if (stringValue == nullptr || stringValue->empty()) {
         return std::nullopt;
     }
 
@@ -200,13 +201,12 @@ status_t PropertyMap::Parser::parse() {
                 return BAD_VALUE;
             }
 
-            if (mMap->hasProperty(keyToken.c_str())) {
+            // Insert and check for duplicates with a single lookup.
+            if (!mMap->mProperties.try_emplace(keyToken.c_str(), valueToken.c_str()).second) {
                 ALOGE("%s: Duplicate property value for key '%s'.",
                       mTokenizer->getLocation().c_str(), keyToken.c_str());
                 return BAD_VALUE;
             }
-
-            mMap->addProperty(keyToken.c_str(), valueToken.c_str());
         }
 
         mTokenizer->nextLine();
@@ -0,0 +1,388 @@
+/**
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "Resampler"
+
+#include <inttypes.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include <android-base/logging.h>
+#include <log/log.h>
+
+#include <input/Resampler.h>
+
+using namespace std::chrono_literals;
+
+namespace android {
+
+namespace {
+
+/**
+ * Log debug messages about the resampling decisions.
+ * Enable this via "adb shell setprop log.tag.ResamplerDebug DEBUG" (requires restart)
+ */
+const bool DEBUG_RESAMPLING =
+        __android_log_is_loggable(ANDROID_LOG_DEBUG, LOG_TAG "Debug", ANDROID_LOG_INFO);
+
+// Latency added during resampling. A few milliseconds doesn't hurt much but reduces the impact of
+// mispredicted touch positions. Matches the legacy InputConsumer.
+constexpr std::chrono::nanoseconds RESAMPLE_LATENCY = 5ms;
+
+// Minimum time difference between consecutive samples before attempting to resample.
+constexpr nsecs_t RESAMPLE_MIN_DELTA = std::chrono::nanoseconds(2ms).count();
+
+// Maximum time difference between consecutive samples before attempting to resample by
+// extrapolation.
+constexpr nsecs_t RESAMPLE_MAX_DELTA = std::chrono::nanoseconds(20ms).count();
+
+// Maximum time to predict forward from the last known state, to avoid predicting too far into the
+// future. This time is further bounded by 50% of the last time delta.
+constexpr nsecs_t RESAMPLE_MAX_PREDICTION = std::chrono::nanoseconds(8ms).count();
+
+inline float lerp(float a, float b, float alpha) {
+    return a + alpha * (b - a);
+}
+
+bool shouldResampleTool(ToolType toolType) {
+    return toolType == ToolType::FINGER || toolType == ToolType::MOUSE ||
+            toolType == ToolType::STYLUS || toolType == ToolType::UNKNOWN;
+}
+
+/**
+ * Only pointer events that start or continue a gesture carry samples that are useful for
+ * resampling the MOVE events that follow them.
+ */
+bool canResample(const MotionEvent& event) {
+    if (!isFromSource(event.getSource(), AINPUT_SOURCE_CLASS_POINTER)) {
+        return false;
+    }
+    const int32_t action = event.getActionMasked();
+    if (action != AMOTION_EVENT_ACTION_DOWN && action != AMOTION_EVENT_ACTION_POINTER_DOWN &&
+        action != AMOTION_EVENT_ACTION_MOVE) {
+        return false;
+    }
+    for (size_t i = 0; i < event.getPointerCount(); i++) {
+        if (!shouldResampleTool(event.getToolType(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// --- LinearResampler ---
+
+const PointerCoords* LinearResampler::Sample::getCoordsById(int32_t id) const {
+    for (const Pointer& pointer : pointers) {
+        if (pointer.properties.id == id) {
+            return &pointer.coords;
+        }
+    }
+    return nullptr;
+}
+
+nsecs_t LinearResampler::getResampleTime(nsecs_t frameTime) const {
+    return frameTime - RESAMPLE_LATENCY.count();
+}
+
+void LinearResampler::resampleMotionEvent(nsecs_t resampleTime, MotionEvent& motionEvent,
+                                          const InputMessage* futureSample) {
+    if (!recordSamples(motionEvent)) {
+        return;
+    }
+    resampleLinear(resampleTime, motionEvent, futureSample);
+}
+
+void LinearResampler::onUnbatchedMotionEvent(const MotionEvent& motionEvent) {
+    // Any unbatched event changes the set of pointers or ends the gesture, so the samples that were
+    // recorded so far can't be used to resample the events that follow it.
+    mLatestSamples.clear();
+    recordSamples(motionEvent);
+}
+
+bool LinearResampler::recordSamples(const MotionEvent& motionEvent) {
+    if (!canResample(motionEvent)) {
+        mLatestSamples.clear();
+        return false;
+    }
+    const size_t pointerCount = motionEvent.getPointerCount();
+    if (!mLatestSamples.empty()) {
+        const Sample& latest = mLatestSamples.back();
+        bool samePointers = latest.pointers.size() == pointerCount;
+        for (size_t i = 0; samePointers && i < pointerCount; i++) {
+            samePointers = latest.getCoordsById(motionEvent.getPointerId(i)) != nullptr;
+        }
+        if (!samePointers) {
+            mLatestSamples.clear();
+        }
+    }
+    for (size_t h = 0; h <= motionEvent.getHistorySize(); h++) {
+        if (motionEvent.isResampled(/*pointerIndex=*/0, h)) {
+            continue;
+        }
+        Sample sample{.eventTime = motionEvent.getHistoricalEventTime(h)};
+        sample.pointers.reserve(pointerCount);
+        for (size_t i = 0; i < pointerCount; i++) {
+            sample.pointers.push_back({*motionEvent.getPointerProperties(i),
+                                       *motionEvent.getHistoricalRawPointerCoords(i, h)});
+        }
+        mLatestSamples.pushBack(std::move(sample));
+    }
+    return !mLatestSamples.empty();
+}
+
+void LinearResampler::resampleLinear(nsecs_t resampleTime, MotionEvent& motionEvent,
+                                     const InputMessage* futureSample) const {
+    if (motionEvent.getAction() != AMOTION_EVENT_ACTION_MOVE || mLatestSamples.empty()) {
+        return;
+    }
+    const Sample& current = mLatestSamples.back();
+
+    // Find the data to use for resampling.
+    Sample future;
+    const Sample* other;
+    float alpha;
+    if (futureSample != nullptr) {
+        // Interpolate between current sample and future sample.
+        // So current.eventTime <= resampleTime <= future.eventTime.
+        future.eventTime = futureSample->body.motion.eventTime;
+        for (uint32_t i = 0; i < futureSample->body.motion.pointerCount; i++) {
+            future.pointers.push_back({futureSample->body.motion.pointers[i].properties,
+                                       futureSample->body.motion.pointers[i].coords});
+        }
+        other = &future;
+        const nsecs_t delta = future.eventTime - current.eventTime;
+        if (delta < RESAMPLE_MIN_DELTA) {
+            ALOGD_IF(DEBUG_RESAMPLING, "Not resampled, delta time is too small: %" PRId64 " ns.",
+                     delta);
+            return;
+        }
+        alpha = float(resampleTime - current.eventTime) / delta;
+    } else if (mLatestSamples.size() >= 2) {
+        // Extrapolate future sample using current sample and past sample.
+        // So other.eventTime <= current.eventTime <= resampleTime.
+        other = &mLatestSamples[mLatestSamples.size() - 2];
+        const nsecs_t delta = current.eventTime - other->eventTime;
+        if (delta < RESAMPLE_MIN_DELTA) {
+            ALOGD_IF(DEBUG_RESAMPLING, "Not resampled, delta time is too small: %" PRId64 " ns.",
+                     delta);
+            return;
+        } else if (delta > RESAMPLE_MAX_DELTA) {
+            ALOGD_IF(DEBUG_RESAMPLING, "Not resampled, delta time is too large: %" PRId64 " ns.",
+                     delta);
+            return;
+        }
+        const nsecs_t maxPredict =
+                current.eventTime + std::min(delta / 2, RESAMPLE_MAX_PREDICTION);
+        resampleTime = std::min(resampleTime, maxPredict);
+        alpha = float(current.eventTime - resampleTime) / delta;
+    } else {
+        ALOGD_IF(DEBUG_RESAMPLING, "Not resampled, insufficient data.");
+        return;
+    }
+
+    addResampledSample(resampleTime, motionEvent,
+                       [&](int32_t id, const PointerCoords& currentCoords,
+                           PointerCoords& outCoords) {
+                           const PointerCoords* otherCoords = other->getCoordsById(id);
+                           if (otherCoords == nullptr) {
+                               ALOGD_IF(DEBUG_RESAMPLING,
+                                        "Not resampled, the other doesn't have pointer id %d.", id);
+                               return false;
+                           }
+                           outCoords.setAxisValue(AMOTION_EVENT_AXIS_X,
+                                                  lerp(currentCoords.getX(), otherCoords->getX(),
+                                                       alpha));
+                           outCoords.setAxisValue(AMOTION_EVENT_AXIS_Y,
+                                                  lerp(currentCoords.getY(), otherCoords->getY(),
+                                                       alpha));
+                           return true;
+                       });
+}
+
+void LinearResampler::addResampledSample(
+        nsecs_t resampleTime, MotionEvent& motionEvent,
+        const std::function<bool(int32_t id, const PointerCoords& current,
+                                 PointerCoords& outCoords)>& resampleCoords) const {
+    const Sample& current = mLatestSamples.back();
+    if (resampleTime <= current.eventTime) {
+        ALOGD_IF(DEBUG_RESAMPLING, "Not resampled, resample time is not after the latest sample.");
+        return;
+    }
+    const size_t pointerCount = motionEvent.getPointerCount();
+    std::vector<PointerCoords> resampledCoords;
+    resampledCoords.reserve(pointerCount);
+    for (size_t i = 0; i < pointerCount; i++) {
+        const int32_t id = motionEvent.getPointerId(i);
+        const PointerCoords* currentCoords = current.getCoordsById(id);
+        if (currentCoords == nullptr) {
+            ALOGD_IF(DEBUG_RESAMPLING, "Not resampled, missing id %d", id);
+            return;
+        }
+        PointerCoords& coords = resampledCoords.emplace_back(*currentCoords);
+        coords.isResampled = true;
+        if (!resampleCoords(id, *currentCoords, coords)) {
+            return;
+        }
+    }
+    motionEvent.addSample(resampleTime, resampledCoords.data());
+}
+
+// --- CatmullRomResampler ---
+
+void CatmullRomResampler::resampleMotionEvent(nsecs_t resampleTime, MotionEvent& motionEvent,
+                                              const InputMessage* futureSample) {
+    if (!recordSamples(motionEvent)) {
+        return;
+    }
+    if (motionEvent.getAction() != AMOTION_EVENT_ACTION_MOVE || futureSample == nullptr ||
+        mLatestSamples.size() < 2) {
+        resampleLinear(resampleTime, motionEvent, futureSample);
+        return;
+    }
+
+    // Resample between p1 and p2, using p0 to estimate the tangent at p1. There is no sample after
+    // p2 yet, so the tangent at p2 is the secant p1 -> p2.
+    const Sample& p0 = mLatestSamples[mLatestSamples.size() - 2];
+    const Sample& p1 = mLatestSamples.back();
+    const nsecs_t t2 = futureSample->body.motion.eventTime;
+    const nsecs_t interval = t2 - p1.eventTime;
+    if (interval < RESAMPLE_MIN_DELTA || p1.eventTime - p0.eventTime > RESAMPLE_MAX_DELTA) {
+        resampleLinear(resampleTime, motionEvent, futureSample);
+        return;
+    }
+    // Scale the tangent at p1 to the [p1, p2] interval, since the samples are not evenly spaced.
+    const float tangentScale = float(interval) / (t2 - p0.eventTime);
+    const float s = float(resampleTime - p1.eventTime) / interval;
+    const float s2 = s * s;
+    const float s3 = s2 * s;
+    const float h00 = 2 * s3 - 3 * s2 + 1;
+    const float h10 = s3 - 2 * s2 + s;
+    const float h01 = -2 * s3 + 3 * s2;
+    const float h11 = s3 - s2;
+
+    addResampledSample(resampleTime, motionEvent,
+                       [&](int32_t id, const PointerCoords& coords1, PointerCoords& outCoords) {
+                           const PointerCoords* coords0 = p0.getCoordsById(id);
+                           const PointerCoords* coords2 = nullptr;
+                           for (uint32_t i = 0; i < futureSample->body.motion.pointerCount; i++) {
+                               if (futureSample->body.motion.pointers[i].properties.id == id) {
+                                   coords2 = &futureSample->body.motion.pointers[i].coords;
+                               }
+                           }
+                           if (coords0 == nullptr || coords2 == nullptr) {
+                               return false;
+                           }
+                           for (const int32_t axis : {AMOTION_EVENT_AXIS_X, AMOTION_EVENT_AXIS_Y}) {
+                               const float v0 = coords0->getAxisValue(axis);
+                               const float v1 = coords1.getAxisValue(axis);
+                               const float v2 = coords2->getAxisValue(axis);
+                               const float m1 = (v2 - v0) * tangentScale;
+                               const float m2 = v2 - v1;
+                               outCoords.setAxisValue(axis,
+                                                      h00 * v1 + h10 * m1 + h01 * v2 + h11 * m2);
+                           }
+                           return true;
+                       });
+}
+
+// --- PredictingResampler ---
+
+PredictingResampler::PredictingResampler(nsecs_t presentTimeOffset,
+                                         std::unique_ptr<MotionPredictor> predictor)
+      : mPresentTimeOffset(presentTimeOffset), mPredictor(std::move(predictor)) {
+    LOG_ALWAYS_FATAL_IF(mPredictor == nullptr);
+}
+
+nsecs_t PredictingResampler::getResampleTime(nsecs_t frameTime) const {
+    return frameTime + mPresentTimeOffset;
+}
+
+void PredictingResampler::resampleMotionEvent(nsecs_t resampleTime, MotionEvent& motionEvent,
+                                              const InputMessage* futureSample) {
+    const bool canResampleEvent = recordSamples(motionEvent);
+    const bool canPredict =
+            mPredictor->isPredictionAvailable(motionEvent.getDeviceId(), motionEvent.getSource());
+    if (canPredict) {
+        // The predictor has to see every sample of the gesture, even the ones we don't resample.
+        mPredictor->record(motionEvent);
+    }
+    if (!canResampleEvent) {
+        return;
+    }
+    if (futureSample != nullptr) {
+        // Real samples past the frame are already queued, so interpolate towards them rather than
+        // predicting beyond them.
+        resampleLinear(std::min(resampleTime, futureSample->body.motion.eventTime), motionEvent,
+                       futureSample);
+        return;
+    }
+    if (!canPredict || motionEvent.getAction() != AMOTION_EVENT_ACTION_MOVE ||
+        motionEvent.getPointerCount() != 1 || !mPredictor->predict(resampleTime, mPrediction)) {
+        resampleLinear(resampleTime, motionEvent, futureSample);
+        return;
+    }
+
+    // The predicted samples are spaced by the model's prediction interval. Interpolate between the
+    // two that surround the resample time, starting from the latest real sample. If the prediction
+    // stops short of the resample time, use its last sample.
+    const Sample& current = mLatestSamples.back();
+    nsecs_t previousTime = current.eventTime;
+    const PointerCoords* previousCoords = &current.pointers[0].coords;
+    nsecs_t sampleTime = resampleTime;
+    float x = previousCoords->getX();
+    float y = previousCoords->getY();
+    bool found = false;
+    for (size_t h = 0; h <= mPrediction.getHistorySize(); h++) {
+        const nsecs_t time = mPrediction.getHistoricalEventTime(h);
+        const PointerCoords* coords = mPrediction.getHistoricalRawPointerCoords(0, h);
+        if (time >= resampleTime) {
+            const float alpha = time > previousTime
+                    ? float(resampleTime - previousTime) / (time - previousTime)
+                    : 1.0f;
+            x = lerp(previousCoords->getX(), coords->getX(), alpha);
+            y = lerp(previousCoords->getY(), coords->getY(), alpha);
+            found = true;
+            break;
+        }
+        previousTime = time;
+        previousCoords = coords;
+    }
+    if (!found) {
+        sampleTime = previousTime;
+        x = previousCoords->getX();
+        y = previousCoords->getY();
+    }
+
+    addResampledSample(sampleTime, motionEvent,
+                       [&](int32_t, const PointerCoords&, PointerCoords& outCoords) {
+                           outCoords.setAxisValue(AMOTION_EVENT_AXIS_X, x);
+                           outCoords.setAxisValue(AMOTION_EVENT_AXIS_Y, y);
+                           return true;
+                       });
+}
+
+void PredictingResampler::onUnbatchedMotionEvent(const MotionEvent& motionEvent) {
+    LinearResampler::onUnbatchedMotionEvent(motionEvent);
+    if (mPredictor->isPredictionAvailable(motionEvent.getDeviceId(), motionEvent.getSource())) {
+        mPredictor->record(motionEvent);
+    }
+}
+
+} // namespace android
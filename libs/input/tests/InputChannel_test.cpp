@@ -226,6 +226,114 @@ TEST_F(InputChannelTest, SendAndReceive_MotionClassification) {
     }
 }
 
+TEST_F(InputChannelTest, SendAndReceive_MotionPointersWithDifferentAxes) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    status_t result =
+            InputChannel::openInputChannelPair("channel name", serverChannel, clientChannel);
+    ASSERT_EQ(OK, result) << "should have successfully opened a channel pair";
+
+    InputMessage serverMsg = {};
+    serverMsg.header.type = InputMessage::Type::MOTION;
+    serverMsg.header.seq = 1;
+    serverMsg.body.motion.eventTime = 123;
+    serverMsg.body.motion.pointerCount = 3;
+    for (uint32_t i = 0; i < serverMsg.body.motion.pointerCount; i++) {
+        InputMessage::Body::Motion::Pointer& pointer = serverMsg.body.motion.pointers[i];
+        pointer.properties.id = i;
+        pointer.properties.toolType = ToolType::FINGER;
+        pointer.coords.clear();
+        pointer.coords.setAxisValue(AMOTION_EVENT_AXIS_X, 10 * i);
+        pointer.coords.setAxisValue(AMOTION_EVENT_AXIS_Y, 20 * i);
+    }
+    // Give the pointers different numbers of axes so that they pack to different sizes.
+    serverMsg.body.motion.pointers[1].coords.setAxisValue(AMOTION_EVENT_AXIS_PRESSURE, 0.5);
+    serverMsg.body.motion.pointers[1].coords.setAxisValue(AMOTION_EVENT_AXIS_GENERIC_16, 16);
+    serverMsg.body.motion.pointers[2].coords.isResampled = true;
+    ASSERT_EQ(OK, serverChannel->sendMessage(&serverMsg));
+
+    InputMessage clientMsg;
+    ASSERT_EQ(OK, clientChannel->receiveMessage(&clientMsg));
+    ASSERT_EQ(InputMessage::Type::MOTION, clientMsg.header.type);
+    EXPECT_EQ(123, clientMsg.body.motion.eventTime);
+    ASSERT_EQ(3u, clientMsg.body.motion.pointerCount);
+    for (uint32_t i = 0; i < clientMsg.body.motion.pointerCount; i++) {
+        EXPECT_EQ(serverMsg.body.motion.pointers[i].properties,
+                  clientMsg.body.motion.pointers[i].properties);
+        EXPECT_EQ(serverMsg.body.motion.pointers[i].coords,
+                  clientMsg.body.motion.pointers[i].coords);
+    }
+}
+
+TEST_F(InputChannelTest, SendMessage_ZeroesUnusedBytes) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    status_t result =
+            InputChannel::openInputChannelPair("channel name", serverChannel, clientChannel);
+    ASSERT_EQ(OK, result) << "should have successfully opened a channel pair";
+
+    // Fill the message with garbage so that padding and unused axis values are non-zero.
+    InputMessage serverMsg;
+    memset(&serverMsg, 0xff, sizeof(serverMsg));
+    serverMsg.header.type = InputMessage::Type::MOTION;
+    serverMsg.header.seq = 1;
+    serverMsg.body.motion.pointerCount = 1;
+    serverMsg.body.motion.pointers[0].coords.clear();
+    serverMsg.body.motion.pointers[0].coords.setAxisValue(AMOTION_EVENT_AXIS_X, 10);
+    serverMsg.body.motion.pointers[0].coords.setAxisValue(AMOTION_EVENT_AXIS_Y, 20);
+    ASSERT_EQ(OK, serverChannel->sendMessage(&serverMsg));
+
+    InputMessage clientMsg;
+    ASSERT_EQ(OK, clientChannel->receiveMessage(&clientMsg));
+    const PointerCoords& coords = clientMsg.body.motion.pointers[0].coords;
+    EXPECT_EQ(10, coords.getX());
+    EXPECT_EQ(20, coords.getY());
+    for (size_t i = 2; i < PointerCoords::MAX_AXES; i++) {
+        EXPECT_EQ(0, coords.values[i]) << "axis slot " << i << " should have been zeroed";
+    }
+    for (uint8_t byte : coords.empty) {
+        EXPECT_EQ(0, byte);
+    }
+}
+
+TEST_F(InputChannelTest, ReceiveMessages_ReturnsQueuedMessagesInOrder) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    status_t result =
+            InputChannel::openInputChannelPair("channel name", serverChannel, clientChannel);
+    ASSERT_EQ(OK, result) << "should have successfully opened a channel pair";
+
+    constexpr uint32_t kMessageCount = 5;
+    for (uint32_t seq = 1; seq <= kMessageCount; seq++) {
+        InputMessage serverMsg = {};
+        serverMsg.header.type = InputMessage::Type::FINISHED;
+        serverMsg.header.seq = seq;
+        ASSERT_EQ(OK, serverChannel->sendMessage(&serverMsg));
+    }
+
+    // A batch smaller than the queue leaves the remaining messages on the socket.
+    std::array<InputMessage, kMessageCount + 1> clientMsgs;
+    size_t received = 0;
+    ASSERT_EQ(OK, clientChannel->receiveMessages(clientMsgs.data(), 2, &received));
+    ASSERT_EQ(2u, received);
+    EXPECT_EQ(1u, clientMsgs[0].header.seq);
+    EXPECT_EQ(2u, clientMsgs[1].header.seq);
+
+    // A batch larger than the queue drains it.
+    ASSERT_EQ(OK,
+              clientChannel->receiveMessages(clientMsgs.data(), clientMsgs.size(), &received));
+    ASSERT_EQ(3u, received);
+    for (size_t i = 0; i < received; i++) {
+        EXPECT_EQ(InputMessage::Type::FINISHED, clientMsgs[i].header.type);
+        EXPECT_EQ(i + 3, clientMsgs[i].header.seq);
+    }
+
+    EXPECT_EQ(WOULD_BLOCK,
+              clientChannel->receiveMessages(clientMsgs.data(), clientMsgs.size(), &received));
+    EXPECT_EQ(0u, received);
+
+    serverChannel.reset(); // close server channel
+    EXPECT_EQ(DEAD_OBJECT,
+              clientChannel->receiveMessages(clientMsgs.data(), clientMsgs.size(), &received));
+}
+
 TEST_F(InputChannelTest, DuplicateChannelAndAssertEqual) {
     std::unique_ptr<InputChannel> serverChannel, clientChannel;
 
@@ -51,4 +51,60 @@ TEST(InputVerifierTest, ProcessSourceClassPointer) {
     ASSERT_TRUE(result.ok());
 }
 
+namespace {
+
+Result<void> processTouch(InputVerifier& verifier, int32_t action, std::vector<int32_t> ids) {
+    std::vector<PointerProperties> properties;
+    std::vector<PointerCoords> coords;
+    for (int32_t id : ids) {
+        properties.push_back({});
+        properties.back().clear();
+        properties.back().id = id;
+        properties.back().toolType = ToolType::FINGER;
+        coords.push_back({});
+        coords.back().clear();
+    }
+    const int32_t flags = action == AMOTION_EVENT_ACTION_CANCEL ? AMOTION_EVENT_FLAG_CANCELED : 0;
+    return verifier.processMovement(/*deviceId=*/0, AINPUT_SOURCE_TOUCHSCREEN, action,
+                                    properties.size(), properties.data(), coords.data(), flags);
+}
+
+constexpr int32_t POINTER_1_DOWN =
+        AMOTION_EVENT_ACTION_POINTER_DOWN | (1 << AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT);
+constexpr int32_t POINTER_1_UP =
+        AMOTION_EVENT_ACTION_POINTER_UP | (1 << AMOTION_EVENT_ACTION_POINTER_INDEX_SHIFT);
+
+} // namespace
+
+TEST(InputVerifierTest, ConsistentMovesAreAccepted) {
+    InputVerifier verifier("ConsistentMovesAreAccepted");
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_DOWN, {0}).ok());
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {0}).ok());
+    ASSERT_TRUE(processTouch(verifier, POINTER_1_DOWN, {0, 1}).ok());
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {0, 1}).ok());
+    ASSERT_TRUE(processTouch(verifier, POINTER_1_UP, {0, 1}).ok());
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {0}).ok());
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_UP, {0}).ok());
+}
+
+TEST(InputVerifierTest, MoveWithDifferentPointersIsRejected) {
+    InputVerifier verifier("MoveWithDifferentPointersIsRejected");
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_DOWN, {0}).ok());
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {0}).ok());
+    ASSERT_FALSE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {1}).ok());
+    ASSERT_FALSE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {0, 1}).ok());
+}
+
+TEST(InputVerifierTest, MoveAfterGestureEndIsRejected) {
+    InputVerifier verifier("MoveAfterGestureEndIsRejected");
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_DOWN, {0}).ok());
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {0}).ok());
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_CANCEL, {0}).ok());
+    ASSERT_FALSE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {0}).ok());
+
+    ASSERT_TRUE(processTouch(verifier, AMOTION_EVENT_ACTION_DOWN, {0}).ok());
+    verifier.resetDevice(/*deviceId=*/0);
+    ASSERT_FALSE(processTouch(verifier, AMOTION_EVENT_ACTION_MOVE, {0}).ok());
+}
+
 } // namespace android
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <input/Input.h>
+#include <input/MotionPredictor.h>
+
+namespace android {
+
+namespace {
+
+constexpr nsecs_t SAMPLE_INTERVAL = 4'000'000; // A 240Hz stylus.
+constexpr nsecs_t FRAME_INTERVAL = 16'666'667;
+
+MotionEvent createStylusEvent(int32_t action, nsecs_t downTime, nsecs_t eventTime, float x) {
+    PointerProperties properties;
+    properties.clear();
+    properties.id = 0;
+    properties.toolType = ToolType::STYLUS;
+    PointerCoords coords;
+    coords.clear();
+    coords.setAxisValue(AMOTION_EVENT_AXIS_X, x);
+    coords.setAxisValue(AMOTION_EVENT_AXIS_Y, 2 * x);
+    coords.setAxisValue(AMOTION_EVENT_AXIS_PRESSURE, 0.5);
+
+    ui::Transform identityTransform;
+    MotionEvent event;
+    event.initialize(InputEvent::nextId(), /*deviceId=*/1, AINPUT_SOURCE_STYLUS,
+                     ui::LogicalDisplayId::DEFAULT, INVALID_HMAC, action, /*actionButton=*/0,
+                     /*flags=*/0, AMOTION_EVENT_EDGE_FLAG_NONE, AMETA_NONE, /*buttonState=*/0,
+                     MotionClassification::NONE, identityTransform, /*xPrecision=*/0,
+                     /*yPrecision=*/0, AMOTION_EVENT_INVALID_CURSOR_POSITION,
+                     AMOTION_EVENT_INVALID_CURSOR_POSITION, identityTransform, downTime, eventTime,
+                     /*pointerCount=*/1, &properties, &coords);
+    return event;
+}
+
+/**
+ * Records a steady stylus stroke and predicts once per frame, the way a drawing app would.
+ * Argument: whether the prediction is written into a reused event rather than a new one.
+ */
+void BM_MotionPredictor_PredictPerFrame(benchmark::State& state) {
+    const bool reuseEvent = state.range(0) != 0;
+    MotionPredictor predictor(/*predictionTimestampOffsetNanos=*/0, []() { return true; });
+    MotionEvent prediction;
+
+    const nsecs_t downTime = 0;
+    nsecs_t eventTime = downTime;
+    float x = 100;
+    predictor.record(createStylusEvent(AMOTION_EVENT_ACTION_DOWN, downTime, eventTime, x));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (nsecs_t frameEnd = eventTime + FRAME_INTERVAL; eventTime < frameEnd;) {
+            eventTime += SAMPLE_INTERVAL;
+            x += 2;
+            predictor.record(createStylusEvent(AMOTION_EVENT_ACTION_MOVE, downTime, eventTime, x));
+        }
+        state.ResumeTiming();
+
+        if (reuseEvent) {
+            benchmark::DoNotOptimize(predictor.predict(eventTime + FRAME_INTERVAL, prediction));
+        } else {
+            benchmark::DoNotOptimize(predictor.predict(eventTime + FRAME_INTERVAL));
+        }
+    }
+}
+BENCHMARK(BM_MotionPredictor_PredictPerFrame)->ArgName("reuseEvent")->Arg(0)->Arg(1);
+
+} // namespace
+
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -210,6 +210,41 @@ TEST(MotionPredictorTest, FollowsGesture) {
     EXPECT_EQ(nullptr, predictor.predict(100 * NSEC_PER_MSEC));
 }
 
+TEST(MotionPredictorTest, PredictIntoReusedEvent) {
+    MotionPredictor allocatingPredictor(/*predictionTimestampOffsetNanos=*/0,
+                                        []() { return true /*enable prediction*/; });
+    MotionPredictor reusingPredictor(/*predictionTimestampOffsetNanos=*/0,
+                                     []() { return true /*enable prediction*/; });
+    MotionEvent reused;
+
+    std::chrono::nanoseconds eventTime = 20ms;
+    allocatingPredictor.record(getMotionEvent(DOWN, 3.75, 3, eventTime));
+    reusingPredictor.record(getMotionEvent(DOWN, 3.75, 3, eventTime));
+    // Move at a constant velocity so that jerk pruning does not drop the predictions.
+    for (float x = 5.25; x < 20; x += 1.5) {
+        eventTime += 10ms;
+        allocatingPredictor.record(getMotionEvent(MOVE, x, 3, eventTime));
+        reusingPredictor.record(getMotionEvent(MOVE, x, 3, eventTime));
+
+        const nsecs_t predictionTime = (eventTime + 40ms).count();
+        std::unique_ptr<MotionEvent> expected = allocatingPredictor.predict(predictionTime);
+        ASSERT_NE(nullptr, expected);
+        ASSERT_TRUE(reusingPredictor.predict(predictionTime, reused));
+
+        // The reused event must not retain samples from earlier predictions.
+        ASSERT_EQ(expected->getHistorySize(), reused.getHistorySize());
+        for (size_t i = 0; i <= expected->getHistorySize(); i++) {
+            EXPECT_EQ(expected->getHistoricalEventTime(i), reused.getHistoricalEventTime(i));
+            EXPECT_EQ(*expected->getHistoricalRawPointerCoords(0, i),
+                      *reused.getHistoricalRawPointerCoords(0, i));
+        }
+    }
+
+    allocatingPredictor.record(getMotionEvent(UP, 20, 3, eventTime + 10ms));
+    reusingPredictor.record(getMotionEvent(UP, 20, 3, eventTime + 10ms));
+    EXPECT_FALSE(reusingPredictor.predict((eventTime + 50ms).count(), reused));
+}
+
 TEST(MotionPredictorTest, MultipleDevicesNotSupported) {
     MotionPredictor predictor(/*predictionTimestampOffsetNanos=*/0,
                               []() { return true /*enable prediction*/; });
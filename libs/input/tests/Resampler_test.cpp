@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+#include <input/InputEventBuilders.h>
+#include <input/Resampler.h>
+
+using namespace std::chrono_literals;
+
+namespace android {
+
+namespace {
+
+constexpr float EPSILON = 1e-3;
+
+nsecs_t toNs(std::chrono::nanoseconds duration) {
+    return duration.count();
+}
+
+MotionEvent createTouch(int32_t action, std::chrono::nanoseconds eventTime, float x, float y) {
+    return MotionEventBuilder(action, AINPUT_SOURCE_TOUCHSCREEN)
+            .downTime(0)
+            .eventTime(toNs(eventTime))
+            .pointer(PointerBuilder(/*id=*/0, ToolType::FINGER).x(x).y(y))
+            .build();
+}
+
+InputMessage createTouchMessage(std::chrono::nanoseconds eventTime, float x, float y) {
+    InputMessage msg{};
+    msg.header.type = InputMessage::Type::MOTION;
+    msg.body.motion.action = AMOTION_EVENT_ACTION_MOVE;
+    msg.body.motion.source = AINPUT_SOURCE_TOUCHSCREEN;
+    msg.body.motion.eventTime = toNs(eventTime);
+    msg.body.motion.pointerCount = 1;
+    msg.body.motion.pointers[0].properties =
+            PointerBuilder(/*id=*/0, ToolType::FINGER).buildProperties();
+    msg.body.motion.pointers[0].coords = PointerBuilder(/*id=*/0, ToolType::FINGER)
+                                                 .x(x)
+                                                 .y(y)
+                                                 .buildCoords();
+    return msg;
+}
+
+void assertResampledTo(const MotionEvent& event, std::chrono::nanoseconds eventTime, float x,
+                       float y) {
+    ASSERT_GE(event.getHistorySize(), 1u);
+    EXPECT_EQ(toNs(eventTime), event.getEventTime());
+    EXPECT_TRUE(event.isResampled(/*pointerIndex=*/0, event.getHistorySize()));
+    EXPECT_NEAR(x, event.getRawX(0), EPSILON);
+    EXPECT_NEAR(y, event.getRawY(0), EPSILON);
+}
+
+} // namespace
+
+TEST(LinearResamplerTest, ResampleTimeIsBehindFrameTime) {
+    LinearResampler resampler;
+    EXPECT_EQ(toNs(11ms), resampler.getResampleTime(toNs(16ms)));
+}
+
+TEST(LinearResamplerTest, InterpolatesTowardsFutureSample) {
+    LinearResampler resampler;
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_DOWN, 0ms, 0, 0));
+    MotionEvent move = createTouch(AMOTION_EVENT_ACTION_MOVE, 10ms, 10, 20);
+    const InputMessage future = createTouchMessage(20ms, 20, 40);
+
+    resampler.resampleMotionEvent(toNs(15ms), move, &future);
+
+    assertResampledTo(move, 15ms, 15, 30);
+}
+
+TEST(LinearResamplerTest, ExtrapolatesFromLatestSamples) {
+    LinearResampler resampler;
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_DOWN, 0ms, 0, 0));
+    MotionEvent move = createTouch(AMOTION_EVENT_ACTION_MOVE, 10ms, 10, 20);
+
+    // The prediction is capped to half of the latest delta.
+    resampler.resampleMotionEvent(toNs(20ms), move, /*futureSample=*/nullptr);
+
+    assertResampledTo(move, 15ms, 15, 30);
+}
+
+TEST(LinearResamplerTest, DoesNotExtrapolateAcrossGestures) {
+    LinearResampler resampler;
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_DOWN, 0ms, 0, 0));
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_UP, 5ms, 0, 0));
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_DOWN, 10ms, 100, 100));
+    MotionEvent move = createTouch(AMOTION_EVENT_ACTION_MOVE, 20ms, 110, 110);
+    resampler.resampleMotionEvent(toNs(22ms), move, /*futureSample=*/nullptr);
+    assertResampledTo(move, 22ms, 112, 112);
+
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_UP, 25ms, 110, 110));
+    MotionEvent strayMove = createTouch(AMOTION_EVENT_ACTION_MOVE, 30ms, 0, 0);
+    resampler.resampleMotionEvent(toNs(32ms), strayMove, /*futureSample=*/nullptr);
+    EXPECT_EQ(0u, strayMove.getHistorySize());
+}
+
+TEST(LinearResamplerTest, DoesNotExtrapolateFromDistantSamples) {
+    LinearResampler resampler;
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_DOWN, 0ms, 0, 0));
+    MotionEvent move = createTouch(AMOTION_EVENT_ACTION_MOVE, 50ms, 10, 10);
+
+    resampler.resampleMotionEvent(toNs(55ms), move, /*futureSample=*/nullptr);
+
+    EXPECT_EQ(0u, move.getHistorySize());
+    EXPECT_EQ(toNs(50ms), move.getEventTime());
+}
+
+TEST(CatmullRomResamplerTest, FollowsCurvature) {
+    CatmullRomResampler resampler;
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_DOWN, 0ms, 0, 0));
+    MotionEvent move = createTouch(AMOTION_EVENT_ACTION_MOVE, 10ms, 10, 10);
+    const InputMessage future = createTouchMessage(20ms, 20, 0);
+
+    resampler.resampleMotionEvent(toNs(15ms), move, &future);
+
+    // x moves at a constant velocity, so it stays on the line. y turns around at the peak, so the
+    // spline overshoots the chord (linear interpolation would produce 5).
+    assertResampledTo(move, 15ms, 15, 6.25);
+}
+
+TEST(CatmullRomResamplerTest, ExtrapolatesLinearly) {
+    CatmullRomResampler resampler;
+    resampler.onUnbatchedMotionEvent(createTouch(AMOTION_EVENT_ACTION_DOWN, 0ms, 0, 0));
+    MotionEvent move = createTouch(AMOTION_EVENT_ACTION_MOVE, 10ms, 10, 20);
+
+    resampler.resampleMotionEvent(toNs(12ms), move, /*futureSample=*/nullptr);
+
+    assertResampledTo(move, 12ms, 12, 24);
+}
+
+} // namespace android
@@ -193,5 +193,24 @@ TEST(TouchVideoFrame, Rotate270_3x2_4times) {
     ASSERT_EQ(frame, frameOriginal);
 }
 
+TEST(TouchVideoFrame, CopiesShareData) {
+    TouchVideoFrame frame(3, 2, {1, 2, 3, 4, 5, 6}, TIMESTAMP);
+    TouchVideoFrame copy = frame;
+    ASSERT_EQ(&frame.getData(), &copy.getData());
+    ASSERT_EQ(frame, copy);
+}
+
+TEST(TouchVideoFrame, RotatingCopyLeavesOriginalUnchanged) {
+    TouchVideoFrame frame(3, 2, {1, 2, 3, 4, 5, 6}, TIMESTAMP);
+    TouchVideoFrame rotated90 = frame;
+    rotated90.rotate(ui::ROTATION_90);
+    TouchVideoFrame rotated180 = frame;
+    rotated180.rotate(ui::ROTATION_180);
+
+    ASSERT_EQ(TouchVideoFrame(3, 2, {1, 2, 3, 4, 5, 6}, TIMESTAMP), frame);
+    ASSERT_EQ(TouchVideoFrame(2, 3, {2, 4, 6, 1, 3, 5}, TIMESTAMP), rotated90);
+    ASSERT_EQ(TouchVideoFrame(3, 2, {6, 5, 4, 3, 2, 1}, TIMESTAMP), rotated180);
+}
+
 } // namespace test
 } // namespace android
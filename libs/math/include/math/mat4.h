@@ -34,6 +34,13 @@
 #define CONSTEXPR
 #endif
 
+// GCC and Clang lower vector_size types to NEON or SSE instructions, depending on the target.
+#if __cplusplus >= 201703L && defined(__GNUC__) && defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define MATH_VECTOR_EXTENSIONS 1
+#endif
+#endif
+
 #ifdef _WIN32
 // windows.h contains obsolete defines of 'near' and 'far' for systems using
 // legacy 16 bit pointers. Undefine them to avoid conflicting with the usage of
@@ -527,9 +534,38 @@ CONSTEXPR TMat44<T> TMat44<T>::lookAt(const TVec3<A>& eye, const TVec3<B>& cente
  * it determines the output type (only relevant when T != U).
  */
 
+#ifdef MATH_VECTOR_EXTENSIONS
+namespace simd {
+
+typedef float vfloat4 __attribute__((vector_size(16)));
+
+// Equivalent to the scalar mat4 * vec4 below, with one vector multiply-add per column instead of
+// four scalar ones. Products of mat4s go through this as well, one column at a time.
+inline TVec4<float> PURE multiply(const TMat44<float>& lhs, const TVec4<float>& rhs) {
+    // The compiler merges these into single vector loads and stores.
+    const auto load = [](const TVec4<float>& v) { return vfloat4{v[0], v[1], v[2], v[3]}; };
+
+    vfloat4 result = {};
+    result += load(lhs[0]) * rhs[0];
+    result += load(lhs[1]) * rhs[1];
+    result += load(lhs[2]) * rhs[2];
+    result += load(lhs[3]) * rhs[3];
+    return TVec4<float>(result[0], result[1], result[2], result[3]);
+}
+
+} // namespace simd
+#endif
+
 // matrix * column-vector, result is a vector of the same type than the input vector
 template <typename T, typename U>
 CONSTEXPR typename TMat44<T>::col_type PURE operator *(const TMat44<T>& lhs, const TVec4<U>& rhs) {
+#ifdef MATH_VECTOR_EXTENSIONS
+    if constexpr (std::is_same<T, float>::value && std::is_same<U, float>::value) {
+        if (!__builtin_is_constant_evaluated()) {
+            return simd::multiply(lhs, rhs);
+        }
+    }
+#endif
     // Result is initialized to zero.
     typename TMat44<T>::col_type result;
     for (size_t col = 0; col < TMat44<T>::NUM_COLS; ++col) {
@@ -592,3 +628,4 @@ typedef details::TMat44<float> mat4f;
 
 #undef PURE
 #undef CONSTEXPR
+#undef MATH_VECTOR_EXTENSIONS
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <math/mat4.h>
+
+namespace android {
+namespace {
+
+// The scalar mat4 * vec4 that the vectorized operator replaces.
+vec4 scalarMultiply(const mat4& m, const vec4& v) {
+    vec4 result;
+    for (size_t col = 0; col < 4; ++col) {
+        result += m[col] * v[col];
+    }
+    return result;
+}
+
+mat4 scalarMultiply(const mat4& lhs, const mat4& rhs) {
+    mat4 result(mat4::NO_INIT);
+    for (size_t col = 0; col < 4; ++col) {
+        result[col] = scalarMultiply(lhs, rhs[col]);
+    }
+    return result;
+}
+
+const mat4 kMatrix(vec4(1, 2, 3, 4), vec4(5, 6, 7, 8), vec4(9, 10, 11, 12), vec4(13, 14, 15, 16));
+const vec4 kVector(0.5f, -1, 2, 4);
+
+void BM_Mat4MultiplyVec4_Scalar(benchmark::State& state) {
+    mat4 m = kMatrix;
+    vec4 v = kVector;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(scalarMultiply(m, v));
+    }
+}
+BENCHMARK(BM_Mat4MultiplyVec4_Scalar);
+
+void BM_Mat4MultiplyVec4(benchmark::State& state) {
+    mat4 m = kMatrix;
+    vec4 v = kVector;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(m);
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(m * v);
+    }
+}
+BENCHMARK(BM_Mat4MultiplyVec4);
+
+void BM_Mat4MultiplyMat4_Scalar(benchmark::State& state) {
+    mat4 lhs = kMatrix;
+    mat4 rhs = transpose(kMatrix);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(rhs);
+        benchmark::DoNotOptimize(scalarMultiply(lhs, rhs));
+    }
+}
+BENCHMARK(BM_Mat4MultiplyMat4_Scalar);
+
+void BM_Mat4MultiplyMat4(benchmark::State& state) {
+    mat4 lhs = kMatrix;
+    mat4 rhs = transpose(kMatrix);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs);
+        benchmark::DoNotOptimize(rhs);
+        benchmark::DoNotOptimize(lhs * rhs);
+    }
+}
+BENCHMARK(BM_Mat4MultiplyMat4);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
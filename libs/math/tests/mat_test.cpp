@@ -150,6 +150,36 @@ TEST_F(MatTest, MiscOps) {
     }
 }
 
+TEST_F(MatTest, MultiplyMatchesScalarReference) {
+    const mat4 m1(vec4(1, 2, 3, 4), vec4(5, 6, 7, 8), vec4(9, 10, 11, 12), vec4(13, 14, 15, 16));
+    const mat4 m2(vec4(-1, 0.5f, 2, 0), vec4(0.25f, 3, -2, 1), vec4(1, 1, 1, 1),
+                  vec4(0, -4, 0.125f, 2));
+    const vec4 v(0.5f, -1, 2, 4);
+
+    // mat4 * vec4 may be vectorized, so compare it against a plain loop over the elements.
+    const auto multiply = [](const mat4& m, const vec4& u) {
+        vec4 result;
+        for (size_t r = 0; r < 4; r++) {
+            for (size_t c = 0; c < 4; c++) {
+                result[r] += m[c][r] * u[c];
+            }
+        }
+        return result;
+    };
+
+    EXPECT_EQ(vec4(65.5f, 71, 76.5f, 82), m1 * v);
+    EXPECT_EQ(multiply(m1, v), m1 * v);
+
+    const mat4 product = m1 * m2;
+    for (size_t c = 0; c < 4; c++) {
+        EXPECT_EQ(multiply(m1, m2[c]), product[c]);
+    }
+
+    mat4 m3 = m1;
+    m3 *= m2;
+    EXPECT_EQ(product, m3);
+}
+
 TEST_F(MatTest, ElementAccess) {
     mat4 m(vec4(1, 2, 3, 4), vec4(5, 6, 7, 8), vec4(9, 10, 11, 12), vec4(13, 14, 15, 16));
     for (size_t c=0 ; c<4 ; c++) {
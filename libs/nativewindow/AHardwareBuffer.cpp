@@ -638,6 +638,40 @@ enum AHardwareBufferStatus AHardwareBuffer_allocateWithOptions(
     return AHARDWAREBUFFER_STATUS_OK;
 }
 
+enum AHardwareBufferStatus AHardwareBuffer_allocateBatch(const AHardwareBuffer_Desc* desc,
+                                                         uint32_t count,
+                                                         AHardwareBuffer** outBuffers) {
+    if (!outBuffers || !desc || count == 0) return AHARDWAREBUFFER_STATUS_BAD_VALUE;
+    if (!AHardwareBuffer_isValidDescription(desc, /*log=*/true)) {
+        return AHARDWAREBUFFER_STATUS_BAD_VALUE;
+    }
+
+    int format = AHardwareBuffer_convertToPixelFormat(desc->format);
+    uint64_t usage = AHardwareBuffer_convertToGrallocUsageBits(desc->usage);
+
+    std::vector<sp<GraphicBuffer>> gbuffers;
+    status_t err = GraphicBuffer::allocateBatch(desc->width, desc->height, format, desc->layers,
+                                                usage, count,
+                                                std::string("AHardwareBuffer pid [") +
+                                                        std::to_string(getpid()) + "]",
+                                                &gbuffers);
+    if (err != NO_ERROR) {
+        if (err == NO_MEMORY) {
+            GraphicBuffer::dumpAllocationsToSystemLog();
+        }
+        ALOGE("GraphicBuffer::allocateBatch(w=%u, h=%u, lc=%u, count=%u) failed (%s)",
+              desc->width, desc->height, desc->layers, count, strerror(-err));
+        return filterStatus(err);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        outBuffers[i] = AHardwareBuffer_from_GraphicBuffer(gbuffers[i].get());
+        // Ensure the buffer doesn't get destroyed when the sp<> goes away.
+        AHardwareBuffer_acquire(outBuffers[i]);
+    }
+    return AHARDWAREBUFFER_STATUS_OK;
+}
+
 // ----------------------------------------------------------------------------
 // Helpers implementation
 // ----------------------------------------------------------------------------
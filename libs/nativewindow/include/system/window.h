@@ -260,6 +260,7 @@ enum {
     NATIVE_WINDOW_SET_FRAME_TIMELINE_INFO         = 48,    /* private */
     NATIVE_WINDOW_GET_LAST_QUEUED_BUFFER2         = 49,    /* private */
     NATIVE_WINDOW_SET_BUFFERS_ADDITIONAL_OPTIONS  = 50,
+    NATIVE_WINDOW_GET_CACHED_FRAME_TIMESTAMPS     = 51,    /* private */
     // clang-format on
 };
 
@@ -991,6 +992,28 @@ static inline int native_window_get_frame_timestamps(
             outDequeueReadyTime, outReleaseTime);
 }
 
+/*
+ * Same as native_window_get_frame_timestamps, but only returns what the
+ * producer side has already received, and never asks the consumer for newer
+ * timestamps. Timestamps not received yet are reported as
+ * NATIVE_WINDOW_TIMESTAMP_PENDING. Useful when querying many frames together,
+ * right after one native_window_get_frame_timestamps call has updated them all.
+ */
+static inline int native_window_get_cached_frame_timestamps(
+        struct ANativeWindow* window, uint64_t frameId,
+        int64_t* outRequestedPresentTime, int64_t* outAcquireTime,
+        int64_t* outLatchTime, int64_t* outFirstRefreshStartTime,
+        int64_t* outLastRefreshStartTime, int64_t* outGpuCompositionDoneTime,
+        int64_t* outDisplayPresentTime, int64_t* outDequeueReadyTime,
+        int64_t* outReleaseTime)
+{
+    return window->perform(window, NATIVE_WINDOW_GET_CACHED_FRAME_TIMESTAMPS,
+            frameId, outRequestedPresentTime, outAcquireTime, outLatchTime,
+            outFirstRefreshStartTime, outLastRefreshStartTime,
+            outGpuCompositionDoneTime, outDisplayPresentTime,
+            outDequeueReadyTime, outReleaseTime);
+}
+
 /* deprecated. Always returns 0 and outSupport holds true. Don't call. */
 static inline int native_window_get_wide_color_support (
     struct ANativeWindow* window __UNUSED, bool* outSupport) __deprecated;
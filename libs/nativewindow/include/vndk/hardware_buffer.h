@@ -155,6 +155,29 @@ enum AHardwareBufferStatus AHardwareBuffer_allocateWithOptions(
         const AHardwareBufferLongOptions* _Nullable additionalOptions, size_t additionalOptionsSize,
         AHardwareBuffer* _Nullable* _Nonnull outBuffer) __INTRODUCED_IN(__ANDROID_API_V__);
 
+/**
+ * Allocates \a count buffers that all match the passed AHardwareBuffer_Desc.
+ *
+ * The descriptor is validated once and, where the gralloc HAL supports it, every buffer is
+ * allocated in a single allocator transaction. This is cheaper than calling
+ * AHardwareBuffer_allocate() count times when filling a buffer pool.
+ *
+ * @param desc The AHardwareBuffer_Desc that describes the allocations to request. Note that
+ *             `stride` is ignored.
+ * @param count The number of buffers to allocate; must be nonzero
+ * @param outBuffers An array with room for \a count buffers
+ * @return AHARDWAREBUFFER_STATUS_OK on success, in which case every entry of \a outBuffers holds
+ *         a buffer with a reference count of 1
+ *         AHARDWAREBUFFER_STATUS_NO_MEMORY if there's insufficient resources for the allocation
+ *         AHARDWAREBUFFER_STATUS_BAD_VALUE if the provided description is not supported by the
+ *         device
+ *         AHARDWAREBUFFER_STATUS_UNKNOWN_ERROR for any other error
+ * On failure no buffer is allocated and \a outBuffers is left untouched.
+ */
+enum AHardwareBufferStatus AHardwareBuffer_allocateBatch(
+        const AHardwareBuffer_Desc* _Nonnull desc, uint32_t count,
+        AHardwareBuffer* _Nullable* _Nonnull outBuffers) __INTRODUCED_IN(__ANDROID_API_V__);
+
 /**
  * Queries the dataspace of the given AHardwareBuffer.
  *
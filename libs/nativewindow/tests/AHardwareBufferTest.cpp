@@ -25,6 +25,9 @@
 #include <ui/GraphicBuffer.h>
 #include <vndk/hardware_buffer.h>
 
+#include <array>
+#include <set>
+
 using namespace android;
 using android::hardware::graphics::common::V1_0::BufferUsage;
 
@@ -234,6 +237,38 @@ TEST(AHardwareBufferTest, Allocate2WithExtras) {
     AHardwareBuffer_release(buffer);
 }
 
+TEST(AHardwareBufferTest, AllocateBatch) {
+    AHardwareBuffer_Desc desc{
+            .width = 64,
+            .height = 48,
+            .layers = 1,
+            .format = AHARDWAREBUFFER_FORMAT_R8G8B8A8_UNORM,
+            .usage = AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN | AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN,
+            .stride = 0,
+    };
+
+    std::array<AHardwareBuffer*, 4> buffers{};
+    ASSERT_EQ(0, AHardwareBuffer_allocateBatch(&desc, buffers.size(), buffers.data()));
+    std::set<uint64_t> ids;
+    for (AHardwareBuffer* buffer : buffers) {
+        ASSERT_NE(nullptr, buffer);
+        uint64_t id = 0;
+        EXPECT_EQ(0, AHardwareBuffer_getId(buffer, &id));
+        ids.insert(id);
+        AHardwareBuffer_Desc desc2{};
+        AHardwareBuffer_describe(buffer, &desc2);
+        EXPECT_EQ(desc.width, desc2.width);
+        EXPECT_EQ(desc.height, desc2.height);
+        EXPECT_GE(desc2.stride, desc2.width);
+        AHardwareBuffer_release(buffer);
+    }
+    EXPECT_EQ(buffers.size(), ids.size());
+
+    AHardwareBuffer* buffer = nullptr;
+    EXPECT_EQ(AHARDWAREBUFFER_STATUS_BAD_VALUE, AHardwareBuffer_allocateBatch(&desc, 0, &buffer));
+    EXPECT_EQ(nullptr, buffer);
+}
+
 TEST(AHardwareBufferTest, GetSetDataspace) {
     AHardwareBuffer_Desc desc{
             .width = 64,
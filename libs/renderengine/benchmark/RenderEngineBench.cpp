@@ -23,8 +23,12 @@
 #include <renderengine/LayerSettings.h>
 #include <renderengine/RenderEngine.h>
 #include <renderengine/impl/ExternalTexture.h>
+#include <ui/Fence.h>
+#include <utils/Timers.h>
 
+#include <algorithm>
 #include <mutex>
+#include <tuple>
 
 using namespace android;
 using namespace android::renderengine;
@@ -64,8 +68,9 @@ std::pair<uint32_t, uint32_t> getDisplaySize() {
     return std::pair<uint32_t, uint32_t>(width, height);
 }
 
-static std::unique_ptr<RenderEngine> createRenderEngine(RenderEngine::Threaded threaded,
-                                                        RenderEngine::GraphicsApi graphicsApi) {
+static std::unique_ptr<RenderEngine> createRenderEngine(
+        RenderEngine::Threaded threaded, RenderEngine::GraphicsApi graphicsApi,
+        RenderEngine::SkiaBackend skiaBackend = RenderEngine::SkiaBackend::GANESH) {
     auto args = RenderEngineCreationArgs::Builder()
                         .setPixelFormat(static_cast<int>(ui::PixelFormat::RGBA_8888))
                         .setImageCacheSize(1)
@@ -75,6 +80,7 @@ static std::unique_ptr<RenderEngine> createRenderEngine(RenderEngine::Threaded t
                         .setContextPriority(RenderEngine::ContextPriority::REALTIME)
                         .setThreaded(threaded)
                         .setGraphicsApi(graphicsApi)
+                        .setSkiaBackend(skiaBackend)
                         .build();
     return RenderEngine::create(args);
 }
@@ -131,35 +137,63 @@ static std::shared_ptr<ExternalTexture> copyBuffer(RenderEngine& re,
     return texture;
 }
 
-/**
- * Helper for timing calls to drawLayers.
- *
- * Caller needs to create RenderEngine and the LayerSettings, and this takes
- * care of setting up the display, starting and stopping the timer, calling
- * drawLayers, and saving (if --save is used).
- *
- * This times both the CPU and GPU work initiated by drawLayers. All work done
- * outside of the for loop is excluded from the timing measurements.
- */
-static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>& layers,
-                            benchmark::State& benchState, const char* saveFileName) {
-    auto [width, height] = getDisplaySize();
-    auto outputBuffer = allocateBuffer(re, width, height);
-
+static DisplaySettings makeDisplaySettings(uint32_t width, uint32_t height) {
     const Rect displayRect(0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height));
-    DisplaySettings display{
+    return DisplaySettings{
             .physicalDisplay = displayRect,
             .clip = displayRect,
             .maxLuminance = 500,
     };
+}
 
-    // This loop starts and stops the timer.
-    for (auto _ : benchState) {
-        sp<Fence> waitFence =
-                re.drawLayers(display, layers, outputBuffer, base::unique_fd()).get().value();
-        waitFence->waitForever(LOG_TAG);
+/**
+ * Accumulates the time spent in each drawLayers call, split into the part
+ * spent on the CPU before drawLayers returned and the part spent waiting for
+ * the GPU to signal the returned fence.
+ *
+ * RenderEngine does not expose GPU timer queries, so the fence's signal time
+ * is the closest per-backend measure of GPU work that we have. Both values
+ * are reported as per-iteration averages, in milliseconds.
+ */
+class DrawTimes {
+public:
+    void add(nsecs_t start, nsecs_t submitted, const sp<Fence>& fence) {
+        mCpuTime += submitted - start;
+        const nsecs_t signalTime = fence->getSignalTime();
+        if (signalTime != Fence::SIGNAL_TIME_PENDING && signalTime != Fence::SIGNAL_TIME_INVALID) {
+            mGpuTime += std::max<nsecs_t>(0, signalTime - submitted);
+        }
+    }
+
+    void report(benchmark::State& benchState) const {
+        benchState.counters["cpu_ms"] =
+                benchmark::Counter(toMillis(mCpuTime), benchmark::Counter::kAvgIterations);
+        benchState.counters["gpu_ms"] =
+                benchmark::Counter(toMillis(mGpuTime), benchmark::Counter::kAvgIterations);
     }
 
+private:
+    static double toMillis(nsecs_t ns) { return static_cast<double>(ns) / 1e6; }
+
+    nsecs_t mCpuTime = 0;
+    nsecs_t mGpuTime = 0;
+};
+
+// Draws the layers once and waits for the GPU, recording the time taken in drawTimes.
+static void drawAndWait(RenderEngine& re, const DisplaySettings& display,
+                        const std::vector<LayerSettings>& layers,
+                        const std::shared_ptr<ExternalTexture>& outputBuffer,
+                        DrawTimes& drawTimes) {
+    const nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    sp<Fence> waitFence =
+            re.drawLayers(display, layers, outputBuffer, base::unique_fd()).get().value();
+    const nsecs_t submitted = systemTime(SYSTEM_TIME_MONOTONIC);
+    waitFence->waitForever(LOG_TAG);
+    drawTimes.add(start, submitted, waitFence);
+}
+
+static void saveOutput(RenderEngine& re, std::shared_ptr<ExternalTexture> outputBuffer,
+                       const char* saveFileName) {
     if (renderenginebench::save() && saveFileName) {
         // Copy to a CPU-accessible buffer so we can encode it.
         outputBuffer = copyBuffer(re, outputBuffer, GRALLOC_USAGE_SW_READ_OFTEN, "to_encode");
@@ -172,44 +206,91 @@ static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>&
     }
 }
 
-///////////////////////////////////////////////////////////////////////////////
-//  Benchmarks
-///////////////////////////////////////////////////////////////////////////////
+/**
+ * Helper for timing calls to drawLayers.
+ *
+ * Caller needs to create RenderEngine and the LayerSettings, and this takes
+ * care of setting up the display, starting and stopping the timer, calling
+ * drawLayers, and saving (if --save is used).
+ *
+ * This times both the CPU and GPU work initiated by drawLayers. All work done
+ * outside of the for loop is excluded from the timing measurements.
+ */
+static void benchDrawLayers(RenderEngine& re, const DisplaySettings& display,
+                            const std::vector<LayerSettings>& layers,
+                            benchmark::State& benchState, const char* saveFileName) {
+    auto [width, height] = getDisplaySize();
+    auto outputBuffer = allocateBuffer(re, width, height);
 
-template <class... Args>
-void BM_blur(benchmark::State& benchState, Args&&... args) {
-    auto args_tuple = std::make_tuple(std::move(args)...);
-    auto re = createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
-                                 static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)));
+    DrawTimes drawTimes;
+    // This loop starts and stops the timer.
+    for (auto _ : benchState) {
+        drawAndWait(re, display, layers, outputBuffer, drawTimes);
+    }
+    drawTimes.report(benchState);
+
+    saveOutput(re, outputBuffer, saveFileName);
+}
+
+static void benchDrawLayers(RenderEngine& re, const std::vector<LayerSettings>& layers,
+                            benchmark::State& benchState, const char* saveFileName) {
+    auto [width, height] = getDisplaySize();
+    benchDrawLayers(re, makeDisplaySettings(width, height), layers, benchState, saveFileName);
+}
 
+// Decodes the homescreen image into a GPU-only buffer the size of the display.
+static std::shared_ptr<ExternalTexture> loadSourceBuffer(RenderEngine& re) {
     // Initially use cpu access so we can decode into it with AImageDecoder.
     auto [width, height] = getDisplaySize();
     auto srcBuffer =
-            allocateBuffer(*re, width, height, GRALLOC_USAGE_SW_WRITE_OFTEN, "decoded_source");
-    {
-        std::string srcImage = base::GetExecutableDirectory();
-        srcImage.append("/resources/homescreen.png");
-        renderenginebench::decode(srcImage.c_str(), srcBuffer->getBuffer());
-
-        // Now copy into GPU-only buffer for more realistic timing.
-        srcBuffer = copyBuffer(*re, srcBuffer, 0, "source");
-    }
+            allocateBuffer(re, width, height, GRALLOC_USAGE_SW_WRITE_OFTEN, "decoded_source");
+    std::string srcImage = base::GetExecutableDirectory();
+    srcImage.append("/resources/homescreen.png");
+    renderenginebench::decode(srcImage.c_str(), srcBuffer->getBuffer());
 
-    const FloatRect layerRect(0, 0, width, height);
-    LayerSettings layer{
+    // Now copy into GPU-only buffer for more realistic timing.
+    return copyBuffer(re, srcBuffer, 0, "source");
+}
+
+static LayerSettings makeBufferLayer(const std::shared_ptr<ExternalTexture>& buffer,
+                                     const FloatRect& bounds, float alpha = 1.0f) {
+    return LayerSettings{
             .geometry =
                     Geometry{
-                            .boundaries = layerRect,
+                            .boundaries = bounds,
                     },
             .source =
                     PixelSource{
                             .buffer =
                                     Buffer{
-                                            .buffer = srcBuffer,
+                                            .buffer = buffer,
                                     },
                     },
-            .alpha = half(1.0f),
+            .alpha = half(alpha),
     };
+}
+
+template <class... Args>
+static std::unique_ptr<RenderEngine> createRenderEngine(const std::tuple<Args...>& args_tuple) {
+    return createRenderEngine(static_cast<RenderEngine::Threaded>(std::get<0>(args_tuple)),
+                              static_cast<RenderEngine::GraphicsApi>(std::get<1>(args_tuple)),
+                              static_cast<RenderEngine::SkiaBackend>(std::get<2>(args_tuple)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//  Benchmarks
+///////////////////////////////////////////////////////////////////////////////
+
+template <class... Args>
+void BM_blur(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto re = createRenderEngine(args_tuple);
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = loadSourceBuffer(*re);
+
+    const FloatRect layerRect(0, 0, width, height);
+    LayerSettings layer = makeBufferLayer(srcBuffer, layerRect);
     LayerSettings blurLayer{
             .geometry =
                     Geometry{
@@ -224,5 +305,229 @@ void BM_blur(benchmark::State& benchState, Args&&... args) {
     benchDrawLayers(*re, layers, benchState, "blurred");
 }
 
-BENCHMARK_CAPTURE(BM_blur, SkiaGLThreaded, RenderEngine::Threaded::YES,
-                  RenderEngine::GraphicsApi::GL);
+/**
+ * Blends the given number of translucent, partially overlapping copies of the
+ * source image, as when several app windows are stacked.
+ */
+template <class... Args>
+void BM_alphaBlend(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto re = createRenderEngine(args_tuple);
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = loadSourceBuffer(*re);
+
+    const int layerCount = std::get<3>(args_tuple);
+    const float step = static_cast<float>(height) / static_cast<float>(4 * layerCount);
+    std::vector<LayerSettings> layers;
+    for (int i = 0; i < layerCount; i++) {
+        const float offset = step * static_cast<float>(i);
+        layers.push_back(
+                makeBufferLayer(srcBuffer, FloatRect(offset, offset, width, height), 0.5f));
+    }
+    benchDrawLayers(*re, layers, benchState, "alpha_blend");
+}
+
+/**
+ * Draws a column of rounded, shadow-casting cards over the source image, as
+ * in a notification shade.
+ */
+template <class... Args>
+void BM_roundedCornersWithShadows(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto re = createRenderEngine(args_tuple);
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = loadSourceBuffer(*re);
+
+    std::vector<LayerSettings> layers{makeBufferLayer(srcBuffer, FloatRect(0, 0, width, height))};
+    static constexpr int kCardCount = 6;
+    const float margin = static_cast<float>(width) / 20.0f;
+    const float cardHeight = static_cast<float>(height) / (kCardCount + 1);
+    for (int i = 0; i < kCardCount; i++) {
+        const float top = margin + cardHeight * static_cast<float>(i);
+        const FloatRect bounds(margin, top, width - margin, top + cardHeight - margin);
+        LayerSettings card{
+                .geometry =
+                        Geometry{
+                                .boundaries = bounds,
+                                .roundedCornersRadius = {margin, margin},
+                                .roundedCornersCrop = bounds,
+                        },
+                .source =
+                        PixelSource{
+                                .solidColor = half3(0.9f, 0.9f, 0.9f),
+                        },
+                .alpha = half(1.0f),
+                .shadow =
+                        ShadowSettings{
+                                .boundaries = bounds,
+                                .ambientColor = vec4(0.0f, 0.0f, 0.0f, 0.1f),
+                                .spotColor = vec4(0.0f, 0.0f, 0.0f, 0.3f),
+                                .lightPos = vec3(width / 2.0f, 0.0f, 600.0f),
+                                .lightRadius = 800.0f,
+                                .length = 20.0f,
+                        },
+        };
+        layers.push_back(card);
+    }
+    benchDrawLayers(*re, layers, benchState, "rounded_shadows");
+}
+
+/**
+ * Composes a full screen PQ layer onto an SDR display, using the given tone
+ * mapping strategy.
+ */
+template <class... Args>
+void BM_hdrToSdr(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto re = createRenderEngine(args_tuple);
+    const auto tonemapStrategy =
+            static_cast<DisplaySettings::TonemapStrategy>(std::get<3>(args_tuple));
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = loadSourceBuffer(*re);
+
+    LayerSettings layer = makeBufferLayer(srcBuffer, FloatRect(0, 0, width, height));
+    layer.sourceDataspace = ui::Dataspace::BT2020_ITU_PQ;
+    layer.source.buffer.maxLuminanceNits = 1000.0f;
+
+    DisplaySettings display = makeDisplaySettings(width, height);
+    display.outputDataspace = ui::Dataspace::SRGB;
+    display.tonemapStrategy = tonemapStrategy;
+
+    benchDrawLayers(*re, display, {layer}, benchState,
+                    tonemapStrategy == DisplaySettings::TonemapStrategy::Local ? "hdr_local"
+                                                                                : "hdr_global");
+}
+
+/**
+ * Alternates between protected and unprotected output every frame, as when
+ * DRM video enters and leaves client composition.
+ */
+template <class... Args>
+void BM_protectedSwitch(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto re = createRenderEngine(args_tuple);
+    if (!re->supportsProtectedContent()) {
+        benchState.SkipWithError("Protected content is not supported");
+        return;
+    }
+
+    auto [width, height] = getDisplaySize();
+    auto srcBuffer = loadSourceBuffer(*re);
+    auto unprotectedOutput = allocateBuffer(*re, width, height);
+    auto protectedOutput =
+            allocateBuffer(*re, width, height, GRALLOC_USAGE_PROTECTED, "protected_output");
+
+    const DisplaySettings display = makeDisplaySettings(width, height);
+    const std::vector<LayerSettings> layers{
+            makeBufferLayer(srcBuffer, FloatRect(0, 0, width, height))};
+
+    DrawTimes drawTimes;
+    bool useProtected = false;
+    for (auto _ : benchState) {
+        useProtected = !useProtected;
+        re->useProtectedContext(useProtected);
+        drawAndWait(*re, display, layers, useProtected ? protectedOutput : unprotectedOutput,
+                    drawTimes);
+    }
+    drawTimes.report(benchState);
+    re->useProtectedContext(false);
+}
+
+/**
+ * Times mapExternalTextureBuffer and unmapExternalTextureBuffer for buffers
+ * that have not been imported yet, as when an app allocates new buffers.
+ */
+template <class... Args>
+void BM_mapExternalTextureBuffer(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    auto re = createRenderEngine(args_tuple);
+
+    auto [width, height] = getDisplaySize();
+    for (auto _ : benchState) {
+        benchState.PauseTiming();
+        auto buffer = sp<GraphicBuffer>::make(width, height, HAL_PIXEL_FORMAT_RGBA_8888, 1u,
+                                              GRALLOC_USAGE_HW_TEXTURE, "imported");
+        benchState.ResumeTiming();
+
+        re->mapExternalTextureBuffer(buffer, false);
+        re->unmapExternalTextureBuffer(std::move(buffer));
+    }
+}
+
+/**
+ * Times the first frame drawn by a new RenderEngine, with or without
+ * priming the shader cache first. The creation of RenderEngine and the
+ * priming itself are excluded from the measurement. Decoding the source
+ * already draws a plain image layer, so the measured frame adds rounded
+ * corners and blending on top of it to reach uncompiled pipelines.
+ */
+template <class... Args>
+void BM_firstFrame(benchmark::State& benchState, Args&&... args) {
+    auto args_tuple = std::make_tuple(std::move(args)...);
+    const bool primeCache = std::get<3>(args_tuple);
+
+    auto [width, height] = getDisplaySize();
+    const DisplaySettings display = makeDisplaySettings(width, height);
+    const FloatRect bounds(0, 0, width, height);
+
+    DrawTimes drawTimes;
+    for (auto _ : benchState) {
+        benchState.PauseTiming();
+        auto re = createRenderEngine(args_tuple);
+        if (primeCache) {
+            re->primeCache(PrimeCacheConfig()).wait();
+        }
+        auto srcBuffer = loadSourceBuffer(*re);
+        auto outputBuffer = allocateBuffer(*re, width, height);
+        LayerSettings roundedLayer = makeBufferLayer(srcBuffer, bounds, 0.75f);
+        roundedLayer.geometry.roundedCornersRadius = {width / 20.0f, width / 20.0f};
+        roundedLayer.geometry.roundedCornersCrop = bounds;
+        const std::vector<LayerSettings> layers{makeBufferLayer(srcBuffer, bounds),
+                                                roundedLayer};
+        benchState.ResumeTiming();
+
+        drawAndWait(*re, display, layers, outputBuffer, drawTimes);
+
+        benchState.PauseTiming();
+        outputBuffer.reset();
+        srcBuffer.reset();
+        re.reset();
+        benchState.ResumeTiming();
+    }
+    drawTimes.report(benchState);
+}
+
+// Registers func for GL, Ganesh Vulkan and Graphite Vulkan. Any extra arguments are passed to func
+// after the backend, and suffix tells the resulting benchmarks apart.
+#define RE_BENCHMARK_ALL_BACKENDS(func, suffix, ...)                                          \
+    BENCHMARK_CAPTURE(func, SkiaGLThreaded##suffix, RenderEngine::Threaded::YES,             \
+                      RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH,      \
+                      ##__VA_ARGS__);                                                        \
+    BENCHMARK_CAPTURE(func, SkiaVkGaneshThreaded##suffix, RenderEngine::Threaded::YES,       \
+                      RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GANESH,      \
+                      ##__VA_ARGS__);                                                        \
+    BENCHMARK_CAPTURE(func, SkiaVkGraphiteThreaded##suffix, RenderEngine::Threaded::YES,     \
+                      RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GRAPHITE,    \
+                      ##__VA_ARGS__)
+
+RE_BENCHMARK_ALL_BACKENDS(BM_blur, );
+RE_BENCHMARK_ALL_BACKENDS(BM_alphaBlend, _2Layers, 2);
+RE_BENCHMARK_ALL_BACKENDS(BM_alphaBlend, _4Layers, 4);
+RE_BENCHMARK_ALL_BACKENDS(BM_alphaBlend, _8Layers, 8);
+RE_BENCHMARK_ALL_BACKENDS(BM_roundedCornersWithShadows, );
+RE_BENCHMARK_ALL_BACKENDS(BM_hdrToSdr, _Libtonemap, DisplaySettings::TonemapStrategy::Libtonemap);
+RE_BENCHMARK_ALL_BACKENDS(BM_hdrToSdr, _MouriMap, DisplaySettings::TonemapStrategy::Local);
+RE_BENCHMARK_ALL_BACKENDS(BM_protectedSwitch, );
+RE_BENCHMARK_ALL_BACKENDS(BM_firstFrame, _Cold, false);
+RE_BENCHMARK_ALL_BACKENDS(BM_firstFrame, _Primed, true);
+
+// Unthreaded, so that the mapping is timed rather than just queued.
+BENCHMARK_CAPTURE(BM_mapExternalTextureBuffer, SkiaGL, RenderEngine::Threaded::NO,
+                  RenderEngine::GraphicsApi::GL, RenderEngine::SkiaBackend::GANESH);
+BENCHMARK_CAPTURE(BM_mapExternalTextureBuffer, SkiaVkGanesh, RenderEngine::Threaded::NO,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GANESH);
+BENCHMARK_CAPTURE(BM_mapExternalTextureBuffer, SkiaVkGraphite, RenderEngine::Threaded::NO,
+                  RenderEngine::GraphicsApi::VK, RenderEngine::SkiaBackend::GRAPHITE);
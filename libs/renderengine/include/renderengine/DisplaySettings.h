@@ -102,6 +102,24 @@ struct DisplaySettings {
         Local,
     };
     TonemapStrategy tonemapStrategy = TonemapStrategy::Libtonemap;
+
+    // Scheduling priority of the draw. This does not affect the rendered output, so it is not
+    // part of equality.
+    enum class Priority {
+        // Composition of a display that is about to be presented.
+        Normal,
+        // Offscreen work that no frame is waiting on, such as screenshots. A threaded
+        // RenderEngine runs this only after all pending Normal work.
+        Background,
+    };
+    Priority priority = Priority::Normal;
+
+    // If set, only this area of the output buffer, in the same space as clip, is redrawn and the
+    // rest of the buffer is kept as it is. The caller is responsible for the kept pixels already
+    // matching the layers being drawn. RenderEngine may still redraw the entire buffer, e.g. when
+    // a layer blurs what is behind it. Like the priority this is not part of equality, since the
+    // result of a correct draw does not depend on it.
+    std::optional<Rect> damage;
 };
 
 static inline bool operator==(const DisplaySettings& lhs, const DisplaySettings& rhs) {
@@ -158,6 +176,10 @@ static inline void PrintTo(const DisplaySettings& settings, ::std::ostream* os)
         << aidl::android::hardware::graphics::composer3::toString(settings.dimmingStage).c_str();
     *os << "\n    .renderIntent = "
         << aidl::android::hardware::graphics::composer3::toString(settings.renderIntent).c_str();
+    if (settings.damage) {
+        *os << "\n    .damage = ";
+        PrintTo(*settings.damage, os);
+    }
     *os << "\n}";
 }
 
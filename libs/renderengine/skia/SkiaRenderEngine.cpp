@@ -66,11 +66,13 @@
 #include <ui/HdrRenderTypeUtils.h>
 #include <utils/Trace.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <deque>
 #include <memory>
 #include <numeric>
+#include <string_view>
 
 #include "Cache.h"
 #include "ColorSpaces.h"
@@ -248,6 +250,7 @@ using base::StringAppendF;
 
 std::future<void> SkiaRenderEngine::primeCache(PrimeCacheConfig config) {
     Cache::primeShaderCache(this, config);
+    mSkSLCacheMonitor.onPrimeCacheFinished();
     return {};
 }
 
@@ -262,6 +265,26 @@ void SkiaRenderEngine::SkSLCacheMonitor::store(const SkData& key, const SkData&
     mShadersCachedSinceLastCall++;
     mTotalShadersCompiled++;
     ATRACE_FORMAT("SF cache: %i shaders", mTotalShadersCompiled);
+
+    if (!mPrimeCacheFinished) {
+        return;
+    }
+    mShadersCompiledAfterPriming++;
+    if (mShaderDescriptionsAfterPriming.size() == kMaxRecordedShaderDescriptions) {
+        mShaderDescriptionsAfterPriming.pop_front();
+    }
+    std::string_view view(description.c_str(), description.size());
+    view = view.substr(0, std::min(view.find('\n'), kMaxShaderDescriptionLength));
+    mShaderDescriptionsAfterPriming.emplace_back(view);
+}
+
+void SkiaRenderEngine::SkSLCacheMonitor::dumpShadersCompiledAfterPriming(
+        std::string& result) const {
+    StringAppendF(&result, "RenderEngine shaders compiled after primeCache: %d\n",
+                  mShadersCompiledAfterPriming);
+    for (const auto& description : mShaderDescriptionsAfterPriming) {
+        StringAppendF(&result, "    %s\n", description.c_str());
+    }
 }
 
 int SkiaRenderEngine::reportShadersCompiled() {
@@ -305,6 +328,7 @@ void SkiaRenderEngine::finishRenderingAndAbandonContexts() {
     if (mBlurFilter) {
         delete mBlurFilter;
     }
+    mBlurCache.reset();
 
     // Leftover textures may hold refs to backend-specific Skia contexts, which must be released
     // before ~SkiaGpuContext is called.
@@ -427,7 +451,10 @@ void SkiaRenderEngine::mapExternalTextureBuffer(const sp<GraphicBuffer>& buffer,
     std::lock_guard<std::mutex> lock(mRenderingMutex);
     mGraphicBufferExternalRefs[buffer->getId()]++;
 
-    if (const auto& iter = cache.find(buffer->getId()); iter == cache.end()) {
+    if (const auto& iter = cache.find(buffer->getId()); iter != cache.end()) {
+        mTextureImportStats.mappedHits++;
+    } else {
+        mTextureImportStats.mappedImports++;
         if (FlagManager::getInstance().renderable_buffer_usage()) {
             isRenderable = buffer->getUsage() & GRALLOC_USAGE_HW_RENDER;
         }
@@ -486,6 +513,10 @@ std::shared_ptr<AutoBackendTexture::LocalRef> SkiaRenderEngine::getOrCreateBacke
             return it->second;
         }
     }
+    // Input buffers are normally imported when they are mapped, so an import here is a buffer that
+    // was never mapped (or is protected) and its cost lands in the frame.
+    ATRACE_NAME("SkiaRenderEngine::importTextureForDraw");
+    mTextureImportStats.drawImports++;
     std::unique_ptr<SkiaBackendTexture> backendTexture =
             getActiveContext()->makeBackendTexture(buffer->toAHardwareBuffer(), isOutputBuffer);
     return std::make_shared<AutoBackendTexture::LocalRef>(std::move(backendTexture),
@@ -500,6 +531,12 @@ bool SkiaRenderEngine::canSkipPostRenderCleanup() const {
 void SkiaRenderEngine::cleanupPostRender() {
     ATRACE_CALL();
     std::lock_guard<std::mutex> lock(mRenderingMutex);
+    // Submission never blocks on the GPU, so the recordings of earlier frames may still hold the
+    // textures that are about to be cleaned up. Retire whatever has finished since, rather than
+    // waiting for the next submission to do so.
+    if (SkiaGpuContext* context = getActiveContext()) {
+        context->checkAsyncWorkCompletion();
+    }
     mTextureCleanupMgr.cleanup();
 }
 
@@ -534,7 +571,12 @@ sk_sp<SkShader> SkiaRenderEngine::createRuntimeEffectShader(
                                 HdrRenderType::GENERIC_HDR
                         ? 1.0f
                         : parameters.layerDimmingRatio;
-                return kMapper.mouriMap(getActiveContext(), parameters.shader, ratio);
+                std::optional<MouriMap::InputKey> key;
+                if (targetBuffer) {
+                    key = MouriMap::InputKey{.bufferId = targetBuffer->getId(),
+                                             .acquireFence = parameters.layer.source.buffer.fence};
+                }
+                return kMapper.mouriMap(getActiveContext(), parameters.shader, ratio, key);
             }
         }
 
@@ -665,6 +707,36 @@ void logSettings(const T& t) {
 }
 } // namespace
 
+SkiaRenderEngine::BlurCache::LayerKey::LayerKey(const LayerSettings& layer)
+      : settings(layer), buffer(layer.source.buffer.buffer), fence(layer.source.buffer.fence) {
+    settings.source.buffer.buffer = nullptr;
+    settings.source.buffer.fence = nullptr;
+}
+
+bool SkiaRenderEngine::BlurCache::LayerKey::matches(const LayerSettings& layer) const {
+    // A buffer that was freed since cannot match, so the weak references are safe to compare.
+    if (buffer.lock() != layer.source.buffer.buffer || fence.promote() != layer.source.buffer.fence) {
+        return false;
+    }
+    LayerSettings other = layer;
+    other.source.buffer.buffer = nullptr;
+    other.source.buffer.fence = nullptr;
+    return settings == other;
+}
+
+bool SkiaRenderEngine::BlurCache::matches(const DisplaySettings& otherDisplay,
+                                          SkISize otherSurfaceSize,
+                                          std::vector<LayerSettings>::const_iterator layersBegin,
+                                          std::vector<LayerSettings>::const_iterator layersEnd,
+                                          const SkRect& otherBlurRect) const {
+    return display == otherDisplay && surfaceSize == otherSurfaceSize &&
+            blurRect == otherBlurRect &&
+            std::equal(layersBelow.begin(), layersBelow.end(), layersBegin, layersEnd,
+                       [](const LayerKey& key, const LayerSettings& layer) {
+                           return key.matches(layer);
+                       });
+}
+
 // Helper class intended to be used on the stack to ensure that texture cleanup
 // is deferred until after this class goes out of scope.
 class DeferTextureCleanup final {
@@ -768,14 +840,29 @@ void SkiaRenderEngine::drawLayersInternal(
         }
     }
 
+    // Blurs sample outside of their own bounds, and the offscreen pass above starts out empty, so
+    // the whole buffer has to be drawn whenever a layer blurs.
+    const bool drawDamageOnly = display.damage &&
+            std::none_of(layers.begin(), layers.end(), [&](const LayerSettings& layer) {
+                return layerHasBlur(layer, ctModifiesAlpha);
+            });
+
     AutoSaveRestore surfaceAutoSaveRestore(canvas);
-    // Clear the entire canvas with a transparent black to prevent ghost images.
-    canvas->clear(SK_ColorTRANSPARENT);
+    if (!drawDamageOnly) {
+        // Clear the entire canvas with a transparent black to prevent ghost images.
+        canvas->clear(SK_ColorTRANSPARENT);
+    }
     initCanvas(canvas, display);
+    if (drawDamageOnly) {
+        ATRACE_FORMAT("drawDamageOnly %dx%d", display.damage->width(), display.damage->height());
+        canvas->clipRect(getSkRect(*display.damage));
+        canvas->clear(SK_ColorTRANSPARENT);
+    }
 
     if (kPrintLayerSettings) {
         logSettings(display);
     }
+    bool drewBlurLayer = false;
     for (const auto& layer : layers) {
         ATRACE_FORMAT("DrawLayer: %s", layer.name.c_str());
 
@@ -869,14 +956,30 @@ void SkiaRenderEngine::drawLayersInternal(
                 canvas->clipRRect(roundRectClip, true);
             }
 
+            // Only the lowest blurring layer has a background that is fully described by the
+            // layers below it, so only its blurs can be reused by a later frame.
+            const bool canCacheBlurs = !drewBlurLayer;
+            drewBlurLayer = true;
+            const auto layersBelowEnd = layers.begin() + (&layer - layers.data());
+            const SkISize surfaceSize = activeSurface->imageInfo().dimensions();
+            bool reusedBlurs = false;
+            if (canCacheBlurs && mBlurCache &&
+                mBlurCache->matches(display, surfaceSize, layers.begin(), layersBelowEnd,
+                                    blurRect)) {
+                ATRACE_NAME("ReuseCachedBlurs");
+                cachedBlurs = mBlurCache->blurs;
+                reusedBlurs = true;
+            }
+
             // TODO(b/182216890): Filter out empty layers earlier
             if (blurRect.width() > 0 && blurRect.height() > 0) {
                 if (layer.backgroundBlurRadius > 0) {
-                    ATRACE_NAME("BackgroundBlur");
-                    auto blurredImage = mBlurFilter->generate(context, layer.backgroundBlurRadius,
-                                                              blurInput, blurRect);
-
-                    cachedBlurs[layer.backgroundBlurRadius] = blurredImage;
+                    auto& blurredImage = cachedBlurs[layer.backgroundBlurRadius];
+                    if (blurredImage == nullptr) {
+                        ATRACE_NAME("BackgroundBlur");
+                        blurredImage = mBlurFilter->generate(context, layer.backgroundBlurRadius,
+                                                             blurInput, blurRect);
+                    }
 
                     mBlurFilter->drawBlurRegion(canvas, bounds, layer.backgroundBlurRadius, 1.0f,
                                                 blurRect, blurredImage, blurInput);
@@ -896,6 +999,22 @@ void SkiaRenderEngine::drawLayersInternal(
                                                 cachedBlurs[region.blurRadius], blurInput);
                 }
             }
+
+            if (canCacheBlurs) {
+                if (reusedBlurs) {
+                    mBlurCache->blurs = std::move(cachedBlurs);
+                } else {
+                    BlurCache cache{.display = display,
+                                    .surfaceSize = surfaceSize,
+                                    .blurRect = blurRect,
+                                    .blurs = std::move(cachedBlurs)};
+                    cache.layersBelow.reserve(layersBelowEnd - layers.begin());
+                    for (auto it = layers.begin(); it != layersBelowEnd; ++it) {
+                        cache.layersBelow.emplace_back(*it);
+                    }
+                    mBlurCache = std::move(cache);
+                }
+            }
         }
 
         if (layer.shadow.length > 0) {
@@ -1164,6 +1283,11 @@ void SkiaRenderEngine::drawLayersInternal(
         }
     }
 
+    // Release the cached blurs once their display stops blurring, e.g. when the shade is closed.
+    if (!drewBlurLayer && mBlurCache && mBlurCache->display.namePlusId == display.namePlusId) {
+        mBlurCache.reset();
+    }
+
     surfaceAutoSaveRestore.restore();
     mCapture->endCapture();
 
@@ -1230,6 +1354,7 @@ void SkiaRenderEngine::dump(std::string& result) {
     StringAppendF(&result, "RenderEngine is in protected context: %d\n", mInProtectedContext);
     StringAppendF(&result, "RenderEngine shaders cached since last dump/primeCache: %d\n",
                   mSkSLCacheMonitor.shadersCachedSinceLastCall());
+    mSkSLCacheMonitor.dumpShadersCompiledAfterPriming(result);
 
     std::vector<ResourcePair> cpuResourceMap = {
             {"skia/sk_resource_cache/bitmap_", "Bitmaps"},
@@ -1269,6 +1394,11 @@ void SkiaRenderEngine::dump(std::string& result) {
         }
         StringAppendF(&result, "RenderEngine AHB/BackendTexture cache size: %zu\n",
                       mTextureCache.size());
+        StringAppendF(&result,
+                      "RenderEngine texture imports: %" PRIu64 " when mapped (%" PRIu64
+                      " already cached), %" PRIu64 " while drawing\n",
+                      mTextureImportStats.mappedImports, mTextureImportStats.mappedHits,
+                      mTextureImportStats.drawImports);
         StringAppendF(&result, "Dumping buffer ids...\n");
         // TODO(178539829): It would be nice to know which layer these are coming from and what
         // the texture sizes are.
@@ -27,8 +27,10 @@
 #include <renderengine/RenderEngine.h>
 #include <sys/types.h>
 
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
 
 #include "AutoBackendTexture.h"
@@ -123,9 +125,25 @@ protected:
 
         int totalShadersCompiled() const { return mTotalShadersCompiled; }
 
+        // Called once Cache::primeShaderCache has run. Shaders stored after this point were
+        // compiled just in time during a frame, and are recorded so that the primed set can be
+        // extended to cover them.
+        void onPrimeCacheFinished() { mPrimeCacheFinished = true; }
+
+        void dumpShadersCompiledAfterPriming(std::string& result) const;
+
     private:
+        // Bounds the number of just-in-time shader descriptions kept for dumpsys.
+        static constexpr size_t kMaxRecordedShaderDescriptions = 32;
+        // Descriptions can be full shader programs; only a prefix is needed to identify them.
+        static constexpr size_t kMaxShaderDescriptionLength = 256;
+
         int mShadersCachedSinceLastCall = 0;
         int mTotalShadersCompiled = 0;
+        bool mPrimeCacheFinished = false;
+        int mShadersCompiledAfterPriming = 0;
+        // Most recent descriptions last.
+        std::deque<std::string> mShaderDescriptionsAfterPriming;
     };
 
     SkSLCacheMonitor mSkSLCacheMonitor;
@@ -178,11 +196,48 @@ private:
             mRuntimeEffects;
     AutoBackendTexture::CleanupManager mTextureCleanupMgr GUARDED_BY(mRenderingMutex);
 
+    // Texture import statistics reported by dump. Imports made while mapping a buffer happen
+    // ahead of composition; imports made while drawing land inside the frame.
+    struct TextureImportStats {
+        uint64_t mappedImports = 0;
+        uint64_t mappedHits = 0;
+        uint64_t drawImports = 0;
+    };
+    TextureImportStats mTextureImportStats GUARDED_BY(mRenderingMutex);
+
     StretchShaderFactory mStretchShaderFactory;
 
     sp<Fence> mLastDrawFence;
     BlurFilter* mBlurFilter = nullptr;
 
+    // Blurs generated for the lowest blurring layer of the last frame that had one, along with
+    // everything that determined their input. A frame that draws the same content underneath
+    // reuses them instead of blurring the background again. Buffers and fences are held weakly,
+    // so that the cache does not keep layer buffers alive.
+    struct BlurCache {
+        struct LayerKey {
+            explicit LayerKey(const LayerSettings& layer);
+            bool matches(const LayerSettings& layer) const;
+
+            // Copy of the layer with its buffer and fence cleared.
+            LayerSettings settings;
+            std::weak_ptr<ExternalTexture> buffer;
+            wp<Fence> fence;
+        };
+
+        bool matches(const DisplaySettings& display, SkISize surfaceSize,
+                     std::vector<LayerSettings>::const_iterator layersBegin,
+                     std::vector<LayerSettings>::const_iterator layersEnd,
+                     const SkRect& blurRect) const;
+
+        DisplaySettings display;
+        SkISize surfaceSize;
+        std::vector<LayerKey> layersBelow;
+        SkRect blurRect;
+        std::unordered_map<uint32_t, sk_sp<SkImage>> blurs;
+    };
+    std::optional<BlurCache> mBlurCache GUARDED_BY(mRenderingMutex);
+
     // Object to capture commands send to Skia.
     std::unique_ptr<SkiaCapture> mCapture;
 
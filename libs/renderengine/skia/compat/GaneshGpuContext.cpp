@@ -113,6 +113,10 @@ void GaneshGpuContext::resetContextIfApplicable() {
     mGrContext->resetContext(); // Only applicable to GL
 };
 
+void GaneshGpuContext::checkAsyncWorkCompletion() {
+    mGrContext->checkAsyncWorkCompletion();
+}
+
 void GaneshGpuContext::dumpMemoryStatistics(SkTraceMemoryDump* traceMemoryDump) const {
     mGrContext->dumpMemoryStatistics(traceMemoryDump);
 }
@@ -41,6 +41,7 @@ public:
 
     void purgeUnlockedScratchResources() override;
     void resetContextIfApplicable() override;
+    void checkAsyncWorkCompletion() override;
 
     void dumpMemoryStatistics(SkTraceMemoryDump* traceMemoryDump) const override;
 
@@ -106,6 +106,10 @@ size_t GraphiteGpuContext::getMaxTextureSize() const {
     return mContext->maxTextureSize();
 };
 
+void GraphiteGpuContext::checkAsyncWorkCompletion() {
+    mContext->checkAsyncWorkCompletion();
+}
+
 bool GraphiteGpuContext::isAbandonedOrDeviceLost() {
     return mContext->isDeviceLost();
 }
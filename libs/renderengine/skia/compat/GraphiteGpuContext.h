@@ -51,6 +51,7 @@ public:
     void purgeUnlockedScratchResources() override{};
     // No-op (only applicable to GL).
     void resetContextIfApplicable() override{};
+    void checkAsyncWorkCompletion() override;
 
     void dumpMemoryStatistics(SkTraceMemoryDump* traceMemoryDump) const override;
 
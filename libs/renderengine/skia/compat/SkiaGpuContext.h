@@ -108,6 +108,12 @@ public:
     virtual void purgeUnlockedScratchResources() = 0;
     virtual void resetContextIfApplicable() = 0; // No-op outside of GL (&& Ganesh at this point.)
 
+    /**
+     * Runs Skia's completion callbacks for submitted GPU work that has finished, without blocking.
+     * This releases the resources and semaphores held by that work before the next submission.
+     */
+    virtual void checkAsyncWorkCompletion() = 0;
+
     virtual void dumpMemoryStatistics(SkTraceMemoryDump* traceMemoryDump) const = 0;
 };
 
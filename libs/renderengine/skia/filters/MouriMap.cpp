@@ -113,10 +113,39 @@ MouriMap::MouriMap()
         mBlur(makeEffect(kBlur)),
         mTonemap(makeEffect(kTonemap)) {}
 
+bool MouriMap::LocalLuxCache::matches(SkiaGpuContext* context, const InputKey& key,
+                                      const SkMatrix& matrix, const SkImage& image,
+                                      float hdrSdrRatio) const {
+    // Without a live fence there is nothing telling us that the buffer was not rewritten.
+    const sp<Fence> fence = key.acquireFence.promote();
+    return fence != nullptr && fence == this->key.acquireFence.promote() &&
+            context == this->context && key.bufferId == this->key.bufferId &&
+            matrix == this->matrix && image.width() == width && image.height() == height &&
+            hdrSdrRatio == this->hdrSdrRatio;
+}
+
 sk_sp<SkShader> MouriMap::mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input,
-                                   float hdrSdrRatio) {
+                                   float hdrSdrRatio, std::optional<InputKey> key) {
+    SkMatrix matrix;
+    SkImage* image = input->isAImage(&matrix, (SkTileMode*)nullptr);
+    if (key && image && mLocalLuxCache &&
+        mLocalLuxCache->matches(context, *key, matrix, *image, hdrSdrRatio)) {
+        return tonemap(input, mLocalLuxCache->localLux.get(), hdrSdrRatio);
+    }
+
     auto downchunked = downchunk(context, input, hdrSdrRatio);
     auto localLux = blur(context, downchunked.get());
+    if (key && image) {
+        mLocalLuxCache = LocalLuxCache{.context = context,
+                                       .key = *key,
+                                       .matrix = matrix,
+                                       .width = image->width(),
+                                       .height = image->height(),
+                                       .hdrSdrRatio = hdrSdrRatio,
+                                       .localLux = localLux};
+    } else {
+        mLocalLuxCache.reset();
+    }
     return tonemap(input, localLux.get(), hdrSdrRatio);
 }
 
@@ -17,6 +17,11 @@
 #include <SkImage.h>
 #include <SkRuntimeEffect.h>
 #include <SkShader.h>
+#include <ui/Fence.h>
+#include <utils/RefBase.h>
+
+#include <optional>
+
 #include "../compat/SkiaGpuContext.h"
 namespace android {
 namespace renderengine {
@@ -60,13 +65,37 @@ namespace skia {
  */
 class MouriMap {
 public:
+    // Identifies the contents of the input, so that the local luminance map computed for it can be
+    // reused while the contents are unchanged. A buffer's contents are only considered unchanged
+    // while it is drawn with the same acquire fence.
+    struct InputKey {
+        uint64_t bufferId = 0;
+        wp<Fence> acquireFence;
+    };
+
     MouriMap();
     // Apply the MouriMap tonemmaping operator to the input.
     // The HDR/SDR ratio describes the luminace range of the input. 1.0 means SDR. Anything larger
     // then 1.0 means that there is headroom above the SDR region.
-    sk_sp<SkShader> mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input, float hdrSdrRatio);
+    // If a key is given, the downsampled local luminance is cached and reused for as long as the
+    // same input is mapped again, so that only the final per-pixel tonemap is re-evaluated.
+    sk_sp<SkShader> mouriMap(SkiaGpuContext* context, sk_sp<SkShader> input, float hdrSdrRatio,
+                             std::optional<InputKey> key = std::nullopt);
 
 private:
+    struct LocalLuxCache {
+        SkiaGpuContext* context = nullptr;
+        InputKey key;
+        SkMatrix matrix;
+        int width = 0;
+        int height = 0;
+        float hdrSdrRatio = 1.0f;
+        sk_sp<SkImage> localLux;
+
+        bool matches(SkiaGpuContext* context, const InputKey& key, const SkMatrix& matrix,
+                     const SkImage& image, float hdrSdrRatio) const;
+    };
+
     sk_sp<SkImage> downchunk(SkiaGpuContext* context, sk_sp<SkShader> input,
                              float hdrSdrRatio) const;
     sk_sp<SkImage> blur(SkiaGpuContext* context, SkImage* input) const;
@@ -75,6 +104,9 @@ private:
     const sk_sp<SkRuntimeEffect> mChunk8x8;
     const sk_sp<SkRuntimeEffect> mBlur;
     const sk_sp<SkRuntimeEffect> mTonemap;
+    // Luminance map of the most recently keyed input. A single entry covers the common case of one
+    // HDR layer that stays static while other content on screen changes.
+    std::optional<LocalLuxCache> mLocalLuxCache;
 };
 } // namespace skia
 } // namespace renderengine
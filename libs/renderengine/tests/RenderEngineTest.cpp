@@ -1743,6 +1743,48 @@ TEST_P(RenderEngineTest, drawLayers_fillBufferAndBlurBackground_colorSource) {
     fillBufferAndBlurBackground<ColorSourceVariant>();
 }
 
+TEST_P(RenderEngineTest, drawLayers_blurFollowsChangedBackground) {
+    if (!GetParam()->apiSupported()) {
+        GTEST_SKIP();
+    }
+    initializeRenderEngine();
+    if (!mRE->supportsBackgroundBlur()) {
+        GTEST_SKIP();
+    }
+
+    const auto center = DEFAULT_DISPLAY_WIDTH / 2;
+    const Rect centerRect(center - 1, center - 5, center + 1, center + 5);
+
+    renderengine::DisplaySettings settings;
+    settings.outputDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    settings.physicalDisplay = fullscreenRect();
+    settings.clip = fullscreenRect();
+
+    renderengine::LayerSettings backgroundLayer;
+    backgroundLayer.sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    backgroundLayer.geometry.boundaries = fullscreenRect().toFloatRect();
+    ColorSourceVariant::fillColor(backgroundLayer, 1.0f, 0.0f, 0.0f, this);
+    backgroundLayer.alpha = 1.0f;
+
+    renderengine::LayerSettings blurLayer;
+    blurLayer.sourceDataspace = ui::Dataspace::V0_SRGB_LINEAR;
+    blurLayer.geometry.boundaries = fullscreenRect().toFloatRect();
+    blurLayer.backgroundBlurRadius = 50;
+    ColorSourceVariant::fillColor(blurLayer, 0.0f, 0.0f, 1.0f, this);
+    blurLayer.alpha = 0;
+
+    // Drawing the same frame twice may reuse the first blur.
+    invokeDraw(settings, {backgroundLayer, blurLayer});
+    expectBufferColor(centerRect, 255, 0, 0, 255, 1 /* tolerance */);
+    invokeDraw(settings, {backgroundLayer, blurLayer});
+    expectBufferColor(centerRect, 255, 0, 0, 255, 1 /* tolerance */);
+
+    // A changed background must be blurred again.
+    ColorSourceVariant::fillColor(backgroundLayer, 0.0f, 1.0f, 0.0f, this);
+    invokeDraw(settings, {backgroundLayer, blurLayer});
+    expectBufferColor(centerRect, 0, 255, 0, 255, 1 /* tolerance */);
+}
+
 TEST_P(RenderEngineTest, drawLayers_fillSmallLayerAndBlurBackground_colorSource) {
     if (!GetParam()->apiSupported()) {
         GTEST_SKIP();
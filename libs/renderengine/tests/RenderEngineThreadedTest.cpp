@@ -27,6 +27,7 @@ namespace android {
 
 using renderengine::PrimeCacheConfig;
 using testing::_;
+using testing::AnyNumber;
 using testing::Eq;
 using testing::Mock;
 using testing::Return;
@@ -246,4 +247,52 @@ TEST_F(RenderEngineThreadedTest, drawLayers_protectedOutputBuffer) {
     ASSERT_TRUE(result.ok());
 }
 
+TEST_F(RenderEngineThreadedTest, drawLayers_backgroundRunsAfterNormal) {
+    std::vector<renderengine::LayerSettings> layers;
+    std::shared_ptr<renderengine::ExternalTexture> buffer = std::make_shared<
+            renderengine::impl::
+                    ExternalTexture>(sp<GraphicBuffer>::make(), *mRenderEngine,
+                                     renderengine::impl::ExternalTexture::Usage::READABLE |
+                                             renderengine::impl::ExternalTexture::Usage::WRITEABLE);
+
+    std::promise<void> unblock;
+    std::shared_future<void> unblocked = unblock.get_future().share();
+    std::vector<std::string> drawOrder;
+
+    EXPECT_CALL(*mRenderEngine, useProtectedContext(false)).Times(AnyNumber());
+    EXPECT_CALL(*mRenderEngine, drawLayersInternal)
+            .Times(3)
+            .WillRepeatedly([&](const std::shared_ptr<std::promise<FenceResult>>&& resultPromise,
+                                const renderengine::DisplaySettings& display,
+                                const std::vector<renderengine::LayerSettings>&,
+                                const std::shared_ptr<renderengine::ExternalTexture>&,
+                                base::unique_fd&&) {
+                if (display.namePlusId == "blocker") {
+                    unblocked.wait();
+                }
+                drawOrder.push_back(display.namePlusId);
+                resultPromise->set_value(Fence::NO_FENCE);
+            });
+
+    // Keep the RenderEngine thread busy so that the next two draws are queued together.
+    renderengine::DisplaySettings blocker{.namePlusId = "blocker"};
+    auto blockerFuture = mThreadedRE->drawLayers(blocker, layers, buffer, base::unique_fd());
+
+    renderengine::DisplaySettings background{
+            .namePlusId = "background",
+            .priority = renderengine::DisplaySettings::Priority::Background,
+    };
+    auto backgroundFuture = mThreadedRE->drawLayers(background, layers, buffer, base::unique_fd());
+
+    renderengine::DisplaySettings normal{.namePlusId = "normal"};
+    auto normalFuture = mThreadedRE->drawLayers(normal, layers, buffer, base::unique_fd());
+
+    unblock.set_value();
+    ASSERT_TRUE(blockerFuture.get().ok());
+    ASSERT_TRUE(normalFuture.get().ok());
+    ASSERT_TRUE(backgroundFuture.get().ok());
+
+    EXPECT_THAT(drawOrder, testing::ElementsAre("blocker", "normal", "background"));
+}
+
 } // namespace android
@@ -104,6 +104,11 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
                 mFunctionCalls.pop();
                 return std::make_optional<Work>(task);
             }
+            if (!mBackgroundFunctionCalls.empty()) {
+                Work task = mBackgroundFunctionCalls.front();
+                mBackgroundFunctionCalls.pop();
+                return std::make_optional<Work>(task);
+            }
             return std::nullopt;
         };
 
@@ -115,7 +120,7 @@ void RenderEngineThreaded::threadMain(CreateInstanceFactory factory) NO_THREAD_S
 
         std::unique_lock<std::mutex> lock(mThreadMutex);
         mCondition.wait(lock, [this]() REQUIRES(mThreadMutex) {
-            return !mRunning || !mFunctionCalls.empty();
+            return !mRunning || !mFunctionCalls.empty() || !mBackgroundFunctionCalls.empty();
         });
     }
 
@@ -259,7 +264,10 @@ ftl::Future<FenceResult> RenderEngineThreaded::drawLayers(
     {
         std::lock_guard lock(mThreadMutex);
         mNeedsPostRenderCleanup = true;
-        mFunctionCalls.push(
+        auto& queue = display.priority == DisplaySettings::Priority::Background
+                ? mBackgroundFunctionCalls
+                : mFunctionCalls;
+        queue.push(
                 [resultPromise, display, layers, buffer, fd](renderengine::RenderEngine& instance) {
                     ATRACE_NAME("REThreaded::drawLayers");
                     instance.updateProtectedContext(layers, buffer);
@@ -96,6 +96,9 @@ private:
 
     using Work = std::function<void(renderengine::RenderEngine&)>;
     mutable std::queue<Work> mFunctionCalls GUARDED_BY(mThreadMutex);
+    // Drained only while mFunctionCalls is empty, so that background draws such as screenshots
+    // do not delay composition that is queued behind them.
+    mutable std::queue<Work> mBackgroundFunctionCalls GUARDED_BY(mThreadMutex);
     mutable std::condition_variable mCondition;
 
     // Used to allow select thread safe methods to be accessed without requiring the
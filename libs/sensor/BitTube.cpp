@@ -23,11 +23,16 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include <binder/Parcel.h>
 
 namespace android {
 // ----------------------------------------------------------------------------
 
+// Most messages received by a single recvObjectsBatched call.
+static const size_t MAX_BATCHED_MESSAGES = 16;
+
 // Socket buffer size.  The default is typically about 128KB, which is much larger than
 // we really need.  So we make it smaller.
 static const size_t DEFAULT_SOCKET_BUFFER_SIZE = 4 * 1024;
@@ -170,5 +175,49 @@ ssize_t BitTube::recvObjects(const sp<BitTube>& tube,
     return size < 0 ? size : size / static_cast<ssize_t>(objSize);
 }
 
+ssize_t BitTube::recvObjectsBatched(const sp<BitTube>& tube,
+        void* events, size_t count, size_t objSize, size_t maxPerMessage)
+{
+    const size_t numMessages = std::min(count / maxPerMessage, MAX_BATCHED_MESSAGES);
+    if (numMessages <= 1) {
+        return recvObjects(tube, events, count, objSize);
+    }
+
+    // Each message gets a slot large enough for any message, so none can be truncated.
+    char* vaddr = reinterpret_cast<char*>(events);
+    const size_t slotSize = maxPerMessage * objSize;
+    iovec iovs[MAX_BATCHED_MESSAGES];
+    mmsghdr msgs[MAX_BATCHED_MESSAGES] = {};
+    for (size_t i = 0; i < numMessages; i++) {
+        iovs[i] = {.iov_base = vaddr + i * slotSize, .iov_len = slotSize};
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int received;
+    do {
+        received = ::recvmmsg(tube->mReceiveFd, msgs, numMessages, MSG_DONTWAIT, nullptr);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0) {
+        // Same as read(): no data is not an error for a non-blocking receive.
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -errno;
+    }
+
+    // Close the gaps left at the end of slots which weren't full.
+    size_t size = 0;
+    for (int i = 0; i < received; i++) {
+        const size_t len = msgs[i].msg_len;
+        // should never happen because of SOCK_SEQPACKET
+        LOG_ALWAYS_FATAL_IF(len % objSize,
+                "BitTube::recvObjectsBatched(count=%zu, size=%zu), res=%zu (partial events were "
+                "received!)", count, objSize, len);
+        if (size != i * slotSize) {
+            memmove(vaddr + size, iovs[i].iov_base, len);
+        }
+        size += len;
+    }
+    return static_cast<ssize_t>(size / objSize);
+}
+
 // ----------------------------------------------------------------------------
 }; // namespace android
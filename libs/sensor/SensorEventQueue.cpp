@@ -64,6 +64,13 @@ ssize_t SensorEventQueue::write(const sp<BitTube>& tube,
 }
 
 ssize_t SensorEventQueue::read(ASensorEvent* events, size_t numEvents) {
+    if (mAvailable == 0 && numEvents >= MAX_RECEIVE_BUFFER_EVENT_COUNT) {
+        // sensorservice never sends more than MAX_RECEIVE_BUFFER_EVENT_COUNT events at once, so
+        // a buffer this large can't truncate a message. Skip mRecBuffer and drain as many
+        // messages as fit straight into the caller's buffer.
+        return BitTube::recvObjectsBatched(mSensorChannel, events, numEvents,
+                                           MAX_RECEIVE_BUFFER_EVENT_COUNT);
+    }
     if (mAvailable == 0) {
         ssize_t err = BitTube::recvObjects(mSensorChannel,
                 mRecBuffer, MAX_RECEIVE_BUFFER_EVENT_COUNT);
@@ -176,8 +183,9 @@ void SensorEventQueue::sendAck(const ASensorEvent* events, int count) {
             ++mNumAcksToSend;
         }
     }
-    // Send mNumAcksToSend to acknowledge for the wake up sensor events received.
-    if (mNumAcksToSend > 0) {
+    // Send mNumAcksToSend to acknowledge for the wake up sensor events received. Events still in
+    // mRecBuffer are read right after this, so their acks are sent together with these.
+    if (mNumAcksToSend > 0 && mAvailable == 0) {
         ssize_t size = ::send(mSensorChannel->getFd(), &mNumAcksToSend, sizeof(mNumAcksToSend),
                 MSG_DONTWAIT | MSG_NOSIGNAL);
         if (size < 0) {
@@ -63,6 +63,15 @@ public:
         return recvObjects(tube, events, count, sizeof(T));
     }
 
+    // receive the objects of as many messages as are available and fit in events, with a single
+    // system call. No message may hold more than maxPerMessage objects. The objects are packed
+    // at the start of events, in the order they were sent.
+    template <typename T>
+    static ssize_t recvObjectsBatched(const sp<BitTube>& tube,
+            T* events, size_t count, size_t maxPerMessage) {
+        return recvObjectsBatched(tube, events, count, sizeof(T), maxPerMessage);
+    }
+
     // parcels this BitTube
     status_t writeToParcel(Parcel* reply) const;
 
@@ -84,6 +93,9 @@ private:
 
     static ssize_t recvObjects(const sp<BitTube>& tube,
             void* events, size_t count, size_t objSize);
+
+    static ssize_t recvObjectsBatched(const sp<BitTube>& tube,
+            void* events, size_t count, size_t objSize, size_t maxPerMessage);
 };
 
 // ----------------------------------------------------------------------------
@@ -74,6 +74,9 @@ public:
     static ssize_t write(const sp<BitTube>& tube,
             ASensorEvent const* events, size_t numEvents);
 
+    // Reads up to numEvents events without blocking. When numEvents is at least
+    // MAX_RECEIVE_BUFFER_EVENT_COUNT, events are received straight into the given buffer, and
+    // all the pending messages which fit are read at once.
     ssize_t read(ASensorEvent* events, size_t numEvents);
 
     status_t waitForEvent() const;
@@ -90,6 +93,7 @@ public:
     status_t disableSensor(int32_t handle) const;
     status_t flush() const;
     // Send an ack for every wake_up sensor event that is set to WAKE_UP_SENSOR_EVENT_NEEDS_ACK.
+    // Acks are held back while read() still has buffered events, and sent with theirs.
     void sendAck(const ASensorEvent* events, int count);
 
     status_t injectSensorEvent(const ASensorEvent& event);
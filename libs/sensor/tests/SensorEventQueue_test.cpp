@@ -21,6 +21,7 @@
 
 #include <android/sensor.h>
 #include <hardware/sensors-base.h>
+#include <sensor/BitTube.h>
 #include <sensor/SensorManager.h>
 #include <sensor/SensorEventQueue.h>
 
@@ -169,4 +170,26 @@ TEST_F(SensorEventQueueTest, FilterEvents_ReconfigureAdditionalInfo) {
     runFilterTest(events);
 }
 
+TEST(BitTubeTest, RecvObjectsBatched) {
+    sp<BitTube> tube = sp<BitTube>::make(64 * 1024);
+    ASSERT_EQ(NO_ERROR, tube->initCheck());
+
+    const int32_t first[] = {1, 2};
+    const int32_t second[] = {3, 4, 5, 6};
+    const int32_t third[] = {7};
+    ASSERT_EQ(2, BitTube::sendObjects(tube, first, 2));
+    ASSERT_EQ(4, BitTube::sendObjects(tube, second, 4));
+    ASSERT_EQ(1, BitTube::sendObjects(tube, third, 1));
+
+    // Room for four messages of up to four objects, so all three are read at once.
+    int32_t received[16] = {};
+    ASSERT_EQ(7, BitTube::recvObjectsBatched(tube, received, 16, 4 /* maxPerMessage */));
+    for (int32_t i = 0; i < 7; i++) {
+        EXPECT_EQ(i + 1, received[i]);
+    }
+
+    // Nothing left to read.
+    EXPECT_EQ(0, BitTube::recvObjectsBatched(tube, received, 16, 4 /* maxPerMessage */));
+}
+
 } // namespace android
@@ -19,6 +19,7 @@
 #include <tonemap/tonemap.h>
 
 #include <cmath>
+#include <iterator>
 #include <optional>
 
 #include <math/mat4.h>
@@ -245,17 +246,23 @@ std::string buildLinearEffectSkSL(const LinearEffect& linearEffect) {
     return shaderString;
 }
 
-ColorSpace toColorSpace(ui::Dataspace dataspace) {
+// ColorSpaces are costly to construct and the uniforms are rebuilt for every draw that needs them,
+// so hand out shared instances.
+const ColorSpace& toColorSpace(ui::Dataspace dataspace) {
+    static const ColorSpace kSRGB = ColorSpace::sRGB();
+    static const ColorSpace kDisplayP3 = ColorSpace::DisplayP3();
+    static const ColorSpace kBT2020 = ColorSpace::BT2020();
+    static const ColorSpace kAdobeRGB = ColorSpace::AdobeRGB();
     switch (dataspace & HAL_DATASPACE_STANDARD_MASK) {
         case HAL_DATASPACE_STANDARD_BT709:
-            return ColorSpace::sRGB();
+            return kSRGB;
         case HAL_DATASPACE_STANDARD_DCI_P3:
-            return ColorSpace::DisplayP3();
+            return kDisplayP3;
         case HAL_DATASPACE_STANDARD_BT2020:
         case HAL_DATASPACE_STANDARD_BT2020_CONSTANT_LUMINANCE:
-            return ColorSpace::BT2020();
+            return kBT2020;
         case HAL_DATASPACE_STANDARD_ADOBE_RGB:
-            return ColorSpace::AdobeRGB();
+            return kAdobeRGB;
             // TODO(b/208290320): BT601 format and variants return different primaries
         case HAL_DATASPACE_STANDARD_BT601_625:
         case HAL_DATASPACE_STANDARD_BT601_625_UNADJUSTED:
@@ -267,7 +274,7 @@ ColorSpace toColorSpace(ui::Dataspace dataspace) {
         case HAL_DATASPACE_STANDARD_FILM:
         case HAL_DATASPACE_STANDARD_UNSPECIFIED:
         default:
-            return ColorSpace::sRGB();
+            return kSRGB;
     }
 }
 
@@ -276,21 +283,22 @@ std::vector<tonemap::ShaderUniform> buildLinearEffectUniforms(
         const LinearEffect& linearEffect, const mat4& colorTransform, float maxDisplayLuminance,
         float currentDisplayLuminanceNits, float maxLuminance, AHardwareBuffer* buffer,
         aidl::android::hardware::graphics::composer3::RenderIntent renderIntent) {
+    static const ColorSpace kLinearExtendedSRGB = ColorSpace::linearExtendedSRGB();
+
     std::vector<tonemap::ShaderUniform> uniforms;
 
-    auto inputColorSpace = toColorSpace(linearEffect.inputDataspace);
-    auto outputColorSpace = toColorSpace(linearEffect.outputDataspace);
+    const ColorSpace& inputColorSpace = toColorSpace(linearEffect.inputDataspace);
+    const ColorSpace& outputColorSpace = toColorSpace(linearEffect.outputDataspace);
 
-    uniforms.push_back(
-            {.name = "in_rgbToXyz",
-             .value = buildUniformValue<mat3>(ColorSpace::linearExtendedSRGB().getRGBtoXYZ())});
+    uniforms.push_back({.name = "in_rgbToXyz",
+                        .value = buildUniformValue<mat3>(kLinearExtendedSRGB.getRGBtoXYZ())});
     uniforms.push_back({.name = "in_xyzToSrcRgb",
                         .value = buildUniformValue<mat3>(inputColorSpace.getXYZtoRGB())});
     // Transforms xyz colors to linear source colors, then applies the color transform, then
     // transforms to linear extended RGB for skia to color manage.
     uniforms.push_back({.name = "in_colorTransform",
                         .value = buildUniformValue<mat4>(
-                                mat4(ColorSpace::linearExtendedSRGB().getXYZtoRGB()) *
+                                mat4(kLinearExtendedSRGB.getXYZtoRGB()) *
                                 // TODO: the color transform ideally should be applied
                                 // in the source colorspace, but doing that breaks
                                 // renderengine tests
@@ -309,9 +317,9 @@ std::vector<tonemap::ShaderUniform> buildLinearEffectUniforms(
                                .buffer = buffer,
                                .renderIntent = renderIntent};
 
-    for (const auto uniform : tonemap::getToneMapper()->generateShaderSkSLUniforms(metadata)) {
-        uniforms.push_back(uniform);
-    }
+    auto tonemapUniforms = tonemap::getToneMapper()->generateShaderSkSLUniforms(metadata);
+    uniforms.insert(uniforms.end(), std::make_move_iterator(tonemapUniforms.begin()),
+                    std::make_move_iterator(tonemapUniforms.end()));
 
     return uniforms;
 }
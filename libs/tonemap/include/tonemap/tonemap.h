@@ -21,6 +21,8 @@
 #include <android/hardware_buffer.h>
 #include <math/vec3.h>
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -83,6 +85,44 @@ struct Color {
     vec3 xyz;
 };
 
+// A tonemapping curve sampled ahead of time for a particular source dataspace, destination dataspace
+// and metadata, as returned by ToneMapper::getTonemapLut().
+//
+// Looking up a gain interpolates between the two nearest samples, which is considerably cheaper than
+// evaluating the curve, at the cost of a small approximation error. CPU clients that tonemap many
+// colors with the same parameters, such as image decoders, should prefer this over
+// ToneMapper::lookupTonemapGain().
+class ToneMapLut {
+public:
+    // The value of a color that the curve is a function of.
+    enum class Input {
+        Luminance, // The Y component of the XYZ color.
+        MaxRGB,    // The largest component of the linear RGB color.
+    };
+
+    // Samples gainFn, which maps the absolute nits of the input to a gain. gainFn is retained to
+    // evaluate inputs outside of the sampled range.
+    ToneMapLut(Input input, std::function<double(double nits)> gainFn);
+
+    // Equivalent to ToneMapper::lookupTonemapGain() for the parameters that this table was built
+    // for, up to the approximation error of the table.
+    double lookupTonemapGain(const Color& color) const;
+    std::vector<double> lookupTonemapGain(const std::vector<Color>& colors) const;
+
+private:
+    // The table covers the inputs within [2^(kMinExponent - 1), 2^kMaxExponent) nits, sampled
+    // linearly within each power of two.
+    static constexpr int kMinExponent = -9;
+    static constexpr int kMaxExponent = 14;
+    static constexpr int kSamplesPerOctave = 32;
+
+    double lookupTonemapGain(double nits) const;
+
+    const Input mInput;
+    const std::function<double(double)> mGainFn;
+    std::vector<float> mGains;
+};
+
 class ToneMapper {
 public:
     virtual ~ToneMapper() {}
@@ -148,6 +188,14 @@ public:
             aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
             aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
             const std::vector<Color>& colors, const Metadata& metadata) = 0;
+
+    // Returns the tonemapping curve of lookupTonemapGain() for the given parameters, sampled into a
+    // table. Tables are cached across calls, so clients may call this for every frame or image
+    // without rebuilding the table unless the parameters change.
+    virtual std::shared_ptr<const ToneMapLut> getTonemapLut(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+            const Metadata& metadata) = 0;
 };
 
 // Retrieves a tonemapper instance.
@@ -85,4 +85,57 @@ TEST_F(TonemapTest, generateTonemapGainShaderSkSL_containsEntryPointForHLG) {
     EXPECT_THAT(shader, HasSubstr("float libtonemap_LookupTonemapGain(vec3 linearRGB, vec3 xyz)"));
 }
 
+TEST_F(TonemapTest, getTonemapLut_matchesLookupTonemapGain) {
+    using aidl::android::hardware::graphics::common::Dataspace;
+    const std::pair<Dataspace, Dataspace> kConversions[] = {
+            {Dataspace::BT2020_ITU_PQ, Dataspace::DISPLAY_P3},
+            {Dataspace::BT2020_ITU_HLG, Dataspace::DISPLAY_P3},
+            {Dataspace::BT2020_ITU_PQ, Dataspace::BT2020_ITU_HLG},
+            {Dataspace::BT2020_ITU_HLG, Dataspace::BT2020_ITU_PQ},
+            {Dataspace::DISPLAY_P3, Dataspace::BT2020_ITU_PQ},
+    };
+    const tonemap::Metadata metadata{.displayMaxLuminance = 750.f,
+                                     .contentMaxLuminance = 4000.f,
+                                     .currentDisplayLuminance = 300.f};
+
+    std::vector<tonemap::Color> colors;
+    for (double nits = 0.01; nits <= 10000.0; nits *= 1.1) {
+        const float channel = static_cast<float>(nits);
+        colors.push_back({.linearRGB = vec3(channel, channel * 0.5f, channel * 0.25f),
+                          .xyz = vec3(channel * 0.9f, channel, channel * 1.1f)});
+    }
+
+    for (const auto& [source, destination] : kConversions) {
+        const auto lut = tonemap::getToneMapper()->getTonemapLut(source, destination, metadata);
+        ASSERT_NE(nullptr, lut);
+
+        const auto expected =
+                tonemap::getToneMapper()->lookupTonemapGain(source, destination, colors, metadata);
+        const auto actual = lut->lookupTonemapGain(colors);
+        ASSERT_EQ(expected.size(), actual.size());
+
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_NEAR(expected[i], actual[i], expected[i] * 1e-3)
+                    << "source=" << static_cast<int32_t>(source)
+                    << " destination=" << static_cast<int32_t>(destination) << " index=" << i;
+        }
+    }
+}
+
+TEST_F(TonemapTest, getTonemapLut_cachesTables) {
+    using aidl::android::hardware::graphics::common::Dataspace;
+    tonemap::Metadata metadata{.displayMaxLuminance = 750.f, .currentDisplayLuminance = 300.f};
+
+    const auto lut = tonemap::getToneMapper()->getTonemapLut(Dataspace::BT2020_ITU_PQ,
+                                                             Dataspace::DISPLAY_P3, metadata);
+    EXPECT_EQ(lut,
+              tonemap::getToneMapper()->getTonemapLut(Dataspace::BT2020_ITU_PQ,
+                                                      Dataspace::DISPLAY_P3, metadata));
+
+    metadata.displayMaxLuminance = 500.f;
+    EXPECT_NE(lut,
+              tonemap::getToneMapper()->getTonemapLut(Dataspace::BT2020_ITU_PQ,
+                                                      Dataspace::DISPLAY_P3, metadata));
+}
+
 } // namespace android
@@ -17,6 +17,7 @@
 #include <tonemap/tonemap.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <mutex>
 #include <type_traits>
@@ -64,6 +65,48 @@ float computeHlgGamma(float currentDisplayBrightnessNits) {
     return 1.2 + 0.42 * std::log10(currentDisplayBrightnessNits / 1000);
 }
 
+// Parameters that a tonemapping curve may depend on. Parameters that a particular curve does not
+// depend on are left zero-initialized, so that they do not cause spurious cache misses.
+struct LutKey {
+    int32_t sourceTransfer = 0;
+    int32_t destinationTransfer = 0;
+    float displayMaxLuminance = 0.f;
+    float contentMaxLuminance = 0.f;
+    float currentDisplayLuminance = 0.f;
+
+    bool operator==(const LutKey&) const = default;
+};
+
+// Keeps the most recently used tonemapping tables, since HDR content commonly alternates between a
+// handful of curves, e.g. one per visible HDR layer.
+class LutCache {
+public:
+    template <typename F>
+    std::shared_ptr<const ToneMapLut> getOrBuild(const LutKey& key, F&& build) {
+        std::lock_guard lock(mMutex);
+
+        const auto it = std::find_if(mEntries.begin(), mEntries.end(),
+                                     [&key](const auto& entry) { return entry.first == key; });
+        if (it != mEntries.end()) {
+            // Move the entry to the front, so that the least recently used entry is at the back.
+            std::rotate(mEntries.begin(), it, it + 1);
+            return mEntries.front().second;
+        }
+
+        if (mEntries.size() == kMaxEntries) {
+            mEntries.pop_back();
+        }
+        mEntries.emplace(mEntries.begin(), key, build());
+        return mEntries.front().second;
+    }
+
+private:
+    static constexpr size_t kMaxEntries = 4;
+
+    std::mutex mMutex;
+    std::vector<std::pair<LutKey, std::shared_ptr<const ToneMapLut>>> mEntries;
+};
+
 class ToneMapperO : public ToneMapper {
 public:
     std::string generateTonemapGainShaderSkSL(
@@ -289,6 +332,10 @@ public:
             aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
             aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
             const std::vector<Color>& colors, const Metadata& metadata) override {
+        const int32_t sourceTransfer = static_cast<int32_t>(sourceDataspace) & kTransferMask;
+        const int32_t destinationTransfer =
+                static_cast<int32_t>(destinationDataspace) & kTransferMask;
+
         std::vector<Gain> gains;
         gains.reserve(colors.size());
 
@@ -297,146 +344,177 @@ public:
                 gains.push_back(1.0);
                 continue;
             }
-            const int32_t sourceDataspaceInt = static_cast<int32_t>(sourceDataspace);
-            const int32_t destinationDataspaceInt = static_cast<int32_t>(destinationDataspace);
-
-            double targetNits = 0.0;
-            switch (sourceDataspaceInt & kTransferMask) {
-                case kTransferST2084:
-                case kTransferHLG:
-                    switch (destinationDataspaceInt & kTransferMask) {
-                        case kTransferST2084:
-                            targetNits = xyz.y;
-                            break;
-                        case kTransferHLG:
-                            // PQ has a wider luminance range (10,000 nits vs. 1,000 nits) than HLG,
-                            // so we'll clamp the luminance range in case we're mapping from PQ
-                            // input to HLG output.
-                            targetNits = std::clamp(xyz.y, 0.0f, 1000.0f);
-                            targetNits *= std::pow(targetNits / 1000.f, -0.2 / 1.2);
-                            break;
-                        default:
-                            // Here we're mapping from HDR to SDR content, so interpolate using a
-                            // Hermitian polynomial onto the smaller luminance range.
+            gains.push_back(toneMapTargetNits(sourceTransfer, destinationTransfer, metadata, xyz.y) /
+                            xyz.y);
+        }
+        return gains;
+    }
 
-                            targetNits = xyz.y;
+    std::shared_ptr<const ToneMapLut> getTonemapLut(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+            const Metadata& metadata) override {
+        const int32_t sourceTransfer = static_cast<int32_t>(sourceDataspace) & kTransferMask;
+        const int32_t destinationTransfer =
+                static_cast<int32_t>(destinationDataspace) & kTransferMask;
+        const LutKey key{.sourceTransfer = sourceTransfer,
+                         .destinationTransfer = destinationTransfer,
+                         .displayMaxLuminance = metadata.displayMaxLuminance,
+                         .contentMaxLuminance = metadata.contentMaxLuminance};
+
+        return mLutCache.getOrBuild(key, [&] {
+            const Metadata curveMetadata{.displayMaxLuminance = metadata.displayMaxLuminance,
+                                         .contentMaxLuminance = metadata.contentMaxLuminance};
+            auto gainFn = [=](double nits) {
+                return toneMapTargetNits(sourceTransfer, destinationTransfer, curveMetadata, nits) /
+                        nits;
+            };
+            return std::make_shared<const ToneMapLut>(ToneMapLut::Input::Luminance,
+                                                      std::move(gainFn));
+        });
+    }
 
-                            if ((sourceDataspaceInt & kTransferMask) == kTransferHLG) {
-                                targetNits *= std::pow(targetNits, 0.2);
-                            }
-                            // if the max input luminance is less than what we can output then
-                            // no tone mapping is needed as all color values will be in range.
-                            if (metadata.contentMaxLuminance > metadata.displayMaxLuminance) {
-                                // three control points
-                                const double x0 = 10.0;
-                                const double y0 = 17.0;
-                                double x1 = metadata.displayMaxLuminance * 0.75;
-                                double y1 = x1;
-                                double x2 = x1 + (metadata.contentMaxLuminance - x1) / 2.0;
-                                double y2 = y1 + (metadata.displayMaxLuminance - y1) * 0.75;
-
-                                // horizontal distances between the last three control points
-                                double h12 = x2 - x1;
-                                double h23 = metadata.contentMaxLuminance - x2;
-                                // tangents at the last three control points
-                                double m1 = (y2 - y1) / h12;
-                                double m3 = (metadata.displayMaxLuminance - y2) / h23;
-                                double m2 = (m1 + m3) / 2.0;
-
-                                if (targetNits < x0) {
-                                    // scale [0.0, x0] to [0.0, y0] linearly
-                                    double slope = y0 / x0;
-                                    targetNits *= slope;
-                                } else if (targetNits < x1) {
-                                    // scale [x0, x1] to [y0, y1] linearly
-                                    double slope = (y1 - y0) / (x1 - x0);
-                                    targetNits = y0 + (targetNits - x0) * slope;
-                                } else if (targetNits < x2) {
-                                    // scale [x1, x2] to [y1, y2] using Hermite interp
-                                    double t = (targetNits - x1) / h12;
-                                    targetNits = (y1 * (1.0 + 2.0 * t) + h12 * m1 * t) * (1.0 - t) *
-                                                    (1.0 - t) +
-                                            (y2 * (3.0 - 2.0 * t) + h12 * m2 * (t - 1.0)) * t * t;
-                                } else {
-                                    // scale [x2, maxInLumi] to [y2, maxOutLumi] using Hermite
-                                    // interp
-                                    double t = (targetNits - x2) / h23;
-                                    targetNits = (y2 * (1.0 + 2.0 * t) + h23 * m2 * t) * (1.0 - t) *
-                                                    (1.0 - t) +
-                                            (metadata.displayMaxLuminance * (3.0 - 2.0 * t) +
-                                             h23 * m3 * (t - 1.0)) *
-                                                    t * t;
-                                }
-                            }
-                            break;
-                    }
-                    break;
-                default:
-                    // source is SDR
-                    switch (destinationDataspaceInt & kTransferMask) {
-                        case kTransferST2084:
-                        case kTransferHLG: {
-                            // Map from SDR onto an HDR output buffer
-                            // Here we use a polynomial curve to map from [0, displayMaxLuminance]
-                            // onto [0, maxOutLumi] which is hard-coded to be 3000 nits.
-                            const double maxOutLumi = 3000.0;
-
-                            double x0 = 5.0;
-                            double y0 = 2.5;
-                            double x1 = metadata.displayMaxLuminance * 0.7;
-                            double y1 = maxOutLumi * 0.15;
-                            double x2 = metadata.displayMaxLuminance * 0.9;
-                            double y2 = maxOutLumi * 0.45;
-                            double x3 = metadata.displayMaxLuminance;
-                            double y3 = maxOutLumi;
-
-                            double c1 = y1 / 3.0;
-                            double c2 = y2 / 2.0;
-                            double c3 = y3 / 1.5;
-
-                            targetNits = xyz.y;
-
-                            if (targetNits <= x0) {
+private:
+    // Maps the luminance of a color from the source transfer to the destination transfer.
+    static double toneMapTargetNits(int32_t sourceTransfer, int32_t destinationTransfer,
+                                    const Metadata& metadata, double nits) {
+        double targetNits = 0.0;
+        switch (sourceTransfer) {
+            case kTransferST2084:
+            case kTransferHLG:
+                switch (destinationTransfer) {
+                    case kTransferST2084:
+                        targetNits = nits;
+                        break;
+                    case kTransferHLG:
+                        // PQ has a wider luminance range (10,000 nits vs. 1,000 nits) than HLG,
+                        // so we'll clamp the luminance range in case we're mapping from PQ
+                        // input to HLG output.
+                        targetNits = std::clamp(nits, 0.0, 1000.0);
+                        targetNits *= std::pow(targetNits / 1000.f, -0.2 / 1.2);
+                        break;
+                    default:
+                        // Here we're mapping from HDR to SDR content, so interpolate using a
+                        // Hermitian polynomial onto the smaller luminance range.
+
+                        targetNits = nits;
+
+                        if (sourceTransfer == kTransferHLG) {
+                            targetNits *= std::pow(targetNits, 0.2);
+                        }
+                        // if the max input luminance is less than what we can output then
+                        // no tone mapping is needed as all color values will be in range.
+                        if (metadata.contentMaxLuminance > metadata.displayMaxLuminance) {
+                            // three control points
+                            const double x0 = 10.0;
+                            const double y0 = 17.0;
+                            double x1 = metadata.displayMaxLuminance * 0.75;
+                            double y1 = x1;
+                            double x2 = x1 + (metadata.contentMaxLuminance - x1) / 2.0;
+                            double y2 = y1 + (metadata.displayMaxLuminance - y1) * 0.75;
+
+                            // horizontal distances between the last three control points
+                            double h12 = x2 - x1;
+                            double h23 = metadata.contentMaxLuminance - x2;
+                            // tangents at the last three control points
+                            double m1 = (y2 - y1) / h12;
+                            double m3 = (metadata.displayMaxLuminance - y2) / h23;
+                            double m2 = (m1 + m3) / 2.0;
+
+                            if (targetNits < x0) {
                                 // scale [0.0, x0] to [0.0, y0] linearly
                                 double slope = y0 / x0;
                                 targetNits *= slope;
-                            } else if (targetNits <= x1) {
-                                // scale [x0, x1] to [y0, y1] using a curve
-                                double t = (targetNits - x0) / (x1 - x0);
-                                targetNits = (1.0 - t) * (1.0 - t) * y0 + 2.0 * (1.0 - t) * t * c1 +
-                                        t * t * y1;
-                            } else if (targetNits <= x2) {
-                                // scale [x1, x2] to [y1, y2] using a curve
-                                double t = (targetNits - x1) / (x2 - x1);
-                                targetNits = (1.0 - t) * (1.0 - t) * y1 + 2.0 * (1.0 - t) * t * c2 +
-                                        t * t * y2;
+                            } else if (targetNits < x1) {
+                                // scale [x0, x1] to [y0, y1] linearly
+                                double slope = (y1 - y0) / (x1 - x0);
+                                targetNits = y0 + (targetNits - x0) * slope;
+                            } else if (targetNits < x2) {
+                                // scale [x1, x2] to [y1, y2] using Hermite interp
+                                double t = (targetNits - x1) / h12;
+                                targetNits = (y1 * (1.0 + 2.0 * t) + h12 * m1 * t) * (1.0 - t) *
+                                                (1.0 - t) +
+                                        (y2 * (3.0 - 2.0 * t) + h12 * m2 * (t - 1.0)) * t * t;
                             } else {
-                                // scale [x2, x3] to [y2, y3] using a curve
-                                double t = (targetNits - x2) / (x3 - x2);
-                                targetNits = (1.0 - t) * (1.0 - t) * y2 + 2.0 * (1.0 - t) * t * c3 +
-                                        t * t * y3;
+                                // scale [x2, maxInLumi] to [y2, maxOutLumi] using Hermite
+                                // interp
+                                double t = (targetNits - x2) / h23;
+                                targetNits = (y2 * (1.0 + 2.0 * t) + h23 * m2 * t) * (1.0 - t) *
+                                                (1.0 - t) +
+                                        (metadata.displayMaxLuminance * (3.0 - 2.0 * t) +
+                                         h23 * m3 * (t - 1.0)) *
+                                                t * t;
                             }
+                        }
+                        break;
+                }
+                break;
+            default:
+                // source is SDR
+                switch (destinationTransfer) {
+                    case kTransferST2084:
+                    case kTransferHLG: {
+                        // Map from SDR onto an HDR output buffer
+                        // Here we use a polynomial curve to map from [0, displayMaxLuminance]
+                        // onto [0, maxOutLumi] which is hard-coded to be 3000 nits.
+                        const double maxOutLumi = 3000.0;
+
+                        double x0 = 5.0;
+                        double y0 = 2.5;
+                        double x1 = metadata.displayMaxLuminance * 0.7;
+                        double y1 = maxOutLumi * 0.15;
+                        double x2 = metadata.displayMaxLuminance * 0.9;
+                        double y2 = maxOutLumi * 0.45;
+                        double x3 = metadata.displayMaxLuminance;
+                        double y3 = maxOutLumi;
+
+                        double c1 = y1 / 3.0;
+                        double c2 = y2 / 2.0;
+                        double c3 = y3 / 1.5;
+
+                        targetNits = nits;
+
+                        if (targetNits <= x0) {
+                            // scale [0.0, x0] to [0.0, y0] linearly
+                            double slope = y0 / x0;
+                            targetNits *= slope;
+                        } else if (targetNits <= x1) {
+                            // scale [x0, x1] to [y0, y1] using a curve
+                            double t = (targetNits - x0) / (x1 - x0);
+                            targetNits = (1.0 - t) * (1.0 - t) * y0 + 2.0 * (1.0 - t) * t * c1 +
+                                    t * t * y1;
+                        } else if (targetNits <= x2) {
+                            // scale [x1, x2] to [y1, y2] using a curve
+                            double t = (targetNits - x1) / (x2 - x1);
+                            targetNits = (1.0 - t) * (1.0 - t) * y1 + 2.0 * (1.0 - t) * t * c2 +
+                                    t * t * y2;
+                        } else {
+                            // scale [x2, x3] to [y2, y3] using a curve
+                            double t = (targetNits - x2) / (x3 - x2);
+                            targetNits = (1.0 - t) * (1.0 - t) * y2 + 2.0 * (1.0 - t) * t * c3 +
+                                    t * t * y3;
+                        }
 
-                            if ((destinationDataspaceInt & kTransferMask) == kTransferHLG) {
-                                targetNits *= std::pow(targetNits / 1000.0, -0.2 / 1.2);
-                            }
-                        } break;
-                        default:
-                            // For completeness, this is tone-mapping from SDR to SDR, where this is
-                            // just a no-op.
-                            targetNits = xyz.y;
-                            break;
-                    }
-            }
-            gains.push_back(targetNits / xyz.y);
+                        if (destinationTransfer == kTransferHLG) {
+                            targetNits *= std::pow(targetNits / 1000.0, -0.2 / 1.2);
+                        }
+                    } break;
+                    default:
+                        // For completeness, this is tone-mapping from SDR to SDR, where this is
+                        // just a no-op.
+                        targetNits = nits;
+                        break;
+                }
         }
-        return gains;
+        return targetNits;
     }
+
+    LutCache mLutCache;
 };
 
 class ToneMapper13 : public ToneMapper {
 private:
-    double OETF_ST2084(double nits) {
+    static double OETF_ST2084(double nits) {
         nits = nits / 10000.0;
         double m1 = (2610.0 / 4096.0) / 4.0;
         double m2 = (2523.0 / 4096.0) * 128.0;
@@ -449,7 +527,7 @@ private:
         return std::pow(tmp, m2);
     }
 
-    double OETF_HLG(double nits) {
+    static double OETF_HLG(double nits) {
         nits = nits / 1000.0;
         const double a = 0.17883277;
         const double b = 0.28466892;
@@ -630,31 +708,14 @@ public:
             aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
             aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
             const std::vector<Color>& colors, const Metadata& metadata) override {
+        const int32_t sourceTransfer = static_cast<int32_t>(sourceDataspace) & kTransferMask;
+        const int32_t destinationTransfer =
+                static_cast<int32_t>(destinationDataspace) & kTransferMask;
+        const Curve curve(metadata);
+
         std::vector<Gain> gains;
         gains.reserve(colors.size());
 
-        // Precompute constants for HDR->SDR tonemapping parameters
-        constexpr double maxInLumi = 4000;
-        const double maxOutLumi = metadata.displayMaxLuminance;
-
-        const double x1 = maxOutLumi * 0.65;
-        const double y1 = x1;
-
-        const double x3 = maxInLumi;
-        const double y3 = maxOutLumi;
-
-        const double x2 = x1 + (x3 - x1) * 4.0 / 17.0;
-        const double y2 = maxOutLumi * 0.9;
-
-        const double greyNorm1 = OETF_ST2084(x1);
-        const double greyNorm2 = OETF_ST2084(x2);
-        const double greyNorm3 = OETF_ST2084(x3);
-
-        const double slope2 = (y2 - y1) / (greyNorm2 - greyNorm1);
-        const double slope3 = (y3 - y2) / (greyNorm3 - greyNorm2);
-
-        const double hlgGamma = computeHlgGamma(metadata.currentDisplayLuminance);
-
         for (const auto [linearRGB, _] : colors) {
             double maxRGB = std::max({linearRGB.r, linearRGB.g, linearRGB.b});
 
@@ -662,74 +723,181 @@ public:
                 gains.push_back(1.0);
                 continue;
             }
+            gains.push_back(toneMapTargetNits(sourceTransfer, destinationTransfer, curve, maxRGB) /
+                            maxRGB);
+        }
+        return gains;
+    }
 
-            const int32_t sourceDataspaceInt = static_cast<int32_t>(sourceDataspace);
-            const int32_t destinationDataspaceInt = static_cast<int32_t>(destinationDataspace);
+    std::shared_ptr<const ToneMapLut> getTonemapLut(
+            aidl::android::hardware::graphics::common::Dataspace sourceDataspace,
+            aidl::android::hardware::graphics::common::Dataspace destinationDataspace,
+            const Metadata& metadata) override {
+        const int32_t sourceTransfer = static_cast<int32_t>(sourceDataspace) & kTransferMask;
+        const int32_t destinationTransfer =
+                static_cast<int32_t>(destinationDataspace) & kTransferMask;
+        const LutKey key{.sourceTransfer = sourceTransfer,
+                         .destinationTransfer = destinationTransfer,
+                         .displayMaxLuminance = metadata.displayMaxLuminance,
+                         .currentDisplayLuminance = metadata.currentDisplayLuminance};
+
+        return mLutCache.getOrBuild(key, [&] {
+            auto gainFn = [=, curve = Curve(metadata)](double nits) {
+                return toneMapTargetNits(sourceTransfer, destinationTransfer, curve, nits) / nits;
+            };
+            return std::make_shared<const ToneMapLut>(ToneMapLut::Input::MaxRGB, std::move(gainFn));
+        });
+    }
 
-            double targetNits = 0.0;
-            switch (sourceDataspaceInt & kTransferMask) {
-                case kTransferST2084:
-                    switch (destinationDataspaceInt & kTransferMask) {
-                        case kTransferST2084:
-                            targetNits = maxRGB;
-                            break;
-                        case kTransferHLG:
-                            // PQ has a wider luminance range (10,000 nits vs. 1,000 nits) than HLG,
-                            // so we'll clamp the luminance range in case we're mapping from PQ
-                            // input to HLG output.
-                            targetNits = std::clamp(maxRGB, 0.0, 1000.0);
-                            targetNits *= pow(targetNits / 1000.0, (1 - hlgGamma) / (hlgGamma));
+private:
+    // Matches the max content luminance passed to the shader by generateShaderSkSLUniforms().
+    static constexpr double kMaxInLumi = 4000;
+
+    // Constants of the tonemapping curve that only depend on the metadata.
+    struct Curve {
+        explicit Curve(const Metadata& metadata)
+              : maxOutLumi(metadata.displayMaxLuminance),
+                x1(maxOutLumi * 0.65),
+                y1(x1),
+                y2(maxOutLumi * 0.9),
+                y3(maxOutLumi),
+                greyNorm2(OETF_ST2084(x1 + (kMaxInLumi - x1) * 4.0 / 17.0)),
+                greyNorm3(OETF_ST2084(kMaxInLumi)),
+                slope2((y2 - y1) / (greyNorm2 - OETF_ST2084(x1))),
+                slope3((y3 - y2) / (greyNorm3 - greyNorm2)),
+                hlgGamma(computeHlgGamma(metadata.currentDisplayLuminance)) {}
+
+        double maxOutLumi;
+        double x1;
+        double y1;
+        double y2;
+        double y3;
+        double greyNorm2;
+        double greyNorm3;
+        double slope2;
+        double slope3;
+        double hlgGamma;
+    };
+
+    // Maps the largest component of a color from the source transfer to the destination transfer.
+    static double toneMapTargetNits(int32_t sourceTransfer, int32_t destinationTransfer,
+                                    const Curve& curve, double maxRGB) {
+        double targetNits = 0.0;
+        switch (sourceTransfer) {
+            case kTransferST2084:
+                switch (destinationTransfer) {
+                    case kTransferST2084:
+                        targetNits = maxRGB;
+                        break;
+                    case kTransferHLG:
+                        // PQ has a wider luminance range (10,000 nits vs. 1,000 nits) than HLG,
+                        // so we'll clamp the luminance range in case we're mapping from PQ
+                        // input to HLG output.
+                        targetNits = std::clamp(maxRGB, 0.0, 1000.0);
+                        targetNits *= pow(targetNits / 1000.0, (1 - curve.hlgGamma) / (curve.hlgGamma));
+                        break;
+                    default:
+                        targetNits = maxRGB;
+                        if (targetNits < curve.x1) {
                             break;
-                        default:
-                            targetNits = maxRGB;
-                            if (targetNits < x1) {
-                                break;
-                            }
-
-                            if (targetNits > maxInLumi) {
-                                targetNits = maxOutLumi;
-                                break;
-                            }
-
-                            const double greyNits = OETF_ST2084(targetNits);
+                        }
 
-                            if (greyNits <= greyNorm2) {
-                                targetNits = (greyNits - greyNorm2) * slope2 + y2;
-                            } else if (greyNits <= greyNorm3) {
-                                targetNits = (greyNits - greyNorm3) * slope3 + y3;
-                            } else {
-                                targetNits = maxOutLumi;
-                            }
-                            break;
-                    }
-                    break;
-                case kTransferHLG:
-                    switch (destinationDataspaceInt & kTransferMask) {
-                        case kTransferST2084:
-                            targetNits = maxRGB * pow(maxRGB / 1000.0, hlgGamma - 1);
-                            break;
-                        case kTransferHLG:
-                            targetNits = maxRGB;
+                        if (targetNits > kMaxInLumi) {
+                            targetNits = curve.maxOutLumi;
                             break;
-                        default:
-                            targetNits = maxRGB * pow(maxRGB / 1000.0, hlgGamma - 1) *
-                                    metadata.displayMaxLuminance / 1000.0;
-                            break;
-                    }
-                    break;
-                default:
-                    targetNits = maxRGB;
-                    break;
-            }
+                        }
+
+                        const double greyNits = OETF_ST2084(targetNits);
 
-            gains.push_back(targetNits / maxRGB);
+                        if (greyNits <= curve.greyNorm2) {
+                            targetNits = (greyNits - curve.greyNorm2) * curve.slope2 + curve.y2;
+                        } else if (greyNits <= curve.greyNorm3) {
+                            targetNits = (greyNits - curve.greyNorm3) * curve.slope3 + curve.y3;
+                        } else {
+                            targetNits = curve.maxOutLumi;
+                        }
+                        break;
+                }
+                break;
+            case kTransferHLG:
+                switch (destinationTransfer) {
+                    case kTransferST2084:
+                        targetNits = maxRGB * pow(maxRGB / 1000.0, curve.hlgGamma - 1);
+                        break;
+                    case kTransferHLG:
+                        targetNits = maxRGB;
+                        break;
+                    default:
+                        targetNits = maxRGB * pow(maxRGB / 1000.0, curve.hlgGamma - 1) *
+                                curve.maxOutLumi / 1000.0;
+                        break;
+                }
+                break;
+            default:
+                targetNits = maxRGB;
+                break;
         }
-        return gains;
+
+        return targetNits;
     }
+
+    LutCache mLutCache;
 };
 
 } // namespace
 
+ToneMapLut::ToneMapLut(Input input, std::function<double(double nits)> gainFn)
+      : mInput(input), mGainFn(std::move(gainFn)) {
+    constexpr int kOctaves = kMaxExponent - kMinExponent;
+    mGains.reserve(kOctaves * kSamplesPerOctave + 1);
+
+    for (int octave = 0; octave < kOctaves; octave++) {
+        const double base = std::ldexp(1.0, kMinExponent - 1 + octave);
+        for (int sample = 0; sample < kSamplesPerOctave; sample++) {
+            mGains.push_back(static_cast<float>(
+                    mGainFn(base + base * sample / kSamplesPerOctave)));
+        }
+    }
+    mGains.push_back(static_cast<float>(mGainFn(std::ldexp(1.0, kMaxExponent))));
+}
+
+double ToneMapLut::lookupTonemapGain(double nits) const {
+    if (nits <= 0.0) {
+        return 1.0;
+    }
+
+    // nits = fraction * 2^exponent, where fraction is within [0.5, 1).
+    int exponent;
+    const double fraction = std::frexp(nits, &exponent);
+    if (!std::isfinite(nits) || exponent < kMinExponent || exponent >= kMaxExponent) {
+        return mGainFn(nits);
+    }
+
+    // Samples are evenly spaced within each octave, so the position within the octave is linear.
+    const double position = (exponent - kMinExponent) * kSamplesPerOctave +
+            (fraction * 2.0 - 1.0) * kSamplesPerOctave;
+    const size_t index = static_cast<size_t>(position);
+    const double t = position - index;
+    return mGains[index] + (mGains[index + 1] - mGains[index]) * t;
+}
+
+double ToneMapLut::lookupTonemapGain(const Color& color) const {
+    return lookupTonemapGain(mInput == Input::Luminance
+                                     ? color.xyz.y
+                                     : std::max({color.linearRGB.r, color.linearRGB.g,
+                                                 color.linearRGB.b}));
+}
+
+std::vector<double> ToneMapLut::lookupTonemapGain(const std::vector<Color>& colors) const {
+    std::vector<double> gains;
+    gains.reserve(colors.size());
+
+    for (const auto& color : colors) {
+        gains.push_back(lookupTonemapGain(color));
+    }
+    return gains;
+}
+
 ToneMapper* getToneMapper() {
     static std::once_flag sOnce;
     static std::unique_ptr<ToneMapper> sToneMapper;
@@ -27,6 +27,11 @@ void registerWithPerfetto(bool test = false);
 
 Result traceBegin(uint64_t category, const char* name);
 
+// Like traceBegin, with a printf-style name. The name is only formatted when the
+// category is enabled, so a disabled trace point costs a category check.
+Result traceFormatBegin(uint64_t category, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
 Result traceEnd(uint64_t category);
 
 Result traceAsyncBegin(uint64_t category, const char* name, int32_t cookie);
@@ -41,6 +46,11 @@ Result traceAsyncEndForTrack(uint64_t category, const char* trackName,
 
 Result traceInstant(uint64_t category, const char* name);
 
+// Like traceInstant, with a printf-style name that is only formatted when the
+// category is enabled.
+Result traceFormatInstant(uint64_t category, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
 Result traceInstantForTrack(uint64_t category, const char* trackName,
                             const char* name);
 
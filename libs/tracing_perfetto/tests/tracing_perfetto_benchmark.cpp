@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "trace_categories.h"
+#include "tracing_perfetto.h"
+
+namespace tracing_perfetto {
+namespace {
+
+// No tracing session is started, so these measure the cost of a trace point
+// whose category is disabled.
+
+void BM_isTagEnabled(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(isTagEnabled(TRACE_CATEGORY_GRAPHICS));
+  }
+}
+BENCHMARK(BM_isTagEnabled);
+
+void BM_traceBeginEnd(benchmark::State& state) {
+  for (auto _ : state) {
+    traceBegin(TRACE_CATEGORY_GRAPHICS, "slice");
+    traceEnd(TRACE_CATEGORY_GRAPHICS);
+  }
+}
+BENCHMARK(BM_traceBeginEnd);
+
+void BM_traceFormatBeginEnd(benchmark::State& state) {
+  int frame = 0;
+  for (auto _ : state) {
+    traceFormatBegin(TRACE_CATEGORY_GRAPHICS, "frame %d of %s", frame++,
+                     "display");
+    traceEnd(TRACE_CATEGORY_GRAPHICS);
+  }
+}
+BENCHMARK(BM_traceFormatBeginEnd);
+
+void BM_traceCounter(benchmark::State& state) {
+  int64_t value = 0;
+  for (auto _ : state) {
+    traceCounter(TRACE_CATEGORY_GRAPHICS, "counter", value++);
+  }
+}
+BENCHMARK(BM_traceCounter);
+
+}  // namespace
+}  // namespace tracing_perfetto
+
+int main(int argc, char** argv) {
+  tracing_perfetto::registerWithPerfetto(true /* test */);
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
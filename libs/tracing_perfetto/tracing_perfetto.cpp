@@ -17,6 +17,8 @@
 #include "tracing_perfetto.h"
 
 #include <cutils/trace.h>
+#include <stdarg.h>
+#include <stdio.h>
 
 #include "perfetto/public/te_category_macros.h"
 #include "trace_categories.h"
@@ -24,6 +26,13 @@
 
 namespace tracing_perfetto {
 
+namespace {
+
+// Longer names are truncated.
+constexpr size_t kMaxFormattedNameLength = 256;
+
+}  // namespace
+
 void registerWithPerfetto(bool test) {
   internal::registerWithPerfetto(test);
 }
@@ -39,6 +48,18 @@ Result traceBegin(uint64_t category, const char* name) {
   }
 }
 
+Result traceFormatBegin(uint64_t category, const char* format, ...) {
+  if (!isTagEnabled(category)) {
+    return Result::SUCCESS;
+  }
+  char name[kMaxFormattedNameLength];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(name, sizeof(name), format, args);
+  va_end(args);
+  return traceBegin(category, name);
+}
+
 Result traceEnd(uint64_t category) {
   struct PerfettoTeCategory* perfettoTeCategory =
       internal::toPerfettoCategory(category);
@@ -107,6 +128,18 @@ Result traceInstant(uint64_t category, const char* name) {
   }
 }
 
+Result traceFormatInstant(uint64_t category, const char* format, ...) {
+  if (!isTagEnabled(category)) {
+    return Result::SUCCESS;
+  }
+  char name[kMaxFormattedNameLength];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(name, sizeof(name), format, args);
+  va_end(args);
+  return traceInstant(category, name);
+}
+
 Result traceInstantForTrack(uint64_t category, const char* trackName,
                             const char* name) {
   struct PerfettoTeCategory* perfettoTeCategory =
@@ -70,73 +70,35 @@ PERFETTO_TE_CATEGORIES_DECLARE(FRAMEWORK_CATEGORIES);
 
 PERFETTO_TE_CATEGORIES_DEFINE(FRAMEWORK_CATEGORIES);
 
+// Indexed by the bit of the category, see trace_categories.h, which lists the
+// categories in the same order as FRAMEWORK_CATEGORIES. Categories are single
+// bits, so looking one up is a count of trailing zeros rather than a chain of
+// comparisons.
+#define CATEGORY_POINTER(name, ...) &name,
+struct PerfettoTeCategory* const kCategories[] = {
+    FRAMEWORK_CATEGORIES(CATEGORY_POINTER)};
+#undef CATEGORY_POINTER
+
+static_assert(sizeof(kCategories) / sizeof(kCategories[0]) ==
+              __builtin_ctzll(TRACE_CATEGORY_THERMAL) + 1);
+
 struct PerfettoTeCategory* toCategory(uint64_t inCategory) {
-  switch (inCategory) {
-    case TRACE_CATEGORY_ALWAYS:
-      return &always;
-    case TRACE_CATEGORY_GRAPHICS:
-      return &graphics;
-    case TRACE_CATEGORY_INPUT:
-      return &input;
-    case TRACE_CATEGORY_VIEW:
-      return &view;
-    case TRACE_CATEGORY_WEBVIEW:
-      return &webview;
-    case TRACE_CATEGORY_WINDOW_MANAGER:
-      return &windowmanager;
-    case TRACE_CATEGORY_ACTIVITY_MANAGER:
-      return &activitymanager;
-    case TRACE_CATEGORY_SYNC_MANAGER:
-      return &syncmanager;
-    case TRACE_CATEGORY_AUDIO:
-      return &audio;
-    case TRACE_CATEGORY_VIDEO:
-      return &video;
-    case TRACE_CATEGORY_CAMERA:
-      return &camera;
-    case TRACE_CATEGORY_HAL:
-      return &hal;
-    case TRACE_CATEGORY_APP:
-      return &app;
-    case TRACE_CATEGORY_RESOURCES:
-      return &resources;
-    case TRACE_CATEGORY_DALVIK:
-      return &dalvik;
-    case TRACE_CATEGORY_RS:
-      return &rs;
-    case TRACE_CATEGORY_BIONIC:
-      return &bionic;
-    case TRACE_CATEGORY_POWER:
-      return &power;
-    case TRACE_CATEGORY_PACKAGE_MANAGER:
-      return &packagemanager;
-    case TRACE_CATEGORY_SYSTEM_SERVER:
-      return &systemserver;
-    case TRACE_CATEGORY_DATABASE:
-      return &database;
-    case TRACE_CATEGORY_NETWORK:
-      return &network;
-    case TRACE_CATEGORY_ADB:
-      return &adb;
-    case TRACE_CATEGORY_VIBRATOR:
-      return &vibrator;
-    case TRACE_CATEGORY_AIDL:
-      return &aidl;
-    case TRACE_CATEGORY_NNAPI:
-      return &nnapi;
-    case TRACE_CATEGORY_RRO:
-      return &rro;
-    case TRACE_CATEGORY_THERMAL:
-      return &thermal;
-    default:
-      return nullptr;
+  if (inCategory == 0 || (inCategory & (inCategory - 1)) != 0) {
+    return nullptr;
+  }
+  const size_t index = __builtin_ctzll(inCategory);
+  if (index >= sizeof(kCategories) / sizeof(kCategories[0])) {
+    return nullptr;
   }
+  return kCategories[index];
 }
 
 }  // namespace
 
 bool isPerfettoSdkTracingEnabled() {
-  return android::os::perfetto_sdk_tracing();
+  // The flag is read-only, so it is read once rather than on every trace point.
+  static const bool enabled = android::os::perfetto_sdk_tracing();
+  return enabled;
 }
 
 struct PerfettoTeCategory* toPerfettoCategory(uint64_t category) {
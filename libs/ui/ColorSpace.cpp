@@ -16,6 +16,8 @@
 
 #include <ui/ColorSpace.h>
 
+#include <algorithm>
+
 using namespace std::placeholders;
 
 namespace android {
@@ -106,9 +108,11 @@ ColorSpace::ColorSpace(
         : mName(name)
         , mRGBtoXYZ(rgbToXYZ)
         , mXYZtoRGB(inverse(rgbToXYZ))
+        , mTransferType(getTransferType(OETF, EOTF))
+        , mSaturates(!clamper)
         , mOETF(std::move(OETF))
         , mEOTF(std::move(EOTF))
-        , mClamper(std::move(clamper))
+        , mClamper(clamper ? std::move(clamper) : saturate<float>)
         , mPrimaries(computePrimaries(rgbToXYZ))
         , mWhitePoint(computeWhitePoint(rgbToXYZ)) {
 }
@@ -122,9 +126,11 @@ ColorSpace::ColorSpace(
         , mRGBtoXYZ(rgbToXYZ)
         , mXYZtoRGB(inverse(rgbToXYZ))
         , mParameters(parameters)
+        , mTransferType(getTransferType(mParameters))
+        , mSaturates(!clamper)
         , mOETF(toOETF(mParameters))
         , mEOTF(toEOTF(mParameters))
-        , mClamper(std::move(clamper))
+        , mClamper(clamper ? std::move(clamper) : saturate<float>)
         , mPrimaries(computePrimaries(rgbToXYZ))
         , mWhitePoint(computeWhitePoint(rgbToXYZ)) {
 }
@@ -138,9 +144,11 @@ ColorSpace::ColorSpace(
         , mRGBtoXYZ(rgbToXYZ)
         , mXYZtoRGB(inverse(rgbToXYZ))
         , mParameters({gamma, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f})
+        , mTransferType(gamma == 1.0f ? TransferType::Linear : TransferType::Gamma)
+        , mSaturates(!clamper)
         , mOETF(toOETF(gamma))
         , mEOTF(toEOTF(gamma))
-        , mClamper(std::move(clamper))
+        , mClamper(clamper ? std::move(clamper) : saturate<float>)
         , mPrimaries(computePrimaries(rgbToXYZ))
         , mWhitePoint(computeWhitePoint(rgbToXYZ)) {
 }
@@ -155,9 +163,11 @@ ColorSpace::ColorSpace(
         : mName(name)
         , mRGBtoXYZ(computeXYZMatrix(primaries, whitePoint))
         , mXYZtoRGB(inverse(mRGBtoXYZ))
+        , mTransferType(getTransferType(OETF, EOTF))
+        , mSaturates(!clamper)
         , mOETF(std::move(OETF))
         , mEOTF(std::move(EOTF))
-        , mClamper(std::move(clamper))
+        , mClamper(clamper ? std::move(clamper) : saturate<float>)
         , mPrimaries(primaries)
         , mWhitePoint(whitePoint) {
 }
@@ -172,9 +182,11 @@ ColorSpace::ColorSpace(
         , mRGBtoXYZ(computeXYZMatrix(primaries, whitePoint))
         , mXYZtoRGB(inverse(mRGBtoXYZ))
         , mParameters(parameters)
+        , mTransferType(getTransferType(mParameters))
+        , mSaturates(!clamper)
         , mOETF(toOETF(mParameters))
         , mEOTF(toEOTF(mParameters))
-        , mClamper(std::move(clamper))
+        , mClamper(clamper ? std::move(clamper) : saturate<float>)
         , mPrimaries(primaries)
         , mWhitePoint(whitePoint) {
 }
@@ -189,13 +201,94 @@ ColorSpace::ColorSpace(
         , mRGBtoXYZ(computeXYZMatrix(primaries, whitePoint))
         , mXYZtoRGB(inverse(mRGBtoXYZ))
         , mParameters({gamma, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f})
+        , mTransferType(gamma == 1.0f ? TransferType::Linear : TransferType::Gamma)
+        , mSaturates(!clamper)
         , mOETF(toOETF(gamma))
         , mEOTF(toEOTF(gamma))
-        , mClamper(std::move(clamper))
+        , mClamper(clamper ? std::move(clamper) : saturate<float>)
         , mPrimaries(primaries)
         , mWhitePoint(whitePoint) {
 }
 
+ColorSpace::TransferType ColorSpace::getTransferType(const transfer_function& OETF,
+                                                     const transfer_function& EOTF) noexcept {
+    const auto isLinear = [](const transfer_function& f) {
+        const auto* function = f.target<float (*)(float)>();
+        return function && *function == &ColorSpace::linearResponse;
+    };
+    return isLinear(OETF) && isLinear(EOTF) ? TransferType::Linear : TransferType::Custom;
+}
+
+ColorSpace::TransferType ColorSpace::getTransferType(
+        const TransferParameters& parameters) noexcept {
+    if (parameters.e == 0.0f && parameters.f == 0.0f) {
+        return TransferType::Parametric;
+    }
+    return TransferType::ParametricFull;
+}
+
+template <typename F>
+static void applyToChannels(float3* values, size_t count, const F& f) {
+    for (size_t i = 0; i < count; i++) {
+        float3& v = values[i];
+        v.r = f(v.r);
+        v.g = f(v.g);
+        v.b = f(v.b);
+    }
+}
+
+void ColorSpace::fromLinear(float3* values, size_t count) const noexcept {
+    const TransferParameters& p = mParameters;
+    switch (mTransferType) {
+        case TransferType::Linear:
+            break;
+        case TransferType::Gamma:
+            applyToChannels(values, count, [e = 1.0f / p.g](float x) { return safePow(x, e); });
+            break;
+        case TransferType::Parametric:
+            applyToChannels(values, count, [&p](float x) { return rcpResponse(x, p); });
+            break;
+        case TransferType::ParametricFull:
+            applyToChannels(values, count, [&p](float x) { return rcpFullResponse(x, p); });
+            break;
+        case TransferType::Custom:
+            applyToChannels(values, count, mOETF);
+            break;
+    }
+}
+
+void ColorSpace::toLinear(float3* values, size_t count) const noexcept {
+    const TransferParameters& p = mParameters;
+    switch (mTransferType) {
+        case TransferType::Linear:
+            break;
+        case TransferType::Gamma:
+            applyToChannels(values, count, [e = p.g](float x) { return safePow(x, e); });
+            break;
+        case TransferType::Parametric:
+            applyToChannels(values, count, [&p](float x) { return response(x, p); });
+            break;
+        case TransferType::ParametricFull:
+            applyToChannels(values, count, [&p](float x) { return fullResponse(x, p); });
+            break;
+        case TransferType::Custom:
+            applyToChannels(values, count, mEOTF);
+            break;
+    }
+}
+
+void ColorSpace::clampValues(const float3* src, float3* dst, size_t count) const noexcept {
+    if (mSaturates) {
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = saturate(src[i]);
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = apply(src[i], mClamper);
+        }
+    }
+}
+
 constexpr mat3 ColorSpace::computeXYZMatrix(
         const std::array<float2, 3>& primaries, const float2& whitePoint) {
     const float2& R = primaries[0];
@@ -364,12 +457,14 @@ std::unique_ptr<float3[]> ColorSpace::createLUT(uint32_t size, const ColorSpace&
     for (uint32_t z = 0; z < size; z++) {
         for (int32_t y = int32_t(size - 1); y >= 0; y--) {
             for (uint32_t x = 0; x < size; x++) {
-                *data++ = connector.transform({
+                data[x] = {
                     static_cast<float>(x) * m,
                     static_cast<float>(y) * m,
                     static_cast<float>(z) * m,
-                });
+                };
             }
+            connector.transform(data, data, size);
+            data += size;
         }
     }
 
@@ -417,4 +512,22 @@ ColorSpaceConnector::ColorSpaceConnector(
     }
 }
 
+void ColorSpaceConnector::transform(const float3* src, float3* dst, size_t count) const noexcept {
+    // Small enough for each block to stay in the L1 cache across all of the steps.
+    constexpr size_t kBlockSize = 256;
+
+    for (size_t start = 0; start < count; start += kBlockSize) {
+        const size_t n = std::min(kBlockSize, count - start);
+        float3* block = dst + start;
+
+        mSource.clampValues(src + start, block, n);
+        mSource.toLinear(block, n);
+        for (size_t i = 0; i < n; i++) {
+            block[i] = mTransform * block[i];
+        }
+        mDestination.fromLinear(block, n);
+        mDestination.clampValues(block, block, n);
+    }
+}
+
 }; // namespace android
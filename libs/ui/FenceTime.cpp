@@ -20,10 +20,17 @@
 
 #include <cutils/compiler.h>  // For CC_[UN]LIKELY
 #include <utils/Log.h>
+#include <fcntl.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
 
+#include <array>
 #include <memory>
+#include <thread>
 
 namespace android {
 
@@ -122,7 +129,14 @@ status_t FenceTime::wait(int timeout) {
     }
 
     // Make the system call without the lock held.
-    return fence->wait(timeout);
+    const status_t status = fence->wait(timeout);
+
+    // Don't leave getSignalTime() reporting a pending fence that the caller
+    // just saw signal while FenceTimeResolver catches up.
+    if (status == NO_ERROR && mResolverPending.load(std::memory_order_acquire)) {
+        pollSignalTime();
+    }
+    return status;
 }
 
 nsecs_t FenceTime::getSignalTime() {
@@ -132,6 +146,15 @@ nsecs_t FenceTime::getSignalTime() {
         return signalTime;
     }
 
+    // FenceTimeResolver will store the signal time when the fence signals.
+    if (mResolverPending.load(std::memory_order_acquire)) {
+        return Fence::SIGNAL_TIME_PENDING;
+    }
+
+    return pollSignalTime();
+}
+
+nsecs_t FenceTime::pollSignalTime() {
     // Hold a reference to the fence on the stack in case the class'
     // reference is removed by another thread. This prevents the
     // fence from being destroyed until the end of this method, where
@@ -150,7 +173,7 @@ nsecs_t FenceTime::getSignalTime() {
     }
 
     // Make the system call without the lock held.
-    signalTime = fence->getSignalTime();
+    nsecs_t signalTime = fence->getSignalTime();
 
     // Allow tests to override SIGNAL_TIME_INVALID behavior, since tests
     // use invalid underlying Fences without real file descriptors.
@@ -327,6 +350,113 @@ void FenceTimeline::updateSignalTimes() {
     }
 }
 
+// ============================================================================
+// FenceTimeResolver
+// ============================================================================
+FenceTimeResolver& FenceTimeResolver::getInstance() {
+    // Never destroyed, since the resolver thread runs until the process exits.
+    static FenceTimeResolver* const sInstance = new FenceTimeResolver();
+    return *sInstance;
+}
+
+FenceTimeResolver::FenceTimeResolver() : mEpollFd(epoll_create1(EPOLL_CLOEXEC)) {
+    if (mEpollFd < 0) {
+        ALOGE("FenceTimeResolver: epoll_create1 failed: %s", strerror(errno));
+        mAbandoned = true;
+        return;
+    }
+    std::thread([this] { threadMain(); }).detach();
+}
+
+bool FenceTimeResolver::watch(const std::shared_ptr<FenceTime>& fenceTime) {
+    if (!fenceTime || fenceTime->mState != FenceTime::State::VALID) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mAbandoned || mPending.size() >= MAX_PENDING) {
+        return false;
+    }
+
+    int fd;
+    {
+        std::lock_guard<std::mutex> fenceLock(fenceTime->mMutex);
+        if (!fenceTime->mFence.get() ||
+            fenceTime->mResolverPending.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        fd = fcntl(fenceTime->mFence->get(), F_DUPFD_CLOEXEC, 0);
+    }
+    if (fd < 0) {
+        return false;
+    }
+
+    const uint64_t token = mNextToken++;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = token;
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        ALOGE("FenceTimeResolver: epoll_ctl failed: %s", strerror(errno));
+        close(fd);
+        return false;
+    }
+    fenceTime->mResolverPending.store(true, std::memory_order_release);
+    mPending.emplace(token, Entry{fenceTime, fd});
+    return true;
+}
+
+void FenceTimeResolver::threadMain() {
+    pthread_setname_np(pthread_self(), "FenceTimeResolv");
+
+    std::array<epoll_event, 16> events;
+    while (true) {
+        const int count = epoll_wait(mEpollFd, events.data(), events.size(), -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ALOGE("FenceTimeResolver: epoll_wait failed: %s", strerror(errno));
+            std::lock_guard<std::mutex> lock(mMutex);
+            abandonAllLocked();
+            return;
+        }
+
+        for (int i = 0; i < count; i++) {
+            Entry entry;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                auto it = mPending.find(events[i].data.u64);
+                if (it == mPending.end()) {
+                    continue;
+                }
+                entry = std::move(it->second);
+                mPending.erase(it);
+            }
+            epoll_ctl(mEpollFd, EPOLL_CTL_DEL, entry.fd, nullptr);
+            close(entry.fd);
+
+            if (std::shared_ptr<FenceTime> fenceTime = entry.fence.lock()) {
+                // The fence has signaled (or errored), so this is the one and
+                // only query needed to latch its signal time.
+                fenceTime->pollSignalTime();
+                fenceTime->mResolverPending.store(false, std::memory_order_release);
+            }
+        }
+    }
+}
+
+void FenceTimeResolver::abandonAllLocked() {
+    // Hand every watched FenceTime back to polling its own fence.
+    for (auto& [token, entry] : mPending) {
+        if (std::shared_ptr<FenceTime> fenceTime = entry.fence.lock()) {
+            fenceTime->mResolverPending.store(false, std::memory_order_release);
+        }
+        close(entry.fd);
+    }
+    mPending.clear();
+    mAbandoned = true;
+}
+
 // ============================================================================
 // FenceToFenceTimeMap
 // ============================================================================
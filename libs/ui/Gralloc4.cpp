@@ -435,6 +435,17 @@ int Gralloc4Mapper::unlock(buffer_handle_t bufferHandle) const {
     return releaseFence;
 }
 
+status_t Gralloc4Mapper::rereadLockedBuffer(buffer_handle_t bufferHandle) const {
+    auto buffer = const_cast<native_handle_t*>(bufferHandle);
+    auto ret = mMapper->rereadLockedBuffer(buffer);
+
+    const Error error = ret.isOk() ? static_cast<Error>(ret) : kTransactionError;
+    if (error != Error::NONE) {
+        ALOGE("rereadLockedBuffer(%p) failed with %d", buffer, error);
+    }
+    return static_cast<status_t>(error);
+}
+
 status_t Gralloc4Mapper::isSupported(uint32_t width, uint32_t height, PixelFormat format,
                                      uint32_t layerCount, uint64_t usage,
                                      bool* outSupported) const {
@@ -1042,6 +1053,25 @@ status_t Gralloc4Allocator::allocate(std::string requestorName, uint32_t width,
                                      android::PixelFormat format, uint32_t layerCount,
                                      uint64_t usage, uint32_t* outStride,
                                      buffer_handle_t* outBufferHandles, bool importBuffers) const {
+    return allocateBuffers(requestorName, width, height, format, layerCount, usage, 1, outStride,
+                           outBufferHandles, importBuffers);
+}
+
+status_t Gralloc4Allocator::allocateBatch(std::string requestorName, uint32_t width,
+                                          uint32_t height, android::PixelFormat format,
+                                          uint32_t layerCount, uint64_t usage,
+                                          uint32_t bufferCount, uint32_t* outStride,
+                                          buffer_handle_t* outBufferHandles) const {
+    return allocateBuffers(requestorName, width, height, format, layerCount, usage, bufferCount,
+                           outStride, outBufferHandles, true);
+}
+
+status_t Gralloc4Allocator::allocateBuffers(std::string requestorName, uint32_t width,
+                                            uint32_t height, android::PixelFormat format,
+                                            uint32_t layerCount, uint64_t usage,
+                                            uint32_t bufferCount, uint32_t* outStride,
+                                            buffer_handle_t* outBufferHandles,
+                                            bool importBuffers) const {
     IMapper::BufferDescriptorInfo descriptorInfo;
     if (auto error = sBufferDescriptorInfo(requestorName, width, height, format, layerCount, usage,
                                            &descriptorInfo) != OK) {
@@ -1055,8 +1085,6 @@ status_t Gralloc4Allocator::allocate(std::string requestorName, uint32_t width,
         return error;
     }
 
-    constexpr auto bufferCount = 1;
-
     if (mAidlAllocator) {
         AllocationResult result;
 #pragma clang diagnostic push
@@ -29,6 +29,9 @@
 #include <ui/FatVector.h>
 #include <vndksupport/linker.h>
 
+#include <mutex>
+#include <unordered_map>
+
 using namespace aidl::android::hardware::graphics::allocator;
 using namespace aidl::android::hardware::graphics::common;
 using namespace ::android::hardware::graphics::mapper;
@@ -156,6 +159,62 @@ static auto getStandardMetadata(AIMapper *mapper, buffer_handle_t bufferHandle)
     return Value::decode(buffer.data(), sizeRequired);
 }
 
+template <StandardMetadataType T>
+using StandardMetadataValue = decltype(StandardMetadata<T>::value::decode(nullptr, 0));
+
+// Metadata that gralloc fixes when the buffer is allocated, decoded once per imported handle.
+// SurfaceFlinger and the codecs query plane layouts, usage and friends per buffer per frame, and
+// each query otherwise re-encodes and re-decodes them through AIMapper. Entries are dropped in
+// freeBuffer(). Mutable metadata (dataspace, HDR blobs) is never cached: it can be set by another
+// process sharing the buffer, so no local setter could invalidate it reliably.
+struct Gralloc5MetadataCache {
+    struct Entry {
+        StandardMetadataValue<StandardMetadataType::BUFFER_ID> bufferId;
+        StandardMetadataValue<StandardMetadataType::WIDTH> width;
+        StandardMetadataValue<StandardMetadataType::HEIGHT> height;
+        StandardMetadataValue<StandardMetadataType::LAYER_COUNT> layerCount;
+        StandardMetadataValue<StandardMetadataType::PIXEL_FORMAT_REQUESTED> pixelFormatRequested;
+        StandardMetadataValue<StandardMetadataType::PIXEL_FORMAT_FOURCC> pixelFormatFourCC;
+        StandardMetadataValue<StandardMetadataType::PIXEL_FORMAT_MODIFIER> pixelFormatModifier;
+        StandardMetadataValue<StandardMetadataType::USAGE> usage;
+        StandardMetadataValue<StandardMetadataType::ALLOCATION_SIZE> allocationSize;
+        StandardMetadataValue<StandardMetadataType::PROTECTED_CONTENT> protectedContent;
+        StandardMetadataValue<StandardMetadataType::COMPRESSION> compression;
+        StandardMetadataValue<StandardMetadataType::INTERLACED> interlaced;
+        StandardMetadataValue<StandardMetadataType::CHROMA_SITING> chromaSiting;
+        StandardMetadataValue<StandardMetadataType::PLANE_LAYOUTS> planeLayouts;
+        StandardMetadataValue<StandardMetadataType::STRIDE> stride;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<buffer_handle_t, Entry> entries;
+
+    void erase(buffer_handle_t bufferHandle) {
+        std::lock_guard lock(mutex);
+        entries.erase(bufferHandle);
+    }
+};
+
+template <StandardMetadataType T>
+static StandardMetadataValue<T> getCachedStandardMetadata(
+        AIMapper *mapper, Gralloc5MetadataCache &cache, buffer_handle_t bufferHandle,
+        StandardMetadataValue<T> Gralloc5MetadataCache::Entry::*field) {
+    {
+        std::lock_guard lock(cache.mutex);
+        auto it = cache.entries.find(bufferHandle);
+        if (it != cache.entries.end() && (it->second.*field).has_value()) {
+            return it->second.*field;
+        }
+    }
+    // Query outside the lock; a racing reader decoding the same value is harmless.
+    auto value = getStandardMetadata<T>(mapper, bufferHandle);
+    if (value.has_value()) {
+        std::lock_guard lock(cache.mutex);
+        cache.entries[bufferHandle].*field = value;
+    }
+    return value;
+}
+
 template <StandardMetadataType T>
 static AIMapper_Error setStandardMetadata(AIMapper *mapper, buffer_handle_t bufferHandle,
                                           const typename StandardMetadata<T>::value_type &value) {
@@ -218,6 +277,24 @@ static std::optional<BufferDescriptorInfo> makeDescriptor(std::string requestorN
     return descriptorInfo;
 }
 
+static status_t allocationStatusToError(const ndk::ScopedAStatus& status) {
+    auto error = status.getExceptionCode();
+    if (error == EX_SERVICE_SPECIFIC) {
+        switch (static_cast<AllocationError>(status.getServiceSpecificError())) {
+            case AllocationError::BAD_DESCRIPTOR:
+                error = BAD_VALUE;
+                break;
+            case AllocationError::NO_RESOURCES:
+                error = NO_MEMORY;
+                break;
+            default:
+                error = UNKNOWN_ERROR;
+                break;
+        }
+    }
+    return error;
+}
+
 std::string Gralloc5Allocator::dumpDebugInfo(bool less) const {
     return mMapper.dumpBuffers(less);
 }
@@ -241,6 +318,48 @@ status_t Gralloc5Allocator::allocate(std::string requestorName, uint32_t width,
     return result.status;
 }
 
+status_t Gralloc5Allocator::allocateBatch(std::string requestorName, uint32_t width,
+                                          uint32_t height, android::PixelFormat format,
+                                          uint32_t layerCount, uint64_t usage,
+                                          uint32_t bufferCount, uint32_t* outStride,
+                                          buffer_handle_t* outBufferHandles) const {
+    auto descriptorInfo =
+            makeDescriptor(requestorName, width, height, format, layerCount, usage);
+    if (!descriptorInfo) {
+        return BAD_VALUE;
+    }
+
+    AllocationResult result;
+    auto status = mAllocator->allocate2(*descriptorInfo, static_cast<int32_t>(bufferCount),
+                                        &result);
+    if (!status.isOk()) {
+        return allocationStatusToError(status);
+    }
+    if (result.buffers.size() != bufferCount) {
+        ALOGE("allocator returned %zu buffers, expected %u", result.buffers.size(), bufferCount);
+        return UNKNOWN_ERROR;
+    }
+
+    for (uint32_t i = 0; i < bufferCount; i++) {
+        auto handle = makeFromAidl(result.buffers[i]);
+        auto error = mMapper.importBuffer(handle, &outBufferHandles[i]);
+        native_handle_delete(handle);
+        if (error != NO_ERROR) {
+            for (uint32_t j = 0; j < i; j++) {
+                mMapper.freeBuffer(outBufferHandles[j]);
+                outBufferHandles[j] = nullptr;
+            }
+            return error;
+        }
+    }
+
+    *outStride = result.stride;
+
+    // Release all the resources held by AllocationResult (specifically any remaining FDs)
+    result = {};
+    return OK;
+}
+
 GraphicBufferAllocator::AllocationResult Gralloc5Allocator::allocate(
         const GraphicBufferAllocator::AllocationRequest& request) const {
     auto descriptorInfo = makeDescriptor(request.requestorName, request.width, request.height,
@@ -260,21 +379,7 @@ GraphicBufferAllocator::AllocationResult Gralloc5Allocator::allocate(
     AllocationResult result;
     auto status = mAllocator->allocate2(*descriptorInfo, 1, &result);
     if (!status.isOk()) {
-        auto error = status.getExceptionCode();
-        if (error == EX_SERVICE_SPECIFIC) {
-            switch (static_cast<AllocationError>(status.getServiceSpecificError())) {
-                case AllocationError::BAD_DESCRIPTOR:
-                    error = BAD_VALUE;
-                    break;
-                case AllocationError::NO_RESOURCES:
-                    error = NO_MEMORY;
-                    break;
-                default:
-                    error = UNKNOWN_ERROR;
-                    break;
-            }
-        }
-        return GraphicBufferAllocator::AllocationResult{error};
+        return GraphicBufferAllocator::AllocationResult{allocationStatusToError(status)};
     }
 
     GraphicBufferAllocator::AllocationResult ret{OK};
@@ -310,10 +415,12 @@ void Gralloc5Mapper::preload() {
     // use that here.
 }
 
-Gralloc5Mapper::Gralloc5Mapper() {
+Gralloc5Mapper::Gralloc5Mapper() : mMetadataCache(std::make_unique<Gralloc5MetadataCache>()) {
     mMapper = getInstance().mapper;
 }
 
+Gralloc5Mapper::~Gralloc5Mapper() = default;
+
 bool Gralloc5Mapper::isLoaded() const {
     return mMapper != nullptr && mMapper->version >= AIMAPPER_VERSION_5;
 }
@@ -525,6 +632,8 @@ status_t Gralloc5Mapper::importBuffer(const native_handle_t *rawHandle,
 }
 
 void Gralloc5Mapper::freeBuffer(buffer_handle_t bufferHandle) const {
+    // Drop the entry first: the handle value may be reused by the next import.
+    mMetadataCache->erase(bufferHandle);
     mMapper->v5.freeBuffer(bufferHandle);
 }
 
@@ -533,14 +642,16 @@ status_t Gralloc5Mapper::validateBufferSize(buffer_handle_t bufferHandle, uint32
                                             uint32_t layerCount, uint64_t usage,
                                             uint32_t stride) const {
     {
-        auto value = getStandardMetadata<StandardMetadataType::WIDTH>(mMapper, bufferHandle);
+        auto value = getCachedStandardMetadata<StandardMetadataType::WIDTH>(
+                mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::width);
         if (width != value) {
             ALOGW("Width didn't match, expected %d got %" PRId64, width, value.value_or(-1));
             return BAD_VALUE;
         }
     }
     {
-        auto value = getStandardMetadata<StandardMetadataType::HEIGHT>(mMapper, bufferHandle);
+        auto value = getCachedStandardMetadata<StandardMetadataType::HEIGHT>(
+                mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::height);
         if (height != value) {
             ALOGW("Height didn't match, expected %d got %" PRId64, height, value.value_or(-1));
             return BAD_VALUE;
@@ -549,9 +660,9 @@ status_t Gralloc5Mapper::validateBufferSize(buffer_handle_t bufferHandle, uint32
     {
         auto expected = static_cast<APixelFormat>(format);
         if (expected != APixelFormat::IMPLEMENTATION_DEFINED) {
-            auto value =
-                    getStandardMetadata<StandardMetadataType::PIXEL_FORMAT_REQUESTED>(mMapper,
-                                                                                      bufferHandle);
+            auto value = getCachedStandardMetadata<StandardMetadataType::PIXEL_FORMAT_REQUESTED>(
+                    mMapper, *mMetadataCache, bufferHandle,
+                    &Gralloc5MetadataCache::Entry::pixelFormatRequested);
             if (expected != value) {
                 ALOGW("Format didn't match, expected %d got %s", format,
                       value.has_value() ? toString(*value).c_str() : "<null>");
@@ -560,7 +671,8 @@ status_t Gralloc5Mapper::validateBufferSize(buffer_handle_t bufferHandle, uint32
         }
     }
     {
-        auto value = getStandardMetadata<StandardMetadataType::LAYER_COUNT>(mMapper, bufferHandle);
+        auto value = getCachedStandardMetadata<StandardMetadataType::LAYER_COUNT>(
+                mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::layerCount);
         if (layerCount != value) {
             ALOGW("Layer count didn't match, expected %d got %" PRId64, layerCount,
                   value.value_or(-1));
@@ -579,7 +691,8 @@ status_t Gralloc5Mapper::validateBufferSize(buffer_handle_t bufferHandle, uint32
     //     }
     // }
     {
-        auto value = getStandardMetadata<StandardMetadataType::STRIDE>(mMapper, bufferHandle);
+        auto value = getCachedStandardMetadata<StandardMetadataType::STRIDE>(
+                mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::stride);
         if (stride != value) {
             ALOGW("Stride didn't match, expected %" PRIu32 " got %" PRId32, stride,
                   value.value_or(-1));
@@ -725,6 +838,14 @@ int Gralloc5Mapper::unlock(buffer_handle_t bufferHandle) const {
     return fence;
 }
 
+status_t Gralloc5Mapper::rereadLockedBuffer(buffer_handle_t bufferHandle) const {
+    AIMapper_Error error = mMapper->v5.rereadLockedBuffer(bufferHandle);
+    if (error != AIMAPPER_ERROR_NONE) {
+        ALOGW("rereadLockedBuffer failed with error %d", error);
+    }
+    return static_cast<status_t>(error);
+}
+
 status_t Gralloc5Mapper::isSupported(uint32_t width, uint32_t height, PixelFormat format,
                                      uint32_t layerCount, uint64_t usage,
                                      bool *outSupported) const {
@@ -742,7 +863,8 @@ status_t Gralloc5Mapper::isSupported(uint32_t width, uint32_t height, PixelForma
 }
 
 status_t Gralloc5Mapper::getBufferId(buffer_handle_t bufferHandle, uint64_t *outBufferId) const {
-    auto value = getStandardMetadata<StandardMetadataType::BUFFER_ID>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::BUFFER_ID>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::bufferId);
     if (value.has_value()) {
         *outBufferId = *value;
         return OK;
@@ -760,7 +882,8 @@ status_t Gralloc5Mapper::getName(buffer_handle_t bufferHandle, std::string *outN
 }
 
 status_t Gralloc5Mapper::getWidth(buffer_handle_t bufferHandle, uint64_t *outWidth) const {
-    auto value = getStandardMetadata<StandardMetadataType::WIDTH>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::WIDTH>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::width);
     if (value.has_value()) {
         *outWidth = *value;
         return OK;
@@ -769,7 +892,8 @@ status_t Gralloc5Mapper::getWidth(buffer_handle_t bufferHandle, uint64_t *outWid
 }
 
 status_t Gralloc5Mapper::getHeight(buffer_handle_t bufferHandle, uint64_t *outHeight) const {
-    auto value = getStandardMetadata<StandardMetadataType::HEIGHT>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::HEIGHT>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::height);
     if (value.has_value()) {
         *outHeight = *value;
         return OK;
@@ -779,7 +903,8 @@ status_t Gralloc5Mapper::getHeight(buffer_handle_t bufferHandle, uint64_t *outHe
 
 status_t Gralloc5Mapper::getLayerCount(buffer_handle_t bufferHandle,
                                        uint64_t *outLayerCount) const {
-    auto value = getStandardMetadata<StandardMetadataType::LAYER_COUNT>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::LAYER_COUNT>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::layerCount);
     if (value.has_value()) {
         *outLayerCount = *value;
         return OK;
@@ -789,8 +914,9 @@ status_t Gralloc5Mapper::getLayerCount(buffer_handle_t bufferHandle,
 
 status_t Gralloc5Mapper::getPixelFormatRequested(buffer_handle_t bufferHandle,
                                                  ui::PixelFormat *outPixelFormatRequested) const {
-    auto value = getStandardMetadata<StandardMetadataType::PIXEL_FORMAT_REQUESTED>(mMapper,
-                                                                                   bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::PIXEL_FORMAT_REQUESTED>(
+            mMapper, *mMetadataCache, bufferHandle,
+            &Gralloc5MetadataCache::Entry::pixelFormatRequested);
     if (value.has_value()) {
         *outPixelFormatRequested = static_cast<ui::PixelFormat>(*value);
         return OK;
@@ -800,8 +926,9 @@ status_t Gralloc5Mapper::getPixelFormatRequested(buffer_handle_t bufferHandle,
 
 status_t Gralloc5Mapper::getPixelFormatFourCC(buffer_handle_t bufferHandle,
                                               uint32_t *outPixelFormatFourCC) const {
-    auto value =
-            getStandardMetadata<StandardMetadataType::PIXEL_FORMAT_FOURCC>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::PIXEL_FORMAT_FOURCC>(
+            mMapper, *mMetadataCache, bufferHandle,
+            &Gralloc5MetadataCache::Entry::pixelFormatFourCC);
     if (value.has_value()) {
         *outPixelFormatFourCC = *value;
         return OK;
@@ -811,8 +938,9 @@ status_t Gralloc5Mapper::getPixelFormatFourCC(buffer_handle_t bufferHandle,
 
 status_t Gralloc5Mapper::getPixelFormatModifier(buffer_handle_t bufferHandle,
                                                 uint64_t *outPixelFormatModifier) const {
-    auto value =
-            getStandardMetadata<StandardMetadataType::PIXEL_FORMAT_MODIFIER>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::PIXEL_FORMAT_MODIFIER>(
+            mMapper, *mMetadataCache, bufferHandle,
+            &Gralloc5MetadataCache::Entry::pixelFormatModifier);
     if (value.has_value()) {
         *outPixelFormatModifier = *value;
         return OK;
@@ -821,7 +949,8 @@ status_t Gralloc5Mapper::getPixelFormatModifier(buffer_handle_t bufferHandle,
 }
 
 status_t Gralloc5Mapper::getUsage(buffer_handle_t bufferHandle, uint64_t *outUsage) const {
-    auto value = getStandardMetadata<StandardMetadataType::USAGE>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::USAGE>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::usage);
     if (value.has_value()) {
         *outUsage = static_cast<uint64_t>(*value);
         return OK;
@@ -831,7 +960,8 @@ status_t Gralloc5Mapper::getUsage(buffer_handle_t bufferHandle, uint64_t *outUsa
 
 status_t Gralloc5Mapper::getAllocationSize(buffer_handle_t bufferHandle,
                                            uint64_t *outAllocationSize) const {
-    auto value = getStandardMetadata<StandardMetadataType::ALLOCATION_SIZE>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::ALLOCATION_SIZE>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::allocationSize);
     if (value.has_value()) {
         *outAllocationSize = *value;
         return OK;
@@ -841,8 +971,9 @@ status_t Gralloc5Mapper::getAllocationSize(buffer_handle_t bufferHandle,
 
 status_t Gralloc5Mapper::getProtectedContent(buffer_handle_t bufferHandle,
                                              uint64_t *outProtectedContent) const {
-    auto value =
-            getStandardMetadata<StandardMetadataType::PROTECTED_CONTENT>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::PROTECTED_CONTENT>(
+            mMapper, *mMetadataCache, bufferHandle,
+            &Gralloc5MetadataCache::Entry::protectedContent);
     if (value.has_value()) {
         *outProtectedContent = *value;
         return OK;
@@ -853,7 +984,8 @@ status_t Gralloc5Mapper::getProtectedContent(buffer_handle_t bufferHandle,
 status_t Gralloc5Mapper::getCompression(
         buffer_handle_t bufferHandle,
         aidl::android::hardware::graphics::common::ExtendableType *outCompression) const {
-    auto value = getStandardMetadata<StandardMetadataType::COMPRESSION>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::COMPRESSION>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::compression);
     if (value.has_value()) {
         *outCompression = *value;
         return OK;
@@ -863,7 +995,8 @@ status_t Gralloc5Mapper::getCompression(
 
 status_t Gralloc5Mapper::getCompression(buffer_handle_t bufferHandle,
                                         ui::Compression *outCompression) const {
-    auto value = getStandardMetadata<StandardMetadataType::COMPRESSION>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::COMPRESSION>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::compression);
     if (!value.has_value()) {
         return UNKNOWN_TRANSACTION;
     }
@@ -877,7 +1010,8 @@ status_t Gralloc5Mapper::getCompression(buffer_handle_t bufferHandle,
 status_t Gralloc5Mapper::getInterlaced(
         buffer_handle_t bufferHandle,
         aidl::android::hardware::graphics::common::ExtendableType *outInterlaced) const {
-    auto value = getStandardMetadata<StandardMetadataType::INTERLACED>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::INTERLACED>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::interlaced);
     if (value.has_value()) {
         *outInterlaced = *value;
         return OK;
@@ -905,7 +1039,8 @@ status_t Gralloc5Mapper::getInterlaced(buffer_handle_t bufferHandle,
 status_t Gralloc5Mapper::getChromaSiting(
         buffer_handle_t bufferHandle,
         aidl::android::hardware::graphics::common::ExtendableType *outChromaSiting) const {
-    auto value = getStandardMetadata<StandardMetadataType::CHROMA_SITING>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::CHROMA_SITING>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::chromaSiting);
     if (value.has_value()) {
         *outChromaSiting = *value;
         return OK;
@@ -932,7 +1067,8 @@ status_t Gralloc5Mapper::getChromaSiting(buffer_handle_t bufferHandle,
 
 status_t Gralloc5Mapper::getPlaneLayouts(buffer_handle_t bufferHandle,
                                          std::vector<ui::PlaneLayout> *outPlaneLayouts) const {
-    auto value = getStandardMetadata<StandardMetadataType::PLANE_LAYOUTS>(mMapper, bufferHandle);
+    auto value = getCachedStandardMetadata<StandardMetadataType::PLANE_LAYOUTS>(
+            mMapper, *mMetadataCache, bufferHandle, &Gralloc5MetadataCache::Entry::planeLayouts);
     if (value.has_value()) {
         *outPlaneLayouts = *value;
         return OK;
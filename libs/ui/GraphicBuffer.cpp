@@ -158,6 +158,38 @@ GraphicBuffer::GraphicBuffer(const GraphicBufferAllocator::AllocationRequest& re
     }
 }
 
+status_t GraphicBuffer::allocateBatch(uint32_t inWidth, uint32_t inHeight, PixelFormat inFormat,
+                                      uint32_t inLayerCount, uint64_t inUsage,
+                                      uint32_t bufferCount, std::string requestorName,
+                                      std::vector<sp<GraphicBuffer>>* outBuffers) {
+    std::vector<buffer_handle_t> handles(bufferCount);
+    uint32_t outStride = 0;
+    GraphicBufferAllocator& allocator = GraphicBufferAllocator::get();
+    status_t err = allocator.allocateBatch(inWidth, inHeight, inFormat, inLayerCount, inUsage,
+                                           bufferCount, handles.data(), &outStride,
+                                           std::move(requestorName));
+    if (err != NO_ERROR) {
+        return err;
+    }
+
+    outBuffers->reserve(outBuffers->size() + bufferCount);
+    for (buffer_handle_t h : handles) {
+        sp<GraphicBuffer> buffer = sp<GraphicBuffer>::make();
+        buffer->handle = h;
+        buffer->stride = static_cast<int>(outStride);
+        buffer->mBufferMapper.getTransportSize(h, &buffer->mTransportNumFds,
+                                               &buffer->mTransportNumInts);
+        buffer->width = static_cast<int>(inWidth);
+        buffer->height = static_cast<int>(inHeight);
+        buffer->format = inFormat;
+        buffer->layerCount = inLayerCount;
+        buffer->usage = inUsage;
+        buffer->usage_deprecated = int(inUsage);
+        outBuffers->push_back(std::move(buffer));
+    }
+    return NO_ERROR;
+}
+
 GraphicBuffer::~GraphicBuffer()
 {
     ATRACE_CALL();
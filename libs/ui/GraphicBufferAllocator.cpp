@@ -47,6 +47,12 @@ ANDROID_SINGLETON_STATIC_INSTANCE( GraphicBufferAllocator )
 Mutex GraphicBufferAllocator::sLock;
 KeyedVector<buffer_handle_t,
     GraphicBufferAllocator::alloc_rec_t> GraphicBufferAllocator::sAllocList;
+std::list<std::pair<buffer_handle_t, GraphicBufferAllocator::alloc_rec_t>>
+        GraphicBufferAllocator::sRecyclePool;
+size_t GraphicBufferAllocator::sRecyclePoolBytes = 0;
+size_t GraphicBufferAllocator::sRecyclePoolLimit = 0;
+uint64_t GraphicBufferAllocator::sRecycleHits = 0;
+uint64_t GraphicBufferAllocator::sRecycleMisses = 0;
 
 GraphicBufferAllocator::GraphicBufferAllocator() : mMapper(GraphicBufferMapper::getInstance()) {
     switch (mMapper.getMapperVersion()) {
@@ -80,6 +86,8 @@ uint64_t GraphicBufferAllocator::getTotalSize() const {
     for (size_t i = 0; i < sAllocList.size(); ++i) {
         total += sAllocList.valueAt(i).size;
     }
+    // Pooled buffers are still allocated.
+    total += sRecyclePoolBytes;
     return total;
 }
 
@@ -103,6 +111,15 @@ void GraphicBufferAllocator::dump(std::string& result, bool less) const {
     }
     StringAppendF(&result, "Total allocated by GraphicBufferAllocator (estimate): %.2f KB\n",
                   static_cast<double>(total) / 1024.0);
+    if (sRecyclePoolLimit > 0 || !sRecyclePool.empty()) {
+        const uint64_t lookups = sRecycleHits + sRecycleMisses;
+        StringAppendF(&result,
+                      "Recycle pool: %zu buffers, %.2f KB of %.2f KB, %" PRIu64 "/%" PRIu64
+                      " hits (%.1f%%)\n",
+                      sRecyclePool.size(), static_cast<double>(sRecyclePoolBytes) / 1024.0,
+                      static_cast<double>(sRecyclePoolLimit) / 1024.0, sRecycleHits, lookups,
+                      lookups ? 100.0 * static_cast<double>(sRecycleHits) / lookups : 0.0);
+    }
 
     result.append(mAllocator->dumpDebugInfo(less));
 }
@@ -134,6 +151,18 @@ auto GraphicBufferAllocator::allocate(const AllocationRequest& request) -> Alloc
         return AllocationResult(BAD_VALUE);
     }
 
+    const bool recyclable = request.importBuffer && request.extras.empty() &&
+            !(request.usage & GRALLOC_USAGE_PROTECTED);
+    if (recyclable) {
+        Mutex::Autolock _l(sLock);
+        buffer_handle_t handle;
+        uint32_t stride;
+        if (takeRecycledLocked(width, height, request.format, request.layerCount, request.usage,
+                               request.requestorName, &handle, &stride)) {
+            return AllocationResult(handle, stride);
+        }
+    }
+
     auto result = mAllocator->allocate(request);
     if (result.status == UNKNOWN_TRANSACTION) {
         if (!request.extras.empty()) {
@@ -181,6 +210,7 @@ auto GraphicBufferAllocator::allocate(const AllocationRequest& request) -> Alloc
     rec.usage = request.usage;
     rec.size = bufSize;
     rec.requestorName = request.requestorName;
+    rec.recyclable = recyclable;
     list.add(result.handle, rec);
 
     return result;
@@ -213,6 +243,15 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
     // TODO(b/72323293, b/72703005): Remove these invalid bits from callers
     usage &= ~static_cast<uint64_t>((1 << 10) | (1 << 13));
 
+    const bool recyclable = importBuffer && !(usage & GRALLOC_USAGE_PROTECTED);
+    if (recyclable) {
+        Mutex::Autolock _l(sLock);
+        if (takeRecycledLocked(width, height, format, layerCount, usage, requestorName, handle,
+                               stride)) {
+            return NO_ERROR;
+        }
+    }
+
     status_t error = mAllocator->allocate(requestorName, width, height, format, layerCount, usage,
                                           stride, handle, importBuffer);
     if (error != NO_ERROR) {
@@ -247,6 +286,7 @@ status_t GraphicBufferAllocator::allocateHelper(uint32_t width, uint32_t height,
     rec.usage = usage;
     rec.size = bufSize;
     rec.requestorName = std::move(requestorName);
+    rec.recyclable = recyclable;
     list.add(*handle, rec);
 
     return NO_ERROR;
@@ -276,10 +316,113 @@ status_t GraphicBufferAllocator::allocate(uint32_t width, uint32_t height, Pixel
                           true);
 }
 
+status_t GraphicBufferAllocator::allocateBatch(uint32_t width, uint32_t height, PixelFormat format,
+                                               uint32_t layerCount, uint64_t usage,
+                                               uint32_t bufferCount, buffer_handle_t* handles,
+                                               uint32_t* stride, std::string requestorName) {
+    ATRACE_CALL();
+
+    if (bufferCount == 0) {
+        return BAD_VALUE;
+    }
+
+    if (!width || !height)
+        width = height = 1;
+
+    const uint32_t bpp = bytesPerPixel(format);
+    if (std::numeric_limits<size_t>::max() / width / height < static_cast<size_t>(bpp)) {
+        ALOGE("Failed to allocate %u x (%u x %u) layerCount %u format %d "
+              "usage %" PRIx64 ": Requesting too large a buffer size",
+              bufferCount, width, height, layerCount, format, usage);
+        return BAD_VALUE;
+    }
+
+    if (layerCount < 1) {
+        layerCount = 1;
+    }
+
+    // TODO(b/72323293, b/72703005): Remove these invalid bits from callers
+    usage &= ~static_cast<uint64_t>((1 << 10) | (1 << 13));
+
+    status_t error = mAllocator->allocateBatch(requestorName, width, height, format, layerCount,
+                                               usage, bufferCount, stride, handles);
+    if (error == INVALID_OPERATION) {
+        // No batch path in this allocator; allocate one at a time, all or nothing.
+        for (uint32_t i = 0; i < bufferCount; i++) {
+            error = allocateHelper(width, height, format, layerCount, usage, &handles[i], stride,
+                                   requestorName, true);
+            if (error != NO_ERROR) {
+                for (uint32_t j = 0; j < i; j++) {
+                    free(handles[j]);
+                    handles[j] = nullptr;
+                }
+                return error;
+            }
+        }
+        return NO_ERROR;
+    }
+    if (error != NO_ERROR) {
+        ALOGE("Failed to allocate %u x (%u x %u) layerCount %u format %d "
+              "usage %" PRIx64 ": %d",
+              bufferCount, width, height, layerCount, format, usage, error);
+        return error;
+    }
+
+    size_t bufSize;
+    if ((*stride) != 0 &&
+        std::numeric_limits<size_t>::max() / height / (*stride) < static_cast<size_t>(bpp)) {
+        bufSize = static_cast<size_t>(width) * height * bpp;
+    } else {
+        bufSize = static_cast<size_t>((*stride)) * height * bpp;
+    }
+
+    Mutex::Autolock _l(sLock);
+    KeyedVector<buffer_handle_t, alloc_rec_t>& list(sAllocList);
+    alloc_rec_t rec;
+    rec.width = width;
+    rec.height = height;
+    rec.stride = *stride;
+    rec.format = format;
+    rec.layerCount = layerCount;
+    rec.usage = usage;
+    rec.size = bufSize;
+    rec.requestorName = std::move(requestorName);
+    rec.recyclable = !(usage & GRALLOC_USAGE_PROTECTED);
+    for (uint32_t i = 0; i < bufferCount; i++) {
+        list.add(handles[i], rec);
+    }
+
+    return NO_ERROR;
+}
+
 status_t GraphicBufferAllocator::free(buffer_handle_t handle)
 {
     ATRACE_CALL();
 
+    bool pooled = false;
+    std::vector<buffer_handle_t> evicted;
+    {
+        Mutex::Autolock _l(sLock);
+        ssize_t index = sAllocList.indexOfKey(handle);
+        if (index >= 0 && sRecyclePoolLimit > 0) {
+            const alloc_rec_t& rec = sAllocList.valueAt(index);
+            // Buffers of unknown size can't be accounted against the limit.
+            if (rec.recyclable && rec.size > 0 && rec.size <= sRecyclePoolLimit) {
+                evicted = evictRecycledLocked(sRecyclePoolLimit - rec.size);
+                sRecyclePool.emplace_back(handle, rec);
+                sRecyclePoolBytes += rec.size;
+                sAllocList.removeItemsAt(index);
+                pooled = true;
+            }
+        }
+    }
+    for (buffer_handle_t evictedHandle : evicted) {
+        mMapper.freeBuffer(evictedHandle);
+    }
+    if (pooled) {
+        return NO_ERROR;
+    }
+
     // We allocated a buffer from the allocator and imported it into the
     // mapper to get the handle.  We just need to free the handle now.
     mMapper.freeBuffer(handle);
@@ -291,6 +434,67 @@ status_t GraphicBufferAllocator::free(buffer_handle_t handle)
     return NO_ERROR;
 }
 
+void GraphicBufferAllocator::setRecyclePoolLimit(size_t maxBytes) {
+    std::vector<buffer_handle_t> evicted;
+    {
+        Mutex::Autolock _l(sLock);
+        sRecyclePoolLimit = maxBytes;
+        evicted = evictRecycledLocked(maxBytes);
+    }
+    for (buffer_handle_t handle : evicted) {
+        mMapper.freeBuffer(handle);
+    }
+}
+
+void GraphicBufferAllocator::trimRecyclePool(size_t maxBytes) {
+    std::vector<buffer_handle_t> evicted;
+    {
+        Mutex::Autolock _l(sLock);
+        evicted = evictRecycledLocked(maxBytes);
+    }
+    for (buffer_handle_t handle : evicted) {
+        mMapper.freeBuffer(handle);
+    }
+}
+
+bool GraphicBufferAllocator::takeRecycledLocked(uint32_t width, uint32_t height,
+                                                PixelFormat format, uint32_t layerCount,
+                                                uint64_t usage, const std::string& requestorName,
+                                                buffer_handle_t* handle, uint32_t* stride) {
+    if (sRecyclePoolLimit == 0 && sRecyclePool.empty()) {
+        return false;
+    }
+    // Most recently freed first.
+    for (auto it = sRecyclePool.rbegin(); it != sRecyclePool.rend(); ++it) {
+        const alloc_rec_t& rec = it->second;
+        if (rec.width != width || rec.height != height || rec.format != format ||
+            rec.layerCount != layerCount || rec.usage != usage) {
+            continue;
+        }
+        *handle = it->first;
+        *stride = rec.stride;
+        alloc_rec_t reused = rec;
+        reused.requestorName = requestorName;
+        sAllocList.add(*handle, reused);
+        sRecyclePoolBytes -= rec.size;
+        sRecyclePool.erase(std::next(it).base());
+        sRecycleHits++;
+        return true;
+    }
+    sRecycleMisses++;
+    return false;
+}
+
+std::vector<buffer_handle_t> GraphicBufferAllocator::evictRecycledLocked(size_t maxBytes) {
+    std::vector<buffer_handle_t> evicted;
+    while (sRecyclePoolBytes > maxBytes && !sRecyclePool.empty()) {
+        evicted.push_back(sRecyclePool.front().first);
+        sRecyclePoolBytes -= sRecyclePool.front().second.size;
+        sRecyclePool.pop_front();
+    }
+    return evicted;
+}
+
 bool GraphicBufferAllocator::supportsAdditionalOptions() const {
     return mAllocator->supportsAdditionalOptions();
 }
@@ -179,6 +179,11 @@ status_t GraphicBufferMapper::unlock(buffer_handle_t handle, base::unique_fd* ou
     return OK;
 }
 
+status_t GraphicBufferMapper::rereadLockedBuffer(buffer_handle_t handle) {
+    ATRACE_CALL();
+    return mMapper->rereadLockedBuffer(handle);
+}
+
 status_t GraphicBufferMapper::lock(buffer_handle_t handle, uint32_t usage, const Rect& bounds,
                                    void** vaddr) {
     auto result = lock(handle, static_cast<int64_t>(usage), bounds);
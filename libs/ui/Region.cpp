@@ -19,6 +19,8 @@
 #include <inttypes.h>
 #include <limits.h>
 
+#include <algorithm>
+
 #include <android-base/stringprintf.h>
 
 #include <utils/Log.h>
@@ -45,6 +47,13 @@
 #include <core/SkRegion.h>
 #endif
 
+#if VALIDATE_WITH_CORECG || defined(VALIDATE_REGIONS)
+// Always go through the sweep so its result gets cross-checked.
+static constexpr bool kFastBooleanOperations = false;
+#else
+static constexpr bool kFastBooleanOperations = true;
+#endif
+
 namespace android {
 // ----------------------------------------------------------------------------
 
@@ -64,6 +73,11 @@ enum {
 
 const Region Region::INVALID_REGION(Rect::INVALID_RECT);
 
+static inline bool rectContains(const Rect& outer, const Rect& inner) {
+    return outer.left <= inner.left && outer.top <= inner.top &&
+            outer.right >= inner.right && outer.bottom >= inner.bottom;
+}
+
 // ----------------------------------------------------------------------------
 
 Region::Region() {
@@ -101,7 +115,8 @@ Region::~Region()
  * final, correctly ordered region buffer. Each rectangle will be compared with the span directly
  * above it, and subdivided to resolve any remaining T-junctions.
  */
-static void reverseRectsResolvingJunctions(const Rect* begin, const Rect* end, FatVector<Rect>& dst,
+template <typename RectVector>
+static void reverseRectsResolvingJunctions(const Rect* begin, const Rect* end, RectVector& dst,
                                            int spanDirection) {
     dst.clear();
 
@@ -202,7 +217,7 @@ Region Region::createTJunctionFreeRegion(const Region& r) {
     if (r.isEmpty()) return r;
     if (r.isRect()) return r;
 
-    FatVector<Rect> reversed;
+    Storage reversed;
     reverseRectsResolvingJunctions(r.begin(), r.end(), reversed, direction_RTL);
 
     Region outputRegion;
@@ -329,6 +344,9 @@ Region& Region::subtractSelf(const Rect& r) {
     return operationSelf(r, op_nand);
 }
 Region& Region::operationSelf(const Rect& r, uint32_t op) {
+    if (fast_boolean_operation(op, *this, *this, r)) {
+        return *this;
+    }
     Region lhs(*this);
     boolean_operation(op, *this, lhs, r);
     return *this;
@@ -353,6 +371,9 @@ Region& Region::subtractSelf(const Region& rhs) {
     return operationSelf(rhs, op_nand);
 }
 Region& Region::operationSelf(const Region& rhs, uint32_t op) {
+    if (fast_boolean_operation(op, *this, *this, rhs, 0, 0)) {
+        return *this;
+    }
     Region lhs(*this);
     boolean_operation(op, *this, lhs, rhs);
     return *this;
@@ -393,6 +414,9 @@ const Region Region::subtract(const Rect& rhs) const {
 }
 const Region Region::operation(const Rect& rhs, uint32_t op) const {
     Region result;
+    if (fast_boolean_operation(op, result, *this, rhs)) {
+        return result;
+    }
     boolean_operation(op, result, *this, rhs);
     return result;
 }
@@ -413,6 +437,9 @@ const Region Region::subtract(const Region& rhs) const {
 }
 const Region Region::operation(const Region& rhs, uint32_t op) const {
     Region result;
+    if (fast_boolean_operation(op, result, *this, rhs, 0, 0)) {
+        return result;
+    }
     boolean_operation(op, result, *this, rhs);
     return result;
 }
@@ -438,6 +465,9 @@ Region& Region::subtractSelf(const Region& rhs, int dx, int dy) {
     return operationSelf(rhs, dx, dy, op_nand);
 }
 Region& Region::operationSelf(const Region& rhs, int dx, int dy, uint32_t op) {
+    if (fast_boolean_operation(op, *this, *this, rhs, dx, dy)) {
+        return *this;
+    }
     Region lhs(*this);
     boolean_operation(op, *this, lhs, rhs, dx, dy);
     return *this;
@@ -459,6 +489,9 @@ const Region Region::subtract(const Region& rhs, int dx, int dy) const {
 }
 const Region Region::operation(const Region& rhs, int dx, int dy, uint32_t op) const {
     Region result;
+    if (fast_boolean_operation(op, result, *this, rhs, dx, dy)) {
+        return result;
+    }
     boolean_operation(op, result, *this, rhs, dx, dy);
     return result;
 }
@@ -470,10 +503,10 @@ const Region Region::operation(const Region& rhs, int dx, int dy, uint32_t op) c
 class Region::rasterizer : public region_operator<Rect>::region_rasterizer
 {
     Rect bounds;
-    FatVector<Rect>& storage;
+    Storage& storage;
     Rect* head;
     Rect* tail;
-    FatVector<Rect> span;
+    Storage span;
     Rect* cur;
 public:
     explicit rasterizer(Region& reg)
@@ -793,6 +826,134 @@ void Region::boolean_operation(uint32_t op, Region& dst,
     boolean_operation(op, dst, lhs, rhs, 0, 0);
 }
 
+bool Region::fast_boolean_operation(uint32_t op, Region& dst,
+        const Region& lhs, const Rect& rhs)
+{
+    // Empty (or invalid) operands are left to the general path, which
+    // normalizes them and reports invalid rects.
+    if (!kFastBooleanOperations || lhs.isEmpty() || rhs.isEmpty()) {
+        return false;
+    }
+
+    // Everything below is computed before dst is written, since dst may be
+    // the same object as lhs.
+    const Rect bounds(lhs.getBounds());
+    const bool lhsIsRect = lhs.isRect();
+    Rect overlap;
+    const bool intersects = bounds.intersect(rhs, &overlap);
+
+    switch (op) {
+        case op_and:
+            if (!intersects) {
+                dst.clear();
+            } else if (overlap == bounds) {
+                if (&dst != &lhs) dst = lhs;
+            } else if (lhsIsRect) {
+                dst.set(overlap);
+            } else {
+                return false;
+            }
+            return true;
+        case op_or:
+            if (rectContains(rhs, bounds)) {
+                dst.set(rhs);
+                return true;
+            }
+            if (!lhsIsRect) {
+                return false;
+            }
+            if (rectContains(bounds, rhs)) {
+                if (&dst != &lhs) dst = lhs;
+                return true;
+            }
+            // Two rects sharing a full edge extent that overlap or touch
+            // along it merge into a single rect.
+            if ((bounds.top == rhs.top && bounds.bottom == rhs.bottom &&
+                 bounds.left <= rhs.right && rhs.left <= bounds.right) ||
+                (bounds.left == rhs.left && bounds.right == rhs.right &&
+                 bounds.top <= rhs.bottom && rhs.top <= bounds.bottom)) {
+                dst.set(Rect(std::min(bounds.left, rhs.left), std::min(bounds.top, rhs.top),
+                             std::max(bounds.right, rhs.right),
+                             std::max(bounds.bottom, rhs.bottom)));
+                return true;
+            }
+            return false;
+        case op_nand:
+            if (!intersects) {
+                if (&dst != &lhs) dst = lhs;
+                return true;
+            }
+            if (overlap == bounds) {
+                dst.clear();
+                return true;
+            }
+            if (lhsIsRect) {
+                // reduce() only shrinks the rect when the remainder is a
+                // single rect; otherwise it returns the rect unchanged.
+                const Rect remainder(bounds.reduce(rhs));
+                if (remainder != bounds) {
+                    dst.set(remainder);
+                    return true;
+                }
+            }
+            return false;
+        case op_xor:
+            if (lhsIsRect && bounds == rhs) {
+                dst.clear();
+                return true;
+            }
+            return false;
+    }
+    return false;
+}
+
+bool Region::fast_boolean_operation(uint32_t op, Region& dst,
+        const Region& lhs, const Region& rhs, int dx, int dy)
+{
+    if (rhs.isRect()) {
+        Rect r(rhs.mStorage[0]);
+        r.offsetBy(dx, dy);
+        return fast_boolean_operation(op, dst, lhs, r);
+    }
+
+    if (!kFastBooleanOperations || !lhs.isRect() || lhs.isEmpty() || rhs.isEmpty()) {
+        return false;
+    }
+
+    const Rect lhsRect(lhs.mStorage[0]);
+    Rect rhsBounds(rhs.getBounds());
+    rhsBounds.offsetBy(dx, dy);
+    Rect overlap;
+    const bool intersects = lhsRect.intersect(rhsBounds, &overlap);
+
+    switch (op) {
+        case op_and:
+            if (!intersects) {
+                dst.clear();
+                return true;
+            }
+            if (overlap == rhsBounds) {
+                if (&dst != &rhs) dst = rhs;
+                translate(dst, dx, dy);
+                return true;
+            }
+            return false;
+        case op_or:
+            if (overlap == rhsBounds) {
+                dst.set(lhsRect);
+                return true;
+            }
+            return false;
+        case op_nand:
+            if (!intersects) {
+                dst.set(lhsRect);
+                return true;
+            }
+            return false;
+    }
+    return false;
+}
+
 void Region::translate(Region& reg, int dx, int dy)
 {
     if ((dx || dy) && !reg.isEmpty()) {
@@ -814,8 +975,18 @@ void Region::translate(Region& reg, int dx, int dy)
 
 void Region::translate(Region& dst, const Region& reg, int dx, int dy)
 {
-    dst = reg;
-    translate(dst, dx, dy);
+    if (&dst == &reg || !(dx || dy) || reg.isEmpty()) {
+        dst = reg;
+        translate(dst, dx, dy);
+        return;
+    }
+    // Write the translated rects straight into dst instead of copying reg
+    // and then walking the copy a second time.
+    dst.mStorage.clear();
+    dst.mStorage.reserve(reg.mStorage.size());
+    for (const Rect& rect : reg.mStorage) {
+        dst.mStorage.push_back(Rect(rect).offsetBy(dx, dy));
+    }
 }
 
 // ----------------------------------------------------------------------------
@@ -67,6 +67,18 @@ Transform Transform::operator*(const Transform& rhs) const {
     if (rhs.mType == IDENTITY)
         return r;
 
+    // Pure translations compose by adding their offsets. This is the common
+    // case when walking a layer hierarchy, and the type of the result is
+    // known without another type() pass.
+    if (type() <= TRANSLATE && rhs.type() <= TRANSLATE && isAffine() && rhs.isAffine()) {
+        const float x = tx() + rhs.tx();
+        const float y = ty() + rhs.ty();
+        r.mMatrix[2][0] = x;
+        r.mMatrix[2][1] = y;
+        r.mType = (isZero(x) && isZero(y)) ? IDENTITY : TRANSLATE;
+        return r;
+    }
+
     // TODO: we could use mType to optimize the matrix multiply
     const mat33& A(mMatrix);
     const mat33& B(rhs.mMatrix);
@@ -251,51 +263,50 @@ Rect Transform::makeBounds(int w, int h) const {
     return transform( Rect(w, h) );
 }
 
-Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
-    Rect r;
-    vec2 lt( bounds.left,  bounds.top    );
-    vec2 rt( bounds.right, bounds.top    );
-    vec2 lb( bounds.left,  bounds.bottom );
-    vec2 rb( bounds.right, bounds.bottom );
+FloatRect Transform::transformCorners(float left, float top, float right, float bottom) const {
+    const vec2 lt = transform(vec2(left, top));
+    const vec2 rb = transform(vec2(right, bottom));
+
+    FloatRect r;
+    if (CC_LIKELY(preserveRects())) {
+        // Without skew or arbitrary rotation, each coordinate of the other two
+        // corners is shared with lt or rb, so they can't extend the bounds.
+        r.left = std::min(lt[0], rb[0]);
+        r.top = std::min(lt[1], rb[1]);
+        r.right = std::max(lt[0], rb[0]);
+        r.bottom = std::max(lt[1], rb[1]);
+    } else {
+        const vec2 rt = transform(vec2(right, top));
+        const vec2 lb = transform(vec2(left, bottom));
+        r.left = std::min({lt[0], rt[0], lb[0], rb[0]});
+        r.top = std::min({lt[1], rt[1], lb[1], rb[1]});
+        r.right = std::max({lt[0], rt[0], lb[0], rb[0]});
+        r.bottom = std::max({lt[1], rt[1], lb[1], rb[1]});
+    }
+    return r;
+}
 
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
+Rect Transform::transform(const Rect& bounds, bool roundOutwards) const {
+    const FloatRect f = transformCorners(bounds.left, bounds.top, bounds.right, bounds.bottom);
 
+    Rect r;
     if (roundOutwards) {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]})));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]})));
-        r.right  = static_cast<int32_t>(ceilf(std::max({lt[0], rt[0], lb[0], rb[0]})));
-        r.bottom = static_cast<int32_t>(ceilf(std::max({lt[1], rt[1], lb[1], rb[1]})));
+        r.left   = static_cast<int32_t>(floorf(f.left));
+        r.top    = static_cast<int32_t>(floorf(f.top));
+        r.right  = static_cast<int32_t>(ceilf(f.right));
+        r.bottom = static_cast<int32_t>(ceilf(f.bottom));
     } else {
-        r.left   = static_cast<int32_t>(floorf(std::min({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.top    = static_cast<int32_t>(floorf(std::min({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
-        r.right  = static_cast<int32_t>(floorf(std::max({lt[0], rt[0], lb[0], rb[0]}) + 0.5f));
-        r.bottom = static_cast<int32_t>(floorf(std::max({lt[1], rt[1], lb[1], rb[1]}) + 0.5f));
+        r.left   = static_cast<int32_t>(floorf(f.left + 0.5f));
+        r.top    = static_cast<int32_t>(floorf(f.top + 0.5f));
+        r.right  = static_cast<int32_t>(floorf(f.right + 0.5f));
+        r.bottom = static_cast<int32_t>(floorf(f.bottom + 0.5f));
     }
 
     return r;
 }
 
 FloatRect Transform::transform(const FloatRect& bounds) const {
-    vec2 lt(bounds.left, bounds.top);
-    vec2 rt(bounds.right, bounds.top);
-    vec2 lb(bounds.left, bounds.bottom);
-    vec2 rb(bounds.right, bounds.bottom);
-
-    lt = transform(lt);
-    rt = transform(rt);
-    lb = transform(lb);
-    rb = transform(rb);
-
-    FloatRect r;
-    r.left = std::min({lt[0], rt[0], lb[0], rb[0]});
-    r.top = std::min({lt[1], rt[1], lb[1], rb[1]});
-    r.right = std::max({lt[0], rt[0], lb[0], rb[0]});
-    r.bottom = std::max({lt[1], rt[1], lb[1], rb[1]});
-
-    return r;
+    return transformCorners(bounds.left, bounds.top, bounds.right, bounds.bottom);
 }
 
 Region Transform::transform(const Region& reg) const {
@@ -422,6 +433,10 @@ uint32_t Transform::getOrientation() const {
     return (type() >> 8) & 0xFF;
 }
 
+bool Transform::isAffine() const {
+    return mMatrix[0][2] == 0.0f && mMatrix[1][2] == 0.0f && mMatrix[2][2] == 1.0f;
+}
+
 bool Transform::preserveRects() const {
     return (getOrientation() & ROT_INVALID) ? false : true;
 }
@@ -29,12 +29,14 @@
 
 namespace android {
 
+class FenceTimeResolver;
 class FenceToFenceTimeMap;
 
 // A wrapper around fence that only implements isValid and getSignalTime.
 // It automatically closes the fence in a thread-safe manner once the signal
 // time is known.
 class FenceTime {
+friend class FenceTimeResolver;
 friend class FenceToFenceTimeMap;
 public:
     // An atomic snapshot of the FenceTime that is flattenable.
@@ -104,6 +106,9 @@ public:
 
     // Attempts to get the timestamp from the Fence if the timestamp isn't
     // already cached. Otherwise, it returns the cached value.
+    // If the FenceTime is being watched by FenceTimeResolver, this never
+    // queries the Fence and returns SIGNAL_TIME_PENDING until the resolver
+    // has recorded the signal time.
     nsecs_t getSignalTime();
 
     // Gets the cached timestamp without attempting to query the Fence.
@@ -126,6 +131,9 @@ private:
     // never return SIGNAL_TIME_INVALID and isValid will always return true.
     FenceTime(const sp<Fence>& fence, bool forceValidForTest);
 
+    // Queries the Fence for the signal time and caches it once known.
+    nsecs_t pollSignalTime();
+
     enum class State {
         VALID,
         INVALID,
@@ -140,6 +148,9 @@ private:
     mutable std::mutex mMutex;
     sp<Fence> mFence{Fence::NO_FENCE};
     std::atomic<nsecs_t> mSignalTime{Fence::SIGNAL_TIME_INVALID};
+
+    // Set while FenceTimeResolver is waiting on mFence for us.
+    std::atomic<bool> mResolverPending{false};
 };
 
 using FenceTimePtr = std::shared_ptr<FenceTime>;
@@ -172,6 +183,48 @@ private:
     std::queue<std::weak_ptr<FenceTime>> mQueue GUARDED_BY(mMutex);
 };
 
+// Waits on many FenceTimes at once from a single background thread and
+// caches each signal time as soon as its fence signals.
+//
+// Once a FenceTime is watched, getSignalTime() and getCachedSignalTime()
+// become plain loads: neither makes a syscall, and both report the signal
+// time shortly after the fence signals. This is meant for fences that are
+// queried repeatedly (e.g. every frame) until they signal.
+//
+// Only weak references to the FenceTimes are kept. The resolver dups the
+// fence's file descriptor so that it can wait on it even if the FenceTime
+// is destroyed first. At most MAX_PENDING fences are watched; watch()
+// returns false beyond that and the FenceTime keeps polling its fence.
+//
+// watch() is safe to call from any thread.
+class FenceTimeResolver {
+public:
+    static constexpr size_t MAX_PENDING = 256;
+
+    static FenceTimeResolver& getInstance();
+
+    // Returns true if the fence is now watched. Invalid, already signaled
+    // and already watched FenceTimes are not watched again.
+    bool watch(const std::shared_ptr<FenceTime>& fence);
+
+private:
+    FenceTimeResolver();
+
+    void threadMain();
+    void abandonAllLocked() REQUIRES(mMutex);
+
+    struct Entry {
+        std::weak_ptr<FenceTime> fence;
+        int fd = -1;
+    };
+
+    const int mEpollFd;
+    std::mutex mMutex;
+    uint64_t mNextToken GUARDED_BY(mMutex) = 1;
+    std::unordered_map<uint64_t, Entry> mPending GUARDED_BY(mMutex);
+    bool mAbandoned GUARDED_BY(mMutex) = false;
+};
+
 // Used by test code to create or get FenceTimes for a given Fence.
 //
 // By design, Fences cannot be signaled from user space. However, this class
@@ -72,6 +72,14 @@ public:
     // owned by the caller
     virtual int unlock(buffer_handle_t bufferHandle) const = 0;
 
+    // Makes a buffer that is already locked for CPU reading observe writes
+    // that other devices made since it was locked, without unlocking and
+    // relocking it. Returns INVALID_OPERATION when the mapper HAL
+    // predates this operation.
+    virtual status_t rereadLockedBuffer(buffer_handle_t /*bufferHandle*/) const {
+        return INVALID_OPERATION;
+    }
+
     // isSupported queries whether or not a buffer with the given width, height,
     // format, layer count, and usage can be allocated on the device.  If
     // *outSupported is set to true, a buffer with the given specifications may be successfully
@@ -222,6 +230,21 @@ public:
                               uint32_t* outStride, buffer_handle_t* outBufferHandles,
                               bool importBuffers = true) const = 0;
 
+    /*
+     * Allocates bufferCount buffers sharing a single descriptor in one
+     * allocator transaction.  The returned buffers are already imported.
+     * Either every buffer is allocated or none is.  Returns
+     * INVALID_OPERATION when the allocator has no batch path, in which case
+     * callers should fall back to allocate().
+     */
+    virtual status_t allocateBatch(std::string /*requestorName*/, uint32_t /*width*/,
+                                   uint32_t /*height*/, PixelFormat /*format*/,
+                                   uint32_t /*layerCount*/, uint64_t /*usage*/,
+                                   uint32_t /*bufferCount*/, uint32_t* /*outStride*/,
+                                   buffer_handle_t* /*outBufferHandles*/) const {
+        return INVALID_OPERATION;
+    }
+
     virtual GraphicBufferAllocator::AllocationResult allocate(
             const GraphicBufferAllocator::AllocationRequest&) const {
         return GraphicBufferAllocator::AllocationResult(UNKNOWN_TRANSACTION);
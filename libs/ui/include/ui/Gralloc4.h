@@ -65,6 +65,8 @@ public:
 
     int unlock(buffer_handle_t bufferHandle) const override;
 
+    status_t rereadLockedBuffer(buffer_handle_t bufferHandle) const override;
+
     status_t isSupported(uint32_t width, uint32_t height, PixelFormat format, uint32_t layerCount,
                          uint64_t usage, bool* outSupported) const override;
 
@@ -177,7 +179,17 @@ public:
                       PixelFormat format, uint32_t layerCount, uint64_t usage, uint32_t* outStride,
                       buffer_handle_t* outBufferHandles, bool importBuffers = true) const override;
 
+    status_t allocateBatch(std::string requestorName, uint32_t width, uint32_t height,
+                           PixelFormat format, uint32_t layerCount, uint64_t usage,
+                           uint32_t bufferCount, uint32_t* outStride,
+                           buffer_handle_t* outBufferHandles) const override;
+
 private:
+    status_t allocateBuffers(std::string requestorName, uint32_t width, uint32_t height,
+                             PixelFormat format, uint32_t layerCount, uint64_t usage,
+                             uint32_t bufferCount, uint32_t* outStride,
+                             buffer_handle_t* outBufferHandles, bool importBuffers) const;
+
     const Gralloc4Mapper& mMapper;
     sp<hardware::graphics::allocator::V4_0::IAllocator> mAllocator;
     // Optional "4.1" allocator
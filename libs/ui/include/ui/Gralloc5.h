@@ -20,14 +20,19 @@
 #include <android/hardware/graphics/mapper/IMapper.h>
 #include <ui/Gralloc.h>
 
+#include <memory>
+
 namespace android {
 
+struct Gralloc5MetadataCache;
+
 class Gralloc5Mapper : public GrallocMapper {
 public:
 public:
     static void preload();
 
     Gralloc5Mapper();
+    ~Gralloc5Mapper() override;
 
     [[nodiscard]] bool isLoaded() const override;
 
@@ -57,6 +62,8 @@ public:
 
     [[nodiscard]] int unlock(buffer_handle_t bufferHandle) const override;
 
+    [[nodiscard]] status_t rereadLockedBuffer(buffer_handle_t bufferHandle) const override;
+
     [[nodiscard]] status_t isSupported(uint32_t width, uint32_t height, PixelFormat format,
                                        uint32_t layerCount, uint64_t usage,
                                        bool *outSupported) const override;
@@ -160,6 +167,8 @@ private:
     void unlockBlocking(buffer_handle_t bufferHandle) const;
 
     AIMapper *mMapper = nullptr;
+    // Decoded allocation-time metadata per imported handle; see Gralloc5.cpp.
+    std::unique_ptr<Gralloc5MetadataCache> mMetadataCache;
 };
 
 class Gralloc5Allocator : public GrallocAllocator {
@@ -175,6 +184,12 @@ public:
                                     uint32_t* outStride, buffer_handle_t* outBufferHandles,
                                     bool importBuffers) const override;
 
+    [[nodiscard]] status_t allocateBatch(std::string requestorName, uint32_t width,
+                                         uint32_t height, PixelFormat format,
+                                         uint32_t layerCount, uint64_t usage,
+                                         uint32_t bufferCount, uint32_t* outStride,
+                                         buffer_handle_t* outBufferHandles) const override;
+
     [[nodiscard]] GraphicBufferAllocator::AllocationResult allocate(
             const GraphicBufferAllocator::AllocationRequest&) const override;
 
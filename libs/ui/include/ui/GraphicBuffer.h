@@ -109,6 +109,14 @@ public:
 
     GraphicBuffer(const GraphicBufferAllocator::AllocationRequest&);
 
+    // Allocate bufferCount identical buffers with a single allocator call where
+    // possible, appending them to outBuffers.  Either every buffer is allocated
+    // or outBuffers is left unchanged.
+    static status_t allocateBatch(uint32_t inWidth, uint32_t inHeight, PixelFormat inFormat,
+                                  uint32_t inLayerCount, uint64_t inUsage, uint32_t bufferCount,
+                                  std::string requestorName,
+                                  std::vector<sp<GraphicBuffer>>* outBuffers);
+
     // Create a GraphicBuffer from an existing handle.
     enum HandleWrapMethod : uint8_t {
         // Wrap and use the handle directly.  It assumes the handle has been
@@ -20,8 +20,10 @@
 
 #include <stdint.h>
 
+#include <list>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <cutils/native_handle.h>
@@ -100,8 +102,40 @@ public:
             buffer_handle_t* handle, uint32_t* stride, uint64_t graphicBufferId,
             std::string requestorName);
 
+    /**
+     * Allocates and imports bufferCount identical gralloc buffers, in a single allocator
+     * transaction when the allocator supports it. handles must have room for bufferCount
+     * entries; all buffers share the returned stride. Either every buffer is allocated or
+     * none is.
+     *
+     * Each handle must be freed with GraphicBufferAllocator::free() when no longer needed.
+     */
+    status_t allocateBatch(uint32_t w, uint32_t h, PixelFormat format, uint32_t layerCount,
+                           uint64_t usage, uint32_t bufferCount, buffer_handle_t* handles,
+                           uint32_t* stride, std::string requestorName);
+
     status_t free(buffer_handle_t handle);
 
+    /**
+     * Enables a process-wide pool of freed buffers, holding up to maxBytes, that
+     * allocate() draws from before going to gralloc when a request has exactly the
+     * same width, height, format, layer count and usage. Passing 0 (the default)
+     * disables the pool and frees everything in it.
+     *
+     * Recycled buffers keep their previous contents and gralloc metadata. The pool
+     * can't tell whether another process still holds an imported reference to a
+     * buffer freed here, so only enable it in processes whose freed buffers are no
+     * longer being read elsewhere. Protected buffers, buffers allocated with
+     * additional options, and raw handles are never pooled.
+     */
+    void setRecyclePoolLimit(size_t maxBytes);
+
+    /**
+     * Frees pooled buffers, oldest first, until the pool holds at most maxBytes.
+     * Intended to be called on memory pressure.
+     */
+    void trimRecyclePool(size_t maxBytes = 0);
+
     uint64_t getTotalSize() const;
 
     void dump(std::string& res, bool less = true) const;
@@ -119,14 +153,31 @@ protected:
         uint64_t usage;
         size_t size;
         std::string requestorName;
+        // Whether free() may hand this buffer to the recycle pool.
+        bool recyclable = false;
     };
 
+    // Takes a pooled buffer matching the given attributes and moves it back to sAllocList under
+    // requestorName. Must be called with sLock held.
+    bool takeRecycledLocked(uint32_t width, uint32_t height, PixelFormat format,
+                            uint32_t layerCount, uint64_t usage, const std::string& requestorName,
+                            buffer_handle_t* handle, uint32_t* stride);
+    // Removes buffers from the pool, oldest first, until it holds at most maxBytes, and returns
+    // them so they can be freed after sLock is released. Must be called with sLock held.
+    std::vector<buffer_handle_t> evictRecycledLocked(size_t maxBytes);
+
     status_t allocateHelper(uint32_t w, uint32_t h, PixelFormat format, uint32_t layerCount,
                             uint64_t usage, buffer_handle_t* handle, uint32_t* stride,
                             std::string requestorName, bool importBuffer);
 
     static Mutex sLock;
     static KeyedVector<buffer_handle_t, alloc_rec_t> sAllocList;
+    // Freed buffers available for reuse, oldest first. See setRecyclePoolLimit.
+    static std::list<std::pair<buffer_handle_t, alloc_rec_t>> sRecyclePool;
+    static size_t sRecyclePoolBytes;
+    static size_t sRecyclePoolLimit;
+    static uint64_t sRecycleHits;
+    static uint64_t sRecycleMisses;
 
     friend class Singleton<GraphicBufferAllocator>;
     GraphicBufferAllocator();
@@ -119,6 +119,9 @@ public:
         return result;
     }
 
+    // See GrallocMapper::rereadLockedBuffer.
+    status_t rereadLockedBuffer(buffer_handle_t handle);
+
     status_t isSupported(uint32_t width, uint32_t height, android::PixelFormat format,
                          uint32_t layerCount, uint64_t usage, bool* outSupported);
 
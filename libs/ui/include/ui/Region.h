@@ -171,17 +171,31 @@ private:
     static void boolean_operation(uint32_t op, Region& dst,
             const Region& lhs, const Rect& rhs);
 
+    // O(1) shortcuts for operations whose result can be derived from the
+    // bounds alone (e.g. rect vs rect, or disjoint/containing operands).
+    // Return false when the general sweep is needed. dst may alias lhs or rhs.
+    static bool fast_boolean_operation(uint32_t op, Region& dst,
+            const Region& lhs, const Rect& rhs);
+    static bool fast_boolean_operation(uint32_t op, Region& dst,
+            const Region& lhs, const Region& rhs, int dx, int dy);
+
     static void translate(Region& reg, int dx, int dy);
     static void translate(Region& dst, const Region& reg, int dx, int dy);
 
     static bool validate(const Region& reg,
             const char* name, bool silent = false);
 
+    // Regions of up to kInlineRects - 1 rects (plus the bounds) live entirely
+    // inside the Region, so copying or translating the small regions that make
+    // up most visible, damage and touchable regions never touches the heap.
+    static constexpr size_t kInlineRects = 8;
+    using Storage = FatVector<Rect, kInlineRects>;
+
     // mStorage is a (manually) sorted array of Rects describing the region
     // with an extra Rect as the last element which is set to the
     // bounds of the region. However, if the region is
     // a simple Rect then mStorage contains only that rect.
-    FatVector<Rect> mStorage;
+    Storage mStorage;
 };
 
 
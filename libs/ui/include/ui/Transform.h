@@ -125,6 +125,10 @@ private:
     enum { UNKNOWN_TYPE = 0x80000000 };
 
     uint32_t type() const;
+    // Whether the last row of the matrix is < 0, 0, 1 >.
+    bool isAffine() const;
+    // Returns the bounds of the transformed corners of the given rect.
+    FloatRect transformCorners(float left, float top, float right, float bottom) const;
     static bool absIsOne(float f);
     static bool isZero(float f);
 
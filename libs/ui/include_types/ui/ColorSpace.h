@@ -52,14 +52,14 @@ public:
      *
      * The default transfer functions are a linear response x->x
      * and the default clamping function is a simple saturate
-     * (clamp(x, 0, 1)).
+     * (clamp(x, 0, 1)), which is also used if clamper is empty.
      */
     ColorSpace(
             const std::string& name,
             const mat3& rgbToXYZ,
             transfer_function OETF = linearResponse,
             transfer_function EOTF = linearResponse,
-            clamping_function clamper = saturate<float>
+            clamping_function clamper = {}
     ) noexcept;
 
     /**
@@ -69,13 +69,14 @@ public:
      *
      * The transfer functions are defined by the set of supplied
      * transfer parameters. The default clamping function is a
-     * simple saturate (clamp(x, 0, 1)).
+     * simple saturate (clamp(x, 0, 1)), which is also used if
+     * clamper is empty.
      */
     ColorSpace(
             const std::string& name,
             const mat3& rgbToXYZ,
             const TransferParameters parameters,
-            clamping_function clamper = saturate<float>
+            clamping_function clamper = {}
     ) noexcept;
 
     /**
@@ -84,13 +85,14 @@ public:
      * computed from the supplied matrix.
      *
      * The transfer functions are defined by a simple gamma value.
-     * The default clamping function is a saturate (clamp(x, 0, 1)).
+     * The default clamping function is a saturate (clamp(x, 0, 1)),
+     * which is also used if clamper is empty.
      */
     ColorSpace(
             const std::string& name,
             const mat3& rgbToXYZ,
             float gamma,
-            clamping_function clamper = saturate<float>
+            clamping_function clamper = {}
     ) noexcept;
 
     /**
@@ -100,7 +102,7 @@ public:
      *
      * The default transfer functions are a linear response x->x
      * and the default clamping function is a simple saturate
-     * (clamp(x, 0, 1)).
+     * (clamp(x, 0, 1)), which is also used if clamper is empty.
      */
     ColorSpace(
             const std::string& name,
@@ -108,7 +110,7 @@ public:
             const float2& whitePoint,
             transfer_function OETF = linearResponse,
             transfer_function EOTF = linearResponse,
-            clamping_function clamper = saturate<float>
+            clamping_function clamper = {}
     ) noexcept;
 
     /**
@@ -118,14 +120,15 @@ public:
      *
      * The transfer functions are defined by the set of supplied
      * transfer parameters. The default clamping function is a
-     * simple saturate (clamp(x, 0, 1)).
+     * simple saturate (clamp(x, 0, 1)), which is also used if
+     * clamper is empty.
      */
     ColorSpace(
             const std::string& name,
             const std::array<float2, 3>& primaries,
             const float2& whitePoint,
             const TransferParameters parameters,
-            clamping_function clamper = saturate<float>
+            clamping_function clamper = {}
     ) noexcept;
 
     /**
@@ -134,14 +137,15 @@ public:
      * computed from the primaries and white point.
      *
      * The transfer functions are defined by a single gamma value.
-     * The default clamping function is a saturate (clamp(x, 0, 1)).
+     * The default clamping function is a saturate (clamp(x, 0, 1)),
+     * which is also used if clamper is empty.
      */
     ColorSpace(
             const std::string& name,
             const std::array<float2, 3>& primaries,
             const float2& whitePoint,
             float gamma,
-            clamping_function clamper = saturate<float>
+            clamping_function clamper = {}
     ) noexcept;
 
     ColorSpace() noexcept = delete;
@@ -162,6 +166,22 @@ public:
         return apply(v, mEOTF);
     }
 
+    /**
+     * Encodes the supplied RGB values in place. This is equivalent
+     * to calling fromLinear() on each value, but color spaces that
+     * are defined by transfer parameters or a gamma value evaluate
+     * their transfer function inline rather than through
+     * transfer_function.
+     */
+    void fromLinear(float3* values, size_t count) const noexcept;
+
+    /**
+     * Decodes the supplied RGB values in place. This is equivalent
+     * to calling toLinear() on each value, with the same benefits
+     * as the batch variant of fromLinear().
+     */
+    void toLinear(float3* values, size_t count) const noexcept;
+
     /**
      * Converts the supplied XYZ value to RGB. The returned value
      * is encoded with this color space's opto-electronic transfer
@@ -254,6 +274,25 @@ public:
                                                const ColorSpace& dst);
 
 private:
+    friend class ColorSpaceConnector;
+
+    // How the transfer functions of this color space are defined, so
+    // that batch conversions can evaluate them without going through
+    // transfer_function.
+    enum class TransferType {
+        Custom,
+        Linear,
+        Gamma,
+        Parametric,
+        ParametricFull,
+    };
+
+    static TransferType getTransferType(const transfer_function& OETF,
+                                        const transfer_function& EOTF) noexcept;
+    static TransferType getTransferType(const TransferParameters& parameters) noexcept;
+
+    void clampValues(const float3* src, float3* dst, size_t count) const noexcept;
+
     static constexpr mat3 computeXYZMatrix(
             const std::array<float2, 3>& primaries, const float2& whitePoint);
 
@@ -267,6 +306,8 @@ private:
     mat3 mXYZtoRGB;
 
     TransferParameters mParameters;
+    TransferType mTransferType;
+    bool mSaturates;
     transfer_function mOETF;
     transfer_function mEOTF;
     clamping_function mClamper;
@@ -289,6 +330,16 @@ public:
         return apply(mDestination.fromLinear(mTransform * linear), mDestination.getClamper());
     }
 
+    /**
+     * Transforms count values from src into dst, which may be the
+     * same array. This is equivalent to calling transform() on each
+     * value, but applies each step of the conversion to a block of
+     * values at a time, which keeps the loops free of indirect calls
+     * for the common color spaces and lets the compiler vectorize
+     * the matrix and clamping steps.
+     */
+    void transform(const float3* src, float3* dst, size_t count) const noexcept;
+
     constexpr float3 transformLinear(const float3& v) const noexcept {
         float3 linear = apply(v, mSource.getClamper());
         return apply(mTransform * linear, mDestination.getClamper());
@@ -53,6 +53,11 @@ public:
                     allocate)
                 .WillOnce(DoAll(SetArgPointee<6>(stride), Return(err)));
     }
+    void setUpAllocateExpectations(status_t err, uint32_t stride, buffer_handle_t handle) {
+        EXPECT_CALL(*(reinterpret_cast<const mock::MockGrallocAllocator*>(mAllocator.get())),
+                    allocate)
+                .WillOnce(DoAll(SetArgPointee<6>(stride), SetArgPointee<7>(handle), Return(err)));
+    }
     std::unique_ptr<const GrallocAllocator>& getAllocator() { return mAllocator; }
 };
 
@@ -113,4 +118,36 @@ TEST_F(GraphicBufferAllocatorTest, AllocateLargeStride) {
     ASSERT_EQ(NO_ERROR, err);
     ASSERT_EQ(expectedStride, stride);
 }
+
+TEST_F(GraphicBufferAllocatorTest, RecyclePoolReusesFreedBuffer) {
+    // Never dereferenced: the pooled handle is handed back without touching the mapper.
+    const buffer_handle_t fakeHandle = reinterpret_cast<buffer_handle_t>(0x1000);
+    android::PixelFormat format = PIXEL_FORMAT_RGBA_8888;
+    mAllocator.setRecyclePoolLimit(kTestWidth * kTestHeight * 4);
+
+    // Only the first allocation may reach gralloc.
+    mAllocator.setUpAllocateExpectations(NO_ERROR, kTestWidth, fakeHandle);
+    uint32_t stride = 0;
+    buffer_handle_t handle;
+    ASSERT_EQ(NO_ERROR,
+              mAllocator.allocate(kTestWidth, kTestHeight, format, kTestLayerCount, kTestUsage,
+                                  &handle, &stride, "GraphicBufferAllocatorTest"));
+    ASSERT_EQ(fakeHandle, handle);
+    ASSERT_EQ(NO_ERROR, mAllocator.free(handle));
+
+    stride = 0;
+    handle = nullptr;
+    ASSERT_EQ(NO_ERROR,
+              mAllocator.allocate(kTestWidth, kTestHeight, format, kTestLayerCount, kTestUsage,
+                                  &handle, &stride, "GraphicBufferAllocatorTest"));
+    EXPECT_EQ(fakeHandle, handle);
+    EXPECT_EQ(kTestWidth, stride);
+
+    std::string dump;
+    mAllocator.dump(dump);
+    EXPECT_NE(std::string::npos, dump.find("Recycle pool: 0 buffers")) << dump;
+
+    // The pool is empty, so disabling it doesn't free anything through the mapper.
+    mAllocator.setRecyclePoolLimit(0);
+}
 } // namespace android
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <ui/Rect.h>
+#include <ui/Region.h>
+
+namespace android {
+namespace {
+
+// A region shaped like a typical visible region: a display-sized rect with a
+// few occluding windows punched out of it.
+Region makeFragmentedRegion() {
+    Region region(Rect(0, 0, 1080, 2400));
+    region.subtractSelf(Rect(100, 200, 500, 600));
+    region.subtractSelf(Rect(600, 800, 1000, 1400));
+    region.subtractSelf(Rect(0, 2200, 1080, 2300));
+    return region;
+}
+
+void BM_RectIntersectRect(benchmark::State& state) {
+    const Region region(Rect(0, 0, 1080, 2400));
+    const Rect crop(100, 100, 980, 2300);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.intersect(crop));
+    }
+}
+BENCHMARK(BM_RectIntersectRect);
+
+void BM_RectMergeRect(benchmark::State& state) {
+    const Region region(Rect(0, 0, 1080, 1200));
+    const Rect rect(0, 1200, 1080, 2400);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.merge(rect));
+    }
+}
+BENCHMARK(BM_RectMergeRect);
+
+void BM_RectSubtractRect(benchmark::State& state) {
+    const Region region(Rect(0, 0, 1080, 2400));
+    const Rect bar(0, 0, 1080, 100);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.subtract(bar));
+    }
+}
+BENCHMARK(BM_RectSubtractRect);
+
+void BM_RectAndSelfRect(benchmark::State& state) {
+    const Rect crop(100, 100, 980, 2300);
+    for (auto _ : state) {
+        Region region(Rect(0, 0, 1080, 2400));
+        region.andSelf(crop);
+        benchmark::DoNotOptimize(region);
+    }
+}
+BENCHMARK(BM_RectAndSelfRect);
+
+void BM_RegionIntersectContainingRect(benchmark::State& state) {
+    const Region region = makeFragmentedRegion();
+    const Rect display(0, 0, 1080, 2400);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.intersect(display));
+    }
+}
+BENCHMARK(BM_RegionIntersectContainingRect);
+
+void BM_RegionSubtractDisjointRect(benchmark::State& state) {
+    const Region region = makeFragmentedRegion();
+    const Rect offscreen(2000, 0, 2100, 100);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(region.subtract(offscreen));
+    }
+}
+BENCHMARK(BM_RegionSubtractDisjointRect);
+
+// Exercises the general sweep, for comparison with the shortcuts above.
+void BM_RegionIntersectRegion(benchmark::State& state) {
+    const Region lhs = makeFragmentedRegion();
+    const Region rhs = makeFragmentedRegion().translate(50, 50);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lhs.intersect(rhs));
+    }
+}
+BENCHMARK(BM_RegionIntersectRegion);
+
+} // namespace
+} // namespace android
+
+BENCHMARK_MAIN();
@@ -179,5 +179,113 @@ TEST_F(RegionTest, RegionHash) {
     EXPECT_NE(std::hash<Region>{}(region1), std::hash<Region>{}(region2));
 }
 
+TEST_F(RegionTest, RectOperations_SingleRectResults) {
+    const Region region(Rect(0, 0, 10, 10));
+
+    EXPECT_TRUE(region.intersect(Rect(5, 5, 20, 20)).hasSameRects(Region(Rect(5, 5, 10, 10))));
+    EXPECT_TRUE(region.intersect(Rect(20, 20, 30, 30)).isEmpty());
+    EXPECT_TRUE(region.intersect(Rect(20, 20, 30, 30)).hasSameRects(Region()));
+    EXPECT_TRUE(region.merge(Rect(10, 0, 20, 10)).hasSameRects(Region(Rect(0, 0, 20, 10))));
+    EXPECT_TRUE(region.merge(Rect(0, 5, 10, 20)).hasSameRects(Region(Rect(0, 0, 10, 20))));
+    EXPECT_TRUE(region.merge(Rect(2, 2, 8, 8)).hasSameRects(region));
+    EXPECT_TRUE(region.subtract(Rect(5, -5, 15, 15)).hasSameRects(Region(Rect(0, 0, 5, 10))));
+    EXPECT_TRUE(region.subtract(Rect(-5, -5, 15, 15)).hasSameRects(Region()));
+    EXPECT_TRUE(region.mergeExclusive(Rect(0, 0, 10, 10)).hasSameRects(Region()));
+}
+
+TEST_F(RegionTest, RegionOperations_AliasedOperands) {
+    Region region(Rect(0, 0, 10, 10));
+    region.orSelf(Rect(20, 0, 30, 10));
+
+    Region copy(region);
+    copy.andSelf(copy);
+    EXPECT_TRUE(copy.hasSameRects(region));
+
+    copy = region;
+    copy.andSelf(copy, 5, 0);
+    EXPECT_TRUE(copy.hasSameRects(region.intersect(Region(region), 5, 0)));
+
+    Region rect(Rect(0, 0, 10, 10));
+    rect.andSelf(rect, 5, 5);
+    EXPECT_TRUE(rect.hasSameRects(Region(Rect(5, 5, 10, 10))));
+}
+
+TEST_F(RegionTest, Random_BooleanOperations) {
+    srandom(54321);
+
+    const auto randomRect = []() {
+        const int l = random() % X_MAX;
+        const int t = random() % Y_MAX;
+        return Rect(l, t, l + 1 + random() % (X_MAX - l), t + 1 + random() % (Y_MAX - t));
+    };
+    const auto randomRegion = [&]() {
+        Region region;
+        const int count = 1 + random() % 3;
+        for (int i = 0; i < count; i++) {
+            region.orSelf(randomRect());
+        }
+        return region;
+    };
+    const auto checkCoverage = [](const Region& result, const Region& lhs, const Region& rhs,
+                                  int dx, int dy, uint32_t op) {
+        for (int x = -X_MAX; x < 2 * X_MAX; x++) {
+            for (int y = -Y_MAX; y < 2 * Y_MAX; y++) {
+                const bool a = lhs.contains(x, y);
+                const bool b = rhs.contains(x - dx, y - dy);
+                bool expected = false;
+                switch (op) {
+                    case 0: expected = a || b; break;
+                    case 1: expected = a && b; break;
+                    case 2: expected = a && !b; break;
+                    case 3: expected = a != b; break;
+                }
+                ASSERT_EQ(expected, result.contains(x, y))
+                        << "op=" << op << " at (" << x << ", " << y << ")";
+            }
+        }
+    };
+
+    for (int iter = 0; iter < ITER_MAX; iter++) {
+        const Region lhs = (random() % 2) ? Region(randomRect()) : randomRegion();
+        const Region rhs = (random() % 2) ? Region(randomRect()) : randomRegion();
+        const int dx = static_cast<int>(random() % 5) - 2;
+        const int dy = static_cast<int>(random() % 5) - 2;
+
+        checkCoverage(lhs.merge(rhs, dx, dy), lhs, rhs, dx, dy, 0);
+        checkCoverage(lhs.intersect(rhs, dx, dy), lhs, rhs, dx, dy, 1);
+        checkCoverage(lhs.subtract(rhs, dx, dy), lhs, rhs, dx, dy, 2);
+        checkCoverage(lhs.mergeExclusive(rhs, dx, dy), lhs, rhs, dx, dy, 3);
+
+        if (rhs.isRect()) {
+            const Rect rect = rhs.getBounds();
+            checkCoverage(Region(lhs).orSelf(rect), lhs, rhs, 0, 0, 0);
+            checkCoverage(Region(lhs).andSelf(rect), lhs, rhs, 0, 0, 1);
+            checkCoverage(Region(lhs).subtractSelf(rect), lhs, rhs, 0, 0, 2);
+            checkCoverage(Region(lhs).xorSelf(rect), lhs, rhs, 0, 0, 3);
+        }
+    }
+}
+
+TEST_F(RegionTest, Translate_CopiesAndOffsetsRects) {
+    Region region;
+    // Enough rects to spill out of the inline storage.
+    for (int i = 0; i < 12; i++) {
+        region.orSelf(Rect(i * 10, i * 10, i * 10 + 5, i * 10 + 5));
+    }
+
+    Region expected(region);
+    expected.translateSelf(3, -7);
+
+    const Region translated = region.translate(3, -7);
+    EXPECT_TRUE(translated.hasSameRects(expected));
+    EXPECT_EQ(expected.getBounds(), translated.getBounds());
+
+    Region copy(region);
+    EXPECT_TRUE(copy.hasSameRects(region));
+    copy = Region(Rect(0, 0, 1, 1));
+    copy = region;
+    EXPECT_TRUE(copy.hasSameRects(region));
+}
+
 }; // namespace android
 
@@ -18,6 +18,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+
 namespace android::ui {
 
 TEST(TransformTest, inverseRotation_hasCorrectType) {
@@ -46,4 +48,49 @@ TEST(TransformTest, inverseRotation_hasCorrectType) {
     testRotationFlagsForInverse(Transform::FLIP_V, Transform::FLIP_V, false);
 }
 
+TEST(TransformTest, translationsCompose) {
+    Transform a;
+    a.set(10.f, 20.f);
+    Transform b;
+    b.set(-10.f, 5.f);
+
+    const Transform ab = a * b;
+    EXPECT_EQ(Transform::TRANSLATE, ab.getType());
+    EXPECT_EQ(0.f, ab.tx());
+    EXPECT_EQ(25.f, ab.ty());
+
+    Transform c;
+    c.set(0.f, -25.f);
+    EXPECT_EQ(Transform::IDENTITY, (ab * c).getType());
+}
+
+TEST(TransformTest, transformRectMatchesCorners) {
+    const auto expectCornerBounds = [](const Transform& t, const FloatRect& in) {
+        const vec2 corners[] = {t.transform(in.left, in.top), t.transform(in.right, in.top),
+                                t.transform(in.left, in.bottom),
+                                t.transform(in.right, in.bottom)};
+        FloatRect expected{corners[0].x, corners[0].y, corners[0].x, corners[0].y};
+        for (const vec2& corner : corners) {
+            expected.left = std::min(expected.left, corner.x);
+            expected.top = std::min(expected.top, corner.y);
+            expected.right = std::max(expected.right, corner.x);
+            expected.bottom = std::max(expected.bottom, corner.y);
+        }
+        EXPECT_EQ(expected, t.transform(in));
+    };
+
+    const FloatRect rect{10.f, 20.f, 110.f, 70.f};
+    for (uint32_t flags : {Transform::ROT_0, Transform::FLIP_H, Transform::FLIP_V,
+                           Transform::ROT_90, Transform::ROT_180, Transform::ROT_270}) {
+        Transform t(flags, 1920, 1080);
+        expectCornerBounds(t, rect);
+        t.set(2.f, 0.f, 0.f, 0.5f);
+        expectCornerBounds(t, rect);
+    }
+
+    Transform skew;
+    skew.set(1.f, 0.5f, 0.25f, 1.f);
+    expectCornerBounds(skew, rect);
+}
+
 } // namespace android::ui
@@ -19,6 +19,8 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include <vector>
+
 #include <ui/ColorSpace.h>
 
 #include <gtest/gtest.h>
@@ -165,6 +167,59 @@ TEST_F(ColorSpaceTest, Connect) {
     EXPECT_TRUE(all(lessThan(abs(r - float3{0.70226f, 0.2757f, 0.1036f}), float3{1e-4f})));
 }
 
+TEST_F(ColorSpaceTest, ConnectBatch) {
+    const ColorSpace spaces[] = {
+        ColorSpace::sRGB(), ColorSpace::linearSRGB(), ColorSpace::extendedSRGB(),
+        ColorSpace::linearExtendedSRGB(), ColorSpace::BT2020(), ColorSpace::AdobeRGB(),
+        ColorSpace::ProPhotoRGB(), ColorSpace::DisplayP3(), ColorSpace::ACES(),
+    };
+
+    // Enough values to span several blocks, including values outside of [0, 1].
+    std::vector<float3> values;
+    for (int i = 0; i < 1000; i++) {
+        values.push_back(float3{i / 999.0f, (i % 100) / 50.0f - 0.5f, 1.0f - i / 999.0f});
+    }
+
+    for (const auto& src : spaces) {
+        for (const auto& dst : spaces) {
+            ColorSpaceConnector connector(src, dst);
+
+            std::vector<float3> batch(values.size());
+            connector.transform(values.data(), batch.data(), values.size());
+
+            for (size_t i = 0; i < values.size(); i++) {
+                const float3 expected = connector.transform(values[i]);
+                EXPECT_TRUE(all(lessThanEqual(abs(batch[i] - expected), float3{1e-6f})))
+                        << src.getName() << " -> " << dst.getName() << " at " << i;
+            }
+        }
+    }
+}
+
+TEST_F(ColorSpaceTest, TransferFunctionsBatch) {
+    const ColorSpace spaces[] = {
+        ColorSpace::sRGB(), ColorSpace::linearSRGB(), ColorSpace::extendedSRGB(),
+        ColorSpace::AdobeRGB(), ColorSpace::ProPhotoRGB(),
+    };
+
+    for (const auto& space : spaces) {
+        std::vector<float3> values;
+        for (int i = 0; i < 100; i++) {
+            values.push_back(float3{i / 99.0f, i / 198.0f, 1.0f - i / 99.0f});
+        }
+
+        std::vector<float3> linear(values);
+        space.toLinear(linear.data(), linear.size());
+        std::vector<float3> encoded(linear);
+        space.fromLinear(encoded.data(), encoded.size());
+
+        for (size_t i = 0; i < values.size(); i++) {
+            EXPECT_EQ(space.toLinear(values[i]), linear[i]) << space.getName();
+            EXPECT_EQ(space.fromLinear(linear[i]), encoded[i]) << space.getName();
+        }
+    }
+}
+
 TEST_F(ColorSpaceTest, LUT) {
     auto lut = ColorSpace::createLUT(17, ColorSpace::sRGB(), ColorSpace::AdobeRGB());
     EXPECT_TRUE(lut != nullptr);
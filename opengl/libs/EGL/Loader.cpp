@@ -450,6 +450,26 @@ void Loader::init_api(void* dso,
     }
 }
 
+void Loader::copy_api(char const * const * api,
+        char const * const * ref_api,
+        __eglMustCastToProperFunctionPointerType const* src,
+        __eglMustCastToProperFunctionPointerType* curr)
+{
+    ATRACE_CALL();
+
+    // Same walk as init_api, with the lookup replaced by the already resolved ref_api entry
+    while (*api) {
+        if (std::strcmp(*api, *ref_api) != 0) {
+            *curr++ = nullptr;
+        } else {
+            *curr++ = *src;
+            api++;
+        }
+        src++;
+        ref_api++;
+    }
+}
+
 static std::string findLibrary(const std::string libraryName, const std::string searchPath,
                                const bool exact) {
     if (exact) {
@@ -723,17 +743,26 @@ void Loader::initialize_api(void* dso, egl_connection_t* cnx, uint32_t mask) {
         }
     }
 
-    if (mask & GLESv1_CM) {
-        init_api(dso, gl_names_1, gl_names,
+    if (mask & GLESv2) {
+        init_api(dso, gl_names, nullptr,
             (__eglMustCastToProperFunctionPointerType*)
-                &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
+                &cnx->hooks[egl_connection_t::GLESv2_INDEX]->gl,
             getProcAddress);
     }
 
-    if (mask & GLESv2) {
-        init_api(dso, gl_names, nullptr,
+    if ((mask & GLESv1_CM) && (mask & GLESv2)) {
+        // Both tables come from the same library, and GLESv1 entry points are a subset of the
+        // GLESv2 ones in the same layout, so reuse what was just resolved instead of looking
+        // every name up again.
+        copy_api(gl_names_1, gl_names,
             (__eglMustCastToProperFunctionPointerType*)
                 &cnx->hooks[egl_connection_t::GLESv2_INDEX]->gl,
+            (__eglMustCastToProperFunctionPointerType*)
+                &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl);
+    } else if (mask & GLESv1_CM) {
+        init_api(dso, gl_names_1, gl_names,
+            (__eglMustCastToProperFunctionPointerType*)
+                &cnx->hooks[egl_connection_t::GLESv1_INDEX]->gl,
             getProcAddress);
     }
 }
@@ -63,6 +63,9 @@ private:
                                                    const char* const* ref_api,
                                                    __eglMustCastToProperFunctionPointerType* curr,
                                                    getProcAddressType getProcAddress);
+    static void copy_api(const char* const* api, const char* const* ref_api,
+                         __eglMustCastToProperFunctionPointerType const* src,
+                         __eglMustCastToProperFunctionPointerType* curr);
 };
 
 }; // namespace android
@@ -133,14 +133,17 @@ MultifileBlobCache::MultifileBlobCache(size_t maxKeySize, size_t maxValueSize, s
         }
     }
 
-    if (statusGood) {
+    if (statusGood && loadIndex()) {
+        ALOGV("INIT: Loaded %zu entries from the cache index", mTotalCacheEntries);
+    } else if (statusGood) {
         // Read all the files and gather details, then preload their contents
         DIR* dir;
         struct dirent* entry;
         if ((dir = opendir(mMultifileDirName.c_str())) != nullptr) {
             while ((entry = readdir(dir)) != nullptr) {
                 if (entry->d_name == "."s || entry->d_name == ".."s ||
-                    strcmp(entry->d_name, kMultifileBlobCacheStatusFile) == 0) {
+                    strcmp(entry->d_name, kMultifileBlobCacheStatusFile) == 0 ||
+                    strcmp(entry->d_name, kMultifileBlobCacheIndexFile) == 0) {
                     continue;
                 }
 
@@ -508,6 +511,11 @@ void MultifileBlobCache::finish() {
     ALOGV("FINISH: Waiting for work to complete.");
     waitForWorkComplete();
 
+    // Now that every entry is on disk, record them so the next INIT can skip the directory scan
+    ALOGV("FINISH: Writing cache index.");
+    queueIndexWrite();
+    waitForWorkComplete();
+
     // Close all entries in the hot cache
     for (auto hotCacheIter = mHotCache.begin(); hotCacheIter != mHotCache.end();) {
         uint32_t entryHash = hotCacheIter->first;
@@ -626,6 +634,108 @@ bool MultifileBlobCache::checkStatus(const std::string& baseDir) {
     return true;
 }
 
+bool MultifileBlobCache::loadIndex() {
+    std::string indexPath = mMultifileDirName + "/" + kMultifileBlobCacheIndexFile;
+
+    int fd = open(indexPath.c_str(), O_RDONLY);
+    if (fd == -1) {
+        ALOGV("INDEX(LOAD): No index file (%s), scanning entries", indexPath.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(MultifileIndexHeader))) {
+        ALOGE("INDEX(LOAD): Index file (%s) has invalid stats!", indexPath.c_str());
+        close(fd);
+        remove(indexPath.c_str());
+        return false;
+    }
+
+    // Note: Converting from off_t (signed) to size_t (unsigned)
+    size_t indexSize = static_cast<size_t>(st.st_size);
+    uint8_t* mappedIndex =
+            reinterpret_cast<uint8_t*>(mmap(nullptr, indexSize, PROT_READ, MAP_PRIVATE, fd, 0));
+
+    // We can close the file now and the mmap will remain
+    close(fd);
+
+    // The index only describes the entries present when it was written, so consume it now and
+    // write a new one on FINISH. If we crash before then, the next INIT falls back to scanning.
+    if (remove(indexPath.c_str()) != 0) {
+        ALOGE("INDEX(LOAD): Error removing %s: %s", indexPath.c_str(), std::strerror(errno));
+        if (mappedIndex != MAP_FAILED) {
+            munmap(mappedIndex, indexSize);
+        }
+        return false;
+    }
+
+    if (mappedIndex == MAP_FAILED) {
+        ALOGE("INDEX(LOAD): Failed to mmap index, error: %s", std::strerror(errno));
+        return false;
+    }
+
+    const MultifileIndexHeader* header = reinterpret_cast<const MultifileIndexHeader*>(mappedIndex);
+    const MultifileIndexEntry* entries =
+            reinterpret_cast<const MultifileIndexEntry*>(mappedIndex + sizeof(MultifileIndexHeader));
+
+    bool valid = header->magic == kMultifileMagic && header->cacheVersion == mCacheVersion &&
+            indexSize ==
+                    sizeof(MultifileIndexHeader) +
+                            static_cast<uint64_t>(header->entryCount) *
+                                    sizeof(MultifileIndexEntry) &&
+            header->crc ==
+                    crc32c(mappedIndex + offsetof(MultifileIndexHeader, cacheVersion),
+                           indexSize - offsetof(MultifileIndexHeader, cacheVersion));
+    for (uint32_t i = 0; valid && i < header->entryCount; i++) {
+        const MultifileIndexEntry& entry = entries[i];
+        valid = entry.valueSize > 0 && entry.fileSize > sizeof(MultifileHeader) &&
+                entry.accessTime > 0;
+    }
+    if (!valid) {
+        ALOGE("INDEX(LOAD): Index file (%s) is damaged, scanning entries", indexPath.c_str());
+        munmap(mappedIndex, indexSize);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        const MultifileIndexEntry& entry = entries[i];
+        ALOGV("INDEX(LOAD): Tracking entry %u", entry.entryHash);
+        trackEntry(entry.entryHash, entry.valueSize, entry.fileSize, entry.accessTime);
+        increaseTotalCacheSize(entry.fileSize);
+    }
+
+    munmap(mappedIndex, indexSize);
+    return true;
+}
+
+void MultifileBlobCache::queueIndexWrite() {
+    size_t indexSize =
+            sizeof(MultifileIndexHeader) + mEntryStats.size() * sizeof(MultifileIndexEntry);
+    uint8_t* buffer = new uint8_t[indexSize];
+
+    // Zero everything, including struct padding, so the CRC is stable
+    memset(buffer, 0, indexSize);
+    MultifileIndexHeader* header = reinterpret_cast<MultifileIndexHeader*>(buffer);
+    header->magic = kMultifileMagic;
+    header->crc = kCrcPlaceholder;
+    header->cacheVersion = mCacheVersion;
+    header->entryCount = static_cast<uint32_t>(mEntryStats.size());
+
+    MultifileIndexEntry* entry =
+            reinterpret_cast<MultifileIndexEntry*>(buffer + sizeof(MultifileIndexHeader));
+    for (const auto& [entryHash, entryStats] : mEntryStats) {
+        entry->entryHash = entryHash;
+        entry->valueSize = entryStats.valueSize;
+        entry->fileSize = entryStats.fileSize;
+        entry->accessTime = entryStats.accessTime;
+        entry++;
+    }
+
+    DeferredTask task(TaskCommand::WriteIndex);
+    task.initWriteIndex(mMultifileDirName + "/" + kMultifileBlobCacheIndexFile, buffer, indexSize);
+    queueTask(std::move(task));
+}
+
 void MultifileBlobCache::trackEntry(uint32_t entryHash, EGLsizeiANDROID valueSize, size_t fileSize,
                                     time_t accessTime) {
     mEntries.insert(entryHash);
@@ -814,7 +924,7 @@ void MultifileBlobCache::trimCache() {
     }
 }
 
-// This function performs a task.  It only knows how to write files to disk,
+// This function performs a task.  It knows how to write entries and the index to disk,
 // but it could be expanded if needed.
 void MultifileBlobCache::processTask(DeferredTask& task) {
     switch (task.getTaskCommand()) {
@@ -872,6 +982,46 @@ void MultifileBlobCache::processTask(DeferredTask& task) {
 
             return;
         }
+        case TaskCommand::WriteIndex: {
+            std::string& fullPath = task.getFullPath();
+            uint8_t* buffer = task.getBuffer();
+            size_t bufferSize = task.getBufferSize();
+
+            // Add CRC check to the header (always do this last!)
+            MultifileIndexHeader* header = reinterpret_cast<MultifileIndexHeader*>(buffer);
+            header->crc = crc32c(buffer + offsetof(MultifileIndexHeader, cacheVersion),
+                                 bufferSize - offsetof(MultifileIndexHeader, cacheVersion));
+
+            // Write to a temporary file and rename it, so INIT never sees a partial index
+            std::string tempPath = fullPath + ".tmp";
+            int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+            if (fd == -1) {
+                ALOGE("Cache error in FINISH - failed to open index: %s, error: %s",
+                      tempPath.c_str(), std::strerror(errno));
+                delete[] buffer;
+                return;
+            }
+
+            ssize_t result = write(fd, buffer, bufferSize);
+            close(fd);
+            delete[] buffer;
+            if (result != bufferSize) {
+                ALOGE("Error writing cache index (%s): %s", tempPath.c_str(),
+                      std::strerror(errno));
+                remove(tempPath.c_str());
+                return;
+            }
+
+            if (rename(tempPath.c_str(), fullPath.c_str()) != 0) {
+                ALOGE("Error renaming cache index to %s: %s", fullPath.c_str(),
+                      std::strerror(errno));
+                remove(tempPath.c_str());
+                return;
+            }
+
+            ALOGV("DEFERRED: Completed index write for: %s", fullPath.c_str());
+            return;
+        }
         default: {
             ALOGE("DEFERRED: Unhandled task type");
             return;
@@ -36,6 +36,7 @@ namespace android {
 
 constexpr uint32_t kMultifileBlobCacheVersion = 1;
 constexpr char kMultifileBlobCacheStatusFile[] = "cache.status";
+constexpr char kMultifileBlobCacheIndexFile[] = "cache.index";
 
 struct MultifileHeader {
     uint32_t magic;
@@ -57,6 +58,23 @@ struct MultifileStatus {
     char buildId[PROP_VALUE_MAX];
 };
 
+// The index file records the stats of every entry when the cache is closed, so the next
+// initialization can skip opening and checking each entry file. It holds a MultifileIndexHeader
+// followed by entryCount MultifileIndexEntry records.
+struct MultifileIndexHeader {
+    uint32_t magic;
+    uint32_t crc;
+    uint32_t cacheVersion;
+    uint32_t entryCount;
+};
+
+struct MultifileIndexEntry {
+    uint32_t entryHash;
+    EGLsizeiANDROID valueSize;
+    size_t fileSize;
+    time_t accessTime;
+};
+
 struct MultifileHotCache {
     int entryFd;
     uint8_t* entryBuffer;
@@ -66,6 +84,7 @@ struct MultifileHotCache {
 enum class TaskCommand {
     Invalid = 0,
     WriteToDisk,
+    WriteIndex,
     Exit,
 };
 
@@ -85,6 +104,13 @@ public:
         mBufferSize = bufferSize;
     }
 
+    void initWriteIndex(std::string fullPath, uint8_t* buffer, size_t bufferSize) {
+        mCommand = TaskCommand::WriteIndex;
+        mFullPath = std::move(fullPath);
+        mBuffer = buffer;
+        mBufferSize = bufferSize;
+    }
+
     uint32_t getEntryHash() { return mEntryHash; }
     std::string& getFullPath() { return mFullPath; }
     uint8_t* getBuffer() { return mBuffer; }
@@ -93,7 +119,7 @@ public:
 private:
     TaskCommand mCommand;
 
-    // Parameters for WriteToDisk
+    // Parameters for WriteToDisk and WriteIndex
     uint32_t mEntryHash;
     std::string mFullPath;
     uint8_t* mBuffer;
@@ -132,6 +158,12 @@ private:
     bool createStatus(const std::string& baseDir);
     bool checkStatus(const std::string& baseDir);
 
+    // Track all entries listed in the index file, consuming it. Returns false if there is no
+    // usable index, in which case the directory must be scanned instead.
+    bool loadIndex();
+    // Queue a write of the index file describing the current entries.
+    void queueIndexWrite();
+
     size_t getFileSize(uint32_t entryHash);
     size_t getValueSize(uint32_t entryHash);
 
@@ -322,7 +322,8 @@ std::vector<std::string> MultifileBlobCacheTest::getCacheEntries() {
                 if (entry->d_name == "."s || entry->d_name == ".."s) {
                     continue;
                 }
-                if (strcmp(entry->d_name, kMultifileBlobCacheStatusFile) == 0) {
+                if (strcmp(entry->d_name, kMultifileBlobCacheStatusFile) == 0 ||
+                    strcmp(entry->d_name, kMultifileBlobCacheIndexFile) == 0) {
                     continue;
                 }
                 cacheEntries.push_back(multifileDirName + "/" + entry->d_name);
@@ -503,4 +504,71 @@ TEST_F(MultifileBlobCacheTest, MismatchedBuildIdClears) {
     ASSERT_EQ(getCacheEntries().size(), 0);
 }
 
+// Verify the index written on finish is used, and consumed, by the next initialization
+TEST_F(MultifileBlobCacheTest, CacheIndexLoadsEntries) {
+    // Set two entries
+    mMBC->set("abcd", 4, "efgh", 4);
+    mMBC->set("ijkl", 4, "mnop", 4);
+
+    // Close the cache so everything writes out
+    mMBC->finish();
+    mMBC.reset();
+
+    // Ensure the index was written alongside the entries
+    std::stringstream indexFile;
+    indexFile << &mTempFile->path[0] << ".multifile/" << kMultifileBlobCacheIndexFile;
+    struct stat info;
+    ASSERT_EQ(stat(indexFile.str().c_str(), &info), 0);
+    ASSERT_EQ(info.st_size, sizeof(MultifileIndexHeader) + 2 * sizeof(MultifileIndexEntry));
+    ASSERT_EQ(getCacheEntries().size(), 2);
+
+    // Open the cache again, which consumes the index
+    mMBC.reset(new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, kMaxTotalEntries,
+                                      &mTempFile->path[0]));
+    ASSERT_NE(stat(indexFile.str().c_str(), &info), 0);
+
+    // Ensure both entries are still available
+    unsigned char buf[4] = {0xee, 0xee, 0xee, 0xee};
+    ASSERT_EQ(size_t(4), mMBC->get("abcd", 4, buf, 4));
+    ASSERT_EQ('e', buf[0]);
+    ASSERT_EQ('f', buf[1]);
+    ASSERT_EQ('g', buf[2]);
+    ASSERT_EQ('h', buf[3]);
+    ASSERT_EQ(size_t(4), mMBC->get("ijkl", 4, buf, 4));
+    ASSERT_EQ('m', buf[0]);
+    ASSERT_EQ('n', buf[1]);
+    ASSERT_EQ('o', buf[2]);
+    ASSERT_EQ('p', buf[3]);
+}
+
+// Verify a damaged index falls back to scanning the entries
+TEST_F(MultifileBlobCacheTest, ModifiedCacheIndexScansEntries) {
+    // Set one entry
+    mMBC->set("abcd", 4, "efgh", 4);
+
+    // Close the cache so everything writes out
+    mMBC->finish();
+    mMBC.reset();
+
+    // Corrupt the entry count at the end of the index header
+    std::stringstream indexFile;
+    indexFile << &mTempFile->path[0] << ".multifile/" << kMultifileBlobCacheIndexFile;
+    std::fstream fs(indexFile.str());
+    fs.seekp(offsetof(MultifileIndexHeader, entryCount), std::ios_base::beg);
+    fs << "X";
+    fs.close();
+
+    // Open the cache again and ensure the entry is still found
+    mMBC.reset(new MultifileBlobCache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, kMaxTotalEntries,
+                                      &mTempFile->path[0]));
+
+    unsigned char buf[4] = {0xee, 0xee, 0xee, 0xee};
+    ASSERT_EQ(size_t(4), mMBC->get("abcd", 4, buf, 4));
+    ASSERT_EQ('e', buf[0]);
+    ASSERT_EQ('f', buf[1]);
+    ASSERT_EQ('g', buf[2]);
+    ASSERT_EQ('h', buf[3]);
+    ASSERT_EQ(getCacheEntries().size(), 1);
+}
+
 } // namespace android
@@ -43,6 +43,10 @@ constexpr uint32_t kMaxMultifileValueSize = 8 * 1024 * 1024;
 constexpr uint32_t kMaxMultifileTotalSize = 32 * 1024 * 1024;
 constexpr uint32_t kMaxMultifileTotalEntries = 4 * 1024;
 
+// Shared read-only cache size limit. The shared cache is populated by a privileged service and
+// uses the multifile key and value limits, since it serves the same drivers.
+constexpr uint32_t kMaxSharedTotalSize = 16 * 1024 * 1024;
+
 namespace android {
 
 #define BC_EXT_STR "EGL_ANDROID_blob_cache"
@@ -69,7 +73,10 @@ static EGLsizeiANDROID getBlob(const void* key, EGLsizeiANDROID keySize, void* v
 // egl_cache_t definition
 //
 egl_cache_t::egl_cache_t()
-      : mInitialized(false), mMultifileMode(false), mCacheByteLimit(kMaxMonolithicTotalSize) {}
+      : mInitialized(false),
+        mMultifileMode(false),
+        mCacheByteLimit(kMaxMonolithicTotalSize),
+        mSharedCacheByteLimit(kMaxSharedTotalSize) {}
 
 egl_cache_t::~egl_cache_t() {}
 
@@ -125,6 +132,8 @@ void egl_cache_t::terminate() {
         mMultifileBlobCache->finish();
     }
     mMultifileBlobCache = nullptr;
+    // The shared cache is read-only, so there is nothing to write out
+    mSharedBlobCache = nullptr;
     mInitialized = false;
 }
 
@@ -175,6 +184,15 @@ EGLsizeiANDROID egl_cache_t::getBlob(const void* key, EGLsizeiANDROID keySize, v
     updateMode();
 
     if (mInitialized) {
+        // Entries common to many apps may already be in the shared cache, so check it first
+        BlobCache* sbc = getSharedBlobCacheLocked();
+        if (sbc) {
+            EGLsizeiANDROID sharedSize = sbc->get(key, keySize, value, valueSize);
+            if (sharedSize > 0) {
+                return sharedSize;
+            }
+        }
+
         if (mMultifileMode) {
             MultifileBlobCache* mbc = getMultifileBlobCacheLocked();
             return mbc->get(key, keySize, value, valueSize);
@@ -264,6 +282,22 @@ void egl_cache_t::updateMode() {
 
         ALOGV("Using multifile EGL blobcache limit of %zu bytes", mCacheByteLimit);
     }
+
+    // Check for a shared read-only cache, allowing it to be overridden for debug purposes
+    mSharedFilename = base::GetProperty("ro.egl.blobcache.shared_file", "");
+    std::string debugSharedFilename = base::GetProperty("debug.egl.blobcache.shared_file", "");
+    if (!debugSharedFilename.empty()) {
+        ALOGV("Overriding shared cache %s with %s from debug.egl.blobcache.shared_file",
+              mSharedFilename.c_str(), debugSharedFilename.c_str());
+        mSharedFilename = debugSharedFilename == "none" ? "" : debugSharedFilename;
+    }
+    if (!mSharedFilename.empty()) {
+        mSharedCacheByteLimit = static_cast<size_t>(
+                base::GetUintProperty<uint32_t>("ro.egl.blobcache.shared_limit",
+                                                kMaxSharedTotalSize));
+        ALOGV("Using shared EGL blobcache %s with limit of %zu bytes", mSharedFilename.c_str(),
+              mSharedCacheByteLimit);
+    }
 }
 
 BlobCache* egl_cache_t::getBlobCacheLocked() {
@@ -274,6 +308,17 @@ BlobCache* egl_cache_t::getBlobCacheLocked() {
     return mBlobCache.get();
 }
 
+BlobCache* egl_cache_t::getSharedBlobCacheLocked() {
+    if (mSharedFilename.empty()) {
+        return nullptr;
+    }
+    if (mSharedBlobCache == nullptr) {
+        mSharedBlobCache.reset(new FileBlobCache(kMaxMultifileKeySize, kMaxMultifileValueSize,
+                                                 mSharedCacheByteLimit, mSharedFilename));
+    }
+    return mSharedBlobCache.get();
+}
+
 MultifileBlobCache* egl_cache_t::getMultifileBlobCacheLocked() {
     if (mMultifileBlobCache == nullptr) {
         mMultifileBlobCache.reset(new MultifileBlobCache(kMaxMultifileKeySize,
@@ -100,6 +100,10 @@ private:
     // Get or create the multifile blobcache
     MultifileBlobCache* getMultifileBlobCacheLocked();
 
+    // Get or load the shared read-only blobcache. Returns nullptr if no shared cache is
+    // configured.
+    BlobCache* getSharedBlobCacheLocked();
+
     // mInitialized indicates whether the egl_cache_t is in the initialized
     // state.  It is initialized to false at construction time, and gets set to
     // true when initialize is called.  It is set back to false when terminate
@@ -116,6 +120,16 @@ private:
     // The multifile version of blobcache allowing larger contents to be stored
     std::unique_ptr<MultifileBlobCache> mMultifileBlobCache;
 
+    // mSharedBlobCache is a read-only cache shared by all apps, consulted before the per-app
+    // cache. It is populated by a privileged service from entries commonly seen across apps, and
+    // is never written to file from here. Its contents are dropped on load if they were created
+    // on a different build.
+    std::unique_ptr<FileBlobCache> mSharedBlobCache;
+
+    // mSharedFilename is the file the shared cache is loaded from. An empty string indicates that
+    // no shared cache is used.
+    std::string mSharedFilename;
+
     // mFilename is the name of the file for storing cache contents in between
     // program invocations.  It is initialized to an empty string at
     // construction time, and can be set with the setCacheFilename method.  An
@@ -142,6 +156,9 @@ private:
 
     // Cache limit
     size_t mCacheByteLimit;
+
+    // Shared cache limit
+    size_t mSharedCacheByteLimit;
 };
 
 }; // namespace android
@@ -99,6 +99,8 @@ void GpuMem::dump(const Vector<String16>& /* args */, std::string* result) {
     uint64_t key = res.value();
     // unordered_map<gpu_id, vector<pair<pid, size>>>
     std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, uint64_t>>> dumpMap;
+    std::vector<std::pair<uint64_t, uint64_t>> changes;
+    std::unique_lock<std::mutex> lock(mLock);
     while (true) {
         uint32_t gpu_id = key >> 32;
         uint32_t pid = key;
@@ -108,11 +110,14 @@ void GpuMem::dump(const Vector<String16>& /* args */, std::string* result) {
         uint64_t size = res.value();
 
         dumpMap[gpu_id].emplace_back(pid, size);
+        noteSizeLocked(gpu_id, pid, size, &changes);
 
         res = mGpuMemTotalMap.getNextKey(key);
         if (!res.ok()) break;
         key = res.value();
     }
+    lock.unlock();
+    notifySizeChanges(changes);
 
     for (auto& gpu : dumpMap) {
         if (gpu.second.empty()) continue;
@@ -140,6 +145,7 @@ void GpuMem::traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t
     auto res = mGpuMemTotalMap.getFirstKey();
     if (!res.ok()) return;
     uint64_t key = res.value();
+    std::vector<std::pair<uint64_t, uint64_t>> changes;
     while (true) {
         uint32_t gpu_id = key >> 32;
         uint32_t pid = key;
@@ -148,11 +154,81 @@ void GpuMem::traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t
         if (!res.ok()) break;
         uint64_t size = res.value();
 
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            noteSizeLocked(gpu_id, pid, size, &changes);
+        }
         callback(systemTime(), gpu_id, pid, size);
         res = mGpuMemTotalMap.getNextKey(key);
         if (!res.ok()) break;
         key = res.value();
     }
+    notifySizeChanges(changes);
+}
+
+bool GpuMem::getGpuMemTotalForPid(uint32_t pid, uint64_t* size) {
+    if (!mInitialized.load() || !mGpuMemTotalMap.isValid()) return false;
+
+    std::unique_lock<std::mutex> lock(mLock);
+    if (mGpuIds.empty()) {
+        // No traversal has happened yet, so learn the gpu ids once. The map is keyed by
+        // (gpu_id << 32 | pid), and new gpus do not appear after the driver has loaded.
+        lock.unlock();
+        traverseGpuMemTotals([](int64_t, uint32_t, uint32_t, uint64_t) {});
+        lock.lock();
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> changes;
+    bool found = false;
+    uint64_t total = 0;
+    for (uint32_t gpuId : mGpuIds) {
+        auto res = mGpuMemTotalMap.readValue(((uint64_t)gpuId << 32) | pid);
+        if (!res.ok()) continue;
+        found = true;
+        total += res.value();
+        noteSizeLocked(gpuId, pid, res.value(), &changes);
+    }
+    lock.unlock();
+    notifySizeChanges(changes);
+
+    if (found) *size = total;
+    return found;
+}
+
+void GpuMem::setSizeChangeCallback(uint64_t thresholdBytes, SizeChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(mLock);
+    mSizeChangeThreshold = thresholdBytes;
+    mSizeChangeCallback = std::move(callback);
+    mLastReportedSizes.clear();
+}
+
+void GpuMem::noteSizeLocked(uint32_t gpuId, uint32_t pid, uint64_t size,
+                            std::vector<std::pair<uint64_t, uint64_t>>* changes) {
+    mGpuIds.insert(gpuId);
+    if (!mSizeChangeCallback) return;
+
+    const uint64_t key = ((uint64_t)gpuId << 32) | pid;
+    auto [it, inserted] = mLastReportedSizes.try_emplace(key, size);
+    const uint64_t last = it->second;
+    const uint64_t delta = size > last ? size - last : last - size;
+    if (inserted || delta >= mSizeChangeThreshold) {
+        it->second = size;
+        changes->emplace_back(key, size);
+    }
+}
+
+void GpuMem::notifySizeChanges(const std::vector<std::pair<uint64_t, uint64_t>>& changes) {
+    if (changes.empty()) return;
+
+    SizeChangeCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        callback = mSizeChangeCallback;
+    }
+    if (!callback) return;
+    for (const auto& [key, size] : changes) {
+        callback(key >> 32, (uint32_t)key, size);
+    }
 }
 
 } // namespace android
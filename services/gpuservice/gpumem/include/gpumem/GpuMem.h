@@ -21,6 +21,10 @@
 #include <utils/Vector.h>
 
 #include <functional>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace android {
 
@@ -40,6 +44,17 @@ public:
     void traverseGpuMemTotals(const std::function<void(int64_t ts, uint32_t gpuId, uint32_t pid,
                                                        uint64_t size)>& callback);
 
+    // Sum of the gpu memory attributed to pid across all gpus. This is a point lookup per known
+    // gpu rather than a full map traversal, so it is cheap enough to poll. Returns false if the
+    // map is not available or pid has no entry on any gpu.
+    bool getGpuMemTotalForPid(uint32_t pid, uint64_t* size);
+
+    using SizeChangeCallback = std::function<void(uint32_t gpuId, uint32_t pid, uint64_t size)>;
+    // Register a callback invoked whenever a size read through this class differs from the
+    // last reported size for that gpu/pid by at least thresholdBytes. The first size seen for
+    // each gpu/pid is always reported. Pass an empty callback to unregister.
+    void setSizeChangeCallback(uint64_t thresholdBytes, SizeChangeCallback callback);
+
 private:
     // Friend class for testing.
     friend class TestableGpuMem;
@@ -47,6 +62,12 @@ private:
     // set gpu memory total map
     void setGpuMemTotalMap(bpf::BpfMapRO<uint64_t, uint64_t>& map);
 
+    // Record a size read from the map, and queue a notification if it moved past the threshold.
+    void noteSizeLocked(uint32_t gpuId, uint32_t pid, uint64_t size,
+                        std::vector<std::pair<uint64_t, uint64_t>>* changes);
+    // Deliver notifications queued by noteSizeLocked, without holding mLock.
+    void notifySizeChanges(const std::vector<std::pair<uint64_t, uint64_t>>& changes);
+
     // indicate whether ebpf has been initialized
     std::atomic<bool> mInitialized = false;
 
@@ -56,6 +77,14 @@ private:
     // bpf map for GPU memory total data
     android::bpf::BpfMapRO<uint64_t, uint64_t> mGpuMemTotalMap;
 
+    std::mutex mLock;
+    // gpu ids seen in the map so far, used for per-pid point lookups
+    std::set<uint32_t> mGpuIds;
+    // last size reported through the change callback, keyed like the bpf map
+    std::unordered_map<uint64_t, uint64_t> mLastReportedSizes;
+    SizeChangeCallback mSizeChangeCallback;
+    uint64_t mSizeChangeThreshold = 0;
+
     // gpu memory tracepoint event category
     static constexpr char kGpuMemTraceGroup[] = "gpu_mem";
     // gpu memory total tracepoint
@@ -136,7 +136,7 @@ void GpuWork::initialize() {
             return;
         }
 
-        mPreviousMapClearTimePoint = std::chrono::steady_clock::now();
+        mAccumulationStartTimePoint = std::chrono::steady_clock::now();
     }
 
     // Attach the tracepoint.
@@ -146,7 +146,7 @@ void GpuWork::initialize() {
     }
 
     // Create the map clearer thread, and store it to |mMapClearerThread|.
-    std::thread thread([this]() { periodicallyClearMap(); });
+    std::thread thread([this]() { periodicallyDrainMap(); });
 
     mMapClearerThread.swap(thread);
 
@@ -271,33 +271,34 @@ AStatsManager_PullAtomCallbackReturn GpuWork::pullWorkAtoms(AStatsEventList* dat
         return AStatsManager_PULL_SKIP;
     }
 
-    std::lock_guard<std::mutex> lock(mMutex);
-
-    if (!mGpuWorkMap.isValid()) {
-        return AStatsManager_PULL_SKIP;
-    }
-
     std::unordered_map<GpuIdUid, UidTrackingInfo, decltype(hashGpuIdUid)*, decltype(equalGpuIdUid)*>
             workMap(32, &hashGpuIdUid, &equalGpuIdUid);
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point accumulationStartTimePoint;
 
-    // Iteration of BPF hash maps can be unreliable (no data races, but elements
-    // may be repeated), as the map is typically being modified by other
-    // threads. The buckets are all preallocated. Our eBPF program only updates
-    // entries (in-place) or adds entries. |GpuWork| only iterates or clears the
-    // map while holding |mMutex|. Given this, we should be able to iterate over
-    // all elements reliably. Nevertheless, we copy into a map to avoid
-    // duplicates.
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
 
-    // Note that userspace reads of BPF maps make a copy of the value, and thus
-    // the returned value is not being concurrently accessed by the BPF program
-    // (no atomic reads needed below).
+        if (!mGpuWorkMap.isValid()) {
+            return AStatsManager_PULL_SKIP;
+        }
 
-    mGpuWorkMap.iterateWithValue([&workMap](const GpuIdUid& key, const UidTrackingInfo& value,
-                                            const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
-                                         -> base::Result<void> {
-        workMap[key] = value;
-        return {};
-    });
+        // |mAccumulatedWork| is kept up to date by |mMapClearerThread|, so the
+        // pull only copies it (at most |kMaxTrackedGpuIdUids| entries) rather
+        // than iterating the BPF map.
+        for (const auto& [key, work] : mAccumulatedWork) {
+            if (work.active_duration_ns == 0 && work.inactive_duration_ns == 0) {
+                continue;
+            }
+            UidTrackingInfo& info =
+                    workMap[GpuIdUid{static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key)}];
+            info.total_active_duration_ns = work.active_duration_ns;
+            info.total_inactive_duration_ns = work.inactive_duration_ns;
+        }
+        resetAccumulatedWork();
+        accumulationStartTimePoint = mAccumulationStartTimePoint;
+        mAccumulationStartTimePoint = now;
+    }
 
     // Get a list of just the UIDs; the order does not matter.
     std::vector<Uid> uids;
@@ -381,14 +382,12 @@ AStatsManager_PullAtomCallbackReturn GpuWork::pullWorkAtoms(AStatsEventList* dat
 
     ALOGI("pullWorkAtoms: after random selection: uids.size() == %zu", uids.size());
 
-    auto now = std::chrono::steady_clock::now();
     long long duration =
-            std::chrono::duration_cast<std::chrono::seconds>(now - mPreviousMapClearTimePoint)
+            std::chrono::duration_cast<std::chrono::seconds>(now - accumulationStartTimePoint)
                     .count();
     if (duration > std::numeric_limits<int32_t>::max() || duration < 0) {
-        // This is essentially impossible. If it does somehow happen, give up,
-        // but still clear the map.
-        clearMap();
+        // This is essentially impossible. If it does somehow happen, give up;
+        // the accumulated work has already been reset.
         return AStatsManager_PULL_SKIP;
     }
 
@@ -425,11 +424,10 @@ AStatsManager_PullAtomCallbackReturn GpuWork::pullWorkAtoms(AStatsEventList* dat
                                           static_cast<int32_t>(total_inactive_duration_ms));
         }
     }
-    clearMap();
     return AStatsManager_PULL_SUCCESS;
 }
 
-void GpuWork::periodicallyClearMap() {
+void GpuWork::periodicallyDrainMap() {
     std::unique_lock<std::mutex> lock(mMutex);
 
     auto previousTime = std::chrono::steady_clock::now();
@@ -441,20 +439,77 @@ void GpuWork::periodicallyClearMap() {
         auto nextTime = std::chrono::steady_clock::now();
         auto differenceSeconds =
                 std::chrono::duration_cast<std::chrono::seconds>(nextTime - previousTime);
-        if (differenceSeconds.count() > kMapClearerWaitDurationSeconds) {
-            // It has been >1 hour, so clear the map, if needed.
+        if (differenceSeconds.count() >= kMapDrainWaitDurationSeconds) {
+            drainMap();
+            // Now that the map's contents are accumulated, clearing it loses
+            // nothing, so do that before the BPF program runs out of entries.
             clearMapIfNeeded();
             // We only update |previousTime| if we actually checked the map.
             previousTime = nextTime;
         }
-        // Sleep for ~1 hour. It does not matter if we don't check the map for 2
-        // hours.
         mIsTerminatingConditionVariable.wait_for(lock,
                                                  std::chrono::seconds{
-                                                         kMapClearerWaitDurationSeconds});
+                                                         kMapDrainWaitDurationSeconds});
+    }
+}
+
+void GpuWork::drainMap() {
+    if (!mInitialized.load() || !mGpuWorkMap.isValid()) {
+        return;
+    }
+
+    ATRACE_CALL();
+
+    // See |dump| for why iterating while holding |mMutex| is reliable. A
+    // repeated element is harmless here, as its second delta is zero.
+    std::vector<std::pair<GpuIdUid, UidTrackingInfo>> entries;
+    entries.reserve(kMaxTrackedGpuIdUids);
+    mGpuWorkMap.iterateWithValue([&entries](const GpuIdUid& key, const UidTrackingInfo& value,
+                                            const android::bpf::BpfMap<GpuIdUid, UidTrackingInfo>&)
+                                         -> base::Result<void> {
+        entries.emplace_back(key, value);
+        return {};
+    });
+
+    for (const auto& [gpuIdUid, info] : entries) {
+        const uint64_t key = (static_cast<uint64_t>(gpuIdUid.gpu_id) << 32) | gpuIdUid.uid;
+        auto it = mAccumulatedWork.find(key);
+        if (it == mAccumulatedWork.end()) {
+            if (mAccumulatedWork.size() >= kMaxTrackedGpuIdUids) {
+                ++mDroppedGpuIdUids;
+                continue;
+            }
+            it = mAccumulatedWork.emplace(key, WorkAccumulator{}).first;
+        }
+        WorkAccumulator& work = it->second;
+        // The BPF totals only grow until the map is cleared, at which point
+        // the baselines are reset too.
+        if (info.total_active_duration_ns >= work.last_total_active_duration_ns) {
+            work.active_duration_ns +=
+                    info.total_active_duration_ns - work.last_total_active_duration_ns;
+        }
+        if (info.total_inactive_duration_ns >= work.last_total_inactive_duration_ns) {
+            work.inactive_duration_ns +=
+                    info.total_inactive_duration_ns - work.last_total_inactive_duration_ns;
+        }
+        work.last_total_active_duration_ns = info.total_active_duration_ns;
+        work.last_total_inactive_duration_ns = info.total_inactive_duration_ns;
+    }
+
+    if (mDroppedGpuIdUids) {
+        ALOGW("drainMap: %" PRIu64 " GPU ID/UID entries dropped, accumulator full",
+              mDroppedGpuIdUids);
     }
 }
 
+void GpuWork::resetAccumulatedWork() {
+    for (auto& [key, work] : mAccumulatedWork) {
+        work.active_duration_ns = 0;
+        work.inactive_duration_ns = 0;
+    }
+    mDroppedGpuIdUids = 0;
+}
+
 void GpuWork::clearMapIfNeeded() {
     if (!mInitialized.load() || !mGpuWorkMap.isValid() || !mGpuWorkGlobalDataMap.isValid()) {
         ALOGW("Map clearing could not occur because we are not initialized properly");
@@ -520,9 +575,19 @@ void GpuWork::clearMap() {
     globalData.value().num_map_entries = 0;
     mGpuWorkGlobalDataMap.writeValue(0, globalData.value(), BPF_ANY);
 
-    // Update |mPreviousMapClearTimePoint| so we know when we started collecting
-    // the stats.
-    mPreviousMapClearTimePoint = std::chrono::steady_clock::now();
+    // The BPF totals restart from zero, so reset the baselines. Entries with
+    // nothing left to report no longer need a baseline and can go, which keeps
+    // |mAccumulatedWork| bounded by what the map holds between clears.
+    for (auto it = mAccumulatedWork.begin(); it != mAccumulatedWork.end();) {
+        WorkAccumulator& work = it->second;
+        if (work.active_duration_ns == 0 && work.inactive_duration_ns == 0) {
+            it = mAccumulatedWork.erase(it);
+            continue;
+        }
+        work.last_total_active_duration_ns = 0;
+        work.last_total_inactive_duration_ns = 0;
+        ++it;
+    }
 }
 
 void GpuWork::waitForPermissions() {
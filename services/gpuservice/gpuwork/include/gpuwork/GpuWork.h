@@ -26,6 +26,7 @@
 #include <cstdint>
 #include <functional>
 #include <thread>
+#include <unordered_map>
 
 #include "gpuwork/gpuWork.h"
 
@@ -58,13 +59,21 @@ private:
 
     AStatsManager_PullAtomCallbackReturn pullWorkAtoms(AStatsEventList* data);
 
-    // Periodically calls |clearMapIfNeeded| to clear the |mGpuWorkMap| map, if
-    // needed.
+    // Periodically calls |drainMap| to fold |mGpuWorkMap| into
+    // |mAccumulatedWork|, then |clearMapIfNeeded| to clear the map, if needed.
     //
     // Thread safety analysis is skipped because we need to use
     // |std::unique_lock|, which is not currently supported by thread safety
     // analysis.
-    void periodicallyClearMap() NO_THREAD_SAFETY_ANALYSIS;
+    void periodicallyDrainMap() NO_THREAD_SAFETY_ANALYSIS;
+
+    // Adds the work recorded in |mGpuWorkMap| since the previous drain to
+    // |mAccumulatedWork|.
+    void drainMap() REQUIRES(mMutex);
+
+    // Zeroes the accumulated totals after they have been pulled, keeping the
+    // baselines needed to compute the next deltas.
+    void resetAccumulatedWork() REQUIRES(mMutex);
 
     // Checks whether the |mGpuWorkMap| map is nearly full and, if so, clears
     // it.
@@ -84,8 +93,8 @@ private:
     // Indicates whether eBPF initialization should be stopped.
     std::atomic<bool> mStop = false;
 
-    // A thread that periodically checks whether |mGpuWorkMap| is nearly full
-    // and, if so, clears it.
+    // A thread that periodically drains |mGpuWorkMap| and, if it is nearly
+    // full, clears it.
     std::thread mMapClearerThread;
 
     // Mutex for |mGpuWorkMap| and a few other fields.
@@ -103,12 +112,31 @@ private:
     // A condition variable for |mIsTerminating|.
     std::condition_variable mIsTerminatingConditionVariable GUARDED_BY(mMutex);
 
+    // Work accumulated for a (gpu id, uid) pair since the last atom pull.
+    struct WorkAccumulator {
+        uint64_t active_duration_ns = 0;
+        uint64_t inactive_duration_ns = 0;
+        // Totals seen in |mGpuWorkMap| at the previous drain, so that only the
+        // new work is added. Reset when |mGpuWorkMap| is cleared.
+        uint64_t last_total_active_duration_ns = 0;
+        uint64_t last_total_inactive_duration_ns = 0;
+    };
+
+    // Accumulated work keyed by (gpu_id << 32 | uid). Holds at most
+    // |kMaxTrackedGpuIdUids| entries; work for further pairs is dropped and
+    // counted in |mDroppedGpuIdUids|.
+    std::unordered_map<uint64_t, WorkAccumulator> mAccumulatedWork GUARDED_BY(mMutex);
+
+    // Number of drained entries that did not fit in |mAccumulatedWork|.
+    uint64_t mDroppedGpuIdUids GUARDED_BY(mMutex) = 0;
+
     // 30 second timeout for trying to attach a BPF program to a tracepoint.
     static constexpr int kGpuWaitTimeoutSeconds = 30;
 
-    // The wait duration for the map clearer thread; the thread checks the map
-    // every ~1 hour.
-    static constexpr uint32_t kMapClearerWaitDurationSeconds = 60 * 60;
+    // The wait duration for the map clearer thread; the thread drains the map
+    // every ~1 minute, which keeps each drain small and well ahead of the map
+    // filling up.
+    static constexpr uint32_t kMapDrainWaitDurationSeconds = 60;
 
     // Whether our |pullAtomCallback| function is registered.
     bool mStatsdRegistered GUARDED_BY(mMutex) = false;
@@ -127,8 +155,9 @@ private:
     // The minimum GPU time needed to actually log stats for a UID.
     static constexpr uint64_t kMinGpuTimeNanoseconds = 30U * 1000000000U; // 30 seconds.
 
-    // The previous time point at which |mGpuWorkMap| was cleared.
-    std::chrono::steady_clock::time_point mPreviousMapClearTimePoint GUARDED_BY(mMutex);
+    // The time point at which |mAccumulatedWork| started accumulating, i.e. the
+    // previous atom pull.
+    std::chrono::steady_clock::time_point mAccumulationStartTimePoint GUARDED_BY(mMutex);
 
     // Permission to register a statsd puller.
     static constexpr char16_t kPermissionRegisterStatsPullAtom[] =
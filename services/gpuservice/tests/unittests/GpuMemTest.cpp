@@ -166,5 +166,41 @@ TEST_F(GpuMemTest, traverseGpuMemTotals) {
     EXPECT_EQ(sCount, TEST_KEY_COUNT);
 }
 
+TEST_F(GpuMemTest, getGpuMemTotalForPid) {
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_GLOBAL_KEY, TEST_GLOBAL_VAL, BPF_ANY));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_1, TEST_PROC_VAL_1, BPF_ANY));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_2, TEST_PROC_VAL_2, BPF_ANY));
+    // Same pid as TEST_PROC_KEY_1 on the second gpu.
+    ASSERT_RESULT_OK(mTestMap.writeValue(((uint64_t)1 << 32) | (uint32_t)TEST_PROC_KEY_1,
+                                         TEST_PROC_VAL_2, BPF_ANY));
+    mTestableGpuMem.setGpuMemTotalMap(mTestMap);
+
+    uint64_t size = 0;
+    EXPECT_TRUE(mGpuMem->getGpuMemTotalForPid((uint32_t)TEST_PROC_KEY_1, &size));
+    EXPECT_EQ(size, TEST_PROC_VAL_1 + TEST_PROC_VAL_2);
+    EXPECT_TRUE(mGpuMem->getGpuMemTotalForPid((uint32_t)TEST_PROC_KEY_2, &size));
+    EXPECT_EQ(size, TEST_PROC_VAL_2);
+    EXPECT_FALSE(mGpuMem->getGpuMemTotalForPid(12345, &size));
+}
+
+TEST_F(GpuMemTest, sizeChangeCallbackHonoursThreshold) {
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_1, TEST_PROC_VAL_1, BPF_ANY));
+    mTestableGpuMem.setGpuMemTotalMap(mTestMap);
+
+    std::vector<uint64_t> reported;
+    mGpuMem->setSizeChangeCallback(100, [&](uint32_t, uint32_t, uint64_t size) {
+        reported.push_back(size);
+    });
+
+    uint64_t size = 0;
+    EXPECT_TRUE(mGpuMem->getGpuMemTotalForPid((uint32_t)TEST_PROC_KEY_1, &size));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_1, TEST_PROC_VAL_1 + 50, BPF_ANY));
+    EXPECT_TRUE(mGpuMem->getGpuMemTotalForPid((uint32_t)TEST_PROC_KEY_1, &size));
+    ASSERT_RESULT_OK(mTestMap.writeValue(TEST_PROC_KEY_1, TEST_PROC_VAL_1 + 150, BPF_ANY));
+    EXPECT_TRUE(mGpuMem->getGpuMemTotalForPid((uint32_t)TEST_PROC_KEY_1, &size));
+
+    EXPECT_THAT(reported, testing::ElementsAre(TEST_PROC_VAL_1, TEST_PROC_VAL_1 + 150));
+}
+
 } // namespace
 } // namespace android
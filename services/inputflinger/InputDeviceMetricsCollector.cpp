@@ -40,6 +40,11 @@ const bool DEBUG = __android_log_is_loggable(ANDROID_LOG_DEBUG, LOG_TAG, ANDROID
 
 constexpr size_t INTERACTIONS_QUEUE_CAPACITY = 500;
 
+// The maximum number of uids that are tracked in a single device usage session, including the uid
+// sessions that have already completed. Interactions with additional uids are not tracked, which
+// bounds the memory used by a long session that interacts with many apps.
+constexpr size_t MAX_UIDS_PER_USAGE_SESSION = 64;
+
 int32_t linuxBusToInputDeviceBusEnum(int32_t linuxBus, bool isUsiStylus) {
     if (isUsiStylus) {
         // This is a stylus connected over the Universal Stylus Initiative (USI) protocol.
@@ -121,7 +126,8 @@ InputDeviceMetricsCollector::InputDeviceMetricsCollector(InputListenerInterface&
       : mNextListener(listener),
         mLogger(logger),
         mUsageSessionTimeout(usageSessionTimeout),
-        mInteractionsQueue(INTERACTIONS_QUEUE_CAPACITY) {}
+        mInteractionsQueue(INTERACTIONS_QUEUE_CAPACITY),
+        mNextSessionExpiryTime(nanoseconds::max()) {}
 
 void InputDeviceMetricsCollector::notifyInputDevicesChanged(
         const NotifyInputDevicesChangedArgs& args) {
@@ -284,7 +290,8 @@ void InputDeviceMetricsCollector::onInputDeviceUsage(DeviceId deviceId, nanoseco
     auto [sessionIt, _] =
             mActiveUsageSessions.try_emplace(deviceId, ActiveSession(mUsageSessionTimeout, eventTime));
     for (InputDeviceUsageSource source : getSources(infoIt->second)) {
-        sessionIt->second.recordUsage(eventTime, source);
+        mNextSessionExpiryTime =
+                std::min(mNextSessionExpiryTime, sessionIt->second.recordUsage(eventTime, source));
     }
 }
 
@@ -294,7 +301,8 @@ void InputDeviceMetricsCollector::onInputDeviceInteraction(const Interaction& in
         return;
     }
 
-    activeSessionIt->second.recordInteraction(interaction);
+    mNextSessionExpiryTime =
+            std::min(mNextSessionExpiryTime, activeSessionIt->second.recordInteraction(interaction));
 }
 
 void InputDeviceMetricsCollector::reportCompletedSessions() {
@@ -305,12 +313,20 @@ void InputDeviceMetricsCollector::reportCompletedSessions() {
     }
 
     const auto currentTime = mLogger.getCurrentTime();
+    if (currentTime < mNextSessionExpiryTime) {
+        // This is the common case for a stream of events: nothing can have expired yet.
+        return;
+    }
     std::vector<DeviceId> completedUsageSessions;
 
     // Process usages for all active session to determine if any sessions have expired.
+    mNextSessionExpiryTime = nanoseconds::max();
     for (auto& [deviceId, activeSession] : mActiveUsageSessions) {
         if (activeSession.checkIfCompletedAt(currentTime)) {
             completedUsageSessions.emplace_back(deviceId);
+        } else {
+            mNextSessionExpiryTime =
+                    std::min(mNextSessionExpiryTime, activeSession.getEarliestExpiryTime());
         }
     }
 
@@ -333,8 +349,8 @@ InputDeviceMetricsCollector::ActiveSession::ActiveSession(nanoseconds usageSessi
                                                           nanoseconds startTime)
       : mUsageSessionTimeout(usageSessionTimeout), mDeviceSession({startTime, startTime}) {}
 
-void InputDeviceMetricsCollector::ActiveSession::recordUsage(nanoseconds eventTime,
-                                                             InputDeviceUsageSource source) {
+nanoseconds InputDeviceMetricsCollector::ActiveSession::recordUsage(
+        nanoseconds eventTime, InputDeviceUsageSource source) {
     // We assume that event times for subsequent events are always monotonically increasing for each
     // input device.
     auto [activeSourceIt, inserted] =
@@ -343,23 +359,34 @@ void InputDeviceMetricsCollector::ActiveSession::recordUsage(nanoseconds eventTi
         activeSourceIt->second.end = eventTime;
     }
     mDeviceSession.end = eventTime;
+    return inserted ? eventTime + mUsageSessionTimeout : nanoseconds::max();
 }
 
-void InputDeviceMetricsCollector::ActiveSession::recordInteraction(const Interaction& interaction) {
+nanoseconds InputDeviceMetricsCollector::ActiveSession::recordInteraction(
+        const Interaction& interaction) {
     const auto sessionExpiryTime = mDeviceSession.end + mUsageSessionTimeout;
     const auto timestamp = std::get<nanoseconds>(interaction);
     if (timestamp >= sessionExpiryTime) {
         // This interaction occurred after the device's current active session is set to expire.
         // Ignore it.
-        return;
+        return nanoseconds::max();
     }
 
+    nanoseconds expiryTime = nanoseconds::max();
     for (Uid uid : std::get<std::set<Uid>>(interaction)) {
-        auto [activeUidIt, inserted] = mActiveSessionsByUid.try_emplace(uid, UsageSession(timestamp, timestamp));
-        if (!inserted) {
+        auto activeUidIt = mActiveSessionsByUid.find(uid);
+        if (activeUidIt != mActiveSessionsByUid.end()) {
             activeUidIt->second.end = timestamp;
+            continue;
         }
+        if (mActiveSessionsByUid.size() + mUidUsageBreakdown.size() >=
+            MAX_UIDS_PER_USAGE_SESSION) {
+            continue;
+        }
+        mActiveSessionsByUid.emplace(uid, UsageSession(timestamp, timestamp));
+        expiryTime = timestamp + mUsageSessionTimeout;
     }
+    return expiryTime;
 }
 
 bool InputDeviceMetricsCollector::ActiveSession::checkIfCompletedAt(nanoseconds timestamp) {
@@ -394,6 +421,17 @@ bool InputDeviceMetricsCollector::ActiveSession::checkIfCompletedAt(nanoseconds
     return mActiveSessionsBySource.empty();
 }
 
+nanoseconds InputDeviceMetricsCollector::ActiveSession::getEarliestExpiryTime() const {
+    nanoseconds earliestEnd = nanoseconds::max();
+    for (const auto& [_, session] : mActiveSessionsBySource) {
+        earliestEnd = std::min(earliestEnd, session.end);
+    }
+    for (const auto& [_, session] : mActiveSessionsByUid) {
+        earliestEnd = std::min(earliestEnd, session.end);
+    }
+    return earliestEnd == nanoseconds::max() ? earliestEnd : earliestEnd + mUsageSessionTimeout;
+}
+
 InputDeviceMetricsLogger::DeviceUsageReport
 InputDeviceMetricsCollector::ActiveSession::finishSession() {
     const auto deviceUsageDuration = mDeviceSession.end - mDeviceSession.start;
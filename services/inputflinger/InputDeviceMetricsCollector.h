@@ -149,9 +149,14 @@ private:
     public:
         explicit ActiveSession(std::chrono::nanoseconds usageSessionTimeout,
                                std::chrono::nanoseconds startTime);
-        void recordUsage(std::chrono::nanoseconds eventTime, InputDeviceUsageSource source);
-        void recordInteraction(const Interaction&);
+        // The record methods return the time at which a session that they started would expire,
+        // or nanoseconds::max() if they only extended existing sessions.
+        std::chrono::nanoseconds recordUsage(std::chrono::nanoseconds eventTime,
+                                             InputDeviceUsageSource source);
+        std::chrono::nanoseconds recordInteraction(const Interaction&);
         bool checkIfCompletedAt(std::chrono::nanoseconds timestamp);
+        // The earliest time at which one of the source or uid sessions could expire.
+        std::chrono::nanoseconds getEarliestExpiryTime() const;
         InputDeviceMetricsLogger::DeviceUsageReport finishSession();
 
     private:
@@ -175,6 +180,10 @@ private:
 
     // The input devices that currently have active usage sessions.
     std::map<DeviceId, ActiveSession> mActiveUsageSessions GUARDED_BY(mLock);
+    // No session can expire before this time, so the sessions don't need to be checked for
+    // completion until then. This is a lower bound: sessions are only ever extended after it is
+    // computed, which moves their expiry later.
+    std::chrono::nanoseconds mNextSessionExpiryTime GUARDED_BY(mLock);
 
     void onInputDevicesChanged(const std::vector<InputDeviceInfo>& infos) REQUIRES(mLock);
     void onInputDeviceRemoved(DeviceId deviceId, const MetricsDeviceInfo& info) REQUIRES(mLock);
@@ -154,6 +154,16 @@ PointerChoreographer::~PointerChoreographer() {
 void PointerChoreographer::notifyInputDevicesChanged(const NotifyInputDevicesChangedArgs& args) {
     PointerDisplayChange pointerDisplayChange;
 
+    mTouchOnlyDevices.clear();
+    for (const auto& info : args.inputDeviceInfos) {
+        const uint32_t sources = info.getSources();
+        if (isFromSource(sources, AINPUT_SOURCE_TOUCHSCREEN) &&
+            !isFromSource(sources, AINPUT_SOURCE_MOUSE) &&
+            !isFromSource(sources, AINPUT_SOURCE_MOUSE_RELATIVE)) {
+            mTouchOnlyDevices.insert(info.getId());
+        }
+    }
+
     { // acquire lock
         std::scoped_lock _l(mLock);
 
@@ -175,11 +185,29 @@ void PointerChoreographer::notifyKey(const NotifyKeyArgs& args) {
 }
 
 void PointerChoreographer::notifyMotion(const NotifyMotionArgs& args) {
+    if (canSkipMotionProcessing(args)) {
+        mNextListener.notify(args);
+        return;
+    }
     NotifyMotionArgs newArgs = processMotion(args);
 
     mNextListener.notify(newArgs);
 }
 
+/**
+ * Touchscreen events are never modified, and only affect pointer controllers when show touches is
+ * enabled, when they hover with a stylus, or when a DOWN fades the mouse cursor. Every other event
+ * of a touch-only device can be forwarded without taking the lock or copying the args.
+ */
+bool PointerChoreographer::canSkipMotionProcessing(const NotifyMotionArgs& args) const {
+    if (args.action == AMOTION_EVENT_ACTION_DOWN ||
+        !isFromSource(args.source, AINPUT_SOURCE_TOUCHSCREEN) || isStylusHoverEvent(args)) {
+        return false;
+    }
+    return !mShowTouchesEnabledForFastPath.load(std::memory_order_relaxed) &&
+            mTouchOnlyDevices.count(args.deviceId) != 0;
+}
+
 void PointerChoreographer::fadeMouseCursorOnKeyPress(const android::NotifyKeyArgs& args) {
     if (args.action == AKEY_EVENT_ACTION_UP || isMetaKey(args.keyCode)) {
         return;
@@ -746,6 +774,7 @@ void PointerChoreographer::setShowTouchesEnabled(bool enabled) {
             return;
         }
         mShowTouchesEnabled = enabled;
+        mShowTouchesEnabledForFastPath.store(enabled, std::memory_order_relaxed);
         pointerDisplayChange = updatePointerControllersLocked();
     } // release lock
 
@@ -22,6 +22,7 @@
 
 #include <android-base/thread_annotations.h>
 #include <gui/WindowInfosListener.h>
+#include <atomic>
 #include <type_traits>
 #include <unordered_set>
 
@@ -131,6 +132,7 @@ private:
     bool canUnfadeOnDisplay(ui::LogicalDisplayId displayId) REQUIRES(mLock);
 
     void fadeMouseCursorOnKeyPress(const NotifyKeyArgs& args);
+    bool canSkipMotionProcessing(const NotifyMotionArgs& args) const;
     NotifyMotionArgs processMotion(const NotifyMotionArgs& args);
     NotifyMotionArgs processMouseEventLocked(const NotifyMotionArgs& args) REQUIRES(mLock);
     NotifyMotionArgs processTouchpadEventLocked(const NotifyMotionArgs& args) REQUIRES(mLock);
@@ -198,6 +200,13 @@ private:
     std::vector<DisplayViewport> mViewports GUARDED_BY(mLock);
     bool mShowTouchesEnabled GUARDED_BY(mLock);
     bool mStylusPointerIconEnabled GUARDED_BY(mLock);
+    // A copy of mShowTouchesEnabled that can be read without the lock.
+    std::atomic<bool> mShowTouchesEnabledForFastPath{false};
+    // Touchscreen devices that are not also mice, touchpads or drawing tablets. Only their touch
+    // spots and the mouse cursor they fade can be affected by their motion events. This is only
+    // accessed from the thread that notifies input devices and motion events, so it does not need
+    // to be guarded by mLock.
+    std::unordered_set<DeviceId> mTouchOnlyDevices;
     std::set<ui::LogicalDisplayId /*displayId*/> mDisplaysWithPointersHidden;
     ui::LogicalDisplayId mCurrentFocusedDisplay GUARDED_BY(mLock);
 
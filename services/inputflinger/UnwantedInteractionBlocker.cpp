@@ -212,6 +212,15 @@ NotifyMotionArgs removePointerIds(const NotifyMotionArgs& args,
  * Return NotifyMotionArgs where the stylus pointers have been removed.
  * If this results in removal of the active pointer, then return nullopt.
  */
+static bool hasStylusPointer(const NotifyMotionArgs& args) {
+    for (uint32_t i = 0; i < args.getPointerCount(); i++) {
+        if (isStylusToolType(args.pointerProperties[i].toolType)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static std::optional<NotifyMotionArgs> removeStylusPointerIds(const NotifyMotionArgs& args) {
     std::set<int32_t> stylusPointerIds;
     for (uint32_t i = 0; i < args.getPointerCount(); i++) {
@@ -378,9 +387,14 @@ void UnwantedInteractionBlocker::enqueueOutboundMotionLocked(const NotifyMotionA
 }
 
 void UnwantedInteractionBlocker::notifyMotionLocked(const NotifyMotionArgs& args) {
+    // Check the source before looking up the device, so that mouse, touchpad and stylus-only
+    // streams don't pay for the lookup.
+    if (!isFromTouchscreen(args.source) || mPalmRejectors.empty()) {
+        enqueueOutboundMotionLocked(args);
+        return;
+    }
     auto it = mPalmRejectors.find(args.deviceId);
-    const bool sendToPalmRejector = it != mPalmRejectors.end() && isFromTouchscreen(args.source);
-    if (!sendToPalmRejector) {
+    if (it == mPalmRejectors.end()) {
         enqueueOutboundMotionLocked(args);
         return;
     }
@@ -588,6 +602,14 @@ std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
                                                    const SlotState& oldSlotState,
                                                    const SlotState& newSlotState) {
     std::vector<::ui::InProgressTouchEvdev> touches;
+    getTouches(args, deviceInfo, oldSlotState, newSlotState, touches);
+    return touches;
+}
+
+void getTouches(const NotifyMotionArgs& args, const AndroidPalmFilterDeviceInfo& deviceInfo,
+                const SlotState& oldSlotState, const SlotState& newSlotState,
+                std::vector<::ui::InProgressTouchEvdev>& touches) {
+    touches.clear();
 
     for (size_t i = 0; i < args.getPointerCount(); i++) {
         const int32_t pointerId = args.pointerProperties[i].id;
@@ -647,7 +669,6 @@ std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
         // The field 'reported_tool_type' is not used for palm rejection
         touches.back().stylus_button = false;
     }
-    return touches;
 }
 
 std::set<int32_t> PalmRejector::detectPalmPointers(const NotifyMotionArgs& args) {
@@ -659,19 +680,18 @@ std::set<int32_t> PalmRejector::detectPalmPointers(const NotifyMotionArgs& args)
     SlotState oldSlotState = mSlotState;
     mSlotState.update(args);
 
-    std::vector<::ui::InProgressTouchEvdev> touches =
-            getTouches(args, mDeviceInfo, oldSlotState, mSlotState);
+    getTouches(args, mDeviceInfo, oldSlotState, mSlotState, mTouches);
     ::base::TimeTicks chromeTimestamp = toChromeTimestamp(args.eventTime);
 
     if (DEBUG_MODEL) {
         std::stringstream touchesStream;
-        for (const ::ui::InProgressTouchEvdev& touch : touches) {
+        for (const ::ui::InProgressTouchEvdev& touch : mTouches) {
             touchesStream << touch.tracking_id << " : " << touch << "\n";
         }
         ALOGD("Filter: touches = %s", touchesStream.str().c_str());
     }
 
-    mPalmDetectionFilter->Filter(touches, chromeTimestamp, &slotsToHold, &slotsToSuppress);
+    mPalmDetectionFilter->Filter(mTouches, chromeTimestamp, &slotsToHold, &slotsToSuppress);
 
     ALOGD_IF(DEBUG_MODEL, "Response: slotsToHold = %s, slotsToSuppress = %s",
              slotsToHold.to_string().c_str(), slotsToSuppress.to_string().c_str());
@@ -713,8 +733,11 @@ std::vector<NotifyMotionArgs> PalmRejector::processMotion(const NotifyMotionArgs
     std::set<int32_t> oldSuppressedIds;
     std::swap(oldSuppressedIds, mSuppressedPointerIds);
 
-    std::optional<NotifyMotionArgs> touchOnlyArgs = removeStylusPointerIds(args);
-    if (touchOnlyArgs) {
+    if (!hasStylusPointer(args)) {
+        // The common case: there is nothing to strip, so avoid copying the args.
+        mSuppressedPointerIds = detectPalmPointers(args);
+    } else if (std::optional<NotifyMotionArgs> touchOnlyArgs = removeStylusPointerIds(args);
+               touchOnlyArgs) {
         mSuppressedPointerIds = detectPalmPointers(*touchOnlyArgs);
     } else {
         // This is a stylus-only event.
@@ -722,6 +745,11 @@ std::vector<NotifyMotionArgs> PalmRejector::processMotion(const NotifyMotionArgs
         mSuppressedPointerIds = oldSuppressedIds;
     }
 
+    if (oldSuppressedIds.empty() && mSuppressedPointerIds.empty()) {
+        // Nothing was rejected before or after this event, so it goes out unmodified.
+        return {args};
+    }
+
     std::vector<NotifyMotionArgs> argsWithoutUnwantedPointers =
             cancelSuppressedPointers(args, oldSuppressedIds, mSuppressedPointerIds);
     for (const NotifyMotionArgs& checkArgs : argsWithoutUnwantedPointers) {
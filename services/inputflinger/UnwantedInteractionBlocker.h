@@ -161,6 +161,14 @@ std::vector<::ui::InProgressTouchEvdev> getTouches(const NotifyMotionArgs& args,
                                                    const SlotState& oldSlotState,
                                                    const SlotState& newSlotState);
 
+/**
+ * Same as above, but writes into the provided vector so that its storage can be reused across
+ * events.
+ */
+void getTouches(const NotifyMotionArgs& args, const AndroidPalmFilterDeviceInfo& deviceInfo,
+                const SlotState& oldSlotState, const SlotState& newSlotState,
+                std::vector<::ui::InProgressTouchEvdev>& outTouches);
+
 class PalmRejector {
 public:
     explicit PalmRejector(const AndroidPalmFilterDeviceInfo& info,
@@ -187,6 +195,8 @@ private:
     AndroidPalmFilterDeviceInfo mDeviceInfo;
     std::unique_ptr<::ui::PalmDetectionFilter> mPalmDetectionFilter;
     std::set<int32_t> mSuppressedPointerIds;
+    // The model input for the current event. Kept as a member so that its storage is reused.
+    std::vector<::ui::InProgressTouchEvdev> mTouches;
 
     // Used to help convert an Android touch stream to Linux input stream.
     SlotState mSlotState;
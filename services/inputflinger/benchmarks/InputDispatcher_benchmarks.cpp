@@ -16,14 +16,22 @@
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <vector>
+
+#include <NotifyArgsBuilders.h>
 #include <android/os/IInputConstants.h>
 #include <binder/Binder.h>
+#include <input/InputConsumer.h>
+#include <input/InputEventBuilders.h>
 #include "../dispatcher/InputDispatcher.h"
 #include "../tests/FakeApplicationHandle.h"
 #include "../tests/FakeInputDispatcherPolicy.h"
 #include "../tests/FakeWindows.h"
 
 using android::base::Result;
+using android::gui::FocusRequest;
+using android::gui::TouchOcclusionMode;
 using android::gui::WindowInfo;
 using android::os::IInputConstants;
 using android::os::InputEventInjectionResult;
@@ -45,6 +53,82 @@ static nsecs_t now() {
     return systemTime(SYSTEM_TIME_MONOTONIC);
 }
 
+/**
+ * Collects the latency of every benchmark iteration so that the tail, and not just the mean
+ * reported by the benchmark library, is visible. The percentiles are reported as counters in
+ * microseconds.
+ */
+class LatencyRecorder {
+public:
+    explicit LatencyRecorder(benchmark::State& state) : mState(state) {
+        mSamples.reserve(state.max_iterations);
+    }
+
+    void record(nsecs_t latency) { mSamples.push_back(latency); }
+
+    void report() {
+        if (mSamples.empty()) {
+            return;
+        }
+        std::sort(mSamples.begin(), mSamples.end());
+        mState.counters["p50_us"] = percentile(0.5) / 1000.0;
+        mState.counters["p99_us"] = percentile(0.99) / 1000.0;
+    }
+
+private:
+    benchmark::State& mState;
+    std::vector<nsecs_t> mSamples;
+
+    double percentile(double fraction) const {
+        const size_t index = std::min(mSamples.size() - 1,
+                                      static_cast<size_t>(fraction * mSamples.size()));
+        return mSamples[index];
+    }
+};
+
+static std::unique_ptr<InputDispatcher> createDispatcher(FakeInputDispatcherPolicy& policy) {
+    auto dispatcher = std::make_unique<InputDispatcher>(policy);
+    dispatcher->setInputDispatchMode(/*enabled*/ true, /*frozen*/ false);
+    dispatcher->start();
+    return dispatcher;
+}
+
+static gui::DisplayInfo createDisplayInfo(ui::LogicalDisplayId displayId) {
+    gui::DisplayInfo info;
+    info.displayId = displayId;
+    info.logicalWidth = 1080;
+    info.logicalHeight = 1920;
+    return info;
+}
+
+static NotifyMotionArgs generateTouchArgs(int32_t action, nsecs_t downTime,
+                                          ui::LogicalDisplayId displayId = DISPLAY_ID) {
+    return MotionArgsBuilder(action, AINPUT_SOURCE_TOUCHSCREEN)
+            .deviceId(DEVICE_ID)
+            .displayId(displayId)
+            .downTime(downTime)
+            .eventTime(now())
+            .pointer(PointerBuilder(/*id=*/0, ToolType::FINGER).x(100).y(100))
+            .build();
+}
+
+/**
+ * Send a DOWN and an UP to the dispatcher and wait for every receiver to consume both. Returns the
+ * time from the DOWN being notified until the last receiver got the UP.
+ */
+static nsecs_t tapAndConsume(InputDispatcher& dispatcher,
+                             const std::vector<sp<FakeWindowHandle>>& receivers,
+                             ui::LogicalDisplayId displayId = DISPLAY_ID) {
+    const nsecs_t downTime = now();
+    dispatcher.notifyMotion(generateTouchArgs(AMOTION_EVENT_ACTION_DOWN, downTime, displayId));
+    dispatcher.notifyMotion(generateTouchArgs(AMOTION_EVENT_ACTION_UP, downTime, displayId));
+    for (const sp<FakeWindowHandle>& receiver : receivers) {
+        receiver->consumeMotionEvent();
+        receiver->consumeMotionEvent();
+    }
+    return now() - downTime;
+}
+
 static MotionEvent generateMotionEvent() {
     PointerProperties pointerProperties[1];
     PointerCoords pointerCoords[1];
@@ -195,11 +279,272 @@ static void benchmarkOnWindowInfosChanged(benchmark::State& state) {
     dispatcher->stop();
 }
 
+/**
+ * Touch a window at the bottom of a stack of windows that do not contain the touch, with some spy
+ * windows on top. Every window is hit tested and every spy receives a copy of the gesture.
+ * Arguments: number of windows above the touched one, number of spy windows.
+ */
+static void benchmarkNotifyMotion_ManyWindows(benchmark::State& state) {
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = createDispatcher(fakePolicy);
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+
+    std::vector<sp<FakeWindowHandle>> receivers;
+    std::vector<gui::WindowInfo> windowInfos;
+    for (int64_t i = 0; i < state.range(1); i++) {
+        sp<FakeWindowHandle> spy =
+                sp<FakeWindowHandle>::make(application, dispatcher, "Spy " + std::to_string(i),
+                                           DISPLAY_ID);
+        spy->setSpy(true);
+        spy->setTrustedOverlay(true);
+        windowInfos.push_back(*spy->getInfo());
+        receivers.push_back(spy);
+    }
+    for (int64_t i = 0; i < state.range(0); i++) {
+        sp<FakeWindowHandle> window =
+                sp<FakeWindowHandle>::make(application, dispatcher,
+                                           "Window " + std::to_string(i), DISPLAY_ID);
+        // A thin strip along the bottom of the display, clear of the touch at (100, 100).
+        window->setFrame(Rect(0, 1000 + i, 1080, 1001 + i));
+        windowInfos.push_back(*window->getInfo());
+    }
+    sp<FakeWindowHandle> touchedWindow =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Touched Window", DISPLAY_ID);
+    windowInfos.push_back(*touchedWindow->getInfo());
+    receivers.push_back(touchedWindow);
+
+    dispatcher->onWindowInfosChanged({windowInfos, {createDisplayInfo(DISPLAY_ID)}, 0, 0});
+
+    LatencyRecorder latencies(state);
+    for (auto _ : state) {
+        latencies.record(tapAndConsume(*dispatcher, receivers));
+    }
+    latencies.report();
+
+    dispatcher->stop();
+}
+
+/**
+ * Touch each of several displays in turn, with one window per display.
+ * Argument: number of displays.
+ */
+static void benchmarkNotifyMotion_MultiDisplay(benchmark::State& state) {
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = createDispatcher(fakePolicy);
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+
+    std::vector<sp<FakeWindowHandle>> windows;
+    std::vector<gui::WindowInfo> windowInfos;
+    std::vector<gui::DisplayInfo> displayInfos;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        const ui::LogicalDisplayId displayId{static_cast<int32_t>(i)};
+        sp<FakeWindowHandle> window =
+                sp<FakeWindowHandle>::make(application, dispatcher,
+                                           "Window on display " + std::to_string(i), displayId);
+        windowInfos.push_back(*window->getInfo());
+        displayInfos.push_back(createDisplayInfo(displayId));
+        windows.push_back(window);
+    }
+    dispatcher->onWindowInfosChanged({windowInfos, displayInfos, 0, 0});
+
+    LatencyRecorder latencies(state);
+    size_t nextDisplay = 0;
+    for (auto _ : state) {
+        const sp<FakeWindowHandle>& window = windows[nextDisplay];
+        latencies.record(tapAndConsume(*dispatcher, {window}, window->getInfo()->displayId));
+        nextDisplay = (nextDisplay + 1) % windows.size();
+    }
+    latencies.report();
+
+    dispatcher->stop();
+}
+
+/**
+ * Touch a window that is covered by non-touchable windows from other apps, so that the touch
+ * occlusion of every overlay is computed. The overlays allow touches through so that the
+ * gesture is still delivered.
+ * Argument: number of overlays.
+ */
+static void benchmarkNotifyMotion_Occluded(benchmark::State& state) {
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = createDispatcher(fakePolicy);
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+
+    std::vector<gui::WindowInfo> windowInfos;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        sp<FakeWindowHandle> overlay =
+                sp<FakeWindowHandle>::make(application, dispatcher,
+                                           "Overlay " + std::to_string(i), DISPLAY_ID);
+        overlay->setTouchable(false);
+        overlay->setOwnerInfo(gui::Pid{static_cast<pid_t>(2000 + i)},
+                              gui::Uid{static_cast<uid_t>(20000 + i)});
+        overlay->setTouchOcclusionMode(TouchOcclusionMode::ALLOW);
+        windowInfos.push_back(*overlay->getInfo());
+    }
+    sp<FakeWindowHandle> window =
+            sp<FakeWindowHandle>::make(application, dispatcher, "Occluded Window", DISPLAY_ID);
+    windowInfos.push_back(*window->getInfo());
+
+    dispatcher->onWindowInfosChanged({windowInfos, {createDisplayInfo(DISPLAY_ID)}, 0, 0});
+
+    LatencyRecorder latencies(state);
+    for (auto _ : state) {
+        latencies.record(tapAndConsume(*dispatcher, {window}));
+    }
+    latencies.report();
+
+    dispatcher->stop();
+}
+
+/**
+ * Move focus between two windows and send a key to the newly focused one on every iteration.
+ */
+static void benchmarkNotifyKey_FocusChange(benchmark::State& state) {
+    FakeInputDispatcherPolicy fakePolicy;
+    auto dispatcher = createDispatcher(fakePolicy);
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+    dispatcher->setFocusedApplication(DISPLAY_ID, application);
+
+    std::array<sp<FakeWindowHandle>, 2> windows;
+    std::vector<gui::WindowInfo> windowInfos;
+    for (size_t i = 0; i < windows.size(); i++) {
+        windows[i] = sp<FakeWindowHandle>::make(application, dispatcher,
+                                                "Window " + std::to_string(i), DISPLAY_ID);
+        windows[i]->setFocusable(true);
+        windowInfos.push_back(*windows[i]->getInfo());
+    }
+    dispatcher->onWindowInfosChanged({windowInfos, {createDisplayInfo(DISPLAY_ID)}, 0, 0});
+
+    auto requestFocus = [&](const sp<FakeWindowHandle>& window) {
+        FocusRequest request;
+        request.token = window->getToken();
+        request.windowName = window->getName();
+        request.timestamp = now();
+        request.displayId = DISPLAY_ID.val();
+        dispatcher->setFocusedWindow(request);
+    };
+    requestFocus(windows[0]);
+    windows[0]->consumeFocusEvent(/*hasFocus=*/true);
+
+    LatencyRecorder latencies(state);
+    size_t focused = 0;
+    for (auto _ : state) {
+        const size_t next = 1 - focused;
+        const nsecs_t startTime = now();
+        requestFocus(windows[next]);
+        windows[focused]->consumeFocusEvent(/*hasFocus=*/false);
+        windows[next]->consumeFocusEvent(/*hasFocus=*/true);
+
+        const nsecs_t downTime = now();
+        dispatcher->notifyKey(KeyArgsBuilder(AKEY_EVENT_ACTION_DOWN, AINPUT_SOURCE_KEYBOARD)
+                                      .keyCode(AKEYCODE_A)
+                                      .downTime(downTime)
+                                      .eventTime(downTime)
+                                      .build());
+        dispatcher->notifyKey(KeyArgsBuilder(AKEY_EVENT_ACTION_UP, AINPUT_SOURCE_KEYBOARD)
+                                      .keyCode(AKEYCODE_A)
+                                      .downTime(downTime)
+                                      .eventTime(now())
+                                      .build());
+        windows[next]->consumeKey();
+        windows[next]->consumeKey();
+        latencies.record(now() - startTime);
+        focused = next;
+    }
+    latencies.report();
+
+    dispatcher->stop();
+}
+
+static status_t publishTouch(InputPublisher& publisher, uint32_t seq, int32_t action,
+                             nsecs_t downTime, nsecs_t eventTime, float x) {
+    PointerProperties properties;
+    properties.clear();
+    properties.id = 0;
+    properties.toolType = ToolType::FINGER;
+    PointerCoords coords;
+    coords.clear();
+    coords.setAxisValue(AMOTION_EVENT_AXIS_X, x);
+    coords.setAxisValue(AMOTION_EVENT_AXIS_Y, 100);
+    ui::Transform identityTransform;
+    return publisher.publishMotionEvent(seq, InputEvent::nextId(), DEVICE_ID,
+                                        AINPUT_SOURCE_TOUCHSCREEN, DISPLAY_ID, INVALID_HMAC, action,
+                                        /*actionButton=*/0, /*flags=*/0, /*edgeFlags=*/0,
+                                        AMETA_NONE, /*buttonState=*/0, MotionClassification::NONE,
+                                        identityTransform, /*xPrecision=*/0, /*yPrecision=*/0,
+                                        AMOTION_EVENT_INVALID_CURSOR_POSITION,
+                                        AMOTION_EVENT_INVALID_CURSOR_POSITION, identityTransform,
+                                        downTime, eventTime, /*pointerCount=*/1, &properties,
+                                        &coords);
+}
+
+/**
+ * The receiving side of a touch stream: several MOVE samples queue up between frames, and the
+ * consumer batches and resamples them when the frame is drawn.
+ * Argument: number of samples per frame.
+ */
+static void benchmarkConsumeBatchedMotion(benchmark::State& state) {
+    std::unique_ptr<InputChannel> serverChannel, clientChannel;
+    if (InputChannel::openInputChannelPair("benchmark", serverChannel, clientChannel) != OK) {
+        state.SkipWithError("Failed to open an input channel pair");
+        return;
+    }
+    InputPublisher publisher(std::move(serverChannel));
+    InputConsumer consumer(std::move(clientChannel), /*enableTouchResampling=*/true);
+    PreallocatedInputEventFactory factory;
+
+    uint32_t seq = 0;
+    auto consumeAndFinish = [&](bool consumeBatches, nsecs_t frameTime) {
+        uint32_t consumeSeq;
+        InputEvent* event;
+        while (consumer.consume(&factory, consumeBatches, frameTime, &consumeSeq, &event) == OK &&
+               event != nullptr) {
+            consumer.sendFinishedSignal(consumeSeq, /*handled=*/true);
+        }
+        while (publisher.receiveConsumerResponse().ok()) {
+        }
+    };
+
+    const nsecs_t downTime = now();
+    nsecs_t eventTime = downTime;
+    publishTouch(publisher, ++seq, AMOTION_EVENT_ACTION_DOWN, downTime, eventTime, /*x=*/0);
+    consumeAndFinish(/*consumeBatches=*/true, eventTime);
+
+    // Touch samples arrive every 4ms.
+    constexpr nsecs_t kSampleInterval = 4'000'000;
+    LatencyRecorder latencies(state);
+    float x = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int64_t i = 0; i < state.range(0); i++) {
+            eventTime += kSampleInterval;
+            x += 5;
+            publishTouch(publisher, ++seq, AMOTION_EVENT_ACTION_MOVE, downTime, eventTime, x);
+        }
+        state.ResumeTiming();
+
+        const nsecs_t startTime = now();
+        consumeAndFinish(/*consumeBatches=*/true, /*frameTime=*/eventTime + kSampleInterval);
+        latencies.record(now() - startTime);
+    }
+    latencies.report();
+}
+
 } // namespace
 
 BENCHMARK(benchmarkNotifyMotion);
 BENCHMARK(benchmarkInjectMotion);
 BENCHMARK(benchmarkOnWindowInfosChanged);
+BENCHMARK(benchmarkNotifyMotion_ManyWindows)
+        ->ArgNames({"windows", "spies"})
+        ->Args({0, 0})
+        ->Args({16, 0})
+        ->Args({64, 0})
+        ->Args({16, 4});
+BENCHMARK(benchmarkNotifyMotion_MultiDisplay)->ArgName("displays")->Arg(1)->Arg(4);
+BENCHMARK(benchmarkNotifyMotion_Occluded)->ArgName("overlays")->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK(benchmarkNotifyKey_FocusChange);
+BENCHMARK(benchmarkConsumeBatchedMotion)->ArgName("samples")->Arg(1)->Arg(4)->Arg(16);
 
 } // namespace android::inputdispatcher
 
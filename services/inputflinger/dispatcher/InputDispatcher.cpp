@@ -411,7 +411,7 @@ std::unique_ptr<DispatchEntry> createDispatchEntry(const IdGenerator& idGenerato
 
     if (inputTarget.useDefaultPointerTransform() && !zeroCoords) {
         const ui::Transform& transform = inputTarget.getDefaultPointerTransform();
-        return std::make_unique<DispatchEntry>(eventEntry, inputTargetFlags, transform,
+        return std::make_unique<DispatchEntry>(std::move(eventEntry), inputTargetFlags, transform,
                                                inputTarget.displayTransform,
                                                inputTarget.globalScaleFactor, uid, vsyncId,
                                                windowId);
@@ -464,7 +464,7 @@ std::unique_ptr<DispatchEntry> createDispatchEntry(const IdGenerator& idGenerato
                                           motionEntry.xPrecision, motionEntry.yPrecision,
                                           motionEntry.xCursorPosition, motionEntry.yCursorPosition,
                                           motionEntry.downTime, motionEntry.pointerProperties,
-                                          pointerCoords);
+                                          std::move(pointerCoords));
     if (tracer) {
         combinedMotionEntry->traceTracker =
                 tracer->traceDerivedEvent(*combinedMotionEntry, *motionEntry.traceTracker);
@@ -592,12 +592,20 @@ bool windowAcceptsTouchAt(const WindowInfo& windowInfo, ui::LogicalDisplayId dis
     // "bottom" of the window will be different in the display (un-rotated) space compared to in the
     // logical display in which WM determined the bounds. Perform the hit test in the logical
     // display space to ensure these edges are considered correctly in all orientations.
-    const auto touchableRegion = displayTransform.transform(windowInfo.touchableRegion);
     const auto p = displayTransform.transform(x, y);
-    if (!touchableRegion.contains(std::floor(p.x), std::floor(p.y))) {
+    const int px = std::floor(p.x);
+    const int py = std::floor(p.y);
+    if (displayTransform.getType() == ui::Transform::IDENTITY) {
+        return windowInfo.touchableRegion.contains(px, py);
+    }
+
+    // Transforming the region allocates and re-sweeps it, so first reject points outside of its
+    // transformed bounds, which contain every transformed rect of the region.
+    const Rect bounds = displayTransform.transform(windowInfo.touchableRegion.getBounds());
+    if (px < bounds.left || px >= bounds.right || py < bounds.top || py >= bounds.bottom) {
         return false;
     }
-    return true;
+    return displayTransform.transform(windowInfo.touchableRegion).contains(px, py);
 }
 
 // Returns true if the given window's frame can occlude pointer events at the given display
@@ -921,11 +929,13 @@ InputDispatcher::InputDispatcher(InputDispatcherPolicyInterface& policy,
         mDispatchFrozen(false),
         mInputFilterEnabled(false),
         mMaximumObscuringOpacityForTouch(1.0f),
+        mPerDisplayKeyOrderingEnabled(false),
         mFocusedDisplayId(ui::LogicalDisplayId::DEFAULT),
         mWindowTokenWithPointerCapture(nullptr),
         mAwaitedApplicationDisplayId(ui::LogicalDisplayId::INVALID),
         mLatencyAggregator(),
-        mLatencyTracker(&mLatencyAggregator) {
+        mLatencyBreakdown(&mLatencyAggregator),
+        mLatencyTracker(&mLatencyBreakdown, getLatencyTrackerConfig()) {
     mLooper = sp<Looper>::make(false);
     mReporter = createInputReporter();
 
@@ -1419,6 +1429,7 @@ sp<WindowInfoHandle> InputDispatcher::findTouchedWindowAtLocked(ui::LogicalDispl
                                                                 bool ignoreDragWindow) const {
     // Traverse windows from front to back to find touched window.
     const auto& windowHandles = getWindowHandlesLocked(displayId);
+    const ui::Transform displayTransform = getTransformLocked(displayId);
     for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
         if (ignoreDragWindow && haveSameToken(windowHandle, mDragState->dragWindow)) {
             continue;
@@ -1426,7 +1437,7 @@ sp<WindowInfoHandle> InputDispatcher::findTouchedWindowAtLocked(ui::LogicalDispl
 
         const WindowInfo& info = *windowHandle->getInfo();
         if (!info.isSpy() &&
-            windowAcceptsTouchAt(info, displayId, x, y, isStylus, getTransformLocked(displayId))) {
+            windowAcceptsTouchAt(info, displayId, x, y, isStylus, displayTransform)) {
             return windowHandle;
         }
     }
@@ -1466,10 +1477,11 @@ std::vector<sp<WindowInfoHandle>> InputDispatcher::findTouchedSpyWindowsAtLocked
     // Traverse windows from front to back and gather the touched spy windows.
     std::vector<sp<WindowInfoHandle>> spyWindows;
     const auto& windowHandles = getWindowHandlesLocked(displayId);
+    const ui::Transform displayTransform = getTransformLocked(displayId);
     for (const sp<WindowInfoHandle>& windowHandle : windowHandles) {
         const WindowInfo& info = *windowHandle->getInfo();
 
-        if (!windowAcceptsTouchAt(info, displayId, x, y, isStylus, getTransformLocked(displayId))) {
+        if (!windowAcceptsTouchAt(info, displayId, x, y, isStylus, displayTransform)) {
             continue;
         }
         if (!info.isSpy()) {
@@ -2232,8 +2244,10 @@ ui::LogicalDisplayId InputDispatcher::getTargetDisplayId(const EventEntry& entry
 }
 
 bool InputDispatcher::shouldWaitToSendKeyLocked(nsecs_t currentTime,
-                                                const char* focusedWindowName) {
-    if (mAnrTracker.empty()) {
+                                                const char* focusedWindowName,
+                                                ui::LogicalDisplayId displayId) {
+    if (mAnrTracker.empty() ||
+        (mPerDisplayKeyOrderingEnabled && !hasUnprocessedEventsOnDisplayLocked(displayId))) {
         // already processed all events that we waited for
         mKeyIsWaitingForEventsTimeout = std::nullopt;
         return false;
@@ -2262,6 +2276,21 @@ bool InputDispatcher::shouldWaitToSendKeyLocked(nsecs_t currentTime,
     return false;
 }
 
+bool InputDispatcher::hasUnprocessedEventsOnDisplayLocked(ui::LogicalDisplayId displayId) const {
+    // Only responsive connections are tracked by mAnrTracker, so ignore the others here too.
+    // Monitors have no window and can't change focus, so they are never waited on.
+    for (const auto& [token, connection] : mConnectionsByToken) {
+        if (!connection->responsive || connection->waitQueue.empty()) {
+            continue;
+        }
+        const sp<WindowInfoHandle> window = getWindowHandleLocked(token, displayId);
+        if (window != nullptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
 sp<WindowInfoHandle> InputDispatcher::findFocusedWindowTargetLocked(
         nsecs_t currentTime, const EventEntry& entry, nsecs_t& nextWakeupTime,
         InputEventInjectionResult& outInjectionResult) {
@@ -2346,7 +2375,8 @@ sp<WindowInfoHandle> InputDispatcher::findFocusedWindowTargetLocked(
     // To obtain this behavior, we must serialize key events with respect to all
     // prior input events.
     if (entry.type == EventEntry::Type::KEY) {
-        if (shouldWaitToSendKeyLocked(currentTime, focusedWindowHandle->getName().c_str())) {
+        if (shouldWaitToSendKeyLocked(currentTime, focusedWindowHandle->getName().c_str(),
+                                      displayId)) {
             nextWakeupTime = std::min(nextWakeupTime, *mKeyIsWaitingForEventsTimeout);
             outInjectionResult = InputEventInjectionResult::PENDING;
             return nullptr;
@@ -3142,13 +3172,14 @@ InputDispatcher::TouchOcclusionInfo InputDispatcher::computeTouchOcclusionInfoLo
     info.obscuringOpacity = 0;
     info.obscuringUid = gui::Uid::INVALID;
     std::map<gui::Uid, float> opacityByUid;
+    const ui::Transform displayTransform = getTransformLocked(displayId);
     for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
         if (windowHandle == otherHandle) {
             break; // All future windows are below us. Exit early.
         }
         const WindowInfo* otherInfo = otherHandle->getInfo();
         if (canBeObscuredBy(windowHandle, otherHandle) &&
-            windowOccludesTouchAt(*otherInfo, displayId, x, y, getTransformLocked(displayId)) &&
+            windowOccludesTouchAt(*otherInfo, displayId, x, y, displayTransform) &&
             !haveSameApplicationToken(windowInfo, otherInfo)) {
             if (DEBUG_TOUCH_OCCLUSION) {
                 info.debugInfo.push_back(
@@ -3221,13 +3252,14 @@ bool InputDispatcher::isWindowObscuredAtPointLocked(const sp<WindowInfoHandle>&
                                                     float x, float y) const {
     ui::LogicalDisplayId displayId = windowHandle->getInfo()->displayId;
     const std::vector<sp<WindowInfoHandle>>& windowHandles = getWindowHandlesLocked(displayId);
+    const ui::Transform displayTransform = getTransformLocked(displayId);
     for (const sp<WindowInfoHandle>& otherHandle : windowHandles) {
         if (windowHandle == otherHandle) {
             break; // All future windows are below us. Exit early.
         }
         const WindowInfo* otherInfo = otherHandle->getInfo();
         if (canBeObscuredBy(windowHandle, otherHandle) &&
-            windowOccludesTouchAt(*otherInfo, displayId, x, y, getTransformLocked(displayId))) {
+            windowOccludesTouchAt(*otherInfo, displayId, x, y, displayTransform)) {
             return true;
         }
     }
@@ -4378,7 +4410,7 @@ void InputDispatcher::synthesizePointerDownEventsForConnectionLocked(
 std::unique_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
         const MotionEntry& originalMotionEntry, std::bitset<MAX_POINTER_ID + 1> pointerIds,
         nsecs_t splitDownTime) {
-    const auto& [action, pointerProperties, pointerCoords] =
+    auto [action, pointerProperties, pointerCoords] =
             MotionEvent::split(originalMotionEntry.action, originalMotionEntry.flags,
                                /*historySize=*/0, originalMotionEntry.pointerProperties,
                                originalMotionEntry.pointerCoords, pointerIds);
@@ -4426,7 +4458,7 @@ std::unique_ptr<MotionEntry> InputDispatcher::splitMotionEvent(
                                           originalMotionEntry.yPrecision,
                                           originalMotionEntry.xCursorPosition,
                                           originalMotionEntry.yCursorPosition, splitDownTime,
-                                          pointerProperties, pointerCoords);
+                                          std::move(pointerProperties), std::move(pointerCoords));
     if (mTracer) {
         splitMotionEntry->traceTracker =
                 mTracer->traceDerivedEvent(*splitMotionEntry, *originalMotionEntry.traceTracker);
@@ -5674,6 +5706,16 @@ void InputDispatcher::setMaximumObscuringOpacityForTouch(float opacity) {
     mMaximumObscuringOpacityForTouch = opacity;
 }
 
+void InputDispatcher::setPerDisplayKeyOrderingEnabled(bool enabled) {
+    { // acquire lock
+        std::scoped_lock lock(mLock);
+        mPerDisplayKeyOrderingEnabled = enabled;
+    } // release lock
+
+    // A pending key may no longer need to wait.
+    mLooper->wake();
+}
+
 std::tuple<TouchState*, TouchedWindow*, ui::LogicalDisplayId /*displayId*/>
 InputDispatcher::findTouchStateWindowAndDisplayLocked(const sp<IBinder>& token) {
     for (auto& [displayId, state] : mTouchStatesByDisplay) {
@@ -5893,6 +5935,8 @@ void InputDispatcher::dumpDispatchStateLocked(std::string& dump) const {
     dump += StringPrintf(INDENT "DispatchEnabled: %s\n", toString(mDispatchEnabled));
     dump += StringPrintf(INDENT "DispatchFrozen: %s\n", toString(mDispatchFrozen));
     dump += StringPrintf(INDENT "InputFilterEnabled: %s\n", toString(mInputFilterEnabled));
+    dump += StringPrintf(INDENT "PerDisplayKeyOrderingEnabled: %s\n",
+                         toString(mPerDisplayKeyOrderingEnabled));
     dump += StringPrintf(INDENT "FocusedDisplayId: %s\n", mFocusedDisplayId.toString().c_str());
 
     if (!mFocusedApplicationHandlesByDisplay.empty()) {
@@ -6060,6 +6104,7 @@ void InputDispatcher::dumpDispatchStateLocked(std::string& dump) const {
                          ns2ms(mConfig.keyRepeatTimeout));
     dump += mLatencyTracker.dump(INDENT2);
     dump += mLatencyAggregator.dump(INDENT2);
+    dump += mLatencyBreakdown.dump(INDENT2);
     dump += INDENT "InputTracer: ";
     dump += mTracer == nullptr ? "Disabled" : "Enabled";
 }
@@ -28,6 +28,7 @@
 #include "InputTarget.h"
 #include "InputThread.h"
 #include "LatencyAggregator.h"
+#include "LatencyBreakdown.h"
 #include "LatencyTracker.h"
 #include "Monitor.h"
 #include "TouchState.h"
@@ -123,6 +124,7 @@ public:
     bool setInTouchMode(bool inTouchMode, gui::Pid pid, gui::Uid uid, bool hasPermission,
                         ui::LogicalDisplayId displayId) override;
     void setMaximumObscuringOpacityForTouch(float opacity) override;
+    void setPerDisplayKeyOrderingEnabled(bool enabled) override;
 
     bool transferTouchGesture(const sp<IBinder>& fromToken, const sp<IBinder>& toToken,
                               bool isDragDrop = false) override;
@@ -343,6 +345,7 @@ private:
     bool mDispatchFrozen GUARDED_BY(mLock);
     bool mInputFilterEnabled GUARDED_BY(mLock);
     float mMaximumObscuringOpacityForTouch GUARDED_BY(mLock);
+    bool mPerDisplayKeyOrderingEnabled GUARDED_BY(mLock);
 
     // This map is not really needed, but it helps a lot with debugging (dumpsys input).
     // In the java layer, touch mode states are spread across multiple DisplayContent objects,
@@ -490,7 +493,10 @@ private:
      * without waiting on other events to be processed first.
      */
     std::optional<nsecs_t> mKeyIsWaitingForEventsTimeout GUARDED_BY(mLock);
-    bool shouldWaitToSendKeyLocked(nsecs_t currentTime, const char* focusedWindowName)
+    bool shouldWaitToSendKeyLocked(nsecs_t currentTime, const char* focusedWindowName,
+                                   ui::LogicalDisplayId displayId) REQUIRES(mLock);
+    // Whether a window on the given display has events that it has not yet finished processing.
+    bool hasUnprocessedEventsOnDisplayLocked(ui::LogicalDisplayId displayId) const
             REQUIRES(mLock);
 
     /**
@@ -696,6 +702,7 @@ private:
 
     // Statistics gathering.
     LatencyAggregator mLatencyAggregator GUARDED_BY(mLock);
+    LatencyBreakdown mLatencyBreakdown GUARDED_BY(mLock);
     LatencyTracker mLatencyTracker GUARDED_BY(mLock);
     void traceInboundQueueLengthLocked() REQUIRES(mLock);
     void traceOutboundQueueLength(const Connection& connection);
@@ -19,8 +19,8 @@
 #include "../InputDeviceMetricsSource.h"
 
 #include <binder/IBinder.h>
+#include <ftl/small_map.h>
 #include <input/Input.h>
-#include <unordered_map>
 
 namespace android {
 
@@ -84,13 +84,9 @@ struct InputEventTimeline {
     const uint16_t productId;
     const std::set<InputDeviceUsageSource> sources;
 
-    struct IBinderHash {
-        std::size_t operator()(const sp<IBinder>& b) const {
-            return std::hash<IBinder*>{}(b.get());
-        }
-    };
-
-    std::unordered_map<sp<IBinder>, ConnectionTimeline, IBinderHash> connectionTimelines;
+    // An event is usually delivered to one or two connections, so keep their timelines inline
+    // rather than allocating a node per connection.
+    ftl::SmallMap<sp<IBinder>, ConnectionTimeline, 2> connectionTimelines;
 
     bool operator==(const InputEventTimeline& rhs) const;
 };
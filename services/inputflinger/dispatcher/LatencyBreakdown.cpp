@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "LatencyBreakdown"
+#include "LatencyBreakdown.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <android-base/stringprintf.h>
+#include <log/log.h>
+
+using android::base::StringPrintf;
+
+namespace android::inputdispatcher {
+
+namespace {
+
+constexpr std::array<const char*, SketchIndex::SIZE> STAGE_NAMES = {
+        "eventToRead",          // EVENT_TO_READ: kernel and InputReader
+        "readToDeliver",        // READ_TO_DELIVER: InputDispatcher
+        "deliverToConsume",     // DELIVER_TO_CONSUME: app picking up the event
+        "consumeToFinish",      // CONSUME_TO_FINISH: app handling the event
+        "consumeToGpuComplete", // CONSUME_TO_GPU_COMPLETE: app drawing the response
+        "gpuCompleteToPresent", // GPU_COMPLETE_TO_PRESENT: SurfaceFlinger latch and present
+        "endToEnd",             // END_TO_END
+};
+
+} // namespace
+
+void LatencyBreakdown::StageLatencies::add(nsecs_t latency) {
+    const nsecs_t us = std::clamp<nsecs_t>(ns2us(latency), 0, std::numeric_limits<int32_t>::max());
+    values[next] = static_cast<int32_t>(us);
+    next = (next + 1) % CAPACITY;
+    size = std::min(size + 1, CAPACITY);
+}
+
+LatencyBreakdown::LatencyBreakdown(InputEventTimelineProcessor* next) : mNext(next) {
+    LOG_ALWAYS_FATAL_IF(next == nullptr);
+}
+
+void LatencyBreakdown::processTimeline(const InputEventTimeline& timeline) {
+    Stages& stages = timeline.isDown ? mDownStages : mMoveStages;
+    stages[SketchIndex::EVENT_TO_READ].add(timeline.readTime - timeline.eventTime);
+
+    for (const auto& [token, connectionTimeline] : timeline.connectionTimelines) {
+        if (!connectionTimeline.isComplete()) {
+            continue;
+        }
+        const nsecs_t gpuCompletedTime =
+                connectionTimeline.graphicsTimeline[GraphicsTimeline::GPU_COMPLETED_TIME];
+        const nsecs_t presentTime =
+                connectionTimeline.graphicsTimeline[GraphicsTimeline::PRESENT_TIME];
+        stages[SketchIndex::READ_TO_DELIVER].add(connectionTimeline.deliveryTime -
+                                                 timeline.readTime);
+        stages[SketchIndex::DELIVER_TO_CONSUME].add(connectionTimeline.consumeTime -
+                                                    connectionTimeline.deliveryTime);
+        stages[SketchIndex::CONSUME_TO_FINISH].add(connectionTimeline.finishTime -
+                                                   connectionTimeline.consumeTime);
+        stages[SketchIndex::CONSUME_TO_GPU_COMPLETE].add(gpuCompletedTime -
+                                                         connectionTimeline.consumeTime);
+        stages[SketchIndex::GPU_COMPLETE_TO_PRESENT].add(presentTime - gpuCompletedTime);
+        stages[SketchIndex::END_TO_END].add(presentTime - timeline.eventTime);
+    }
+
+    mNext->processTimeline(timeline);
+}
+
+std::optional<LatencyBreakdown::Percentiles> LatencyBreakdown::getPercentiles(
+        bool isDown, SketchIndex stage) const {
+    const StageLatencies& latencies = (isDown ? mDownStages : mMoveStages)[stage];
+    if (latencies.size == 0) {
+        return std::nullopt;
+    }
+
+    std::vector<int32_t> sorted(latencies.values.begin(),
+                                latencies.values.begin() + latencies.size);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](size_t p) { return us2ns(sorted[(sorted.size() - 1) * p / 100]); };
+    return Percentiles{.count = sorted.size(),
+                       .p50 = percentile(50),
+                       .p90 = percentile(90),
+                       .p99 = percentile(99),
+                       .max = us2ns(sorted.back())};
+}
+
+std::string LatencyBreakdown::dump(const char* prefix) const {
+    std::string dump = StringPrintf("%sLatencyBreakdown (last %zu events, ms):\n", prefix, CAPACITY);
+    for (bool isDown : {true, false}) {
+        dump += StringPrintf("%s  %s:\n", prefix, isDown ? "DOWN" : "MOVE");
+        for (size_t i = 0; i < SketchIndex::SIZE; i++) {
+            const std::optional<Percentiles> percentiles =
+                    getPercentiles(isDown, static_cast<SketchIndex>(i));
+            if (!percentiles) {
+                dump += StringPrintf("%s    %s: <none>\n", prefix, STAGE_NAMES[i]);
+                continue;
+            }
+            dump += StringPrintf("%s    %s: p50=%.1f p90=%.1f p99=%.1f max=%.1f (n=%zu)\n",
+                                 prefix, STAGE_NAMES[i], percentiles->p50 * 1E-6,
+                                 percentiles->p90 * 1E-6, percentiles->p99 * 1E-6,
+                                 percentiles->max * 1E-6, percentiles->count);
+        }
+    }
+    return dump;
+}
+
+} // namespace android::inputdispatcher
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <string>
+
+#include <utils/Timers.h>
+
+#include "InputEventTimeline.h"
+#include "LatencyAggregator.h"
+
+namespace android::inputdispatcher {
+
+/**
+ * Keep the per-stage latencies of the most recent input events, from the kernel timestamp to the
+ * present of the frame drawn in response, so that the input-to-photon breakdown can be read from
+ * dumpsys. Every timeline is then passed on to the next processor.
+ *
+ * Like LatencyTracker, this is not thread-safe.
+ */
+class LatencyBreakdown final : public InputEventTimelineProcessor {
+public:
+    // How many of the most recent latencies are kept for each stage.
+    static constexpr size_t CAPACITY = 512;
+
+    struct Percentiles {
+        size_t count;
+        nsecs_t p50;
+        nsecs_t p90;
+        nsecs_t p99;
+        nsecs_t max;
+    };
+
+    explicit LatencyBreakdown(InputEventTimelineProcessor* next);
+
+    void processTimeline(const InputEventTimeline& timeline) override;
+
+    /**
+     * Return the latency percentiles of a stage across the recent DOWN or MOVE events, or
+     * std::nullopt if no event reached that stage.
+     */
+    std::optional<Percentiles> getPercentiles(bool isDown, SketchIndex stage) const;
+
+    std::string dump(const char* prefix) const;
+
+private:
+    // Latencies are kept in microseconds, which halves the storage compared to nsecs_t.
+    struct StageLatencies {
+        std::array<int32_t, CAPACITY> values;
+        size_t next = 0;
+        size_t size = 0;
+
+        void add(nsecs_t latency);
+    };
+    using Stages = std::array<StageLatencies, SketchIndex::SIZE>;
+
+    InputEventTimelineProcessor* const mNext;
+    Stages mDownStages;
+    Stages mMoveStages;
+};
+
+} // namespace android::inputdispatcher
@@ -20,12 +20,14 @@
 
 #include <inttypes.h>
 
+#include <android-base/parseint.h>
 #include <android-base/properties.h>
 #include <android-base/stringprintf.h>
 #include <android/os/IInputConstants.h>
 #include <input/Input.h>
 #include <input/InputDevice.h>
 #include <log/log.h>
+#include <server_configurable_flags/get_flags.h>
 
 using android::base::HwTimeoutMultiplier;
 using android::base::StringPrintf;
@@ -42,43 +44,54 @@ const std::chrono::duration ANR_TIMEOUT = std::chrono::milliseconds(
         android::os::IInputConstants::UNMULTIPLIED_DEFAULT_DISPATCHING_TIMEOUT_MILLIS *
         HwTimeoutMultiplier());
 
+// Category (=namespace) name for the input settings that are applied at boot time
+static const char* INPUT_NATIVE_BOOT = "input_native_boot";
+// Feature flag name for the LatencyTrackerConfig::sampleInterval of InputDispatcher
+static const char* LATENCY_TRACKER_SAMPLE_INTERVAL = "latency_tracker_sample_interval";
+
 static bool isMatureEvent(nsecs_t eventTime, nsecs_t now) {
     std::chrono::duration age = std::chrono::nanoseconds(now) - std::chrono::nanoseconds(eventTime);
     return age > ANR_TIMEOUT;
 }
 
-/**
- * A multimap allows to have several entries with the same key. This function just erases a specific
- * key-value pair. Equivalent to the imaginary std api std::multimap::erase(key, value).
- */
-template <typename K, typename V>
-static void eraseByValue(std::multimap<K, V>& map, const V& value) {
-    for (auto it = map.begin(); it != map.end();) {
-        if (it->second == value) {
-            it = map.erase(it);
-        } else {
-            it++;
-        }
+LatencyTrackerConfig getLatencyTrackerConfig() {
+    LatencyTrackerConfig config;
+    const std::string interval = server_configurable_flags::
+            GetServerConfigurableFlag(INPUT_NATIVE_BOOT, LATENCY_TRACKER_SAMPLE_INTERVAL,
+                                      std::to_string(config.sampleInterval));
+    if (!android::base::ParseUint(interval, &config.sampleInterval) ||
+        config.sampleInterval == 0) {
+        ALOGE("Invalid %s: %s", LATENCY_TRACKER_SAMPLE_INTERVAL, interval.c_str());
+        config.sampleInterval = 1;
     }
+    return config;
 }
 
-LatencyTracker::LatencyTracker(InputEventTimelineProcessor* processor)
-      : mTimelineProcessor(processor) {
+LatencyTracker::LatencyTracker(InputEventTimelineProcessor* processor,
+                               LatencyTrackerConfig config)
+      : mConfig(config),
+        mTimelines(config.capacity),
+        mEventIds(config.capacity),
+        mTimelineProcessor(processor) {
     LOG_ALWAYS_FATAL_IF(processor == nullptr);
+    LOG_ALWAYS_FATAL_IF(mConfig.capacity == 0 || mConfig.sampleInterval == 0,
+                        "Invalid LatencyTracker config");
 }
 
 void LatencyTracker::trackListener(int32_t inputEventId, bool isDown, nsecs_t eventTime,
                                    nsecs_t readTime, DeviceId deviceId,
                                    const std::set<InputDeviceUsageSource>& sources) {
     reportAndPruneMatureRecords(eventTime);
-    const auto it = mTimelines.find(inputEventId);
-    if (it != mTimelines.end()) {
+    if (static_cast<uint32_t>(inputEventId) % mConfig.sampleInterval != 0) {
+        return;
+    }
+    const std::optional<size_t> slot = findSlot(inputEventId);
+    if (slot) {
         // Input event ids are randomly generated, so it's possible that two events have the same
         // event id. Drop this event, and also drop the existing event because the apps would
         // confuse us by reporting the rest of the timeline for one of them. This should happen
         // rarely, so we won't lose much data
-        mTimelines.erase(it);
-        eraseByValue(mEventTimes, inputEventId);
+        mTimelines[*slot].reset();
         return;
     }
 
@@ -101,30 +114,34 @@ void LatencyTracker::trackListener(int32_t inputEventId, bool isDown, nsecs_t ev
         return;
     }
 
-    mTimelines.emplace(inputEventId,
-                       InputEventTimeline(isDown, eventTime, readTime, identifier->vendor,
-                                          identifier->product, sources));
-    mEventTimes.emplace(eventTime, inputEventId);
+    if (mSize == mConfig.capacity) {
+        // Stop waiting for more information about the oldest event, rather than growing.
+        reportAndPopOldest();
+    }
+    const size_t newSlot = (mOldest + mSize) % mConfig.capacity;
+    mTimelines[newSlot].emplace(isDown, eventTime, readTime, identifier->vendor,
+                                identifier->product, sources);
+    mEventIds[newSlot] = inputEventId;
+    mSize++;
 }
 
 void LatencyTracker::trackFinishedEvent(int32_t inputEventId, const sp<IBinder>& connectionToken,
                                         nsecs_t deliveryTime, nsecs_t consumeTime,
                                         nsecs_t finishTime) {
-    const auto it = mTimelines.find(inputEventId);
-    if (it == mTimelines.end()) {
+    const std::optional<size_t> slot = findSlot(inputEventId);
+    if (!slot) {
         // This could happen if we erased this event when duplicate events were detected. It's
         // also possible that an app sent a bad (or late) 'Finish' signal, since it's free to do
         // anything in its process. Just drop the report and move on.
         return;
     }
 
-    InputEventTimeline& timeline = it->second;
+    InputEventTimeline& timeline = *mTimelines[*slot];
     const auto connectionIt = timeline.connectionTimelines.find(connectionToken);
     if (connectionIt == timeline.connectionTimelines.end()) {
         // Most likely case: app calls 'finishInputEvent' before it reports the graphics timeline
-        timeline.connectionTimelines.emplace(connectionToken,
-                                             ConnectionTimeline{deliveryTime, consumeTime,
-                                                                finishTime});
+        timeline.connectionTimelines.try_emplace(connectionToken, deliveryTime, consumeTime,
+                                                 finishTime);
     } else {
         // Already have a record for this connectionToken
         ConnectionTimeline& connectionTimeline = connectionIt->second;
@@ -133,7 +150,7 @@ void LatencyTracker::trackFinishedEvent(int32_t inputEventId, const sp<IBinder>&
         if (!success) {
             // We are receiving unreliable data from the app. Just delete the entire connection
             // timeline for this event
-            timeline.connectionTimelines.erase(connectionIt);
+            timeline.connectionTimelines.erase(connectionToken);
         }
     }
 }
@@ -141,18 +158,18 @@ void LatencyTracker::trackFinishedEvent(int32_t inputEventId, const sp<IBinder>&
 void LatencyTracker::trackGraphicsLatency(
         int32_t inputEventId, const sp<IBinder>& connectionToken,
         std::array<nsecs_t, GraphicsTimeline::SIZE> graphicsTimeline) {
-    const auto it = mTimelines.find(inputEventId);
-    if (it == mTimelines.end()) {
+    const std::optional<size_t> slot = findSlot(inputEventId);
+    if (!slot) {
         // This could happen if we erased this event when duplicate events were detected. It's
         // also possible that an app sent a bad (or late) 'Timeline' signal, since it's free to do
         // anything in its process. Just drop the report and move on.
         return;
     }
 
-    InputEventTimeline& timeline = it->second;
+    InputEventTimeline& timeline = *mTimelines[*slot];
     const auto connectionIt = timeline.connectionTimelines.find(connectionToken);
     if (connectionIt == timeline.connectionTimelines.end()) {
-        timeline.connectionTimelines.emplace(connectionToken, std::move(graphicsTimeline));
+        timeline.connectionTimelines.try_emplace(connectionToken, std::move(graphicsTimeline));
     } else {
         // Most likely case
         ConnectionTimeline& connectionTimeline = connectionIt->second;
@@ -160,40 +177,56 @@ void LatencyTracker::trackGraphicsLatency(
         if (!success) {
             // We are receiving unreliable data from the app. Just delete the entire connection
             // timeline for this event
-            timeline.connectionTimelines.erase(connectionIt);
+            timeline.connectionTimelines.erase(connectionToken);
         }
     }
 }
 
+std::optional<size_t> LatencyTracker::findSlot(int32_t inputEventId) const {
+    // Reports usually arrive for the most recent events, so search from the newest one.
+    for (size_t i = mSize; i > 0; i--) {
+        const size_t slot = (mOldest + i - 1) % mConfig.capacity;
+        if (mEventIds[slot] == inputEventId && mTimelines[slot]) {
+            return slot;
+        }
+    }
+    return std::nullopt;
+}
+
+void LatencyTracker::reportAndPopOldest() {
+    std::optional<InputEventTimeline>& timeline = mTimelines[mOldest];
+    if (timeline) {
+        mTimelineProcessor->processTimeline(*timeline);
+        timeline.reset();
+    }
+    mOldest = (mOldest + 1) % mConfig.capacity;
+    mSize--;
+}
+
 /**
  * We should use the current time 'now()' here to determine the age of the event, but instead we
  * are using the latest 'eventTime' for efficiency since this time is already acquired, and
  * 'trackListener' should happen soon after the event occurs.
+ * Events are pruned in the order in which they were tracked. That order matches their eventTime
+ * order, except for events of different devices that are racing each other, which could only be
+ * reported slightly later than they mature.
  */
 void LatencyTracker::reportAndPruneMatureRecords(nsecs_t newEventTime) {
-    while (!mEventTimes.empty()) {
-        const auto& [oldestEventTime, oldestInputEventId] = *mEventTimes.begin();
-        if (isMatureEvent(oldestEventTime, /*now=*/newEventTime)) {
-            // Report and drop this event
-            const auto it = mTimelines.find(oldestInputEventId);
-            LOG_ALWAYS_FATAL_IF(it == mTimelines.end(),
-                                "Event %" PRId32 " is in mEventTimes, but not in mTimelines",
-                                oldestInputEventId);
-            const InputEventTimeline& timeline = it->second;
-            mTimelineProcessor->processTimeline(timeline);
-            mTimelines.erase(it);
-            mEventTimes.erase(mEventTimes.begin());
-        } else {
+    while (mSize > 0) {
+        const std::optional<InputEventTimeline>& oldest = mTimelines[mOldest];
+        if (oldest && !isMatureEvent(oldest->eventTime, /*now=*/newEventTime)) {
             // If the oldest event does not need to be pruned, no events should be pruned.
             return;
         }
+        // Report and drop this event, or skip over the slot of a dropped duplicate event
+        reportAndPopOldest();
     }
 }
 
 std::string LatencyTracker::dump(const char* prefix) const {
     return StringPrintf("%sLatencyTracker:\n", prefix) +
-            StringPrintf("%s  mTimelines.size() = %zu\n", prefix, mTimelines.size()) +
-            StringPrintf("%s  mEventTimes.size() = %zu\n", prefix, mEventTimes.size());
+            StringPrintf("%s  tracked events = %zu / %zu\n", prefix, mSize, mConfig.capacity) +
+            StringPrintf("%s  sampleInterval = %" PRIu32 "\n", prefix, mConfig.sampleInterval);
 }
 
 void LatencyTracker::setInputDevices(const std::vector<InputDeviceInfo>& inputDevices) {
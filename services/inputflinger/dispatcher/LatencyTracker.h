@@ -18,8 +18,8 @@
 
 #include "../InputDeviceMetricsSource.h"
 
-#include <map>
-#include <unordered_map>
+#include <optional>
+#include <vector>
 
 #include <binder/IBinder.h>
 #include <input/Input.h>
@@ -29,6 +29,26 @@
 
 namespace android::inputdispatcher {
 
+struct LatencyTrackerConfig {
+    /**
+     * The maximum number of events that can be waiting to mature. If an event is tracked while the
+     * tracker is full, the oldest event is reported early.
+     */
+    size_t capacity = 2048;
+    /**
+     * Only one out of this many events is tracked. Input event ids are random, so selecting events
+     * by id gives an unbiased sample.
+     */
+    uint32_t sampleInterval = 1;
+};
+
+/**
+ * Return the settings of the tracker used by InputDispatcher. The sample interval is read from the
+ * input_native_boot/latency_tracker_sample_interval flag, so that devices can keep measuring
+ * latency with a fraction of the overhead.
+ */
+LatencyTrackerConfig getLatencyTrackerConfig();
+
 /**
  * Maintain a record for input events that are received by InputDispatcher, sent out to the apps,
  * and processed by the apps. Once an event becomes "mature" (older than the ANR timeout), report
@@ -41,8 +61,9 @@ public:
     /**
      * Create a LatencyTracker.
      * param reportingFunction: the function that will be called in order to report full latency.
+     * param config: the storage and sampling settings of the tracker.
      */
-    LatencyTracker(InputEventTimelineProcessor* processor);
+    LatencyTracker(InputEventTimelineProcessor* processor, LatencyTrackerConfig config = {});
     /**
      * Start keeping track of an event identified by inputEventId. This must be called first.
      * If duplicate events are encountered (events that have the same eventId), none of them will be
@@ -63,22 +84,34 @@ public:
     void setInputDevices(const std::vector<InputDeviceInfo>& inputDevices);
 
 private:
+    const LatencyTrackerConfig mConfig;
     /**
-     * A collection of InputEventTimelines keyed by inputEventId. An InputEventTimeline is first
-     * created when 'trackListener' is called.
+     * A fixed-capacity ring of InputEventTimelines, in the order in which 'trackListener' was
+     * called. An InputEventTimeline is first created when 'trackListener' is called.
      * When either 'trackFinishedEvent' or 'trackGraphicsLatency' is called for this input event,
      * the corresponding InputEventTimeline will be updated for that token.
+     * Slots of events that were dropped because of duplicate ids hold no timeline, and are skipped
+     * when the ring is pruned.
+     */
+    std::vector<std::optional<InputEventTimeline>> mTimelines;
+    /**
+     * The inputEventId of each slot of 'mTimelines'. Lookups by id scan this dense array instead of
+     * the much larger timelines.
+     */
+    std::vector<int32_t> mEventIds;
+    // The slot of the oldest tracked event, and the number of occupied slots.
+    size_t mOldest = 0;
+    size_t mSize = 0;
+
+    /**
+     * Return the slot of the live timeline for the provided event, or std::nullopt if the event is
+     * not being tracked.
      */
-    std::unordered_map<int32_t /*inputEventId*/, InputEventTimeline> mTimelines;
+    std::optional<size_t> findSlot(int32_t inputEventId) const;
     /**
-     * The collection of eventTimes will help us quickly find the events that we should prune
-     * from the 'mTimelines'. Since 'mTimelines' is keyed by inputEventId, it would be inefficient
-     * to walk through it directly to find the oldest input events to get rid of.
-     * There is a 1:1 mapping between 'mTimelines' and 'mEventTimes'.
-     * We are using 'multimap' instead of 'map' because there could be more than 1 event with the
-     * same eventTime.
+     * Free the slot of the oldest event, reporting its timeline if it has one.
      */
-    std::multimap<nsecs_t /*eventTime*/, int32_t /*inputEventId*/> mEventTimes;
+    void reportAndPopOldest();
 
     InputEventTimelineProcessor* mTimelineProcessor;
     std::vector<InputDeviceInfo> mInputDevices;
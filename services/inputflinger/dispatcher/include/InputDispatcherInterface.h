@@ -140,6 +140,16 @@ public:
      */
     virtual void setMaximumObscuringOpacityForTouch(float opacity) = 0;
 
+    /**
+     * Sets whether key events are ordered against other events per display.
+     * By default, a key waits for every event that was sent to any window and not yet processed,
+     * since those events may change focus. When this is enabled, a key only waits for the events
+     * that were sent to windows on the display that the key targets. Touch traffic on one display
+     * then no longer delays keys on another. Enable this on devices where every display has its
+     * own focus, such as multi-zone automotive builds.
+     */
+    virtual void setPerDisplayKeyOrderingEnabled(bool enabled) = 0;
+
     /**
      * Transfers a touch gesture from one window to another window. Transferring touch will not
      * have any effect on the focused window.
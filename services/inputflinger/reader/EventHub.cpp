@@ -1851,6 +1851,7 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
     std::array<input_event, EVENT_BUFFER_SIZE> readBuffer;
 
     std::vector<RawEvent> events;
+    events.reserve(EVENT_BUFFER_SIZE);
     bool awoken = false;
     for (;;) {
         nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
@@ -1992,14 +1993,23 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
             }
             // This must be an input event
             if (eventItem.events & EPOLLIN) {
+                if (events.size() >= EVENT_BUFFER_SIZE) {
+                    // The result buffer is already full. Read this device on the next iteration.
+                    mPendingEventIndex -= 1;
+                    break;
+                }
+                // Only read as many events as still fit in the result, so that it never grows past
+                // the capacity reserved above. Anything left stays queued in the kernel and is
+                // read on the next call.
+                const size_t capacity = EVENT_BUFFER_SIZE - events.size();
                 int32_t readSize =
                         read(device->fd, readBuffer.data(),
-                             sizeof(decltype(readBuffer)::value_type) * readBuffer.size());
+                             sizeof(decltype(readBuffer)::value_type) * capacity);
                 if (readSize == 0 || (readSize < 0 && errno == ENODEV)) {
                     // Device was removed before INotify noticed.
                     ALOGW("could not get event, removed? (fd: %d size: %" PRId32
                           " capacity: %zu errno: %d)\n",
-                          device->fd, readSize, readBuffer.size(), errno);
+                          device->fd, readSize, capacity, errno);
                     deviceChanged = true;
                     closeDeviceLocked(*device);
                 } else if (readSize < 0) {
@@ -2011,13 +2021,15 @@ std::vector<RawEvent> EventHub::getEvents(int timeoutMillis) {
                 } else {
                     const int32_t deviceId = device->id == mBuiltInKeyboardId ? 0 : device->id;
 
+                    // Every event in the buffer was read by the same read() call.
+                    const nsecs_t readTime = systemTime(SYSTEM_TIME_MONOTONIC);
                     const size_t count = size_t(readSize) / sizeof(struct input_event);
                     for (size_t i = 0; i < count; i++) {
                         struct input_event& iev = readBuffer[i];
                         device->trackInputEvent(iev);
                         events.push_back({
                                 .when = processEventTimestamp(iev),
-                                .readTime = systemTime(SYSTEM_TIME_MONOTONIC),
+                                .readTime = readTime,
                                 .deviceId = deviceId,
                                 .type = iev.type,
                                 .code = iev.code,
@@ -177,6 +177,7 @@ void InputDevice::addEmptyEventHubDevice(int32_t eventHubId) {
     std::vector<std::unique_ptr<InputMapper>> mappers;
 
     mDevices.insert({eventHubId, std::make_pair(std::move(contextPtr), std::move(mappers))});
+    mMapperRoutesValid = false;
 }
 
 [[nodiscard]] std::list<NotifyArgs> InputDevice::addEventHubDevice(
@@ -194,6 +195,7 @@ void InputDevice::addEmptyEventHubDevice(int32_t eventHubId) {
 
     DevicePair& devicePair = mDevices[eventHubId];
     devicePair.second = createMappers(*devicePair.first, readerConfig);
+    mMapperRoutesValid = false;
 
     // Must change generation to flag this device as changed
     bumpGeneration();
@@ -206,6 +208,7 @@ void InputDevice::removeEventHubDevice(int32_t eventHubId) {
         mController = nullptr;
     }
     mDevices.erase(eventHubId);
+    mMapperRoutesValid = false;
 }
 
 std::list<NotifyArgs> InputDevice::configure(nsecs_t when,
@@ -358,6 +361,7 @@ std::list<NotifyArgs> InputDevice::configureInternal(nsecs_t when,
             out += mapper.reconfigure(when, readerConfig, changes);
             mSources |= mapper.getSources();
         });
+        rebuildMapperRoutes();
 
         if (!changes.any() || changes.test(Change::ENABLED_STATE) ||
             changes.test(Change::DISPLAY_INFO)) {
@@ -386,6 +390,14 @@ std::list<NotifyArgs> InputDevice::process(const RawEvent* rawEvents, size_t cou
     // gamepad button presses are handled by different mappers but they should be dispatched
     // in the order received.
     std::list<NotifyArgs> out;
+    // InputReader hands over one subdevice's events at a time, so the subdevice's mappers are
+    // looked up once per change of subdevice rather than once per event.
+    if (!mMapperRoutesValid) {
+        rebuildMapperRoutes();
+    }
+    std::optional<int32_t> mappersEventHubId;
+    MapperVector* mappers = nullptr;
+    const MapperRoutes* routes = nullptr;
     for (const RawEvent* rawEvent = rawEvents; count != 0; rawEvent++) {
         if (debugRawEvents()) {
             const auto [type, code, value] =
@@ -408,9 +420,22 @@ std::list<NotifyArgs> InputDevice::process(const RawEvent* rawEvents, size_t cou
             ALOGI("Detected input event buffer overrun for device %s.", getName().c_str());
             mDropUntilNextSync = true;
         } else {
-            for_each_mapper_in_subdevice(rawEvent->deviceId, [&](InputMapper& mapper) {
-                out += mapper.process(*rawEvent);
-            });
+            if (rawEvent->deviceId != mappersEventHubId) {
+                mappersEventHubId = rawEvent->deviceId;
+                auto deviceIt = mDevices.find(rawEvent->deviceId);
+                mappers = deviceIt != mDevices.end() ? &deviceIt->second.second : nullptr;
+                auto routesIt = mMapperRoutes.find(rawEvent->deviceId);
+                routes = routesIt != mMapperRoutes.end() ? &routesIt->second : nullptr;
+            }
+            if (routes != nullptr && rawEvent->type >= 0 && rawEvent->type < EV_CNT) {
+                for (InputMapper* mapper : (*routes)[rawEvent->type]) {
+                    out += mapper->process(*rawEvent);
+                }
+            } else if (mappers != nullptr) {
+                for (auto& mapperPtr : *mappers) {
+                    out += mapperPtr->process(*rawEvent);
+                }
+            }
         }
         --count;
     }
@@ -418,6 +443,21 @@ std::list<NotifyArgs> InputDevice::process(const RawEvent* rawEvents, size_t cou
     return out;
 }
 
+void InputDevice::rebuildMapperRoutes() {
+    mMapperRoutes.clear();
+    for (auto& [eventHubId, devicePair] : mDevices) {
+        MapperRoutes& routes = mMapperRoutes[eventHubId];
+        for (auto& mapperPtr : devicePair.second) {
+            for (int32_t type = 0; type < EV_CNT; type++) {
+                if (mapperPtr->isInterestedInEventType(type)) {
+                    routes[type].push_back(mapperPtr.get());
+                }
+            }
+        }
+    }
+    mMapperRoutesValid = true;
+}
+
 void InputDevice::postProcess(std::list<NotifyArgs>& args) const {
     if (mIsWaking) {
         // Update policy flags to request wake for the `NotifyArgs` that come from waking devices.
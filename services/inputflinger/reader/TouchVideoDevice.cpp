@@ -159,15 +159,12 @@ std::unique_ptr<TouchVideoDevice> TouchVideoDevice::create(std::string devicePat
 }
 
 size_t TouchVideoDevice::readAndQueueFrames() {
-    std::vector<TouchVideoFrame> frames = readFrames();
-    const size_t numFrames = frames.size();
+    const size_t numFrames = readFrames();
     if (numFrames == 0) {
         // Likely an error occurred
         return 0;
     }
-    // Concatenate the vectors, then clip up to maximum size allowed
-    mFrames.insert(mFrames.end(), std::make_move_iterator(frames.begin()),
-                   std::make_move_iterator(frames.end()));
+    // Clip up to maximum size allowed
     if (mFrames.size() > MAX_QUEUE_SIZE) {
         // A user-space grip suppression process may be processing the video frames, and holding
         // back the input events. This could result in video frames being produced without the
@@ -180,6 +177,7 @@ size_t TouchVideoDevice::readAndQueueFrames() {
 std::vector<TouchVideoFrame> TouchVideoDevice::consumeFrames() {
     std::vector<TouchVideoFrame> frames = std::move(mFrames);
     mFrames = {};
+    mFrames.reserve(MAX_QUEUE_SIZE);
     return frames;
 }
 
@@ -202,9 +200,10 @@ std::optional<TouchVideoFrame> TouchVideoDevice::readFrame() {
               static_cast<long long>(buf.timestamp.tv_sec),
               static_cast<long long>(buf.timestamp.tv_usec));
     }
-    std::vector<int16_t> data(mHeight * mWidth);
+    // The mmap buffer goes back to the driver below, so this is the one copy of the heatmap.
+    // Later copies of the frame share the data.
     const int16_t* readFrom = mReadLocations[buf.index];
-    std::copy(readFrom, readFrom + mHeight * mWidth, data.begin());
+    std::vector<int16_t> data(readFrom, readFrom + mHeight * mWidth);
     TouchVideoFrame frame(mHeight, mWidth, std::move(data), buf.timestamp);
 
     result = ioctl(mFd.get(), VIDIOC_QBUF, &buf);
@@ -217,18 +216,19 @@ std::optional<TouchVideoFrame> TouchVideoDevice::readFrame() {
 /*
  * This function should not be called unless buffer is ready! This must be checked with
  * select, poll, epoll, or some other similar api first.
- * The oldest frame will be at the beginning of the array.
+ * The frames are appended to mFrames, oldest first.
  */
-std::vector<TouchVideoFrame> TouchVideoDevice::readFrames() {
-    std::vector<TouchVideoFrame> frames;
+size_t TouchVideoDevice::readFrames() {
+    size_t numFrames = 0;
     while (true) {
         std::optional<TouchVideoFrame> frame = readFrame();
         if (!frame) {
             break;
         }
-        frames.push_back(std::move(*frame));
+        mFrames.push_back(std::move(*frame));
+        numFrames++;
     }
-    return frames;
+    return numFrames;
 }
 
 TouchVideoDevice::~TouchVideoDevice() {
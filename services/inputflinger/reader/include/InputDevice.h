@@ -21,6 +21,7 @@
 #include <input/InputDevice.h>
 #include <input/PropertyMap.h>
 
+#include <array>
 #include <cstdint>
 #include <optional>
 #include <unordered_map>
@@ -153,6 +154,7 @@ public:
         auto& mappers = devicePair.second;
         T* mapper = new T(*deviceContext, args...);
         mappers.emplace_back(mapper);
+        mMapperRoutesValid = false;
         return *mapper;
     }
 
@@ -163,6 +165,7 @@ public:
         auto& deviceContext = devicePair.first;
         auto& mappers = devicePair.second;
         mappers.push_back(createInputMapper<T>(*deviceContext, args...));
+        mMapperRoutesValid = false;
         return static_cast<T&>(*mappers.back());
     }
 
@@ -194,6 +197,12 @@ private:
     using DevicePair = std::pair<std::unique_ptr<InputDeviceContext>, MapperVector>;
     // Map from EventHub ID to pair of device context and vector of mapper.
     std::unordered_map<int32_t, DevicePair> mDevices;
+    // The mappers of a subdevice that are interested in each raw event type, in mapper order.
+    using MapperRoutes = std::array<std::vector<InputMapper*>, EV_CNT>;
+    // Map from EventHub ID to the routes of that subdevice's mappers. Rebuilt on configure, and
+    // lazily whenever mappers are added or removed.
+    std::unordered_map<int32_t, MapperRoutes> mMapperRoutes;
+    bool mMapperRoutesValid = false;
     // Misc devices controller for lights, battery, etc.
     std::unique_ptr<PeripheralControllerInterface> mController;
 
@@ -216,6 +225,8 @@ private:
     std::vector<std::unique_ptr<InputMapper>> createMappers(
             InputDeviceContext& contextPtr, const InputReaderConfiguration& readerConfig);
 
+    void rebuildMapperRoutes();
+
     [[nodiscard]] std::list<NotifyArgs> configureInternal(
             nsecs_t when, const InputReaderConfiguration& readerConfig,
             ConfigurationChanges changes, bool forceEnable = false);
@@ -112,9 +112,10 @@ private:
                               uint32_t width,
                               const std::array<const int16_t*, NUM_BUFFERS>& readLocations);
     /**
-     * Read all currently available frames.
+     * Read all currently available frames into the internal queue.
+     * Return the number of frames that were read.
      */
-    std::vector<TouchVideoFrame> readFrames();
+    size_t readFrames();
     /**
      * Read a single frame. May return nullopt if no data is currently available for reading.
      */
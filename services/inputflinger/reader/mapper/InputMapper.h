@@ -79,6 +79,12 @@ public:
                                                             ConfigurationChanges changes);
     [[nodiscard]] virtual std::list<NotifyArgs> reset(nsecs_t when);
     [[nodiscard]] virtual std::list<NotifyArgs> process(const RawEvent& rawEvent) = 0;
+    /**
+     * Returns whether process() needs to see raw events of the given type (EV_KEY, EV_ABS, ...).
+     * InputDevice only routes events to the mappers that are interested in them. The answer may
+     * depend on the configuration, but must not change between calls to reconfigure().
+     */
+    virtual bool isInterestedInEventType(int32_t type) const { return true; }
     [[nodiscard]] virtual std::list<NotifyArgs> timeoutExpired(nsecs_t when);
 
     virtual int32_t getKeyCodeState(uint32_t sourceMask, int32_t keyCode);
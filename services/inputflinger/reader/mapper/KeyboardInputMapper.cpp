@@ -253,6 +253,11 @@ std::list<NotifyArgs> KeyboardInputMapper::process(const RawEvent& rawEvent) {
     return out;
 }
 
+bool KeyboardInputMapper::isInterestedInEventType(int32_t type) const {
+    // EV_MSC and EV_SYN are needed to track the HID usage of each key.
+    return type == EV_KEY || type == EV_MSC || type == EV_SYN;
+}
+
 std::list<NotifyArgs> KeyboardInputMapper::processKey(nsecs_t when, nsecs_t readTime, bool down,
                                                       int32_t scanCode, int32_t usageCode) {
     std::list<NotifyArgs> out;
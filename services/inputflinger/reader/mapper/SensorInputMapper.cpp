@@ -286,6 +286,10 @@ std::list<NotifyArgs> SensorInputMapper::process(const RawEvent& rawEvent) {
     return out;
 }
 
+bool SensorInputMapper::isInterestedInEventType(int32_t type) const {
+    return type == EV_ABS || type == EV_MSC || type == EV_SYN;
+}
+
 bool SensorInputMapper::setSensorEnabled(InputDeviceSensorType sensorType, bool enabled) {
     auto it = mSensors.find(sensorType);
     if (it == mSensors.end()) {
@@ -45,6 +45,10 @@ std::list<NotifyArgs> SwitchInputMapper::process(const RawEvent& rawEvent) {
     return out;
 }
 
+bool SwitchInputMapper::isInterestedInEventType(int32_t type) const {
+    return type == EV_SW || type == EV_SYN;
+}
+
 void SwitchInputMapper::processSwitch(int32_t switchCode, int32_t switchValue) {
     if (switchCode >= 0 && switchCode < 32) {
         if (switchValue) {
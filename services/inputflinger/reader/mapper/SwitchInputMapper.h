@@ -30,6 +30,7 @@ public:
 
     virtual uint32_t getSources() const override;
     [[nodiscard]] std::list<NotifyArgs> process(const RawEvent& rawEvent) override;
+    bool isInterestedInEventType(int32_t type) const override;
 
     virtual int32_t getSwitchState(uint32_t sourceMask, int32_t switchCode) override;
     virtual void dump(std::string& dump) override;
@@ -321,6 +321,7 @@ std::list<NotifyArgs> TouchInputMapper::reconfigure(nsecs_t when,
         changes.test(InputReaderConfiguration::Change::TOUCH_AFFINE_TRANSFORMATION)) {
         // Update location calibration to reflect current settings
         updateAffineTransformation();
+        updateCalibratedRawToDisplay();
     }
 
     if (!changes.any() || changes.test(InputReaderConfiguration::Change::POINTER_SPEED)) {
@@ -1022,6 +1023,7 @@ void TouchInputMapper::configureInputDevice(nsecs_t when, bool* outResetNeeded)
             mRawToRotatedDisplay = mRawToDisplay;
         }
     }
+    updateCalibratedRawToDisplay();
 
     // If moving between pointer modes, need to reset some state.
     bool deviceModeChanged = mDeviceMode != oldDeviceMode;
@@ -1042,6 +1044,7 @@ void TouchInputMapper::configureInputDevice(nsecs_t when, bool* outResetNeeded)
 
         // Location
         updateAffineTransformation();
+        updateCalibratedRawToDisplay();
 
         if (mDeviceMode == DeviceMode::POINTER) {
             // Compute pointer gesture detection parameters.
@@ -1359,6 +1362,14 @@ void TouchInputMapper::updateAffineTransformation() {
                                                                  mInputDeviceOrientation);
 }
 
+void TouchInputMapper::updateCalibratedRawToDisplay() {
+    ui::Transform affine;
+    affine.set({mAffineTransform.x_scale, mAffineTransform.x_ymix, mAffineTransform.x_offset,
+                mAffineTransform.y_xmix, mAffineTransform.y_scale, mAffineTransform.y_offset, 0, 0,
+                1});
+    mCalibratedRawToDisplay = mRawToDisplay * affine;
+}
+
 std::list<NotifyArgs> TouchInputMapper::reset(nsecs_t when) {
     std::list<NotifyArgs> out = cancelTouch(when, when);
 
@@ -2239,6 +2250,12 @@ void TouchInputMapper::cookPointerData() {
         mCurrentCookedState.buttonState = mCurrentRawState.buttonState;
     }
 
+    // Summed sizes are split evenly between the touching pointers, which is the same for every
+    // pointer of this sync.
+    const uint32_t touchingCount = mCurrentRawState.rawPointerData.touchingIdBits.count();
+    const bool splitSummedSize =
+            mCalibration.sizeIsSummed && *mCalibration.sizeIsSummed && touchingCount > 1;
+
     // Walk through the the active pointers and map device coordinates onto
     // display coordinates and adjust for display orientation.
     for (uint32_t i = 0; i < currentPointerCount; i++) {
@@ -2281,15 +2298,12 @@ void TouchInputMapper::cookPointerData() {
                     size = 0;
                 }
 
-                if (mCalibration.sizeIsSummed && *mCalibration.sizeIsSummed) {
-                    uint32_t touchingCount = mCurrentRawState.rawPointerData.touchingIdBits.count();
-                    if (touchingCount > 1) {
-                        touchMajor /= touchingCount;
-                        touchMinor /= touchingCount;
-                        toolMajor /= touchingCount;
-                        toolMinor /= touchingCount;
-                        size /= touchingCount;
-                    }
+                if (splitSummedSize) {
+                    touchMajor /= touchingCount;
+                    touchMinor /= touchingCount;
+                    toolMajor /= touchingCount;
+                    toolMinor /= touchingCount;
+                    size /= touchingCount;
                 }
 
                 if (mCalibration.sizeCalibration == Calibration::SizeCalibration::GEOMETRIC) {
@@ -2387,9 +2401,7 @@ void TouchInputMapper::cookPointerData() {
         }
 
         // Adjust X,Y coords for device calibration and convert to the natural display coordinates.
-        vec2 transformed = {in.x, in.y};
-        mAffineTransform.applyTo(transformed.x /*byRef*/, transformed.y /*byRef*/);
-        transformed = mRawToDisplay.transform(transformed);
+        const vec2 transformed = mCalibratedRawToDisplay.transform(in.x, in.y);
 
         // Write output coords.
         PointerCoords& out = mCurrentCookedState.cookedPointerData.pointerCoords[i];
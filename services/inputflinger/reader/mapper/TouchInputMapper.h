@@ -406,6 +406,7 @@ protected:
     virtual void resolveCalibration();
     virtual void dumpCalibration(std::string& dump);
     virtual void updateAffineTransformation();
+    void updateCalibratedRawToDisplay();
     virtual void dumpAffineTransformation(std::string& dump);
     virtual void resolveExternalStylusPresence();
     virtual bool hasStylus() const = 0;
@@ -444,6 +445,10 @@ private:
     // The transform used for non-planar raw axes, such as orientation and tilt.
     ui::Transform mRawRotation;
 
+    // mRawToDisplay applied after the touch affine calibration, so that cooking a pointer's
+    // location takes a single transform. Must be refreshed whenever either of them changes.
+    ui::Transform mCalibratedRawToDisplay;
+
     float mGeometricScale;
 
     float mPressureScale;
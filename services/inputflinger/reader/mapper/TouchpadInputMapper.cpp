@@ -427,6 +427,12 @@ std::list<NotifyArgs> TouchpadInputMapper::process(const RawEvent& rawEvent) {
     std::optional<SelfContainedHardwareState> state = mStateConverter.processRawEvent(rawEvent);
     if (state) {
         updatePalmDetectionMetrics();
+        if (input_flags::enable_gestures_library_timer_provider()) {
+            // Fire any timers that have already expired before pushing the new state, so that
+            // their gestures are emitted in order and in the same batch as the state's gestures,
+            // instead of in a separate wakeup of the reader.
+            mTimerProvider.triggerDueCallbacks(rawEvent.when);
+        }
         return sendHardwareState(rawEvent.when, rawEvent.readTime, *state);
     } else {
         return {};
@@ -41,6 +41,10 @@ std::list<NotifyArgs> VibratorInputMapper::process(const RawEvent& rawEvent) {
     return {};
 }
 
+bool VibratorInputMapper::isInterestedInEventType(int32_t type) const {
+    return false;
+}
+
 std::list<NotifyArgs> VibratorInputMapper::vibrate(const VibrationSequence& sequence,
                                                    ssize_t repeat, int32_t token) {
     if (DEBUG_VIBRATOR) {
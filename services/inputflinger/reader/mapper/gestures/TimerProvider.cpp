@@ -93,6 +93,13 @@ void TimerProvider::triggerCallbacks(nsecs_t when) {
     requestTimeout();
 }
 
+void TimerProvider::triggerDueCallbacks(nsecs_t when) {
+    if (mDeadlines.empty() || when < mDeadlines.begin()->first) {
+        return;
+    }
+    triggerCallbacks(when);
+}
+
 GesturesTimer* TimerProvider::createTimer() {
     mTimers.push_back(std::make_unique<GesturesTimer>());
     mTimers.back()->id = mNextTimerId;
@@ -45,6 +45,10 @@ public:
 
     std::string dump();
     void triggerCallbacks(nsecs_t when);
+    // Like triggerCallbacks, but does nothing (not even requesting a timeout) if no deadline has
+    // passed. Used to run timers that are due together with an incoming hardware state, rather
+    // than waiting for a separate InputReader timeout.
+    void triggerDueCallbacks(nsecs_t when);
 
     // Methods to be called by the gestures library:
     GesturesTimer* createTimer();
@@ -526,4 +526,35 @@ TEST_F(InputDeviceMetricsCollectorTest, BreakdownUsageByUid_TracksUidsByDevice)
     ASSERT_NO_FATAL_FAILURE(assertUsageNotLogged());
 }
 
+TEST_F(InputDeviceMetricsCollectorTest, BreakdownUsageByUid_LimitsTrackedUids) {
+    // Must match MAX_UIDS_PER_USAGE_SESSION in InputDeviceMetricsCollector.cpp.
+    constexpr int32_t MAX_TRACKED_UIDS = 64;
+    mMetricsCollector.notifyInputDevicesChanged({/*id=*/0, {TOUCHSCREEN_STYLUS_INFO}});
+    UidUsageBreakdown expectedUidBreakdown;
+
+    std::set<gui::Uid> manyUids;
+    for (int32_t uid = 1; uid <= 2 * MAX_TRACKED_UIDS; uid++) {
+        manyUids.emplace(uid);
+    }
+    mMetricsCollector.notifyMotion(generateMotionArgs(DEVICE_ID));
+    mMetricsCollector.notifyDeviceInteraction(DEVICE_ID, currentTime(), manyUids);
+
+    // Uids that are already tracked continue to be tracked.
+    setCurrentTime(TIME + 100ns);
+    mMetricsCollector.notifyMotion(generateMotionArgs(DEVICE_ID));
+    mMetricsCollector.notifyDeviceInteraction(DEVICE_ID, currentTime(), uids({1}));
+
+    expectedUidBreakdown.emplace_back(1, 100ns);
+    for (int32_t uid = 2; uid <= MAX_TRACKED_UIDS; uid++) {
+        expectedUidBreakdown.emplace_back(uid, 0ns);
+    }
+
+    // Remove the device to force the usage session to be logged.
+    mMetricsCollector.notifyInputDevicesChanged({});
+    ASSERT_NO_FATAL_FAILURE(assertUsageLogged(TOUCHSCREEN_STYLUS_INFO, 100ns,
+                                              /*sourceBreakdown=*/{}, expectedUidBreakdown));
+
+    ASSERT_NO_FATAL_FAILURE(assertUsageNotLogged());
+}
+
 } // namespace android
@@ -5954,6 +5954,65 @@ TEST_P(InputDispatcherDisplayOrientationFixture, HitTestInDifferentOrientations)
     window->assertNoEvents();
 }
 
+// This test verifies that a touch inside the bounds of a non-rectangular touchable region, but
+// outside of the region itself, goes to the window below for all rotations of the display.
+TEST_P(InputDispatcherDisplayOrientationFixture,
+       HitTestNonRectangularRegionInDifferentOrientations) {
+    constexpr static int32_t displayWidth = 400;
+    constexpr static int32_t displayHeight = 800;
+
+    std::shared_ptr<FakeApplicationHandle> application = std::make_shared<FakeApplicationHandle>();
+
+    const auto rotation = GetParam();
+    const bool isRotated = rotation == ui::ROTATION_90 || rotation == ui::ROTATION_270;
+    const int32_t logicalDisplayWidth = isRotated ? displayHeight : displayWidth;
+    const int32_t logicalDisplayHeight = isRotated ? displayWidth : displayHeight;
+    const ui::Transform displayTransform(ui::Transform::toRotationFlags(rotation),
+                                         logicalDisplayWidth, logicalDisplayHeight);
+    addDisplayInfo(ui::LogicalDisplayId::DEFAULT, displayTransform);
+
+    // An L-shaped window in the logical display, on top of a window covering the display.
+    const Rect frameInLogicalDisplay(100, 100, 300, 300);
+    sp<FakeWindowHandle> window = sp<FakeWindowHandle>::make(application, mDispatcher, "Window",
+                                                             ui::LogicalDisplayId::DEFAULT);
+    window->setFrame(displayTransform.inverse().transform(frameInLogicalDisplay),
+                     displayTransform);
+    Region touchableRegionInLogicalDisplay(Rect(100, 100, 200, 200));
+    touchableRegionInLogicalDisplay.orSelf(Rect(100, 200, 300, 300));
+    window->setTouchableRegion(
+            displayTransform.inverse().transform(touchableRegionInLogicalDisplay));
+    addWindow(window);
+
+    sp<FakeWindowHandle> background =
+            sp<FakeWindowHandle>::make(application, mDispatcher, "Background",
+                                       ui::LogicalDisplayId::DEFAULT);
+    background->setFrame(Rect(0, 0, displayWidth, displayHeight));
+    addWindow(background);
+
+    const auto tap = [&](vec2 pointInLogicalDisplay) {
+        const vec2 p = displayTransform.inverse().transform(pointInLogicalDisplay);
+        const PointF pointInDisplaySpace{p.x, p.y};
+        mDispatcher->notifyMotion(
+                generateMotionArgs(AMOTION_EVENT_ACTION_DOWN, AINPUT_SOURCE_TOUCHSCREEN,
+                                   ui::LogicalDisplayId::DEFAULT, {pointInDisplaySpace}));
+        mDispatcher->notifyMotion(
+                generateMotionArgs(AMOTION_EVENT_ACTION_UP, AINPUT_SOURCE_TOUCHSCREEN,
+                                   ui::LogicalDisplayId::DEFAULT, {pointInDisplaySpace}));
+    };
+
+    tap({150, 250});
+    window->consumeMotionDown();
+    window->consumeMotionUp();
+
+    // Inside the bounds of the touchable region, but not in the region.
+    tap({250, 150});
+    background->consumeMotionDown();
+    background->consumeMotionUp();
+
+    window->assertNoEvents();
+    background->assertNoEvents();
+}
+
 // This test verifies the occlusion detection for all rotations of the display by tapping
 // in different locations on the display, specifically points close to the four corners of a
 // window.
@@ -8654,6 +8713,42 @@ TEST_F(InputDispatcherFocusOnTwoDisplaysTest, SetInputWindow_MultiDisplayFocus)
     windowInSecondary->assertNoEvents();
 }
 
+/**
+ * With per-display key ordering, a key on one display does not wait for touch events on another
+ * display to be processed. The key still waits for unprocessed events on its own display.
+ */
+TEST_F(InputDispatcherFocusOnTwoDisplaysTest, PerDisplayKeyOrdering_KeyDoesNotWaitForOtherDisplay) {
+    mDispatcher->setPerDisplayKeyOrderingEnabled(true);
+
+    // Touch the primary display, and don't finish the DOWN event.
+    mDispatcher->notifyMotion(MotionArgsBuilder(ACTION_DOWN, AINPUT_SOURCE_TOUCHSCREEN)
+                                      .displayId(ui::LogicalDisplayId::DEFAULT)
+                                      .pointer(PointerBuilder(0, ToolType::FINGER).x(10).y(10))
+                                      .build());
+    const auto& [primarySequenceNum, _] = windowInPrimary->receiveEvent();
+    ASSERT_TRUE(primarySequenceNum);
+
+    // The secondary display is focused. Its key is delivered right away.
+    mDispatcher->notifyKey(KeyArgsBuilder(AKEY_EVENT_ACTION_DOWN, AINPUT_SOURCE_KEYBOARD)
+                                   .policyFlags(DEFAULT_POLICY_FLAGS |
+                                                POLICY_FLAG_DISABLE_KEY_REPEAT)
+                                   .build());
+    windowInSecondary->consumeKeyDown(ui::LogicalDisplayId::INVALID);
+
+    // A key for the primary display waits for the DOWN event to be processed.
+    mDispatcher->notifyKey(KeyArgsBuilder(AKEY_EVENT_ACTION_DOWN, AINPUT_SOURCE_KEYBOARD)
+                                   .displayId(ui::LogicalDisplayId::DEFAULT)
+                                   .policyFlags(DEFAULT_POLICY_FLAGS |
+                                                POLICY_FLAG_DISABLE_KEY_REPEAT)
+                                   .build());
+    windowInPrimary->assertNoEvents(100ms);
+
+    windowInPrimary->finishEvent(*primarySequenceNum);
+    windowInPrimary->consumeKeyDown(ui::LogicalDisplayId::DEFAULT);
+    windowInPrimary->assertNoEvents();
+    windowInSecondary->assertNoEvents();
+}
+
 // Test per-display input monitors for motion event.
 TEST_F(InputDispatcherFocusOnTwoDisplaysTest, MonitorMotionEvent_MultiDisplay) {
     FakeMonitorReceiver monitorInPrimary =
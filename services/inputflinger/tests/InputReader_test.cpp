@@ -17,6 +17,7 @@
 #include <cinttypes>
 #include <memory>
 #include <optional>
+#include <set>
 
 #include <CursorInputMapper.h>
 #include <InputDevice.h>
@@ -166,6 +167,7 @@ class FakeInputMapper : public InputMapper {
     std::unordered_map<int32_t, int32_t> mKeyCodeMapping;
     std::vector<int32_t> mSupportedKeyCodes;
     std::list<NotifyArgs> mProcessResult;
+    std::optional<std::set<int32_t>> mInterestedEventTypes;
 
     std::mutex mLock;
     std::condition_variable mStateChangedCondition;
@@ -196,6 +198,10 @@ public:
         mMetaState = metaState;
     }
 
+    // Restricts the raw event types that the mapper asks to receive. Takes effect on the next
+    // configure.
+    void setInterestedEventTypes(std::set<int32_t> types) { mInterestedEventTypes = types; }
+
     // Sets the return value for the `process` call.
     void setProcessResult(std::list<NotifyArgs> notifyArgs) {
         mProcessResult.clear();
@@ -317,6 +323,10 @@ private:
         return mProcessResult;
     }
 
+    bool isInterestedInEventType(int32_t type) const override {
+        return !mInterestedEventTypes || mInterestedEventTypes->count(type) != 0;
+    }
+
     int32_t getKeyCodeState(uint32_t, int32_t keyCode) override {
         ssize_t index = mKeyCodeStates.indexOfKey(keyCode);
         return index >= 0 ? mKeyCodeStates.valueAt(index) : AKEY_STATE_UNKNOWN;
@@ -3057,6 +3067,44 @@ TEST_F(InputDeviceTest, KernelBufferOverflowResetsMappers) {
     mapper.assertProcessWasCalled();
 }
 
+TEST_F(InputDeviceTest, EventsAreOnlyRoutedToInterestedMappers) {
+    FakeInputMapper& keyMapper =
+            mDevice->addMapper<FakeInputMapper>(EVENTHUB_ID, mFakePolicy->getReaderConfiguration(),
+                                                AINPUT_SOURCE_KEYBOARD);
+    keyMapper.setInterestedEventTypes({EV_KEY, EV_SYN});
+    FakeInputMapper& touchMapper =
+            mDevice->addMapper<FakeInputMapper>(EVENTHUB_ID, mFakePolicy->getReaderConfiguration(),
+                                                AINPUT_SOURCE_TOUCHSCREEN);
+    touchMapper.setInterestedEventTypes({EV_ABS, EV_KEY, EV_SYN});
+    std::list<NotifyArgs> unused =
+            mDevice->configure(ARBITRARY_TIME, mFakePolicy->getReaderConfiguration(),
+                               /*changes=*/{});
+
+    RawEvent event{.when = ARBITRARY_TIME,
+                   .readTime = ARBITRARY_TIME,
+                   .deviceId = EVENTHUB_ID,
+                   .type = EV_ABS,
+                   .code = ABS_MT_POSITION_X,
+                   .value = 100};
+    unused = mDevice->process(&event, /*count=*/1);
+    ASSERT_NO_FATAL_FAILURE(touchMapper.assertProcessWasCalled());
+    ASSERT_NO_FATAL_FAILURE(keyMapper.assertProcessWasNotCalled());
+
+    event.type = EV_KEY;
+    event.code = BTN_TOUCH;
+    event.value = 1;
+    unused = mDevice->process(&event, /*count=*/1);
+    ASSERT_NO_FATAL_FAILURE(touchMapper.assertProcessWasCalled());
+    ASSERT_NO_FATAL_FAILURE(keyMapper.assertProcessWasCalled());
+
+    event.type = EV_SYN;
+    event.code = SYN_REPORT;
+    event.value = 0;
+    unused = mDevice->process(&event, /*count=*/1);
+    ASSERT_NO_FATAL_FAILURE(touchMapper.assertProcessWasCalled());
+    ASSERT_NO_FATAL_FAILURE(keyMapper.assertProcessWasCalled());
+}
+
 // --- SwitchInputMapperTest ---
 
 class SwitchInputMapperTest : public InputMapperTest {
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../dispatcher/LatencyBreakdown.h"
+
+#include <binder/Binder.h>
+#include <gtest/gtest.h>
+
+namespace android::inputdispatcher {
+
+namespace {
+
+// A timeline whose stages take 1, 2, 3, 4, 5 and 6 ms, for a 17 ms total. Every stage is scaled by
+// 'scale'.
+InputEventTimeline makeTimeline(bool isDown, nsecs_t scale) {
+    const nsecs_t eventTime = 1000 * scale;
+    InputEventTimeline timeline(isDown, eventTime, /*readTime=*/eventTime + ms2ns(1) * scale,
+                                /*vendorId=*/0, /*productId=*/0,
+                                /*sources=*/{InputDeviceUsageSource::UNKNOWN});
+    const nsecs_t deliveryTime = timeline.readTime + ms2ns(2) * scale;
+    const nsecs_t consumeTime = deliveryTime + ms2ns(3) * scale;
+    ConnectionTimeline connectionTimeline(deliveryTime, consumeTime,
+                                          /*finishTime=*/consumeTime + ms2ns(4) * scale);
+    std::array<nsecs_t, GraphicsTimeline::SIZE> graphicsTimeline;
+    graphicsTimeline[GraphicsTimeline::GPU_COMPLETED_TIME] = consumeTime + ms2ns(5) * scale;
+    graphicsTimeline[GraphicsTimeline::PRESENT_TIME] =
+            graphicsTimeline[GraphicsTimeline::GPU_COMPLETED_TIME] + ms2ns(6) * scale;
+    connectionTimeline.setGraphicsTimeline(std::move(graphicsTimeline));
+    timeline.connectionTimelines.try_emplace(sp<BBinder>::make(), std::move(connectionTimeline));
+    return timeline;
+}
+
+} // namespace
+
+class LatencyBreakdownTest : public testing::Test, public InputEventTimelineProcessor {
+protected:
+    LatencyBreakdown mBreakdown{this};
+    size_t mNumForwarded = 0;
+
+private:
+    void processTimeline(const InputEventTimeline&) override { mNumForwarded++; }
+};
+
+TEST_F(LatencyBreakdownTest, ReportsEachStage) {
+    mBreakdown.processTimeline(makeTimeline(/*isDown=*/true, /*scale=*/1));
+    EXPECT_EQ(1u, mNumForwarded);
+
+    const std::array<nsecs_t, SketchIndex::SIZE> expected = {ms2ns(1), ms2ns(2), ms2ns(3),
+                                                             ms2ns(4), ms2ns(5), ms2ns(6),
+                                                             ms2ns(17)};
+    for (size_t i = 0; i < SketchIndex::SIZE; i++) {
+        const auto percentiles = mBreakdown.getPercentiles(/*isDown=*/true,
+                                                           static_cast<SketchIndex>(i));
+        ASSERT_TRUE(percentiles.has_value()) << i;
+        EXPECT_EQ(1u, percentiles->count);
+        EXPECT_EQ(expected[i], percentiles->p50) << i;
+        EXPECT_EQ(expected[i], percentiles->max) << i;
+    }
+    EXPECT_FALSE(mBreakdown.getPercentiles(/*isDown=*/false, SketchIndex::END_TO_END));
+}
+
+TEST_F(LatencyBreakdownTest, KeepsOnlyRecentEvents) {
+    // The first events are 100 times slower, but they are pushed out by the later ones.
+    for (size_t i = 0; i < 10; i++) {
+        mBreakdown.processTimeline(makeTimeline(/*isDown=*/false, /*scale=*/100));
+    }
+    for (size_t i = 0; i < LatencyBreakdown::CAPACITY; i++) {
+        mBreakdown.processTimeline(makeTimeline(/*isDown=*/false, /*scale=*/1));
+    }
+
+    const auto percentiles = mBreakdown.getPercentiles(/*isDown=*/false, SketchIndex::END_TO_END);
+    ASSERT_TRUE(percentiles.has_value());
+    EXPECT_EQ(LatencyBreakdown::CAPACITY, percentiles->count);
+    EXPECT_EQ(ms2ns(17), percentiles->p99);
+    EXPECT_EQ(ms2ns(17), percentiles->max);
+}
+
+} // namespace android::inputdispatcher
@@ -72,7 +72,7 @@ InputEventTimeline getTestTimeline() {
     graphicsTimeline[GraphicsTimeline::GPU_COMPLETED_TIME] = 9;
     graphicsTimeline[GraphicsTimeline::PRESENT_TIME] = 10;
     expectedCT.setGraphicsTimeline(std::move(graphicsTimeline));
-    t.connectionTimelines.emplace(sp<BBinder>::make(), std::move(expectedCT));
+    t.connectionTimelines.try_emplace(sp<BBinder>::make(), std::move(expectedCT));
     return t;
 }
 
@@ -244,9 +244,10 @@ TEST_F(LatencyTrackerTest, MultipleEvents_AreReportedConsistently) {
             /*vendorId=*/0,
             /*productId=*/0,
             /*sources=*/{InputDeviceUsageSource::UNKNOWN});
-    timeline1.connectionTimelines.emplace(connection1,
-                                          ConnectionTimeline(/*deliveryTime*/ 6, /*consumeTime*/ 7,
-                                                             /*finishTime*/ 8));
+    timeline1.connectionTimelines.try_emplace(connection1,
+                                              ConnectionTimeline(/*deliveryTime*/ 6,
+                                                                 /*consumeTime*/ 7,
+                                                                 /*finishTime*/ 8));
     ConnectionTimeline& connectionTimeline1 = timeline1.connectionTimelines.begin()->second;
     std::array<nsecs_t, GraphicsTimeline::SIZE> graphicsTimeline1;
     graphicsTimeline1[GraphicsTimeline::GPU_COMPLETED_TIME] = 9;
@@ -261,10 +262,10 @@ TEST_F(LatencyTrackerTest, MultipleEvents_AreReportedConsistently) {
             /*vendorId=*/0,
             /*productId=*/0,
             /*sources=*/{InputDeviceUsageSource::UNKNOWN});
-    timeline2.connectionTimelines.emplace(connection2,
-                                          ConnectionTimeline(/*deliveryTime=*/60,
-                                                             /*consumeTime=*/70,
-                                                             /*finishTime=*/80));
+    timeline2.connectionTimelines.try_emplace(connection2,
+                                              ConnectionTimeline(/*deliveryTime=*/60,
+                                                                 /*consumeTime=*/70,
+                                                                 /*finishTime=*/80));
     ConnectionTimeline& connectionTimeline2 = timeline2.connectionTimelines.begin()->second;
     std::array<nsecs_t, GraphicsTimeline::SIZE> graphicsTimeline2;
     graphicsTimeline2[GraphicsTimeline::GPU_COMPLETED_TIME] = 90;
@@ -313,11 +314,50 @@ TEST_F(LatencyTrackerTest, IncompleteEvents_AreHandledConsistently) {
                                  expectedCT.consumeTime, expectedCT.finishTime);
     mTracker->trackGraphicsLatency(/*inputEventId=*/1, token, expectedCT.graphicsTimeline);
 
-    expectedTimelines[0].connectionTimelines.emplace(token, std::move(expectedCT));
+    expectedTimelines[0].connectionTimelines.try_emplace(token, std::move(expectedCT));
     triggerEventReporting(timeline.eventTime);
     assertReceivedTimelines(expectedTimelines);
 }
 
+/**
+ * When the tracker is full, the oldest event is reported before it matures, instead of growing the
+ * tracker.
+ */
+TEST_F(LatencyTrackerTest, WhenFull_OldestEventIsReportedEarly) {
+    mTracker = std::make_unique<LatencyTracker>(this, LatencyTrackerConfig{.capacity = 2});
+    setDefaultInputDeviceInfo(*mTracker);
+    InputEventTimeline timeline = getTestTimeline();
+
+    for (int32_t inputEventId = 1; inputEventId <= 3; inputEventId++) {
+        mTracker->trackListener(inputEventId, timeline.isDown, timeline.eventTime + inputEventId,
+                                timeline.readTime, DEVICE_ID, {InputDeviceUsageSource::UNKNOWN});
+    }
+    assertReceivedTimelines({InputEventTimeline{timeline.isDown, timeline.eventTime + 1,
+                                                timeline.readTime, timeline.vendorId,
+                                                timeline.productId, timeline.sources}});
+}
+
+/**
+ * Only the events whose id is a multiple of the sample interval are tracked.
+ */
+TEST_F(LatencyTrackerTest, WithSampleInterval_OnlySampledEventsAreTracked) {
+    mTracker = std::make_unique<LatencyTracker>(this, LatencyTrackerConfig{.sampleInterval = 2});
+    setDefaultInputDeviceInfo(*mTracker);
+    InputEventTimeline timeline = getTestTimeline();
+
+    for (int32_t inputEventId = 2; inputEventId <= 5; inputEventId++) {
+        mTracker->trackListener(inputEventId, timeline.isDown, timeline.eventTime,
+                                timeline.readTime, DEVICE_ID, {InputDeviceUsageSource::UNKNOWN});
+    }
+    // Use an unsampled id to trigger the reporting.
+    mTracker->trackListener(/*inputEventId=*/7, timeline.isDown,
+                            timeline.eventTime + std::chrono::nanoseconds(ANR_TIMEOUT).count() + 1,
+                            timeline.readTime, DEVICE_ID, {InputDeviceUsageSource::UNKNOWN});
+    const InputEventTimeline expected{timeline.isDown,   timeline.eventTime, timeline.readTime,
+                                      timeline.vendorId, timeline.productId, timeline.sources};
+    assertReceivedTimelines({expected, expected});
+}
+
 /**
  * For simplicity of the implementation, LatencyTracker only starts tracking an event when
  * 'trackListener' is invoked.
@@ -141,6 +141,19 @@ TEST_F(TimerProviderTest, SingleRescheduledDeadlineTriggers) {
     EXPECT_EQ(2u, callTimes.size());
 }
 
+TEST_F(TimerProviderTest, DueCallbacksOnlyTriggerOncePassedWithoutRequestingTimeouts) {
+    GesturesTimer* timer = mProvider.createTimer();
+    stime_t callTime = -1.0;
+    EXPECT_CALL(mMockContext, requestTimeoutAtTime(1'000'000'000)).Times(1);
+    mProvider.setDeadline(timer, 1'000'000'000, &copyTimeToVariable, &callTime);
+
+    mProvider.triggerDueCallbacks(500'000'000);
+    EXPECT_EQ(-1.0, callTime);
+
+    mProvider.triggerDueCallbacks(1'005'000'000);
+    EXPECT_NEAR(1.005, callTime, EPSILON);
+}
+
 TEST_F(TimerProviderTest, MultipleDeadlinesTriggerWithMultipleTimeouts) {
     GesturesTimer* timer = mProvider.createTimer();
     std::vector<stime_t> callTimes1;
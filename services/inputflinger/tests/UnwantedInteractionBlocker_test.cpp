@@ -1094,4 +1094,31 @@ TEST_F(PalmRejectorFakeFilterTest, CancelTwoPointers) {
     ASSERT_EQ(CANCEL, argsList[0].action);
 }
 
+/**
+ * Events that don't have any rejected pointers are passed through unmodified. The model must still
+ * see single-pointer events, because a palm often lands on its own.
+ */
+TEST_F(PalmRejectorFakeFilterTest, SinglePointerIsPassedThroughUntilSuppressed) {
+    std::vector<NotifyMotionArgs> argsList;
+    constexpr nsecs_t downTime = 0;
+
+    NotifyMotionArgs downArgs = generateMotionArgs(downTime, downTime, DOWN, {{100, 200, 10}});
+    argsList = mPalmRejector->processMotion(downArgs);
+    ASSERT_EQ(1u, argsList.size());
+    ASSERT_EQ(downArgs, argsList[0]);
+
+    NotifyMotionArgs moveArgs =
+            generateMotionArgs(downTime, /*eventTime=*/1, MOVE, {{110, 210, 10}});
+    argsList = mPalmRejector->processMotion(moveArgs);
+    ASSERT_EQ(1u, argsList.size());
+    ASSERT_EQ(moveArgs, argsList[0]);
+
+    suppressPointerAtPosition(120, 220);
+    argsList = mPalmRejector->processMotion(
+            generateMotionArgs(downTime, /*eventTime=*/2, MOVE, {{120, 220, 10}}));
+    ASSERT_EQ(1u, argsList.size());
+    ASSERT_EQ(CANCEL, argsList[0].action);
+    ASSERT_EQ(FLAG_CANCELED, argsList[0].flags);
+}
+
 } // namespace android
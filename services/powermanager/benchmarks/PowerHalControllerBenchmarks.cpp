@@ -18,15 +18,24 @@
 
 #include <aidl/android/hardware/power/Boost.h>
 #include <aidl/android/hardware/power/Mode.h>
+#include <aidl/android/hardware/power/SessionHint.h>
+#include <aidl/android/hardware/power/WorkDuration.h>
 #include <benchmark/benchmark.h>
 #include <powermanager/PowerHalController.h>
 #include <testUtil.h>
+#include <unistd.h>
+#include <algorithm>
 #include <chrono>
+#include <memory>
+#include <vector>
 
 using aidl::android::hardware::power::Boost;
 using aidl::android::hardware::power::Mode;
+using aidl::android::hardware::power::SessionHint;
+using aidl::android::hardware::power::WorkDuration;
 using android::power::HalResult;
 using android::power::PowerHalController;
+using android::power::PowerHintSessionWrapper;
 
 using namespace android;
 using namespace std::chrono_literals;
@@ -108,9 +117,156 @@ static void BM_PowerHalControllerBenchmarks_setModeCached(benchmark::State& stat
     runCachedBenchmark(state, &PowerHalController::setMode, mode, false);
 }
 
+// Shared by all threads of a multi-threaded benchmark, so calls contend on the same controller
+// and session the way SurfaceFlinger's threads do. Set up by thread 0 before the timed loop and
+// torn down after it; benchmark holds every thread at the start and end of the loop, so other
+// threads only touch these inside it.
+static std::unique_ptr<PowerHalController> sContendedController;
+static std::shared_ptr<PowerHintSessionWrapper> sContendedSession;
+
+static constexpr const char* kRequestFailed = "Power HAL request failed";
+static constexpr const char* kSessionUnsupported = "Power HAL doesn't support session";
+
+// Times each call of |fn| and reports tail latency counters alongside the mean, since a single
+// slow call is what costs a frame. |fn| returns nullptr on success, or an error message.
+// |afterEach| runs outside the measured time.
+template <class F, class G>
+static void runLatencyBenchmark(benchmark::State& state, F&& fn, G&& afterEach) {
+    std::vector<int64_t> latenciesNs;
+    latenciesNs.reserve(1024);
+
+    for (auto _ : state) {
+        auto start = std::chrono::steady_clock::now();
+        const char* error = fn();
+        auto end = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+        if (error != nullptr) {
+            if (error == kSessionUnsupported) {
+                state.SkipWithMessage(error);
+            } else {
+                state.SkipWithError(error);
+            }
+            break;
+        }
+        latenciesNs.push_back(std::chrono::nanoseconds(end - start).count());
+        afterEach();
+        testDelaySpin(
+                std::chrono::duration_cast<std::chrono::duration<float>>(ONEWAY_API_DELAY).count());
+    }
+
+    if (latenciesNs.empty()) return;
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    auto percentileUs = [&latenciesNs](double p) {
+        size_t index = static_cast<size_t>(p * (latenciesNs.size() - 1));
+        return latenciesNs[index] / 1000.0;
+    };
+    state.counters["p50_us"] =
+            benchmark::Counter(percentileUs(0.50), benchmark::Counter::kAvgThreads);
+    state.counters["p99_us"] =
+            benchmark::Counter(percentileUs(0.99), benchmark::Counter::kAvgThreads);
+    state.counters["max_us"] =
+            benchmark::Counter(percentileUs(1.0), benchmark::Counter::kAvgThreads);
+}
+
+template <class F>
+static void runLatencyBenchmark(benchmark::State& state, F&& fn) {
+    runLatencyBenchmark(state, std::forward<F>(fn), [] {});
+}
+
+static void setUpContendedSession(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        sContendedController = std::make_unique<PowerHalController>();
+        sContendedController->init();
+        auto ret = sContendedController->createHintSession(getpid(), static_cast<int32_t>(getuid()),
+                                                           {gettid()}, 16666666L);
+        sContendedSession = ret.isOk() ? ret.value() : nullptr;
+    }
+}
+
+static void tearDownContendedSession(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        if (sContendedSession != nullptr) sContendedSession->close();
+        sContendedSession = nullptr;
+        sContendedController = nullptr;
+    }
+}
+
+static void BM_PowerHalControllerBenchmarks_createHintSession(benchmark::State& state) {
+    PowerHalController controller;
+    controller.init();
+    std::vector<int32_t> threadIds{gettid()};
+    std::shared_ptr<PowerHintSessionWrapper> session;
+
+    runLatencyBenchmark(
+            state,
+            [&]() -> const char* {
+                auto ret = controller.createHintSession(getpid(), static_cast<int32_t>(getuid()),
+                                                        threadIds, 16666666L);
+                if (ret.isUnsupported()) return kSessionUnsupported;
+                if (!ret.isOk()) return kRequestFailed;
+                session = ret.value();
+                return session == nullptr ? kSessionUnsupported : nullptr;
+            },
+            [&] {
+                session->close();
+                session = nullptr;
+            });
+}
+
+static void BM_PowerHalControllerBenchmarks_reportActualWorkDuration(benchmark::State& state) {
+    setUpContendedSession(state);
+
+    // Batch size is the argument; SurfaceFlinger reports one duration per frame but batches
+    // them when the HAL falls behind.
+    std::vector<WorkDuration> durations(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < durations.size(); ++i) {
+        durations[i].durationNanos = 8000000L;
+        durations[i].timeStampNanos = static_cast<int64_t>(i + 1);
+    }
+    runLatencyBenchmark(state, [&]() -> const char* {
+        if (sContendedSession == nullptr) return kSessionUnsupported;
+        return sContendedSession->reportActualWorkDuration(durations).isOk() ? nullptr
+                                                                             : kRequestFailed;
+    });
+    tearDownContendedSession(state);
+}
+
+static void BM_PowerHalControllerBenchmarks_sendHint(benchmark::State& state) {
+    setUpContendedSession(state);
+
+    runLatencyBenchmark(state, []() -> const char* {
+        if (sContendedSession == nullptr) return kSessionUnsupported;
+        return sContendedSession->sendHint(SessionHint::CPU_LOAD_UP).isOk() ? nullptr
+                                                                            : kRequestFailed;
+    });
+    tearDownContendedSession(state);
+}
+
+static void BM_PowerHalControllerBenchmarks_setBoostContended(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        sContendedController = std::make_unique<PowerHalController>();
+        sContendedController->init();
+    }
+    runLatencyBenchmark(state, []() -> const char* {
+        return sContendedController->setBoost(Boost::INTERACTION, 0).isFailed() ? kRequestFailed
+                                                                                : nullptr;
+    });
+    if (state.thread_index() == 0) {
+        sContendedController = nullptr;
+    }
+}
+
 BENCHMARK(BM_PowerHalControllerBenchmarks_init);
 BENCHMARK(BM_PowerHalControllerBenchmarks_initCached);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setBoost)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setBoostCached)->DenseRange(FIRST_BOOST, LAST_BOOST, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setMode)->DenseRange(FIRST_MODE, LAST_MODE, 1);
 BENCHMARK(BM_PowerHalControllerBenchmarks_setModeCached)->DenseRange(FIRST_MODE, LAST_MODE, 1);
+BENCHMARK(BM_PowerHalControllerBenchmarks_createHintSession)->UseManualTime();
+BENCHMARK(BM_PowerHalControllerBenchmarks_reportActualWorkDuration)
+        ->RangeMultiplier(4)
+        ->Range(1, 16)
+        ->ThreadRange(1, 8)
+        ->UseManualTime();
+BENCHMARK(BM_PowerHalControllerBenchmarks_sendHint)->ThreadRange(1, 8)->UseManualTime();
+BENCHMARK(BM_PowerHalControllerBenchmarks_setBoostContended)->ThreadRange(1, 8)->UseManualTime();
@@ -487,7 +487,20 @@ void Fusion::predict(const vec3_t& w, float dT) {
     if (x0.w < 0)
         x0 = -x0;
 
-    P = Phi*P*transpose(Phi) + GQGt;
+    // Phi's bottom row is | 0 I33 |, so most blocks of Phi*P*Phi' are plain copies of P.
+    // Expanding the product by hand takes 8 of the 16 mat33 multiplies of the generic form and
+    // gives the same result, since the skipped terms are exact products with 0 and I33.
+    const mat33_t& Phi00 = Phi[0][0];
+    const mat33_t& Phi10 = Phi[1][0];
+    const mat33_t Phi00t(transpose(Phi00));
+    const mat33_t Phi10t(transpose(Phi10));
+    const mat33_t PhiP00(Phi00*P[0][0] + Phi10*P[0][1]);
+    const mat33_t PhiP10(Phi00*P[1][0] + Phi10*P[1][1]);
+    const mat33_t P01(P[0][1]*Phi00t + P[1][1]*Phi10t);
+    P[0][0] = PhiP00*Phi00t + PhiP10*Phi10t + GQGt[0][0];
+    P[1][0] = PhiP10 + GQGt[1][0];
+    P[0][1] = P01 + GQGt[0][1];
+    P[1][1] = P[1][1] + GQGt[1][1];
 
     checkState();
 }
@@ -54,16 +54,31 @@ void RecentEventLogger::setLastEventStale() {
     mIsLastEventCurrent = false;
 }
 
-std::string RecentEventLogger::dump() const {
+RecentEventLogger::Snapshot RecentEventLogger::snapshot() const {
     std::lock_guard<std::mutex> lk(mLock);
+    Snapshot snapshot;
+    snapshot.mSensorType = mSensorType;
+    snapshot.mEventSize = mEventSize;
+    snapshot.mMaskData = mMaskData;
+    snapshot.mEvents.reserve(mRecentEvents.size());
+    for (size_t i = 0; i < mRecentEvents.size(); ++i) {
+        snapshot.mEvents.push_back(mRecentEvents[i]);
+    }
+    return snapshot;
+}
+
+std::string RecentEventLogger::dump() const {
+    return snapshot().dump();
+}
 
+std::string RecentEventLogger::Snapshot::dump() const {
     //TODO: replace String8 with std::string completely in this function
     String8 buffer;
 
-    buffer.appendFormat("last %zu events\n", mRecentEvents.size());
+    buffer.appendFormat("last %zu events\n", mEvents.size());
     int j = 0;
-    for (int i = mRecentEvents.size() - 1; i >= 0; --i) {
-        const auto& ev = mRecentEvents[i];
+    for (int i = mEvents.size() - 1; i >= 0; --i) {
+        const auto& ev = mEvents[i];
         struct tm * timeinfo = localtime(&(ev.mWallTime.tv_sec));
         buffer.appendFormat("\t%2d (ts=%.9f, wall=%02d:%02d:%02d.%03d) ",
                 ++j, ev.mEvent.timestamp/1e9, timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec,
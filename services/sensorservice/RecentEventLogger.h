@@ -24,6 +24,7 @@
 #include <utils/String8.h>
 
 #include <mutex>
+#include <vector>
 
 namespace android {
 namespace SensorServiceUtil {
@@ -58,6 +59,26 @@ protected:
         sensors_event_t mEvent;
     };
 
+public:
+    // A copy of the recorded events and the current format. Taking one only holds the lock for
+    // a copy of at most logSizeBySensorType() events, so the text can be formatted later
+    // without holding up addEvent() or the caller's own locks.
+    class Snapshot {
+    public:
+        std::string dump() const;
+
+    private:
+        friend class RecentEventLogger;
+        int mSensorType = 0;
+        size_t mEventSize = 0;
+        bool mMaskData = false;
+        // Newest event first, same as RingBuffer indexing.
+        std::vector<SensorEventLog> mEvents;
+    };
+
+    Snapshot snapshot() const;
+
+protected:
     const int mSensorType;
     const size_t mEventSize;
 
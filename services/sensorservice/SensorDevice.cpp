@@ -381,8 +381,13 @@ ssize_t SensorDevice::poll(sensors_event_t* buffer, size_t count) {
     }
 
     if (eventsRead > 0) {
+        float resolution = 0;
         for (ssize_t i = 0; i < eventsRead; i++) {
-            float resolution = getResolutionForSensor(buffer[i].sensor);
+            // Events arrive in runs from the same sensor; only look up the resolution (a linear
+            // search of the sensor list) when the sensor changes.
+            if (i == 0 || buffer[i].sensor != buffer[i - 1].sensor) {
+                resolution = getResolutionForSensor(buffer[i].sensor);
+            }
             android::SensorDeviceUtils::quantizeSensorEventValues(&buffer[i], resolution);
 
             if (buffer[i].type == SENSOR_TYPE_DYNAMIC_SENSOR_META) {
@@ -35,6 +35,12 @@ namespace {
 // Used as the default value for the target SDK until it's obtained via getTargetSdkVersion.
 constexpr int kTargetSdkUnknown = 0;
 
+// Returns the sensor an event belongs to. The sensor field is zero for meta_data events, which
+// carry the sensor in meta_data.sensor instead.
+int32_t eventSensorHandle(const sensors_event_t& event) {
+    return event.type == SENSOR_TYPE_META_DATA ? event.meta_data.sensor : event.sensor;
+}
+
 }  // namespace
 
 SensorService::SensorEventConnection::SensorEventConnection(
@@ -297,6 +303,9 @@ status_t SensorService::SensorEventConnection::sendEvents(
 
     int count = 0;
     Mutex::Autolock _l(mConnectionLock);
+    // Sensor access depends on the uid state and sensor privacy, and checking it takes the uid
+    // policy lock. Evaluate it once for the whole batch rather than once per event.
+    const bool hasAccess = hasSensorAccess();
     if (scratch) {
         size_t i=0;
         while (i<numEvents) {
@@ -310,10 +319,13 @@ status_t SensorService::SensorEventConnection::sendEvents(
                 sensor_handle = buffer[i].meta_data.sensor;
             }
 
-            // Check if this connection has registered for this sensor. If not continue to the
-            // next sensor_event.
+            // Check if this connection has registered for this sensor. If not, skip the whole
+            // run of events from this sensor; the HAL delivers events grouped by sensor, so this
+            // keeps the per-connection cost close to one lookup per sensor rather than per event.
             if (mSensorInfo.count(sensor_handle) == 0) {
-                ++i;
+                do {
+                    ++i;
+                } while (i < numEvents && eventSensorHandle(buffer[i]) == sensor_handle);
                 continue;
             }
 
@@ -347,7 +359,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
                 } else {
                     // Regular sensor event, just copy it to the scratch buffer after checking
                     // the AppOp.
-                    if (hasSensorAccess() && noteOpIfRequired(buffer[i])) {
+                    if (hasAccess && noteOpIfRequired(buffer[i])) {
                         scratch[count++] = buffer[i];
                     }
                 }
@@ -358,7 +370,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
                                         buffer[i].meta_data.sensor == sensor_handle)));
         }
     } else {
-        if (hasSensorAccess()) {
+        if (hasAccess) {
             scratch = const_cast<sensors_event_t *>(buffer);
             count = numEvents;
         } else {
@@ -389,7 +401,7 @@ status_t SensorService::SensorEventConnection::sendEvents(
     }
 
     int index_wake_up_event = -1;
-    if (hasSensorAccess()) {
+    if (hasAccess) {
         index_wake_up_event = findWakeUpSensorEventLocked(scratch, count);
         if (index_wake_up_event >= 0) {
             BatteryService::noteWakeupSensorEvent(scratch[index_wake_up_event].timestamp,
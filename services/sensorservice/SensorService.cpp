@@ -578,6 +578,12 @@ SensorService::~SensorService() {
 
 status_t SensorService::dump(int fd, const Vector<String16>& args) {
     String8 result;
+    // Recent events are snapshotted under mLock but formatted after it is released, since
+    // threadLoop needs mLock for every batch it delivers. They are spliced back in at
+    // recentEventsOffset.
+    std::vector<std::pair<std::string, SensorServiceUtil::RecentEventLogger::Snapshot>>
+            recentEvents;
+    size_t recentEventsOffset = 0;
     if (!PermissionCache::checkCallingPermission(sDumpPermission)) {
         result.appendFormat("Permission Denial: can't dump SensorService from pid=%d, uid=%d\n",
                 IPCThreadState::self()->getCallingPid(),
@@ -625,6 +631,7 @@ status_t SensorService::dump(int fd, const Vector<String16>& args) {
             SensorFusion::getInstance().dump(result);
 
             result.append("Recent Sensor events:\n");
+            recentEventsOffset = result.size();
             for (auto&& i : mRecentEvent) {
                 std::shared_ptr<SensorInterface> s = getSensorInterfaceFromHandle(i.first);
                 if (!i.second->isEmpty() && s != nullptr) {
@@ -634,8 +641,8 @@ status_t SensorService::dump(int fd, const Vector<String16>& args) {
                         i.second->setFormat("mask_data");
                     }
                     // if there is events and sensor does not need special permission.
-                    result.appendFormat("%s: ", s->getSensor().getName().c_str());
-                    result.append(i.second->dump().c_str());
+                    recentEvents.emplace_back(s->getSensor().getName().c_str(),
+                                              i.second->snapshot());
                 }
             }
 
@@ -714,7 +721,15 @@ status_t SensorService::dump(int fd, const Vector<String16>& args) {
             } while(startIndex != currentIndex);
         }
     }
-    write(fd, result.c_str(), result.size());
+    std::string output(result.c_str(), result.size());
+    if (!recentEvents.empty()) {
+        std::string events;
+        for (const auto& [name, snapshot] : recentEvents) {
+            events += name + ": " + snapshot.dump();
+        }
+        output.insert(recentEventsOffset, events);
+    }
+    write(fd, output.c_str(), output.size());
     return NO_ERROR;
 }
 
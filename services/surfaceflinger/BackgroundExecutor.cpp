@@ -22,6 +22,8 @@
 #include <processgroup/sched_policy.h>
 #include <pthread.h>
 #include <sched.h>
+#include <android-base/stringprintf.h>
+#include <binder/IPCThreadState.h>
 #include <utils/Log.h>
 #include <mutex>
 
@@ -40,7 +42,8 @@ void set_thread_priority(bool highPriority) {
 
 } // anonymous namespace
 
-BackgroundExecutor::BackgroundExecutor(bool highPriority) {
+BackgroundExecutor::BackgroundExecutor(bool highPriority)
+      : mName(highPriority ? "BckgrndExec HP" : "BckgrndExec LP") {
     // mSemaphore must be initialized before any calls to
     // BackgroundExecutor::sendCallbacks. For this reason, we initialize it
     // within the constructor instead of within mThread.
@@ -53,16 +56,19 @@ BackgroundExecutor::BackgroundExecutor(bool highPriority) {
             if (!callbacks) {
                 continue;
             }
+            mPendingTasks.fetch_sub(callbacks->size(), std::memory_order_relaxed);
+            // Most callbacks notify listeners with oneway binder calls. Send the ones queued
+            // together to the driver together.
+            const bool batch = callbacks->size() > 1;
+            if (batch) IPCThreadState::self()->beginOnewayBatch();
             for (auto& callback : *callbacks) {
                 callback();
+                mExecutedTasks.fetch_add(1, std::memory_order_relaxed);
             }
+            if (batch) IPCThreadState::self()->endOnewayBatch();
         }
     });
-    if (highPriority) {
-        pthread_setname_np(mThread.native_handle(), "BckgrndExec HP");
-    } else {
-        pthread_setname_np(mThread.native_handle(), "BckgrndExec LP");
-    }
+    pthread_setname_np(mThread.native_handle(), mName);
 }
 
 BackgroundExecutor::~BackgroundExecutor() {
@@ -75,6 +81,13 @@ BackgroundExecutor::~BackgroundExecutor() {
 }
 
 void BackgroundExecutor::sendCallbacks(Callbacks&& tasks) {
+    const size_t pending =
+            mPendingTasks.fetch_add(tasks.size(), std::memory_order_relaxed) + tasks.size();
+    size_t maxPending = mMaxPendingTasks.load(std::memory_order_relaxed);
+    while (pending > maxPending &&
+           !mMaxPendingTasks.compare_exchange_weak(maxPending, pending,
+                                                   std::memory_order_relaxed)) {
+    }
     mCallbacksQueue.push(std::move(tasks));
     LOG_ALWAYS_FATAL_IF(sem_post(&mSemaphore), "sem_post failed");
 }
@@ -92,4 +105,22 @@ void BackgroundExecutor::flushQueue() {
     cv.wait(lock, [&]() { return flushComplete; });
 }
 
+BackgroundExecutor::Stats BackgroundExecutor::getStats() const {
+    return {.pendingTasks = mPendingTasks.load(std::memory_order_relaxed),
+            .maxPendingTasks = mMaxPendingTasks.load(std::memory_order_relaxed),
+            .executedTasks = mExecutedTasks.load(std::memory_order_relaxed)};
+}
+
+void BackgroundExecutor::dump(std::string& result) const {
+    const Stats stats = getStats();
+    base::StringAppendF(&result, "  %s: pending=%zu maxPending=%zu executed=%zu\n", mName,
+                        stats.pendingTasks, stats.maxPendingTasks, stats.executedTasks);
+}
+
+void BackgroundExecutor::dumpAll(std::string& result) {
+    result.append("BackgroundExecutor lanes:\n");
+    getInstance().dump(result);
+    getLowPriorityInstance().dump(result);
+}
+
 } // namespace android
@@ -18,22 +18,28 @@
 
 #include <ftl/small_vector.h>
 #include <semaphore.h>
+#include <string>
 #include <thread>
 
 #include "LocklessQueue.h"
 
 namespace android {
 
-// Executes tasks off the main thread.
+// Executes tasks off the main thread. Each instance is a lane with its own thread and scheduling
+// class, so that latency-critical tasks never wait behind bulk work.
 class BackgroundExecutor {
 public:
     ~BackgroundExecutor();
 
+    // Latency-critical lane, running at SCHED_FIFO: window info updates, buffer releases and
+    // anything else a client or InputFlinger is waiting on.
     static BackgroundExecutor& getInstance() {
         static BackgroundExecutor instance(true);
         return instance;
     }
 
+    // Bulk lane, running at SCHED_NORMAL in the background cgroup: cleanup and other work that
+    // nobody is waiting on.
     static BackgroundExecutor& getLowPriorityInstance() {
         static BackgroundExecutor instance(false);
         return instance;
@@ -45,12 +51,29 @@ public:
     void sendCallbacks(Callbacks&& tasks);
     void flushQueue();
 
+    struct Stats {
+        size_t pendingTasks = 0;
+        size_t maxPendingTasks = 0;
+        size_t executedTasks = 0;
+    };
+    Stats getStats() const;
+
+    void dump(std::string& result) const;
+    // Dumps the queue depth of every lane.
+    static void dumpAll(std::string& result);
+
 private:
     BackgroundExecutor(bool highPriority);
 
+    const char* const mName;
     sem_t mSemaphore;
     std::atomic_bool mDone = false;
 
+    // Tasks queued but not yet started.
+    std::atomic<size_t> mPendingTasks = 0;
+    std::atomic<size_t> mMaxPendingTasks = 0;
+    std::atomic<size_t> mExecutedTasks = 0;
+
     LocklessQueue<Callbacks> mCallbacksQueue;
     std::thread mThread;
 };
@@ -24,6 +24,7 @@
 #include <android-base/stringprintf.h>
 #include <gui/TraceUtils.h>
 #include <renderengine/impl/ExternalTexture.h>
+#include <ui/PixelFormat.h>
 
 #include "ClientCache.h"
 
@@ -33,30 +34,19 @@ ANDROID_SINGLETON_STATIC_INSTANCE(ClientCache);
 
 ClientCache::ClientCache() : mDeathRecipient(sp<CacheDeathRecipient>::make()) {}
 
-bool ClientCache::getBuffer(const client_cache_t& cacheId,
-                            ClientCacheBuffer** outClientCacheBuffer) {
-    auto& [processToken, id] = cacheId;
+std::shared_ptr<ClientCache::ProcessCache> ClientCache::getProcessCache(
+        const wp<IBinder>& processToken) {
     if (processToken == nullptr) {
-        ALOGE_AND_TRACE("ClientCache::getBuffer - invalid (nullptr) process token");
-        return false;
-    }
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
-        ALOGE_AND_TRACE("ClientCache::getBuffer - invalid process token");
-        return false;
+        ALOGE_AND_TRACE("ClientCache::getProcessCache - invalid (nullptr) process token");
+        return nullptr;
     }
-
-    auto& processBuffers = it->second.second;
-
-    auto bufItr = processBuffers.find(id);
-    if (bufItr == processBuffers.end()) {
-        ALOGE_AND_TRACE("ClientCache::getBuffer - invalid buffer id");
-        return false;
+    std::lock_guard lock(mMutex);
+    auto it = mProcesses.find(processToken);
+    if (it == mProcesses.end()) {
+        ALOGE_AND_TRACE("ClientCache::getProcessCache - invalid process token");
+        return nullptr;
     }
-
-    ClientCacheBuffer& buf = bufItr->second;
-    *outClientCacheBuffer = &buf;
-    return true;
+    return it->second;
 }
 
 base::expected<std::shared_ptr<renderengine::ExternalTexture>, ClientCache::AddError>
@@ -72,47 +62,50 @@ ClientCache::add(const client_cache_t& cacheId, const sp<GraphicBuffer>& buffer)
         return base::unexpected(AddError::Unspecified);
     }
 
-    std::lock_guard lock(mMutex);
-    sp<IBinder> token;
-
-    // If this is a new process token, set a death recipient. If the client process dies, we will
-    // get a callback through binderDied.
-    auto it = mBuffers.find(processToken);
-    if (it == mBuffers.end()) {
-        token = processToken.promote();
-        if (!token) {
-            ALOGE_AND_TRACE("ClientCache::add - invalid token");
-            return base::unexpected(AddError::Unspecified);
-        }
+    std::shared_ptr<ProcessCache> processCache;
+    {
+        std::lock_guard lock(mMutex);
 
-        // Only call linkToDeath if not a local binder
-        if (token->localBinder() == nullptr) {
-            status_t err = token->linkToDeath(mDeathRecipient);
-            if (err != NO_ERROR) {
-                ALOGE_AND_TRACE("ClientCache::add - could not link to death");
+        // If this is a new process token, set a death recipient. If the client process dies, we
+        // will get a callback through binderDied.
+        auto it = mProcesses.find(processToken);
+        if (it == mProcesses.end()) {
+            sp<IBinder> token = processToken.promote();
+            if (!token) {
+                ALOGE_AND_TRACE("ClientCache::add - invalid token");
                 return base::unexpected(AddError::Unspecified);
             }
+
+            // Only call linkToDeath if not a local binder
+            if (token->localBinder() == nullptr) {
+                status_t err = token->linkToDeath(mDeathRecipient);
+                if (err != NO_ERROR) {
+                    ALOGE_AND_TRACE("ClientCache::add - could not link to death");
+                    return base::unexpected(AddError::Unspecified);
+                }
+            }
+            auto [itr, success] =
+                    mProcesses.emplace(processToken,
+                                       std::make_shared<ProcessCache>(std::move(token)));
+            LOG_ALWAYS_FATAL_IF(!success, "failed to insert new process into client cache");
+            it = itr;
         }
-        auto [itr, success] =
-                mBuffers.emplace(processToken,
-                                 std::make_pair(token,
-                                                std::unordered_map<uint64_t, ClientCacheBuffer>()));
-        LOG_ALWAYS_FATAL_IF(!success, "failed to insert new process into client cache");
-        it = itr;
+        processCache = it->second;
     }
 
-    auto& processBuffers = it->second.second;
+    LOG_ALWAYS_FATAL_IF(mRenderEngine == nullptr,
+                        "Attempted to build the ClientCache before a RenderEngine instance was "
+                        "ready!");
 
-    if (processBuffers.size() > BUFFER_CACHE_MAX_SIZE) {
+    std::lock_guard lock(processCache->mutex);
+    if (processCache->buffers.size() > BUFFER_CACHE_MAX_SIZE) {
         ALOGE_AND_TRACE("ClientCache::add - cache is full");
+        mCacheFullCount++;
         return base::unexpected(AddError::CacheFull);
     }
 
-    LOG_ALWAYS_FATAL_IF(mRenderEngine == nullptr,
-                        "Attempted to build the ClientCache before a RenderEngine instance was "
-                        "ready!");
-
-    return (processBuffers[id].buffer = std::make_shared<
+    mAddCount++;
+    return (processCache->buffers[id].buffer = std::make_shared<
                     renderengine::impl::ExternalTexture>(buffer, *mRenderEngine,
                                                          renderengine::impl::ExternalTexture::
                                                                  Usage::READABLE));
@@ -123,23 +116,29 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
     auto& [processToken, id] = cacheId;
     std::vector<sp<ErasedRecipient>> pendingErase;
     {
-        std::lock_guard lock(mMutex);
-        ClientCacheBuffer* buf = nullptr;
-        if (!getBuffer(cacheId, &buf)) {
+        const auto processCache = getProcessCache(processToken);
+        if (!processCache) {
             ALOGE("failed to erase buffer, could not retrieve buffer");
             return nullptr;
         }
 
-        buffer = buf->buffer->getBuffer();
+        std::lock_guard lock(processCache->mutex);
+        auto bufItr = processCache->buffers.find(id);
+        if (bufItr == processCache->buffers.end()) {
+            ALOGE("failed to erase buffer, could not retrieve buffer");
+            return nullptr;
+        }
 
-        for (auto& recipient : buf->recipients) {
+        buffer = bufItr->second.buffer->getBuffer();
+
+        for (auto& recipient : bufItr->second.recipients) {
             sp<ErasedRecipient> erasedRecipient = recipient.promote();
             if (erasedRecipient) {
                 pendingErase.push_back(erasedRecipient);
             }
         }
 
-        mBuffers[processToken].second.erase(id);
+        processCache->buffers.erase(bufItr);
     }
 
     for (auto& recipient : pendingErase) {
@@ -149,41 +148,57 @@ sp<GraphicBuffer> ClientCache::erase(const client_cache_t& cacheId) {
 }
 
 std::shared_ptr<renderengine::ExternalTexture> ClientCache::get(const client_cache_t& cacheId) {
-    std::lock_guard lock(mMutex);
-
-    ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
-        ALOGE("failed to get buffer, could not retrieve buffer");
-        return nullptr;
+    auto& [processToken, id] = cacheId;
+    const auto processCache = getProcessCache(processToken);
+    if (processCache) {
+        std::lock_guard lock(processCache->mutex);
+        auto bufItr = processCache->buffers.find(id);
+        if (bufItr != processCache->buffers.end()) {
+            mGetHitCount++;
+            return bufItr->second.buffer;
+        }
     }
 
-    return buf->buffer;
+    mGetMissCount++;
+    ALOGE("failed to get buffer, could not retrieve buffer");
+    return nullptr;
 }
 
 bool ClientCache::registerErasedRecipient(const client_cache_t& cacheId,
                                           const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
+    auto& [processToken, id] = cacheId;
+    const auto processCache = getProcessCache(processToken);
+    if (!processCache) {
+        ALOGV("failed to register erased recipient, could not retrieve buffer");
+        return false;
+    }
 
-    ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    std::lock_guard lock(processCache->mutex);
+    auto bufItr = processCache->buffers.find(id);
+    if (bufItr == processCache->buffers.end()) {
         ALOGV("failed to register erased recipient, could not retrieve buffer");
         return false;
     }
-    buf->recipients.insert(recipient);
+    bufItr->second.recipients.insert(recipient);
     return true;
 }
 
 void ClientCache::unregisterErasedRecipient(const client_cache_t& cacheId,
                                             const wp<ErasedRecipient>& recipient) {
-    std::lock_guard lock(mMutex);
-
-    ClientCacheBuffer* buf = nullptr;
-    if (!getBuffer(cacheId, &buf)) {
+    auto& [processToken, id] = cacheId;
+    const auto processCache = getProcessCache(processToken);
+    if (!processCache) {
         ALOGE("failed to unregister erased recipient");
         return;
     }
 
-    buf->recipients.erase(recipient);
+    std::lock_guard lock(processCache->mutex);
+    auto bufItr = processCache->buffers.find(id);
+    if (bufItr == processCache->buffers.end()) {
+        ALOGE("failed to unregister erased recipient");
+        return;
+    }
+    bufItr->second.recipients.erase(recipient);
 }
 
 void ClientCache::removeProcess(const wp<IBinder>& processToken) {
@@ -193,14 +208,20 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
             ALOGE("failed to remove process, invalid (nullptr) process token");
             return;
         }
-        std::lock_guard lock(mMutex);
-        auto itr = mBuffers.find(processToken);
-        if (itr == mBuffers.end()) {
-            ALOGE("failed to remove process, could not find process");
-            return;
+        std::shared_ptr<ProcessCache> processCache;
+        {
+            std::lock_guard lock(mMutex);
+            auto itr = mProcesses.find(processToken);
+            if (itr == mProcesses.end()) {
+                ALOGE("failed to remove process, could not find process");
+                return;
+            }
+            processCache = std::move(itr->second);
+            mProcesses.erase(itr);
         }
 
-        for (auto& [id, clientCacheBuffer] : itr->second.second) {
+        std::lock_guard lock(processCache->mutex);
+        for (auto& [id, clientCacheBuffer] : processCache->buffers) {
             client_cache_t cacheId = {processToken, id};
             for (auto& recipient : clientCacheBuffer.recipients) {
                 sp<ErasedRecipient> erasedRecipient = recipient.promote();
@@ -209,7 +230,7 @@ void ClientCache::removeProcess(const wp<IBinder>& processToken) {
                 }
             }
         }
-        mBuffers.erase(itr);
+        processCache->buffers.clear();
     }
 
     for (auto& [recipient, cacheId] : pendingErase) {
@@ -222,11 +243,34 @@ void ClientCache::CacheDeathRecipient::binderDied(const wp<IBinder>& who) {
 }
 
 void ClientCache::dump(std::string& result) {
-    std::lock_guard lock(mMutex);
-    for (const auto& [_, cache] : mBuffers) {
-        base::StringAppendF(&result, " Cache owner: %p\n", cache.first.get());
+    base::StringAppendF(&result,
+                        " Adds: %" PRIu64 ", rejected (cache full): %" PRIu64 ", lookups: %" PRIu64
+                        " hits / %" PRIu64 " misses\n",
+                        mAddCount.load(), mCacheFullCount.load(), mGetHitCount.load(),
+                        mGetMissCount.load());
+
+    std::vector<std::shared_ptr<ProcessCache>> processCaches;
+    {
+        std::lock_guard lock(mMutex);
+        processCaches.reserve(mProcesses.size());
+        for (const auto& [_, processCache] : mProcesses) {
+            processCaches.push_back(processCache);
+        }
+    }
+
+    for (const auto& processCache : processCaches) {
+        std::lock_guard lock(processCache->mutex);
+        uint64_t totalBytes = 0;
+        for (const auto& [_, entry] : processCache->buffers) {
+            const auto& buffer = entry.buffer->getBuffer();
+            totalBytes += static_cast<uint64_t>(buffer->getStride()) * buffer->getHeight() *
+                    bytesPerPixel(buffer->getPixelFormat());
+        }
+        base::StringAppendF(&result, " Cache owner: %p, %zu buffers, %.2f MB\n",
+                            processCache->token.get(), processCache->buffers.size(),
+                            static_cast<float>(totalBytes) / (1024.f * 1024.f));
 
-        for (const auto& [id, entry] : cache.second) {
+        for (const auto& [id, entry] : processCache->buffers) {
             const auto& buffer = entry.buffer->getBuffer();
             base::StringAppendF(&result, "\tID: %" PRIu64 ", size: %ux%u\n", id, buffer->getWidth(),
                                 buffer->getHeight());
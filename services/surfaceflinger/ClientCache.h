@@ -24,7 +24,9 @@
 #include <utils/RefBase.h>
 #include <utils/Singleton.h>
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <unordered_map>
@@ -78,16 +80,25 @@ public:
     void dump(std::string& result);
 
 private:
-    std::mutex mMutex;
-
     struct ClientCacheBuffer {
         std::shared_ptr<renderengine::ExternalTexture> buffer;
         std::set<wp<ErasedRecipient>> recipients;
     };
-    std::map<wp<IBinder> /*caching process*/,
-             std::pair<sp<IBinder> /*strong ref to caching process*/,
-                       std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer>>>
-            mBuffers GUARDED_BY(mMutex);
+
+    // Buffers cached by a single process. Each process has its own lock, so that processes
+    // caching buffers do not contend with each other or with lookups on the main thread.
+    struct ProcessCache {
+        explicit ProcessCache(sp<IBinder> token) : token(std::move(token)) {}
+
+        std::mutex mutex;
+        const sp<IBinder> token; // strong ref to caching process
+        std::unordered_map<uint64_t /*cache id*/, ClientCacheBuffer> buffers GUARDED_BY(mutex);
+    };
+
+    // Only held to look up, add or remove a process, never while a ProcessCache is locked.
+    std::mutex mMutex;
+    std::map<wp<IBinder> /*caching process*/, std::shared_ptr<ProcessCache>> mProcesses
+            GUARDED_BY(mMutex);
 
     class CacheDeathRecipient : public IBinder::DeathRecipient {
     public:
@@ -97,8 +108,14 @@ private:
     sp<CacheDeathRecipient> mDeathRecipient;
     renderengine::RenderEngine* mRenderEngine = nullptr;
 
-    bool getBuffer(const client_cache_t& cacheId, ClientCacheBuffer** outClientCacheBuffer)
-            REQUIRES(mMutex);
+    // Statistics reported by dump.
+    std::atomic<uint64_t> mAddCount = 0;
+    std::atomic<uint64_t> mCacheFullCount = 0;
+    std::atomic<uint64_t> mGetHitCount = 0;
+    std::atomic<uint64_t> mGetMissCount = 0;
+
+    std::shared_ptr<ProcessCache> getProcessCache(const wp<IBinder>& processToken)
+            EXCLUDES(mMutex);
 };
 
 }; // namespace android
@@ -157,6 +157,9 @@ public:
         // only has a value if there's something needing it, like when a TrustedPresentationListener
         // is set
         std::optional<Region> aboveCoveredLayersExcludingOverlays;
+        // Whether the opaque layers above cover the entire output, in which case no layer below
+        // them can be visible
+        bool aboveOpaqueLayersCoverOutput = false;
     };
 
     virtual ~Output();
@@ -54,8 +54,14 @@ private:
         std::vector<LayerFE::LayerSettings> layerSettings;
         ClientCompositionRequest(const renderengine::DisplaySettings& _display,
                                  const std::vector<LayerFE::LayerSettings>& _layerSettings);
+        // Replaces the request in place, reusing the existing layer settings storage.
+        void update(const renderengine::DisplaySettings& _display,
+                    const std::vector<LayerFE::LayerSettings>& _layerSettings);
         bool equals(const renderengine::DisplaySettings& _display,
                     const std::vector<LayerFE::LayerSettings>& _layerSettings) const;
+
+    private:
+        void setLayerSettings(const std::vector<LayerFE::LayerSettings>& _layerSettings);
     };
 
     // Cache of requests, keyed by corresponding GraphicBuffer ID.
@@ -64,6 +64,7 @@ public:
     void setExpensiveRenderingExpected(bool) override;
     void finishFrame(GpuCompositionResult&&) override;
     bool supportsOffloadPresent() const override;
+    bool supportsPartialClientComposition() const override;
 
     // compositionengine::Display overrides
     DisplayId getId() const override;
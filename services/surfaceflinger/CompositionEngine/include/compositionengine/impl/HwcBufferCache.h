@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <optional>
 #include <stack>
 #include <unordered_map>
 
@@ -63,8 +65,13 @@ private:
 public:
     // public for testing
     // Override buffers don't use the normal cache slots because we don't want them to evict client
-    // buffers from the cache. We add an extra slot at the end for the override buffers.
+    // buffers from the cache. We add extra slots at the end for the override buffers, starting at
+    // kOverrideBufferSlot.
     static const constexpr size_t kOverrideBufferSlot = kMaxLayerBufferCount;
+    // Override buffers come from the Planner's TexturePool, which rotates through up to four
+    // textures. With one slot per texture, a texture that comes back around is not re-imported.
+    // Composer HAL layers are created with this many slots on top of the BufferQueue slots.
+    static const constexpr size_t kOverrideBufferSlotCount = 4;
 
     HwcBufferCache();
 
@@ -105,9 +112,16 @@ private:
     };
 
     std::unordered_map<uint64_t, Cache> mCacheByBufferId;
-    sp<GraphicBuffer> mLastOverrideBuffer;
+
+    // Override buffers are only tracked by ID. GraphicBuffer IDs are never reused, and not holding
+    // a reference lets the TexturePool free its textures.
+    struct OverrideCache {
+        std::optional<uint64_t> bufferId;
+        uint64_t lruCounter = 0;
+    };
+    std::array<OverrideCache, kOverrideBufferSlotCount> mOverrideCaches;
     std::stack<uint32_t> mFreeSlots;
-    uint64_t mLeastRecentlyUsedCounter;
+    uint64_t mLeastRecentlyUsedCounter = 0;
 };
 
 } // namespace compositionengine::impl
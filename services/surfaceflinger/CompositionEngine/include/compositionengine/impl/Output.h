@@ -34,7 +34,10 @@
 #include <renderengine/DisplaySettings.h>
 #include <renderengine/LayerSettings.h>
 
+#include <deque>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -169,6 +172,10 @@ protected:
 
     bool mustRecompose() const;
 
+    // Whether client composition may redraw only the stale part of each client target buffer.
+    // This requires that nothing but this output writes to the buffers of its render surface.
+    virtual bool supportsPartialClientComposition() const { return false; }
+
     const std::string& getNamePlusId() const { return mNamePlusId; }
 
 private:
@@ -180,6 +187,11 @@ private:
             const compositionengine::CompositionRefreshArgs&) const;
     void updateHwcAsyncWorker();
     float getHdrSdrRatio(const std::shared_ptr<renderengine::ExternalTexture>& buffer) const;
+    std::optional<Region> computeClientCompositionFrameDamage(
+            const renderengine::DisplaySettings&, const std::vector<LayerFE::LayerSettings>&) const;
+    std::optional<Region> updateClientCompositionDamage(const renderengine::DisplaySettings&,
+                                                        const std::vector<LayerFE::LayerSettings>&,
+                                                        uint64_t clientTargetId);
 
     std::string mName;
     std::string mNamePlusId;
@@ -198,6 +210,28 @@ private:
 
     // Whether the content must be recomposed this frame.
     bool mMustRecompose = false;
+
+    // The last client composition request, used to find what changed in the next one. The buffers
+    // and fences are cleared from the layers and identified separately, so that the request does
+    // not keep them alive.
+    struct ClientCompositionSnapshot {
+        struct BufferKey {
+            uint64_t bufferId = 0;
+            uint64_t frameNumber = 0;
+            wp<Fence> fence;
+        };
+
+        renderengine::DisplaySettings display;
+        std::vector<renderengine::LayerSettings> layers;
+        std::vector<BufferKey> buffers;
+    };
+    std::optional<ClientCompositionSnapshot> mLastClientComposition;
+    // Area that changed in each of the most recent client compositions, in layer stack space,
+    // oldest first. Unset for compositions that changed too much to track.
+    std::deque<std::optional<Region>> mClientCompositionDamage;
+    uint64_t mClientCompositionCount = 0;
+    // The client composition each client target buffer was last drawn for, by buffer id.
+    std::unordered_map<uint64_t, uint64_t> mClientTargetDrawnAt;
 };
 
 // This template factory function standardizes the implementation details of the
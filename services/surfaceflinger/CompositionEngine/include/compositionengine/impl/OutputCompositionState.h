@@ -19,6 +19,7 @@
 #include <cstdint>
 #include "aidl/android/hardware/graphics/composer3/DimmingStage.h"
 
+#include <ftl/small_vector.h>
 #include <math/mat4.h>
 #include <ui/FenceTime.h>
 
@@ -165,9 +166,23 @@ struct OutputCompositionState {
 
     bool treat170mAsSrgb = false;
 
-    uint64_t lastOutputLayerHash = 0;
     uint64_t outputLayerHash = 0;
 
+    // The composition strategy last chosen by the device for a given outputLayerHash.
+    struct CompositionStrategyHistoryEntry {
+        uint64_t outputLayerHash = 0;
+        std::optional<android::HWComposer::DeviceRequestedChanges> changes;
+        bool success = false;
+        // Number of consecutive frames on which predicting this strategy failed.
+        uint32_t missCount = 0;
+    };
+
+    // Recently chosen composition strategies, most recently used first. Lets the strategy be
+    // predicted when the output flips between a few layer stacks, not only when it is unchanged.
+    static constexpr size_t kCompositionStrategyHistorySize = 4;
+    ftl::SmallVector<CompositionStrategyHistoryEntry, kCompositionStrategyHistorySize>
+            compositionStrategyHistory;
+
     ICEPowerCallback* powerCallback = nullptr;
 
     // Debugging
@@ -229,6 +229,11 @@ private:
 
     void buildCachedSets(std::chrono::steady_clock::time_point now);
 
+    // Returns how long rendering the cached set is expected to take on this thread, scaling the
+    // measured cost of previous renders by its creation cost once one has been measured.
+    std::chrono::nanoseconds estimateRenderDuration(const CachedSet&) const;
+    void recordRenderDuration(const CachedSet&, std::chrono::nanoseconds);
+
     renderengine::RenderEngine& mRenderEngine;
     const Tunables mTunables;
 
@@ -246,6 +251,9 @@ private:
 
     std::vector<CachedSet> mLayers;
 
+    // Moving average of the time spent rendering a cached set, per pixel of creation cost
+    std::optional<float> mRenderNanosPerPixel;
+
     // Statistics
     size_t mUnflattenedDisplayCost = 0;
     size_t mFlattenedDisplayCost = 0;
@@ -32,7 +32,8 @@ namespace android::compositionengine::impl::planner {
 // memory, it is a simpler implementation to only manage screen-sized textures. The texture pool is
 // unbounded - there are a minimum number of textures preallocated. Under heavy system load, new
 // textures may be allocated, but only a maximum number of retained once those textures are no
-// longer necessary.
+// longer necessary. Textures that sit unused in the pool for long enough are released, so that
+// an output which stopped caching layers does not keep holding screen-sized buffers.
 class TexturePool {
 public:
     // RAII class helping with managing textures from the texture pool
@@ -83,16 +84,23 @@ public:
     // be held by the pool. This is useful when the active display changes.
     void setEnabled(bool enable);
 
+    // Releases the textures that have not been borrowed in the last kIdleTextureTimeout.
+    // Textures are allocated again on demand when borrowed.
+    void releaseIdleTextures(std::chrono::steady_clock::time_point now);
+
     void dump(std::string& out) const;
 
 protected:
     // Proteted visibility so that they can be used for testing
     const static constexpr size_t kMinPoolSize = 3;
     const static constexpr size_t kMaxPoolSize = 4;
+    const static constexpr std::chrono::seconds kIdleTextureTimeout = std::chrono::seconds(30);
 
     struct Entry {
         std::shared_ptr<renderengine::ExternalTexture> texture;
         sp<Fence> fence;
+        // When the texture was allocated or last returned to the pool
+        std::chrono::steady_clock::time_point returnTime;
     };
 
     std::deque<Entry> mPool;
@@ -106,6 +114,11 @@ private:
     renderengine::RenderEngine& mRenderEngine;
     ui::Size mSize;
     bool mEnabled;
+
+    // Statistics
+    size_t mBorrowHits = 0;
+    size_t mBorrowMisses = 0;
+    size_t mIdleReleases = 0;
 };
 
 } // namespace android::compositionengine::impl::planner
@@ -70,8 +70,22 @@ ClientCompositionRequestCache::ClientCompositionRequest::ClientCompositionReques
         const renderengine::DisplaySettings& initDisplay,
         const std::vector<LayerFE::LayerSettings>& initLayerSettings)
       : display(initDisplay) {
-    layerSettings.reserve(initLayerSettings.size());
-    for (const LayerFE::LayerSettings& settings : initLayerSettings) {
+    setLayerSettings(initLayerSettings);
+}
+
+void ClientCompositionRequestCache::ClientCompositionRequest::update(
+        const renderengine::DisplaySettings& newDisplay,
+        const std::vector<LayerFE::LayerSettings>& newLayerSettings) {
+    display = newDisplay;
+    setLayerSettings(newLayerSettings);
+}
+
+void ClientCompositionRequestCache::ClientCompositionRequest::setLayerSettings(
+        const std::vector<LayerFE::LayerSettings>& newLayerSettings) {
+    // Clearing keeps the capacity so a request that is updated every frame does not reallocate.
+    layerSettings.clear();
+    layerSettings.reserve(newLayerSettings.size());
+    for (const LayerFE::LayerSettings& settings : newLayerSettings) {
         layerSettings.push_back(getLayerSettingsSnapshot(settings));
     }
 }
@@ -98,10 +112,9 @@ bool ClientCompositionRequestCache::exists(
 void ClientCompositionRequestCache::add(uint64_t bufferId,
                                         const renderengine::DisplaySettings& display,
                                         const std::vector<LayerFE::LayerSettings>& layerSettings) {
-    const ClientCompositionRequest request(display, layerSettings);
     for (auto& [cachedBufferId, cachedRequest] : mCache) {
         if (cachedBufferId == bufferId) {
-            cachedRequest = std::move(request);
+            cachedRequest.update(display, layerSettings);
             return;
         }
     }
@@ -110,7 +123,7 @@ void ClientCompositionRequestCache::add(uint64_t bufferId,
         mCache.pop_front();
     }
 
-    mCache.emplace_back(bufferId, std::move(request));
+    mCache.emplace_back(bufferId, ClientCompositionRequest(display, layerSettings));
 }
 
 void ClientCompositionRequestCache::remove(uint64_t bufferId) {
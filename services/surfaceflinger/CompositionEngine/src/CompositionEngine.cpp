@@ -96,9 +96,15 @@ void offloadOutputs(Outputs& outputs) {
     }
 
     ui::PhysicalDisplayVector<compositionengine::Output*> outputsToOffload;
+    // Whether an enabled client-composited output is presented after the last eligible display.
+    bool hasTrailingGpuOutput = false;
     for (const auto& output : outputs) {
         if (!ftl::Optional(output->getDisplayId()).and_then(HalDisplayId::tryCast)) {
-            // Not HWC-enabled, so it is always client-composited. No need to offload.
+            // Not HWC-enabled, so it is always client-composited. No need to offload, but its
+            // composition can overlap with the HWC present of the displays before it.
+            if (output->getState().isEnabled && !outputsToOffload.empty()) {
+                hasTrailingGpuOutput = true;
+            }
             continue;
         }
         if (!output->getState().isEnabled) {
@@ -111,15 +117,22 @@ void offloadOutputs(Outputs& outputs) {
             return;
         }
         outputsToOffload.push_back(output.get());
+        hasTrailingGpuOutput = false;
     }
 
-    if (outputsToOffload.size() < 2) {
+    if (outputsToOffload.empty()) {
         return;
     }
 
-    // Leave the last eligible display on the main thread, which will
-    // allow it to run concurrently without an extra thread hop.
-    outputsToOffload.pop_back();
+    if (!hasTrailingGpuOutput) {
+        if (outputsToOffload.size() < 2) {
+            return;
+        }
+
+        // Leave the last eligible display on the main thread, which will
+        // allow it to run concurrently without an extra thread hop.
+        outputsToOffload.pop_back();
+    }
 
     for (compositionengine::Output* output : outputsToOffload) {
         output->offloadPresentNextFrame();
@@ -131,9 +144,11 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
     ATRACE_CALL();
     ALOGV(__FUNCTION__);
 
-    preComposition(args);
-
     {
+        TimeStats::ScopedFrameStage stage(getTimeStats(),
+                                          TimeStats::FrameStage::CompositionPrepare);
+        preComposition(args);
+
         // latchedLayers is used to track the set of front-end layer state that
         // has been latched across all outputs for the prepare step, and is not
         // needed for anything else.
@@ -156,10 +171,8 @@ void CompositionEngine::present(CompositionRefreshArgs& args) {
 
     {
         ATRACE_NAME("Waiting on HWC");
-        for (auto& future : presentFutures) {
-            // TODO(b/185536303): Call ftl::Future::wait() once it exists, since
-            // we do not need the return value of get().
-            future.get();
+        for (const auto& future : presentFutures) {
+            future.wait();
         }
     }
     postComposition(args);
@@ -304,11 +304,16 @@ bool Display::chooseCompositionStrategy(
 
     const TimePoint hwcValidateStartTime = TimePoint::now();
 
-    if (status_t result = hwc.getDeviceCompositionChanges(*halDisplayId, requiresClientComposition,
-                                                          getState().earliestPresentTime,
-                                                          getState().expectedPresentTime,
-                                                          getState().frameInterval, outChanges);
-        result != NO_ERROR) {
+    status_t result;
+    {
+        TimeStats::ScopedFrameStage stage(getCompositionEngine().getTimeStats(),
+                                          TimeStats::FrameStage::HwcValidate);
+        result = hwc.getDeviceCompositionChanges(*halDisplayId, requiresClientComposition,
+                                                 getState().earliestPresentTime,
+                                                 getState().expectedPresentTime,
+                                                 getState().frameInterval, outChanges);
+    }
+    if (result != NO_ERROR) {
         ALOGE("chooseCompositionStrategy failed for %s: %d (%s)", getName().c_str(), result,
               strerror(-result));
         return false;
@@ -440,7 +445,11 @@ compositionengine::Output::FrameFences Display::presentFrame() {
         mPowerAdvisor->setHwcPresentDelayedTime(mId, *getState().earliestPresentTime);
     }
 
-    hwc.presentAndGetReleaseFences(*halDisplayIdOpt, getState().earliestPresentTime);
+    {
+        TimeStats::ScopedFrameStage stage(getCompositionEngine().getTimeStats(),
+                                          TimeStats::FrameStage::HwcPresent);
+        hwc.presentAndGetReleaseFences(*halDisplayIdOpt, getState().earliestPresentTime);
+    }
 
     if (isPowerHintSessionEnabled()) {
         mPowerAdvisor->setHwcPresentTiming(mId, startTime, TimePoint::now());
@@ -630,6 +639,11 @@ void Display::qtiEndDraw() {
 }
 /* QTI_END */
 
+bool Display::supportsPartialClientComposition() const {
+    // The buffers of a virtual display are handed to a consumer that may keep or change them.
+    return !isVirtual();
+}
+
 bool Display::supportsOffloadPresent() const {
     if (const auto halDisplayId = HalDisplayId::tryCast(mId)) {
         const auto& hwc = getCompositionEngine().getHwComposer();
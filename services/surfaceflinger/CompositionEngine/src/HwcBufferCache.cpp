@@ -38,11 +38,23 @@ HwcSlotAndBuffer HwcBufferCache::getHwcSlotAndBuffer(const sp<GraphicBuffer>& bu
 }
 
 HwcSlotAndBuffer HwcBufferCache::getOverrideHwcSlotAndBuffer(const sp<GraphicBuffer>& buffer) {
-    if (buffer == mLastOverrideBuffer) {
-        return {kOverrideBufferSlot, nullptr};
+    const uint64_t bufferId = buffer->getId();
+    // Prefer a matching slot, then an empty one, then the least recently used one
+    size_t index = 0;
+    for (size_t i = 0; i < mOverrideCaches.size(); ++i) {
+        const OverrideCache& cache = mOverrideCaches[i];
+        if (cache.bufferId == bufferId) {
+            mOverrideCaches[i].lruCounter = mLeastRecentlyUsedCounter++;
+            return {static_cast<uint32_t>(kOverrideBufferSlot + i), nullptr};
+        }
+        const OverrideCache& candidate = mOverrideCaches[index];
+        if (candidate.bufferId &&
+            (!cache.bufferId || cache.lruCounter < candidate.lruCounter)) {
+            index = i;
+        }
     }
-    mLastOverrideBuffer = buffer;
-    return {kOverrideBufferSlot, buffer};
+    mOverrideCaches[index] = {bufferId, mLeastRecentlyUsedCounter++};
+    return {static_cast<uint32_t>(kOverrideBufferSlot + index), buffer};
 }
 
 uint32_t HwcBufferCache::uncache(uint64_t bufferId) {
@@ -52,9 +64,11 @@ uint32_t HwcBufferCache::uncache(uint64_t bufferId) {
         mFreeSlots.push(slot);
         return slot;
     }
-    if (mLastOverrideBuffer && bufferId == mLastOverrideBuffer->getId()) {
-        mLastOverrideBuffer = nullptr;
-        return kOverrideBufferSlot;
+    for (size_t i = 0; i < mOverrideCaches.size(); ++i) {
+        if (mOverrideCaches[i].bufferId == bufferId) {
+            mOverrideCaches[i] = {};
+            return static_cast<uint32_t>(kOverrideBufferSlot + i);
+        }
     }
     return UINT32_MAX;
 }
@@ -42,6 +42,8 @@
 #include <scheduler/FrameTargeter.h>
 #include <scheduler/Time.h>
 
+#include <cmath>
+#include <limits>
 #include <optional>
 #include <thread>
 
@@ -109,6 +111,122 @@ ScaleVector getScale(const Rect& from, const Rect& to) {
             .y = static_cast<float>(to.height()) / from.height()};
 }
 
+// Consecutive mispredictions after which a layer stack is no longer predicted, until the device
+// picks the same composition strategy for it twice in a row.
+constexpr uint32_t kMaxCompositionStrategyMisses = 2;
+
+using CompositionStrategyHistoryEntry = OutputCompositionState::CompositionStrategyHistoryEntry;
+
+// Returns the history entry for outputLayerHash, moving it to the front, or nullptr if none.
+CompositionStrategyHistoryEntry* findCompositionStrategy(OutputCompositionState& state,
+                                                         uint64_t outputLayerHash) {
+    auto& history = state.compositionStrategyHistory;
+    const auto it = std::find_if(history.begin(), history.end(), [&](const auto& entry) {
+        return entry.outputLayerHash == outputLayerHash;
+    });
+    if (it == history.end()) {
+        return nullptr;
+    }
+    std::rotate(history.begin(), it, std::next(it));
+    return &history.front();
+}
+
+void recordCompositionStrategy(
+        OutputCompositionState& state,
+        const std::optional<android::HWComposer::DeviceRequestedChanges>& changes, bool success) {
+    auto* entry = findCompositionStrategy(state, state.outputLayerHash);
+    if (!entry) {
+        auto& history = state.compositionStrategyHistory;
+        if (history.size() == OutputCompositionState::kCompositionStrategyHistorySize) {
+            history.pop_back();
+        }
+        history.push_back({.outputLayerHash = state.outputLayerHash});
+        std::rotate(history.begin(), std::prev(history.end()), history.end());
+        entry = &history.front();
+    } else {
+        switch (state.strategyPrediction) {
+            case CompositionStrategyPredictionState::FAIL:
+                entry->missCount++;
+                break;
+            case CompositionStrategyPredictionState::SUCCESS:
+                entry->missCount = 0;
+                break;
+            case CompositionStrategyPredictionState::DISABLED:
+                if (entry->changes == changes) {
+                    entry->missCount = 0;
+                }
+                break;
+        }
+    }
+    entry->changes = changes;
+    entry->success = success;
+}
+
+// Client target buffers last drawn more than this many client compositions ago are redrawn in
+// full. This covers triple buffered render surfaces with room to spare.
+constexpr size_t kMaxClientCompositionDamageHistory = 4;
+
+// Slack around damaged areas, for texture filtering and for rounding in the projection to the
+// client target.
+constexpr int32_t kClientCompositionDamagePadding = 2;
+
+Rect padDamage(float left, float top, float right, float bottom) {
+    return Rect(static_cast<int32_t>(std::floor(left)) - kClientCompositionDamagePadding,
+                static_cast<int32_t>(std::floor(top)) - kClientCompositionDamagePadding,
+                static_cast<int32_t>(std::ceil(right)) + kClientCompositionDamagePadding,
+                static_cast<int32_t>(std::ceil(bottom)) + kClientCompositionDamagePadding);
+}
+
+// Returns the bounds of the layer's content in layer stack space. Shadows may extend past these,
+// but they do not depend on the content.
+Rect getLayerStackBounds(const renderengine::LayerSettings& layer) {
+    const FloatRect& bounds = layer.geometry.boundaries;
+    const mat4& transform = layer.geometry.positionTransform;
+    float left = std::numeric_limits<float>::max();
+    float top = std::numeric_limits<float>::max();
+    float right = std::numeric_limits<float>::lowest();
+    float bottom = std::numeric_limits<float>::lowest();
+    for (const vec2& corner : {vec2(bounds.left, bounds.top), vec2(bounds.right, bounds.top),
+                               vec2(bounds.left, bounds.bottom), vec2(bounds.right, bounds.bottom)}) {
+        const vec4 mapped = transform * vec4(corner.x, corner.y, 0.f, 1.f);
+        left = std::min(left, mapped.x);
+        top = std::min(top, mapped.y);
+        right = std::max(right, mapped.x);
+        bottom = std::max(bottom, mapped.y);
+    }
+    return padDamage(left, top, right, bottom);
+}
+
+// Maps the surface damage of the layer's buffer into layer stack space. Returns nullopt if the
+// damage covers the whole buffer, or can't be mapped exactly.
+std::optional<Region> mapSurfaceDamage(const compositionengine::OutputLayer& layer,
+                                       const ui::Transform& displayToLayerStack) {
+    const auto& layerState = layer.getState();
+    const Region& surfaceDamage = layer.getLayerFE().getCompositionState()->surfaceDamage;
+    // Both no damage and Region::INVALID_REGION, which stands for the whole buffer, are empty.
+    if (surfaceDamage.isEmpty() ||
+        layerState.bufferTransform != static_cast<Hwc2::Transform>(0) ||
+        layerState.sourceCrop.isEmpty() || layerState.displayFrame.isEmpty()) {
+        return std::nullopt;
+    }
+
+    const FloatRect& crop = layerState.sourceCrop;
+    const Rect& frame = layerState.displayFrame;
+    const float scaleX = static_cast<float>(frame.getWidth()) / crop.getWidth();
+    const float scaleY = static_cast<float>(frame.getHeight()) / crop.getHeight();
+    Region damage;
+    for (const Rect& rect : surfaceDamage) {
+        Rect mapped = padDamage(frame.left + (rect.left - crop.left) * scaleX,
+                                frame.top + (rect.top - crop.top) * scaleY,
+                                frame.left + (rect.right - crop.left) * scaleX,
+                                frame.top + (rect.bottom - crop.top) * scaleY);
+        if (mapped.intersect(frame, &mapped)) {
+            damage.orSelf(displayToLayerStack.transform(mapped));
+        }
+    }
+    return damage;
+}
+
 } // namespace
 
 std::shared_ptr<Output> createOutput(
@@ -560,8 +678,8 @@ void Output::collectVisibleLayers(const compositionengine::CompositionRefreshArg
         // Incrementally process the coverage for each layer
         ensureOutputLayerIfVisible(layer, coverage);
 
-        // TODO(b/121291683): Stop early if the output is completely covered and
-        // no more layers could even be visible underneath the ones on top.
+        // Once the output is completely covered, the layers underneath still go
+        // through ensureOutputLayerIfVisible() to be latched, but are not visible.
     }
 
     setReleasedLayers(refreshArgs);
@@ -583,6 +701,11 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
         return;
     }
 
+    // Nothing below an opaque cover of the whole output can be visible, so skip the region math
+    if (coverage.aboveOpaqueLayersCoverOutput) {
+        return;
+    }
+
     // Obtain a read-only pointer to the front-end layer state
     const auto* layerFEState = layerFE->getCompositionState();
     if (CC_UNLIKELY(!layerFEState)) {
@@ -781,6 +904,13 @@ void Output::ensureOutputLayerIfVisible(sp<compositionengine::LayerFE>& layerFE,
     // Perform the final check to see if this layer is visible on this output
     // TODO(b/121291683): Why does this not use visibleRegion? (see outputSpaceVisibleRegion below)
     const auto& outputState = getState();
+    if (!opaqueRegion.isEmpty()) {
+        coverage.aboveOpaqueLayersCoverOutput =
+                Region(outputState.displaySpace.getBoundsAsRect())
+                        .subtractSelf(outputState.transform.transform(coverage.aboveOpaqueLayers))
+                        .isEmpty();
+    }
+
     Region drawRegion(outputState.transform.transform(visibleNonTransparentRegion));
     drawRegion.andSelf(outputState.displaySpace.getBoundsAsRect());
     if (drawRegion.isEmpty()) {
@@ -1137,6 +1267,7 @@ void Output::prepareFrame() {
     outputState.strategyPrediction = CompositionStrategyPredictionState::DISABLED;
     outputState.previousDeviceRequestedChanges = changes;
     outputState.previousDeviceRequestedSuccess = success;
+    recordCompositionStrategy(outputState, changes, success);
     if (success) {
         applyCompositionStrategy(changes);
     }
@@ -1199,6 +1330,7 @@ GpuCompositionResult Output::prepareFrameAsync() {
     } else {
         ATRACE_NAME("CompositionStrategyPredictionHit");
     }
+    recordCompositionStrategy(state, changes, chooseCompositionSuccess);
     state.previousDeviceRequestedChanges = std::move(changes);
     state.previousDeviceRequestedSuccess = chooseCompositionSuccess;
     return compositionResult;
@@ -1361,13 +1493,32 @@ std::optional<base::unique_fd> Output::composeSurfaces(
     appendRegionFlashRequests(debugRegion, clientCompositionLayers);
 
     OutputCompositionState& outputCompositionState = editState();
+    const uint64_t clientTargetId = tex->getBuffer()->getId();
+    if (supportsPartialClientComposition()) {
+        if (const auto damage = updateClientCompositionDamage(clientCompositionDisplay,
+                                                              clientCompositionLayers,
+                                                              clientTargetId)) {
+            if (damage->isEmpty()) {
+                ATRACE_NAME("ClientCompositionUnchanged");
+                outputCompositionState.reusedClientComposition = true;
+                setExpensiveRenderingExpected(false);
+                return base::unique_fd(std::move(fd));
+            }
+            const Rect& clip = clientCompositionDisplay.clip;
+            Rect stale;
+            if (clip.intersect(damage->getBounds(), &stale) && stale != clip) {
+                clientCompositionDisplay.damage = stale;
+            }
+        }
+    }
+
     // Check if the client composition requests were rendered into the provided graphic buffer. If
     // so, we can reuse the buffer and avoid client composition.
     if (mClientCompositionRequestCache
         /* QTI_BEGIN */
         && (!QtiOutputExtension::qtiUseSpecFence() || mLayerRequestingBackgroundBlur != nullptr)
         /* QTI_END */) {
-        if (mClientCompositionRequestCache->exists(tex->getBuffer()->getId(),
+        if (mClientCompositionRequestCache->exists(clientTargetId,
                                                    clientCompositionDisplay,
                                                    clientCompositionLayers)) {
             ATRACE_NAME("ClientCompositionCacheHit");
@@ -1377,7 +1528,7 @@ std::optional<base::unique_fd> Output::composeSurfaces(
             return base::unique_fd(std::move(fd));
         }
         ATRACE_NAME("ClientCompositionCacheMiss");
-        mClientCompositionRequestCache->add(tex->getBuffer()->getId(), clientCompositionDisplay,
+        mClientCompositionRequestCache->add(clientTargetId, clientCompositionDisplay,
                                             clientCompositionLayers);
     }
 
@@ -1396,12 +1547,14 @@ std::optional<base::unique_fd> Output::composeSurfaces(
         setExpensiveRenderingExpected(true);
     }
 
+    // The client composition requests are not used past this point, so move them into the
+    // RenderEngine request instead of copying every layer's settings.
     std::vector<renderengine::LayerSettings> clientRenderEngineLayers;
     clientRenderEngineLayers.reserve(clientCompositionLayers.size());
     std::transform(clientCompositionLayers.begin(), clientCompositionLayers.end(),
                    std::back_inserter(clientRenderEngineLayers),
                    [](LayerFE::LayerSettings& settings) -> renderengine::LayerSettings {
-                       return settings;
+                       return std::move(settings);
                    });
 
     const nsecs_t renderEngineStart = systemTime();
@@ -1409,10 +1562,18 @@ std::optional<base::unique_fd> Output::composeSurfaces(
                                .drawLayers(clientCompositionDisplay, clientRenderEngineLayers, tex,
                                            std::move(fd))
                                .get();
+    if (auto timeStats = getCompositionEngine().getTimeStats()) {
+        timeStats->recordFrameStageDuration(TimeStats::FrameStage::RenderEngineWait,
+                                            systemTime() - renderEngineStart);
+    }
 
-    if (mClientCompositionRequestCache && fenceStatus(fenceResult) != NO_ERROR) {
-        // If rendering was not successful, remove the request from the cache.
-        mClientCompositionRequestCache->remove(tex->getBuffer()->getId());
+    if (fenceStatus(fenceResult) != NO_ERROR) {
+        // If rendering was not successful, remove the request from the cache, and don't trust any
+        // of the buffer's contents next time.
+        if (mClientCompositionRequestCache) {
+            mClientCompositionRequestCache->remove(clientTargetId);
+        }
+        mClientTargetDrawnAt.erase(clientTargetId);
     }
     const auto fence = std::move(fenceResult).value_or(Fence::NO_FENCE);
     if (isPowerHintSessionEnabled()) {
@@ -1445,6 +1606,116 @@ std::optional<base::unique_fd> Output::composeSurfaces(
     return base::unique_fd(fence->dup());
 }
 
+std::optional<Region> Output::computeClientCompositionFrameDamage(
+        const renderengine::DisplaySettings& display,
+        const std::vector<LayerFE::LayerSettings>& layers) const {
+    if (!mLastClientComposition || !(mLastClientComposition->display == display) ||
+        mLastClientComposition->layers.size() != layers.size()) {
+        return std::nullopt;
+    }
+
+    // The surface damage of each client composited buffer, mapped lazily since most frames only
+    // change a few buffers.
+    std::optional<std::unordered_map<uint64_t, std::optional<Region>>> surfaceDamage;
+    const auto getSurfaceDamage = [&](uint64_t bufferId) -> std::optional<Region> {
+        if (!surfaceDamage) {
+            surfaceDamage.emplace();
+            const ui::Transform displayToLayerStack = getState().transform.inverse();
+            for (const auto* layer : getOutputLayersOrderedByZ()) {
+                const auto& buffer = layer->getLayerFE().getCompositionState()->buffer;
+                if (!buffer || !layer->requiresClientComposition() ||
+                    layer->getState().overrideInfo.buffer) {
+                    continue;
+                }
+                // A buffer shown by several layers has no single mapping.
+                auto [it, inserted] = surfaceDamage->try_emplace(buffer->getId());
+                it->second = inserted ? mapSurfaceDamage(*layer, displayToLayerStack)
+                                      : std::nullopt;
+            }
+        }
+        const auto it = surfaceDamage->find(bufferId);
+        return it != surfaceDamage->end() ? it->second : std::nullopt;
+    };
+
+    Region damage;
+    for (size_t i = 0; i < layers.size(); i++) {
+        const auto& layer = layers[i];
+        renderengine::LayerSettings settings = layer;
+        settings.source.buffer.buffer = nullptr;
+        settings.source.buffer.fence = nullptr;
+        if (!(settings == mLastClientComposition->layers[i])) {
+            // Anything else than the content changed, e.g. the layer moved.
+            return std::nullopt;
+        }
+
+        const auto& lastBuffer = mLastClientComposition->buffers[i];
+        const auto& buffer = layer.source.buffer.buffer;
+        const uint64_t bufferId = buffer ? buffer->getId() : 0;
+        if (bufferId == lastBuffer.bufferId && layer.frameNumber == lastBuffer.frameNumber &&
+            layer.source.buffer.fence == lastBuffer.fence.promote()) {
+            continue;
+        }
+        if (auto layerDamage = getSurfaceDamage(bufferId)) {
+            damage.orSelf(*layerDamage);
+        } else {
+            damage.orSelf(getLayerStackBounds(layer));
+        }
+    }
+    return damage;
+}
+
+std::optional<Region> Output::updateClientCompositionDamage(
+        const renderengine::DisplaySettings& display,
+        const std::vector<LayerFE::LayerSettings>& layers, uint64_t clientTargetId) {
+    mClientCompositionDamage.push_back(computeClientCompositionFrameDamage(display, layers));
+    if (mClientCompositionDamage.size() > kMaxClientCompositionDamageHistory) {
+        mClientCompositionDamage.pop_front();
+    }
+    mClientCompositionCount++;
+
+    ClientCompositionSnapshot snapshot{.display = display};
+    snapshot.layers.reserve(layers.size());
+    snapshot.buffers.reserve(layers.size());
+    for (const auto& layer : layers) {
+        const auto& buffer = layer.source.buffer.buffer;
+        snapshot.buffers.push_back({.bufferId = buffer ? buffer->getId() : 0,
+                                    .frameNumber = layer.frameNumber,
+                                    .fence = layer.source.buffer.fence});
+        renderengine::LayerSettings& settings = snapshot.layers.emplace_back(layer);
+        settings.source.buffer.buffer = nullptr;
+        settings.source.buffer.fence = nullptr;
+    }
+    mLastClientComposition = std::move(snapshot);
+
+    // The buffer holds the result of the client composition it was last drawn for, so it is stale
+    // wherever any of the compositions since changed. It will hold this one's after the draw.
+    std::optional<Region> damage;
+    if (const auto it = mClientTargetDrawnAt.find(clientTargetId);
+        it != mClientTargetDrawnAt.end() &&
+        mClientCompositionCount - it->second <= mClientCompositionDamage.size()) {
+        damage.emplace();
+        const auto age = static_cast<size_t>(mClientCompositionCount - it->second);
+        for (auto frame = mClientCompositionDamage.end() - age;
+             frame != mClientCompositionDamage.end(); ++frame) {
+            if (!*frame) {
+                damage.reset();
+                break;
+            }
+            damage->orSelf(**frame);
+        }
+    }
+
+    mClientTargetDrawnAt[clientTargetId] = mClientCompositionCount;
+    for (auto it = mClientTargetDrawnAt.begin(); it != mClientTargetDrawnAt.end();) {
+        if (mClientCompositionCount - it->second > kMaxClientCompositionDamageHistory) {
+            it = mClientTargetDrawnAt.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return damage;
+}
+
 renderengine::DisplaySettings Output::generateClientCompositionDisplaySettings(
         const std::shared_ptr<renderengine::ExternalTexture>& buffer) const {
     const auto& outputState = getState();
@@ -1745,20 +2016,11 @@ void Output::setTreat170mAsSrgb(bool enable) {
 }
 
 bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refreshArgs) {
-    uint64_t lastOutputLayerHash = getState().lastOutputLayerHash;
-    uint64_t outputLayerHash = getState().outputLayerHash;
-    editState().lastOutputLayerHash = outputLayerHash;
-
     if (!getState().isEnabled || !mPredictCompositionStrategy) {
         ALOGV("canPredictCompositionStrategy disabled");
         return false;
     }
 
-    if (!getState().previousDeviceRequestedChanges) {
-        ALOGV("canPredictCompositionStrategy previous changes not available");
-        return false;
-    }
-
     if (!mRenderSurface->supportsCompositionStrategyPrediction()) {
         ALOGV("canPredictCompositionStrategy surface does not support");
         return false;
@@ -1769,8 +2031,14 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
         return false;
     }
 
-    if (lastOutputLayerHash != outputLayerHash) {
-        ALOGV("canPredictCompositionStrategy output layers changed");
+    const auto* entry = findCompositionStrategy(editState(), getState().outputLayerHash);
+    if (!entry || !entry->changes) {
+        ALOGV("canPredictCompositionStrategy output layers not seen recently");
+        return false;
+    }
+
+    if (entry->missCount >= kMaxCompositionStrategyMisses) {
+        ALOGV("canPredictCompositionStrategy output layers mispredicted recently");
         return false;
     }
 
@@ -1781,6 +2049,9 @@ bool Output::canPredictCompositionStrategy(const CompositionRefreshArgs& refresh
         return false;
     }
 
+    // Predict the strategy the device last chose for this set of output layers.
+    editState().previousDeviceRequestedChanges = entry->changes;
+    editState().previousDeviceRequestedSuccess = entry->success;
     return true;
 }
 
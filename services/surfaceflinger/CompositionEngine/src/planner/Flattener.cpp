@@ -115,6 +115,8 @@ void Flattener::renderCachedSets(
         bool deviceHandlesColorTransform) {
     ATRACE_CALL();
 
+    mTexturePool.releaseIdleTextures(std::chrono::steady_clock::now());
+
     if (!mNewCachedSet) {
         return;
     }
@@ -131,8 +133,7 @@ void Flattener::renderCachedSets(
     // have enough time, then we skip rendering the cached set if we think that we'll steal too much
     // time from the next frame.
     if (renderDeadline && mTunables.mRenderScheduling) {
-        if (const auto estimatedRenderFinish =
-                    now + mTunables.mRenderScheduling->cachedSetRenderDuration;
+        if (const auto estimatedRenderFinish = now + estimateRenderDuration(*mNewCachedSet);
             estimatedRenderFinish > *renderDeadline) {
             mNewCachedSet->incrementSkipCount();
 
@@ -150,6 +151,35 @@ void Flattener::renderCachedSets(
     }
 
     mNewCachedSet->render(mRenderEngine, mTexturePool, outputState, deviceHandlesColorTransform);
+    if (mNewCachedSet->hasRenderedBuffer()) {
+        recordRenderDuration(*mNewCachedSet, std::chrono::steady_clock::now() - now);
+    }
+}
+
+std::chrono::nanoseconds Flattener::estimateRenderDuration(const CachedSet& cachedSet) const {
+    const size_t creationCost = cachedSet.getCreationCost();
+    if (!mRenderNanosPerPixel || creationCost == 0) {
+        return mTunables.mRenderScheduling->cachedSetRenderDuration;
+    }
+    return std::chrono::nanoseconds(
+            static_cast<int64_t>(*mRenderNanosPerPixel * static_cast<float>(creationCost)));
+}
+
+void Flattener::recordRenderDuration(const CachedSet& cachedSet,
+                                     std::chrono::nanoseconds duration) {
+    const size_t creationCost = cachedSet.getCreationCost();
+    if (creationCost == 0) {
+        return;
+    }
+
+    // Weight the latest sample by a quarter, so that one slow render (e.g. a shader compile)
+    // does not stop flattening for long, but a GPU that is consistently busy is accounted for.
+    constexpr float kSampleWeight = 0.25f;
+    const float nanosPerPixel =
+            static_cast<float>(duration.count()) / static_cast<float>(creationCost);
+    mRenderNanosPerPixel = mRenderNanosPerPixel
+            ? *mRenderNanosPerPixel + kSampleWeight * (nanosPerPixel - *mRenderNanosPerPixel)
+            : nanosPerPixel;
 }
 
 void Flattener::dumpLayers(std::string& result) const {
@@ -200,6 +230,10 @@ void Flattener::dump(std::string& result) const {
     base::StringAppendF(&result, "\n    Cached sets created: %zd\n", mCachedSetCreationCount);
     base::StringAppendF(&result, "    Cost: %.2f\n",
                         static_cast<float>(mCachedSetCreationCost) / displayArea);
+    if (mRenderNanosPerPixel) {
+        base::StringAppendF(&result, "    Render time per screen-size buffer: %.2fus\n",
+                            *mRenderNanosPerPixel * displayArea / 1000.f);
+    }
 
     const auto lastUpdate =
             std::chrono::duration_cast<std::chrono::milliseconds>(now - mLastGeometryUpdate);
@@ -29,8 +29,9 @@ void TexturePool::allocatePool() {
     mPool.clear();
     if (mEnabled && mSize.isValid()) {
         mPool.resize(kMinPoolSize);
+        const auto now = std::chrono::steady_clock::now();
         std::generate_n(mPool.begin(), kMinPoolSize, [&]() {
-            return Entry{genTexture(), nullptr};
+            return Entry{genTexture(), nullptr, now};
         });
     }
 }
@@ -45,9 +46,11 @@ void TexturePool::setDisplaySize(ui::Size size) {
 
 std::shared_ptr<TexturePool::AutoTexture> TexturePool::borrowTexture() {
     if (mPool.empty()) {
+        mBorrowMisses++;
         return std::make_shared<AutoTexture>(*this, genTexture(), nullptr);
     }
 
+    mBorrowHits++;
     const auto entry = mPool.front();
     mPool.pop_front();
     return std::make_shared<AutoTexture>(*this, entry.texture, entry.fence);
@@ -77,7 +80,18 @@ void TexturePool::returnTexture(std::shared_ptr<renderengine::ExternalTexture>&&
         return;
     }
 
-    mPool.push_back({std::move(texture), fence});
+    mPool.push_back({std::move(texture), fence, std::chrono::steady_clock::now()});
+}
+
+void TexturePool::releaseIdleTextures(std::chrono::steady_clock::time_point now) {
+    // Textures are borrowed from the front and returned to the back, so the front is the one that
+    // has been idle for the longest.
+    while (!mPool.empty() && now - mPool.front().returnTime > kIdleTextureTimeout) {
+        ALOGV("Deallocating texture from Planner's pool - idle for more than %" PRId64 "s",
+              static_cast<int64_t>(kIdleTextureTimeout.count()));
+        mPool.pop_front();
+        mIdleReleases++;
+    }
 }
 
 std::shared_ptr<renderengine::ExternalTexture> TexturePool::genTexture() {
@@ -107,6 +121,12 @@ void TexturePool::dump(std::string& out) const {
     base::StringAppendF(&out,
                         "TexturePool (%s) has %zu buffers of size [%" PRId32 ", %" PRId32 "]\n",
                         mEnabled ? "enabled" : "disabled", mPool.size(), mSize.width, mSize.height);
+    const size_t bufferBytes = static_cast<size_t>(mSize.width * mSize.height) * 4;
+    base::StringAppendF(&out,
+                        "  pooled memory: %.2fMB, borrows: %zu hits / %zu misses, "
+                        "released when idle: %zu\n",
+                        static_cast<float>(mPool.size() * bufferBytes) / (1024.f * 1024.f),
+                        mBorrowHits, mBorrowMisses, mIdleReleases);
 }
 
 } // namespace android::compositionengine::impl::planner
\ No newline at end of file
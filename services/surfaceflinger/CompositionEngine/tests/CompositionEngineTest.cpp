@@ -396,8 +396,10 @@ TEST_F(CompositionEngineOffloadTest, virtualDisplay) {
     EXPECT_CALL(*mDisplay2, supportsOffloadPresent).WillOnce(Return(true));
     EXPECT_CALL(*mVirtualDisplay, supportsOffloadPresent).Times(0);
 
+    // The virtual display is composited on the main thread after the HWC displays, so all of
+    // them are offloaded to overlap with it.
     EXPECT_CALL(*mDisplay1, offloadPresentNextFrame).Times(1);
-    EXPECT_CALL(*mDisplay2, offloadPresentNextFrame).Times(0);
+    EXPECT_CALL(*mDisplay2, offloadPresentNextFrame).Times(1);
     EXPECT_CALL(*mVirtualDisplay, offloadPresentNextFrame).Times(0);
 
     SET_FLAG_FOR_TEST(flags::multithreaded_present, true);
@@ -410,6 +412,21 @@ TEST_F(CompositionEngineOffloadTest, virtualDisplay2) {
     EXPECT_CALL(*mDisplay1, supportsOffloadPresent).WillOnce(Return(true));
     EXPECT_CALL(*mVirtualDisplay, supportsOffloadPresent).Times(0);
 
+    EXPECT_CALL(*mDisplay1, offloadPresentNextFrame).Times(1);
+    EXPECT_CALL(*mVirtualDisplay, offloadPresentNextFrame).Times(0);
+
+    SET_FLAG_FOR_TEST(flags::multithreaded_present, true);
+    setOutputs({mDisplay1, mVirtualDisplay});
+
+    mEngine.present(mRefreshArgs);
+}
+
+TEST_F(CompositionEngineOffloadTest, disabledVirtualDisplay) {
+    // Disable mVirtualDisplay.
+    mOutputStates[2].isEnabled = false;
+    EXPECT_CALL(*mDisplay1, supportsOffloadPresent).WillOnce(Return(true));
+    EXPECT_CALL(*mVirtualDisplay, supportsOffloadPresent).Times(0);
+
     EXPECT_CALL(*mDisplay1, offloadPresentNextFrame).Times(0);
     EXPECT_CALL(*mVirtualDisplay, offloadPresentNextFrame).Times(0);
 
@@ -190,5 +190,39 @@ TEST_F(HwcBufferCacheTest, uncache_whenOverrideUncached_returnsInvalidSlotNumber
     EXPECT_EQ(cache.uncache(mBuffer2->getId()), UINT32_MAX);
 }
 
+TEST_F(HwcBufferCacheTest, getOverrideHwcSlotAndBuffer_whenRotating_reusesOverrideSlots) {
+    HwcBufferCache cache;
+
+    sp<GraphicBuffer> overrideBuffers[HwcBufferCache::kOverrideBufferSlotCount];
+    HwcSlotAndBuffer slotsAndBuffers[HwcBufferCache::kOverrideBufferSlotCount];
+    for (size_t i = 0; i < HwcBufferCache::kOverrideBufferSlotCount; ++i) {
+        overrideBuffers[i] = sp<GraphicBuffer>::make(1u, 1u, HAL_PIXEL_FORMAT_RGBA_8888, 1u, 0u);
+        slotsAndBuffers[i] = cache.getOverrideHwcSlotAndBuffer(overrideBuffers[i]);
+        EXPECT_GE(slotsAndBuffers[i].slot, HwcBufferCache::kOverrideBufferSlot);
+        EXPECT_LT(slotsAndBuffers[i].slot,
+                  HwcBufferCache::kOverrideBufferSlot + HwcBufferCache::kOverrideBufferSlotCount);
+        EXPECT_EQ(slotsAndBuffers[i].buffer, overrideBuffers[i]);
+        for (size_t j = 0; j < i; ++j) {
+            EXPECT_NE(slotsAndBuffers[i].slot, slotsAndBuffers[j].slot);
+        }
+    }
+
+    // Going around the rotation again does not resend any of the buffers
+    for (size_t i = 0; i < HwcBufferCache::kOverrideBufferSlotCount; ++i) {
+        HwcSlotAndBuffer slotAndBuffer = cache.getOverrideHwcSlotAndBuffer(overrideBuffers[i]);
+        EXPECT_EQ(slotAndBuffer.slot, slotsAndBuffers[i].slot);
+        EXPECT_EQ(slotAndBuffer.buffer, nullptr);
+    }
+
+    // A new buffer evicts the least recently used override buffer
+    sp<GraphicBuffer> newBuffer =
+            sp<GraphicBuffer>::make(1u, 1u, HAL_PIXEL_FORMAT_RGBA_8888, 1u, 0u);
+    HwcSlotAndBuffer newSlotAndBuffer = cache.getOverrideHwcSlotAndBuffer(newBuffer);
+    EXPECT_EQ(newSlotAndBuffer.slot, slotsAndBuffers[0].slot);
+    EXPECT_EQ(newSlotAndBuffer.buffer, newBuffer);
+    EXPECT_EQ(cache.uncache(overrideBuffers[0]->getId()), UINT32_MAX);
+    EXPECT_EQ(cache.uncache(overrideBuffers[1]->getId()), slotsAndBuffers[1].slot);
+}
+
 } // namespace
 } // namespace android::compositionengine
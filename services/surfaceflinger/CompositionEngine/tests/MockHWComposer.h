@@ -72,8 +72,9 @@ public:
     MOCK_CONST_METHOD1(getPresentFence, sp<Fence>(HalDisplayId));
     MOCK_METHOD(nsecs_t, getPresentTimestamp, (PhysicalDisplayId), (const, override));
     MOCK_CONST_METHOD2(getLayerReleaseFence, sp<Fence>(HalDisplayId, HWC2::Layer*));
-    MOCK_METHOD3(setOutputBuffer,
-                 status_t(HalVirtualDisplayId, const sp<Fence>&, const sp<GraphicBuffer>&));
+    MOCK_METHOD4(setOutputBuffer,
+                 status_t(HalVirtualDisplayId, uint32_t, const sp<Fence>&,
+                          const sp<GraphicBuffer>&));
     MOCK_METHOD1(clearReleaseFences, void(HalDisplayId));
     MOCK_METHOD2(getHdrCapabilities, status_t(HalDisplayId, HdrCapabilities*));
     MOCK_CONST_METHOD1(getSupportedPerFrameMetadata, int32_t(HalDisplayId));
@@ -998,6 +998,24 @@ TEST_F(OutputPrepareFrameTest, delegatesToChooseCompositionStrategyAndRenderSurf
     EXPECT_EQ(mOutput.getState().strategyPrediction, CompositionStrategyPredictionState::DISABLED);
 }
 
+TEST_F(OutputPrepareFrameTest, recordsCompositionStrategyForOutputLayers) {
+    mOutput.editState().isEnabled = true;
+    mOutput.editState().outputLayerHash = 42u;
+
+    EXPECT_CALL(mOutput, chooseCompositionStrategy(_)).WillOnce(Return(true));
+    EXPECT_CALL(mOutput, resetCompositionStrategy()).Times(1);
+    EXPECT_CALL(mOutput, getOutputLayerCount()).WillRepeatedly(Return(0u));
+    EXPECT_CALL(*mRenderSurface, prepareFrame(_, _));
+
+    mOutput.prepareFrame();
+
+    const auto& history = mOutput.getState().compositionStrategyHistory;
+    ASSERT_EQ(1u, history.size());
+    EXPECT_EQ(42u, history.front().outputLayerHash);
+    EXPECT_TRUE(history.front().success);
+    EXPECT_EQ(0u, history.front().missCount);
+}
+
 // Note: Use OutputTest and not OutputPrepareFrameTest, so the real
 // base chooseCompositionStrategy() is invoked.
 TEST_F(OutputTest, prepareFrameSetsClientCompositionOnlyByDefault) {
@@ -1155,6 +1173,45 @@ TEST_F(OutputPrepareFrameAsyncTest, predictionMiss) {
     EXPECT_TRUE(result.bufferAvailable());
 }
 
+TEST_F(OutputPrepareFrameAsyncTest, predictionMissIsCountedForOutputLayers) {
+    mOutput.editState().isEnabled = true;
+    mOutput.editState().usesClientComposition = false;
+    mOutput.editState().usesDeviceComposition = true;
+    mOutput.editState().outputLayerHash = 42u;
+    mOutput.editState().previousDeviceRequestedChanges =
+            std::make_optional<android::HWComposer::DeviceRequestedChanges>({});
+    mOutput.editState().compositionStrategyHistory.push_back(
+            {.outputLayerHash = 42u,
+             .changes = mOutput.getState().previousDeviceRequestedChanges,
+             .success = true});
+    std::promise<bool> p;
+    p.set_value(false);
+    std::shared_ptr<renderengine::ExternalTexture> tex =
+            std::make_shared<renderengine::mock::FakeExternalTexture>(1, 1,
+                                                                      HAL_PIXEL_FORMAT_RGBA_8888, 1,
+                                                                      2);
+
+    EXPECT_CALL(mOutput, resetCompositionStrategy()).Times(2);
+    EXPECT_CALL(mOutput, getOutputLayerCount()).WillRepeatedly(Return(0u));
+    EXPECT_CALL(mOutput, updateProtectedContentState());
+    EXPECT_CALL(mOutput, dequeueRenderBuffer(_, _))
+            .WillOnce(DoAll(SetArgPointee<1>(tex), Return(true)));
+    EXPECT_CALL(*mRenderSurface, prepareFrame(false, true)).Times(2);
+    EXPECT_CALL(mOutput, chooseCompositionStrategyAsync(_)).WillOnce([&] {
+        return p.get_future();
+    });
+    EXPECT_CALL(mOutput, composeSurfaces(_, _, _));
+
+    mOutput.prepareFrameAsync();
+    EXPECT_EQ(mOutput.getState().strategyPrediction, CompositionStrategyPredictionState::FAIL);
+
+    const auto& history = mOutput.getState().compositionStrategyHistory;
+    ASSERT_EQ(1u, history.size());
+    EXPECT_EQ(1u, history.front().missCount);
+    EXPECT_FALSE(history.front().changes);
+    EXPECT_FALSE(history.front().success);
+}
+
 /*
  * Output::prepare()
  */
@@ -1533,6 +1590,38 @@ TEST_F(OutputEnsureOutputLayerIfVisibleTest, takesNotSoEarlyOutifDrawRegionEmpty
     ensureOutputLayerIfVisible();
 }
 
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, takesEarlyOutIfOutputCoveredByOpaqueLayers) {
+    mCoverageState.aboveOpaqueLayersCoverOutput = true;
+
+    ensureOutputLayerIfVisible();
+
+    EXPECT_THAT(mCoverageState.aboveCoveredLayers, RegionEq(kEmptyRegion));
+}
+
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, marksOutputCoveredByOpaqueFullscreenLayer) {
+    mLayer.layerFEState.isOpaque = true;
+    mLayer.layerFEState.geomLayerBounds = FloatRect{0, 0, 200, 300};
+    mLayer.layerFEState.geomLayerTransform = ui::Transform(TR_IDENT, 200, 300);
+
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(0u), Eq(mLayer.layerFE)))
+            .WillOnce(Return(&mLayer.outputLayer));
+
+    ensureOutputLayerIfVisible();
+
+    EXPECT_TRUE(mCoverageState.aboveOpaqueLayersCoverOutput);
+}
+
+TEST_F(OutputEnsureOutputLayerIfVisibleTest, doesNotMarkOutputCoveredByPartialOpaqueLayer) {
+    mLayer.layerFEState.isOpaque = true;
+
+    EXPECT_CALL(mOutput, ensureOutputLayer(Eq(0u), Eq(mLayer.layerFE)))
+            .WillOnce(Return(&mLayer.outputLayer));
+
+    ensureOutputLayerIfVisible();
+
+    EXPECT_FALSE(mCoverageState.aboveOpaqueLayersCoverOutput);
+}
+
 TEST_F(OutputEnsureOutputLayerIfVisibleTest,
        handlesCreatingOutputLayerForOpaqueDirtyNotRotatedLayer) {
     mLayer.layerFEState.isOpaque = true;
@@ -3527,6 +3616,7 @@ struct OutputComposeSurfacesTest : public testing::Test {
         MOCK_METHOD(void, setHintSessionRequiresRenderEngine, (bool), (override));
         MOCK_METHOD(bool, isPowerHintSessionEnabled, (), (override));
         MOCK_METHOD(bool, isPowerHintSessionGpuReportingEnabled, (), (override));
+        MOCK_METHOD(bool, supportsPartialClientComposition, (), (const, override));
     };
 
     OutputComposeSurfacesTest() {
@@ -3558,6 +3648,7 @@ struct OutputComposeSurfacesTest : public testing::Test {
                 .WillRepeatedly(ReturnRef(kHdrCapabilities));
         EXPECT_CALL(mOutput, isPowerHintSessionEnabled()).WillRepeatedly(Return(true));
         EXPECT_CALL(mOutput, isPowerHintSessionGpuReportingEnabled()).WillRepeatedly(Return(true));
+        EXPECT_CALL(mOutput, supportsPartialClientComposition()).WillRepeatedly(Return(false));
     }
 
     struct ExecuteState : public CallOrderStateMachineHelper<TestType, ExecuteState> {
@@ -3949,6 +4040,88 @@ TEST_F(OutputComposeSurfacesTest, clientCompositionIfRequestChanges) {
     EXPECT_FALSE(mOutput.mState.reusedClientComposition);
 }
 
+TEST_F(OutputComposeSurfacesTest, partialClientCompositionSkipsUnchangedBuffer) {
+    mOutput.cacheClientCompositionRequests(0);
+    LayerFE::LayerSettings r1;
+    LayerFE::LayerSettings r2;
+
+    r1.geometry.boundaries = FloatRect{1, 2, 3, 4};
+    r2.geometry.boundaries = FloatRect{5, 6, 7, 8};
+
+    EXPECT_CALL(mOutput, supportsPartialClientComposition()).WillRepeatedly(Return(true));
+    EXPECT_CALL(mOutput, getSkipColorTransform()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*mDisplayColorProfile, hasWideColorGamut()).WillRepeatedly(Return(true));
+    EXPECT_CALL(mRenderEngine, supportsProtectedContent()).WillRepeatedly(Return(false));
+    EXPECT_CALL(mRenderEngine, isProtected()).WillRepeatedly(Return(false));
+    EXPECT_CALL(mOutput, generateClientCompositionRequests(_, kDefaultOutputDataspace, _))
+            .WillRepeatedly(Return(std::vector<LayerFE::LayerSettings>{r1, r2}));
+    EXPECT_CALL(mOutput, appendRegionFlashRequests(RegionEq(kDebugRegion), _))
+            .WillRepeatedly(Return());
+
+    EXPECT_CALL(*mRenderSurface, dequeueBuffer(_)).WillRepeatedly(Return(mOutputBuffer));
+    EXPECT_CALL(mRenderEngine, drawLayers(_, ElementsAre(r1, r2), _, _))
+            .WillOnce(Return(ByMove(ftl::yield<FenceResult>(Fence::NO_FENCE))));
+    EXPECT_CALL(mOutput, setExpensiveRenderingExpected(false));
+
+    verify().execute().expectAFenceWasReturned();
+    EXPECT_FALSE(mOutput.mState.reusedClientComposition);
+
+    // The buffer already holds exactly this composition.
+    verify().execute().expectAFenceWasReturned();
+    EXPECT_TRUE(mOutput.mState.reusedClientComposition);
+}
+
+TEST_F(OutputComposeSurfacesTest, partialClientCompositionRedrawsChangedLayerOnly) {
+    mOutput.cacheClientCompositionRequests(0);
+    mOutput.mState.layerStackSpace.setContent(Rect{0, 0, 100, 100});
+
+    const auto makeLayerBuffer = [&] {
+        return std::make_shared<
+                renderengine::impl::ExternalTexture>(sp<GraphicBuffer>::make(), mRenderEngine,
+                                                     renderengine::impl::ExternalTexture::Usage::
+                                                             READABLE);
+    };
+    LayerFE::LayerSettings r1;
+    LayerFE::LayerSettings r2;
+    r1.geometry.boundaries = FloatRect{1, 2, 3, 4};
+    r2.geometry.boundaries = FloatRect{50, 60, 70, 80};
+    r2.source.buffer.buffer = makeLayerBuffer();
+    LayerFE::LayerSettings r2WithNewBuffer = r2;
+    r2WithNewBuffer.source.buffer.buffer = makeLayerBuffer();
+
+    EXPECT_CALL(mOutput, supportsPartialClientComposition()).WillRepeatedly(Return(true));
+    EXPECT_CALL(mOutput, getOutputLayerCount()).WillRepeatedly(Return(0u));
+    EXPECT_CALL(mOutput, getSkipColorTransform()).WillRepeatedly(Return(false));
+    EXPECT_CALL(*mDisplayColorProfile, hasWideColorGamut()).WillRepeatedly(Return(true));
+    EXPECT_CALL(mRenderEngine, supportsProtectedContent()).WillRepeatedly(Return(false));
+    EXPECT_CALL(mRenderEngine, isProtected()).WillRepeatedly(Return(false));
+    EXPECT_CALL(mOutput, generateClientCompositionRequests(_, kDefaultOutputDataspace, _))
+            .WillOnce(Return(std::vector<LayerFE::LayerSettings>{r1, r2}))
+            .WillOnce(Return(std::vector<LayerFE::LayerSettings>{r1, r2WithNewBuffer}));
+    EXPECT_CALL(mOutput, appendRegionFlashRequests(RegionEq(kDebugRegion), _))
+            .WillRepeatedly(Return());
+
+    EXPECT_CALL(*mRenderSurface, dequeueBuffer(_)).WillRepeatedly(Return(mOutputBuffer));
+    std::vector<std::optional<Rect>> drawnDamage;
+    EXPECT_CALL(mRenderEngine, drawLayers(_, _, _, _))
+            .Times(2)
+            .WillRepeatedly([&](const renderengine::DisplaySettings& display,
+                                const std::vector<renderengine::LayerSettings>&,
+                                const std::shared_ptr<renderengine::ExternalTexture>&,
+                                base::unique_fd&&) -> ftl::Future<FenceResult> {
+                drawnDamage.push_back(display.damage);
+                return ftl::yield<FenceResult>(Fence::NO_FENCE);
+            });
+
+    verify().execute().expectAFenceWasReturned();
+    verify().execute().expectAFenceWasReturned();
+
+    // Without any surface damage the changed layer is redrawn in full, with some slack.
+    ASSERT_EQ(2u, drawnDamage.size());
+    EXPECT_EQ(std::nullopt, drawnDamage[0]);
+    EXPECT_EQ(Rect(48, 58, 72, 82), drawnDamage[1]);
+}
+
 struct OutputComposeSurfacesTest_UsesExpectedDisplaySettings : public OutputComposeSurfacesTest {
     OutputComposeSurfacesTest_UsesExpectedDisplaySettings() {
         EXPECT_CALL(mRenderEngine, supportsProtectedContent()).WillRepeatedly(Return(false));
@@ -35,6 +35,7 @@ public:
     size_t getMinPoolSize() const { return kMinPoolSize; }
     size_t getMaxPoolSize() const { return kMaxPoolSize; }
     size_t getPoolSize() const { return mPool.size(); }
+    std::chrono::seconds getIdleTextureTimeout() const { return kIdleTextureTimeout; }
 };
 
 struct TexturePoolTest : public testing::Test {
@@ -170,5 +171,21 @@ TEST_F(TexturePoolTest, reallocatesWhenReEnabled) {
     EXPECT_EQ(mTexturePool.getPoolSize(), mTexturePool.getMinPoolSize());
 }
 
+TEST_F(TexturePoolTest, releasesIdleTextures) {
+    const auto now = std::chrono::steady_clock::now();
+    mTexturePool.releaseIdleTextures(now);
+    EXPECT_EQ(mTexturePool.getMinPoolSize(), mTexturePool.getPoolSize());
+
+    mTexturePool.releaseIdleTextures(now + mTexturePool.getIdleTextureTimeout() +
+                                     std::chrono::seconds(1));
+    EXPECT_EQ(0u, mTexturePool.getPoolSize());
+
+    // Textures are allocated on demand again afterwards.
+    auto texture = mTexturePool.borrowTexture();
+    EXPECT_NE(nullptr, texture->get());
+    texture.reset();
+    EXPECT_EQ(1u, mTexturePool.getPoolSize());
+}
+
 } // namespace
 } // namespace android::compositionengine::impl::planner
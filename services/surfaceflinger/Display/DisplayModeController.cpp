@@ -26,9 +26,12 @@
 #include <ftl/concat.h>
 #include <ftl/expected.h>
 #include <log/log.h>
+#include <utils/Timers.h>
 
 namespace android::display {
 
+using namespace std::string_view_literals;
+
 template <size_t N>
 inline std::string DisplayModeController::Display::concatId(const char (&str)[N]) const {
     return std::string(ftl::Concat(str, ' ', snapshot.get().displayId().value).str());
@@ -179,8 +182,14 @@ bool DisplayModeController::initiateModeChange(PhysicalDisplayId displayId,
                                                DisplayModeRequest&& desiredMode,
                                                const hal::VsyncPeriodChangeConstraints& constraints,
                                                hal::VsyncPeriodChangeTimeline& outTimeline) {
-    std::lock_guard lock(mDisplayLock);
-    const auto& displayPtr = FTL_EXPECT(mDisplays.get(displayId).ok_or(false)).get();
+    Display* displayPtr;
+    {
+        // Displays are only unregistered on the main thread, so the Display outlives this call
+        // without holding mDisplayLock. That keeps binder threads which set the desired mode
+        // from waiting on HWC below.
+        std::lock_guard lock(mDisplayLock);
+        displayPtr = FTL_EXPECT(mDisplays.get(displayId).ok_or(false)).get().get();
+    }
 
     // TODO: b/255635711 - Flow the DisplayModeRequest through the desired/pending/active states.
     // For now, `desiredMode` and `desiredModeOpt` are one and the same, but the latter is not
@@ -199,8 +208,22 @@ bool DisplayModeController::initiateModeChange(PhysicalDisplayId displayId,
 
     const auto& mode = *displayPtr->pendingModeOpt->mode.modePtr;
 
-    if (mComposerPtr->setActiveModeWithConstraints(displayId, mode.getHwcId(), constraints,
-                                                   &outTimeline) != OK) {
+    const nsecs_t startTime = systemTime();
+    const bool ok = mComposerPtr->setActiveModeWithConstraints(displayId, mode.getHwcId(),
+                                                               constraints, &outTimeline) == OK;
+    const nsecs_t hwcTime = systemTime() - startTime;
+    displayPtr->modeChangeInitiatedTime = startTime;
+
+    {
+        std::scoped_lock lock(displayPtr->desiredModeLock);
+        auto& stats = displayPtr->modeChangeStats;
+        stats.initiatedCount++;
+        stats.hwcTotalTime += hwcTime;
+        stats.hwcMaxTime = std::max(stats.hwcMaxTime, hwcTime);
+        if (!ok) stats.failedCount++;
+    }
+
+    if (!ok) {
         return false;
     }
 
@@ -215,6 +238,18 @@ void DisplayModeController::finalizeModeChange(PhysicalDisplayId displayId, Disp
 
     const auto& displayPtr = FTL_TRY(mDisplays.get(displayId).ok_or(ftl::Unit())).get();
     displayPtr->isModeSetPending = false;
+
+    if (displayPtr->modeChangeInitiatedTime != 0) {
+        const nsecs_t latency = systemTime() - displayPtr->modeChangeInitiatedTime;
+        displayPtr->modeChangeInitiatedTime = 0;
+
+        std::scoped_lock lock(displayPtr->desiredModeLock);
+        auto& stats = displayPtr->modeChangeStats;
+        stats.finalizedCount++;
+        stats.latencyTotalTime += latency;
+        stats.latencyMaxTime = std::max(stats.latencyMaxTime, latency);
+        stats.latencyLastTime = latency;
+    }
 }
 
 void DisplayModeController::setActiveMode(PhysicalDisplayId displayId, DisplayModeId modeId,
@@ -223,6 +258,32 @@ void DisplayModeController::setActiveMode(PhysicalDisplayId displayId, DisplayMo
     setActiveModeLocked(displayId, modeId, vsyncRate, renderFps);
 }
 
+void DisplayModeController::dump(PhysicalDisplayId displayId, utils::Dumper& dumper) const {
+    std::lock_guard lock(mDisplayLock);
+    const auto& displayPtr = FTL_TRY(mDisplays.get(displayId).ok_or(ftl::Unit())).get();
+
+    ModeChangeStats stats;
+    {
+        std::scoped_lock lock(displayPtr->desiredModeLock);
+        stats = displayPtr->modeChangeStats;
+    }
+
+    const auto averageMs = [](nsecs_t total, size_t count) {
+        return count == 0 ? 0.f : static_cast<float>(ns2us(total)) / 1000.f / count;
+    };
+    const auto ms = [](nsecs_t time) { return static_cast<float>(ns2us(time)) / 1000.f; };
+
+    utils::Dumper::Section section(dumper, "Mode switches"sv);
+    dumper.dump("initiated"sv, stats.initiatedCount);
+    dumper.dump("failed"sv, stats.failedCount);
+    dumper.dump("finalized"sv, stats.finalizedCount);
+    dumper.dump("hwcAvgMs"sv, averageMs(stats.hwcTotalTime, stats.initiatedCount));
+    dumper.dump("hwcMaxMs"sv, ms(stats.hwcMaxTime));
+    dumper.dump("latencyAvgMs"sv, averageMs(stats.latencyTotalTime, stats.finalizedCount));
+    dumper.dump("latencyMaxMs"sv, ms(stats.latencyMaxTime));
+    dumper.dump("latencyLastMs"sv, ms(stats.latencyLastTime));
+}
+
 void DisplayModeController::setActiveModeLocked(PhysicalDisplayId displayId, DisplayModeId modeId,
                                                 Fps vsyncRate, Fps renderFps) {
     const auto& displayPtr = FTL_TRY(mDisplays.get(displayId).ok_or(ftl::Unit())).get();
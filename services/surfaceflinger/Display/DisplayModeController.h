@@ -33,6 +33,7 @@
 #include "Scheduler/RefreshRateSelector.h"
 #include "ThreadContext.h"
 #include "TracedOrdinal.h"
+#include "Utils/Dumper.h"
 
 namespace android {
 class HWComposer;
@@ -97,7 +98,24 @@ public:
     void setActiveMode(PhysicalDisplayId, DisplayModeId, Fps vsyncRate, Fps renderFps)
             EXCLUDES(mDisplayLock);
 
+    void dump(PhysicalDisplayId, utils::Dumper&) const EXCLUDES(mDisplayLock);
+
 private:
+    // Latency of the mode switches of a display, from initiateModeChange to finalizeModeChange.
+    struct ModeChangeStats {
+        size_t initiatedCount = 0;
+        size_t failedCount = 0;
+        size_t finalizedCount = 0;
+
+        // Time spent in HWComposer::setActiveModeWithConstraints.
+        nsecs_t hwcTotalTime = 0;
+        nsecs_t hwcMaxTime = 0;
+
+        nsecs_t latencyTotalTime = 0;
+        nsecs_t latencyMaxTime = 0;
+        nsecs_t latencyLastTime = 0;
+    };
+
     struct Display {
         template <size_t N>
         std::string concatId(const char (&)[N]) const;
@@ -121,6 +139,10 @@ private:
 
         DisplayModeRequestOpt pendingModeOpt GUARDED_BY(kMainThreadContext);
         bool isModeSetPending GUARDED_BY(kMainThreadContext) = false;
+        nsecs_t modeChangeInitiatedTime GUARDED_BY(kMainThreadContext) = 0;
+
+        // Written on the main thread and read by dumpsys.
+        ModeChangeStats modeChangeStats GUARDED_BY(desiredModeLock);
     };
 
     using DisplayPtr = std::unique_ptr<Display>;
@@ -543,6 +543,7 @@ void DisplayDevice::animateOverlay() {
 void DisplayDevice::adjustRefreshRate(Fps pacesetterDisplayRefreshRate) {
     using fps_approx_ops::operator<=;
     if (mRequestedRefreshRate <= 0_Hz) {
+        mAdjustedRefreshRate = 0_Hz;
         return;
     }
 
@@ -227,6 +227,12 @@ public:
     // display's refresh rate. Only supported for virtual displays.
     void adjustRefreshRate(Fps pacesetterDisplayRefreshRate);
 
+    // Changes the requested refresh rate of a virtual display, e.g. when a mirror output
+    // lowers its rate. Must be followed by adjustRefreshRate.
+    void setRequestedRefreshRate(Fps requestedRefreshRate) {
+        mRequestedRefreshRate = requestedRefreshRate;
+    }
+
     // release HWC resources (if any) for removable displays
     void disconnect();
 
@@ -269,7 +275,7 @@ private:
     // Requested refresh rate in fps, supported only for virtual displays.
     // when this value is non zero, SurfaceFlinger will try to drop frames
     // for virtual displays to match this requested refresh rate.
-    const Fps mRequestedRefreshRate;
+    Fps mRequestedRefreshRate;
 
     // Adjusted refresh rate, rounded to match a divisor of the pacesetter
     // display's refresh rate. Only supported for virtual displays.
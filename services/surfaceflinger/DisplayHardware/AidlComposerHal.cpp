@@ -397,7 +397,7 @@ uint32_t AidlComposer::getMaxVirtualDisplayCount() {
 Error AidlComposer::createVirtualDisplay(uint32_t width, uint32_t height, PixelFormat* format,
                                          Display* outDisplay) {
     using AidlPixelFormat = aidl::android::hardware::graphics::common::PixelFormat;
-    const int32_t bufferSlotCount = 1;
+    const int32_t bufferSlotCount = BufferQueue::NUM_BUFFER_SLOTS;
     VirtualDisplay virtualDisplay;
     const auto status =
             mAidlComposerClient->createVirtualDisplay(static_cast<int32_t>(width),
@@ -785,12 +785,13 @@ Error AidlComposer::setColorTransform(Display display, const float* matrix) {
     return error;
 }
 
-Error AidlComposer::setOutputBuffer(Display display, const native_handle_t* buffer,
+Error AidlComposer::setOutputBuffer(Display display, uint32_t slot, const native_handle_t* buffer,
                                     int releaseFence) {
     auto error = Error::NONE;
     mMutex.lock_shared();
     if (auto writer = getWriter(display)) {
-        writer->get().setOutputBuffer(translate<int64_t>(display), 0, buffer, dup(releaseFence));
+        writer->get().setOutputBuffer(translate<int64_t>(display), static_cast<int32_t>(slot),
+                                      buffer, dup(releaseFence));
     } else {
         error = Error::BAD_DISPLAY;
     }
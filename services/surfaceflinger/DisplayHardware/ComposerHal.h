@@ -167,7 +167,8 @@ public:
                                   float hdrSdrRatio) = 0;
     virtual Error setColorMode(Display display, ColorMode mode, RenderIntent renderIntent) = 0;
     virtual Error setColorTransform(Display display, const float* matrix) = 0;
-    virtual Error setOutputBuffer(Display display, const native_handle_t* buffer,
+    /* see setClientTarget for the purpose of slot */
+    virtual Error setOutputBuffer(Display display, uint32_t slot, const native_handle_t* buffer,
                                   int releaseFence) = 0;
     virtual Error setPowerMode(Display display, IComposerClient::PowerMode mode) = 0;
     virtual Error setVsyncEnabled(Display display, IComposerClient::Vsync enabled) = 0;
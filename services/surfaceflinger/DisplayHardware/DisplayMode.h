@@ -53,6 +53,18 @@ struct DisplayModeId : ftl::DefaultConstructible<DisplayModeId, ui::DisplayModeI
     using DefaultConstructible::DefaultConstructible;
 };
 
+} // namespace android
+
+// Lets large DisplayModes maps index their lookups by hash.
+template <>
+struct std::hash<android::DisplayModeId> {
+    std::size_t operator()(android::DisplayModeId modeId) const {
+        return std::hash<android::ui::DisplayModeId>{}(android::ftl::to_underlying(modeId));
+    }
+};
+
+namespace android {
+
 using DisplayModes = ftl::SmallMap<DisplayModeId, DisplayModePtr, 3>;
 using DisplayModeIterator = DisplayModes::const_iterator;
 
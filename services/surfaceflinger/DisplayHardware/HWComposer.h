@@ -190,8 +190,10 @@ public:
     // Get last release fence for the given layer
     virtual sp<Fence> getLayerReleaseFence(HalDisplayId, HWC2::Layer*) const = 0;
 
-    // Set the output buffer and acquire fence for a virtual display.
-    virtual status_t setOutputBuffer(HalVirtualDisplayId, const sp<Fence>& acquireFence,
+    // Set the output buffer and acquire fence for a virtual display. As with setClientTarget, a
+    // null buffer reuses the one HWC cached for the slot.
+    virtual status_t setOutputBuffer(HalVirtualDisplayId, uint32_t slot,
+                                     const sp<Fence>& acquireFence,
                                      const sp<GraphicBuffer>& buffer) = 0;
 
     // After SurfaceFlinger has retrieved the release fences for all the frames,
@@ -394,7 +396,7 @@ public:
     sp<Fence> getLayerReleaseFence(HalDisplayId, HWC2::Layer*) const override;
 
     // Set the output buffer and acquire fence for a virtual display.
-    status_t setOutputBuffer(HalVirtualDisplayId, const sp<Fence>& acquireFence,
+    status_t setOutputBuffer(HalVirtualDisplayId, uint32_t slot, const sp<Fence>& acquireFence,
                              const sp<GraphicBuffer>& buffer) override;
 
     // After SurfaceFlinger has retrieved the release fences for all the frames,
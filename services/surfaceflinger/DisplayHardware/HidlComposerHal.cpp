@@ -393,7 +393,7 @@ uint32_t HidlComposer::getMaxVirtualDisplayCount() {
 
 Error HidlComposer::createVirtualDisplay(uint32_t width, uint32_t height, PixelFormat* format,
                                          Display* outDisplay) {
-    const uint32_t bufferSlotCount = 1;
+    const uint32_t bufferSlotCount = BufferQueue::NUM_BUFFER_SLOTS;
     Error error = kDefaultError;
     if (mClient_2_2) {
         mClient_2_2->createVirtualDisplay_2_2(width, height,
@@ -715,10 +715,10 @@ Error HidlComposer::setColorTransform(Display display, const float* matrix) {
     return Error::NONE;
 }
 
-Error HidlComposer::setOutputBuffer(Display display, const native_handle_t* buffer,
+Error HidlComposer::setOutputBuffer(Display display, uint32_t slot, const native_handle_t* buffer,
                                     int releaseFence) {
     mWriter.selectDisplay(display);
-    mWriter.setOutputBuffer(0, buffer, dup(releaseFence));
+    mWriter.setOutputBuffer(slot, buffer, dup(releaseFence));
     return Error::NONE;
 }
 
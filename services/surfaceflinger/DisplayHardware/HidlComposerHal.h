@@ -249,7 +249,7 @@ public:
                           float hdrSdrRatio) override;
     Error setColorMode(Display display, ColorMode mode, RenderIntent renderIntent) override;
     Error setColorTransform(Display display, const float* matrix) override;
-    Error setOutputBuffer(Display display, const native_handle_t* buffer,
+    Error setOutputBuffer(Display display, uint32_t slot, const native_handle_t* buffer,
                           int releaseFence) override;
     Error setPowerMode(Display display, IComposerClient::PowerMode mode) override;
     Error setVsyncEnabled(Display display, IComposerClient::Vsync enabled) override;
@@ -416,8 +416,9 @@ private:
     // Max number of buffers that may be cached for a given layer
     // We obtain this number by:
     // 1. Tightly coupling this cache to the max size of BufferQueue
-    // 2. Adding an additional slot for the layer caching feature in SurfaceFlinger (see: Planner.h)
-    static const constexpr uint32_t kMaxLayerBufferCount = BufferQueue::NUM_BUFFER_SLOTS + 1;
+    // 2. Adding the slots for the layer caching feature in SurfaceFlinger (see:
+    //    HwcBufferCache::kOverrideBufferSlotCount)
+    static const constexpr uint32_t kMaxLayerBufferCount = BufferQueue::NUM_BUFFER_SLOTS + 4;
     CommandWriter mWriter;
     CommandReader mReader;
 };
@@ -27,6 +27,7 @@
 #undef LOG_TAG
 #define LOG_TAG "PowerAdvisor"
 
+#include <pthread.h>
 #include <unistd.h>
 #include <cinttypes>
 #include <cstdint>
@@ -68,7 +69,18 @@ using ChannelMessageContents = ChannelMessage::ChannelMessageContents;
 using MsgQueue = android::AidlMessageQueue<ChannelMessage, SynchronizedReadWrite>;
 using FlagQueue = android::AidlMessageQueue<int8_t, SynchronizedReadWrite>;
 
-PowerAdvisor::~PowerAdvisor() = default;
+PowerAdvisor::~PowerAdvisor() {
+    std::thread reportThread;
+    {
+        std::scoped_lock lock(mHintSessionReportMutex);
+        mHintSessionReportThreadStop = true;
+        reportThread = std::move(mHintSessionReportThread);
+    }
+    mHintSessionReportCondition.notify_all();
+    if (reportThread.joinable()) {
+        reportThread.join();
+    }
+}
 
 namespace {
 std::chrono::milliseconds getUpdateTimeout() {
@@ -227,6 +239,10 @@ void PowerAdvisor::sendHintSessionHint(SessionHint hint) {
         }
         ALOGV("Sending session hint: %d", static_cast<int>(hint));
         if (!writeHintSessionMessage<ChannelMessageContents::Tag::hint>(&hint, 1)) {
+            if (mAsyncHintSessionReporting) {
+                queueHintSessionReport(std::nullopt, hint, {});
+                return;
+            }
             auto ret = mHintSession->sendHint(hint);
             if (!ret.isOk()) {
                 ALOGW("Failed to send session hint with error: %s", ret.errorMessage());
@@ -316,6 +332,10 @@ void PowerAdvisor::updateTargetWorkDuration(Duration targetDuration) {
         mLastTargetDurationSent = targetDuration;
         auto target = targetDuration.ns();
         if (!writeHintSessionMessage<ChannelMessageContents::Tag::targetDuration>(&target, 1)) {
+            if (mAsyncHintSessionReporting) {
+                queueHintSessionReport(target, std::nullopt, {});
+                return;
+            }
             auto ret = mHintSession->updateTargetWorkDuration(targetDuration.ns());
             if (!ret.isOk()) {
                 ALOGW("Failed to set power hint target work duration with error: %s",
@@ -372,6 +392,11 @@ void PowerAdvisor::reportActualWorkDuration() {
         if (!writeHintSessionMessage<
                     ChannelMessageContents::Tag::workDuration>(mHintSessionQueue.data(),
                                                                mHintSessionQueue.size())) {
+            if (mAsyncHintSessionReporting) {
+                queueHintSessionReport(std::nullopt, std::nullopt, std::move(mHintSessionQueue));
+                mHintSessionQueue.clear();
+                return;
+            }
             auto ret = mHintSession->reportActualWorkDuration(mHintSessionQueue);
             if (!ret.isOk()) {
                 ALOGW("Failed to report actual work durations with error: %s", ret.errorMessage());
@@ -383,6 +408,84 @@ void PowerAdvisor::reportActualWorkDuration() {
     mHintSessionQueue.clear();
 }
 
+void PowerAdvisor::queueHintSessionReport(std::optional<int64_t> targetDurationNanos,
+                                          std::optional<SessionHint> hint,
+                                          std::vector<WorkDuration>&& workDurations) {
+    {
+        std::scoped_lock lock(mHintSessionReportMutex);
+        PendingHintSessionReports& pending = mPendingHintSessionReports;
+        if (targetDurationNanos) {
+            pending.targetDurationNanos = targetDurationNanos;
+        }
+        if (hint) {
+            pending.hints.push_back(*hint);
+        }
+        pending.workDurations.insert(pending.workDurations.end(),
+                                     std::make_move_iterator(workDurations.begin()),
+                                     std::make_move_iterator(workDurations.end()));
+        if (!mHintSessionReportThread.joinable()) {
+            mHintSessionReportThread = std::thread([this] { hintSessionReportLoop(); });
+            pthread_setname_np(mHintSessionReportThread.native_handle(), "HintSessionRpt");
+        }
+    }
+    mHintSessionReportCondition.notify_one();
+}
+
+void PowerAdvisor::hintSessionReportLoop() {
+    while (true) {
+        PendingHintSessionReports reports;
+        {
+            std::unique_lock lock(mHintSessionReportMutex);
+            mHintSessionReportCondition.wait(lock, [this] {
+                return mHintSessionReportThreadStop || !mPendingHintSessionReports.empty();
+            });
+            if (mHintSessionReportThreadStop) return;
+            std::swap(reports, mPendingHintSessionReports);
+        }
+
+        // Only hold mHintSessionMutex to take a reference, so the binder calls below never block
+        // the threads queueing reports.
+        std::shared_ptr<power::PowerHintSessionWrapper> session;
+        {
+            std::scoped_lock lock(mHintSessionMutex);
+            session = mHintSession;
+        }
+        if (session == nullptr) continue;
+
+        ATRACE_NAME("hintSessionReport");
+        bool failed = false;
+        if (reports.targetDurationNanos) {
+            auto ret = session->updateTargetWorkDuration(*reports.targetDurationNanos);
+            if (!ret.isOk()) {
+                ALOGW("Failed to set power hint target work duration with error: %s",
+                      ret.errorMessage());
+                failed = true;
+            }
+        }
+        for (size_t i = 0; !failed && i < reports.hints.size(); ++i) {
+            auto ret = session->sendHint(reports.hints[i]);
+            if (!ret.isOk()) {
+                ALOGW("Failed to send session hint with error: %s", ret.errorMessage());
+                failed = true;
+            }
+        }
+        if (!failed && !reports.workDurations.empty()) {
+            auto ret = session->reportActualWorkDuration(reports.workDurations);
+            if (!ret.isOk()) {
+                ALOGW("Failed to report actual work durations with error: %s", ret.errorMessage());
+                failed = true;
+            }
+        }
+        if (failed) {
+            // Let the next report recreate the session, unless that already happened.
+            std::scoped_lock lock(mHintSessionMutex);
+            if (mHintSession == session) {
+                mHintSession = nullptr;
+            }
+        }
+    }
+}
+
 template <ChannelMessage::ChannelMessageContents::Tag T, class In>
 bool PowerAdvisor::writeHintSessionMessage(In* contents, size_t count) {
     if (!mMsgQueue) {
@@ -760,6 +863,9 @@ const Duration PowerAdvisor::sTargetSafetyMargin = std::chrono::microseconds(
 const bool PowerAdvisor::sUseReportActualDuration =
         base::GetBoolProperty(std::string("debug.adpf.use_report_actual_duration"), true);
 
+const bool PowerAdvisor::sAsyncHintSessionReporting =
+        base::GetBoolProperty(std::string("debug.sf.hint_session_async_reporting"), true);
+
 power::PowerHalController& PowerAdvisor::getPowerHal() {
     static std::once_flag halFlag;
     std::call_once(halFlag, [this] { mPowerHal->init(); });
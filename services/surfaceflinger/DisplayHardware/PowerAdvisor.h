@@ -24,6 +24,8 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -320,6 +322,36 @@ private:
     bool mSessionConfigSupported = true;
     bool mFirstConfigSupportCheck = true;
 
+    // Session calls that could not go through the FMQ and are waiting for
+    // mHintSessionReportThread to make the binder calls. Reports queued between two wakeups of
+    // the thread are coalesced: only the latest target is sent, and work durations are batched.
+    struct PendingHintSessionReports {
+        std::optional<int64_t> targetDurationNanos;
+        std::vector<aidl::android::hardware::power::SessionHint> hints;
+        std::vector<aidl::android::hardware::power::WorkDuration> workDurations;
+
+        bool empty() const {
+            return !targetDurationNanos && hints.empty() && workDurations.empty();
+        }
+    };
+
+    // Queues reports for mHintSessionReportThread, starting it if needed
+    void queueHintSessionReport(std::optional<int64_t> targetDurationNanos,
+                                std::optional<aidl::android::hardware::power::SessionHint> hint,
+                                std::vector<aidl::android::hardware::power::WorkDuration>&&
+                                        workDurations) EXCLUDES(mHintSessionReportMutex);
+    void hintSessionReportLoop() NO_THREAD_SAFETY_ANALYSIS;
+
+    std::mutex mHintSessionReportMutex;
+    std::condition_variable mHintSessionReportCondition;
+    PendingHintSessionReports mPendingHintSessionReports GUARDED_BY(mHintSessionReportMutex);
+    bool mHintSessionReportThreadStop GUARDED_BY(mHintSessionReportMutex) = false;
+    std::thread mHintSessionReportThread GUARDED_BY(mHintSessionReportMutex);
+
+    // Whether binder fallback calls are made on mHintSessionReportThread rather than inline, so
+    // that power HAL latency does not block the caller
+    bool mAsyncHintSessionReporting = sAsyncHintSessionReporting;
+
     // Whether we should emit ATRACE_INT data for hint sessions
     static const bool sTraceHintSessionData;
 
@@ -334,6 +366,9 @@ private:
     // Whether we should send reportActualWorkDuration calls
     static const bool sUseReportActualDuration;
 
+    // Default for mAsyncHintSessionReporting
+    static const bool sAsyncHintSessionReporting;
+
     // How long we expect hwc to run after the present call until it waits for the fence
     static constexpr const Duration kFenceWaitStartDelayValidated{150us};
     static constexpr const Duration kFenceWaitStartDelaySkippedValidate{250us};
@@ -127,6 +127,7 @@ VirtualDisplaySurface::VirtualDisplaySurface(HWComposer& hwc, VirtualDisplayId d
 
     for (size_t i = 0; i < sizeof(mHwcBufferIds) / sizeof(mHwcBufferIds[0]); ++i) {
         mHwcBufferIds[i] = UINT64_MAX;
+        mHwcOutputBufferIds[i] = UINT64_MAX;
     }
 }
 
@@ -247,7 +248,7 @@ status_t VirtualDisplaySurface::advanceFrame(float hdrSdrRatio) {
     LOG_FATAL_IF(!halDisplayId);
     // At this point we know the output buffer acquire fence,
     // so update HWC state with it.
-    mHwc.setOutputBuffer(*halDisplayId, mOutputFence, outBuffer);
+    setHwcOutputBuffer(mOutputFence);
 
     status_t result = NO_ERROR;
     if (fbBuffer != nullptr) {
@@ -679,11 +680,27 @@ status_t VirtualDisplaySurface::refreshOutputBuffer() {
     // until after GPU calls queueBuffer(). So here we just set the buffer
     // (for use in HWC prepare) but not the fence; we'll call this again with
     // the proper fence once we have it.
+    return setHwcOutputBuffer(Fence::NO_FENCE);
+}
+
+status_t VirtualDisplaySurface::setHwcOutputBuffer(const sp<Fence>& acquireFence) {
     const auto halDisplayId = HalVirtualDisplayId::tryCast(mDisplayId);
     LOG_FATAL_IF(!halDisplayId);
-    result = mHwc.setOutputBuffer(*halDisplayId, Fence::NO_FENCE,
-                                  mProducerBuffers[mOutputProducerSlot]);
 
+    const int sslot = mapProducer2SourceSlot(SOURCE_SINK, mOutputProducerSlot);
+    const sp<GraphicBuffer>& outBuffer = mProducerBuffers[mOutputProducerSlot];
+    // assume that HWC has previously seen the buffer in this slot
+    sp<GraphicBuffer> hwcBuffer = sp<GraphicBuffer>(nullptr);
+    if (outBuffer->getId() != mHwcOutputBufferIds[sslot]) {
+        mHwcOutputBufferIds[sslot] = outBuffer->getId();
+        hwcBuffer = outBuffer; // HWC hasn't previously seen this buffer in this slot
+    }
+
+    status_t result = mHwc.setOutputBuffer(*halDisplayId, sslot, acquireFence, hwcBuffer);
+    if (result != NO_ERROR) {
+        // The buffer may not have made it into the HWC cache, send it again next time.
+        mHwcOutputBufferIds[sslot] = UINT64_MAX;
+    }
     return result;
 }
 
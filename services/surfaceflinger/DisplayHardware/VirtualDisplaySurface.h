@@ -170,6 +170,8 @@ private:
     void updateQueueBufferOutput(QueueBufferOutput&&);
     void resetPerFrameState();
     status_t refreshOutputBuffer();
+    // Passes the current output buffer to HWC, skipping its handle if HWC already imported it.
+    status_t setHwcOutputBuffer(const sp<Fence>& acquireFence);
 
     // Both the sink and scratch buffer pools have their own set of slots
     // ("source slots", or "sslot"). We have to merge these into the single
@@ -192,6 +194,9 @@ private:
     // Buffers that HWC has seen before, indexed by HWC slot number.
     // NOTE: The BufferQueue slot number is the same as the HWC slot number.
     uint64_t mHwcBufferIds[BufferQueue::NUM_BUFFER_SLOTS];
+    // Same for the output buffers, which are cached by HWC in the sink slot they were dequeued
+    // from. Sink buffers are reused frame after frame, so HWC imports each of them only once.
+    uint64_t mHwcOutputBufferIds[BufferQueue::NUM_BUFFER_SLOTS];
 
     //
     // Inter-frame state
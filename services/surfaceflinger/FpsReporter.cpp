@@ -21,6 +21,7 @@
 #include <algorithm>
 
 #include "FpsReporter.h"
+#include "BackgroundExecutor.h"
 #include "Layer.h"
 #include "SurfaceFlinger.h"
 
@@ -76,6 +77,7 @@ void FpsReporter::dispatchLayerFps(const frontend::LayerHierarchy& layerHierarch
         return true;
     });
 
+    BackgroundExecutor::Callbacks callbacks;
     for (const auto& [listener, hierarchy] : listenersAndLayersToReport) {
         std::unordered_set<int32_t> layerIds;
 
@@ -88,7 +90,15 @@ void FpsReporter::dispatchLayerFps(const frontend::LayerHierarchy& layerHierarch
             return true;
         });
 
-        listener.listener->onFpsReported(mFrameTimeline.computeFps(layerIds));
+        // Computing the fps walks the FrameTimeline history, which is left to the bulk lane
+        // rather than done on the main thread.
+        callbacks.push_back([this, self = sp<FpsReporter>::fromExisting(this),
+                             listener = listener.listener, layerIds = std::move(layerIds)]() {
+            listener->onFpsReported(mFrameTimeline.computeFps(layerIds));
+        });
+    }
+    if (!callbacks.empty()) {
+        BackgroundExecutor::getLowPriorityInstance().sendCallbacks(std::move(callbacks));
     }
 
     mLastDispatch = now;
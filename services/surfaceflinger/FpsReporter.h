@@ -39,7 +39,8 @@ public:
 
     // Dispatches updated layer fps values for the registered listeners
     // This method promotes Layer weak pointers and performs layer stack traversals, so mStateLock
-    // must be held when calling this method.
+    // must be held when calling this method. The fps are computed and reported on the low
+    // priority BackgroundExecutor.
     void dispatchLayerFps(const frontend::LayerHierarchy&) EXCLUDES(mMutex);
 
     // Override for IBinder::DeathRecipient
@@ -830,34 +830,43 @@ namespace impl {
 int64_t TokenManager::generateTokenForPredictions(TimelineItem&& predictions) {
     ATRACE_CALL();
     std::scoped_lock lock(mMutex);
-    while (mPredictions.size() >= kMaxTokens) {
-        mPredictions.erase(mPredictions.begin());
-    }
     const int64_t assignedToken = mCurrentToken++;
-    mPredictions[assignedToken] = predictions;
+    mPredictions[static_cast<size_t>(assignedToken) % kMaxTokens] = {assignedToken, predictions};
     return assignedToken;
 }
 
 std::optional<TimelineItem> TokenManager::getPredictionsForToken(int64_t token) const {
+    if (token < 0) {
+        return {};
+    }
     std::scoped_lock lock(mMutex);
-    auto predictionsIterator = mPredictions.find(token);
-    if (predictionsIterator != mPredictions.end()) {
-        return predictionsIterator->second;
+    const auto& slot = mPredictions[static_cast<size_t>(token) % kMaxTokens];
+    if (slot.token == token) {
+        return slot.predictions;
     }
     return {};
 }
 
 FrameTimeline::FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid,
-                             JankClassificationThresholds thresholds, bool useBootTimeClock)
+                             JankClassificationThresholds thresholds, bool useBootTimeClock,
+                             std::unique_ptr<Executor> executor)
       : mUseBootTimeClock(useBootTimeClock),
         mMaxDisplayFrames(kDefaultMaxDisplayFrames),
         mTimeStats(std::move(timeStats)),
         mSurfaceFlingerPid(surfaceFlingerPid),
-        mJankClassificationThresholds(thresholds) {
+        mJankClassificationThresholds(thresholds),
+        mExecutor(std::move(executor)) {
     mCurrentDisplayFrame =
             std::make_shared<DisplayFrame>(mTimeStats, thresholds, &mTraceCookieCounter);
 }
 
+FrameTimeline::~FrameTimeline() {
+    // Posted flushes refer to this FrameTimeline.
+    if (mExecutor) {
+        mExecutor->flush();
+    }
+}
+
 void FrameTimeline::onBootFinished() {
     perfetto::TracingInitArgs args;
     args.backends = perfetto::kSystemBackend;
@@ -931,7 +940,16 @@ void FrameTimeline::setSfPresent(nsecs_t sfPresentTime,
     mCurrentDisplayFrame->setActualEndTime(sfPresentTime);
     mCurrentDisplayFrame->setGpuFence(gpuFence);
     mPendingPresentFences.emplace_back(std::make_pair(presentFence, mCurrentDisplayFrame));
-    flushPendingPresentFences();
+    if (mExecutor) {
+        // Classifying and tracing presented frames isn't latency critical, so keep it off the
+        // caller's thread.
+        mExecutor->post([this] {
+            std::scoped_lock lock(mMutex);
+            flushPendingPresentFences();
+        });
+    } else {
+        flushPendingPresentFences();
+    }
     finalizeCurrentDisplayFrame();
 }
 
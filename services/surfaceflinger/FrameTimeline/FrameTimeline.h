@@ -16,9 +16,11 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -359,12 +361,18 @@ private:
     // Friend class for testing
     friend class android::frametimeline::FrameTimelineTest;
 
-    void flushTokens(nsecs_t flushTime) REQUIRES(mMutex);
+    static constexpr size_t kMaxTokens = 500;
+
+    struct PredictionSlot {
+        int64_t token = FrameTimelineInfo::INVALID_VSYNC_ID;
+        TimelineItem predictions;
+    };
 
-    std::map<int64_t, TimelineItem> mPredictions GUARDED_BY(mMutex);
+    // Tokens are handed out sequentially, so they index a ring in which each new token replaces the
+    // oldest one, without allocating.
+    std::array<PredictionSlot, kMaxTokens> mPredictions GUARDED_BY(mMutex);
     int64_t mCurrentToken GUARDED_BY(mMutex);
     mutable std::mutex mMutex;
-    static constexpr size_t kMaxTokens = 500;
 };
 
 class FrameTimeline : public android::frametimeline::FrameTimeline {
@@ -476,9 +484,21 @@ public:
         TraceCookieCounter& mTraceCookieCounter;
     };
 
+    // Runs work posted by FrameTimeline in order, off the posting thread.
+    class Executor {
+    public:
+        virtual ~Executor() = default;
+        virtual void post(std::function<void()>&& task) = 0;
+        // Waits until all the work posted so far has completed.
+        virtual void flush() = 0;
+    };
+
+    // If an executor is given, jank classification and tracing of presented frames run on it
+    // rather than on the thread calling setSfPresent.
     FrameTimeline(std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid,
-                  JankClassificationThresholds thresholds = {}, bool useBootTimeClock = true);
-    ~FrameTimeline() = default;
+                  JankClassificationThresholds thresholds = {}, bool useBootTimeClock = true,
+                  std::unique_ptr<Executor> executor = nullptr);
+    ~FrameTimeline();
 
     frametimeline::TokenManager* getTokenManager() override { return &mTokenManager; }
     std::shared_ptr<SurfaceFrame> createSurfaceFrameForToken(
@@ -531,6 +551,7 @@ private:
     nsecs_t mPreviousActualPresentTime = 0;
     nsecs_t mPreviousPredictionPresentTime = 0;
     const JankClassificationThresholds mJankClassificationThresholds;
+    const std::unique_ptr<Executor> mExecutor;
     static constexpr uint32_t kDefaultMaxDisplayFrames = 64;
     // The initial container size for the vector<SurfaceFrames> inside display frame. Although
     // this number doesn't represent any bounds on the number of surface frames that can go in a
@@ -419,6 +419,11 @@ void LayerHierarchyBuilder::update(LayerLifecycleManager& layerLifecycleManager)
                        RequestedLayerState::Changes::Hierarchy)) {
         ATRACE_NAME("LayerHierarchyBuilder:update");
         doUpdate(layerLifecycleManager.getLayers(), layerLifecycleManager.getDestroyedLayers());
+        // The hierarchy was loop free after the last update. Destroying layers only removes
+        // links, so there is nothing new to check.
+        if (!layerLifecycleManager.hasNewHierarchyLinks()) {
+            return;
+        }
     } else {
         return; // nothing to do
     }
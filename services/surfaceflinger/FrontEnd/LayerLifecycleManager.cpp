@@ -42,6 +42,10 @@ void LayerLifecycleManager::addLayers(std::vector<std::unique_ptr<RequestedLayer
     }
 
     mGlobalChanges |= RequestedLayerState::Changes::Hierarchy;
+    mHierarchyLinksChanged = true;
+    mIdToLayer.reserve(mIdToLayer.size() + newLayers.size());
+    mLayers.reserve(mLayers.size() + newLayers.size());
+    mAddedLayers.reserve(mAddedLayers.size() + newLayers.size());
     for (auto& newLayer : newLayers) {
         RequestedLayerState& layer = *newLayer.get();
         auto [it, inserted] = mIdToLayer.try_emplace(layer.id, References{.owner = layer});
@@ -163,13 +167,18 @@ void LayerLifecycleManager::onHandlesDestroyed(
         mIdToLayer.erase(it);
     }
 
+    // Every layer in layersToBeDestroyed is still in mLayers, so the sweep can stop as soon as
+    // they have all been moved out.
+    size_t remaining = layersToBeDestroyed.size();
+    mDestroyedLayers.reserve(mDestroyedLayers.size() + remaining);
     auto it = mLayers.begin();
-    while (it != mLayers.end()) {
+    while (remaining > 0 && it != mLayers.end()) {
         RequestedLayerState* layer = it->get();
         if (layer->changes.test(RequestedLayerState::Changes::Destroyed)) {
             LLOGV(layer->id, "destroyed %s", layer->getDebugStringShort().c_str());
             std::iter_swap(it, mLayers.end() - 1);
             mDestroyedLayers.emplace_back(std::move(mLayers.back()));
+            remaining--;
             if (it == mLayers.end() - 1) {
                 it = mLayers.erase(mLayers.end() - 1);
             } else {
@@ -183,6 +192,9 @@ void LayerLifecycleManager::onHandlesDestroyed(
 
 void LayerLifecycleManager::applyTransactions(const std::vector<TransactionState>& transactions,
                                               bool ignoreUnknownLayers) {
+    // Background color layers which are no longer needed are destroyed together once all the
+    // transactions are applied, so that mLayers is swept once rather than once per layer.
+    std::vector<std::pair<uint32_t, std::string /* debugName */>> destroyedBgColorLayers;
     for (const auto& transaction : transactions) {
         for (const auto& resolvedComposerState : transaction.states) {
             const auto& clientState = resolvedComposerState.state;
@@ -244,7 +256,7 @@ void LayerLifecycleManager::applyTransactions(const std::vector<TransactionState
                     RequestedLayerState* bgColorLayer = getLayerFromId(layer->bgColorLayerId);
                     layer->bgColorLayerId = UNASSIGNED_LAYER_ID;
                     bgColorLayer->parentId = unlinkLayer(bgColorLayer->parentId, bgColorLayer->id);
-                    onHandlesDestroyed({{bgColorLayer->id, bgColorLayer->debugName}});
+                    destroyedBgColorLayers.emplace_back(bgColorLayer->id, bgColorLayer->debugName);
                 } else if (layer->bgColorLayerId != UNASSIGNED_LAYER_ID) {
                     RequestedLayerState* bgColorLayer = getLayerFromId(layer->bgColorLayerId);
                     bgColorLayer->color = layer->bgColor;
@@ -257,6 +269,11 @@ void LayerLifecycleManager::applyTransactions(const std::vector<TransactionState
                 }
             }
 
+            if (oldParentId != layer->parentId ||
+                oldRelativeParentId != layer->relativeParentId ||
+                layer->changes.test(RequestedLayerState::Changes::Mirror)) {
+                mHierarchyLinksChanged = true;
+            }
             if (oldParentId != layer->parentId) {
                 unlinkLayer(oldParentId, layer->id);
                 layer->parentId = linkLayer(layer->parentId, layer->id);
@@ -279,28 +296,30 @@ void LayerLifecycleManager::applyTransactions(const std::vector<TransactionState
             mGlobalChanges |= layer->changes;
         }
     }
+    onHandlesDestroyed(destroyedBgColorLayers);
 }
 
 void LayerLifecycleManager::commitChanges() {
-    for (auto layer : mAddedLayers) {
+    if (!mAddedLayers.empty()) {
         for (auto& listener : mListeners) {
-            listener->onLayerAdded(*layer);
+            listener->onLayersAdded(mAddedLayers);
         }
+        mAddedLayers.clear();
     }
-    mAddedLayers.clear();
 
     for (auto& layer : mLayers) {
         layer->clearChanges();
     }
 
-    for (auto& destroyedLayer : mDestroyedLayers) {
+    if (!mDestroyedLayers.empty()) {
         for (auto& listener : mListeners) {
-            listener->onLayerDestroyed(*destroyedLayer);
+            listener->onLayersDestroyed(mDestroyedLayers);
         }
+        mDestroyedLayers.clear();
     }
-    mDestroyedLayers.clear();
     mChangedLayers.clear();
     mGlobalChanges.clear();
+    mHierarchyLinksChanged = false;
 }
 
 void LayerLifecycleManager::addLifecycleListener(std::shared_ptr<ILifecycleListener> listener) {
@@ -431,6 +450,7 @@ void LayerLifecycleManager::updateDisplayMirrorLayers(RequestedLayerState& rootL
             mirrorLayer->mirrorIds.emplace_back(rootLayer.id);
             linkLayer(rootLayer.id, mirrorLayer->id);
             mirrorLayer->changes |= RequestedLayerState::Changes::Mirror;
+            mHierarchyLinksChanged = true;
         } else if (!canBeMirrored && currentlyMirrored) {
             swapErase(mirrorLayer->mirrorIds, rootLayer.id);
             unlinkLayer(rootLayer.id, mirrorLayer->id);
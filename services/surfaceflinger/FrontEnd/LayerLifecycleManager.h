@@ -55,6 +55,10 @@ public:
     // the system in an invalid state. This is always a client error that
     // needs to be fixed but overriding the state allows us to fail gracefully.
     void fixRelativeZLoop(uint32_t relativeRootId);
+    // Returns true if a layer was added or a parent, relative parent or mirror link changed
+    // since the last commit. A relative z loop can only appear after one of these, so the
+    // hierarchy does not need to be checked for loops otherwise.
+    bool hasNewHierarchyLinks() const { return mHierarchyLinksChanged; }
 
     // Destroys RequestedLayerStates that are marked to be destroyed. Invokes all
     // ILifecycleListener callbacks and clears any change flags from previous state
@@ -72,6 +76,19 @@ public:
         // Called on commitChanges when a layer has been destroyed. The callback
         // includes the final state before the layer was destroyed.
         virtual void onLayerDestroyed(const RequestedLayerState&) = 0;
+        // Called once per commitChanges with all the layers added or destroyed since the last
+        // commit. Listeners that can handle a batch at once should override these.
+        virtual void onLayersAdded(const std::vector<RequestedLayerState*>& layers) {
+            for (const RequestedLayerState* layer : layers) {
+                onLayerAdded(*layer);
+            }
+        }
+        virtual void onLayersDestroyed(
+                const std::vector<std::unique_ptr<RequestedLayerState>>& layers) {
+            for (const auto& layer : layers) {
+                onLayerDestroyed(*layer);
+            }
+        }
     };
     void addLifecycleListener(std::shared_ptr<ILifecycleListener>);
     void removeLifecycleListener(std::shared_ptr<ILifecycleListener>);
@@ -109,6 +126,8 @@ private:
 
     // Aggregation of changes since last commit.
     ftl::Flags<RequestedLayerState::Changes> mGlobalChanges;
+    // See hasNewHierarchyLinks.
+    bool mHierarchyLinksChanged = false;
     std::vector<std::unique_ptr<RequestedLayerState>> mLayers;
     // Layers pending destruction. Layers will be destroyed once changes are committed.
     std::vector<std::unique_ptr<RequestedLayerState>> mDestroyedLayers;
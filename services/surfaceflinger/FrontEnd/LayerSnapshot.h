@@ -153,4 +153,25 @@ struct LayerSnapshot : public compositionengine::LayerFECompositionState {
                bool forceFullDamage, uint32_t displayRotationFlags);
 };
 
+// Copy of the LayerSnapshot fields that are read on every frame. LayerSnapshotBuilder keeps these
+// in a contiguous table indexed by globalZ so passes over all snapshots can filter on them
+// without dereferencing each individually allocated snapshot.
+struct LayerSnapshotHotFields {
+    LayerSnapshotHotFields() = default;
+    explicit LayerSnapshotHotFields(const LayerSnapshot& snapshot)
+          : geomLayerBounds(snapshot.geomLayerBounds),
+            alpha(snapshot.alpha),
+            layerStack(snapshot.outputFilter.layerStack),
+            changes(snapshot.changes),
+            isVisible(snapshot.isVisible),
+            hasInputInfo(snapshot.hasInputInfo()) {}
+
+    FloatRect geomLayerBounds;
+    float alpha = 1.f;
+    ui::LayerStack layerStack = ui::INVALID_LAYER_STACK;
+    ftl::Flags<RequestedLayerState::Changes> changes;
+    bool isVisible = false;
+    bool hasInputInfo = false;
+};
+
 } // namespace android::surfaceflinger::frontend
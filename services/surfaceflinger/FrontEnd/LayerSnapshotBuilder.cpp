@@ -326,6 +326,13 @@ void clearChanges(LayerSnapshot& snapshot) {
     snapshot.surfaceDamage.clear();
 }
 
+// Snapshot changes that are passed down from a parent to its children.
+constexpr ftl::Flags<RequestedLayerState::Changes> kChangesInheritedByChildren =
+        RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
+        RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
+        RequestedLayerState::Changes::AffectsChildren | RequestedLayerState::Changes::Input |
+        RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode;
+
 // TODO (b/259407931): Remove.
 uint32_t getPrimaryDisplayRotationFlags(
         const ui::DisplayMap<ui::LayerStack, frontend::DisplayInfo>& displays) {
@@ -375,6 +382,7 @@ LayerSnapshotBuilder::LayerSnapshotBuilder() {}
 LayerSnapshotBuilder::LayerSnapshotBuilder(Args args) : LayerSnapshotBuilder() {
     args.forceUpdate = ForceUpdateFlags::ALL;
     updateSnapshots(args);
+    updateAllHotFields();
 }
 
 bool LayerSnapshotBuilder::tryFastUpdate(const Args& args) {
@@ -438,9 +446,20 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
         rootSnapshot.clientChanges |= layer_state_t::eReparent;
     }
 
-    for (auto& snapshot : mSnapshots) {
-        if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
-            snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+    // If the hierarchy has not changed, the set of reachable snapshots is the same as in the
+    // previous update. Only walk into subtrees that contain changed layers or inherit changes
+    // from their parent.
+    mSkipCleanSubtrees = args.forceUpdate == ForceUpdateFlags::NONE && !args.displayChanges &&
+            !args.layerLifecycleManager.getGlobalChanges().test(
+                    RequestedLayerState::Changes::Hierarchy);
+    mDirtyHierarchies.clear();
+    if (mSkipCleanSubtrees) {
+        markDirtyHierarchies(args.root, /*depth=*/0);
+    } else {
+        for (auto& snapshot : mSnapshots) {
+            if (snapshot->reachablilty == LayerSnapshot::Reachablilty::Reachable) {
+                snapshot->reachablilty = LayerSnapshot::Reachablilty::Unreachable;
+            }
         }
     }
 
@@ -456,9 +475,13 @@ void LayerSnapshotBuilder::updateSnapshots(const Args& args) {
             LayerHierarchy::ScopedAddToTraversalPath addChildToPath(root,
                                                                     childHierarchy->getLayer()->id,
                                                                     variant);
+            if (canSkipSubtree(*childHierarchy, root, rootSnapshot)) {
+                continue;
+            }
             updateSnapshotsInHierarchy(args, *childHierarchy, root, rootSnapshot, /*depth=*/0);
         }
     }
+    mDirtyHierarchies.clear();
 
     // Update touchable region crops outside the main update pass. This is because a layer could be
     // cropped by any other layer and it requires both snapshots to be updated.
@@ -512,11 +535,23 @@ void LayerSnapshotBuilder::update(const Args& args) {
     for (auto& snapshot : mSnapshots) {
         clearChanges(*snapshot);
     }
+    for (auto& hotFields : mHotFields) {
+        hotFields.changes.clear();
+    }
 
     if (tryFastUpdate(args)) {
+        // The fast path only updates the snapshots of changed layers.
+        for (const RequestedLayerState* requested :
+             args.layerLifecycleManager.getChangedLayers()) {
+            auto range = mIdToSnapshots.equal_range(requested->id);
+            for (auto it = range.first; it != range.second; it++) {
+                updateHotFields(*it->second);
+            }
+        }
         return;
     }
     updateSnapshots(args);
+    updateAllHotFields();
 }
 
 const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
@@ -552,6 +587,9 @@ const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
         LayerHierarchy::ScopedAddToTraversalPath addChildToPath(traversalPath,
                                                                 childHierarchy->getLayer()->id,
                                                                 variant);
+        if (canSkipSubtree(*childHierarchy, traversalPath, *snapshot)) {
+            continue;
+        }
         const LayerSnapshot& childSnapshot =
                 updateSnapshotsInHierarchy(args, *childHierarchy, traversalPath, *snapshot,
                                            depth + 1);
@@ -561,6 +599,45 @@ const LayerSnapshot& LayerSnapshotBuilder::updateSnapshotsInHierarchy(
     return *snapshot;
 }
 
+bool LayerSnapshotBuilder::markDirtyHierarchies(const LayerHierarchy& hierarchy, int depth) {
+    LLOG_ALWAYS_FATAL_WITH_TRACE_IF(depth > 50,
+                                    "Cycle detected in LayerSnapshotBuilder. See "
+                                    "builder_stack_overflow_transactions.winscope");
+    // Hierarchy nodes can be reached from multiple parents when they are mirrored or relatively
+    // parented, so children that are already known to be dirty are not visited again.
+    const RequestedLayerState* layer = hierarchy.getLayer();
+    bool dirty = layer && (layer->changes.get() != 0 || layer->what != 0);
+    for (auto& [childHierarchy, variant] : hierarchy.mChildren) {
+        if (mDirtyHierarchies.find(childHierarchy) != mDirtyHierarchies.end()) {
+            dirty = true;
+            continue;
+        }
+        dirty |= markDirtyHierarchies(*childHierarchy, depth + 1);
+    }
+    if (dirty) {
+        mDirtyHierarchies.insert(&hierarchy);
+    }
+    return dirty;
+}
+
+bool LayerSnapshotBuilder::canSkipSubtree(const LayerHierarchy& childHierarchy,
+                                          const LayerHierarchy::TraversalPath& childPath,
+                                          const LayerSnapshot& parentSnapshot) const {
+    if (!mSkipCleanSubtrees) {
+        return false;
+    }
+    if (mDirtyHierarchies.find(&childHierarchy) != mDirtyHierarchies.end()) {
+        return false;
+    }
+    if (parentSnapshot.changes.any(kChangesInheritedByChildren) ||
+        (parentSnapshot.clientChanges & layer_state_t::AFFECTS_CHILDREN) != 0) {
+        return false;
+    }
+    // Nothing in this subtree changed and nothing is inherited from the parent, so the existing
+    // snapshots are already up to date.
+    return getSnapshot(childPath) != nullptr;
+}
+
 LayerSnapshot* LayerSnapshotBuilder::getSnapshot(uint32_t layerId) const {
     if (layerId == UNASSIGNED_LAYER_ID) {
         return nullptr;
@@ -574,6 +651,10 @@ LayerSnapshot* LayerSnapshotBuilder::getSnapshot(const LayerHierarchy::Traversal
     return it == mPathToSnapshot.end() ? nullptr : it->second;
 }
 
+const std::vector<LayerSnapshotHotFields>& LayerSnapshotBuilder::getHotFields() const {
+    return mHotFields;
+}
+
 LayerSnapshot* LayerSnapshotBuilder::createSnapshot(const LayerHierarchy::TraversalPath& path,
                                                     const RequestedLayerState& layer,
                                                     const LayerSnapshot& parentSnapshot) {
@@ -712,11 +793,8 @@ void LayerSnapshotBuilder::updateSnapshot(LayerSnapshot& snapshot, const Args& a
                                           const LayerSnapshot& parentSnapshot,
                                           const LayerHierarchy::TraversalPath& path) {
     // Always update flags and visibility
-    ftl::Flags<RequestedLayerState::Changes> parentChanges = parentSnapshot.changes &
-            (RequestedLayerState::Changes::Hierarchy | RequestedLayerState::Changes::Geometry |
-             RequestedLayerState::Changes::Visibility | RequestedLayerState::Changes::Metadata |
-             RequestedLayerState::Changes::AffectsChildren | RequestedLayerState::Changes::Input |
-             RequestedLayerState::Changes::FrameRate | RequestedLayerState::Changes::GameMode);
+    ftl::Flags<RequestedLayerState::Changes> parentChanges =
+            parentSnapshot.changes & kChangesInheritedByChildren;
     snapshot.changes |= parentChanges;
     if (args.displayChanges) snapshot.changes |= RequestedLayerState::Changes::Geometry;
     snapshot.reachablilty = LayerSnapshot::Reachablilty::Reachable;
@@ -1150,12 +1228,11 @@ std::vector<std::unique_ptr<LayerSnapshot>>& LayerSnapshotBuilder::getSnapshots(
 
 void LayerSnapshotBuilder::forEachVisibleSnapshot(const ConstVisitor& visitor) const {
     for (int i = 0; i < mNumInterestingSnapshots; i++) {
+        if (!mHotFields[(size_t)i].isVisible) continue;
         if (mSnapshots[(size_t)i] == nullptr) {
           ALOGV("%s snapshot is null", __func__);
         } else {
-            LayerSnapshot& snapshot = *mSnapshots[(size_t)i];
-            if (!snapshot.isVisible) continue;
-            visitor(snapshot);
+            visitor(*mSnapshots[(size_t)i]);
         }
     }
 }
@@ -1176,17 +1253,28 @@ void LayerSnapshotBuilder::forEachVisibleSnapshot(const ConstVisitor& visitor,
 
 void LayerSnapshotBuilder::forEachVisibleSnapshot(const Visitor& visitor) {
     for (int i = 0; i < mNumInterestingSnapshots; i++) {
-        std::unique_ptr<LayerSnapshot>& snapshot = mSnapshots.at((size_t)i);
-        if (!snapshot->isVisible) continue;
-        visitor(snapshot);
+        if (!mHotFields[(size_t)i].isVisible) continue;
+        visitor(mSnapshots.at((size_t)i));
     }
 }
 
 void LayerSnapshotBuilder::forEachInputSnapshot(const ConstVisitor& visitor) const {
     for (int i = mNumInterestingSnapshots - 1; i >= 0; i--) {
-        LayerSnapshot& snapshot = *mSnapshots[(size_t)i];
-        if (!snapshot.hasInputInfo()) continue;
-        visitor(snapshot);
+        if (!mHotFields[(size_t)i].hasInputInfo) continue;
+        visitor(*mSnapshots[(size_t)i]);
+    }
+}
+
+void LayerSnapshotBuilder::updateHotFields(const LayerSnapshot& snapshot) {
+    if (snapshot.globalZ < mHotFields.size()) {
+        mHotFields[snapshot.globalZ] = LayerSnapshotHotFields(snapshot);
+    }
+}
+
+void LayerSnapshotBuilder::updateAllHotFields() {
+    mHotFields.resize(mSnapshots.size());
+    for (auto& snapshot : mSnapshots) {
+        updateHotFields(*snapshot);
     }
 }
 
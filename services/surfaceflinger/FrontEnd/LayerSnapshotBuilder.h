@@ -73,6 +73,8 @@ public:
     std::vector<std::unique_ptr<LayerSnapshot>>& getSnapshots();
     LayerSnapshot* getSnapshot(uint32_t layerId) const;
     LayerSnapshot* getSnapshot(const LayerHierarchy::TraversalPath& id) const;
+    // Hot fields of each snapshot, indexed by the snapshot's globalZ.
+    const std::vector<LayerSnapshotHotFields>& getHotFields() const;
 
     typedef std::function<void(const LayerSnapshot& snapshot)> ConstVisitor;
 
@@ -101,6 +103,12 @@ private:
     const LayerSnapshot& updateSnapshotsInHierarchy(const Args&, const LayerHierarchy& hierarchy,
                                                     LayerHierarchy::TraversalPath& traversalPath,
                                                     const LayerSnapshot& parentSnapshot, int depth);
+    // Returns true if the hierarchy or any of its descendants have pending changes. Dirty
+    // hierarchies are tracked in mDirtyHierarchies so clean subtrees can be skipped.
+    bool markDirtyHierarchies(const LayerHierarchy& hierarchy, int depth);
+    bool canSkipSubtree(const LayerHierarchy& childHierarchy,
+                        const LayerHierarchy::TraversalPath& childPath,
+                        const LayerSnapshot& parentSnapshot) const;
     void updateSnapshot(LayerSnapshot&, const Args&, const RequestedLayerState&,
                         const LayerSnapshot& parentSnapshot, const LayerHierarchy::TraversalPath&);
     static void updateRelativeState(LayerSnapshot& snapshot, const LayerSnapshot& parentSnapshot,
@@ -123,6 +131,8 @@ private:
     void updateFrameRateFromChildSnapshot(LayerSnapshot& snapshot,
                                           const LayerSnapshot& childSnapshot, const Args& args);
     void updateTouchableRegionCrop(const Args& args);
+    void updateHotFields(const LayerSnapshot& snapshot);
+    void updateAllHotFields();
 
     std::unordered_map<LayerHierarchy::TraversalPath, LayerSnapshot*,
                        LayerHierarchy::TraversalPathHash>
@@ -133,6 +143,14 @@ private:
     std::unordered_set<LayerHierarchy::TraversalPath, LayerHierarchy::TraversalPathHash>
             mNeedsTouchableRegionCrop;
     std::vector<std::unique_ptr<LayerSnapshot>> mSnapshots;
+    // Kept in sync with mSnapshots at the end of each update.
+    std::vector<LayerSnapshotHotFields> mHotFields;
+    // Hierarchies containing at least one layer with pending changes. Only valid while
+    // mSkipCleanSubtrees is set.
+    std::unordered_set<const LayerHierarchy*> mDirtyHierarchies;
+    // Set when the hierarchy has not changed since the last update. In this mode the reachability
+    // of existing snapshots cannot change and subtrees without any changes are not revisited.
+    bool mSkipCleanSubtrees = false;
     bool mResortSnapshots = false;
     int mNumInterestingSnapshots = 0;
 };
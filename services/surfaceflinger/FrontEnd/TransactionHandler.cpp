@@ -35,13 +35,21 @@ void TransactionHandler::queueTransaction(TransactionState&& state) {
 }
 
 void TransactionHandler::collectTransactions() {
+    // Clients usually queue several transactions in a row with the same apply token. Remember the
+    // last pending queue so those transactions do not need a map lookup each.
+    IBinder* lastApplyToken = nullptr;
+    std::queue<TransactionState>* lastQueue = nullptr;
     while (!mLocklessTransactionQueue.isEmpty()) {
         auto maybeTransaction = mLocklessTransactionQueue.pop();
         if (!maybeTransaction.has_value()) {
             break;
         }
-        auto transaction = maybeTransaction.value();
-        mPendingTransactionQueues[transaction.applyToken].emplace(std::move(transaction));
+        TransactionState& transaction = *maybeTransaction;
+        if (!lastQueue || transaction.applyToken.get() != lastApplyToken) {
+            lastApplyToken = transaction.applyToken.get();
+            lastQueue = &mPendingTransactionQueues[transaction.applyToken];
+        }
+        lastQueue->emplace(std::move(transaction));
     }
 }
 
@@ -57,16 +65,34 @@ std::vector<TransactionState> TransactionHandler::flushTransactions() {
     // and then satisfy in a later inner iteration of flushPendingTransactionQueues.
     // The barrier dependent transaction was eligible to be presented in this frame
     // but we would have prevented it without case. To fix this we continually
-    // loop through flushPendingTransactionQueues until we perform an iteration
-    // where the number of transactionsPendingBarrier doesn't change. This way
+    // loop through the queues blocked on a barrier until we perform an iteration
+    // where the number of queues pending on a barrier doesn't change. This way
     // we can continue to resolve dependency chains of barriers as far as possible.
-    int lastTransactionsPendingBarrier = 0;
-    int transactionsPendingBarrier = 0;
-    do {
-        lastTransactionsPendingBarrier = transactionsPendingBarrier;
-        // Collect transactions that are ready to be applied.
-        transactionsPendingBarrier = flushPendingTransactionQueues(transactions, flushState);
-    } while (lastTransactionsPendingBarrier != transactionsPendingBarrier);
+    // Only queues blocked on a barrier are revisited, since applying transactions
+    // cannot make any other queue ready within the same flush.
+    std::vector<sp<IBinder>> queuesPendingBarrier;
+    flushPendingTransactionQueues(transactions, flushState, queuesPendingBarrier);
+    while (!queuesPendingBarrier.empty()) {
+        const size_t lastQueuesPendingBarrier = queuesPendingBarrier.size();
+        std::vector<sp<IBinder>> queuesToFlush;
+        std::swap(queuesToFlush, queuesPendingBarrier);
+        for (const auto& applyToken : queuesToFlush) {
+            auto it = mPendingTransactionQueues.find(applyToken);
+            if (it == mPendingTransactionQueues.end()) {
+                continue;
+            }
+            if (flushPendingTransactionQueue(transactions, flushState, it->first, it->second) ==
+                TransactionReadiness::NotReadyBarrier) {
+                queuesPendingBarrier.emplace_back(applyToken);
+            }
+            if (it->second.empty()) {
+                mPendingTransactionQueues.erase(it);
+            }
+        }
+        if (queuesPendingBarrier.size() == lastQueuesPendingBarrier) {
+            break;
+        }
+    }
 
     applyUnsignaledBufferTransaction(transactions, flushState);
 
@@ -146,29 +172,35 @@ TransactionHandler::TransactionReadiness TransactionHandler::applyFilters(
     return ready;
 }
 
-int TransactionHandler::flushPendingTransactionQueues(std::vector<TransactionState>& transactions,
-                                                      TransactionFlushState& flushState) {
-    int transactionsPendingBarrier = 0;
+TransactionHandler::TransactionReadiness TransactionHandler::flushPendingTransactionQueue(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        const sp<IBinder>& applyToken, std::queue<TransactionState>& queue) {
+    while (!queue.empty()) {
+        auto& transaction = queue.front();
+        flushState.transaction = &transaction;
+        auto ready = applyFilters(flushState);
+        if (ready == TransactionReadiness::NotReadyUnsignaled) {
+            // We maybe able to latch this transaction if it's the only transaction
+            // ready to be applied.
+            flushState.queueWithUnsignaledBuffer = applyToken;
+        }
+        if (ready != TransactionReadiness::Ready) {
+            return ready;
+        }
+        popTransactionFromPending(transactions, flushState, queue);
+    }
+    return TransactionReadiness::Ready;
+}
+
+void TransactionHandler::flushPendingTransactionQueues(
+        std::vector<TransactionState>& transactions, TransactionFlushState& flushState,
+        std::vector<sp<IBinder>>& outQueuesPendingBarrier) {
     auto it = mPendingTransactionQueues.begin();
     while (it != mPendingTransactionQueues.end()) {
         auto& [applyToken, queue] = *it;
-        while (!queue.empty()) {
-            auto& transaction = queue.front();
-            flushState.transaction = &transaction;
-            auto ready = applyFilters(flushState);
-            if (ready == TransactionReadiness::NotReadyBarrier) {
-                transactionsPendingBarrier++;
-                break;
-            } else if (ready == TransactionReadiness::NotReady) {
-                break;
-            } else if (ready == TransactionReadiness::NotReadyUnsignaled) {
-                // We maybe able to latch this transaction if it's the only transaction
-                // ready to be applied.
-                flushState.queueWithUnsignaledBuffer = applyToken;
-                break;
-            }
-            // ready == TransactionReadiness::Ready
-            popTransactionFromPending(transactions, flushState, queue);
+        if (flushPendingTransactionQueue(transactions, flushState, applyToken, queue) ==
+            TransactionReadiness::NotReadyBarrier) {
+            outQueuesPendingBarrier.emplace_back(applyToken);
         }
 
         if (queue.empty()) {
@@ -177,7 +209,6 @@ int TransactionHandler::flushPendingTransactionQueues(std::vector<TransactionSta
             it = std::next(it, 1);
         }
     }
-    return transactionsPendingBarrier;
 }
 
 void TransactionHandler::addTransactionReadyFilter(TransactionFilter&& filter) {
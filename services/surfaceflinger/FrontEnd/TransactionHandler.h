@@ -81,7 +81,16 @@ private:
     // For unit tests
     friend class ::android::TestableSurfaceFlinger;
 
-    int flushPendingTransactionQueues(std::vector<TransactionState>&, TransactionFlushState&);
+    // Applies the ready transactions from all pending queues and collects the apply tokens of the
+    // queues that are blocked on a barrier.
+    void flushPendingTransactionQueues(std::vector<TransactionState>&, TransactionFlushState&,
+                                       std::vector<sp<IBinder>>& outQueuesPendingBarrier);
+    // Applies the ready transactions from the front of a single queue and returns the readiness
+    // of the first transaction that could not be applied.
+    TransactionReadiness flushPendingTransactionQueue(std::vector<TransactionState>&,
+                                                      TransactionFlushState&,
+                                                      const sp<IBinder>& applyToken,
+                                                      std::queue<TransactionState>&);
     void applyUnsignaledBufferTransaction(std::vector<TransactionState>&, TransactionFlushState&);
     void popTransactionFromPending(std::vector<TransactionState>&, TransactionFlushState&,
                                    std::queue<TransactionState>&);
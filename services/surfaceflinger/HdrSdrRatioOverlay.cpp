@@ -148,27 +148,9 @@ void HdrSdrRatioOverlay::setViewport(ui::Size viewport) {
             .apply();
 }
 
-auto HdrSdrRatioOverlay::getOrCreateBuffers(float currentHdrSdrRatio) -> const sp<GraphicBuffer> {
-    static const sp<GraphicBuffer> kNoBuffer;
-    if (!mSurfaceControl) return kNoBuffer;
-
-    const auto transformHint =
-            static_cast<ui::Transform::RotationFlags>(mSurfaceControl->get()->getTransformHint());
-
-    // Tell SurfaceFlinger about the pre-rotation on the buffer.
-    const auto transform = [&] {
-        switch (transformHint) {
-            case ui::Transform::ROT_90:
-                return ui::Transform::ROT_270;
-            case ui::Transform::ROT_270:
-                return ui::Transform::ROT_90;
-            default:
-                return ui::Transform::ROT_0;
-        }
-    }();
-
-    SurfaceComposerClient::Transaction().setTransform(mSurfaceControl->get(), transform).apply();
-
+auto HdrSdrRatioOverlay::getOrCreateBuffers(float currentHdrSdrRatio,
+                                            ui::Transform::RotationFlags transformHint)
+        -> const sp<GraphicBuffer> {
     constexpr SkColor kMinRatioColor = SK_ColorBLUE;
     constexpr SkColor kMaxRatioColor = SK_ColorGREEN;
     constexpr float kAlpha = 0.8f;
@@ -194,8 +176,30 @@ auto HdrSdrRatioOverlay::getOrCreateBuffers(float currentHdrSdrRatio) -> const s
 
 void HdrSdrRatioOverlay::animate() {
     if (!std::isfinite(mCurrentHdrSdrRatio) || mCurrentHdrSdrRatio < 1.0f) return;
+    if (!mSurfaceControl) return;
+
+    const auto transformHint =
+            static_cast<ui::Transform::RotationFlags>(mSurfaceControl->get()->getTransformHint());
+    const Key key{static_cast<int>(mCurrentHdrSdrRatio * 100), transformHint};
+    if (mCurrentKey == key) return;
+    mCurrentKey = key;
+
+    // Tell SurfaceFlinger about the pre-rotation on the buffer.
+    const auto transform = [&] {
+        switch (transformHint) {
+            case ui::Transform::ROT_90:
+                return ui::Transform::ROT_270;
+            case ui::Transform::ROT_270:
+                return ui::Transform::ROT_90;
+            default:
+                return ui::Transform::ROT_0;
+        }
+    }();
+
     SurfaceComposerClient::Transaction()
-            .setBuffer(mSurfaceControl->get(), getOrCreateBuffers(mCurrentHdrSdrRatio))
+            .setTransform(mSurfaceControl->get(), transform)
+            .setBuffer(mSurfaceControl->get(),
+                       getOrCreateBuffers(mCurrentHdrSdrRatio, transformHint))
             .apply();
 }
 
@@ -18,7 +18,10 @@
 
 #include "Utils/OverlayUtils.h"
 
+#include <optional>
+
 #include <ui/Size.h>
+#include <ui/Transform.h>
 #include <utils/StrongPointer.h>
 
 class SkCanvas;
@@ -46,12 +49,23 @@ private:
                                   sp<GraphicBuffer>& ringBufer);
     static void drawNumber(float number, int left, SkColor, SkCanvas&);
 
-    const sp<GraphicBuffer> getOrCreateBuffers(float currentHdrSdrRatio);
+    const sp<GraphicBuffer> getOrCreateBuffers(float currentHdrSdrRatio,
+                                               ui::Transform::RotationFlags transformHint);
 
     float mCurrentHdrSdrRatio = 1.f;
     const std::unique_ptr<SurfaceControlHolder> mSurfaceControl;
 
     size_t mIndex = 0;
     std::array<sp<GraphicBuffer>, 2> mRingBuffer;
+
+    // What the current buffer shows. The ratio may change every frame, but is only drawn with two
+    // decimals, so most updates do not change the buffer and are skipped.
+    struct Key {
+        int value;
+        ui::Transform::RotationFlags flags;
+
+        bool operator==(Key other) const { return value == other.value && flags == other.flags; }
+    };
+    std::optional<Key> mCurrentKey;
 };
 } // namespace android
@@ -2860,9 +2860,11 @@ void Layer::callReleaseBufferCallback(const sp<ITransactionCompletedListener>& l
     ATRACE_FORMAT_INSTANT("callReleaseBufferCallback %s - %" PRIu64, getDebugName(), framenumber);
     uint32_t currentMaxAcquiredBufferCount =
             mFlinger->getMaxAcquiredBufferCountForCurrentRefreshRate(mOwnerUid);
-    listener->onReleaseBuffer({buffer->getId(), framenumber},
-                              releaseFence ? releaseFence : Fence::NO_FENCE,
-                              currentMaxAcquiredBufferCount);
+    mFlinger->mTransactionCallbackInvoker.addReleaseBuffer(listener,
+                                                           {{buffer->getId(), framenumber},
+                                                            releaseFence ? releaseFence
+                                                                         : Fence::NO_FENCE,
+                                                            currentMaxAcquiredBufferCount});
 }
 
 sp<CallbackHandle> Layer::findCallbackHandle() {
@@ -3611,6 +3613,8 @@ void Layer::updateTexImage(nsecs_t latchTime, bool bgColorOnly) {
     const uint64_t bufferId = mDrawingState.buffer->getId();
     const uint64_t frameNumber = mDrawingState.frameNumber;
     const auto acquireFence = std::make_shared<FenceTime>(mDrawingState.acquireFence);
+    // TimeStats and FrameTracer poll this until it signals.
+    FenceTimeResolver::getInstance().watch(acquireFence);
     mFlinger->mTimeStats->setAcquireFence(layerId, frameNumber, acquireFence);
     mFlinger->mTimeStats->setLatchTime(layerId, frameNumber, latchTime);
 
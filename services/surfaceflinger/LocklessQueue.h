@@ -17,6 +17,7 @@
 #pragma once
 #include <atomic>
 #include <optional>
+#include <utility>
 
 template <typename T>
 // Single consumer multi producer stack. We can understand the two operations independently to see
@@ -36,20 +37,23 @@ template <typename T>
 // then store the list and pop one element.
 //
 // If we already had something in the pop list we just pop directly.
+//
+// Values are moved in and out of the queue so large values such as TransactionState are not
+// copied on the way from the producer to the consumer.
 class LocklessQueue {
 public:
     class Entry {
     public:
         T mValue;
         std::atomic<Entry*> mNext;
-        Entry(T value) : mValue(value) {}
+        Entry(T&& value) : mValue(std::move(value)) {}
     };
     std::atomic<Entry*> mPush = nullptr;
     std::atomic<Entry*> mPop = nullptr;
     bool isEmpty() { return (mPush.load() == nullptr) && (mPop.load() == nullptr); }
 
     void push(T value) {
-        Entry* entry = new Entry(value);
+        Entry* entry = new Entry(std::move(value));
         Entry* previousHead = mPush.load(/*std::memory_order_relaxed*/);
         do {
             entry->mNext = previousHead;
@@ -60,9 +64,9 @@ public:
         if (popped) {
             // Single consumer so this is fine
             mPop.store(popped->mNext /* , std::memory_order_release */);
-            auto value = popped->mValue;
+            std::optional<T> value = std::move(popped->mValue);
             delete popped;
-            return std::move(value);
+            return value;
         } else {
             Entry* grabbedList = mPush.exchange(nullptr /* , std::memory_order_acquire */);
             if (!grabbedList) return std::nullopt;
@@ -74,9 +78,9 @@ public:
                 grabbedList = next;
             }
             mPop.store(popped /* , std::memory_order_release */);
-            auto value = grabbedList->mValue;
+            std::optional<T> value = std::move(grabbedList->mValue);
             delete grabbedList;
-            return std::move(value);
+            return value;
         }
     }
 };
@@ -202,7 +202,7 @@ auto RefreshRateOverlay::getOrCreateBuffers(Fps refreshRate, Fps renderFps, bool
             static_cast<ui::Transform::RotationFlags>(mSurfaceControl->get()->getTransformHint());
 
     // Tell SurfaceFlinger about the pre-rotation on the buffer.
-    const auto transform = [&] {
+    mBufferTransform = [&] {
         switch (transformHint) {
             case ui::Transform::ROT_90:
                 return ui::Transform::ROT_270;
@@ -213,8 +213,6 @@ auto RefreshRateOverlay::getOrCreateBuffers(Fps refreshRate, Fps renderFps, bool
         }
     }();
 
-    createTransaction().setTransform(mSurfaceControl->get(), transform).apply();
-
     BufferCache::const_iterator it = mBufferCache.find(
             {refreshRate.getIntValue(), renderFps.getIntValue(), transformHint, idle});
     if (it == mBufferCache.end()) {
@@ -276,7 +274,7 @@ void RefreshRateOverlay::changeRefreshRate(Fps refreshRate, Fps renderFps) {
     mRefreshRate = refreshRate;
     mRenderFps = renderFps;
     const auto buffer = getOrCreateBuffers(refreshRate, renderFps, mIsVrrIdle)[mFrame];
-    createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
+    setBuffer(buffer);
 }
 
 void RefreshRateOverlay::onVrrIdle(bool idle) {
@@ -284,7 +282,7 @@ void RefreshRateOverlay::onVrrIdle(bool idle) {
     if (!mRefreshRate || !mRenderFps) return;
 
     const auto buffer = getOrCreateBuffers(*mRefreshRate, *mRenderFps, mIsVrrIdle)[mFrame];
-    createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
+    setBuffer(buffer);
 }
 
 void RefreshRateOverlay::changeRenderRate(Fps renderFps) {
@@ -292,7 +290,7 @@ void RefreshRateOverlay::changeRenderRate(Fps renderFps) {
         FlagManager::getInstance().misc1()) {
         mRenderFps = renderFps;
         const auto buffer = getOrCreateBuffers(*mRefreshRate, renderFps, mIsVrrIdle)[mFrame];
-        createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
+        setBuffer(buffer);
     }
 }
 
@@ -302,7 +300,18 @@ void RefreshRateOverlay::animate() {
     const auto& buffers = getOrCreateBuffers(*mRefreshRate, *mRenderFps, mIsVrrIdle);
     mFrame = (mFrame + 1) % buffers.size();
     const auto buffer = buffers[mFrame];
-    createTransaction().setBuffer(mSurfaceControl->get(), buffer).apply();
+    setBuffer(buffer);
+}
+
+void RefreshRateOverlay::setBuffer(const sp<GraphicBuffer>& buffer) {
+    // The buffer cache is keyed by transform hint, so the same buffer means the same transform.
+    if (buffer == mCurrentBuffer) return;
+    mCurrentBuffer = buffer;
+
+    createTransaction()
+            .setTransform(mSurfaceControl->get(), mBufferTransform)
+            .setBuffer(mSurfaceControl->get(), buffer)
+            .apply();
 }
 
 SurfaceComposerClient::Transaction RefreshRateOverlay::createTransaction() const {
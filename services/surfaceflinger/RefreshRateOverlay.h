@@ -75,6 +75,9 @@ private:
 
     SurfaceComposerClient::Transaction createTransaction() const;
 
+    // Shows buffer, pre-rotated by mBufferTransform. Does nothing if it is already shown.
+    void setBuffer(const sp<GraphicBuffer>& buffer);
+
     struct Key {
         int refreshRate;
         int renderFps;
@@ -95,6 +98,10 @@ private:
     bool mIsVrrIdle = false;
     size_t mFrame = 0;
 
+    // Cached buffers are never redrawn, so a buffer that is already shown needs no transaction.
+    sp<GraphicBuffer> mCurrentBuffer;
+    ui::Transform::RotationFlags mBufferTransform = ui::Transform::ROT_0;
+
     const FpsRange mFpsRange; // For color interpolation.
     const ftl::Flags<Features> mFeatures;
 
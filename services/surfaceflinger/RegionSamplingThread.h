@@ -44,6 +44,8 @@ using gui::IRegionSamplingListener;
 
 float sampleArea(const uint32_t* data, int32_t width, int32_t height, int32_t stride,
                  uint32_t orientation, const Rect& area);
+Rect toSampledBufferArea(const Rect& area, const Rect& sampledBounds, int32_t bufferWidth,
+                         int32_t bufferHeight);
 
 class RegionSamplingThread : public IBinder::DeathRecipient {
 public:
@@ -92,7 +94,7 @@ private:
     };
 
     std::vector<float> sampleBuffer(
-            const sp<GraphicBuffer>& buffer, const Point& leftTop,
+            const sp<GraphicBuffer>& buffer, const Rect& sampledBounds,
             const std::vector<RegionSamplingThread::Descriptor>& descriptors, uint32_t orientation);
 
     void doSample(std::optional<std::chrono::steady_clock::time_point> samplingDeadline);
@@ -120,6 +122,9 @@ private:
     std::unordered_map<wp<IBinder>, Descriptor, WpHash> mDescriptors GUARDED_BY(mSamplingMutex);
     std::shared_ptr<renderengine::ExternalTexture> mCachedBuffer GUARDED_BY(mSamplingMutex) =
             nullptr;
+    // Hash of the sampled bounds, listeners and the content of every layer drawn by the last
+    // capture. A capture with the same hash would produce the same lumas, so it is skipped.
+    std::optional<size_t> mLastSampleContentHash GUARDED_BY(mSamplingMutex);
 };
 
 } // namespace android
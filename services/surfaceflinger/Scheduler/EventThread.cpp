@@ -37,6 +37,8 @@
 #include <cutils/compiler.h>
 #include <cutils/sched_policy.h>
 
+#include <ftl/small_map.h>
+
 #include <gui/DisplayEventReceiver.h>
 #include <gui/SchedulingPolicy.h>
 
@@ -704,14 +706,24 @@ void EventThread::dispatchEvent(const DisplayEventReceiver::Event& event,
     /* QTI_BEGIN */
     const uint8_t num_attempts = 3;
     /* QTI_END */
+    // Most consumers share a frame interval, and so the same frame timelines. Generate them once per
+    // interval rather than once per consumer, since each timeline registers a prediction with the
+    // token manager.
+    ftl::SmallMap<nsecs_t, VsyncEventData, 4> vsyncDataByFrameInterval;
+
     for (const auto& consumer : consumers) {
         DisplayEventReceiver::Event copy = event;
         if (event.header.type == DisplayEventReceiver::DISPLAY_EVENT_VSYNC) {
-            const Period frameInterval = mCallback.getVsyncPeriod(consumer->mOwnerUid);
-            copy.vsync.vsyncData.frameInterval = frameInterval.ns();
-            generateFrameTimeline(copy.vsync.vsyncData, frameInterval.ns(), copy.header.timestamp,
-                                  event.vsync.vsyncData.preferredExpectedPresentationTime(),
-                                  event.vsync.vsyncData.preferredDeadlineTimestamp());
+            const nsecs_t frameInterval = mCallback.getVsyncPeriod(consumer->mOwnerUid).ns();
+            const auto [it, inserted] =
+                    vsyncDataByFrameInterval.try_emplace(frameInterval, event.vsync.vsyncData);
+            if (inserted) {
+                it->second.frameInterval = frameInterval;
+                generateFrameTimeline(it->second, frameInterval, event.header.timestamp,
+                                      event.vsync.vsyncData.preferredExpectedPresentationTime(),
+                                      event.vsync.vsyncData.preferredDeadlineTimestamp());
+            }
+            copy.vsync.vsyncData = it->second;
         }
         /* QTI_BEGIN */
         bool qtiNeedsRetry = true;
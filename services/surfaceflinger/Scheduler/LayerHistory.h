@@ -72,7 +72,9 @@ public:
         SetFrameRate, // setFrameRate API was called
     };
 
-    // Marks the layer as active, and records the given state to its history.
+    // Marks the layer as active, and records the given state to its history. This is called on
+    // the main thread while committing transactions, not from the binder threads that queue
+    // buffers, so it only contends on mLock with layer (de)registration and dumpsys.
     void record(int32_t id, const LayerProps& props, nsecs_t presentTime, nsecs_t now,
                 LayerUpdateType updateType);
 
@@ -22,6 +22,7 @@
 
 #include <ftl/concat.h>
 #include <ftl/optional.h>
+#include <ftl/small_vector.h>
 #include <ftl/unit.h>
 #include <gui/DisplayEventReceiver.h>
 
@@ -188,7 +189,8 @@ public:
             return name == other.name && vote == other.vote &&
                     isApproxEqual(desiredRefreshRate, other.desiredRefreshRate) &&
                     seamlessness == other.seamlessness && weight == other.weight &&
-                    focused == other.focused && frameRateCategory == other.frameRateCategory;
+                    focused == other.focused && frameRateCategory == other.frameRateCategory &&
+                    frameRateCategorySmoothSwitchOnly == other.frameRateCategorySmoothSwitchOnly;
         }
 
         bool operator!=(const LayerRequirement& other) const { return !(*this == other); }
@@ -577,7 +579,12 @@ private:
                     isApproxEqual(pacesetterFps, other.pacesetterFps);
         }
     };
-    mutable std::optional<GetRankedFrameRatesCache> mGetRankedFrameRatesCache GUARDED_BY(mLock);
+    // The scheduler tends to alternate between a few inputs, e.g. as touch boost or the idle
+    // timer toggle, so keep the most recent invocations rather than just the last one.
+    static constexpr size_t kGetRankedFrameRatesCacheSize = 4;
+    // Ordered from most to least recently used.
+    mutable ftl::SmallVector<GetRankedFrameRatesCache, kGetRankedFrameRatesCacheSize>
+            mGetRankedFrameRatesCache GUARDED_BY(mLock);
 
     // Declare mIdleTimer last to ensure its thread joins before the mutex/callbacks are destroyed.
     std::mutex mIdleTimerCallbacksMutex;
@@ -16,6 +16,7 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <algorithm>
 #include <vector>
 
 #include <android-base/stringprintf.h>
@@ -381,6 +382,13 @@ void VSyncDispatchTimerQueue::timerCallback() {
         rearmTimer(mTimeKeeper->now());
     }
 
+    // Callbacks grouped into this wakeup run in the order they asked to be woken up, so one that
+    // was due earlier is not delayed behind a later one.
+    std::stable_sort(invocations.begin(), invocations.end(),
+                     [](const Invocation& lhs, const Invocation& rhs) {
+                         return lhs.wakeupTimestamp < rhs.wakeupTimestamp;
+                     });
+
     for (auto const& invocation : invocations) {
         ftl::Concat trace(ftl::truncated<5>(invocation.callback->name()));
         ATRACE_FORMAT("%s: %s", __func__, trace.c_str());
@@ -191,9 +191,6 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     //
     // intercept = mean(Y) - slope * mean(X)
     //
-    std::vector<nsecs_t> vsyncTS(numSamples);
-    std::vector<nsecs_t> ordinals(numSamples);
-
     // Normalizing to the oldest timestamp cuts down on error in calculating the intercept.
     const auto oldestTS = *std::min_element(mTimestamps.begin(), mTimestamps.end());
     auto it = mRateMap.find(idealPeriod());
@@ -203,34 +200,36 @@ bool VSyncPredictor::addVsyncTimestamp(nsecs_t timestamp) {
     // fixed-point arithmetic.
     constexpr int64_t kScalingFactor = 1000;
 
+    // This runs for every HW vsync sample, so the normalized samples are recomputed on the second
+    // pass rather than stored in temporary vectors.
+    const auto sampleAt = [&](size_t i) -> std::pair<nsecs_t, nsecs_t> {
+        const auto vsyncTS = mTimestamps[i] - oldestTS;
+        const auto ordinal = currentPeriod == 0
+                ? 0
+                : (vsyncTS + currentPeriod / 2) / currentPeriod * kScalingFactor;
+        return {vsyncTS, ordinal};
+    };
+
     nsecs_t meanTS = 0;
     nsecs_t meanOrdinal = 0;
 
     for (size_t i = 0; i < numSamples; i++) {
-        const auto timestamp = mTimestamps[i] - oldestTS;
-        vsyncTS[i] = timestamp;
-        meanTS += timestamp;
-
-        const auto ordinal = currentPeriod == 0
-                ? 0
-                : (vsyncTS[i] + currentPeriod / 2) / currentPeriod * kScalingFactor;
-        ordinals[i] = ordinal;
+        const auto [vsyncTS, ordinal] = sampleAt(i);
+        meanTS += vsyncTS;
         meanOrdinal += ordinal;
     }
 
     meanTS /= numSamples;
     meanOrdinal /= numSamples;
 
-    for (size_t i = 0; i < numSamples; i++) {
-        vsyncTS[i] -= meanTS;
-        ordinals[i] -= meanOrdinal;
-    }
-
     nsecs_t top = 0;
     nsecs_t bottom = 0;
     for (size_t i = 0; i < numSamples; i++) {
-        top += vsyncTS[i] * ordinals[i];
-        bottom += ordinals[i] * ordinals[i];
+        auto [vsyncTS, ordinal] = sampleAt(i);
+        vsyncTS -= meanTS;
+        ordinal -= meanOrdinal;
+        top += vsyncTS * ordinal;
+        bottom += ordinal * ordinal;
     }
 
     if (CC_UNLIKELY(bottom == 0)) {
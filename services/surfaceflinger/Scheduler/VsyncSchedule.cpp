@@ -16,6 +16,9 @@
 
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
+#include <algorithm>
+
+#include <android-base/properties.h>
 #include <common/FlagManager.h>
 
 #include <ftl/fake_guard.h>
@@ -128,11 +131,21 @@ VsyncSchedule::DispatchPtr VsyncSchedule::createDispatch(TrackerPtr tracker) {
     using namespace std::chrono_literals;
 
     // TODO(b/144707443): Tune constants.
-    constexpr std::chrono::nanoseconds kGroupDispatchWithin = 500us;
+    constexpr std::chrono::microseconds kGroupDispatchWithin = 500us;
     constexpr std::chrono::nanoseconds kSnapToSameVsyncWithin = 3ms;
 
+    // Wider grouping saves timer thread wakeups at the cost of running callbacks earlier than
+    // requested. Keep it below the distance at which vsyncs are considered the same, so a group
+    // never spans two vsyncs.
+    const std::chrono::microseconds requestedGroupDispatchWithin(
+            base::GetIntProperty("debug.sf.vsync_group_dispatch_within_us",
+                                 kGroupDispatchWithin.count()));
+    const std::chrono::nanoseconds groupDispatchWithin =
+            std::clamp<std::chrono::nanoseconds>(requestedGroupDispatchWithin, 0ns,
+                                                 kSnapToSameVsyncWithin - 1ns);
+
     return std::make_unique<VSyncDispatchTimerQueue>(std::make_unique<Timer>(), std::move(tracker),
-                                                     kGroupDispatchWithin.count(),
+                                                     groupDispatchWithin.count(),
                                                      kSnapToSameVsyncWithin.count());
 }
 
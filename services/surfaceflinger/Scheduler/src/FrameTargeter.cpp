@@ -144,6 +144,8 @@ void FrameTargeter::endFrame(const CompositeResult& result) {
 
 FenceTimePtr FrameTargeter::setPresentFence(sp<Fence> presentFence) {
     auto presentFenceTime = std::make_shared<FenceTime>(presentFence);
+    // The present fence is polled every frame until it signals.
+    FenceTimeResolver::getInstance().watch(presentFenceTime);
     return setPresentFence(std::move(presentFence), std::move(presentFenceTime));
 }
 
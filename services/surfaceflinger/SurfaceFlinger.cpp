@@ -890,6 +890,7 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
     ATRACE_CALL();
     ALOGI(  "SurfaceFlinger's main thread ready to run. "
             "Initializing graphics H/W...");
+    const nsecs_t initStartTime = systemTime();
     addTransactionReadyFilters();
     Mutex::Autolock lock(mStateLock);
 
@@ -907,10 +908,11 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
                                            ? renderengine::RenderEngine::ContextPriority::REALTIME
                                            : renderengine::RenderEngine::ContextPriority::MEDIUM);
     chooseRenderEngineType(builder);
+    // A threaded RenderEngine creates its context on its own thread. Nothing below waits for the
+    // context until mMaxRenderTargetSize is queried, so connecting to the composer HAL overlaps
+    // with the context creation.
     mRenderEngine = renderengine::RenderEngine::create(builder.build());
     mCompositionEngine->setRenderEngine(mRenderEngine.get());
-    mMaxRenderTargetSize =
-            std::min(getRenderEngine().getMaxTextureSize(), getRenderEngine().getMaxViewportDims());
 
     // Set SF main policy after initializing RenderEngine which has its own policy.
     if (!SetTaskProfiles(0, {"SFMainPolicy"})) {
@@ -931,6 +933,10 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
 
     enableLatchUnsignaledConfig = getLatchUnsignaledConfig();
 
+    mMaxRenderTargetSize =
+            std::min(getRenderEngine().getMaxTextureSize(), getRenderEngine().getMaxViewportDims());
+    ALOGI("Graphics H/W connected after %" PRId64 " ms", ns2ms(systemTime() - initStartTime));
+
     // Process hotplug for displays connected at boot.
     LOG_ALWAYS_FATAL_IF(!configureLocked(),
                         "Initial display configuration failed: HWC did not hotplug");
@@ -1043,6 +1049,7 @@ void SurfaceFlinger::init() FTL_FAKE_GUARD(kMainThreadContext) {
     });
 
     initTransactionTraceWriter();
+    ALOGI("SurfaceFlinger initialized in %" PRId64 " ms", ns2ms(systemTime() - initStartTime));
     /* QTI_BEGIN */
     mQtiSFExtnIntf =
             mQtiSFExtnIntf->qtiPostInit(static_cast<android::impl::HWComposer&>(
@@ -2491,6 +2498,8 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
     frontend::Update update;
     if (flushTransactions) {
         ATRACE_NAME("TransactionHandler:flushTransactions");
+        TimeStats::ScopedFrameStage stage(mTimeStats.get(),
+                                          TimeStats::FrameStage::TransactionFlush);
         // Locking:
         // 1. to prevent onHandleDestroyed from being called while the state lock is held,
         // we must keep a copy of the transactions (specifically the composer
@@ -2543,6 +2552,7 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
 
     {
         ATRACE_NAME("LayerSnapshotBuilder:update");
+        TimeStats::ScopedFrameStage stage(mTimeStats.get(), TimeStats::FrameStage::SnapshotUpdate);
         frontend::LayerSnapshotBuilder::Args
                 args{.root = mLayerHierarchyBuilder.getHierarchy(),
                      .layerLifecycleManager = mLayerLifecycleManager,
@@ -2638,7 +2648,10 @@ bool SurfaceFlinger::updateLayerSnapshots(VsyncId vsyncId, nsecs_t frameTimeNs,
         mLayersIdsWithQueuedFrames.emplace(it->second->sequence);
     }
 
-    updateLayerHistory(latchTime);
+    {
+        TimeStats::ScopedFrameStage stage(mTimeStats.get(), TimeStats::FrameStage::LayerHistory);
+        updateLayerHistory(latchTime);
+    }
     mLayerSnapshotBuilder.forEachVisibleSnapshot([&](const frontend::LayerSnapshot& snapshot) {
         if (mLayersIdsWithQueuedFrames.find(snapshot.path.id) == mLayersIdsWithQueuedFrames.end())
             return;
@@ -2832,6 +2845,8 @@ bool SurfaceFlinger::commit(PhysicalDisplayId pacesetterId,
                                     Fps::fromPeriodNsecs(vsyncPeriod.ns()),
                                     mScheduler->getPacesetterRefreshRate());
 
+        // Coalesce the buffer releases from this commit; sendCallbacks() below flushes them.
+        mTransactionCallbackInvoker.beginReleaseBatch();
         const bool flushTransactions = clearTransactionFlags(eTransactionFlushNeeded);
         bool transactionsAreEmpty = false;
         if (mLayerLifecycleManagerEnabled) {
@@ -3265,6 +3280,12 @@ void SurfaceFlinger::onCompositionPresented(PhysicalDisplayId pacesetterId,
                                             nsecs_t presentStartTime) {
     ATRACE_CALL();
 
+    if (!mFirstFramePresented) {
+        mFirstFramePresented = true;
+        ALOGI("First frame presented %" PRId64 " ms after SurfaceFlinger started",
+              ns2ms(systemTime() - mBootTime));
+    }
+
     ui::PhysicalDisplayMap<PhysicalDisplayId, std::shared_ptr<FenceTime>> presentFences;
     ui::PhysicalDisplayMap<PhysicalDisplayId, const sp<Fence>> gpuCompositionDoneFences;
 
@@ -3390,62 +3411,69 @@ void SurfaceFlinger::onCompositionPresented(PhysicalDisplayId pacesetterId,
         mAddingHDRLayerInfoListener = false;
     }
 
-    if (haveNewListeners || mHdrLayerInfoChanged) {
-        for (auto& [compositionDisplay, listener] : hdrInfoListeners) {
-            HdrLayerInfoReporter::HdrLayerInfo info;
-            int32_t maxArea = 0;
-
-            auto updateInfoFn =
-                    [&](const std::shared_ptr<compositionengine::Display>& compositionDisplay,
-                        const frontend::LayerSnapshot& snapshot, const sp<LayerFE>& layerFe) {
-                        if (snapshot.isVisible &&
-                            compositionDisplay->includesLayer(snapshot.outputFilter)) {
-                            if (isHdrLayer(snapshot)) {
-                                const auto* outputLayer =
-                                        compositionDisplay->getOutputLayerForLayer(layerFe);
-                                if (outputLayer) {
-                                    const float desiredHdrSdrRatio =
-                                            snapshot.desiredHdrSdrRatio < 1.f
-                                            ? std::numeric_limits<float>::infinity()
-                                            : snapshot.desiredHdrSdrRatio;
-                                    info.mergeDesiredRatio(desiredHdrSdrRatio);
-                                    info.numberOfHdrLayers++;
-                                    const auto displayFrame = outputLayer->getState().displayFrame;
-                                    const int32_t area =
-                                            displayFrame.width() * displayFrame.height();
-                                    if (area > maxArea) {
-                                        maxArea = area;
-                                        info.maxW = displayFrame.width();
-                                        info.maxH = displayFrame.height();
-                                    }
-                                }
-                            }
-                        }
-                    };
+    if ((haveNewListeners || mHdrLayerInfoChanged) && !hdrInfoListeners.empty()) {
+        // The info of every display is computed in a single walk over the visible snapshots, so
+        // that each display with listeners does not add another traversal.
+        std::vector<HdrLayerInfoReporter::HdrLayerInfo> infos(hdrInfoListeners.size());
+        std::vector<int32_t> maxAreas(hdrInfoListeners.size(), 0);
 
-            if (mLayerLifecycleManagerEnabled) {
-                mLayerSnapshotBuilder.forEachVisibleSnapshot(
-                        [&, compositionDisplay = compositionDisplay](
-                                std::unique_ptr<frontend::LayerSnapshot>&
-                                        snapshot) FTL_FAKE_GUARD(kMainThreadContext) {
-                            auto it = mLegacyLayers.find(snapshot->sequence);
-                            LLOG_ALWAYS_FATAL_WITH_TRACE_IF(it == mLegacyLayers.end(),
-                                                            "Couldnt find layer object for %s",
-                                                            snapshot->getDebugString().c_str());
-                            auto& legacyLayer = it->second;
-                            sp<LayerFE> layerFe =
-                                    legacyLayer->getCompositionEngineLayerFE(snapshot->path);
-
-                            updateInfoFn(compositionDisplay, *snapshot, layerFe);
-                        });
-            } else {
-                mDrawingState.traverse([&, compositionDisplay = compositionDisplay](Layer* layer) {
-                    const auto layerFe = layer->getCompositionEngineLayerFE();
-                    const frontend::LayerSnapshot& snapshot = *layer->getLayerSnapshot();
-                    updateInfoFn(compositionDisplay, snapshot, layerFe);
-                });
+        auto updateInfoFn = [&](const frontend::LayerSnapshot& snapshot,
+                                const sp<LayerFE>& layerFe) {
+            for (size_t i = 0; i < hdrInfoListeners.size(); i++) {
+                const auto& compositionDisplay = hdrInfoListeners[i].first;
+                if (!compositionDisplay->includesLayer(snapshot.outputFilter)) {
+                    continue;
+                }
+                const auto* outputLayer = compositionDisplay->getOutputLayerForLayer(layerFe);
+                if (!outputLayer) {
+                    continue;
+                }
+                auto& info = infos[i];
+                const float desiredHdrSdrRatio = snapshot.desiredHdrSdrRatio < 1.f
+                        ? std::numeric_limits<float>::infinity()
+                        : snapshot.desiredHdrSdrRatio;
+                info.mergeDesiredRatio(desiredHdrSdrRatio);
+                info.numberOfHdrLayers++;
+                const auto displayFrame = outputLayer->getState().displayFrame;
+                const int32_t area = displayFrame.width() * displayFrame.height();
+                if (area > maxAreas[i]) {
+                    maxAreas[i] = area;
+                    info.maxW = displayFrame.width();
+                    info.maxH = displayFrame.height();
+                }
             }
-            listener->dispatchHdrLayerInfo(info);
+        };
+
+        if (mLayerLifecycleManagerEnabled) {
+            mLayerSnapshotBuilder.forEachVisibleSnapshot(
+                    [&](std::unique_ptr<frontend::LayerSnapshot>& snapshot)
+                            FTL_FAKE_GUARD(kMainThreadContext) {
+                                // Only HDR layers need their LayerFE to be looked up.
+                                if (!snapshot->isVisible || !isHdrLayer(*snapshot)) {
+                                    return;
+                                }
+                                auto it = mLegacyLayers.find(snapshot->sequence);
+                                LLOG_ALWAYS_FATAL_WITH_TRACE_IF(it == mLegacyLayers.end(),
+                                                                "Couldnt find layer object for %s",
+                                                                snapshot->getDebugString().c_str());
+                                auto& legacyLayer = it->second;
+                                sp<LayerFE> layerFe =
+                                        legacyLayer->getCompositionEngineLayerFE(snapshot->path);
+
+                                updateInfoFn(*snapshot, layerFe);
+                            });
+        } else {
+            mDrawingState.traverse([&](Layer* layer) {
+                const frontend::LayerSnapshot& snapshot = *layer->getLayerSnapshot();
+                if (!snapshot.isVisible || !isHdrLayer(snapshot)) {
+                    return;
+                }
+                updateInfoFn(snapshot, layer->getCompositionEngineLayerFE());
+            });
+        }
+
+        for (size_t i = 0; i < hdrInfoListeners.size(); i++) {
+            hdrInfoListeners[i].second->dispatchHdrLayerInfo(infos[i]);
         }
     }
 
@@ -4275,6 +4303,13 @@ void SurfaceFlinger::processDisplayChanged(const wp<IBinder>& displayToken,
             }
             /* QTI_END */
         }
+        if (display->isVirtual() &&
+            !isApproxEqual(currentState.requestedRefreshRate, drawingState.requestedRefreshRate)) {
+            // Composition of the display is skipped on frames which are not in phase with the
+            // adjusted refresh rate, see SurfaceFlinger::composite.
+            display->setRequestedRefreshRate(currentState.requestedRefreshRate);
+            display->adjustRefreshRate(mScheduler->getPacesetterRefreshRate());
+        }
     }
 }
 
@@ -5348,14 +5383,15 @@ TransactionHandler::TransactionReadiness SurfaceFlinger::transactionReadyBufferC
                                             layer->ownerUid.val());
                             ATRACE_FORMAT_INSTANT("callReleaseBufferCallback %s - %" PRIu64,
                                                   layer->name.c_str(), s.bufferData->frameNumber);
-                            s.bufferData->releaseBufferListener
-                                    ->onReleaseBuffer({resolvedState.externalTexture->getBuffer()
-                                                               ->getId(),
-                                                       s.bufferData->frameNumber},
-                                                      s.bufferData->acquireFence
-                                                              ? s.bufferData->acquireFence
-                                                              : Fence::NO_FENCE,
-                                                      currentMaxAcquiredBufferCount);
+                            mTransactionCallbackInvoker
+                                    .addReleaseBuffer(s.bufferData->releaseBufferListener,
+                                                      {{resolvedState.externalTexture->getBuffer()
+                                                                ->getId(),
+                                                        s.bufferData->frameNumber},
+                                                       s.bufferData->acquireFence
+                                                               ? s.bufferData->acquireFence
+                                                               : Fence::NO_FENCE,
+                                                       currentMaxAcquiredBufferCount});
                         }
 
                         // Delete the entire state at this point and not just release the buffer
@@ -5876,6 +5912,13 @@ uint32_t SurfaceFlinger::setDisplayStateLocked(const DisplayState& s) {
             flags |= eDisplayTransactionNeeded;
         }
     }
+    if (what & DisplayState::eRequestedRefreshRateChanged) {
+        const Fps requestedRefreshRate = Fps::fromValue(std::max(s.requestedRefreshRate, 0.f));
+        if (state.isVirtual() && !isApproxEqual(state.requestedRefreshRate, requestedRefreshRate)) {
+            state.requestedRefreshRate = requestedRefreshRate;
+            flags |= eDisplayTransactionNeeded;
+        }
+    }
 
     return flags;
 }
@@ -6871,8 +6914,9 @@ status_t SurfaceFlinger::doDump(int fd, const DumpArgs& args, bool asProto) {
             {"--displays"s, dumper(&SurfaceFlinger::dumpDisplays)},
             {"--edid"s, argsDumper(&SurfaceFlinger::dumpRawDisplayIdentificationData)},
             {"--events"s, dumper(&SurfaceFlinger::dumpEvents)},
+            {"--frame-stages"s, argsDumper(&SurfaceFlinger::dumpFrameStages)},
             {"--frametimeline"s, argsDumper(&SurfaceFlinger::dumpFrameTimeline)},
-            {"--frontend"s, mainThreadDumper(&SurfaceFlinger::dumpFrontEnd)},
+            {"--frontend"s, unlockedDumper(&SurfaceFlinger::dumpFrontEnd)},
             {"--hdrinfo"s, dumper(&SurfaceFlinger::dumpHdrInfo)},
             {"--hwclayers"s, mainThreadDumper(&SurfaceFlinger::dumpHwcLayersMinidump)},
             {"--latency"s, argsMainThreadDumper(&SurfaceFlinger::dumpStats)},
@@ -6892,15 +6936,8 @@ status_t SurfaceFlinger::doDump(int fd, const DumpArgs& args, bool asProto) {
         return NO_ERROR;
     }
 
-    // Traversal of drawing state must happen on the main thread.
-    // Otherwise, SortedVector may have shared ownership during concurrent
-    // traversals, which can result in use-after-frees.
     std::string compositionLayers;
-    mScheduler
-            ->schedule([&]() FTL_FAKE_GUARD(mStateLock) FTL_FAKE_GUARD(kMainThreadContext) {
-                dumpVisibleFrontEnd(compositionLayers);
-            })
-            .get();
+    dumpVisibleFrontEnd(compositionLayers);
 
     /* QTI_BEGIN */
     // selection of mini dumpsys (Format: adb shell dumpsys SurfaceFlinger --mini)
@@ -6956,6 +6993,10 @@ void SurfaceFlinger::dumpFrameTimeline(const DumpArgs& args, std::string& result
     mFrameTimeline->parseArgs(args, result);
 }
 
+void SurfaceFlinger::dumpFrameStages(const DumpArgs& args, std::string& result) const {
+    mTimeStats->parseFrameStageArgs(args, result);
+}
+
 void SurfaceFlinger::logFrameStats(TimePoint now) {
     static TimePoint sTimestamp = now;
     if (now - sTimestamp < 30min) return;
@@ -7022,6 +7063,7 @@ void SurfaceFlinger::dumpDisplays(std::string& result) const {
         utils::Dumper::Section section(dumper, ftl::Concat("Display ", id.value).str());
 
         display.snapshot().dump(dumper);
+        mDisplayModeController.dump(id, dumper);
 
         if (const auto device = getDisplayDeviceLocked(id)) {
             device->dump(dumper);
@@ -7125,35 +7167,32 @@ void SurfaceFlinger::dumpHdrInfo(std::string& result) const {
 }
 
 void SurfaceFlinger::dumpFrontEnd(std::string& result) {
-    std::ostringstream out;
-    out << "\nComposition list\n";
-    ui::LayerStack lastPrintedLayerStackHeader = ui::INVALID_LAYER_STACK;
-    for (const auto& snapshot : mLayerSnapshotBuilder.getSnapshots()) {
-        if (lastPrintedLayerStackHeader != snapshot->outputFilter.layerStack) {
-            lastPrintedLayerStackHeader = snapshot->outputFilter.layerStack;
-            out << "LayerStack=" << lastPrintedLayerStackHeader.id << "\n";
-        }
-        out << "  " << *snapshot << "\n";
-    }
-
-    out << "\nInput list\n";
-    lastPrintedLayerStackHeader = ui::INVALID_LAYER_STACK;
-    mLayerSnapshotBuilder.forEachInputSnapshot([&](const frontend::LayerSnapshot& snapshot) {
-        if (lastPrintedLayerStackHeader != snapshot.outputFilter.layerStack) {
-            lastPrintedLayerStackHeader = snapshot.outputFilter.layerStack;
-            out << "LayerStack=" << lastPrintedLayerStackHeader.id << "\n";
-        }
-        out << "  " << snapshot << "\n";
-    });
-
-    out << "\nLayer Hierarchy\n"
-        << mLayerHierarchyBuilder.getHierarchy().dump() << "\nOffscreen Hierarchy\n"
-        << mLayerHierarchyBuilder.getOffscreenHierarchy().dump() << "\n\n";
-    result.append(out.str());
+    FrontEndDump frontEnd;
+    mScheduler
+            ->schedule([&]() FTL_FAKE_GUARD(mStateLock) FTL_FAKE_GUARD(kMainThreadContext) {
+                frontEnd = captureFrontEnd(/*visibleOnly=*/false);
+            })
+            .get();
+    formatFrontEnd(frontEnd, result);
 }
 
 void SurfaceFlinger::dumpVisibleFrontEnd(std::string& result) {
-    if (!mLayerLifecycleManagerEnabled) {
+    // Traversal of drawing state must happen on the main thread.
+    // Otherwise, SortedVector may have shared ownership during concurrent
+    // traversals, which can result in use-after-frees.
+    FrontEndDump frontEnd;
+    mScheduler
+            ->schedule([&]() FTL_FAKE_GUARD(mStateLock) FTL_FAKE_GUARD(kMainThreadContext) {
+                frontEnd = captureFrontEnd(/*visibleOnly=*/true);
+            })
+            .get();
+    formatFrontEnd(frontEnd, result);
+}
+
+SurfaceFlinger::FrontEndDump SurfaceFlinger::captureFrontEnd(bool visibleOnly) {
+    FrontEndDump dump;
+    if (visibleOnly && !mLayerLifecycleManagerEnabled) {
+        std::string& result = dump.preformatted;
         StringAppendF(&result, "Composition layers\n");
         mDrawingState.traverseInZOrder([&](Layer* layer) {
             auto* compositionState = layer->getCompositionState();
@@ -7169,37 +7208,71 @@ void SurfaceFlinger::dumpVisibleFrontEnd(std::string& result) {
             offscreenLayer->traverse(LayerVector::StateSet::Drawing,
                                      [&](Layer* layer) { layer->dumpOffscreenDebugInfo(result); });
         }
-    } else {
-        std::ostringstream out;
-        out << "\nComposition list\n";
-        ui::LayerStack lastPrintedLayerStackHeader = ui::INVALID_LAYER_STACK;
+        return dump;
+    }
+
+    dump.hasSnapshots = true;
+    if (visibleOnly) {
         mLayerSnapshotBuilder.forEachVisibleSnapshot(
                 [&](std::unique_ptr<frontend::LayerSnapshot>& snapshot) {
                     if (snapshot->hasSomethingToDraw()) {
-                        if (lastPrintedLayerStackHeader != snapshot->outputFilter.layerStack) {
-                            lastPrintedLayerStackHeader = snapshot->outputFilter.layerStack;
-                            out << "LayerStack=" << lastPrintedLayerStackHeader.id << "\n";
-                        }
-                        out << "  " << *snapshot << "\n";
+                        dump.compositionSnapshots.push_back(*snapshot);
                     }
                 });
+    } else {
+        dump.compositionSnapshots.reserve(mLayerSnapshotBuilder.getSnapshots().size());
+        for (const auto& snapshot : mLayerSnapshotBuilder.getSnapshots()) {
+            dump.compositionSnapshots.push_back(*snapshot);
+        }
+    }
+    mLayerSnapshotBuilder.forEachInputSnapshot([&](const frontend::LayerSnapshot& snapshot) {
+        dump.inputSnapshots.push_back(snapshot);
+    });
+
+    // The hierarchy points into RequestedLayerStates owned by the main thread, so it is printed
+    // here. It is one short line per layer.
+    std::ostringstream out;
+    if (visibleOnly) {
+        out << "\nLayer Hierarchy\n"
+            << mLayerHierarchyBuilder.getHierarchy() << "\nOffscreen Hierarchy\n"
+            << mLayerHierarchyBuilder.getOffscreenHierarchy() << "\n\n";
+        dump.hierarchy = out.str();
+        dumpHwcLayersMinidump(dump.preformatted);
+    } else {
+        out << "\nLayer Hierarchy\n"
+            << mLayerHierarchyBuilder.getHierarchy().dump() << "\nOffscreen Hierarchy\n"
+            << mLayerHierarchyBuilder.getOffscreenHierarchy().dump() << "\n\n";
+        dump.hierarchy = out.str();
+    }
+    return dump;
+}
+
+void SurfaceFlinger::formatFrontEnd(const FrontEndDump& dump, std::string& result) {
+    if (!dump.hasSnapshots) {
+        result.append(dump.preformatted);
+        return;
+    }
 
-        out << "\nInput list\n";
-        lastPrintedLayerStackHeader = ui::INVALID_LAYER_STACK;
-        mLayerSnapshotBuilder.forEachInputSnapshot([&](const frontend::LayerSnapshot& snapshot) {
+    const auto printSnapshots = [](std::ostringstream& out,
+                                   const std::vector<frontend::LayerSnapshot>& snapshots) {
+        ui::LayerStack lastPrintedLayerStackHeader = ui::INVALID_LAYER_STACK;
+        for (const auto& snapshot : snapshots) {
             if (lastPrintedLayerStackHeader != snapshot.outputFilter.layerStack) {
                 lastPrintedLayerStackHeader = snapshot.outputFilter.layerStack;
                 out << "LayerStack=" << lastPrintedLayerStackHeader.id << "\n";
             }
             out << "  " << snapshot << "\n";
-        });
+        }
+    };
 
-        out << "\nLayer Hierarchy\n"
-            << mLayerHierarchyBuilder.getHierarchy() << "\nOffscreen Hierarchy\n"
-            << mLayerHierarchyBuilder.getOffscreenHierarchy() << "\n\n";
-        result = out.str();
-        dumpHwcLayersMinidump(result);
-    }
+    std::ostringstream out;
+    out << "\nComposition list\n";
+    printSnapshots(out, dump.compositionSnapshots);
+    out << "\nInput list\n";
+    printSnapshots(out, dump.inputSnapshots);
+    out << dump.hierarchy;
+    result.append(out.str());
+    result.append(dump.preformatted);
 }
 
 perfetto::protos::LayersProto SurfaceFlinger::dumpDrawingStateProto(uint32_t traceFlags) const {
@@ -7468,6 +7541,9 @@ void SurfaceFlinger::dumpAll(const DumpArgs& args, const std::string& compositio
     }
     result.push_back('\n');
 
+    BackgroundExecutor::dumpAll(result);
+    result.push_back('\n');
+
     {
         DumpArgs plannerArgs;
         plannerArgs.add(); // first argument is ignored
@@ -8784,18 +8860,53 @@ std::optional<SurfaceFlinger::OutputCompositionState>
 SurfaceFlinger::getDisplayAndLayerSnapshotsFromMainThread(
         RenderAreaBuilderVariant& renderAreaBuilder, GetLayerSnapshotsFunction getLayerSnapshotsFn,
         std::vector<sp<LayerFE>>& layerFEs) {
-    return mScheduler
-            ->schedule([=, this, &renderAreaBuilder, &layerFEs]() REQUIRES(kMainThreadContext) {
-                auto layers = getLayerSnapshotsFn();
-                for (auto& [layer, layerFE] : layers) {
-                    attachReleaseFenceFutureToLayer(layer, layerFE.get(), ui::INVALID_LAYER_STACK);
-                }
-                layerFEs = extractLayerFEs(layers);
-                return getDisplayStateFromRenderAreaBuilder(renderAreaBuilder);
-            })
+    return getDisplayAndLayerSnapshotsFromMainThreadAsync(renderAreaBuilder,
+                                                          std::move(getLayerSnapshotsFn), layerFEs)
             .get();
 }
 
+std::future<std::optional<SurfaceFlinger::OutputCompositionState>>
+SurfaceFlinger::getDisplayAndLayerSnapshotsFromMainThreadAsync(
+        RenderAreaBuilderVariant& renderAreaBuilder, GetLayerSnapshotsFunction getLayerSnapshotsFn,
+        std::vector<sp<LayerFE>>& layerFEs) {
+    return mScheduler->schedule([=, this, &renderAreaBuilder,
+                                 &layerFEs]() REQUIRES(kMainThreadContext) {
+        auto layers = getLayerSnapshotsFn();
+        for (auto& [layer, layerFE] : layers) {
+            attachReleaseFenceFutureToLayer(layer, layerFE.get(), ui::INVALID_LAYER_STACK);
+        }
+        layerFEs = extractLayerFEs(layers);
+        return getDisplayStateFromRenderAreaBuilder(renderAreaBuilder);
+    });
+}
+
+std::shared_ptr<renderengine::ExternalTexture> SurfaceFlinger::createScreenshotBuffer(
+        ui::Size bufferSize, ui::PixelFormat reqPixelFormat, bool isProtected,
+        const sp<IScreenCaptureListener>& captureListener) {
+    const uint32_t usage = GRALLOC_USAGE_HW_COMPOSER | GRALLOC_USAGE_HW_RENDER |
+            GRALLOC_USAGE_HW_TEXTURE |
+            (isProtected ? GRALLOC_USAGE_PROTECTED
+                         : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
+    sp<GraphicBuffer> buffer =
+            getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
+                                             static_cast<android_pixel_format>(reqPixelFormat),
+                                             1 /* layerCount */, usage, "screenshot");
+
+    const status_t bufferStatus = buffer->initCheck();
+    if (bufferStatus != OK) {
+        // Animations may end up being really janky, but don't crash here.
+        // Otherwise an irreponsible process may cause an SF crash by allocating
+        // too much.
+        ALOGE("%s: Buffer failed to allocate: %d", __func__, bufferStatus);
+        invokeScreenCaptureError(bufferStatus, captureListener);
+        return nullptr;
+    }
+    return std::make_shared<
+            renderengine::impl::ExternalTexture>(buffer, getRenderEngine(),
+                                                 renderengine::impl::ExternalTexture::Usage::
+                                                         WRITEABLE);
+}
+
 void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuilder,
                                          GetLayerSnapshotsFunction getLayerSnapshotsFn,
                                          ui::Size bufferSize, ui::PixelFormat reqPixelFormat,
@@ -8813,14 +8924,27 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
 
     if (FlagManager::getInstance().single_hop_screenshot() &&
         FlagManager::getInstance().ce_fence_promise() && mRenderEngine->isThreaded()) {
+        const bool supportsProtected = getRenderEngine().supportsProtectedContent();
         std::vector<sp<LayerFE>> layerFEs;
-        auto displayState =
-                getDisplayAndLayerSnapshotsFromMainThread(renderAreaBuilder, getLayerSnapshotsFn,
-                                                          layerFEs);
+        auto displayStateFuture =
+                getDisplayAndLayerSnapshotsFromMainThreadAsync(renderAreaBuilder,
+                                                               getLayerSnapshotsFn, layerFEs);
+
+        // Unless the capture may turn out to be protected, the buffer usage is already known, so
+        // allocate it while the main thread collects the layer snapshots.
+        std::shared_ptr<renderengine::ExternalTexture> texture;
+        const bool mayBeProtected = allowProtected && supportsProtected;
+        if (!mayBeProtected) {
+            texture = createScreenshotBuffer(bufferSize, reqPixelFormat, false /* isProtected */,
+                                             captureListener);
+        }
+        auto displayState = displayStateFuture.get();
+        if (!mayBeProtected && !texture) {
+            return;
+        }
 
-        const bool supportsProtected = getRenderEngine().supportsProtectedContent();
         bool hasProtectedLayer = false;
-        if (allowProtected && supportsProtected) {
+        if (mayBeProtected) {
             hasProtectedLayer = layersHasProtectedLayer(layerFEs);
         }
 
@@ -8828,29 +8952,14 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
         mQtiSFExtnIntf->qtiHasProtectedLayer(&hasProtectedLayer);
         /* QTI_END */
 
-        const bool isProtected = hasProtectedLayer && allowProtected && supportsProtected;
-        const uint32_t usage = GRALLOC_USAGE_HW_COMPOSER | GRALLOC_USAGE_HW_RENDER |
-                GRALLOC_USAGE_HW_TEXTURE |
-                (isProtected ? GRALLOC_USAGE_PROTECTED
-                             : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
-        sp<GraphicBuffer> buffer =
-                getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
-                                                 static_cast<android_pixel_format>(reqPixelFormat),
-                                                 1 /* layerCount */, usage, "screenshot");
-
-        const status_t bufferStatus = buffer->initCheck();
-        if (bufferStatus != OK) {
-            // Animations may end up being really janky, but don't crash here.
-            // Otherwise an irreponsible process may cause an SF crash by allocating
-            // too much.
-            ALOGE("%s: Buffer failed to allocate: %d", __func__, bufferStatus);
-            invokeScreenCaptureError(bufferStatus, captureListener);
-            return;
+        const bool isProtected = hasProtectedLayer && mayBeProtected;
+        if (!texture) {
+            texture = createScreenshotBuffer(bufferSize, reqPixelFormat, isProtected,
+                                             captureListener);
+            if (!texture) {
+                return;
+            }
         }
-        const std::shared_ptr<renderengine::ExternalTexture> texture = std::make_shared<
-                renderengine::impl::ExternalTexture>(buffer, getRenderEngine(),
-                                                     renderengine::impl::ExternalTexture::Usage::
-                                                             WRITEABLE);
         auto futureFence =
                 captureScreenshot(renderAreaBuilder, texture, false /* regionSampling */, grayscale,
                                   isProtected, captureListener, displayState, layerFEs);
@@ -8864,28 +8973,11 @@ void SurfaceFlinger::captureScreenCommon(RenderAreaBuilderVariant renderAreaBuil
             hasProtectedLayer = layersHasProtectedLayer(extractLayerFEs(layers));
         }
         const bool isProtected = hasProtectedLayer && allowProtected && supportsProtected;
-        const uint32_t usage = GRALLOC_USAGE_HW_COMPOSER | GRALLOC_USAGE_HW_RENDER |
-                GRALLOC_USAGE_HW_TEXTURE |
-                (isProtected ? GRALLOC_USAGE_PROTECTED
-                             : GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
-        sp<GraphicBuffer> buffer =
-                getFactory().createGraphicBuffer(bufferSize.getWidth(), bufferSize.getHeight(),
-                                                 static_cast<android_pixel_format>(reqPixelFormat),
-                                                 1 /* layerCount */, usage, "screenshot");
-
-        const status_t bufferStatus = buffer->initCheck();
-        if (bufferStatus != OK) {
-            // Animations may end up being really janky, but don't crash here.
-            // Otherwise an irreponsible process may cause an SF crash by allocating
-            // too much.
-            ALOGE("%s: Buffer failed to allocate: %d", __func__, bufferStatus);
-            invokeScreenCaptureError(bufferStatus, captureListener);
+        const auto texture =
+                createScreenshotBuffer(bufferSize, reqPixelFormat, isProtected, captureListener);
+        if (!texture) {
             return;
         }
-        const std::shared_ptr<renderengine::ExternalTexture> texture = std::make_shared<
-                renderengine::impl::ExternalTexture>(buffer, getRenderEngine(),
-                                                     renderengine::impl::ExternalTexture::Usage::
-                                                             WRITEABLE);
         auto futureFence = captureScreenshotLegacy(renderAreaBuilder, getLayerSnapshotsFn, texture,
                                                    false /* regionSampling */, grayscale,
                                                    isProtected, captureListener);
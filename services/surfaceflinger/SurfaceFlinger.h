@@ -536,6 +536,14 @@ private:
         return lockedDumper(std::bind(dump, this, _1, _2, _3));
     }
 
+    // For dumps which take what they need from the main thread themselves, and therefore must
+    // not hold mStateLock while waiting for it.
+    template <typename F, std::enable_if_t<std::is_member_function_pointer_v<F>>* = nullptr>
+    Dumper unlockedDumper(F dump) {
+        using namespace std::placeholders;
+        return std::bind(dump, this, _3);
+    }
+
     Dumper mainThreadDumperImpl(Dumper dumper) {
         return [this, dumper](const DumpArgs& args, bool asProto, std::string& result) -> void {
             mScheduler
@@ -927,6 +935,19 @@ private:
             RenderAreaBuilderVariant& renderAreaBuilder,
             GetLayerSnapshotsFunction getLayerSnapshotsFn, std::vector<sp<LayerFE>>& layerFEs);
 
+    // Same as above, but does not wait for the main thread, so that the caller can do other work
+    // in the meantime. renderAreaBuilder and layerFEs must outlive the returned future.
+    std::future<std::optional<OutputCompositionState>>
+    getDisplayAndLayerSnapshotsFromMainThreadAsync(RenderAreaBuilderVariant& renderAreaBuilder,
+                                                   GetLayerSnapshotsFunction getLayerSnapshotsFn,
+                                                   std::vector<sp<LayerFE>>& layerFEs);
+
+    // Allocates the buffer that a screenshot is rendered into. Returns nullptr and reports the
+    // error to the listener if the allocation fails.
+    std::shared_ptr<renderengine::ExternalTexture> createScreenshotBuffer(
+            ui::Size bufferSize, ui::PixelFormat, bool isProtected,
+            const sp<IScreenCaptureListener>&);
+
     void captureScreenCommon(RenderAreaBuilderVariant, GetLayerSnapshotsFunction,
                              ui::Size bufferSize, ui::PixelFormat, bool allowProtected,
                              bool grayscale, const sp<IScreenCaptureListener>&);
@@ -1193,6 +1214,7 @@ private:
     void clearStats(const DumpArgs& args, std::string& result) REQUIRES(kMainThreadContext);
     void dumpTimeStats(const DumpArgs& args, bool asProto, std::string& result) const;
     void dumpFrameTimeline(const DumpArgs& args, std::string& result) const;
+    void dumpFrameStages(const DumpArgs& args, std::string& result) const;
     void logFrameStats(TimePoint now) REQUIRES(kMainThreadContext);
 
     void dumpScheduler(std::string& result) const REQUIRES(mStateLock);
@@ -1205,8 +1227,23 @@ private:
     void dumpRawDisplayIdentificationData(const DumpArgs&, std::string& result) const;
     void dumpWideColorInfo(std::string& result) const REQUIRES(mStateLock);
     void dumpHdrInfo(std::string& result) const REQUIRES(mStateLock);
-    void dumpFrontEnd(std::string& result) REQUIRES(kMainThreadContext);
-    void dumpVisibleFrontEnd(std::string& result) REQUIRES(mStateLock, kMainThreadContext);
+
+    // Frontend state printed by dumpsys. It is copied on the main thread and formatted on the
+    // binder thread, so that a dump holds up composition only for as long as the copies take.
+    struct FrontEndDump {
+        bool hasSnapshots = false;
+        std::vector<frontend::LayerSnapshot> compositionSnapshots;
+        std::vector<frontend::LayerSnapshot> inputSnapshots;
+        std::string hierarchy;
+        // State that lives outside the snapshots (HWC layers, legacy frontend) is formatted
+        // while capturing.
+        std::string preformatted;
+    };
+
+    void dumpFrontEnd(std::string& result) EXCLUDES(mStateLock);
+    void dumpVisibleFrontEnd(std::string& result) EXCLUDES(mStateLock);
+    FrontEndDump captureFrontEnd(bool visibleOnly) REQUIRES(mStateLock, kMainThreadContext);
+    static void formatFrontEnd(const FrontEndDump&, std::string& result);
 
     perfetto::protos::LayersProto dumpDrawingStateProto(uint32_t traceFlags) const
             REQUIRES(kMainThreadContext);
@@ -1311,6 +1348,8 @@ private:
     // don't need synchronization
     State mDrawingState{LayerVector::StateSet::Drawing};
     bool mVisibleRegionsDirty = false;
+    // Logs the time to first frame once.
+    bool mFirstFramePresented = false;
 
     bool mHdrLayerInfoChanged = false;
 
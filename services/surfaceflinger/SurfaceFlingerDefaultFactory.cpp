@@ -28,6 +28,7 @@
 #include <cutils/properties.h>
 #include <ui/GraphicBuffer.h>
 
+#include "BackgroundExecutor.h"
 #include "DisplayDevice.h"
 #include "FrameTracer/FrameTracer.h"
 #include "Layer.h"
@@ -101,9 +102,26 @@ std::unique_ptr<FrameTracer> DefaultFactory::createFrameTracer() {
     return std::make_unique<FrameTracer>();
 }
 
+namespace {
+
+class FrameTimelineExecutor final : public frametimeline::impl::FrameTimeline::Executor {
+public:
+    void post(std::function<void()>&& task) override {
+        BackgroundExecutor::getLowPriorityInstance().sendCallbacks({std::move(task)});
+    }
+
+    void flush() override { BackgroundExecutor::getLowPriorityInstance().flushQueue(); }
+};
+
+} // namespace
+
 std::unique_ptr<frametimeline::FrameTimeline> DefaultFactory::createFrameTimeline(
         std::shared_ptr<TimeStats> timeStats, pid_t surfaceFlingerPid) {
-    return std::make_unique<frametimeline::impl::FrameTimeline>(timeStats, surfaceFlingerPid);
+    using frametimeline::impl::FrameTimeline;
+    return std::make_unique<FrameTimeline>(timeStats, surfaceFlingerPid,
+                                           frametimeline::JankClassificationThresholds{},
+                                           /*useBootTimeClock=*/true,
+                                           std::make_unique<FrameTimelineExecutor>());
 }
 
 } // namespace android::surfaceflinger
@@ -19,6 +19,7 @@
 #define ATRACE_TAG ATRACE_TAG_GRAPHICS
 
 #include <android-base/stringprintf.h>
+#include <ftl/enum.h>
 #include <log/log.h>
 #include <timestatsatomsproto/TimeStatsAtomsProtoHeader.h>
 #include <utils/String8.h>
@@ -39,13 +40,17 @@ namespace impl {
 
 namespace {
 
-FrameTimingHistogram histogramToProto(const std::unordered_map<int32_t, int32_t>& histogram,
+FrameTimingHistogram histogramToProto(const TimeStatsHelper::Histogram& histogram,
                                       size_t maxPulledHistogramBuckets) {
-    auto buckets = std::vector<std::pair<int32_t, int32_t>>(histogram.begin(), histogram.end());
-    std::sort(buckets.begin(), buckets.end(),
-              [](std::pair<int32_t, int32_t>& left, std::pair<int32_t, int32_t>& right) {
-                  return left.second > right.second;
-              });
+    std::vector<std::pair<int32_t, int32_t>> buckets;
+    buckets.reserve(TimeStatsHelper::Histogram::kBucketCount);
+    histogram.forEachBucket(
+            [&buckets](int32_t time, int32_t count) { buckets.emplace_back(time, count); });
+    std::stable_sort(buckets.begin(), buckets.end(),
+                     [](const std::pair<int32_t, int32_t>& left,
+                        const std::pair<int32_t, int32_t>& right) {
+                         return left.second > right.second;
+                     });
 
     FrameTimingHistogram histogramProto;
     int histogramSize = 0;
@@ -59,6 +64,33 @@ FrameTimingHistogram histogramToProto(const std::unordered_map<int32_t, int32_t>
     return histogramProto;
 }
 
+FrameStageTimingHistogram frameStageHistogramToProto(
+        TimeStatsHelper::FrameStage stage, const TimeStatsHelper::StageHistogram& histogram,
+        size_t maxPulledHistogramBuckets) {
+    std::vector<std::pair<int32_t, int32_t>> buckets;
+    buckets.reserve(TimeStatsHelper::StageHistogram::kBucketCount);
+    histogram.forEachBucket(
+            [&buckets](int32_t time, int32_t count) { buckets.emplace_back(time, count); });
+    std::stable_sort(buckets.begin(), buckets.end(),
+                     [](const std::pair<int32_t, int32_t>& left,
+                        const std::pair<int32_t, int32_t>& right) {
+                         return left.second > right.second;
+                     });
+
+    FrameStageTimingHistogram histogramProto;
+    // The proto enum reserves 0 for FRAME_STAGE_UNSPECIFIED.
+    histogramProto.set_stage(
+            static_cast<FrameStageTimingHistogram::FrameStage>(ftl::to_underlying(stage) + 1));
+    if (buckets.size() > maxPulledHistogramBuckets) {
+        buckets.resize(maxPulledHistogramBuckets);
+    }
+    for (const auto& [time, count] : buckets) {
+        histogramProto.add_time_micros_buckets(time);
+        histogramProto.add_frame_counts(static_cast<int64_t>(count));
+    }
+    return histogramProto;
+}
+
 SurfaceflingerStatsLayerInfo_GameMode gameModeToProto(GameMode gameMode) {
     switch (gameMode) {
         case GameMode::Unsupported:
@@ -98,6 +130,13 @@ bool TimeStats::populateGlobalAtom(std::vector<uint8_t>* pulledData) {
         return false;
     }
     flushPowerTimeLocked();
+    TimeStatsHelper::FrameStageStats frameStageStats;
+    {
+        std::lock_guard<std::mutex> frameStageLock(mFrameStageMutex);
+        frameStageStats = mFrameStageStats;
+        mFrameStageStats.clear(static_cast<int64_t>(std::time(0)));
+    }
+
     SurfaceflingerStatsGlobalInfoWrapper atomList;
     for (const auto& globalSlice : mTimeStats.stats) {
         SurfaceflingerStatsGlobalInfo* atom = atomList.add_atom();
@@ -109,9 +148,9 @@ bool TimeStats::populateGlobalAtom(std::vector<uint8_t>* pulledData) {
         // Deprecated
         atom->set_event_connection_count(0);
         *atom->mutable_frame_duration() =
-                histogramToProto(mTimeStats.frameDurationLegacy.hist, mMaxPulledHistogramBuckets);
+                histogramToProto(mTimeStats.frameDurationLegacy, mMaxPulledHistogramBuckets);
         *atom->mutable_render_engine_timing() =
-                histogramToProto(mTimeStats.renderEngineTimingLegacy.hist,
+                histogramToProto(mTimeStats.renderEngineTimingLegacy,
                                  mMaxPulledHistogramBuckets);
         atom->set_total_timeline_frames(globalSlice.second.jankPayload.totalFrames);
         atom->set_total_janky_frames(globalSlice.second.jankPayload.totalJankyFrames);
@@ -129,12 +168,18 @@ bool TimeStats::populateGlobalAtom(std::vector<uint8_t>* pulledData) {
                 globalSlice.second.jankPayload.totalAppBufferStuffing);
         atom->set_display_refresh_rate_bucket(globalSlice.first.displayRefreshRateBucket);
         *atom->mutable_sf_deadline_misses() =
-                histogramToProto(globalSlice.second.displayDeadlineDeltas.hist,
+                histogramToProto(globalSlice.second.displayDeadlineDeltas,
                                  mMaxPulledHistogramBuckets);
         *atom->mutable_sf_prediction_errors() =
-                histogramToProto(globalSlice.second.displayPresentDeltas.hist,
+                histogramToProto(globalSlice.second.displayPresentDeltas,
                                  mMaxPulledHistogramBuckets);
         atom->set_render_rate_bucket(globalSlice.first.renderRateBucket);
+        for (size_t i = 0; i < TimeStatsHelper::kFrameStageCount; ++i) {
+            *atom->add_frame_stage_timing() =
+                    frameStageHistogramToProto(static_cast<TimeStatsHelper::FrameStage>(i),
+                                               frameStageStats.durations[i],
+                                               mMaxPulledHistogramBuckets);
+        }
     }
 
     // Always clear data.
@@ -180,38 +225,38 @@ bool TimeStats::populateLayerAtom(std::vector<uint8_t>* pulledData) {
         const auto& present2PresentHist = layer->deltas.find("present2present");
         if (present2PresentHist != layer->deltas.cend()) {
             *atom->mutable_present_to_present() =
-                    histogramToProto(present2PresentHist->second.hist, mMaxPulledHistogramBuckets);
+                    histogramToProto(present2PresentHist->second, mMaxPulledHistogramBuckets);
         }
         const auto& present2PresentDeltaHist = layer->deltas.find("present2presentDelta");
         if (present2PresentDeltaHist != layer->deltas.cend()) {
             *atom->mutable_present_to_present_delta() =
-                    histogramToProto(present2PresentDeltaHist->second.hist,
+                    histogramToProto(present2PresentDeltaHist->second,
                                      mMaxPulledHistogramBuckets);
         }
         const auto& post2presentHist = layer->deltas.find("post2present");
         if (post2presentHist != layer->deltas.cend()) {
             *atom->mutable_post_to_present() =
-                    histogramToProto(post2presentHist->second.hist, mMaxPulledHistogramBuckets);
+                    histogramToProto(post2presentHist->second, mMaxPulledHistogramBuckets);
         }
         const auto& acquire2presentHist = layer->deltas.find("acquire2present");
         if (acquire2presentHist != layer->deltas.cend()) {
             *atom->mutable_acquire_to_present() =
-                    histogramToProto(acquire2presentHist->second.hist, mMaxPulledHistogramBuckets);
+                    histogramToProto(acquire2presentHist->second, mMaxPulledHistogramBuckets);
         }
         const auto& latch2presentHist = layer->deltas.find("latch2present");
         if (latch2presentHist != layer->deltas.cend()) {
             *atom->mutable_latch_to_present() =
-                    histogramToProto(latch2presentHist->second.hist, mMaxPulledHistogramBuckets);
+                    histogramToProto(latch2presentHist->second, mMaxPulledHistogramBuckets);
         }
         const auto& desired2presentHist = layer->deltas.find("desired2present");
         if (desired2presentHist != layer->deltas.cend()) {
             *atom->mutable_desired_to_present() =
-                    histogramToProto(desired2presentHist->second.hist, mMaxPulledHistogramBuckets);
+                    histogramToProto(desired2presentHist->second, mMaxPulledHistogramBuckets);
         }
         const auto& post2acquireHist = layer->deltas.find("post2acquire");
         if (post2acquireHist != layer->deltas.cend()) {
             *atom->mutable_post_to_acquire() =
-                    histogramToProto(post2acquireHist->second.hist, mMaxPulledHistogramBuckets);
+                    histogramToProto(post2acquireHist->second, mMaxPulledHistogramBuckets);
         }
 
         atom->set_late_acquire_frames(layer->lateAcquireFrames);
@@ -230,7 +275,7 @@ bool TimeStats::populateLayerAtom(std::vector<uint8_t>* pulledData) {
         atom->set_render_rate_bucket(layer->renderRateBucket);
         *atom->mutable_set_frame_rate_vote() = frameRateVoteToProto(layer->setFrameRateVote);
         *atom->mutable_app_deadline_misses() =
-                histogramToProto(layer->deltas["appDeadlineDeltas"].hist,
+                histogramToProto(layer->deltas["appDeadlineDeltas"],
                                  mMaxPulledHistogramBuckets);
         atom->set_game_mode(gameModeToProto(layer->gameMode));
     }
@@ -246,6 +291,8 @@ TimeStats::TimeStats() : TimeStats(std::nullopt, std::nullopt) {}
 
 TimeStats::TimeStats(std::optional<size_t> maxPulledLayers,
                      std::optional<size_t> maxPulledHistogramBuckets) {
+    mFrameStageStats.clear(static_cast<int64_t>(std::time(0)));
+
     if (maxPulledLayers) {
         mMaxPulledLayers = *maxPulledLayers;
     }
@@ -401,6 +448,28 @@ void TimeStats::recordRenderEngineDuration(nsecs_t startTime,
     mGlobalRecord.renderEngineDurations.push_back({startTime, endTime});
 }
 
+void TimeStats::recordFrameStageDuration(FrameStage stage, nsecs_t duration) {
+    const int32_t durationUs = static_cast<int32_t>(std::min<nsecs_t>(ns2us(duration), INT32_MAX));
+
+    std::lock_guard<std::mutex> lock(mFrameStageMutex);
+    mFrameStageStats.durations[ftl::to_underlying(stage)].insert(durationUs);
+}
+
+void TimeStats::parseFrameStageArgs(const Vector<String16>& args, std::string& result) {
+    ATRACE_CALL();
+
+    const bool clear = std::any_of(args.begin(), args.end(),
+                                   [](const String16& arg) { return arg == String16("-clear"); });
+
+    std::lock_guard<std::mutex> lock(mFrameStageMutex);
+    if (clear) {
+        mFrameStageStats.clear(static_cast<int64_t>(std::time(0)));
+        result.append("Frame stage stats cleared\n");
+        return;
+    }
+    result.append(mFrameStageStats.toString());
+}
+
 bool TimeStats::recordReadyLocked(int32_t layerId, TimeRecord* timeRecord) {
     if (!timeRecord->ready) {
         ALOGV("[%d]-[%" PRIu64 "]-presentFence is still not received", layerId,
@@ -1064,9 +1133,9 @@ void TimeStats::clearGlobalLocked() {
     mTimeStats.compositionStrategyPredictionSucceededLegacy = 0;
     mTimeStats.refreshRateSwitchesLegacy = 0;
     mTimeStats.displayOnTimeLegacy = 0;
-    mTimeStats.presentToPresentLegacy.hist.clear();
-    mTimeStats.frameDurationLegacy.hist.clear();
-    mTimeStats.renderEngineTimingLegacy.hist.clear();
+    mTimeStats.presentToPresentLegacy.clear();
+    mTimeStats.frameDurationLegacy.clear();
+    mTimeStats.renderEngineTimingLegacy.clear();
     mTimeStats.refreshRateStatsLegacy.clear();
     mPowerTime.prevTime = systemTime();
     for (auto& globalRecord : mTimeStats.stats) {
@@ -43,6 +43,7 @@ namespace android {
 class TimeStats {
 public:
     using SetFrameRateVote = TimeStatsHelper::SetFrameRateVote;
+    using FrameStage = TimeStatsHelper::FrameStage;
 
     virtual ~TimeStats() = default;
 
@@ -71,6 +72,29 @@ public:
     // Same as above, but passes in a fence representing the end time.
     virtual void recordRenderEngineDuration(nsecs_t startTime,
                                             const std::shared_ptr<FenceTime>& readyFence) = 0;
+    // Records the main-thread time spent in one stage of a frame. Unlike the other records, stage
+    // durations are kept while TimeStats is disabled so that they can always be dumped.
+    virtual void recordFrameStageDuration(FrameStage, nsecs_t duration) = 0;
+    // Dumps the stage duration histograms, or resets them if -clear is passed.
+    virtual void parseFrameStageArgs(const Vector<String16>& args, std::string& result) = 0;
+
+    // Records the time between construction and destruction as the duration of a stage.
+    class ScopedFrameStage {
+    public:
+        ScopedFrameStage(TimeStats* timeStats, FrameStage stage)
+              : mTimeStats(timeStats), mStage(stage), mStartTime(systemTime()) {}
+        ~ScopedFrameStage() {
+            if (mTimeStats) mTimeStats->recordFrameStageDuration(mStage, systemTime() - mStartTime);
+        }
+
+        ScopedFrameStage(const ScopedFrameStage&) = delete;
+        ScopedFrameStage& operator=(const ScopedFrameStage&) = delete;
+
+    private:
+        TimeStats* const mTimeStats;
+        const FrameStage mStage;
+        const nsecs_t mStartTime;
+    };
 
     virtual void setPostTime(int32_t layerId, uint64_t frameNumber, const std::string& layerName,
                              uid_t uid, nsecs_t postTime, GameMode) = 0;
@@ -255,6 +279,8 @@ public:
     void recordRenderEngineDuration(nsecs_t startTime, nsecs_t endTime) override;
     void recordRenderEngineDuration(nsecs_t startTime,
                                     const std::shared_ptr<FenceTime>& readyFence) override;
+    void recordFrameStageDuration(FrameStage, nsecs_t duration) override;
+    void parseFrameStageArgs(const Vector<String16>& args, std::string& result) override;
 
     void setPostTime(int32_t layerId, uint64_t frameNumber, const std::string& layerName, uid_t uid,
                      nsecs_t postTime, GameMode) override;
@@ -314,6 +340,11 @@ private:
     PowerTime mPowerTime;
     GlobalRecord mGlobalRecord;
 
+    // Stage durations are recorded on every frame regardless of mEnabled, so they are guarded
+    // separately to keep the main thread off mMutex.
+    std::mutex mFrameStageMutex;
+    TimeStatsHelper::FrameStageStats mFrameStageStats;
+
     static const size_t MAX_NUM_LAYER_RECORDS = 200;
 
     static const size_t REFRESH_RATE_BUCKET_WIDTH = 30;
@@ -21,8 +21,6 @@
 #include <array>
 #include <cinttypes>
 
-#define HISTOGRAM_SIZE 85
-
 using android::base::StringAppendF;
 using android::base::StringPrintf;
 
@@ -31,28 +29,32 @@ namespace surfaceflinger {
 
 // Time buckets for histogram, the calculated time deltas will be lower bounded
 // to the buckets in this array.
-static const std::array<int32_t, HISTOGRAM_SIZE> histogramConfig =
+static const std::array<int32_t, TimeStatsHelper::Histogram::kBucketCount> histogramConfig =
         {0,   1,   2,   3,   4,   5,   6,   7,   8,   9,   10,  11,  12,  13,  14,  15,  16,
          17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,  28,  29,  30,  31,  32,  33,
          34,  36,  38,  40,  42,  44,  46,  48,  50,  54,  58,  62,  66,  70,  74,  78,  82,
          86,  90,  94,  98,  102, 106, 110, 114, 118, 122, 126, 130, 134, 138, 142, 146, 150,
          200, 250, 300, 350, 400, 450, 500, 550, 600, 650, 700, 750, 800, 850, 900, 950, 1000};
 
+int32_t TimeStatsHelper::Histogram::bucketTime(size_t index) {
+    return histogramConfig[index];
+}
+
 void TimeStatsHelper::Histogram::insert(int32_t delta) {
     if (delta < 0) return;
     // std::lower_bound won't work on out of range values
-    if (delta > histogramConfig[HISTOGRAM_SIZE - 1]) {
-        hist[histogramConfig[HISTOGRAM_SIZE - 1]]++;
+    if (delta > histogramConfig[kBucketCount - 1]) {
+        counts[kBucketCount - 1]++;
         return;
     }
     auto iter = std::lower_bound(histogramConfig.begin(), histogramConfig.end(), delta);
-    hist[*iter]++;
+    counts[iter - histogramConfig.begin()]++;
 }
 
 int64_t TimeStatsHelper::Histogram::totalTime() const {
     int64_t ret = 0;
-    for (const auto& ele : hist) {
-        ret += ele.first * ele.second;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        ret += static_cast<int64_t>(histogramConfig[i]) * counts[i];
     }
     return ret;
 }
@@ -60,24 +62,90 @@ int64_t TimeStatsHelper::Histogram::totalTime() const {
 float TimeStatsHelper::Histogram::averageTime() const {
     int64_t ret = 0;
     int64_t count = 0;
-    for (const auto& ele : hist) {
-        count += ele.second;
-        ret += ele.first * ele.second;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        count += counts[i];
+        ret += static_cast<int64_t>(histogramConfig[i]) * counts[i];
     }
     return static_cast<float>(ret) / count;
 }
 
 std::string TimeStatsHelper::Histogram::toString() const {
     std::string result;
-    for (int32_t i = 0; i < HISTOGRAM_SIZE; ++i) {
-        int32_t bucket = histogramConfig[i];
-        int32_t count = (hist.count(bucket) == 0) ? 0 : hist.at(bucket);
-        StringAppendF(&result, "%dms=%d ", bucket, count);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        StringAppendF(&result, "%dms=%d ", histogramConfig[i], counts[i]);
+    }
+    result.back() = '\n';
+    return result;
+}
+
+// Stage duration buckets in microseconds. Resolution is finest below a millisecond, where most
+// stages land, and coarsens up to a 60Hz frame budget and beyond.
+static const std::array<int32_t, TimeStatsHelper::StageHistogram::kBucketCount> stageHistogramConfig =
+        {0,    10,   20,   30,   40,   50,   75,   100,  125,  150,  200,   250,   300,   400,
+         500,  600,  700,  800,  900,  1000, 1250, 1500, 1750, 2000, 2500,  3000,  3500,  4000,
+         5000, 6000, 7000, 8000, 9000, 10000, 12000, 14000, 16667, 20000, 33333, 50000};
+
+int32_t TimeStatsHelper::StageHistogram::bucketTime(size_t index) {
+    return stageHistogramConfig[index];
+}
+
+void TimeStatsHelper::StageHistogram::insert(int32_t durationUs) {
+    if (durationUs < 0) return;
+    if (durationUs > stageHistogramConfig[kBucketCount - 1]) {
+        counts[kBucketCount - 1]++;
+        return;
+    }
+    auto iter = std::lower_bound(stageHistogramConfig.begin(), stageHistogramConfig.end(),
+                                 durationUs);
+    counts[iter - stageHistogramConfig.begin()]++;
+}
+
+int64_t TimeStatsHelper::StageHistogram::totalCount() const {
+    int64_t count = 0;
+    for (const int32_t bucketCount : counts) {
+        count += bucketCount;
     }
+    return count;
+}
+
+int32_t TimeStatsHelper::StageHistogram::percentile(int32_t percent) const {
+    const int64_t total = totalCount();
+    if (total == 0) return 0;
+
+    const int64_t target = (total * percent + 99) / 100;
+    int64_t count = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        count += counts[i];
+        if (count >= target) return stageHistogramConfig[i];
+    }
+    return stageHistogramConfig[kBucketCount - 1];
+}
+
+std::string TimeStatsHelper::StageHistogram::toString() const {
+    std::string result;
+    forEachBucket([&result](int32_t time, int32_t count) {
+        StringAppendF(&result, "%dus=%d ", time, count);
+    });
+    if (result.empty()) return "\n";
     result.back() = '\n';
     return result;
 }
 
+std::string TimeStatsHelper::FrameStageStats::toString() const {
+    std::string result = "SurfaceFlinger frame stages:\n";
+    StringAppendF(&result, "statsStart = %" PRId64 "\n", statsStart);
+    for (size_t i = 0; i < kFrameStageCount; ++i) {
+        const auto stage = static_cast<FrameStage>(i);
+        const StageHistogram& histogram = durations[i];
+        StringAppendF(&result, "%s: count = %" PRId64 " p50 = %dus p90 = %dus p99 = %dus\n",
+                      ftl::enum_string(stage).c_str(), histogram.totalCount(),
+                      histogram.percentile(50), histogram.percentile(90),
+                      histogram.percentile(99));
+        result.append(histogram.toString());
+    }
+    return result;
+}
+
 std::string TimeStatsHelper::JankPayload::toString() const {
     std::string result;
     StringAppendF(&result, "totalTimelineFrames = %d\n", totalFrames);
@@ -201,11 +269,11 @@ SFTimeStatsLayerProto TimeStatsHelper::TimeStatsLayer::toProto() const {
     for (const auto& ele : deltas) {
         SFTimeStatsDeltaProto* deltaProto = layerProto.add_deltas();
         deltaProto->set_delta_name(ele.first);
-        for (const auto& histEle : ele.second.hist) {
+        ele.second.forEachBucket([deltaProto](int32_t time, int32_t count) {
             SFTimeStatsHistogramBucketProto* histProto = deltaProto->add_histograms();
-            histProto->set_time_millis(histEle.first);
-            histProto->set_frame_count(histEle.second);
-        }
+            histProto->set_time_millis(time);
+            histProto->set_frame_count(count);
+        });
     }
     return layerProto;
 }
@@ -226,21 +294,21 @@ SFTimeStatsGlobalProto TimeStatsHelper::TimeStatsGlobal::toProto(
         configProto->set_fps(ele.first);
         configBucketProto->set_duration_millis(ns2ms(ele.second));
     }
-    for (const auto& histEle : presentToPresentLegacy.hist) {
+    presentToPresentLegacy.forEachBucket([&globalProto](int32_t time, int32_t count) {
         SFTimeStatsHistogramBucketProto* histProto = globalProto.add_present_to_present();
-        histProto->set_time_millis(histEle.first);
-        histProto->set_frame_count(histEle.second);
-    }
-    for (const auto& histEle : frameDurationLegacy.hist) {
+        histProto->set_time_millis(time);
+        histProto->set_frame_count(count);
+    });
+    frameDurationLegacy.forEachBucket([&globalProto](int32_t time, int32_t count) {
         SFTimeStatsHistogramBucketProto* histProto = globalProto.add_frame_duration();
-        histProto->set_time_millis(histEle.first);
-        histProto->set_frame_count(histEle.second);
-    }
-    for (const auto& histEle : renderEngineTimingLegacy.hist) {
+        histProto->set_time_millis(time);
+        histProto->set_frame_count(count);
+    });
+    renderEngineTimingLegacy.forEachBucket([&globalProto](int32_t time, int32_t count) {
         SFTimeStatsHistogramBucketProto* histProto = globalProto.add_render_engine_timing();
-        histProto->set_time_millis(histEle.first);
-        histProto->set_frame_count(histEle.second);
-    }
+        histProto->set_time_millis(time);
+        histProto->set_frame_count(count);
+    });
     const auto dumpStats = generateDumpStats(maxLayers);
     for (const auto& ele : dumpStats) {
         SFTimeStatsLayerProto* layerProto = globalProto.add_stats();
@@ -19,6 +19,7 @@
 #include <timestatsproto/TimeStatsProtoHeader.h>
 #include <utils/Timers.h>
 
+#include <array>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -34,16 +35,85 @@ class TimeStatsHelper {
 public:
     class Histogram {
     public:
-        // Key is the delta time between timestamps
-        // Value is the number of appearances of that delta
-        std::unordered_map<int32_t, int32_t> hist;
+        static constexpr size_t kBucketCount = 85;
+
+        // Number of appearances of a delta, indexed by bucket. The buckets are fixed, so
+        // recording a delta is a binary search and an increment rather than a hash insertion.
+        std::array<int32_t, kBucketCount> counts{};
+
+        // Returns the delta time, in milliseconds, represented by the bucket at |index|.
+        static int32_t bucketTime(size_t index);
+
+        // Invokes f(deltaTime, count) for every non-empty bucket, in ascending delta order.
+        template <typename F>
+        void forEachBucket(F&& f) const {
+            for (size_t i = 0; i < kBucketCount; ++i) {
+                if (counts[i] != 0) f(bucketTime(i), counts[i]);
+            }
+        }
 
         void insert(int32_t delta);
+        void clear() { counts.fill(0); }
         int64_t totalTime() const;
         float averageTime() const;
         std::string toString() const;
     };
 
+    // Stages of SurfaceFlinger's main-thread frame loop whose CPU time is tracked separately, so
+    // that a missed frame budget can be attributed to the stage that overran.
+    enum class FrameStage : uint8_t {
+        TransactionFlush,
+        SnapshotUpdate,
+        LayerHistory,
+        CompositionPrepare,
+        HwcValidate,
+        HwcPresent,
+        RenderEngineWait,
+
+        ftl_last = RenderEngineWait
+    };
+
+    static constexpr size_t kFrameStageCount = static_cast<size_t>(FrameStage::ftl_last) + 1;
+
+    // Histogram of stage durations in microseconds. Most stages finish well within a millisecond,
+    // which the buckets of Histogram cannot resolve.
+    class StageHistogram {
+    public:
+        static constexpr size_t kBucketCount = 40;
+
+        std::array<int32_t, kBucketCount> counts{};
+
+        // Returns the duration, in microseconds, represented by the bucket at |index|.
+        static int32_t bucketTime(size_t index);
+
+        // Invokes f(durationUs, count) for every non-empty bucket, in ascending duration order.
+        template <typename F>
+        void forEachBucket(F&& f) const {
+            for (size_t i = 0; i < kBucketCount; ++i) {
+                if (counts[i] != 0) f(bucketTime(i), counts[i]);
+            }
+        }
+
+        void insert(int32_t durationUs);
+        void clear() { counts.fill(0); }
+        int64_t totalCount() const;
+        // Returns the bucket time at or below which |percent| of the samples fall.
+        int32_t percentile(int32_t percent) const;
+        std::string toString() const;
+    };
+
+    struct FrameStageStats {
+        int64_t statsStart = 0;
+        std::array<StageHistogram, kFrameStageCount> durations;
+
+        void clear(int64_t start) {
+            statsStart = start;
+            for (auto& histogram : durations) histogram.clear();
+        }
+
+        std::string toString() const;
+    };
+
     struct JankPayload {
         // note that transactions are counted for these frames.
         int32_t totalFrames = 0;
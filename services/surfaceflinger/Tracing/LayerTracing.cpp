@@ -20,6 +20,7 @@
 
 #include "LayerTracing.h"
 
+#include "BackgroundExecutor.h"
 #include "LayerDataSource.h"
 #include "Tracing/tools/LayerTraceGenerator.h"
 #include "TransactionTracing.h"
@@ -29,6 +30,8 @@
 #include <utils/Timers.h>
 #include <utils/Trace.h>
 
+#include <memory>
+
 namespace android {
 
 LayerTracing::LayerTracing() {
@@ -41,6 +44,8 @@ LayerTracing::LayerTracing(std::ostream& outStream) : LayerTracing() {
 }
 
 LayerTracing::~LayerTracing() {
+    // Active snapshots may still be queued for serialization and reference this instance.
+    BackgroundExecutor::getLowPriorityInstance().flushQueue();
     LayerDataSource::UnregisterLayerTracing();
 }
 
@@ -137,6 +142,20 @@ void LayerTracing::addProtoSnapshotToOstream(perfetto::protos::LayersSnapshotPro
     ATRACE_CALL();
     if (mOutStream) {
         writeSnapshotToStream(std::move(snapshot));
+    } else if (mode == Mode::MODE_ACTIVE) {
+        // Active snapshots are taken on the main thread every time the layers change. Serializing
+        // a large hierarchy takes milliseconds, so hand it to a background thread instead of
+        // delaying the frame. The executor runs tasks in order, so the trace stays sequential.
+        // The queue is not drained from the perfetto callbacks, which run under the data source
+        // lock that the writing thread may need; a snapshot still queued when a session stops is
+        // dropped.
+        auto sharedSnapshot =
+                std::make_shared<perfetto::protos::LayersSnapshotProto>(std::move(snapshot));
+        BackgroundExecutor::getLowPriorityInstance().sendCallbacks(
+                {[this, sharedSnapshot = std::move(sharedSnapshot)]() {
+                    ATRACE_NAME("LayerTracing::writeActiveSnapshot");
+                    writeSnapshotToPerfetto(*sharedSnapshot, Mode::MODE_ACTIVE);
+                }});
     } else {
         writeSnapshotToPerfetto(snapshot, mode);
     }
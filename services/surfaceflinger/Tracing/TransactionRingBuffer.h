@@ -56,6 +56,14 @@ public:
         }
     }
 
+    // Invokes f on each serialized entry, oldest first.
+    template <typename F>
+    void forEachEntry(F&& f) const {
+        for (const std::string& entry : mStorage) {
+            f(entry);
+        }
+    }
+
     status_t appendToStream(FileProto& fileProto, std::ofstream& out) {
         ATRACE_CALL();
         writeToProto(fileProto);
@@ -77,11 +85,11 @@ public:
                 return {};
             }
             mUsedInBytes -= static_cast<size_t>(mStorage.front().size());
-            replacedEntries.emplace_back(mStorage.front());
+            replacedEntries.emplace_back(std::move(mStorage.front()));
             mStorage.pop_front();
         }
         mUsedInBytes += protoSize;
-        mStorage.emplace_back(serializedProto);
+        mStorage.emplace_back(std::move(serializedProto));
         return replacedEntries;
     }
 
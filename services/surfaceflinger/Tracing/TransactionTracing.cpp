@@ -87,18 +87,20 @@ void TransactionTracing::onFlush(TransactionTracing::Mode mode) {
 void TransactionTracing::writeRingBufferToPerfetto(TransactionTracing::Mode mode) {
     // Write the ring buffer (starting state + following sequence of transactions) to perfetto
     // tracing sessions with the specified mode.
-    const auto fileProto = writeToProto();
+    // The ring buffer already holds serialized entries, so they are appended as is rather than
+    // parsed back into messages and serialized again. Only the timestamp is decoded.
+    const auto entries = getSerializedEntries();
 
     TransactionDataSource::Trace([&](TransactionDataSource::TraceContext context) {
         // Write packets only to tracing sessions with specified mode
         if (context.GetCustomTlsState()->mMode != mode) {
             return;
         }
-        for (const auto& entryProto : fileProto.entry()) {
-            const auto entryBytes = entryProto.SerializeAsString();
+        for (const std::string& entryBytes : entries) {
+            const perfetto::protos::pbzero::TransactionTraceEntry::Decoder entry(entryBytes);
 
             auto packet = context.NewTracePacket();
-            packet->set_timestamp(static_cast<uint64_t>(entryProto.elapsed_realtime_nanos()));
+            packet->set_timestamp(static_cast<uint64_t>(entry.elapsed_realtime_nanos()));
             packet->set_timestamp_clock_id(perfetto::protos::pbzero::BUILTIN_CLOCK_MONOTONIC);
 
             auto* transactionsProto = packet->set_surfaceflinger_transactions();
@@ -142,6 +144,17 @@ perfetto::protos::TransactionTraceFile TransactionTracing::writeToProto() {
     return fileProto;
 }
 
+std::vector<std::string> TransactionTracing::getSerializedEntries() {
+    std::scoped_lock<std::mutex> lock(mTraceLock);
+    std::vector<std::string> entries;
+    entries.reserve(mBuffer.frameCount() + 1);
+    if (const auto startingStateProto = createStartingStateProtoLocked()) {
+        entries.emplace_back(startingStateProto->SerializeAsString());
+    }
+    mBuffer.forEachEntry([&entries](const std::string& entry) { entries.emplace_back(entry); });
+    return entries;
+}
+
 void TransactionTracing::setBufferSize(size_t bufferSizeInBytes) {
     std::scoped_lock lock(mTraceLock);
     mBuffer.setSize(bufferSizeInBytes);
@@ -233,8 +246,8 @@ void TransactionTracing::addEntry(const std::vector<CommittedUpdates>& committed
     perfetto::protos::TransactionTraceEntry entryProto;
 
     while (auto incomingTransaction = mTransactionQueue.pop()) {
-        auto transaction = *incomingTransaction;
-        mQueuedTransactions[incomingTransaction->transaction_id()] = transaction;
+        mQueuedTransactions[incomingTransaction->transaction_id()] =
+                std::move(*incomingTransaction);
         delete incomingTransaction;
     }
     for (const CommittedUpdates& update : committedUpdates) {
@@ -203,6 +203,8 @@ private:
     int64_t mLastUpdatedVsyncId = -1;
 
     void writeRingBufferToPerfetto(TransactionTracing::Mode mode);
+    // Returns the starting state followed by the ring buffer entries, already serialized.
+    std::vector<std::string> getSerializedEntries() EXCLUDES(mTraceLock);
     perfetto::protos::TransactionTraceFile createTraceFileProto() const;
     void loop();
     void addEntry(const std::vector<CommittedUpdates>& committedTransactions,
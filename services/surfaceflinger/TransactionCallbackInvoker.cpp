@@ -161,10 +161,46 @@ void TransactionCallbackInvoker::addPresentFence(sp<Fence> presentFence) {
     mPresentFence = std::move(presentFence);
 }
 
+void TransactionCallbackInvoker::addReleaseBuffer(const sp<ITransactionCompletedListener>& listener,
+                                                  ReleaseBufferStats release) {
+    if (!mBatchReleases) {
+        listener->onReleaseBuffer(release.callbackId, release.releaseFence,
+                                  release.currentMaxAcquiredBufferCount);
+        return;
+    }
+    mPendingReleases[IInterface::asBinder(listener)].push_back(std::move(release));
+}
+
+void TransactionCallbackInvoker::sendReleaseBuffers(BackgroundExecutor::Callbacks& callbacks) {
+    mBatchReleases = false;
+    for (auto& [listener, releases] : mPendingReleases) {
+        if (!listener->isBinderAlive()) {
+            continue;
+        }
+        if (releases.size() == 1) {
+            callbacks.emplace_back([binder = listener, release = std::move(releases.front())]() {
+                interface_cast<ITransactionCompletedListener>(binder)
+                        ->onReleaseBuffer(release.callbackId, release.releaseFence,
+                                          release.currentMaxAcquiredBufferCount);
+            });
+        } else {
+            callbacks.emplace_back([binder = listener, releases = std::move(releases)]() {
+                interface_cast<ITransactionCompletedListener>(binder)->onReleaseBuffers(
+                        releases);
+            });
+        }
+    }
+    mPendingReleases.clear();
+}
+
 void TransactionCallbackInvoker::sendCallbacks(bool onCommitOnly) {
+    BackgroundExecutor::Callbacks callbacks;
+    // Releases go out first so that clients see them no later than the matching transaction
+    // callbacks, as they did when they were sent synchronously.
+    sendReleaseBuffers(callbacks);
+
     // For each listener
     auto completedTransactionsItr = mCompletedTransactions.begin();
-    BackgroundExecutor::Callbacks callbacks;
     while (completedTransactionsItr != mCompletedTransactions.end()) {
         auto& [listener, transactionStatsDeque] = *completedTransactionsItr;
         ListenerStats listenerStats;
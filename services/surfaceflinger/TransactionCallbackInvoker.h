@@ -32,6 +32,8 @@
 #include <ui/Fence.h>
 #include <ui/FenceResult.h>
 
+#include "BackgroundExecutor.h"
+
 namespace android {
 
 class CallbackHandle : public RefBase {
@@ -80,6 +82,12 @@ public:
     status_t addCallbackHandle(const sp<CallbackHandle>& handle,
                                const std::vector<JankData>& jankData);
 
+    // Between beginReleaseBatch() and the next sendCallbacks(), buffer releases are held and
+    // sent as a single onReleaseBuffers call per listener. Outside a batch they are sent
+    // immediately.
+    void beginReleaseBatch() { mBatchReleases = true; }
+    void addReleaseBuffer(const sp<ITransactionCompletedListener>& listener,
+                          ReleaseBufferStats release);
 
 private:
     status_t findOrCreateTransactionStats(const sp<IBinder>& listener,
@@ -89,7 +97,13 @@ private:
     std::unordered_map<sp<IBinder>, std::deque<TransactionStats>, IListenerHash>
         mCompletedTransactions;
 
+    void sendReleaseBuffers(BackgroundExecutor::Callbacks& callbacks);
+
     sp<Fence> mPresentFence;
+
+    bool mBatchReleases = false;
+    std::unordered_map<sp<IBinder>, std::vector<ReleaseBufferStats>, IListenerHash>
+            mPendingReleases;
 };
 
 } // namespace android
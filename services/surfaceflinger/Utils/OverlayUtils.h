@@ -51,8 +51,8 @@ public:
     ~SurfaceControlHolder() {
         // Hand the sp<SurfaceControl> to the helper thread to release the last
         // reference. This makes sure that the SurfaceControl is destructed without
-        // SurfaceFlinger::mStateLock held.
-        BackgroundExecutor::getInstance().sendCallbacks(
+        // SurfaceFlinger::mStateLock held. Nobody waits on it, so it goes to the bulk lane.
+        BackgroundExecutor::getLowPriorityInstance().sendCallbacks(
                 {[sc = std::move(mSurfaceControl)]() mutable { sc.clear(); }});
     }
 
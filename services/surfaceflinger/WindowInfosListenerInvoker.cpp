@@ -71,6 +71,7 @@ void WindowInfosListenerInvoker::eraseListenerAndAckMessages(const wp<IBinder>&
     auto it = mWindowInfosListeners.find(binder);
     int64_t listenerId = it->second.first;
     mWindowInfosListeners.erase(binder);
+    mDeltaListenerIds.erase(listenerId);
 
     std::vector<int64_t> vsyncIds;
     for (auto& [vsyncId, state] : mUnackedState) {
@@ -133,14 +134,26 @@ void WindowInfosListenerInvoker::windowInfosChanged(
     mDelayInfo.reset();
     updateMaxSendDelay();
 
+    // Listeners that hold the previous update only get the windows that changed since then.
+    update.version = mNextVersion++;
+    std::optional<gui::WindowInfosUpdate> delta;
+    if (mLastSentUpdate && !mDeltaListenerIds.empty()) {
+        delta = gui::WindowInfosUpdate::makeDelta(*mLastSentUpdate, update);
+    }
+
     // Call the listeners
     for (auto& pair : mWindowInfosListeners) {
         auto& [listenerId, listener] = pair.second;
-        auto status = listener->onWindowInfosChanged(update);
+        const bool sendDelta = delta && mDeltaListenerIds.contains(listenerId);
+        auto status = listener->onWindowInfosChanged(sendDelta ? *delta : update);
         if (!status.isOk()) {
+            // The listener may have missed this update, so don't use it as its delta base.
+            mDeltaListenerIds.erase(listenerId);
             ackWindowInfosReceived(update.vsyncId, listenerId);
         }
     }
+
+    mLastSentUpdate = std::move(update);
 }
 
 WindowInfosListenerInvoker::DebugInfo WindowInfosListenerInvoker::getDebugInfo() {
@@ -176,9 +189,13 @@ binder::Status WindowInfosListenerInvoker::ackWindowInfosReceived(int64_t vsyncI
         }
 
         auto& state = it->second;
-        state.unackedListenerIds.unstable_erase(std::find(state.unackedListenerIds.begin(),
-                                                          state.unackedListenerIds.end(),
-                                                          listenerId));
+        auto listenerIt = std::find(state.unackedListenerIds.begin(),
+                                    state.unackedListenerIds.end(), listenerId);
+        // Updates resent by requestWindowInfosDeltas are acked without being tracked.
+        if (listenerIt == state.unackedListenerIds.end()) {
+            return;
+        }
+        state.unackedListenerIds.unstable_erase(listenerIt);
         if (!state.unackedListenerIds.empty()) {
             return;
         }
@@ -203,4 +220,29 @@ binder::Status WindowInfosListenerInvoker::ackWindowInfosReceived(int64_t vsyncI
     return binder::Status::ok();
 }
 
+binder::Status WindowInfosListenerInvoker::requestWindowInfosDeltas(int64_t listenerId) {
+    BackgroundExecutor::getInstance().sendCallbacks({[this, listenerId]() {
+        ATRACE_NAME("WindowInfosListenerInvoker::requestWindowInfosDeltas");
+        auto it = std::find_if(mWindowInfosListeners.begin(), mWindowInfosListeners.end(),
+                               [listenerId](const auto& pair) {
+                                   return pair.second.first == listenerId;
+                               });
+        if (it == mWindowInfosListeners.end()) {
+            return;
+        }
+
+        // Give the listener a complete base. Without a previous update, the next update is
+        // complete anyway.
+        if (mLastSentUpdate) {
+            const sp<IWindowInfosListener>& listener = it->second.second;
+            if (!listener->onWindowInfosChanged(*mLastSentUpdate).isOk()) {
+                mDeltaListenerIds.erase(listenerId);
+                return;
+            }
+        }
+        mDeltaListenerIds.insert(listenerId);
+    }});
+    return binder::Status::ok();
+}
+
 } // namespace android
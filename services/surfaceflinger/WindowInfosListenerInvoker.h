@@ -47,6 +47,7 @@ public:
                             bool forceImmediateCall);
 
     binder::Status ackWindowInfosReceived(int64_t, int64_t) override;
+    binder::Status requestWindowInfosDeltas(int64_t listenerId) override;
 
     struct DebugInfo {
         VsyncId maxSendDelayVsyncId;
@@ -75,6 +76,12 @@ private:
     };
     ftl::SmallMap<int64_t /* vsyncId */, UnackedState, 5> mUnackedState;
 
+    // The latest update sent to listeners, which is the base of the next delta, and the
+    // listeners that opted into deltas and are known to have received it.
+    uint64_t mNextVersion = 1;
+    std::optional<gui::WindowInfosUpdate> mLastSentUpdate;
+    std::unordered_set<int64_t> mDeltaListenerIds;
+
     DebugInfo mDebugInfo;
     struct DelayInfo {
         int64_t vsyncId;
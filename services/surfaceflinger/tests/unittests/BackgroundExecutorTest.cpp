@@ -52,6 +52,50 @@ TEST_F(BackgroundExecutorTest, multipleProducers) {
     ASSERT_EQ(backgroundTaskCount, backgroundTaskCompleteCount);
 }
 
+TEST_F(BackgroundExecutorTest, lowPriorityLaneDoesNotBlockHighPriorityLane) {
+    std::mutex mutex;
+    std::condition_variable condition_variable;
+    bool releaseLowPriorityTask = false;
+    bool highPriorityTaskComplete = false;
+
+    BackgroundExecutor::getLowPriorityInstance().sendCallbacks(
+            {[&mutex, &condition_variable, &releaseLowPriorityTask]() {
+                std::unique_lock<std::mutex> lock{mutex};
+                condition_variable.wait(lock, [&releaseLowPriorityTask]() {
+                    return releaseLowPriorityTask;
+                });
+            }});
+    BackgroundExecutor::getInstance().sendCallbacks(
+            {[&mutex, &condition_variable, &highPriorityTaskComplete]() {
+                std::lock_guard<std::mutex> lock{mutex};
+                highPriorityTaskComplete = true;
+                condition_variable.notify_all();
+            }});
+
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        condition_variable.wait(lock,
+                                [&highPriorityTaskComplete]() { return highPriorityTaskComplete; });
+        releaseLowPriorityTask = true;
+        condition_variable.notify_all();
+    }
+    BackgroundExecutor::getLowPriorityInstance().flushQueue();
+}
+
+TEST_F(BackgroundExecutorTest, statsTrackQueueDepth) {
+    BackgroundExecutor& executor = BackgroundExecutor::getLowPriorityInstance();
+    executor.flushQueue();
+    const BackgroundExecutor::Stats before = executor.getStats();
+
+    executor.sendCallbacks({[]() {}, []() {}, []() {}});
+    executor.flushQueue();
+
+    const BackgroundExecutor::Stats after = executor.getStats();
+    EXPECT_EQ(0u, after.pendingTasks);
+    EXPECT_GE(after.maxPendingTasks, 3u);
+    EXPECT_GE(after.executedTasks, before.executedTasks + 3);
+}
+
 } // namespace
 
 } // namespace android
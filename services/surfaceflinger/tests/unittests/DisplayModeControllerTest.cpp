@@ -230,5 +230,36 @@ TEST_F(DisplayModeControllerTest, initiateDisplayModeSwitch) FTL_FAKE_GUARD(kMai
     EXPECT_FALSE(mDmc.getDesiredMode(mDisplayId));
 }
 
+TEST_F(DisplayModeControllerTest, dumpModeSwitchStats) FTL_FAKE_GUARD(kMainThreadContext) {
+    EXPECT_CALL(mActiveModeListener, Call(mDisplayId, 60_Hz, 60_Hz)).Times(1);
+    EXPECT_CALL(mActiveModeListener, Call(mDisplayId, 90_Hz, 90_Hz)).Times(1);
+
+    EXPECT_EQ(Action::InitiateDisplayModeSwitch,
+              mDmc.setDesiredMode(mDisplayId, DisplayModeRequest(kDesiredMode90)));
+    auto modeRequest = kDesiredMode90;
+
+    hal::VsyncPeriodChangeTimeline timeline;
+    const auto constraints = expectModeSet(modeRequest, timeline);
+
+    EXPECT_TRUE(mDmc.initiateModeChange(mDisplayId, std::move(modeRequest), constraints, timeline));
+    EXPECT_TRUE(mDmc.isModeSetPending(mDisplayId));
+
+    std::string initiated;
+    utils::Dumper initiatedDumper{initiated};
+    mDmc.dump(mDisplayId, initiatedDumper);
+    EXPECT_NE(std::string::npos, initiated.find("initiated=1\n"));
+    EXPECT_NE(std::string::npos, initiated.find("finalized=0\n"));
+
+    mDmc.finalizeModeChange(mDisplayId, kModeId90, 90_Hz, 90_Hz);
+    EXPECT_FALSE(mDmc.isModeSetPending(mDisplayId));
+
+    std::string finalized;
+    utils::Dumper finalizedDumper{finalized};
+    mDmc.dump(mDisplayId, finalizedDumper);
+    EXPECT_NE(std::string::npos, finalized.find("initiated=1\n"));
+    EXPECT_NE(std::string::npos, finalized.find("failed=0\n"));
+    EXPECT_NE(std::string::npos, finalized.find("finalized=1\n"));
+}
+
 } // namespace
 } // namespace android::display
@@ -24,6 +24,7 @@
 #include <gtest/gtest.h>
 #include <gui/LayerMetadata.h>
 
+#include "BackgroundExecutor.h"
 #include "Client.h" // temporarily needed for LayerCreationArgs
 #include "FpsReporter.h"
 #include "FrontEnd/LayerCreationArgs.h"
@@ -87,6 +88,12 @@ protected:
 
     void createLayer(uint32_t id, uint32_t parentId, LayerMetadata metadata);
 
+    // Dispatches, then waits for the fps to be reported on the BackgroundExecutor.
+    void dispatchLayerFps(const frontend::LayerHierarchyBuilder& hierarchyBuilder) {
+        mFpsReporter->dispatchLayerFps(hierarchyBuilder.getHierarchy());
+        BackgroundExecutor::getLowPriorityInstance().flushQueue();
+    }
+
     frontend::LayerLifecycleManager mLifecycleManager;
 
     mock::FrameTimeline mFrameTimeline =
@@ -169,13 +176,13 @@ TEST_F(FpsReporterTest, callsListeners) {
 
     mFpsReporter->addListener(mFpsListener, kTaskId);
     mClock->advanceTime(600ms);
-    mFpsReporter->dispatchLayerFps(hierarchyBuilder.getHierarchy());
+    dispatchLayerFps(hierarchyBuilder);
     EXPECT_EQ(expectedFps, mFpsListener->lastReportedFps);
     mFpsReporter->removeListener(mFpsListener);
     Mock::VerifyAndClearExpectations(&mFrameTimeline);
 
     EXPECT_CALL(mFrameTimeline, computeFps(_)).Times(0);
-    mFpsReporter->dispatchLayerFps(hierarchyBuilder.getHierarchy());
+    dispatchLayerFps(hierarchyBuilder);
 }
 
 TEST_F(FpsReporterTest, rateLimits) {
@@ -197,16 +204,16 @@ TEST_F(FpsReporterTest, rateLimits) {
 
     mFpsReporter->addListener(mFpsListener, kTaskId);
     mClock->advanceTime(600ms);
-    mFpsReporter->dispatchLayerFps(hierarchyBuilder.getHierarchy());
+    dispatchLayerFps(hierarchyBuilder);
     EXPECT_EQ(firstFps, mFpsListener->lastReportedFps);
     mClock->advanceTime(200ms);
-    mFpsReporter->dispatchLayerFps(hierarchyBuilder.getHierarchy());
+    dispatchLayerFps(hierarchyBuilder);
     EXPECT_EQ(firstFps, mFpsListener->lastReportedFps);
     mClock->advanceTime(200ms);
-    mFpsReporter->dispatchLayerFps(hierarchyBuilder.getHierarchy());
+    dispatchLayerFps(hierarchyBuilder);
     EXPECT_EQ(firstFps, mFpsListener->lastReportedFps);
     mClock->advanceTime(200ms);
-    mFpsReporter->dispatchLayerFps(hierarchyBuilder.getHierarchy());
+    dispatchLayerFps(hierarchyBuilder);
     EXPECT_EQ(secondFps, mFpsListener->lastReportedFps);
 }
 
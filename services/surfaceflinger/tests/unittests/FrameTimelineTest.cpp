@@ -139,7 +139,7 @@ public:
         for (size_t i = 0; i < maxTokens; i++) {
             mTokenManager->generateTokenForPredictions({});
         }
-        EXPECT_EQ(getPredictions().size(), maxTokens);
+        EXPECT_EQ(getNumberOfPredictions(), maxTokens);
     }
 
     SurfaceFrame& getSurfaceFrame(size_t displayFrameIdx, size_t surfaceFrameIdx) {
@@ -158,8 +158,12 @@ public:
                 a.presentTime == b.presentTime;
     }
 
-    const std::map<int64_t, TimelineItem>& getPredictions() const {
-        return mTokenManager->mPredictions;
+    size_t getNumberOfPredictions() const {
+        const auto& predictions = mTokenManager->mPredictions;
+        return static_cast<size_t>(
+                std::count_if(predictions.begin(), predictions.end(), [](const auto& slot) {
+                    return slot.token != FrameTimelineInfo::INVALID_VSYNC_ID;
+                }));
     }
 
     uint32_t getNumberOfDisplayFrames() const {
@@ -193,7 +197,7 @@ public:
 
 TEST_F(FrameTimelineTest, tokenManagerRemovesStalePredictions) {
     int64_t token1 = mTokenManager->generateTokenForPredictions({0, 0, 0});
-    EXPECT_EQ(getPredictions().size(), 1u);
+    EXPECT_EQ(getNumberOfPredictions(), 1u);
     flushTokens();
     int64_t token2 = mTokenManager->generateTokenForPredictions({10, 20, 30});
     std::optional<TimelineItem> predictions = mTokenManager->getPredictionsForToken(token1);
@@ -577,6 +581,60 @@ TEST_F(FrameTimelineTest, presentFenceSignaled_doesNotReportForInvalidTokens) {
     mFrameTimeline->setSfPresent(59, presentFence1);
 }
 
+TEST_F(FrameTimelineTest, presentFenceSignaled_classifiesOnExecutor) {
+    class ManualExecutor : public impl::FrameTimeline::Executor {
+    public:
+        void post(std::function<void()>&& task) override { tasks.push_back(std::move(task)); }
+        void flush() override { runAll(); }
+
+        void runAll() {
+            auto pending = std::move(tasks);
+            tasks.clear();
+            for (auto& task : pending) {
+                task();
+            }
+        }
+
+        std::vector<std::function<void()>> tasks;
+    };
+
+    auto executor = std::make_unique<ManualExecutor>();
+    ManualExecutor& manualExecutor = *executor;
+    mFrameTimeline = std::make_unique<impl::FrameTimeline>(mTimeStats, kSurfaceFlingerPid,
+                                                           kTestThresholds,
+                                                           /*useBootTimeClock=*/false,
+                                                           std::move(executor));
+    mTokenManager = &mFrameTimeline->mTokenManager;
+
+    EXPECT_CALL(*mTimeStats, incrementJankyFrames(_)).Times(1);
+    auto presentFence1 = fenceFactory.createFenceTimeForTest(Fence::NO_FENCE);
+    int64_t surfaceFrameToken1 = mTokenManager->generateTokenForPredictions({10, 20, 30});
+    int64_t sfToken1 = mTokenManager->generateTokenForPredictions({22, 26, 30});
+    FrameTimelineInfo ftInfo;
+    ftInfo.vsyncId = surfaceFrameToken1;
+    ftInfo.inputEventId = sInputEventId;
+    auto surfaceFrame1 =
+            mFrameTimeline->createSurfaceFrameForToken(ftInfo, sPidOne, sUidOne, sLayerIdOne,
+                                                       sLayerNameOne, sLayerNameOne,
+                                                       /*isBuffer*/ true, sGameMode);
+    mFrameTimeline->setSfWakeUp(sfToken1, 22, RR_11, RR_11);
+    surfaceFrame1->setPresentState(SurfaceFrame::PresentState::Presented);
+    mFrameTimeline->addSurfaceFrame(surfaceFrame1);
+    mFrameTimeline->setSfPresent(26, presentFence1);
+    auto displayFrame = getDisplayFrame(0);
+    presentFence1->signalForTest(42);
+
+    // The flush is only posted to the executor.
+    addEmptyDisplayFrame();
+    EXPECT_EQ(displayFrame->getActuals().presentTime, 0);
+    EXPECT_EQ(surfaceFrame1->getJankType(), std::nullopt);
+
+    manualExecutor.runAll();
+    EXPECT_EQ(displayFrame->getActuals().presentTime, 42);
+    EXPECT_EQ(surfaceFrame1->getActuals().presentTime, 42);
+    EXPECT_NE(surfaceFrame1->getJankType(), std::nullopt);
+}
+
 TEST_F(FrameTimelineTest, presentFenceSignaled_reportsLongSfCpu) {
     Fps refreshRate = RR_11;
     EXPECT_CALL(*mTimeStats,
@@ -96,6 +96,68 @@ TEST_F(LayerLifecycleManagerTest, addLayers) {
     listener->expectLayersDestroyed({1, 2, 3});
 }
 
+TEST_F(LayerLifecycleManagerTest, listenersAreNotifiedOncePerCommit) {
+    class BatchListener : public ExpectLayerLifecycleListener {
+    public:
+        void onLayersAdded(const std::vector<RequestedLayerState*>& layers) override {
+            mAddedBatches++;
+            ExpectLayerLifecycleListener::onLayersAdded(layers);
+        }
+        void onLayersDestroyed(
+                const std::vector<std::unique_ptr<RequestedLayerState>>& layers) override {
+            mDestroyedBatches++;
+            ExpectLayerLifecycleListener::onLayersDestroyed(layers);
+        }
+        int mAddedBatches = 0;
+        int mDestroyedBatches = 0;
+    };
+
+    LayerLifecycleManager lifecycleManager;
+    auto listener = std::make_shared<BatchListener>();
+    lifecycleManager.addLifecycleListener(listener);
+    std::vector<std::unique_ptr<RequestedLayerState>> layers;
+    layers.emplace_back(rootLayer(1));
+    layers.emplace_back(childLayer(2, /*parent=*/1));
+    layers.emplace_back(rootLayer(3));
+    lifecycleManager.addLayers(std::move(layers));
+    lifecycleManager.commitChanges();
+    EXPECT_EQ(listener->mAddedBatches, 1);
+    EXPECT_EQ(listener->mDestroyedBatches, 0);
+    listener->expectLayersAdded({1, 2, 3});
+
+    lifecycleManager.onHandlesDestroyed({{1, "1"}, {2, "2"}, {3, "3"}});
+    lifecycleManager.commitChanges();
+    EXPECT_EQ(listener->mAddedBatches, 1);
+    EXPECT_EQ(listener->mDestroyedBatches, 1);
+    listener->expectLayersDestroyed({1, 2, 3});
+    EXPECT_TRUE(lifecycleManager.getLayers().empty());
+}
+
+TEST_F(LayerLifecycleManagerTest, hasNewHierarchyLinks) {
+    LayerLifecycleManager lifecycleManager;
+    std::vector<std::unique_ptr<RequestedLayerState>> layers;
+    layers.emplace_back(rootLayer(1));
+    layers.emplace_back(rootLayer(2));
+    layers.emplace_back(childLayer(3, /*parent=*/1));
+    lifecycleManager.addLayers(std::move(layers));
+    EXPECT_TRUE(lifecycleManager.hasNewHierarchyLinks());
+    lifecycleManager.commitChanges();
+    EXPECT_FALSE(lifecycleManager.hasNewHierarchyLinks());
+
+    // Destroying layers only removes links.
+    lifecycleManager.onHandlesDestroyed({{3, "3"}});
+    EXPECT_TRUE(lifecycleManager.getGlobalChanges().test(RequestedLayerState::Changes::Hierarchy));
+    EXPECT_FALSE(lifecycleManager.hasNewHierarchyLinks());
+    lifecycleManager.commitChanges();
+
+    lifecycleManager.applyTransactions(relativeLayerTransaction(2, 1));
+    EXPECT_TRUE(lifecycleManager.hasNewHierarchyLinks());
+    lifecycleManager.commitChanges();
+
+    lifecycleManager.applyTransactions(setZTransaction(1, 5));
+    EXPECT_FALSE(lifecycleManager.hasNewHierarchyLinks());
+}
+
 TEST_F(LayerLifecycleManagerTest, updateLayerStates) {
     LayerLifecycleManager lifecycleManager;
     std::vector<std::unique_ptr<RequestedLayerState>> layers;
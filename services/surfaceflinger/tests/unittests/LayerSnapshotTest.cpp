@@ -249,6 +249,43 @@ TEST_F(LayerSnapshotTest, AlphaInheritedByChildren) {
     EXPECT_EQ(getSnapshot(1221)->alpha, 0.25f);
 }
 
+TEST_F(LayerSnapshotTest, CleanSubtreesAreNotUpdated) {
+    setCrop(122, Rect(1, 2, 3, 4));
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_TRUE(getSnapshot(122)->changes.test(RequestedLayerState::Changes::Geometry));
+    EXPECT_TRUE(getSnapshot(1221)->changes.test(RequestedLayerState::Changes::Geometry));
+    EXPECT_EQ(getSnapshot(11)->changes.get(), 0u);
+    EXPECT_EQ(getSnapshot(111)->changes.get(), 0u);
+    EXPECT_EQ(getSnapshot(2)->changes.get(), 0u);
+
+    // Changes on a parent still reach its otherwise clean children.
+    setAlpha(1, 0.5);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, STARTING_ZORDER);
+    EXPECT_EQ(getSnapshot(111)->alpha, 0.5f);
+    EXPECT_EQ(getSnapshot(1221)->alpha, 0.5f);
+    EXPECT_EQ(getSnapshot(2)->alpha, 1.f);
+}
+
+TEST_F(LayerSnapshotTest, HotFieldsMatchSnapshots) {
+    setAlpha(12, 0.5);
+    hideLayer(13);
+    UPDATE_AND_VERIFY(mSnapshotBuilder, {1, 11, 111, 12, 121, 122, 1221, 2});
+
+    const auto& snapshots = mSnapshotBuilder.getSnapshots();
+    const auto& hotFields = mSnapshotBuilder.getHotFields();
+    ASSERT_EQ(snapshots.size(), hotFields.size());
+    for (size_t i = 0; i < snapshots.size(); i++) {
+        SCOPED_TRACE(snapshots[i]->getDebugString());
+        EXPECT_EQ(snapshots[i]->globalZ, i);
+        EXPECT_EQ(hotFields[i].isVisible, snapshots[i]->isVisible);
+        EXPECT_EQ(hotFields[i].alpha, snapshots[i]->alpha);
+        EXPECT_EQ(hotFields[i].layerStack, snapshots[i]->outputFilter.layerStack);
+        EXPECT_EQ(hotFields[i].changes, snapshots[i]->changes);
+    }
+    EXPECT_EQ(hotFields[getSnapshot(121)->globalZ].alpha, 0.5f);
+    EXPECT_FALSE(hotFields[getSnapshot(13)->globalZ].isVisible);
+}
+
 // Change states
 TEST_F(LayerSnapshotTest, UpdateClearsPreviousChangeStates) {
     setCrop(1, Rect(1, 2, 3, 4));
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LocklessQueue.h"
+
+namespace android {
+namespace {
+
+TEST(LocklessQueueTest, popsInPushOrder) {
+    LocklessQueue<int> queue;
+    EXPECT_TRUE(queue.isEmpty());
+    queue.push(1);
+    queue.push(2);
+    EXPECT_EQ(1, queue.pop());
+    queue.push(3);
+    EXPECT_EQ(2, queue.pop());
+    EXPECT_EQ(3, queue.pop());
+    EXPECT_FALSE(queue.pop().has_value());
+    EXPECT_TRUE(queue.isEmpty());
+}
+
+TEST(LocklessQueueTest, movesValues) {
+    LocklessQueue<std::unique_ptr<std::string>> queue;
+    queue.push(std::make_unique<std::string>("first"));
+    queue.push(std::make_unique<std::string>("second"));
+
+    auto first = queue.pop();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ("first", **first);
+    auto second = queue.pop();
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ("second", **second);
+}
+
+TEST(LocklessQueueTest, multipleProducers) {
+    constexpr int kProducerCount = 4;
+    constexpr int kValuesPerProducer = 1000;
+    LocklessQueue<int> queue;
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kProducerCount; i++) {
+        producers.emplace_back([&queue, i]() {
+            for (int j = 0; j < kValuesPerProducer; j++) {
+                queue.push(i * kValuesPerProducer + j);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    // Values from a single producer keep their relative order.
+    std::vector<int> lastValue(kProducerCount, -1);
+    int count = 0;
+    while (auto value = queue.pop()) {
+        const int producer = *value / kValuesPerProducer;
+        EXPECT_LT(lastValue[producer], *value);
+        lastValue[producer] = *value;
+        count++;
+    }
+    EXPECT_EQ(kProducerCount * kValuesPerProducer, count);
+}
+
+} // namespace
+} // namespace android
@@ -99,6 +99,8 @@ int64_t PowerAdvisorTest::toNanos(Duration d) {
 void PowerAdvisorTest::SetUp() {
     mPowerAdvisor = std::make_unique<impl::PowerAdvisor>(*mFlinger.flinger());
     mPowerAdvisor->mPowerHal = std::make_unique<NiceMock<MockPowerHalController>>();
+    // Most tests check the binder calls as they are made; async reporting is tested on its own.
+    mPowerAdvisor->mAsyncHintSessionReporting = false;
     mMockPowerHalController =
             reinterpret_cast<MockPowerHalController*>(mPowerAdvisor->mPowerHal.get());
     ON_CALL(*mMockPowerHalController, getHintSessionPreferredRate)
@@ -559,6 +561,31 @@ TEST_F(PowerAdvisorTest, hintSessionTestNotifyReportRace) {
     EXPECT_EQ(sessionExists(), false);
 }
 
+TEST_F(PowerAdvisorTest, asyncReportingDoesNotBlockOnBinder) {
+    mPowerAdvisor->mAsyncHintSessionReporting = true;
+    mPowerAdvisor->onBootFinished();
+    startPowerHintSession();
+
+    std::promise<bool> letSendHintFinish;
+    std::shared_future<bool> sendHintCanFinish = letSendHintFinish.get_future().share();
+    std::promise<SessionHint> sentHint;
+    EXPECT_CALL(*mMockPowerHintSession, sendHint(_))
+            .Times(1)
+            .WillOnce([&](SessionHint hint) {
+                sentHint.set_value(hint);
+                sendHintCanFinish.wait();
+                return HalResult<void>::ok();
+            });
+
+    // The binder call is still blocked, but the caller has already returned.
+    mPowerAdvisor->notifyCpuLoadUp();
+    auto sentHintFuture = sentHint.get_future();
+    ASSERT_EQ(sentHintFuture.wait_for(1s), std::future_status::ready);
+    EXPECT_EQ(sentHintFuture.get(), SessionHint::CPU_LOAD_UP);
+    letSendHintFinish.set_value(true);
+    EXPECT_TRUE(sessionExists());
+}
+
 TEST_F(PowerAdvisorTest, legacyHintSessionCreationStillWorks) {
     mPowerAdvisor->onBootFinished();
     mMockPowerHintSession = std::make_shared<NiceMock<MockPowerHintSessionWrapper>>();
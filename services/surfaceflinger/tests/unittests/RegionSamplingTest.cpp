@@ -106,6 +106,26 @@ TEST_F(RegionSamplingTest, bounds_checking) {
                 testing::Eq(0.0));
 }
 
+TEST_F(RegionSamplingTest, maps_area_to_downscaled_buffer) {
+    Rect const sampledBounds{100, 200, 500, 240};
+    int32_t const bufferWidth = sampledBounds.getWidth() / 4;
+    int32_t const bufferHeight = sampledBounds.getHeight() / 4;
+
+    EXPECT_EQ(Rect(0, 0, 50, 10),
+              toSampledBufferArea(Rect{100, 200, 300, 240}, sampledBounds, bufferWidth,
+                                  bufferHeight));
+    EXPECT_EQ(Rect(0, 0, 100, 10),
+              toSampledBufferArea(sampledBounds, sampledBounds, bufferWidth, bufferHeight));
+
+    // Areas thinner than the downscale factor still cover one buffer pixel.
+    EXPECT_EQ(Rect(0, 9, 100, 10),
+              toSampledBufferArea(Rect{100, 238, 500, 239}, sampledBounds, bufferWidth,
+                                  bufferHeight));
+    EXPECT_EQ(Rect(99, 0, 100, 10),
+              toSampledBufferArea(Rect{499, 200, 500, 240}, sampledBounds, bufferWidth,
+                                  bufferHeight));
+}
+
 } // namespace android
 
 // TODO(b/129481165): remove the #pragma below and fix conversion issues
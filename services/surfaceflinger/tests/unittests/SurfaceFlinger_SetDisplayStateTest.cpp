@@ -559,5 +559,72 @@ TEST_F(SetDisplayStateLockedTest, setDisplayStateLockedRequestsUpdateIfHeightCha
     EXPECT_EQ(desiredHeight, display.getCurrentDisplayState().height);
 }
 
+TEST_F(SetDisplayStateLockedTest, setDisplayStateLockedRequestsUpdateIfRequestedRefreshRateChanged) {
+    using Case = NonHwcVirtualDisplayCase;
+    constexpr float desiredRefreshRate = 30.f;
+
+    // --------------------------------------------------------------------
+    // Preconditions
+
+    // A virtual display is set up
+    auto display = Case::Display::makeFakeExistingDisplayInjector(this);
+    display.inject();
+
+    // The display is composed on every frame
+    display.mutableCurrentDisplayState().requestedRefreshRate = Fps();
+
+    // The incoming request lowers the rate of the display
+    DisplayState state;
+    state.what = DisplayState::eRequestedRefreshRateChanged;
+    state.token = display.token();
+    state.requestedRefreshRate = desiredRefreshRate;
+
+    // --------------------------------------------------------------------
+    // Invocation
+
+    uint32_t flags = mFlinger.setDisplayStateLocked(state);
+
+    // --------------------------------------------------------------------
+    // Postconditions
+
+    // The returned flags indicate a transaction is needed
+    EXPECT_EQ(eDisplayTransactionNeeded, flags);
+
+    // The current display state has the new value.
+    EXPECT_EQ(Fps::fromValue(desiredRefreshRate),
+              display.getCurrentDisplayState().requestedRefreshRate);
+}
+
+TEST_F(SetDisplayStateLockedTest, setDisplayStateLockedIgnoresRequestedRefreshRateOfPhysicalDisplay) {
+    using Case = SimplePrimaryDisplayCase;
+
+    // --------------------------------------------------------------------
+    // Preconditions
+
+    // A physical display is set up
+    auto display = Case::Display::makeFakeExistingDisplayInjector(this);
+    display.inject();
+
+    // The incoming request sets a requested refresh rate
+    DisplayState state;
+    state.what = DisplayState::eRequestedRefreshRateChanged;
+    state.token = display.token();
+    state.requestedRefreshRate = 30.f;
+
+    // --------------------------------------------------------------------
+    // Invocation
+
+    uint32_t flags = mFlinger.setDisplayStateLocked(state);
+
+    // --------------------------------------------------------------------
+    // Postconditions
+
+    // The returned flags are empty
+    EXPECT_EQ(0u, flags);
+
+    // The requested refresh rate is only supported for virtual displays
+    EXPECT_EQ(Fps(), display.getCurrentDisplayState().requestedRefreshRate);
+}
+
 } // namespace
 } // namespace android
@@ -557,6 +557,32 @@ TEST_F(TimeStatsTest, canAverageRenderEngineTimings) {
     EXPECT_THAT(result, HasSubstr("averageRenderEngineTiming = 3.000 ms"));
 }
 
+TEST_F(TimeStatsTest, recordsFrameStagesWhileDisabled) {
+    ASSERT_FALSE(mTimeStats->isEnabled());
+    using FrameStage = TimeStats::FrameStage;
+    mTimeStats->recordFrameStageDuration(FrameStage::SnapshotUpdate,
+                                         std::chrono::nanoseconds(100us).count());
+    mTimeStats->recordFrameStageDuration(FrameStage::SnapshotUpdate,
+                                         std::chrono::nanoseconds(180us).count());
+    mTimeStats->recordFrameStageDuration(FrameStage::HwcPresent,
+                                         std::chrono::nanoseconds(3ms).count());
+
+    std::string result;
+    mTimeStats->parseFrameStageArgs({}, result);
+    EXPECT_THAT(result, HasSubstr("SnapshotUpdate: count = 2 p50 = 100us p90 = 200us"));
+    EXPECT_THAT(result, HasSubstr("100us=1 200us=1\n"));
+    EXPECT_THAT(result, HasSubstr("HwcPresent: count = 1 p50 = 3000us"));
+    EXPECT_THAT(result, HasSubstr("LayerHistory: count = 0"));
+
+    result.clear();
+    Vector<String16> clearArgs;
+    clearArgs.push_back(String16("-clear"));
+    mTimeStats->parseFrameStageArgs(clearArgs, result);
+    result.clear();
+    mTimeStats->parseFrameStageArgs({}, result);
+    EXPECT_THAT(result, HasSubstr("SnapshotUpdate: count = 0"));
+}
+
 TEST_F(TimeStatsTest, canInsertGlobalPresentToPresent) {
     EXPECT_TRUE(inputCommand(InputCommand::ENABLE, FMT_STRING).empty());
 
@@ -1103,6 +1129,7 @@ TEST_F(TimeStatsTest, globalStatsCallback) {
     mTimeStats->recordFrameDuration(1000000, 3000000);
     mTimeStats->recordRenderEngineDuration(2000000, 4000000);
     mTimeStats->recordRenderEngineDuration(2000000, std::make_shared<FenceTime>(3000000));
+    mTimeStats->recordFrameStageDuration(TimeStats::FrameStage::HwcValidate, 250000);
 
     mTimeStats->setPresentFenceGlobal(std::make_shared<FenceTime>(3000000));
     mTimeStats->setPresentFenceGlobal(std::make_shared<FenceTime>(5000000));
@@ -1170,6 +1197,14 @@ TEST_F(TimeStatsTest, globalStatsCallback) {
     EXPECT_THAT(atom.sf_deadline_misses(), HistogramEq(buildExpectedHistogram({1}, {7})));
     EXPECT_THAT(atom.sf_prediction_errors(), HistogramEq(buildExpectedHistogram({2}, {7})));
     EXPECT_EQ(atom.render_rate_bucket(), RENDER_RATE_BUCKET_0);
+    ASSERT_EQ(atom.frame_stage_timing_size(), 7);
+    const auto& hwcValidate = atom.frame_stage_timing(4);
+    EXPECT_EQ(hwcValidate.stage(),
+              android::surfaceflinger::FrameStageTimingHistogram::FRAME_STAGE_HWC_VALIDATE);
+    ASSERT_EQ(hwcValidate.time_micros_buckets_size(), 1);
+    EXPECT_EQ(hwcValidate.time_micros_buckets(0), 250);
+    EXPECT_EQ(hwcValidate.frame_counts(0), 1);
+    EXPECT_EQ(atom.frame_stage_timing(0).time_micros_buckets_size(), 0);
 
     SFTimeStatsGlobalProto globalProto;
     ASSERT_TRUE(globalProto.ParseFromString(inputCommand(InputCommand::DUMP_ALL, FMT_PROTO)));
@@ -1084,4 +1084,42 @@ TEST(TransactionHandlerTest, CanAddTransactionWithFullMergedIds) {
                            transaction1Id) > 0);
 }
 
+TEST(TransactionHandlerTest, OnlyQueuesPendingBarrierAreReevaluated) {
+    TransactionHandler handler;
+    constexpr uint64_t kBarrierTransactionId = 1;
+    constexpr uint64_t kReadyTransactionId = 2;
+    constexpr uint64_t kNotReadyTransactionId = 3;
+    int notReadyEvaluations = 0;
+    handler.addTransactionReadyFilter(
+            [&](const TransactionHandler::TransactionFlushState& flushState) {
+                switch (flushState.transaction->id) {
+                    case kBarrierTransactionId:
+                        // Waits on any other transaction to be applied first.
+                        return flushState.firstTransaction
+                                ? TransactionHandler::TransactionReadiness::NotReadyBarrier
+                                : TransactionHandler::TransactionReadiness::Ready;
+                    case kNotReadyTransactionId:
+                        notReadyEvaluations++;
+                        return TransactionHandler::TransactionReadiness::NotReady;
+                    default:
+                        return TransactionHandler::TransactionReadiness::Ready;
+                }
+            });
+
+    for (uint64_t id : {kBarrierTransactionId, kReadyTransactionId, kNotReadyTransactionId}) {
+        TransactionState transaction;
+        transaction.applyToken = sp<BBinder>::make();
+        transaction.id = id;
+        handler.queueTransaction(std::move(transaction));
+    }
+    handler.collectTransactions();
+
+    std::vector<TransactionState> transactions = handler.flushTransactions();
+    ASSERT_EQ(transactions.size(), 2u);
+    EXPECT_TRUE(std::any_of(transactions.begin(), transactions.end(),
+                            [](const auto& t) { return t.id == kBarrierTransactionId; }));
+    EXPECT_EQ(notReadyEvaluations, 1);
+    EXPECT_TRUE(handler.hasPendingTransactions());
+}
+
 } // namespace android
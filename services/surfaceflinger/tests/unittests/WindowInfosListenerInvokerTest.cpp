@@ -283,4 +283,69 @@ TEST_F(WindowInfosListenerInvokerTest, removeListenerAcks) {
     EXPECT_EQ(callCount, 2);
 }
 
+// Test that listeners that requested deltas only receive the windows that changed, while other
+// listeners keep receiving complete updates.
+TEST_F(WindowInfosListenerInvokerTest, sendsDeltasToOptedInListeners) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<gui::WindowInfosUpdate> deltaListenerUpdates;
+    std::vector<gui::WindowInfosUpdate> fullListenerUpdates;
+
+    const auto makeListener = [&](std::vector<gui::WindowInfosUpdate>& updates,
+                                  gui::WindowInfosListenerInfo& info) {
+        return sp<Listener>::make([&](const gui::WindowInfosUpdate& update) {
+            std::scoped_lock lock{mutex};
+            updates.push_back(update);
+            cv.notify_one();
+            info.windowInfosPublisher->ackWindowInfosReceived(update.vsyncId, info.listenerId);
+        });
+    };
+
+    gui::WindowInfosListenerInfo deltaListenerInfo;
+    mInvoker->addWindowInfosListener(makeListener(deltaListenerUpdates, deltaListenerInfo),
+                                     &deltaListenerInfo);
+    gui::WindowInfosListenerInfo fullListenerInfo;
+    mInvoker->addWindowInfosListener(makeListener(fullListenerUpdates, fullListenerInfo),
+                                     &fullListenerInfo);
+    deltaListenerInfo.windowInfosPublisher->requestWindowInfosDeltas(deltaListenerInfo.listenerId);
+
+    gui::WindowInfo window1;
+    window1.id = 1;
+    gui::WindowInfo window2;
+    window2.id = 2;
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        mInvoker->windowInfosChanged(gui::WindowInfosUpdate{{window1, window2}, {},
+                                                            /* vsyncId= */ 1, 0},
+                                     {}, false);
+    }});
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() {
+            return deltaListenerUpdates.size() == 1 && fullListenerUpdates.size() == 1;
+        });
+    }
+
+    window2.frame = Rect(0, 0, 10, 10);
+    BackgroundExecutor::getInstance().sendCallbacks({[&]() {
+        mInvoker->windowInfosChanged(gui::WindowInfosUpdate{{window1, window2}, {},
+                                                            /* vsyncId= */ 2, 0},
+                                     {}, false);
+    }});
+    {
+        std::unique_lock lock{mutex};
+        cv.wait(lock, [&]() {
+            return deltaListenerUpdates.size() == 2 && fullListenerUpdates.size() == 2;
+        });
+    }
+
+    EXPECT_FALSE(deltaListenerUpdates[0].isDelta());
+    ASSERT_TRUE(deltaListenerUpdates[1].isDelta());
+    EXPECT_EQ(deltaListenerUpdates[0].version, deltaListenerUpdates[1].baseVersion);
+    ASSERT_EQ(1u, deltaListenerUpdates[1].windowInfos.size());
+    EXPECT_EQ(window2, deltaListenerUpdates[1].windowInfos[0]);
+
+    EXPECT_FALSE(fullListenerUpdates[1].isDelta());
+    EXPECT_EQ(2u, fullListenerUpdates[1].windowInfos.size());
+}
+
 } // namespace android
@@ -57,6 +57,12 @@ bool isStaticCastValid(Effect effect) {
 // -------------------------------------------------------------------------------------------------
 
 Info HalWrapper::getInfo() {
+    {
+        std::lock_guard<std::mutex> lock(mInfoMutex);
+        if (mInfoCacheFullyLoaded) {
+            return mInfoCache.get();
+        }
+    }
     getCapabilities();
     getPrimitiveDurations();
     std::lock_guard<std::mutex> lock(mInfoMutex);
@@ -93,9 +99,16 @@ Info HalWrapper::getInfo() {
     if (mInfoCache.mMaxAmplitudes.isFailed()) {
         mInfoCache.mMaxAmplitudes = getMaxAmplitudesInternal();
     }
+    mInfoCacheFullyLoaded = mInfoCache.isFullyLoaded();
     return mInfoCache.get();
 }
 
+void HalWrapper::invalidateInfoCache() {
+    std::lock_guard<std::mutex> lock(mInfoMutex);
+    mInfoCache = InfoCache();
+    mInfoCacheFullyLoaded = false;
+}
+
 HalResult<milliseconds> HalWrapper::performComposedEffect(const std::vector<CompositeEffect>&,
                                                           const std::function<void()>&) {
     ALOGV("Skipped performComposedEffect because it's not available in Vibrator HAL");
@@ -210,8 +223,16 @@ void AidlHalWrapper::tryReconnect() {
     }
     sp<Aidl::IVibrator> newHandle = result.value();
     if (newHandle) {
-        std::lock_guard<std::mutex> lock(mHandleMutex);
-        mHandle = std::move(newHandle);
+        bool isNewService;
+        {
+            std::lock_guard<std::mutex> lock(mHandleMutex);
+            isNewService = mHandle == nullptr ||
+                    IInterface::asBinder(mHandle) != IInterface::asBinder(newHandle);
+            mHandle = std::move(newHandle);
+        }
+        if (isNewService) {
+            invalidateInfoCache();
+        }
     }
 }
 
@@ -428,8 +449,15 @@ template <typename I>
 void HidlHalWrapper<I>::tryReconnect() {
     sp<I> newHandle = I::tryGetService();
     if (newHandle) {
-        std::lock_guard<std::mutex> lock(mHandleMutex);
-        mHandle = std::move(newHandle);
+        bool isNewService;
+        {
+            std::lock_guard<std::mutex> lock(mHandleMutex);
+            isNewService = !hardware::interfacesEqual(mHandle, newHandle);
+            mHandle = std::move(newHandle);
+        }
+        if (isNewService) {
+            invalidateInfoCache();
+        }
     }
 }
 
@@ -306,6 +306,17 @@ public:
     }
 
 private:
+    // Whether every field was loaded or reported unsupported, so none needs another HAL call.
+    bool isFullyLoaded() const {
+        return !mCapabilities.isFailed() && !mSupportedEffects.isFailed() &&
+                !mSupportedBraking.isFailed() && !mSupportedPrimitives.isFailed() &&
+                !mPrimitiveDurations.isFailed() && !mPrimitiveDelayMax.isFailed() &&
+                !mPwlePrimitiveDurationMax.isFailed() && !mCompositionSizeMax.isFailed() &&
+                !mPwleSizeMax.isFailed() && !mMinFrequency.isFailed() &&
+                !mResonantFrequency.isFailed() && !mFrequencyResolution.isFailed() &&
+                !mQFactor.isFailed() && !mMaxAmplitudes.isFailed();
+    }
+
     // Create a transaction failed results as default so we can retry on the first time we get them.
     static const constexpr char* MSG = "never loaded";
     HalResult<Capabilities> mCapabilities = HalResult<Capabilities>::transactionFailed(MSG);
@@ -397,9 +408,15 @@ protected:
     virtual HalResult<float> getQFactorInternal();
     virtual HalResult<std::vector<float>> getMaxAmplitudesInternal();
 
+    // Drops all cached vibrator info, to be reloaded from the HAL on next use. Called when
+    // reconnecting reaches a different HAL service instance, which may report different info.
+    void invalidateInfoCache();
+
 private:
     std::mutex mInfoMutex;
     InfoCache mInfoCache GUARDED_BY(mInfoMutex);
+    // Set once mInfoCache has no field left to load, so getInfo can skip checking each one.
+    bool mInfoCacheFullyLoaded GUARDED_BY(mInfoMutex) = false;
 };
 
 // Wrapper for the AIDL Vibrator HAL.
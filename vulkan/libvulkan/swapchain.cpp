@@ -19,6 +19,7 @@
 
 #include <aidl/android/hardware/graphics/common/Dataspace.h>
 #include <aidl/android/hardware/graphics/common/PixelFormat.h>
+#include <android-base/properties.h>
 #include <android/hardware/graphics/common/1.0/types.h>
 #include <android/hardware_buffer.h>
 #include <grallocusage/GrallocUsageConversion.h>
@@ -34,6 +35,11 @@
 #include <utils/Trace.h>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -270,6 +276,11 @@ enum { MAX_TIMING_INFOS = 10 };
 // syncronous requests to Surface Flinger):
 enum { MIN_NUM_FRAMES_AGO = 5 };
 
+// In pre-dequeue mode the helper thread dequeues with this timeout, and retries
+// until it gets a buffer or is asked to exit. This bounds how long stopping the
+// thread can take when no buffer is being released.
+constexpr nsecs_t kPreDequeueRetryTimeout = ms2ns(100);
+
 bool IsSharedPresentMode(VkPresentModeKHR mode) {
     return mode == VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR ||
         mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR;
@@ -288,7 +299,10 @@ struct Swapchain {
           frame_timestamps_enabled(false),
           refresh_duration(refresh_duration_),
           acquire_next_image_timeout(-1),
-          shared(IsSharedPresentMode(present_mode)) {
+          shared(IsSharedPresentMode(present_mode)),
+          pre_dequeue_enabled(
+              !shared && android::base::GetBoolProperty(
+                             "debug.vulkan.swapchain.pre_dequeue", false)) {
     }
 
     VkResult get_refresh_duration(uint64_t& outRefreshDuration)
@@ -314,6 +328,23 @@ struct Swapchain {
     int64_t refresh_duration;
     nsecs_t acquire_next_image_timeout;
     bool shared;
+    // When enabled, a helper thread keeps one buffer dequeued ahead of
+    // vkAcquireNextImageKHR, so the app doesn't block on the BufferQueue.
+    bool pre_dequeue_enabled;
+
+    struct PreDequeue {
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool exit = false;
+        // When ready, the thread owns buffer and fence_fd until they are
+        // taken by AcquireNextImageKHR or cancelled when the thread stops.
+        bool ready = false;
+        ANativeWindowBuffer* buffer = nullptr;
+        int fence_fd = -1;
+        // The error from the last dequeueBuffer, if it failed.
+        int err = android::OK;
+    } pre_dequeue;
 
     struct Image {
         Image()
@@ -338,6 +369,22 @@ struct Swapchain {
         bool dequeued;
     } images[android::BufferQueueDefs::NUM_BUFFER_SLOTS];
 
+    // The parameters the images were created with. A swapchain recreated from
+    // this one with the same parameters can take over its images, instead of
+    // reallocating every buffer and VkImage.
+    struct ImageParams {
+        VkSwapchainCreateFlagsKHR flags;
+        VkFormat format;
+        VkColorSpaceKHR color_space;
+        VkExtent2D extent;
+        VkImageUsageFlags usage;
+        uint32_t min_image_count;
+        VkPresentModeKHR present_mode;
+        uint64_t consumer_usage;
+    };
+    // Only set if the images can be reused by a recreated swapchain.
+    std::optional<ImageParams> image_params;
+
     std::vector<TimingInfo> timing;
 };
 
@@ -421,9 +468,198 @@ void ReleaseSwapchainImage(VkDevice device,
     image.buffer.clear();
 }
 
-void OrphanSwapchain(VkDevice device, Swapchain* swapchain) {
+void PreDequeueLoop(Swapchain* swapchain) {
+    ANativeWindow* window = swapchain->surface.window.get();
+    Swapchain::PreDequeue& pre_dequeue = swapchain->pre_dequeue;
+
+    std::unique_lock<std::mutex> lock(pre_dequeue.mutex);
+    while (true) {
+        pre_dequeue.cond.wait(lock, [&pre_dequeue] {
+            return pre_dequeue.exit ||
+                   (!pre_dequeue.ready && pre_dequeue.err == android::OK);
+        });
+        if (pre_dequeue.exit) {
+            return;
+        }
+
+        lock.unlock();
+        ANativeWindowBuffer* buffer;
+        int fence_fd;
+        int err;
+        {
+            ATRACE_NAME("PreDequeueBuffer");
+            err = window->dequeueBuffer(window, &buffer, &fence_fd);
+        }
+        lock.lock();
+
+        if (err == android::TIMED_OUT) {
+            continue;
+        }
+        if (err == android::OK) {
+            pre_dequeue.buffer = buffer;
+            pre_dequeue.fence_fd = fence_fd;
+            pre_dequeue.ready = true;
+        } else {
+            pre_dequeue.err = err;
+        }
+        pre_dequeue.cond.notify_all();
+    }
+}
+
+VkResult StartPreDequeue(Swapchain& swapchain) {
+    if (swapchain.pre_dequeue.thread.joinable()) {
+        return VK_SUCCESS;
+    }
+
+    ANativeWindow* window = swapchain.surface.window.get();
+    int err = window->perform(window, NATIVE_WINDOW_SET_DEQUEUE_TIMEOUT,
+                              kPreDequeueRetryTimeout);
+    if (err != android::OK) {
+        ALOGE("window->perform(SET_DEQUEUE_TIMEOUT) failed: %s (%d)",
+              strerror(-err), err);
+        return VK_ERROR_SURFACE_LOST_KHR;
+    }
+
+    swapchain.pre_dequeue.thread = std::thread(PreDequeueLoop, &swapchain);
+    pthread_setname_np(swapchain.pre_dequeue.thread.native_handle(),
+                       "VkPreDequeue");
+    return VK_SUCCESS;
+}
+
+// Stop the pre-dequeue thread, returning any buffer it is holding to the
+// window. This must be done while the window is still connected.
+void StopPreDequeue(Swapchain& swapchain) {
+    Swapchain::PreDequeue& pre_dequeue = swapchain.pre_dequeue;
+    if (!pre_dequeue.thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pre_dequeue.mutex);
+        pre_dequeue.exit = true;
+    }
+    pre_dequeue.cond.notify_all();
+    pre_dequeue.thread.join();
+
+    ANativeWindow* window = swapchain.surface.window.get();
+    if (pre_dequeue.ready) {
+        window->cancelBuffer(window, pre_dequeue.buffer, pre_dequeue.fence_fd);
+        pre_dequeue.buffer = nullptr;
+        pre_dequeue.fence_fd = -1;
+        pre_dequeue.ready = false;
+    }
+
+    // Put back the dequeue timeout the swapchain believes is set
+    window->perform(window, NATIVE_WINDOW_SET_DEQUEUE_TIMEOUT,
+                    swapchain.acquire_next_image_timeout);
+}
+
+// Take the buffer dequeued ahead by the pre-dequeue thread, waiting up to
+// timeout for it. Errors are mapped the same way as for a direct dequeue.
+VkResult TakePreDequeuedBuffer(Swapchain& swapchain,
+                               uint64_t timeout,
+                               ANativeWindowBuffer** buffer,
+                               int* fence_fd) {
+    ATRACE_CALL();
+
+    VkResult result = StartPreDequeue(swapchain);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    Swapchain::PreDequeue& pre_dequeue = swapchain.pre_dequeue;
+    std::unique_lock<std::mutex> lock(pre_dequeue.mutex);
+    auto done = [&pre_dequeue] {
+        return pre_dequeue.ready || pre_dequeue.err != android::OK;
+    };
+    if (timeout > (uint64_t)std::numeric_limits<nsecs_t>::max()) {
+        pre_dequeue.cond.wait(lock, done);
+    } else if (!pre_dequeue.cond.wait_for(lock, std::chrono::nanoseconds(timeout),
+                                          done)) {
+        return timeout ? VK_TIMEOUT : VK_NOT_READY;
+    }
+
+    if (pre_dequeue.err == android::INVALID_OPERATION) {
+        // Too many buffers are dequeued. Let the thread retry once the app
+        // has presented some of them.
+        ALOGW("dequeueBuffer timed out: %s (%d)",
+              strerror(-pre_dequeue.err), pre_dequeue.err);
+        pre_dequeue.err = android::OK;
+        pre_dequeue.cond.notify_all();
+        return timeout ? VK_TIMEOUT : VK_NOT_READY;
+    } else if (pre_dequeue.err != android::OK) {
+        ALOGE("dequeueBuffer failed: %s (%d)", strerror(-pre_dequeue.err),
+              pre_dequeue.err);
+        return VK_ERROR_SURFACE_LOST_KHR;
+    }
+
+    *buffer = pre_dequeue.buffer;
+    *fence_fd = pre_dequeue.fence_fd;
+    pre_dequeue.buffer = nullptr;
+    pre_dequeue.fence_fd = -1;
+    pre_dequeue.ready = false;
+
+    // Start dequeuing the next buffer straight away
+    pre_dequeue.cond.notify_all();
+    return VK_SUCCESS;
+}
+
+// Returns true if a swapchain created with create_info can take over the
+// images of old_swapchain.
+bool CanRecycleSwapchainImages(const Swapchain& old_swapchain,
+                               const VkSwapchainCreateInfoKHR* create_info) {
+    if (!old_swapchain.image_params ||
+        create_info->imageSharingMode != VK_SHARING_MODE_EXCLUSIVE) {
+        return false;
+    }
+    const Swapchain::ImageParams& params = *old_swapchain.image_params;
+    if (params.flags != create_info->flags ||
+        params.format != create_info->imageFormat ||
+        params.color_space != create_info->imageColorSpace ||
+        params.extent.width != create_info->imageExtent.width ||
+        params.extent.height != create_info->imageExtent.height ||
+        params.usage != create_info->imageUsage ||
+        params.min_image_count != create_info->minImageCount ||
+        params.present_mode != create_info->presentMode ||
+        params.consumer_usage != old_swapchain.surface.consumer_usage) {
+        return false;
+    }
+
+    // Image compression control would need comparing too, so don't bother
+    for (const VkBaseInStructure* info =
+             reinterpret_cast<const VkBaseInStructure*>(create_info->pNext);
+         info; info = info->pNext) {
+        if (info->sType == VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// If recycled_images is not null, and none of the images are dequeued, they
+// are moved into it rather than released, so they can be taken over by the
+// swapchain replacing this one.
+void OrphanSwapchain(VkDevice device,
+                     Swapchain* swapchain,
+                     std::vector<Swapchain::Image>* recycled_images = nullptr) {
     if (swapchain->surface.swapchain_handle != HandleFromSwapchain(swapchain))
         return;
+    StopPreDequeue(*swapchain);
+    if (recycled_images) {
+        bool any_dequeued = false;
+        for (uint32_t i = 0; i < swapchain->num_images; i++) {
+            any_dequeued |= swapchain->images[i].dequeued;
+        }
+        if (!any_dequeued) {
+            for (uint32_t i = 0; i < swapchain->num_images; i++) {
+                Swapchain::Image& img = swapchain->images[i];
+                recycled_images->push_back(img);
+                // The release fence moves with the image, and is closed when
+                // the image is next presented, as usual.
+                img = Swapchain::Image();
+            }
+        }
+    }
     for (uint32_t i = 0; i < swapchain->num_images; i++) {
         if (!swapchain->images[i].dequeued) {
             ReleaseSwapchainImage(device, swapchain->shared, nullptr, -1,
@@ -439,6 +675,11 @@ uint32_t get_num_ready_timings(Swapchain& swapchain) {
         return 0;
     }
 
+    // Fetching timestamps from the consumer updates every frame at once, so
+    // only let the first query do it and read the rest from what it received.
+    bool updated = false;
+    ANativeWindow* window = swapchain.surface.window.get();
+
     uint32_t num_ready = 0;
     const size_t num_timings = swapchain.timing.size() - MIN_NUM_FRAMES_AGO + 1;
     for (uint32_t i = 0; i < num_timings; i++) {
@@ -457,20 +698,38 @@ uint32_t get_num_ready_timings(Swapchain& swapchain) {
         int64_t composition_latch_time = 0;
         int64_t actual_present_time = 0;
         // Obtain timestamps:
-        int err = native_window_get_frame_timestamps(
-            swapchain.surface.window.get(), ti.native_frame_id_,
-            &desired_present_time, &render_complete_time,
-            &composition_latch_time,
-            nullptr,  //&first_composition_start_time,
-            nullptr,  //&last_composition_start_time,
-            nullptr,  //&composition_finish_time,
-            &actual_present_time,
-            nullptr,  //&dequeue_ready_time,
-            nullptr /*&reads_done_time*/);
+        int err = android::NAME_NOT_FOUND;
+        if (updated) {
+            err = native_window_get_cached_frame_timestamps(
+                window, ti.native_frame_id_,
+                &desired_present_time, &render_complete_time,
+                &composition_latch_time,
+                nullptr,  //&first_composition_start_time,
+                nullptr,  //&last_composition_start_time,
+                nullptr,  //&composition_finish_time,
+                &actual_present_time,
+                nullptr,  //&dequeue_ready_time,
+                nullptr /*&reads_done_time*/);
+        }
+        // Fall back to a full query if the window can't report cached
+        // timestamps.
+        if (err != android::OK) {
+            err = native_window_get_frame_timestamps(
+                window, ti.native_frame_id_,
+                &desired_present_time, &render_complete_time,
+                &composition_latch_time,
+                nullptr,  //&first_composition_start_time,
+                nullptr,  //&last_composition_start_time,
+                nullptr,  //&composition_finish_time,
+                &actual_present_time,
+                nullptr,  //&dequeue_ready_time,
+                nullptr /*&reads_done_time*/);
+        }
 
         if (err != android::OK) {
             continue;
         }
+        updated = true;
 
         // Record the timestamp(s) we received, and then see if this TimingInfo
         // is ready to be reported to the user:
@@ -1392,6 +1651,11 @@ static void DestroySwapchainInternal(VkDevice device,
     bool active = swapchain->surface.swapchain_handle == swapchain_handle;
     ANativeWindow* window = active ? swapchain->surface.window.get() : nullptr;
 
+    // An orphaned swapchain has already stopped its pre-dequeue thread
+    if (active) {
+        StopPreDequeue(*swapchain);
+    }
+
     if (window && swapchain->frame_timestamps_enabled) {
         native_window_enable_frame_timestamps(window, false);
     }
@@ -1701,8 +1965,17 @@ VkResult CreateSwapchainKHR(VkDevice device,
               reinterpret_cast<uint64_t>(create_info->oldSwapchain));
         return VK_ERROR_NATIVE_WINDOW_IN_USE_KHR;
     }
-    if (create_info->oldSwapchain != VK_NULL_HANDLE)
-        OrphanSwapchain(device, SwapchainFromHandle(create_info->oldSwapchain));
+    // If the old swapchain's images match what is being asked for, take them
+    // over instead of reallocating every buffer, e.g. when only preTransform
+    // changes on rotation.
+    std::vector<Swapchain::Image> recycled_images;
+    if (create_info->oldSwapchain != VK_NULL_HANDLE) {
+        Swapchain* old_swapchain = SwapchainFromHandle(create_info->oldSwapchain);
+        OrphanSwapchain(device, old_swapchain,
+                        CanRecycleSwapchainImages(*old_swapchain, create_info)
+                            ? &recycled_images
+                            : nullptr);
+    }
 
     // -- Reset the native window --
     // The native window might have been used previously, and had its properties
@@ -1716,11 +1989,11 @@ VkResult CreateSwapchainKHR(VkDevice device,
     // orphans the previous buffers, getting us back to the state where we can
     // dequeue all buffers.
     //
-    // This is not necessary if the surface was never used previously.
-    //
-    // TODO(http://b/134186185) recycle swapchain images more efficiently
+    // This is not necessary if the surface was never used previously, or if
+    // we're taking over the previous swapchain's images, whose buffers stay
+    // in the queue.
     ANativeWindow* window = surface.window.get();
-    if (surface.used_by_swapchain) {
+    if (surface.used_by_swapchain && recycled_images.empty()) {
         err = native_window_api_disconnect(window, NATIVE_WINDOW_API_EGL);
         ALOGW_IF(err != android::OK,
                  "native_window_api_disconnect failed: %s (%d)", strerror(-err),
@@ -1976,6 +2249,35 @@ VkResult CreateSwapchainKHR(VkDevice device,
         Swapchain(surface, num_images, create_info->presentMode,
                   TranslateVulkanToNativeTransform(create_info->preTransform),
                   refresh_duration);
+    if (!IsSharedPresentMode(create_info->presentMode) &&
+        !(create_info->flags & VK_SWAPCHAIN_CREATE_DEFERRED_MEMORY_ALLOCATION_BIT_EXT) &&
+        !usage_info_pNext) {
+        swapchain->image_params = Swapchain::ImageParams{
+            .flags = create_info->flags,
+            .format = create_info->imageFormat,
+            .color_space = create_info->imageColorSpace,
+            .extent = create_info->imageExtent,
+            .usage = create_info->imageUsage,
+            .min_image_count = create_info->minImageCount,
+            .present_mode = create_info->presentMode,
+            .consumer_usage = surface.consumer_usage,
+        };
+    }
+
+    // The same create parameters should always give the same image count, but
+    // if they don't, drop the old images. Without the reconnect above we can't
+    // dequeue every buffer up front, so bind the queue's buffers to new images
+    // as they are acquired, as for a deferred allocation swapchain.
+    bool bind_on_acquire = false;
+    if (!recycled_images.empty() && recycled_images.size() != num_images) {
+        ALOGW("swapchain image count changed from %zu to %u, not reusing images",
+              recycled_images.size(), num_images);
+        for (Swapchain::Image& img : recycled_images) {
+            ReleaseSwapchainImage(device, false, nullptr, -1, img, false);
+        }
+        recycled_images.clear();
+        bind_on_acquire = true;
+    }
     VkSwapchainImageCreateInfoANDROID swapchain_image_create = {
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wold-style-cast"
@@ -2015,7 +2317,13 @@ VkResult CreateSwapchainKHR(VkDevice device,
 
     // Note: don't do deferred allocation for shared present modes. There's only one buffer
     // involved so very little benefit.
-    if ((create_info->flags & VK_SWAPCHAIN_CREATE_DEFERRED_MEMORY_ALLOCATION_BIT_EXT) &&
+    if (!recycled_images.empty()) {
+        // The buffers are already allocated and bound, so just take the images over
+        for (uint32_t i = 0; i < num_images; i++) {
+            swapchain->images[i] = recycled_images[i];
+        }
+    } else if ((bind_on_acquire ||
+                (create_info->flags & VK_SWAPCHAIN_CREATE_DEFERRED_MEMORY_ALLOCATION_BIT_EXT)) &&
             !IsSharedPresentMode(create_info->presentMode)) {
         // Don't want to touch the underlying gralloc buffers yet;
         // instead just create unbound VkImages which will later be bound to memory inside
@@ -2186,29 +2494,36 @@ VkResult AcquireNextImageKHR(VkDevice device,
         return result;
     }
 
-    const nsecs_t acquire_next_image_timeout =
-        timeout > (uint64_t)std::numeric_limits<nsecs_t>::max() ? -1 : timeout;
-    if (acquire_next_image_timeout != swapchain.acquire_next_image_timeout) {
-        // Cache the timeout to avoid the duplicate binder cost.
-        err = window->perform(window, NATIVE_WINDOW_SET_DEQUEUE_TIMEOUT,
-                              acquire_next_image_timeout);
-        if (err != android::OK) {
-            ALOGE("window->perform(SET_DEQUEUE_TIMEOUT) failed: %s (%d)",
-                  strerror(-err), err);
-            return VK_ERROR_SURFACE_LOST_KHR;
-        }
-        swapchain.acquire_next_image_timeout = acquire_next_image_timeout;
-    }
-
     ANativeWindowBuffer* buffer;
     int fence_fd;
-    err = window->dequeueBuffer(window, &buffer, &fence_fd);
-    if (err == android::TIMED_OUT || err == android::INVALID_OPERATION) {
-        ALOGW("dequeueBuffer timed out: %s (%d)", strerror(-err), err);
-        return timeout ? VK_TIMEOUT : VK_NOT_READY;
-    } else if (err != android::OK) {
-        ALOGE("dequeueBuffer failed: %s (%d)", strerror(-err), err);
-        return VK_ERROR_SURFACE_LOST_KHR;
+    if (swapchain.pre_dequeue_enabled) {
+        result = TakePreDequeuedBuffer(swapchain, timeout, &buffer, &fence_fd);
+        if (result != VK_SUCCESS) {
+            return result;
+        }
+    } else {
+        const nsecs_t acquire_next_image_timeout =
+            timeout > (uint64_t)std::numeric_limits<nsecs_t>::max() ? -1 : timeout;
+        if (acquire_next_image_timeout != swapchain.acquire_next_image_timeout) {
+            // Cache the timeout to avoid the duplicate binder cost.
+            err = window->perform(window, NATIVE_WINDOW_SET_DEQUEUE_TIMEOUT,
+                                  acquire_next_image_timeout);
+            if (err != android::OK) {
+                ALOGE("window->perform(SET_DEQUEUE_TIMEOUT) failed: %s (%d)",
+                      strerror(-err), err);
+                return VK_ERROR_SURFACE_LOST_KHR;
+            }
+            swapchain.acquire_next_image_timeout = acquire_next_image_timeout;
+        }
+
+        err = window->dequeueBuffer(window, &buffer, &fence_fd);
+        if (err == android::TIMED_OUT || err == android::INVALID_OPERATION) {
+            ALOGW("dequeueBuffer timed out: %s (%d)", strerror(-err), err);
+            return timeout ? VK_TIMEOUT : VK_NOT_READY;
+        } else if (err != android::OK) {
+            ALOGE("dequeueBuffer failed: %s (%d)", strerror(-err), err);
+            return VK_ERROR_SURFACE_LOST_KHR;
+        }
     }
 
     uint32_t idx;